@@ -926,6 +926,30 @@ CIVETWEB_API int mg_send_file_body(struct mg_connection *conn,
                                    const char *path);
 
 
+#if !defined(_WIN32)
+/* Send len bytes, starting at offset, from an open file descriptor without
+ * HTTP headers. Uses sendfile if possible (Linux, no SSL, no throttling).
+ * Not available on Windows.
+ * The code must send a valid HTTP response header before using this function.
+ * The file descriptor is not closed and its file offset is not changed.
+ *
+ * Parameters:
+ *   conn: Current connection information.
+ *   fd: File descriptor of a regular file.
+ *   offset: Offset in the file of the first byte to send.
+ *   len: Number of bytes to send.
+ *
+ * Return:
+ *   < 0   Error
+ *   >= 0  Number of bytes sent, less than len if the end of the file is reached.
+ */
+CIVETWEB_API long long mg_send_fd_body(struct mg_connection *conn,
+                                       int fd,
+                                       long long offset,
+                                       long long len);
+#endif
+
+
 /* Send HTTP error reply. */
 CIVETWEB_API int mg_send_http_error(struct mg_connection *conn,
                                     int status_code,
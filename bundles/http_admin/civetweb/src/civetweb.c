@@ -9884,6 +9884,63 @@ mg_send_file_body(struct mg_connection *conn, const char *path)
 #endif /* NO_FILESYSTEMS */
 
 
+#if !defined(_WIN32)
+long long
+mg_send_fd_body(struct mg_connection *conn,
+                int fd,
+                long long offset,
+                long long len)
+{
+    char buf[MG_BUF_LEN];
+    long long sent = 0;
+
+    if ((conn == NULL) || (fd < 0) || (offset < 0) || (len < 0)) {
+        return -1;
+    }
+
+#if defined(__linux__)
+    /* sendfile is only available for Linux */
+    if ((conn->ssl == 0) && (conn->throttle == 0)
+        && (!mg_strcasecmp(conn->dom_ctx->config[ALLOW_SENDFILE_CALL],
+                           "yes"))) {
+        off_t sf_offs = (off_t)offset;
+        while (sent < len) {
+            size_t sf_tosend = (size_t)(((len - sent) < 0x7FFFF000)
+                                            ? (len - sent)
+                                            : 0x7FFFF000);
+            ssize_t sf_sent =
+                sendfile(conn->client.sock, fd, &sf_offs, sf_tosend);
+            if (sf_sent <= 0) {
+                /* EOF, or the fd can not be used with sendfile. For the
+                 * latter fall back to the regular user mode copy. */
+                break;
+            }
+            sent += sf_sent;
+        }
+        offset = (long long)sf_offs;
+    }
+#endif
+
+    while (sent < len) {
+        size_t to_read = (size_t)(((len - sent) < (long long)sizeof(buf))
+                                      ? (len - sent)
+                                      : (long long)sizeof(buf));
+        ssize_t num_read = pread(fd, buf, to_read, (off_t)offset);
+        if (num_read <= 0) {
+            break; /* EOF or error */
+        }
+        if (mg_write(conn, buf, (size_t)num_read) != num_read) {
+            return -1;
+        }
+        sent += num_read;
+        offset += num_read;
+    }
+
+    return sent;
+}
+#endif
+
+
 #if !defined(NO_CACHING)
 /* Return True if we should reply 304 Not Modified. */
 static int
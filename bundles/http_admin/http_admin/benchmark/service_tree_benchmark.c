@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * Routing throughput benchmark for the http admin service tree.
+ *
+ * Registers a number of URIs (/api/v<N>/resource<M>) and routes request URIs (which are sub URIs of the
+ * registered URIs) from multiple threads, while a writer thread keeps adding and removing an extra URI.
+ *
+ * Usage: service_tree_benchmark [nr of URIs] [nr of reader threads] [nr of lookups per thread]
+ * Output is a single comma separated line, so that results can be collected by scripts.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "service_tree.h"
+
+#define BENCHMARK_DEFAULT_NR_OF_URIS        5000
+#define BENCHMARK_DEFAULT_NR_OF_THREADS     4
+#define BENCHMARK_DEFAULT_NR_OF_LOOKUPS     1000000
+#define BENCHMARK_URIS_PER_VERSION          100
+#define BENCHMARK_MAX_URI_LENGTH            128
+
+typedef struct benchmark_reader {
+    pthread_t thread;
+    service_tree_t *tree;
+    char (*requestUris)[BENCHMARK_MAX_URI_LENGTH];
+    int nrOfUris;
+    long nrOfLookups;
+    long nrOfMisses;
+} benchmark_reader_t;
+
+typedef struct benchmark_writer {
+    pthread_t thread;
+    service_tree_t *tree;
+    bool running; //atomic access
+    long nrOfUpdates;
+} benchmark_writer_t;
+
+static double benchmark_elapsed(const struct timespec *start, const struct timespec *end) {
+    return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+static void *benchmark_readerRun(void *data) {
+    benchmark_reader_t *reader = data;
+    unsigned int seed = (unsigned int) (size_t) reader;
+    for (long i = 0; i < reader->nrOfLookups; ++i) {
+        const char *uri = reader->requestUris[rand_r(&seed) % reader->nrOfUris];
+        int token = beginServiceTreeRead(reader->tree);
+        void *svc = findServiceInTree(reader->tree, uri);
+        if (svc == NULL) {
+            reader->nrOfMisses += 1;
+        }
+        endServiceTreeRead(reader->tree, token);
+    }
+    return NULL;
+}
+
+static void *benchmark_writerRun(void *data) {
+    benchmark_writer_t *writer = data;
+    int svc;
+    while (__atomic_load_n(&writer->running, __ATOMIC_RELAXED)) {
+        //Note the writer is the only writer, so no extra serialization needed.
+        addServiceNode(writer->tree, "/benchmark/extra/uri", &svc);
+        removeServiceNode(writer->tree, "/benchmark/extra/uri");
+        writer->nrOfUpdates += 2;
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    int nrOfUris = argc > 1 ? atoi(argv[1]) : BENCHMARK_DEFAULT_NR_OF_URIS;
+    int nrOfThreads = argc > 2 ? atoi(argv[2]) : BENCHMARK_DEFAULT_NR_OF_THREADS;
+    long nrOfLookups = argc > 3 ? atol(argv[3]) : BENCHMARK_DEFAULT_NR_OF_LOOKUPS;
+    if (nrOfUris <= 0 || nrOfThreads <= 0 || nrOfLookups <= 0) {
+        fprintf(stderr, "Usage: %s [nr of URIs] [nr of reader threads] [nr of lookups per thread]\n", argv[0]);
+        return 1;
+    }
+
+    service_tree_t tree = {0};
+    int *services = calloc((size_t) nrOfUris, sizeof(*services));
+    char (*requestUris)[BENCHMARK_MAX_URI_LENGTH] = calloc((size_t) nrOfUris, sizeof(*requestUris));
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < nrOfUris; ++i) {
+        char uri[BENCHMARK_MAX_URI_LENGTH];
+        int version = i / BENCHMARK_URIS_PER_VERSION;
+        int resource = i % BENCHMARK_URIS_PER_VERSION;
+        snprintf(uri, sizeof(uri), "/api/v%i/resource%i", version, resource);
+        addServiceNode(&tree, uri, &services[i]);
+        snprintf(requestUris[i], sizeof(requestUris[i]), "/api/v%i/resource%i/items/%i", version, resource, i);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double addTime = benchmark_elapsed(&start, &end);
+
+    benchmark_writer_t writer = {.tree = &tree, .running = true, .nrOfUpdates = 0};
+    benchmark_reader_t *readers = calloc((size_t) nrOfThreads, sizeof(*readers));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_create(&writer.thread, NULL, benchmark_writerRun, &writer);
+    for (int i = 0; i < nrOfThreads; ++i) {
+        readers[i].tree = &tree;
+        readers[i].requestUris = requestUris;
+        readers[i].nrOfUris = nrOfUris;
+        readers[i].nrOfLookups = nrOfLookups;
+        pthread_create(&readers[i].thread, NULL, benchmark_readerRun, &readers[i]);
+    }
+    long nrOfMisses = 0;
+    for (int i = 0; i < nrOfThreads; ++i) {
+        pthread_join(readers[i].thread, NULL);
+        nrOfMisses += readers[i].nrOfMisses;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    __atomic_store_n(&writer.running, false, __ATOMIC_RELAXED);
+    pthread_join(writer.thread, NULL);
+
+    double lookupTime = benchmark_elapsed(&start, &end);
+    double totalLookups = (double) nrOfLookups * nrOfThreads;
+    printf("uris=%i,threads=%i,lookups=%.0f,add_time_s=%.3f,lookup_time_s=%.3f,lookups_per_s=%.0f,misses=%li,updates=%li\n",
+           nrOfUris, nrOfThreads, totalLookups, addTime, lookupTime, totalLookups / lookupTime, nrOfMisses, writer.nrOfUpdates);
+
+    destroyServiceTree(&tree);
+    free(readers);
+    free(requestUris);
+    free(services);
+    return nrOfMisses == 0 ? 0 : 1;
+}
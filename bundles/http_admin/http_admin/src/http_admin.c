@@ -31,13 +31,26 @@
 
 #include "http_admin.h"
 #include "http_admin/api.h"
+#include "http_admin_constants.h"
 #include "service_tree.h"
 
 #include "civetweb.h"
 
 #include "celix_api.h"
 #include "celix_utils_api.h"
-
+#include "celix_version.h"
+#include "hash_map.h"
+#include "utils.h"
+
+
+//A http service in the service tree
+typedef struct http_admin_service_entry http_admin_service_entry_t;
+struct http_admin_service_entry {
+    char *uri;
+    celix_http_service_t *svc;
+    bool hasStreamingFunctions;         //Whether the service struct contains the streaming functions, see HTTP_ADMIN_SERVICE_VERSION
+    http_admin_service_entry_t *nextRetired;
+};
 
 struct http_admin_manager {
     celix_bundle_context_t *context;
@@ -49,9 +62,24 @@ struct http_admin_manager {
     celix_http_info_service_t infoSvc;
     long infoSvcId;
     celix_array_list_t *aliasList;      //Array list of http_alias_t
-    service_tree_t http_svc_tree;
+    service_tree_t http_svc_tree;       //Tree of http_admin_service_entry_t
+    hash_map_pt serviceEntries;         //Key = uri, value = http_admin_service_entry_t
+    http_admin_service_entry_t *retiredEntries; //Removed entries still used by the request which removed them
+
+    size_t streamBufferSize;            //Size of the per worker thread buffer used for streaming request bodies
 };
 
+//Data of a civetweb worker thread, see mg_get_thread_pointer
+typedef struct http_admin_thread_data {
+    char *streamBuffer;                 //Reused for all streaming requests handled by the thread, lazy allocated
+} http_admin_thread_data_t;
+
+typedef struct http_admin_body_reader_handle {
+    struct mg_connection *connection;
+    char *buffer;
+    size_t bufferSize;
+} http_admin_body_reader_handle_t;
+
 
 typedef struct http_alias {
     char *url;
@@ -65,6 +93,14 @@ static int http_request_handle(struct mg_connection *connection);
 static void httpAdmin_updateInfoSvc(http_admin_manager_t *admin);
 static void createAliasesSymlink(const char *aliases, const char *admin_root, const char *bundle_root, long bundle_id, celix_array_list_t *alias_list);
 static bool aliasList_containsAlias(celix_array_list_t *alias_list, const char *alias);
+static void *httpAdmin_initThread(const struct mg_context *ctx, int thread_type);
+static void httpAdmin_exitThread(const struct mg_context *ctx, int thread_type, void *thread_pointer);
+static bool httpAdmin_hasStreamingFunctions(const celix_properties_t *props);
+static void httpAdmin_freeServiceEntries(http_admin_service_entry_t *entries);
+static void httpAdmin_freeUnusedRetiredEntries(http_admin_manager_t *admin);
+static int httpAdmin_handleStreamRequest(http_admin_manager_t *admin, struct mg_connection *connection, const struct mg_request_info *ri,
+                                         int (*doStream)(void *handle, struct mg_connection *connection, const char *path, celix_http_body_reader_t *body),
+                                         void *handle);
 
 
 http_admin_manager_t *httpAdmin_create(celix_bundle_context_t *context, char *root, const char **svr_opts) {
@@ -77,13 +113,19 @@ http_admin_manager_t *httpAdmin_create(celix_bundle_context_t *context, char *ro
     admin->root = root;
     admin->infoSvcId = -1L;
 
+    long streamBufferSize = celix_bundleContext_getPropertyAsLong(context, HTTP_ADMIN_STREAM_BUFFER_SIZE_KEY, HTTP_ADMIN_STREAM_BUFFER_SIZE_DFT);
+    admin->streamBufferSize = streamBufferSize > 0 ? (size_t) streamBufferSize : (size_t) HTTP_ADMIN_STREAM_BUFFER_SIZE_DFT;
+
     status = celixThreadMutex_create(&admin->admin_lock, NULL);
     admin->aliasList = celix_arrayList_create();
+    admin->serviceEntries = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 
     if (status == CELIX_SUCCESS) {
-        //Use only begin_request callback
+        //Use begin_request callback and the thread callbacks for the per thread data
         memset(&callbacks, 0, sizeof(callbacks));
         callbacks.begin_request = http_request_handle;
+        callbacks.init_thread = httpAdmin_initThread;
+        callbacks.exit_thread = httpAdmin_exitThread;
 
         admin->mgCtx = mg_start(&callbacks, admin, svr_opts);
         status = (admin->mgCtx == NULL ? CELIX_BUNDLE_EXCEPTION : CELIX_SUCCESS);
@@ -103,6 +145,7 @@ http_admin_manager_t *httpAdmin_create(celix_bundle_context_t *context, char *ro
         celixThreadMutex_destroy(&admin->admin_lock);
 
         celix_arrayList_destroy(admin->aliasList);
+        hashMap_destroy(admin->serviceEntries, false, false);
         free(admin);
         admin = NULL;
     }
@@ -119,6 +162,14 @@ void httpAdmin_destroy(http_admin_manager_t *admin) {
     celix_bundleContext_unregisterService(admin->context, admin->infoSvcId);
 
     destroyServiceTree(&admin->http_svc_tree);
+    hash_map_iterator_t iter = hashMapIterator_construct(admin->serviceEntries);
+    while (hashMapIterator_hasNext(&iter)) {
+        http_admin_service_entry_t *entry = hashMapIterator_nextValue(&iter);
+        entry->nextRetired = admin->retiredEntries;
+        admin->retiredEntries = entry;
+    }
+    hashMap_destroy(admin->serviceEntries, false, false);
+    httpAdmin_freeServiceEntries(admin->retiredEntries);
 
     //Destroy alias map by removing symbolic links first.
     unsigned int size = celix_arrayList_size(admin->aliasList);
@@ -154,31 +205,39 @@ void http_admin_addHttpService(void *handle, void *svc, const celix_properties_t
     const char *uri = celix_properties_get(props, HTTP_ADMIN_URI, NULL);
 
     if(uri != NULL) {
+        http_admin_service_entry_t *entry = calloc(1, sizeof(*entry));
+        entry->uri = strdup(uri);
+        entry->svc = httpSvc;
+        entry->hasStreamingFunctions = httpAdmin_hasStreamingFunctions(props);
+
         celixThreadMutex_lock(&(admin->admin_lock));
-        if(!addServiceNode(&admin->http_svc_tree, uri, httpSvc)) {
+        if(addServiceNode(&admin->http_svc_tree, uri, entry)) {
+            hashMap_put(admin->serviceEntries, entry->uri, entry);
+        } else {
             printf("HTTP service with URI %s already exists!\n", uri);
+            httpAdmin_freeServiceEntries(entry);
         }
         celixThreadMutex_unlock(&(admin->admin_lock));
     }
 }
 
-void http_admin_removeHttpService(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props) {
+void http_admin_removeHttpService(void *handle, void *svc, const celix_properties_t *props) {
     http_admin_manager_t *admin = (http_admin_manager_t *) handle;
 
     const char *uri = celix_properties_get(props, HTTP_ADMIN_URI, NULL);
 
     if(uri != NULL) {
         celixThreadMutex_lock(&(admin->admin_lock));
-        service_tree_node_t *node = NULL;
-
-        node = findServiceNodeInTree(&admin->http_svc_tree, uri);
-
-        if(node != NULL){
-            destroyServiceNode(&admin->http_svc_tree, node, &admin->http_svc_tree.tree_node_count, &admin->http_svc_tree.tree_svc_count);
+        http_admin_service_entry_t *entry = hashMap_get(admin->serviceEntries, uri);
+        if(entry != NULL && entry->svc == svc && removeServiceNode(&admin->http_svc_tree, uri)) {
+            hashMap_remove(admin->serviceEntries, uri);
+            entry->nextRetired = admin->retiredEntries;
+            admin->retiredEntries = entry;
+            //removeServiceNode waited until no other request uses the removed entries anymore
+            httpAdmin_freeUnusedRetiredEntries(admin);
         } else {
             printf("Couldn't remove HTTP service with URI: %s, it doesn't exist\n", uri);
         }
-
         celixThreadMutex_unlock(&(admin->admin_lock));
     }
 }
@@ -189,7 +248,6 @@ int http_request_handle(struct mg_connection *connection) {
     if(connection != NULL) {
         const struct mg_request_info *ri = mg_get_request_info(connection);
         http_admin_manager_t *admin = (http_admin_manager_t *) ri->user_data;
-        service_tree_node_t *node = NULL;
 
         if(mg_get_header(connection, "Upgrade") != NULL) {
             //Assume this is a websocket request...
@@ -197,11 +255,12 @@ int http_request_handle(struct mg_connection *connection) {
         }
         else {
             const char *req_uri = ri->request_uri;
-            node = findServiceNodeInTree(&admin->http_svc_tree, req_uri);
+            service_tree_use_t use;
+            http_admin_service_entry_t *entry = useServiceInTree(&admin->http_svc_tree, req_uri, &use);
+            celix_http_service_t *httpSvc = entry != NULL ? entry->svc : NULL;
 
-            if(node != NULL) {
-                //Requested URI with node exists, now obtain the http service and call the requested function.
-                celix_http_service_t *httpSvc = (celix_http_service_t *) node->svc_data->service;
+            if(httpSvc != NULL) {
+                //Requested URI with a http service exists, call the requested function.
 
                 if (strcmp("GET", ri->request_method) == 0) {
                     if (httpSvc->doGet != NULL) {
@@ -216,7 +275,9 @@ int http_request_handle(struct mg_connection *connection) {
                         ret_status = 0; //Let civetweb handle the request
                     }
                 } else if (strcmp("POST", ri->request_method) == 0) {
-                    if (httpSvc->doPost != NULL) {
+                    if (entry->hasStreamingFunctions && httpSvc->doPostStream != NULL) {
+                        ret_status = httpAdmin_handleStreamRequest(admin, connection, ri, httpSvc->doPostStream, httpSvc->handle);
+                    } else if (httpSvc->doPost != NULL) {
                         int bytes_read = 0;
                         bool no_data = false;
                         char *rcv_buf = NULL;
@@ -245,7 +306,9 @@ int http_request_handle(struct mg_connection *connection) {
                     }
 
                 } else if (strcmp("PUT", ri->request_method) == 0) {
-                    if (httpSvc->doPut != NULL) {
+                    if (entry->hasStreamingFunctions && httpSvc->doPutStream != NULL) {
+                        ret_status = httpAdmin_handleStreamRequest(admin, connection, ri, httpSvc->doPutStream, httpSvc->handle);
+                    } else if (httpSvc->doPut != NULL) {
                         int bytes_read = 0;
                         bool no_data = false;
                         char *rcv_buf = NULL;
@@ -314,7 +377,9 @@ int http_request_handle(struct mg_connection *connection) {
                         ret_status = 0; //Let civetweb handle the request
                     }
                 } else if (strcmp("PATCH", ri->request_method) == 0) {
-                    if (httpSvc->doPatch != NULL) {
+                    if (entry->hasStreamingFunctions && httpSvc->doPatchStream != NULL) {
+                        ret_status = httpAdmin_handleStreamRequest(admin, connection, ri, httpSvc->doPatchStream, httpSvc->handle);
+                    } else if (httpSvc->doPatch != NULL) {
                         int bytes_read = 0;
                         bool no_data = false;
                         char *rcv_buf = NULL;
@@ -349,6 +414,7 @@ int http_request_handle(struct mg_connection *connection) {
             } else {
                 ret_status = 0; //Not found requested URI, let civetweb handle this situation
             }
+            releaseServiceInTree(&use);
         }
     } else {
         mg_send_http_error(connection, 400, "%s", "Bad request");
@@ -358,6 +424,105 @@ int http_request_handle(struct mg_connection *connection) {
     return ret_status;
 }
 
+static void *httpAdmin_initThread(const struct mg_context *ctx __attribute__((unused)), int thread_type) {
+    //Only the worker threads (thread_type 1) handle requests
+    return thread_type == 1 ? calloc(1, sizeof(http_admin_thread_data_t)) : NULL;
+}
+
+static void httpAdmin_exitThread(const struct mg_context *ctx __attribute__((unused)), int thread_type __attribute__((unused)), void *thread_pointer) {
+    http_admin_thread_data_t *data = thread_pointer;
+    if (data != NULL) {
+        free(data->streamBuffer);
+        free(data);
+    }
+}
+
+static bool httpAdmin_hasStreamingFunctions(const celix_properties_t *props) {
+    bool result = false;
+    const char *versionStr = celix_properties_get(props, CELIX_FRAMEWORK_SERVICE_VERSION, NULL);
+    celix_version_t *version = versionStr != NULL ? celix_version_createVersionFromString(versionStr) : NULL;
+    if (version != NULL) {
+        result = celix_version_compareToMajorMinor(version, 1, 1) >= 0;
+        celix_version_destroy(version);
+    }
+    return result;
+}
+
+static void httpAdmin_freeServiceEntries(http_admin_service_entry_t *entries) {
+    while (entries != NULL) {
+        http_admin_service_entry_t *entry = entries;
+        entries = entry->nextRetired;
+        free(entry->uri);
+        free(entry);
+    }
+}
+
+/**
+ * Frees the retired entries, except the entries used by the current thread (services removed from their own
+ * request callback), these are freed by a later remove or at destroy.
+ */
+static void httpAdmin_freeUnusedRetiredEntries(http_admin_manager_t *admin) {
+    http_admin_service_entry_t **current = &admin->retiredEntries;
+    while (*current != NULL) {
+        http_admin_service_entry_t *entry = *current;
+        if (isServiceInTreeUsedByCurrentThread(entry)) {
+            current = &entry->nextRetired;
+        } else {
+            *current = entry->nextRetired;
+            entry->nextRetired = NULL;
+            httpAdmin_freeServiceEntries(entry);
+        }
+    }
+}
+
+static int httpAdmin_readBodyChunk(void *handle, const char **data) {
+    http_admin_body_reader_handle_t *reader = handle;
+    int bytes_read = mg_read(reader->connection, reader->buffer, reader->bufferSize);
+    *data = bytes_read > 0 ? reader->buffer : NULL;
+    return bytes_read;
+}
+
+static int httpAdmin_handleStreamRequest(http_admin_manager_t *admin, struct mg_connection *connection, const struct mg_request_info *ri,
+                                         int (*doStream)(void *handle, struct mg_connection *connection, const char *path, celix_http_body_reader_t *body),
+                                         void *handle) {
+    http_admin_thread_data_t *threadData = mg_get_thread_pointer(connection);
+    char *buffer = NULL;
+    if (threadData != NULL) {
+        if (threadData->streamBuffer == NULL) {
+            threadData->streamBuffer = malloc(admin->streamBufferSize);
+        }
+        buffer = threadData->streamBuffer;
+    } else {
+        buffer = malloc(admin->streamBufferSize); //Note should not happen, requests are handled by worker threads
+    }
+    if (buffer == NULL) {
+        mg_send_http_error(connection, 500, "%s", "Internal Server Error");
+        return 500;
+    }
+
+    http_admin_body_reader_handle_t readerHandle;
+    readerHandle.connection = connection;
+    readerHandle.buffer = buffer;
+    readerHandle.bufferSize = admin->streamBufferSize;
+
+    celix_http_body_reader_t reader;
+    reader.handle = &readerHandle;
+    reader.contentLength = ri->content_length;
+    reader.read = httpAdmin_readBodyChunk;
+
+    int ret_status = doStream(handle, connection, ri->request_uri, &reader);
+
+    //Discard the unread part of the body, so that the next request on the connection can be read
+    while (mg_read(connection, buffer, admin->streamBufferSize) > 0) {
+        //nop
+    }
+
+    if (threadData == NULL) {
+        free(buffer);
+    }
+    return ret_status;
+}
+
 static void httpAdmin_updateInfoSvc(http_admin_manager_t *admin) {
     const char *ports = mg_get_option(admin->mgCtx, "listening_ports");
 
@@ -39,5 +39,8 @@
 #define HTTP_ADMIN_NUM_THREADS_KEY              "CELIX_HTTP_ADMIN_NUM_THREADS"
 #define HTTP_ADMIN_NUM_THREADS_DFT              1L
 
+#define HTTP_ADMIN_STREAM_BUFFER_SIZE_KEY       "CELIX_HTTP_ADMIN_STREAM_BUFFER_SIZE"
+#define HTTP_ADMIN_STREAM_BUFFER_SIZE_DFT       65536L
+
 
 #endif //CELIX_HTTP_ADMIN_CONSTANTS_H
@@ -26,332 +26,467 @@
 
 #include <stdlib.h>
 #include <stdbool.h> //for `bool`
-#include <stdio.h>   //for `asprintf`
-#include <memory.h>  //for `strcmp` and `strtok_r`
+#include <string.h>  //for `memcmp`, `memcpy` and `strlen`
+#include <unistd.h>  //for `usleep`
 
 #include "service_tree.h"
 
-//Local function prototypes
-static service_tree_node_t *createServiceNode(service_tree_node_t *parent, service_tree_node_t *children, service_tree_node_t *next, service_tree_node_t *prev, const char *uri, void *svc);
-static size_t getUriTokenCount(const char *uri, const char *separator);
+//Interval in which a remove checks whether a removed service is still used
+#define SERVICE_TREE_USE_WAIT_US 1000
+
+struct service_tree_entry {
+    void *service;
+    unsigned int use_count;     //Number of active uses, see useServiceInTree (atomic access)
+    bool removed;               //Whether the service is removed, after which no new uses are started (atomic access)
+    bool unreachable;           //Whether no reader can find the entry anymore, only used by the writers
+    service_tree_entry_t *next_retired;
+};
+
+typedef struct service_tree_route {
+    const char *segment;        //Points into the segments of the snapshot
+    size_t segment_len;
+    service_tree_entry_t *entry;
+    size_t first_child;         //Index of the first child, the children of a route are stored consecutive
+    size_t children_count;
+} service_tree_route_t;
+
+struct service_tree_snapshot {
+    size_t route_count;
+    service_tree_route_t *routes;   //routes[0] is the root, stored in the same allocation as the snapshot
+    char *segments;                 //Segments of all routes, stored in the same allocation as the snapshot
+    service_tree_snapshot_t *next_retired;
+};
 
+//Local function prototypes
+static int compareSegment(const char *seg1, size_t len1, const char *seg2, size_t len2);
+static const char *nextSegment(const char *uri, size_t *len);
+static service_tree_node_t *createServiceNode(const char *segment, size_t segment_len);
+static void destroyServiceNodes(service_tree_node_t *node);
+static long findChildIndex(service_tree_node_t *parent, const char *segment, size_t segment_len);
+static service_tree_node_t *getOrCreateChild(service_tree_t *svc_tree, service_tree_node_t *parent, const char *segment, size_t segment_len);
+static bool removeFromNode(service_tree_t *svc_tree, service_tree_node_t *node, const char *uri, service_tree_entry_t **removed);
+static service_tree_snapshot_t *createSnapshot(service_tree_t *svc_tree);
+static celix_rcu_t *getServiceTreeRcu(service_tree_t *svc_tree);
+static void publishSnapshot(service_tree_t *svc_tree);
+static void freeRetiredEntries(service_tree_t *svc_tree, bool all);
+static service_tree_entry_t *findEntryInTree(service_tree_t *svc_tree, const char *uri);
+static unsigned int countThreadUses(service_tree_entry_t *entry);
+
+//The services used by the current thread, see useServiceInTree
+static __thread service_tree_use_t *threadUses = NULL;
+
+
+static int compareSegment(const char *seg1, size_t len1, const char *seg2, size_t len2) {
+    int cmp = memcmp(seg1, seg2, len1 < len2 ? len1 : len2);
+    if (cmp == 0) {
+        cmp = len1 < len2 ? -1 : (len1 > len2 ? 1 : 0);
+    }
+    return cmp;
+}
 
+/**
+ * Returns the start of the next segment in the uri (skipping '/' separators) and sets len to the length of
+ * the segment. Returns NULL if there are no more segments.
+ */
+static const char *nextSegment(const char *uri, size_t *len) {
+    while (*uri == '/') {
+        ++uri;
+    }
+    if (*uri == '\0') {
+        return NULL;
+    }
+    const char *end = uri;
+    while (*end != '/' && *end != '\0') {
+        ++end;
+    }
+    *len = (size_t) (end - uri);
+    return uri;
+}
 
-static service_tree_node_t *createServiceNode(service_tree_node_t *parent, service_tree_node_t *children, service_tree_node_t *next, service_tree_node_t *prev, const char *uri, void *svc) {
+static service_tree_node_t *createServiceNode(const char *segment, size_t segment_len) {
     service_tree_node_t *node = calloc(1, sizeof(service_tree_node_t));
-    node->parent = parent;
-    node->children = children;
-    node->next = next;
-    node->prev = prev;
-    node->svc_data = calloc(1, sizeof(service_node_data_t));
-    node->svc_data->sub_uri = (uri != NULL ? strdup(uri) : NULL);
-    node->svc_data->service = svc;
+    node->segment = malloc(segment_len + 1);
+    memcpy(node->segment, segment, segment_len);
+    node->segment[segment_len] = '\0';
+    node->segment_len = segment_len;
     return node;
 }
 
-static size_t getUriTokenCount(const char *uri, const char *separator) {
-    char *saveptr, *token;
-    char *uri_cpy = strdup(uri);
-    size_t tokenCount = 0;
+static void destroyServiceNodes(service_tree_node_t *node) {
+    if (node != NULL) {
+        for (size_t i = 0; i < node->children_count; ++i) {
+            destroyServiceNodes(node->children[i]);
+        }
+        free(node->children);
+        free(node->segment);
+        free(node->entry);
+        free(node);
+    }
+}
 
-    token = strtok_r(uri_cpy, separator, &saveptr);
-    while(token != NULL) {
-        tokenCount++;
-        token = strtok_r(NULL, separator, &saveptr);
+/**
+ * Binary search for the child with the provided segment. Returns the index of the child or, if not found,
+ * the index where the child should be inserted as negative value - 1.
+ */
+static long findChildIndex(service_tree_node_t *parent, const char *segment, size_t segment_len) {
+    long low = 0;
+    long high = (long) parent->children_count - 1;
+    while (low <= high) {
+        long mid = (low + high) / 2;
+        service_tree_node_t *child = parent->children[mid];
+        int cmp = compareSegment(child->segment, child->segment_len, segment, segment_len);
+        if (cmp == 0) {
+            return mid;
+        } else if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -(low + 1);
+}
+
+static service_tree_node_t *getOrCreateChild(service_tree_t *svc_tree, service_tree_node_t *parent, const char *segment, size_t segment_len) {
+    long index = findChildIndex(parent, segment, segment_len);
+    if (index >= 0) {
+        return parent->children[index];
     }
 
-    free(uri_cpy);
-    return tokenCount;
+    size_t insertAt = (size_t) (-index - 1);
+    if (parent->children_count == parent->children_capacity) {
+        parent->children_capacity = parent->children_capacity == 0 ? 4 : parent->children_capacity * 2;
+        parent->children = realloc(parent->children, parent->children_capacity * sizeof(service_tree_node_t *));
+    }
+    memmove(&parent->children[insertAt + 1], &parent->children[insertAt], (parent->children_count - insertAt) * sizeof(service_tree_node_t *));
+    service_tree_node_t *child = createServiceNode(segment, segment_len);
+    parent->children[insertAt] = child;
+    parent->children_count++;
+    svc_tree->tree_node_count++;
+    svc_tree->tree_segments_size += segment_len;
+    return child;
 }
 
 bool addServiceNode(service_tree_t *svc_tree, const char *uri, void *svc) {
-    char *save_ptr = NULL; //Used internally by strtok_r
-    char *uri_cpy = NULL;
-    char *req_uri = NULL;
-    bool uri_exists = true;
-    size_t tokenCount = getUriTokenCount(uri, "/");
-    size_t subNodeCount = 1;
-
-    if(svc_tree == NULL || uri == NULL){
+    if (svc_tree == NULL || uri == NULL || svc == NULL) {
         return false;
     }
 
-    if(strcmp(uri, "/") == 0 ) {
-        //Create the root URI
-        if(svc_tree->root_node == NULL) { //No service yet added
-            svc_tree->root_node = createServiceNode(NULL, NULL, NULL, NULL, "root", svc);
-            svc_tree->tree_node_count = 1;
-            uri_exists = false;
-        } else if(strcmp(svc_tree->root_node->svc_data->sub_uri, "root") != 0) {
-            service_tree_node_t *node = createServiceNode(NULL, svc_tree->root_node, NULL, NULL, "root", svc);
-            //Set this new node as parent for the first line of nodes
-            service_tree_node_t *tmp = svc_tree->root_node;
-            while(tmp != NULL){
-                tmp->parent = node;
-                tmp = tmp->next;
-            }
-            svc_tree->root_node->parent = node;
-            svc_tree->root_node = node; //Set new root
-            svc_tree->tree_node_count++;
-            uri_exists = false;
-        }
-        //Else root already exists
-    } else if(svc_tree->root_node == NULL) { //No service yet added
-        uri_cpy = strdup(uri);
-        req_uri = strtok_r(uri_cpy, "/", &save_ptr);
-        svc_tree->root_node = createServiceNode(NULL, NULL, NULL, NULL, req_uri, (tokenCount == 1 ? svc : NULL));
+    if (svc_tree->root_node == NULL) {
+        svc_tree->root_node = createServiceNode("", 0);
         svc_tree->tree_node_count = 1;
-        uri_exists = false;
-    } else if(strcmp(svc_tree->root_node->svc_data->sub_uri, "root") == 0){
-        asprintf(&uri_cpy, "%s%s", "root", uri);
-        req_uri = strtok_r(uri_cpy, "/", &save_ptr);
-    } else {
-        uri_cpy = strdup(uri);
-        req_uri = strtok_r(uri_cpy, "/", &save_ptr);
     }
 
     service_tree_node_t *current = svc_tree->root_node;
-    service_node_data_t *current_data = current->svc_data;
-    while (req_uri != NULL && subNodeCount <= tokenCount) {
-        bool is_last_entry = (tokenCount == subNodeCount);
-        if (strcmp(current_data->sub_uri, req_uri) == 0) {
-            if (is_last_entry) {
-                //Entry already exists/added in tree
-                if (current_data->service == NULL) {
-                    //When no service added yet, add the current. Because there can already be sub URIs registered
-                    //as children for this URI. No extra node is added, because the node already exists
-                    current_data->service = svc;
-                    uri_exists = false;
-                }
-                req_uri = strtok_r(NULL, "/", &save_ptr);
-            } else if (current->children != NULL) {
-                //Found the parent of the URI, keep searching in the children for sub URIs
-                current = current->children;
-                current_data = current->svc_data;
-                req_uri = strtok_r(NULL, "/", &save_ptr);
-            } else {
-                //Parent has no sub URIs registered yet
-                req_uri = strtok_r(NULL, "/", &save_ptr);
-                //Create svc node without svc pointer, this will be added later if needed.
-                service_tree_node_t *node = createServiceNode(current, NULL, NULL, NULL, req_uri, NULL);
-                current->children = node;
-                current = node;
-                current_data = node->svc_data;
-                svc_tree->tree_node_count++;
-                uri_exists = false;
-            }
-            subNodeCount++;
-        } else if (current->next != NULL) {
-            current = current->next;
-            current_data = current->svc_data;
-        } else {
-            //Not found, so create this URI (tree)
-            service_tree_node_t *node = createServiceNode(current->parent, NULL, NULL, current,
-                                                          req_uri, (is_last_entry ? svc : NULL));
-            current->next = node;
-            current = node;
-            current_data = node->svc_data;
-            svc_tree->tree_node_count++;
-            uri_exists = false;
-            subNodeCount++;
-        }
+    size_t len = 0;
+    const char *segment = nextSegment(uri, &len);
+    while (segment != NULL) {
+        current = getOrCreateChild(svc_tree, current, segment, len);
+        segment = nextSegment(segment + len, &len);
     }
 
-    //Increment tree service count if URI exists (only one service can be added at once)
-    if(!uri_exists) {
+    bool added = current->entry == NULL;
+    if (added) {
+        current->entry = calloc(1, sizeof(service_tree_entry_t));
+        current->entry->service = svc;
         svc_tree->tree_svc_count++;
+        publishSnapshot(svc_tree);
     }
+    return added;
+}
 
-    if(uri_cpy) {
-        free(uri_cpy);
+/**
+ * Removes the service for the uri from the subtree of node. Returns whether node itself can be removed
+ * (no service and no children left).
+ */
+static bool removeFromNode(service_tree_t *svc_tree, service_tree_node_t *node, const char *uri, service_tree_entry_t **removed) {
+    size_t len = 0;
+    const char *segment = nextSegment(uri, &len);
+    if (segment == NULL) {
+        if (node->entry != NULL) {
+            *removed = node->entry;
+            node->entry = NULL;
+            svc_tree->tree_svc_count--;
+        }
+    } else {
+        long index = findChildIndex(node, segment, len);
+        if (index >= 0) {
+            service_tree_node_t *child = node->children[index];
+            if (removeFromNode(svc_tree, child, segment + len, removed)) {
+                memmove(&node->children[index], &node->children[index + 1], (node->children_count - index - 1) * sizeof(service_tree_node_t *));
+                node->children_count--;
+                svc_tree->tree_node_count--;
+                svc_tree->tree_segments_size -= child->segment_len;
+                destroyServiceNodes(child);
+            }
+        }
     }
-
-    return !uri_exists;
+    return node->entry == NULL && node->children_count == 0;
 }
 
-void destroyChildrenFromServiceNode(service_tree_node_t *parent, int *tree_item_count, int *tree_svc_count) {
-    if(parent != NULL && tree_item_count != NULL && tree_svc_count != NULL){
-        service_tree_node_t *child = parent->children;
-        while(child != NULL) {
-            if (child->children != NULL) {
-                //Delete children first
-                destroyChildrenFromServiceNode(child, tree_item_count, tree_svc_count);
-
-            } else {
-                //Delete child first
-                service_tree_node_t *next_child = child->next;
-
-                if(child->svc_data != NULL) {
-                    //Decrement service count if a service was present
-                    if(child->svc_data->service != NULL) (*tree_svc_count)--;
-                    free(child->svc_data->sub_uri);
-                    free(child->svc_data);
-                }
-                free(child);
-                (*tree_item_count)--;
-                child = next_child;
+bool removeServiceNode(service_tree_t *svc_tree, const char *uri) {
+    service_tree_entry_t *removed = NULL;
+    if (svc_tree != NULL && uri != NULL && svc_tree->root_node != NULL) {
+        if (removeFromNode(svc_tree, svc_tree->root_node, uri, &removed)) {
+            destroyServiceNodes(svc_tree->root_node);
+            svc_tree->root_node = NULL;
+            svc_tree->tree_node_count = 0;
+            svc_tree->tree_segments_size = 0;
+        }
+        if (removed != NULL) {
+            __atomic_store_n(&removed->removed, true, __ATOMIC_SEQ_CST);
+            removed->next_retired = svc_tree->retired_entries;
+            svc_tree->retired_entries = removed;
+            publishSnapshot(svc_tree);
+
+            //Wait until the service is no longer used by other threads
+            unsigned int ownUses = countThreadUses(removed);
+            while (__atomic_load_n(&removed->use_count, __ATOMIC_SEQ_CST) > ownUses) {
+                usleep(SERVICE_TREE_USE_WAIT_US);
             }
+            freeRetiredEntries(svc_tree, false);
         }
-        parent->children = NULL;
     }
+    return removed != NULL;
 }
 
-void destroyServiceNode(service_tree_t *svc_tree, service_tree_node_t *node, int *tree_item_count, int *tree_svc_count) {
-    if(node != NULL && tree_item_count != NULL && tree_svc_count != NULL) {
-        bool has_underlaying_services = false;
-
-        //If this service node has children then check if we need to destroy them first
-        if(node->children != NULL) {
-            service_tree_node_t *node_cpy = node;
-            while(node_cpy->children != NULL && has_underlaying_services == false) {
-                service_tree_node_t *node_cpy_horizontal = node_cpy->children;
-                has_underlaying_services |= (node_cpy_horizontal->svc_data->service != NULL);
-                while(node_cpy_horizontal->next != NULL && has_underlaying_services == false) {
-                    has_underlaying_services |= (node_cpy_horizontal->svc_data->service != NULL);
-                    node_cpy_horizontal = node_cpy_horizontal->next;
-                }
-                node_cpy = node_cpy->children;
-            }
+/**
+ * Creates a compact copy of the tree in a single allocation. The routes are stored breadth first, so that the
+ * children of a route are stored consecutive and (as in the tree) sorted on segment.
+ */
+static service_tree_snapshot_t *createSnapshot(service_tree_t *svc_tree) {
+    if (svc_tree->root_node == NULL) {
+        return NULL;
+    }
 
-            //No underlaying services means we can delete all children
-            if(!has_underlaying_services) {
-                destroyChildrenFromServiceNode(node, tree_item_count, tree_svc_count);
-            }
+    size_t count = (size_t) svc_tree->tree_node_count;
+    size_t size = sizeof(service_tree_snapshot_t) + count * sizeof(service_tree_route_t) + svc_tree->tree_segments_size;
+    service_tree_snapshot_t *snapshot = calloc(1, size);
+    snapshot->route_count = count;
+    snapshot->routes = (service_tree_route_t *) (snapshot + 1);
+    snapshot->segments = (char *) (snapshot->routes + count);
+
+    service_tree_node_t **queue = malloc(count * sizeof(service_tree_node_t *));
+    size_t queued = 1;
+    size_t segmentsOffset = 0;
+    queue[0] = svc_tree->root_node;
+    for (size_t i = 0; i < queued; ++i) {
+        service_tree_node_t *node = queue[i];
+        service_tree_route_t *route = &snapshot->routes[i];
+        memcpy(snapshot->segments + segmentsOffset, node->segment, node->segment_len);
+        route->segment = snapshot->segments + segmentsOffset;
+        route->segment_len = node->segment_len;
+        route->entry = node->entry;
+        route->first_child = queued;
+        route->children_count = node->children_count;
+        segmentsOffset += node->segment_len;
+        for (size_t c = 0; c < node->children_count; ++c) {
+            queue[queued++] = node->children[c];
         }
+    }
+    free(queue);
 
-        //Decrement service count if a service was present
-        if(node->svc_data->service != NULL) {
-            node->svc_data->service = NULL;
-            (*tree_svc_count)--;
-        }
+    return snapshot;
+}
 
-        //When no underlaying services found, we have to take care of some pointers and memory...
-        if(!has_underlaying_services){
-            //Set new children pointer for parent when this is the first child in the tree.
-            //When no next is present the children pointer should become NULL.
-            if(node->parent != NULL && node->prev == NULL){
-                node->parent->children = node->next;
-            }
+/**
+ * Returns the rcu of the tree, creates it if needed so that a zeroed service_tree_t stays a valid empty tree.
+ */
+static celix_rcu_t *getServiceTreeRcu(service_tree_t *svc_tree) {
+    celix_rcu_t *rcu = __atomic_load_n(&svc_tree->rcu, __ATOMIC_ACQUIRE);
+    if (rcu == NULL) {
+        celix_rcu_t *created = celix_rcu_create();
+        if (__atomic_compare_exchange_n(&svc_tree->rcu, &rcu, created, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            rcu = created;
+        } else {
+            celix_rcu_destroy(created); //Created concurrently by another thread
+        }
+    }
+    return rcu;
+}
 
-            //If current node to delete is the root node, set new root node pointer
-            if(svc_tree->root_node == node) {
-                svc_tree->root_node = node->next;
-            }
+static void publishSnapshot(service_tree_t *svc_tree) {
+    service_tree_snapshot_t *snapshot = createSnapshot(svc_tree);
+    service_tree_snapshot_t *old = __atomic_exchange_n(&svc_tree->snapshot, snapshot, __ATOMIC_SEQ_CST);
+    if (old == NULL) {
+        return;
+    }
 
-            //Set new previous pointer for the next node if present.
-            if(node->next != NULL) {
-                node->next->prev = node->prev;
-            }
+    celix_rcu_t *rcu = getServiceTreeRcu(svc_tree);
+    if (celix_rcu_inReadSection(rcu)) {
+        //Called from a read section, cannot wait on ourselves. Freed by a later writer.
+        old->next_retired = svc_tree->retired;
+        svc_tree->retired = old;
+        return;
+    }
 
-            //Set new next pointer if a previous is present
-            if(node->prev != NULL) {
-                node->prev->next = node->next;
-            }
+    celix_rcu_synchronize(rcu);
+    free(old);
+    while (svc_tree->retired != NULL) {
+        service_tree_snapshot_t *retired = svc_tree->retired;
+        svc_tree->retired = retired->next_retired;
+        free(retired);
+    }
+    for (service_tree_entry_t *entry = svc_tree->retired_entries; entry != NULL; entry = entry->next_retired) {
+        entry->unreachable = true;
+    }
+}
 
-            free(node->svc_data->sub_uri);
-            free(node->svc_data);
-            free(node);
-            (*tree_item_count)--;
+/**
+ * Frees the retired entries which cannot be found or used anymore, or all retired entries.
+ */
+static void freeRetiredEntries(service_tree_t *svc_tree, bool all) {
+    service_tree_entry_t **current = &svc_tree->retired_entries;
+    while (*current != NULL) {
+        service_tree_entry_t *entry = *current;
+        if (all || (entry->unreachable && __atomic_load_n(&entry->use_count, __ATOMIC_SEQ_CST) == 0)) {
+            *current = entry->next_retired;
+            free(entry);
+        } else {
+            current = &entry->next_retired;
         }
     }
 }
 
 void destroyServiceTree(service_tree_t *svc_tree) {
-    if(svc_tree != NULL) {
-        if(svc_tree->tree_node_count > 0 && svc_tree->root_node != NULL) {
-            service_tree_node_t *current = svc_tree->root_node;
-
-            while(current != NULL) {
-                destroyChildrenFromServiceNode(current, &svc_tree->tree_node_count, &svc_tree->tree_svc_count);
-
-                service_tree_node_t *next = current->next;
-                if(current->svc_data != NULL) {
-                    if(current->svc_data->service != NULL) svc_tree->tree_svc_count--;
-                    free(current->svc_data->sub_uri);
-                    free(current->svc_data);
-                }
-                free(current);
-
-                //Iterate to next node in similar level as root node
-                current = next;
+    if (svc_tree != NULL) {
+        service_tree_snapshot_t *snapshot = __atomic_exchange_n(&svc_tree->snapshot, NULL, __ATOMIC_SEQ_CST);
+        celix_rcu_t *rcu = __atomic_exchange_n(&svc_tree->rcu, NULL, __ATOMIC_SEQ_CST);
+        if (rcu != NULL) {
+            if (!celix_rcu_inReadSection(rcu)) {
+                celix_rcu_synchronize(rcu);
             }
-
-            svc_tree->tree_node_count = 0;
-            svc_tree->tree_svc_count = 0;
-            svc_tree->root_node = NULL;
+            celix_rcu_destroy(rcu);
+        }
+        free(snapshot);
+        while (svc_tree->retired != NULL) {
+            service_tree_snapshot_t *retired = svc_tree->retired;
+            svc_tree->retired = retired->next_retired;
+            free(retired);
         }
+        freeRetiredEntries(svc_tree, true);
+
+        destroyServiceNodes(svc_tree->root_node);
+        svc_tree->root_node = NULL;
+        svc_tree->tree_node_count = 0;
+        svc_tree->tree_svc_count = 0;
+        svc_tree->tree_segments_size = 0;
     }
 }
 
+int beginServiceTreeRead(service_tree_t *svc_tree) {
+    return celix_rcu_beginRead(getServiceTreeRcu(svc_tree));
+}
 
-service_tree_node_t *findServiceNodeInTree(service_tree_t *svc_tree, const char *uri) {
-    service_tree_node_t *found_node = NULL;
-    service_tree_node_t *current = NULL;
-    char *save_ptr; //Pointer used internally by strtok_r to point to next token
-    char *uri_cpy;
-    bool tree_not_empty = false;
+void endServiceTreeRead(service_tree_t *svc_tree, int token) {
+    celix_rcu_endRead(__atomic_load_n(&svc_tree->rcu, __ATOMIC_ACQUIRE), token);
+}
 
-    if(svc_tree != NULL && uri != NULL) {
-        tree_not_empty = ((bool) (svc_tree->tree_svc_count | svc_tree->tree_node_count)
-                               & (svc_tree->root_node != NULL));
-        current = svc_tree->root_node;
-    }
+void *findServiceInTree(service_tree_t *svc_tree, const char *uri) {
+    service_tree_entry_t *entry = findEntryInTree(svc_tree, uri);
+    return entry != NULL ? entry->service : NULL;
+}
 
-    if(tree_not_empty){
-        if(strcmp(current->svc_data->sub_uri, "root") == 0)
-        {
-            asprintf(&uri_cpy, "%s%s", "root", uri);
+void *useServiceInTree(service_tree_t *svc_tree, const char *uri, service_tree_use_t *use) {
+    use->entry = NULL;
+    int readToken = beginServiceTreeRead(svc_tree);
+    service_tree_entry_t *entry = findEntryInTree(svc_tree, uri);
+    if (entry != NULL) {
+        //A remove sets removed before it waits for the uses, so either the remove waits or the use is not started
+        __atomic_add_fetch(&entry->use_count, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&entry->removed, __ATOMIC_SEQ_CST)) {
+            __atomic_sub_fetch(&entry->use_count, 1, __ATOMIC_SEQ_CST);
         } else {
-            uri_cpy = strdup(uri);
+            use->entry = entry;
         }
+    }
+    endServiceTreeRead(svc_tree, readToken);
 
-        char *uri_token = strtok_r(uri_cpy, "/", &save_ptr);
-        //Check for horizontal matches for the first token
-        while(current != NULL) {
-            if(strcmp(current->svc_data->sub_uri, uri_token) == 0){
-                //Save current node to comply with OSGI Http Whiteboard Specification
-                if(current->svc_data->service != NULL) {
-                    found_node = current;
-                }
-                break; //Break out of while loop, keep 'current' pointer
-            } else {
-                current = current->next;
-            }
+    if (use->entry == NULL) {
+        return NULL;
+    }
+    use->next = threadUses;
+    threadUses = use;
+    return use->entry->service;
+}
+
+void releaseServiceInTree(service_tree_use_t *use) {
+    if (use->entry == NULL) {
+        return;
+    }
+    service_tree_use_t **current = &threadUses;
+    while (*current != NULL && *current != use) {
+        current = &(*current)->next;
+    }
+    if (*current != NULL) {
+        *current = use->next;
+    }
+    //Note that the entry can be freed directly after the use count is decreased
+    __atomic_sub_fetch(&use->entry->use_count, 1, __ATOMIC_SEQ_CST);
+    use->entry = NULL;
+}
+
+bool isServiceInTreeUsedByCurrentThread(const void *svc) {
+    for (service_tree_use_t *use = threadUses; use != NULL; use = use->next) {
+        if (use->entry->service == svc) {
+            return true;
         }
+    }
+    return false;
+}
+
+static unsigned int countThreadUses(service_tree_entry_t *entry) {
+    unsigned int count = 0;
+    for (service_tree_use_t *use = threadUses; use != NULL; use = use->next) {
+        if (use->entry == entry) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static service_tree_entry_t *findEntryInTree(service_tree_t *svc_tree, const char *uri) {
+    if (svc_tree == NULL || uri == NULL) {
+        return NULL;
+    }
+
+    service_tree_snapshot_t *snapshot = __atomic_load_n(&svc_tree->snapshot, __ATOMIC_SEQ_CST);
+    if (snapshot == NULL) {
+        return NULL;
+    }
 
-        //Check also in vertical direction for the remaining tokens
-        if(current != NULL) {
-            uri_token = strtok_r(NULL, "/", &save_ptr);
-            if(uri_token != NULL && current->children != NULL){
-                current = current->children;
-                while(current != NULL) {
-                    //Match for current sub URI with URI token
-                    if (current->svc_data->sub_uri != NULL && strcmp(current->svc_data->sub_uri, uri_token) == 0) {
-                        //Save current node to comply with OSGI Http Whiteboard Specification
-                        if(current->svc_data->service != NULL) {
-                            found_node = current;
-                        }
-
-                        uri_token = strtok_r(NULL, "/", &save_ptr);
-                        if(uri_token != NULL && current->children != NULL) {
-                            current = current->children;
-                        }
-                        else {
-                            break; //Break out of while loop since URI token can still have a value
-                        }
-                    } else {
-                        current = current->next;
-                    }
-                }
-                //No more tokens left, save this node when a service is present
-            } else if (uri_token == NULL && current->svc_data->service != NULL) {
-                found_node = current;
+    const service_tree_route_t *current = &snapshot->routes[0];
+    service_tree_entry_t *found = current->entry; //Service of the root ("/") URI, if present
+    size_t len = 0;
+    const char *segment = nextSegment(uri, &len);
+    while (segment != NULL && current->children_count > 0) {
+        //Binary search in the (sorted) children of the current route
+        const service_tree_route_t *children = &snapshot->routes[current->first_child];
+        const service_tree_route_t *match = NULL;
+        size_t low = 0;
+        size_t high = current->children_count;
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            int cmp = compareSegment(children[mid].segment, children[mid].segment_len, segment, len);
+            if (cmp == 0) {
+                match = &children[mid];
+                break;
+            } else if (cmp < 0) {
+                low = mid + 1;
+            } else {
+                high = mid;
             }
-            //Else we haven't found a node that complies with the requested URI...
         }
 
-        free(uri_cpy);
+        if (match == NULL) {
+            break;
+        }
+        current = match;
+        if (current->entry != NULL) {
+            //Keep the most specific match to comply with OSGI Http Whiteboard Specification
+            found = current->entry;
+        }
+        segment = nextSegment(segment + len, &len);
     }
 
-    return found_node;
+    return found;
 }
@@ -27,34 +27,94 @@
 #ifndef SERVICE_TREE_H
 #define SERVICE_TREE_H
 
-//Type declarations
-typedef struct service_tree_node service_tree_node_t;
+#include <stdbool.h>
+#include <stddef.h>
 
-typedef struct service_node_data {
-    char *sub_uri;
-    void *service;
-} service_node_data_t;
+#include "celix_rcu.h"
+
+/**
+ * The service tree is a router for URIs to services.
+ *
+ * The URIs are split on '/' into segments and stored in a trie (the service nodes), which is only used by the
+ * writers (add/remove). After every change a compact, immutable snapshot of the trie is created and published.
+ * A lookup is done on the published snapshot, in place on the requested URI (no copy) and without taking a lock.
+ * Lookups must be done between a beginServiceTreeRead/endServiceTreeRead pair and the found service can be used
+ * until endServiceTreeRead. A remove of a service waits until all readers, which can still see the service, are done.
+ * To use a service outside of a read section (e.g. during a request callback), use useServiceInTree and
+ * releaseServiceInTree. A remove of a service also waits until the service is no longer used by other threads.
+ *
+ * Adding and removing services must be serialized by the caller.
+ * Note that a service_tree_t zeroed struct is a valid empty tree.
+ */
 
+//Type declarations
+typedef struct service_tree_node service_tree_node_t;
+typedef struct service_tree_snapshot service_tree_snapshot_t;
+typedef struct service_tree_entry service_tree_entry_t;
 
 struct service_tree_node {
-    service_node_data_t *svc_data;
-    service_tree_node_t *next;
-    service_tree_node_t *prev;
-    service_tree_node_t *parent;
-    service_tree_node_t *children;
+    char *segment;                  //URI segment of this node, "" for the root node
+    size_t segment_len;
+    service_tree_entry_t *entry;    //Entry of the service registered for the URI ending in this node, NULL if not present
+    size_t children_count;
+    size_t children_capacity;
+    service_tree_node_t **children; //Children sorted on segment
 };
 
 typedef struct service_tree {
     int tree_svc_count;             //Count for number of services in the tree (not number of nodes)
     int tree_node_count;            //Count for number of nodes (tree_node_count != tree_svc_count)
-    service_tree_node_t *root_node; //Pointer to first item
+    size_t tree_segments_size;      //Total size of all node segments
+    service_tree_node_t *root_node; //Pointer to the root node, only used by the writers
+
+    service_tree_snapshot_t *snapshot;  //The published snapshot, used by the readers (atomic access)
+    service_tree_snapshot_t *retired;   //Snapshots which could not be freed yet, because the writer was also a reader
+    service_tree_entry_t *retired_entries; //Entries of removed services which could not be freed yet
+    celix_rcu_t *rcu;                   //Read sections of the snapshot readers, created on first use (atomic access)
 } service_tree_t;
 
+/**
+ * A use of a service, see useServiceInTree.
+ */
+typedef struct service_tree_use {
+    service_tree_entry_t *entry;    //NULL if no service was found
+    struct service_tree_use *next;  //Next use of the same thread
+} service_tree_use_t;
+
 //Global function prototypes
 bool addServiceNode(service_tree_t *svc_tree, const char *uri, void *svc);
-void destroyChildrenFromServiceNode(service_tree_node_t *parent, int *tree_item_count, int *tree_svc_count);
-void destroyServiceNode(service_tree_t *svc_tree, service_tree_node_t *node, int *tree_item_count, int *tree_svc_count);
+
+/**
+ * Removes the service for the URI. Waits until no reader can see the service anymore and the service is no longer
+ * used (see useServiceInTree) by other threads. Uses of the calling thread itself (a service removed from its own
+ * request callback) are not waited for, see isServiceInTreeUsedByCurrentThread.
+ */
+bool removeServiceNode(service_tree_t *svc_tree, const char *uri);
 void destroyServiceTree(service_tree_t *svc_tree);
-service_tree_node_t *findServiceNodeInTree(service_tree_t *svc_tree, const char *uri);
+
+/**
+ * Starts a read section, returns the token which should be provided to endServiceTreeRead.
+ */
+int beginServiceTreeRead(service_tree_t *svc_tree);
+void endServiceTreeRead(service_tree_t *svc_tree, int token);
+
+/**
+ * Finds the service for the requested URI, this is the service registered for the longest registered
+ * URI which matches (segment wise) the start of the requested URI. Must be called in a read section.
+ */
+void *findServiceInTree(service_tree_t *svc_tree, const char *uri);
+
+/**
+ * Finds the service for the requested URI (as findServiceInTree) and marks it as used, so that it is not removed
+ * until releaseServiceInTree is called with the same use. Should not be called in a read section.
+ * Returns NULL if no service is found, releaseServiceInTree must be called in both cases.
+ */
+void *useServiceInTree(service_tree_t *svc_tree, const char *uri, service_tree_use_t *use);
+void releaseServiceInTree(service_tree_use_t *use);
+
+/**
+ * Returns whether the calling thread uses the service (see useServiceInTree).
+ */
+bool isServiceInTreeUsedByCurrentThread(const void *svc);
 
 #endif //SERVICE_TREE_H
@@ -108,16 +108,9 @@ void websocket_admin_removeWebsocketService(void *handle, void *svc __attribute_
 
     if(uri != NULL) {
         celixThreadMutex_lock(&(admin->admin_lock));
-        service_tree_node_t *node = NULL;
-
-        node = findServiceNodeInTree(&admin->sock_svc_tree, uri);
-
-        if(node != NULL){
-            destroyServiceNode(&admin->sock_svc_tree, node, &admin->sock_svc_tree.tree_node_count, &admin->sock_svc_tree.tree_svc_count);
-        } else {
+        if(!removeServiceNode(&admin->sock_svc_tree, uri)) {
             printf("Couldn't remove websocket service with URI: %s, it doesn't exist\n", uri);
         }
-
         celixThreadMutex_unlock(&(admin->admin_lock));
     }
 }
@@ -129,14 +122,11 @@ int websocket_connect_handler(const struct mg_connection *connection, void *hand
     if(connection != NULL && handle != NULL) {
         const struct mg_request_info *ri = mg_get_request_info(connection);
         const char *req_uri = ri->request_uri;
-        service_tree_node_t *node = NULL;
-
-        node = findServiceNodeInTree(&admin->sock_svc_tree, req_uri);
-
-        if(node != NULL) {
-            //Requested URI exists, now obtain the service and delegate the callback handle.
-            celix_websocket_service_t *sockSvc = (celix_websocket_service_t *) node->svc_data->service;
+        service_tree_use_t use;
+        celix_websocket_service_t *sockSvc = useServiceInTree(&admin->sock_svc_tree, req_uri, &use);
 
+        if(sockSvc != NULL) {
+            //Requested URI exists, delegate the callback handle.
             if(sockSvc->connect != NULL) {
                 result = sockSvc->connect(connection, sockSvc->handle);
             }
@@ -144,6 +134,7 @@ int websocket_connect_handler(const struct mg_connection *connection, void *hand
                 result = 0; //No connect callback attached, proceed without error.
             }
         }
+        releaseServiceInTree(&use);
     }
 
     return result;
@@ -156,18 +147,16 @@ void websocket_ready_handler(struct mg_connection *connection, void *handle) {
     if(connection != NULL && handle != NULL) {
         const struct mg_request_info *ri = mg_get_request_info(connection);
         const char *req_uri = ri->request_uri;
-        service_tree_node_t *node = NULL;
-
-        node = findServiceNodeInTree(&admin->sock_svc_tree, req_uri);
-
-        if(node != NULL) {
-            //Requested URI exists, now obtain the service and delegate the callback handle.
-            celix_websocket_service_t *sockSvc = (celix_websocket_service_t *) node->svc_data->service;
+        service_tree_use_t use;
+        celix_websocket_service_t *sockSvc = useServiceInTree(&admin->sock_svc_tree, req_uri, &use);
 
+        if(sockSvc != NULL) {
+            //Requested URI exists, delegate the callback handle.
             if(sockSvc->ready != NULL) {
                 sockSvc->ready(connection, sockSvc->handle);
             }
         }
+        releaseServiceInTree(&use);
     }
 }
 
@@ -178,18 +167,16 @@ int websocket_data_handler(struct mg_connection *connection, int op_code, char *
     if(connection != NULL && handle != NULL) {
         const struct mg_request_info *ri = mg_get_request_info(connection);
         const char *req_uri = ri->request_uri;
-        service_tree_node_t *node = NULL;
-
-        node = findServiceNodeInTree(&admin->sock_svc_tree, req_uri);
-
-        if(node != NULL) {
-            //Requested URI exists, now obtain the service and delegate the callback handle.
-            celix_websocket_service_t *sockSvc = (celix_websocket_service_t *) node->svc_data->service;
+        service_tree_use_t use;
+        celix_websocket_service_t *sockSvc = useServiceInTree(&admin->sock_svc_tree, req_uri, &use);
 
+        if(sockSvc != NULL) {
+            //Requested URI exists, delegate the callback handle.
             if(sockSvc->data != NULL) {
                 result = sockSvc->data(connection, op_code, data, length, sockSvc->handle);
             }
         }
+        releaseServiceInTree(&use);
     }
 
     return result;
@@ -201,17 +188,15 @@ void websocket_close_handler(const struct mg_connection *connection, void *handl
     if (connection != NULL && handle != NULL) {
         const struct mg_request_info *ri = mg_get_request_info(connection);
         const char *req_uri = ri->request_uri;
-        service_tree_node_t *node = NULL;
-
-        node = findServiceNodeInTree(&admin->sock_svc_tree, req_uri);
-
-        if(node != NULL) {
-            //Requested URI exists, now obtain the service and delegate the callback handle.
-            celix_websocket_service_t *sockSvc = (celix_websocket_service_t *) node->svc_data->service;
+        service_tree_use_t use;
+        celix_websocket_service_t *sockSvc = useServiceInTree(&admin->sock_svc_tree, req_uri, &use);
 
+        if(sockSvc != NULL) {
+            //Requested URI exists, delegate the callback handle.
             if (sockSvc->close != NULL) {
                 sockSvc->close(connection, sockSvc->handle);
             }
         }
+        releaseServiceInTree(&use);
     }
 }
@@ -32,14 +32,45 @@
 
 #define HTTP_ADMIN_SERVICE_NAME "http_admin_service"
 
+/*
+ * Version of the celix_http_service_t struct, to be registered as service.version (CELIX_FRAMEWORK_SERVICE_VERSION)
+ * property. The streaming functions (doPostStream, doPutStream and doPatchStream) are added in version 1.1.0 and are
+ * only used for services registered with at least that service version, for other services the struct is assumed
+ * to end with doPatch.
+ */
+#define HTTP_ADMIN_SERVICE_VERSION "1.1.0"
+
 //Properties
 #define HTTP_ADMIN_URI          "uri"
 
+/*
+ * Reader for a request body, provided to the streaming variants of the http service functions.
+ */
+typedef struct celix_http_body_reader {
+    void *handle;
+
+    /*
+     * The content length of the request body, -1 if unknown (e.g. chunked transfer encoding).
+     */
+    long long contentLength;
+
+    /*
+     * Reads the next chunk of the request body. On success data points to the chunk, which is stored in a
+     * (bounded) buffer of the http admin and is only valid until the next read call or until the
+     * streaming function returns.
+     *
+     * Returns the size of the chunk, 0 if the complete body is read or < 0 on error.
+     */
+    int (*read)(void *handle, const char **data);
+} celix_http_body_reader_t;
+
 struct celix_http_service {
     void *handle;
 
     /*
      * Implementation of GET HTTP request, receive the requested file for the given connection.
+     * Note that a response body can be sent from a file descriptor (using sendfile if possible) with
+     * mg_send_fd_body (not available on Windows).
      *
      * Returns HTTP status code.
      */
@@ -104,6 +135,30 @@ struct celix_http_service {
      */
     int (*doPatch)(void *handle, struct mg_connection *connection, const char *path, const char *data, size_t length);
 
+    /*
+     * Streaming variant of the POST HTTP request. If set, this is used instead of doPost.
+     * Only used if the service is registered with a service.version of at least 1.1.0 (HTTP_ADMIN_SERVICE_VERSION).
+     * The request body is not read in memory by the http admin, but can be read in chunks with the provided body
+     * reader. Unread body data is read and discarded by the http admin after the function returns, so that the
+     * connection can be reused.
+     *
+     * Returns HTTP status code.
+     */
+    int (*doPostStream)(void *handle, struct mg_connection *connection, const char *path, celix_http_body_reader_t *body);
+
+    /*
+     * Streaming variant of the PUT HTTP request. If set, this is used instead of doPut. See doPostStream.
+     *
+     * Returns HTTP status code.
+     */
+    int (*doPutStream)(void *handle, struct mg_connection *connection, const char *path, celix_http_body_reader_t *body);
+
+    /*
+     * Streaming variant of the PATCH HTTP request. If set, this is used instead of doPatch. See doPostStream.
+     *
+     * Returns HTTP status code.
+     */
+    int (*doPatchStream)(void *handle, struct mg_connection *connection, const char *path, celix_http_body_reader_t *body);
 };
 
 typedef struct celix_http_service celix_http_service_t;
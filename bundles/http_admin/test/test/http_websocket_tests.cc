@@ -201,6 +201,81 @@ TEST(HTTP_ADMIN_INT_GROUP, http_put_echo_alias_test) {
     mg_close_connection(connection);
 }
 
+TEST(HTTP_ADMIN_INT_GROUP, http_put_stream_test) {
+    char err_buf[100] = {0};
+    char rcv_buf[100] = {0};
+    int send_bytes, response;
+    const struct mg_response_info *response_info;
+    struct mg_connection *connection;
+
+    //Body larger than the stream buffer, so that the service has to read it in multiple chunks
+    const size_t data_len = 256 * 1024;
+    char *data = (char *) malloc(data_len);
+    unsigned long checksum = 0;
+    for (size_t i = 0; i < data_len; ++i) {
+        data[i] = (char) ('a' + (i % 26));
+        checksum += (unsigned char) data[i];
+    }
+
+    connection = mg_connect_client("localhost", HTTP_PORT /*port*/, 0 /*no ssl*/, err_buf, sizeof(err_buf));
+    CHECK(connection != nullptr);
+
+    send_bytes = mg_printf(connection, "PUT /stream HTTP/1.1\r\n"
+                                       "Content-Type: application/octet-stream\r\n"
+                                       "Content-Length: %d\r\n\r\n", (int) data_len);
+    send_bytes += mg_write(connection, data, data_len);
+    CHECK(send_bytes > 0);
+
+    response = mg_get_response(connection, err_buf, sizeof(err_buf), 1000);
+    CHECK(response > 0);
+
+    response_info = mg_get_response_info(connection);
+    CHECK(response_info != nullptr);
+    CHECK_EQUAL(200, response_info->status_code);
+
+    int read_bytes = mg_read(connection, rcv_buf, sizeof(rcv_buf) - 1);
+    CHECK(read_bytes > 0);
+
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%d %lu", (int) data_len, checksum);
+    STRCMP_EQUAL(expected, rcv_buf);
+
+    mg_close_connection(connection);
+    free(data);
+}
+
+TEST(HTTP_ADMIN_INT_GROUP, http_put_stream_requires_service_version_test) {
+    char err_buf[100] = {0};
+    char rcv_buf[100] = {0};
+    const char *data_str = "Data for a service registered without service version";
+    int send_bytes, response;
+    const struct mg_response_info *response_info;
+    struct mg_connection *connection;
+
+    connection = mg_connect_client("localhost", HTTP_PORT /*port*/, 0 /*no ssl*/, err_buf, sizeof(err_buf));
+    CHECK(connection != nullptr);
+
+    send_bytes = mg_printf(connection, "PUT /stream_unversioned HTTP/1.1\r\n"
+                                       "Content-Type: text/plain\r\n"
+                                       "Content-Length: %d\r\n\r\n", (int) strlen(data_str));
+    send_bytes += mg_write(connection, data_str, strlen(data_str));
+    CHECK(send_bytes > 0);
+
+    response = mg_get_response(connection, err_buf, sizeof(err_buf), 1000);
+    CHECK(response > 0);
+
+    response_info = mg_get_response_info(connection);
+    CHECK(response_info != nullptr);
+    CHECK_EQUAL(200, response_info->status_code);
+
+    //Expect the echo of doPut instead of the size and checksum of doPutStream
+    int read_bytes = mg_read(connection, rcv_buf, sizeof(rcv_buf) - 1);
+    CHECK(read_bytes >= (int)strlen(data_str));
+    STRNCMP_EQUAL(data_str, rcv_buf, strlen(data_str));
+
+    mg_close_connection(connection);
+}
+
 TEST(HTTP_ADMIN_INT_GROUP, websocket_echo_test) {
     char err_buf[100] = {0};
     const char *data_str = "Example data string used for testing";
@@ -25,6 +25,7 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
 
 #include "celix_api.h"
 #include "http_admin/api.h"
@@ -38,6 +39,10 @@ struct activator {
     long httpSvcId;
     long httpSvcId2;
     long httpSvcId3;
+    celix_http_service_t streamSvc;
+    long streamSvcId;
+    celix_http_service_t unversionedStreamSvc;
+    long unversionedStreamSvcId;
 
     celix_websocket_service_t sockSvc;
     long sockSvcId;
@@ -45,6 +50,7 @@ struct activator {
 
 //Local function prototypes
 int alias_test_put(void *handle, struct mg_connection *connection, const char *path, const char *data, size_t length);
+int stream_test_put(void *handle, struct mg_connection *connection, const char *path, celix_http_body_reader_t *body);
 int websocket_data_echo(struct mg_connection *connection, int op_code, char *data, size_t length, void *handle);
 
 celix_status_t bnd_start(struct activator *act, celix_bundle_context_t *ctx) {
@@ -64,6 +70,21 @@ celix_status_t bnd_start(struct activator *act, celix_bundle_context_t *ctx) {
     act->httpSvc3.handle = act;
     act->httpSvcId3 = celix_bundleContext_registerService(ctx, &act->httpSvc3, HTTP_ADMIN_SERVICE_NAME, props3);
 
+    celix_properties_t *streamProps = celix_properties_create();
+    celix_properties_set(streamProps, HTTP_ADMIN_URI, "/stream");
+    celix_properties_set(streamProps, CELIX_FRAMEWORK_SERVICE_VERSION, HTTP_ADMIN_SERVICE_VERSION);
+    act->streamSvc.handle = act;
+    act->streamSvc.doPutStream = stream_test_put;
+    act->streamSvcId = celix_bundleContext_registerService(ctx, &act->streamSvc, HTTP_ADMIN_SERVICE_NAME, streamProps);
+
+    //Without a service version the streaming functions are not used
+    celix_properties_t *unversionedStreamProps = celix_properties_create();
+    celix_properties_set(unversionedStreamProps, HTTP_ADMIN_URI, "/stream_unversioned");
+    act->unversionedStreamSvc.handle = act;
+    act->unversionedStreamSvc.doPut = alias_test_put;
+    act->unversionedStreamSvc.doPutStream = stream_test_put;
+    act->unversionedStreamSvcId = celix_bundleContext_registerService(ctx, &act->unversionedStreamSvc, HTTP_ADMIN_SERVICE_NAME, unversionedStreamProps);
+
     celix_properties_t *props4 = celix_properties_create();
     celix_properties_set(props4, WEBSOCKET_ADMIN_URI, "/");
     act->sockSvc.handle = act;
@@ -77,6 +98,8 @@ celix_status_t bnd_stop(struct activator *act, celix_bundle_context_t *ctx) {
     celix_bundleContext_unregisterService(ctx, act->httpSvcId);
     celix_bundleContext_unregisterService(ctx, act->httpSvcId2);
     celix_bundleContext_unregisterService(ctx, act->httpSvcId3);
+    celix_bundleContext_unregisterService(ctx, act->streamSvcId);
+    celix_bundleContext_unregisterService(ctx, act->unversionedStreamSvcId);
     celix_bundleContext_unregisterService(ctx, act->sockSvcId);
 
     return CELIX_SUCCESS;
@@ -96,6 +119,27 @@ int alias_test_put(void *handle __attribute__((unused)), struct mg_connection *c
     return 200;
 }
 
+int stream_test_put(void *handle __attribute__((unused)), struct mg_connection *connection, const char *path __attribute__((unused)), celix_http_body_reader_t *body) {
+    //Read the body in chunks and reply with the number of bytes and the checksum of the received data
+    long long total = 0;
+    unsigned long checksum = 0;
+    const char *chunk = NULL;
+    int len;
+    while ((len = body->read(body->handle, &chunk)) > 0) {
+        for (int i = 0; i < len; ++i) {
+            checksum += (unsigned char)chunk[i];
+        }
+        total += len;
+    }
+
+    char reply[64];
+    int replyLen = snprintf(reply, sizeof(reply), "%lld %lu", total, checksum);
+    mg_printf(connection,
+              "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: %d\r\nConnection: close\r\n\r\n%s", replyLen, reply);
+
+    return 200;
+}
+
 int websocket_data_echo(struct mg_connection *connection, int op_code __attribute__((unused)), char *data, size_t length, void *handle __attribute__((unused))) {
     mg_websocket_write(connection, MG_WEBSOCKET_OPCODE_PONG, data, length);
 
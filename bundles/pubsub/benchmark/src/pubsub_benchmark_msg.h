@@ -0,0 +1,42 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_BENCHMARK_MSG_H
+#define PUBSUB_BENCHMARK_MSG_H
+
+#include <stdint.h>
+
+#define PUBSUB_BENCHMARK_MSG_NAME "benchmark"
+#define PUBSUB_BENCHMARK_TOPIC "benchmark"
+
+/**
+ * C representation of the benchmark.descriptor message.
+ * The payload is a dfi sequence, so the message size can be varied without a new descriptor.
+ */
+typedef struct pubsub_benchmark_msg {
+    uint64_t seqNr;
+    uint64_t sendTimeInNs; //CLOCK_REALTIME at the moment the publisher calls send
+    struct {
+        uint32_t cap;
+        uint32_t len;
+        uint8_t *buf;
+    } payload;
+} pubsub_benchmark_msg_t;
+
+#endif //PUBSUB_BENCHMARK_MSG_H
@@ -0,0 +1,162 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#include "celix_api.h"
+#include "pubsub/api.h"
+#include "pubsub_benchmark_msg.h"
+#include "pubsub_benchmark_services.h"
+
+struct activator {
+    long pubTrkId;
+    pubsub_benchmark_publisher_service_t benchSvc;
+    long benchSvcId;
+
+    celix_thread_mutex_t mutex; //protects pubSvc
+    pubsub_publisher_t *pubSvc;
+};
+
+static void bench_pubSet(void *handle, void *svc);
+static bool bench_isReady(void *handle);
+static int bench_run(void *handle, size_t msgSize, unsigned long rate, unsigned long durationInMs, unsigned long *nrOfSend, unsigned long *nrOfSendErrors, uint64_t *actualDurationInNs);
+
+static celix_status_t bnd_start(struct activator *act, celix_bundle_context_t *ctx) {
+    celixThreadMutex_create(&act->mutex, NULL);
+
+    char filter[512];
+    snprintf(filter, 512, "(%s=%s)", PUBSUB_PUBLISHER_TOPIC, PUBSUB_BENCHMARK_TOPIC);
+    celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+    opts.set = bench_pubSet;
+    opts.callbackHandle = act;
+    opts.filter.serviceName = PUBSUB_PUBLISHER_SERVICE_NAME;
+    opts.filter.filter = filter;
+    act->pubTrkId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+
+    act->benchSvc.handle = act;
+    act->benchSvc.isReady = bench_isReady;
+    act->benchSvc.run = bench_run;
+    act->benchSvcId = celix_bundleContext_registerService(ctx, &act->benchSvc, PUBSUB_BENCHMARK_PUBLISHER_SERVICE_NAME, NULL);
+
+    return CELIX_SUCCESS;
+}
+
+static celix_status_t bnd_stop(struct activator *act, celix_bundle_context_t *ctx) {
+    celix_bundleContext_unregisterService(ctx, act->benchSvcId);
+    celix_bundleContext_stopTracker(ctx, act->pubTrkId);
+    celixThreadMutex_destroy(&act->mutex);
+    return CELIX_SUCCESS;
+}
+
+CELIX_GEN_BUNDLE_ACTIVATOR(struct activator, bnd_start, bnd_stop)
+
+static void bench_pubSet(void *handle, void *svc) {
+    struct activator *act = handle;
+    celixThreadMutex_lock(&act->mutex);
+    act->pubSvc = svc;
+    celixThreadMutex_unlock(&act->mutex);
+}
+
+static bool bench_isReady(void *handle) {
+    struct activator *act = handle;
+    celixThreadMutex_lock(&act->mutex);
+    bool ready = act->pubSvc != NULL;
+    celixThreadMutex_unlock(&act->mutex);
+    return ready;
+}
+
+static uint64_t bench_nowInNs(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void bench_sleepUntil(uint64_t deadlineInNs) {
+    struct timespec deadline;
+    deadline.tv_sec = (time_t)(deadlineInNs / 1000000000ULL);
+    deadline.tv_nsec = (long)(deadlineInNs % 1000000000ULL);
+#if defined(__APPLE__)
+    uint64_t now = bench_nowInNs(CLOCK_MONOTONIC);
+    if (deadlineInNs > now) {
+        struct timespec rel = {.tv_sec = (time_t)((deadlineInNs - now) / 1000000000ULL), .tv_nsec = (long)((deadlineInNs - now) % 1000000000ULL)};
+        nanosleep(&rel, NULL);
+    }
+#else
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+        //retry
+    }
+#endif
+}
+
+static int bench_run(void *handle, size_t msgSize, unsigned long rate, unsigned long durationInMs, unsigned long *nrOfSend, unsigned long *nrOfSendErrors, uint64_t *actualDurationInNs) {
+    struct activator *act = handle;
+
+    //NOTE the publisher is kept locked during the run, the run is driven by a single benchmark runner.
+    celixThreadMutex_lock(&act->mutex);
+    if (act->pubSvc == NULL) {
+        celixThreadMutex_unlock(&act->mutex);
+        return -1;
+    }
+
+    unsigned int msgId = 0;
+    act->pubSvc->localMsgTypeIdForMsgType(act->pubSvc->handle, PUBSUB_BENCHMARK_MSG_NAME, &msgId);
+
+    pubsub_benchmark_msg_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.payload.buf = malloc(msgSize > 0 ? msgSize : 1);
+    msg.payload.cap = (uint32_t)msgSize;
+    msg.payload.len = (uint32_t)msgSize;
+    for (size_t i = 0; i < msgSize; ++i) {
+        msg.payload.buf[i] = (uint8_t)i;
+    }
+
+    unsigned long send = 0;
+    unsigned long errors = 0;
+    uint64_t interval = rate > 0 ? 1000000000ULL / rate : 0;
+    uint64_t start = bench_nowInNs(CLOCK_MONOTONIC);
+    uint64_t end = start + (uint64_t)durationInMs * 1000000ULL;
+    uint64_t next = start;
+    uint64_t now = start;
+    while (now < end) {
+        msg.seqNr += 1;
+        msg.sendTimeInNs = bench_nowInNs(CLOCK_REALTIME);
+        int rc = act->pubSvc->send(act->pubSvc->handle, msgId, &msg, NULL);
+        if (rc == 0) {
+            send += 1;
+        } else {
+            errors += 1;
+        }
+        if (interval > 0) {
+            next += interval;
+            bench_sleepUntil(next);
+        }
+        now = bench_nowInNs(CLOCK_MONOTONIC);
+    }
+    celixThreadMutex_unlock(&act->mutex);
+
+    free(msg.payload.buf);
+    *nrOfSend = send;
+    *nrOfSendErrors = errors;
+    *actualDurationInNs = now - start;
+    return 0;
+}
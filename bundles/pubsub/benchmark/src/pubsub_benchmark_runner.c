@@ -0,0 +1,221 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * Launcher for the pubsub benchmark containers.
+ *
+ * Starts the framework (config.properties, which installs one pubsub admin, one serializer and the benchmark
+ * publisher/subscriber bundles), sweeps the configured message sizes and rates and prints one CSV line per
+ * combination. Latency is measured from the send call in the publisher bundle to the receive callback in the
+ * subscriber bundle.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "celix_api.h"
+#include "pubsub_benchmark_services.h"
+
+#define PUBSUB_BENCHMARK_ADMIN                  "PUBSUB_BENCHMARK_ADMIN"
+#define PUBSUB_BENCHMARK_SERIALIZER             "PUBSUB_BENCHMARK_SERIALIZER"
+#define PUBSUB_BENCHMARK_MSG_SIZES              "PUBSUB_BENCHMARK_MSG_SIZES"
+#define PUBSUB_BENCHMARK_MSG_SIZES_DEFAULT      "16,256,4096,65536"
+#define PUBSUB_BENCHMARK_RATES                  "PUBSUB_BENCHMARK_RATES"
+#define PUBSUB_BENCHMARK_RATES_DEFAULT          "1000,10000,0" //0 -> as fast as possible
+#define PUBSUB_BENCHMARK_DURATION_MS            "PUBSUB_BENCHMARK_DURATION_MS"
+#define PUBSUB_BENCHMARK_DURATION_MS_DEFAULT    2000
+#define PUBSUB_BENCHMARK_WARMUP_TIMEOUT_MS      "PUBSUB_BENCHMARK_WARMUP_TIMEOUT_MS"
+#define PUBSUB_BENCHMARK_WARMUP_TIMEOUT_MS_DEFAULT 30000
+#define PUBSUB_BENCHMARK_DRAIN_TIMEOUT_MS       2000
+#define PUBSUB_BENCHMARK_OUTPUT_FILE            "PUBSUB_BENCHMARK_OUTPUT_FILE" //if not set, results are printed to stdout
+
+typedef struct bench_run_args {
+    size_t msgSize;
+    unsigned long rate;
+    unsigned long durationInMs;
+    int rc;
+    unsigned long nrOfSend;
+    unsigned long nrOfSendErrors;
+    uint64_t durationInNs;
+} bench_run_args_t;
+
+typedef struct bench_result {
+    unsigned long nrOfReceived;
+    unsigned long nrOfPayloadBytes;
+    pubsub_latency_histogram_t latency;
+} bench_result_t;
+
+static void bench_useIsReady(void *handle, void *svc) {
+    bool *ready = handle;
+    pubsub_benchmark_publisher_service_t *pub = svc;
+    *ready = pub->isReady(pub->handle);
+}
+
+static void bench_useRun(void *handle, void *svc) {
+    bench_run_args_t *args = handle;
+    pubsub_benchmark_publisher_service_t *pub = svc;
+    args->rc = pub->run(pub->handle, args->msgSize, args->rate, args->durationInMs, &args->nrOfSend, &args->nrOfSendErrors, &args->durationInNs);
+}
+
+static void bench_useReset(void *handle __attribute__((unused)), void *svc) {
+    pubsub_benchmark_subscriber_service_t *sub = svc;
+    sub->reset(sub->handle);
+}
+
+static void bench_useResult(void *handle, void *svc) {
+    bench_result_t *result = handle;
+    pubsub_benchmark_subscriber_service_t *sub = svc;
+    sub->result(sub->handle, &result->nrOfReceived, &result->nrOfPayloadBytes, &result->latency);
+}
+
+static bool bench_use(celix_bundle_context_t *ctx, const char *serviceName, void *handle, void (*use)(void *handle, void *svc)) {
+    celix_service_use_options_t opts = CELIX_EMPTY_SERVICE_USE_OPTIONS;
+    opts.filter.serviceName = serviceName;
+    opts.waitTimeoutInSeconds = 5.0;
+    opts.callbackHandle = handle;
+    opts.use = use;
+    return celix_bundleContext_useServiceWithOptions(ctx, &opts);
+}
+
+static void bench_run(celix_bundle_context_t *ctx, bench_run_args_t *args, bench_result_t *result) {
+    bench_use(ctx, PUBSUB_BENCHMARK_SUBSCRIBER_SERVICE_NAME, NULL, bench_useReset);
+    args->rc = -1;
+    bench_use(ctx, PUBSUB_BENCHMARK_PUBLISHER_SERVICE_NAME, args, bench_useRun);
+
+    //wait until all send messages are received or the number of received messages is stable
+    unsigned long prevReceived = 0;
+    for (int waited = 0; waited < PUBSUB_BENCHMARK_DRAIN_TIMEOUT_MS; waited += 100) {
+        bench_use(ctx, PUBSUB_BENCHMARK_SUBSCRIBER_SERVICE_NAME, result, bench_useResult);
+        if (result->nrOfReceived >= args->nrOfSend || (waited > 0 && result->nrOfReceived == prevReceived)) {
+            break;
+        }
+        prevReceived = result->nrOfReceived;
+        usleep(100000);
+    }
+}
+
+static bool bench_warmup(celix_bundle_context_t *ctx, long timeoutInMs) {
+    //note the static/discovered connections are setup asynchronous, so send until something is received.
+    for (long waited = 0; waited < timeoutInMs; waited += 100) {
+        bool ready = false;
+        bench_use(ctx, PUBSUB_BENCHMARK_PUBLISHER_SERVICE_NAME, &ready, bench_useIsReady);
+        if (ready) {
+            bench_run_args_t args = {.msgSize = 16, .rate = 1000, .durationInMs = 100};
+            bench_result_t *result = calloc(1, sizeof(*result));
+            bench_run(ctx, &args, result);
+            bool received = result->nrOfReceived > 0;
+            free(result);
+            if (received) {
+                return true;
+            }
+        } else {
+            usleep(100000);
+        }
+    }
+    return false;
+}
+
+static celix_array_list_t* bench_parseList(const char *list) {
+    celix_array_list_t *result = celix_arrayList_create();
+    char *copy = strdup(list);
+    char *savePtr = NULL;
+    for (char *token = strtok_r(copy, ", ", &savePtr); token != NULL; token = strtok_r(NULL, ", ", &savePtr)) {
+        celix_arrayList_addLong(result, strtol(token, NULL, 10));
+    }
+    free(copy);
+    return result;
+}
+
+int main(int argc __attribute__((unused)), char **argv __attribute__((unused))) {
+    celix_framework_t *fw = NULL;
+    if (celixLauncher_launch("config.properties", &fw) != 0) {
+        fprintf(stderr, "Cannot launch framework\n");
+        return 1;
+    }
+    celix_bundle_context_t *ctx = celix_framework_getFrameworkContext(fw);
+
+    const char *admin = celix_bundleContext_getProperty(ctx, PUBSUB_BENCHMARK_ADMIN, "unknown");
+    const char *serializer = celix_bundleContext_getProperty(ctx, PUBSUB_BENCHMARK_SERIALIZER, "unknown");
+    const char *outputFile = celix_bundleContext_getProperty(ctx, PUBSUB_BENCHMARK_OUTPUT_FILE, NULL);
+    long durationInMs = celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_BENCHMARK_DURATION_MS, PUBSUB_BENCHMARK_DURATION_MS_DEFAULT);
+    long warmupTimeoutInMs = celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_BENCHMARK_WARMUP_TIMEOUT_MS, PUBSUB_BENCHMARK_WARMUP_TIMEOUT_MS_DEFAULT);
+    celix_array_list_t *sizes = bench_parseList(celix_bundleContext_getProperty(ctx, PUBSUB_BENCHMARK_MSG_SIZES, PUBSUB_BENCHMARK_MSG_SIZES_DEFAULT));
+    celix_array_list_t *rates = bench_parseList(celix_bundleContext_getProperty(ctx, PUBSUB_BENCHMARK_RATES, PUBSUB_BENCHMARK_RATES_DEFAULT));
+
+    FILE *out = stdout;
+    if (outputFile != NULL) {
+        out = fopen(outputFile, "a");
+        if (out == NULL) {
+            fprintf(stderr, "Cannot open benchmark output file %s\n", outputFile);
+            out = stdout;
+        }
+    }
+    if (out != stdout) {
+        fseek(out, 0, SEEK_END);
+    }
+    if (out == stdout || ftell(out) == 0) {
+        fprintf(out, "admin,serializer,msg_size,target_rate,send,send_errors,received,duration_s,msgs_per_sec,mb_per_sec,mean_us,p50_us,p99_us,p999_us,max_us\n");
+    }
+
+    int rc = 0;
+    if (bench_warmup(ctx, warmupTimeoutInMs)) {
+        bench_result_t *result = calloc(1, sizeof(*result));
+        for (int i = 0; i < celix_arrayList_size(sizes); ++i) {
+            for (int k = 0; k < celix_arrayList_size(rates); ++k) {
+                bench_run_args_t args = {.msgSize = (size_t)celix_arrayList_getLong(sizes, i), .rate = (unsigned long)celix_arrayList_getLong(rates, k), .durationInMs = (unsigned long)durationInMs};
+                memset(result, 0, sizeof(*result));
+                bench_run(ctx, &args, result);
+                if (args.rc != 0) {
+                    fprintf(stderr, "Benchmark publisher not available\n");
+                    rc = 1;
+                    continue;
+                }
+                double seconds = (double)args.durationInNs / 1000000000.0;
+                fprintf(out, "%s,%s,%zu,%lu,%lu,%lu,%lu,%.3f,%.1f,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+                        admin, serializer, args.msgSize, args.rate,
+                        args.nrOfSend, args.nrOfSendErrors, result->nrOfReceived, seconds,
+                        (double)result->nrOfReceived / seconds,
+                        (double)result->nrOfPayloadBytes / 1000000.0 / seconds,
+                        pubsub_latencyHistogram_mean(&result->latency) / 1000.0,
+                        (double)pubsub_latencyHistogram_valueAtPercentile(&result->latency, 50.0) / 1000.0,
+                        (double)pubsub_latencyHistogram_valueAtPercentile(&result->latency, 99.0) / 1000.0,
+                        (double)pubsub_latencyHistogram_valueAtPercentile(&result->latency, 99.9) / 1000.0,
+                        (double)result->latency.max / 1000.0);
+                fflush(out);
+            }
+        }
+        free(result);
+    } else {
+        fprintf(stderr, "No benchmark messages received for %s/%s within %li ms\n", admin, serializer, warmupTimeoutInMs);
+        rc = 1;
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    celix_arrayList_destroy(sizes);
+    celix_arrayList_destroy(rates);
+
+    celixLauncher_stop(fw);
+    celixLauncher_waitForShutdown(fw);
+    celixLauncher_destroy(fw);
+    return rc;
+}
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_BENCHMARK_SERVICES_H
+#define PUBSUB_BENCHMARK_SERVICES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pubsub_latency_histogram.h"
+
+#define PUBSUB_BENCHMARK_PUBLISHER_SERVICE_NAME "pubsub_benchmark_publisher_service"
+#define PUBSUB_BENCHMARK_SUBSCRIBER_SERVICE_NAME "pubsub_benchmark_subscriber_service"
+
+/**
+ * Service provided by the benchmark publisher bundle and used by the benchmark runner.
+ */
+typedef struct pubsub_benchmark_publisher_service {
+    void *handle;
+
+    /**
+     * Returns true if the pubsub publisher service for the benchmark topic is available.
+     */
+    bool (*isReady)(void *handle);
+
+    /**
+     * Publishes messages with a payload of msgSize bytes for durationInMs milliseconds.
+     * If rate is 0 messages are send as fast as possible, otherwise rate is the target number of messages per second.
+     *
+     * @param nrOfSend Output for the number of successfully send messages.
+     * @param nrOfSendErrors Output for the number of messages the publisher failed to send.
+     * @param actualDurationInNs Output for the time spend sending.
+     * @return 0 on success, the benchmark publisher is not ready otherwise.
+     */
+    int (*run)(void *handle, size_t msgSize, unsigned long rate, unsigned long durationInMs, unsigned long *nrOfSend, unsigned long *nrOfSendErrors, uint64_t *actualDurationInNs);
+} pubsub_benchmark_publisher_service_t;
+
+/**
+ * Service provided by the benchmark subscriber bundle and used by the benchmark runner.
+ */
+typedef struct pubsub_benchmark_subscriber_service {
+    void *handle;
+
+    /**
+     * Resets the receive counters and the latency histogram.
+     */
+    void (*reset)(void *handle);
+
+    /**
+     * Returns the number of received messages and payload bytes since the last reset and
+     * copies the send-to-receive latency histogram to latency.
+     */
+    void (*result)(void *handle, unsigned long *nrOfReceived, unsigned long *nrOfPayloadBytes, pubsub_latency_histogram_t *latency);
+} pubsub_benchmark_subscriber_service_t;
+
+#endif //PUBSUB_BENCHMARK_SERVICES_H
@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "celix_api.h"
+#include "pubsub/api.h"
+#include "pubsub_benchmark_msg.h"
+#include "pubsub_benchmark_services.h"
+
+struct activator {
+    pubsub_subscriber_t subSvc;
+    long subSvcId;
+
+    pubsub_benchmark_subscriber_service_t benchSvc;
+    long benchSvcId;
+
+    //NOTE updated lock free from the receive callback, a reset is expected to be done when no messages are in flight.
+    unsigned long nrOfReceived;
+    unsigned long nrOfPayloadBytes;
+    pubsub_latency_histogram_t latency;
+};
+
+static int bench_receive(void *handle, const char *msgType, unsigned int msgTypeId, void *msg, const celix_properties_t *metadata, bool *release);
+static void bench_reset(void *handle);
+static void bench_result(void *handle, unsigned long *nrOfReceived, unsigned long *nrOfPayloadBytes, pubsub_latency_histogram_t *latency);
+
+static celix_status_t bnd_start(struct activator *act, celix_bundle_context_t *ctx) {
+    {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, PUBSUB_SUBSCRIBER_TOPIC, PUBSUB_BENCHMARK_TOPIC);
+        act->subSvc.handle = act;
+        act->subSvc.receive = bench_receive;
+        act->subSvcId = celix_bundleContext_registerService(ctx, &act->subSvc, PUBSUB_SUBSCRIBER_SERVICE_NAME, props);
+    }
+
+    {
+        act->benchSvc.handle = act;
+        act->benchSvc.reset = bench_reset;
+        act->benchSvc.result = bench_result;
+        act->benchSvcId = celix_bundleContext_registerService(ctx, &act->benchSvc, PUBSUB_BENCHMARK_SUBSCRIBER_SERVICE_NAME, NULL);
+    }
+
+    return CELIX_SUCCESS;
+}
+
+static celix_status_t bnd_stop(struct activator *act, celix_bundle_context_t *ctx) {
+    celix_bundleContext_unregisterService(ctx, act->subSvcId);
+    celix_bundleContext_unregisterService(ctx, act->benchSvcId);
+    return CELIX_SUCCESS;
+}
+
+CELIX_GEN_BUNDLE_ACTIVATOR(struct activator, bnd_start, bnd_stop)
+
+static int bench_receive(void *handle, const char *msgType __attribute__((unused)), unsigned int msgTypeId __attribute__((unused)), void *voidMsg, const celix_properties_t *metadata __attribute__((unused)), bool *release __attribute__((unused))) {
+    struct activator *act = handle;
+    pubsub_benchmark_msg_t *msg = voidMsg;
+
+    struct timespec receiveTime;
+    clock_gettime(CLOCK_REALTIME, &receiveTime);
+    pubsub_latencyHistogram_recordSinceTimestamp(&act->latency, msg->sendTimeInNs, &receiveTime);
+    __atomic_fetch_add(&act->nrOfReceived, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&act->nrOfPayloadBytes, msg->payload.len, __ATOMIC_RELAXED);
+    return CELIX_SUCCESS;
+}
+
+static void bench_reset(void *handle) {
+    struct activator *act = handle;
+    __atomic_store_n(&act->nrOfReceived, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&act->nrOfPayloadBytes, 0, __ATOMIC_RELAXED);
+    memset(&act->latency, 0, sizeof(act->latency));
+}
+
+static void bench_result(void *handle, unsigned long *nrOfReceived, unsigned long *nrOfPayloadBytes, pubsub_latency_histogram_t *latency) {
+    struct activator *act = handle;
+    *nrOfReceived = __atomic_load_n(&act->nrOfReceived, __ATOMIC_RELAXED);
+    *nrOfPayloadBytes = __atomic_load_n(&act->nrOfPayloadBytes, __ATOMIC_RELAXED);
+    pubsub_latencyHistogram_copy(&act->latency, latency);
+}
@@ -0,0 +1,342 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <future>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <celix_api.h>
+#include "celix_log_helper.h"
+#include "pubsub_tcp_handler.h"
+#include "pubsub_wire_v2_protocol_impl.h"
+
+/**
+ * Tests the send queue of the tcp handler. The connection is one end of a socketpair which is filled before it is
+ * added to the handler and the other end is not read (until a test reads it), so that messages stay in the send queue.
+ */
+class PubSubTcpHandlerTestSuite : public ::testing::Test {
+public:
+    static constexpr size_t PAYLOAD_SIZE = 256;
+    static constexpr size_t HEADER_SIZE = 48; //wire v2
+    static constexpr size_t FOOTER_SIZE = 4; //wire v2
+    static constexpr size_t FRAME_SIZE = HEADER_SIZE + PAYLOAD_SIZE + FOOTER_SIZE;
+    static constexpr size_t SEGMENT_SIZE = 100; //payload per segment, a message is send in 3 segments (100, 100, 56)
+
+    PubSubTcpHandlerTestSuite() {
+        auto* props = celix_properties_create();
+        celix_properties_set(props, OSGI_FRAMEWORK_FRAMEWORK_STORAGE, ".pubsub_tcp_handler_cache");
+        auto* fwPtr = celix_frameworkFactory_createFramework(props);
+        auto* ctxPtr = celix_framework_getFrameworkContext(fwPtr);
+        fw = std::shared_ptr<celix_framework_t>{fwPtr, [](auto* f) {celix_frameworkFactory_destroyFramework(f);}};
+        ctx = std::shared_ptr<celix_bundle_context_t>{ctxPtr, [](auto*){/*nop*/}};
+        logHelper = std::shared_ptr<celix_log_helper_t>{celix_logHelper_create(ctxPtr, "test"), [](auto* l) {celix_logHelper_destroy(l);}};
+
+        pubsubProtocol_wire_v2_create(&wireProtocol);
+        protocolSvc.handle = wireProtocol;
+        protocolSvc.getHeaderSize = pubsubProtocol_wire_v2_getHeaderSize;
+        protocolSvc.getHeaderBufferSize = pubsubProtocol_wire_v2_getHeaderBufferSize;
+        protocolSvc.getSyncHeaderSize = pubsubProtocol_wire_v2_getSyncHeaderSize;
+        protocolSvc.getSyncHeader = pubsubProtocol_wire_v2_getSyncHeader;
+        protocolSvc.getFooterSize = pubsubProtocol_wire_v2_getFooterSize;
+        protocolSvc.isMessageSegmentationSupported = pubsubProtocol_wire_v2_isMessageSegmentationSupported;
+        protocolSvc.encodeHeader = pubsubProtocol_wire_v2_encodeHeader;
+        protocolSvc.encodePayload = pubsubProtocol_wire_v2_encodePayload;
+        protocolSvc.encodeMetadata = pubsubProtocol_wire_v2_encodeMetadata;
+        protocolSvc.encodeFooter = pubsubProtocol_wire_v2_encodeFooter;
+        protocolSvc.decodeHeader = pubsubProtocol_wire_v2_decodeHeader;
+        protocolSvc.decodePayload = pubsubProtocol_wire_v2_decodePayload;
+        protocolSvc.decodeMetadata = pubsubProtocol_wire_v2_decodeMetadata;
+        protocolSvc.decodeFooter = pubsubProtocol_wire_v2_decodeFooter;
+        protocolSvc.encodeFrame = pubsubProtocol_wire_v2_encodeFrame;
+    }
+
+    ~PubSubTcpHandlerTestSuite() override {
+        if (handler != nullptr) {
+            pubsub_tcpHandler_destroy(handler);
+        }
+        if (readFd >= 0) {
+            close(readFd);
+        }
+        pubsubProtocol_wire_v2_destroy(wireProtocol);
+    }
+
+    PubSubTcpHandlerTestSuite(PubSubTcpHandlerTestSuite&&) = delete;
+    PubSubTcpHandlerTestSuite(const PubSubTcpHandlerTestSuite&) = delete;
+    PubSubTcpHandlerTestSuite& operator=(PubSubTcpHandlerTestSuite&&) = delete;
+    PubSubTcpHandlerTestSuite& operator=(const PubSubTcpHandlerTestSuite&) = delete;
+
+    /**
+     * Creates the handler with a send queue and adds a filled socketpair connection.
+     */
+    void createHandler(unsigned int queueSize, pubsub_tcpHandler_sendQueuePolicy_t policy, bool segmented = false) {
+        handler = pubsub_tcpHandler_create(&protocolSvc, logHelper.get());
+        ASSERT_NE(nullptr, handler);
+        pubsub_tcpHandler_setSendQueue(handler, queueSize, policy);
+        if (segmented) {
+            pubsub_tcpHandler_setMaxMsgSize(handler, HEADER_SIZE + SEGMENT_SIZE + FOOTER_SIZE);
+        }
+
+        int fds[2];
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        int sndBuf = 4096;
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndBuf, sizeof(sndBuf));
+        char fill[1024];
+        memset(fill, 0, sizeof(fill));
+        ssize_t n;
+        while ((n = send(fds[0], fill, sizeof(fill), MSG_DONTWAIT)) > 0) {
+            prefilled += (size_t)n;
+        }
+        ASSERT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+        readFd = fds[1];
+        char url[] = "unix://socketpair";
+        ASSERT_GE(pubsub_tcpHandler_addConnection(handler, fds[0], url), 0);
+    }
+
+    int write(uint8_t id) {
+        uint8_t payload[PAYLOAD_SIZE];
+        memset(payload, id, sizeof(payload));
+        pubsub_protocol_message_t message;
+        memset(&message, 0, sizeof(message));
+        message.header.msgId = 1;
+        message.payload.payload = payload;
+        message.payload.length = sizeof(payload);
+        struct iovec iov = {payload, sizeof(payload)};
+        return pubsub_tcpHandler_write(handler, &message, &iov, 1, 0);
+    }
+
+    pubsub_admin_sender_connection_metrics_t metrics(unsigned int expectedNrOfConnections = 1) {
+        pubsub_admin_sender_connection_metrics_t result{};
+        unsigned int nrOfConnections = 0;
+        auto* m = pubsub_tcpHandler_connectionMetrics(handler, &nrOfConnections);
+        EXPECT_EQ(expectedNrOfConnections, nrOfConnections);
+        if (nrOfConnections > 0) {
+            result = m[0];
+        }
+        free(m);
+        return result;
+    }
+
+    void readExactly(void* buf, size_t size) {
+        auto* data = static_cast<char*>(buf);
+        size_t offset = 0;
+        while (offset < size) {
+            ssize_t n = recv(readFd, data + offset, size - offset, 0);
+            ASSERT_GT(n, 0);
+            offset += (size_t)n;
+        }
+    }
+
+    /**
+     * Reads the prefilled data and the expected number of frames, returns the ids of the read frames.
+     */
+    std::vector<uint8_t> readFrames(size_t nrOfFrames) {
+        size_t frameSize = FRAME_SIZE;
+        std::vector<char> buf(std::max(prefilled, frameSize));
+        readExactly(buf.data(), prefilled);
+        std::vector<uint8_t> ids{};
+        for (size_t i = 0; i < nrOfFrames; ++i) {
+            readExactly(buf.data(), FRAME_SIZE);
+            ids.push_back((uint8_t)buf[HEADER_SIZE]);
+        }
+        return ids;
+    }
+
+    /**
+     * Reads the prefilled data and the segments of the expected number of segmented messages,
+     * returns the ids of the read segments.
+     */
+    std::vector<uint8_t> readSegmentedMessages(size_t nrOfMessages) {
+        size_t frameSize = FRAME_SIZE;
+        std::vector<char> buf(std::max(prefilled, frameSize));
+        readExactly(buf.data(), prefilled);
+        std::vector<uint8_t> ids{};
+        for (size_t i = 0; i < nrOfMessages; ++i) {
+            for (size_t offset = 0; offset < PAYLOAD_SIZE; offset += SEGMENT_SIZE) {
+                size_t partSize = PAYLOAD_SIZE - offset < SEGMENT_SIZE ? PAYLOAD_SIZE - offset : SEGMENT_SIZE;
+                readExactly(buf.data(), HEADER_SIZE + partSize + FOOTER_SIZE);
+                ids.push_back((uint8_t)buf[HEADER_SIZE]);
+            }
+        }
+        return ids;
+    }
+
+    void waitForEmptyQueue() {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+        while (metrics().sendQueueDepth > 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        EXPECT_EQ(0, metrics().sendQueueDepth);
+    }
+
+    std::shared_ptr<celix_framework_t> fw{};
+    std::shared_ptr<celix_bundle_context_t> ctx{};
+    std::shared_ptr<celix_log_helper_t> logHelper{};
+    pubsub_protocol_wire_v2_t* wireProtocol{nullptr};
+    pubsub_protocol_service_t protocolSvc{};
+    pubsub_tcpHandler_t* handler{nullptr};
+    int readFd{-1};
+    size_t prefilled{0};
+};
+
+TEST_F(PubSubTcpHandlerTestSuite, QueueIsDrainedOnWriteEvent) {
+    createHandler(8, PUBSUB_TCP_SEND_QUEUE_POLICY_DROP_NEWEST);
+    for (uint8_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(0, write(i));
+    }
+    auto m = metrics();
+    EXPECT_EQ(8, m.sendQueueSize);
+    EXPECT_EQ(3, m.sendQueueDepth);
+    EXPECT_EQ(0, m.nrOfDroppedMessages);
+
+    //reading makes the socket writable, the handler thread drains the queue
+    EXPECT_EQ((std::vector<uint8_t>{0, 1, 2}), readFrames(3));
+    waitForEmptyQueue();
+    EXPECT_EQ(0, metrics().nrOfDroppedMessages);
+}
+
+TEST_F(PubSubTcpHandlerTestSuite, DropNewestPolicy) {
+    createHandler(4, PUBSUB_TCP_SEND_QUEUE_POLICY_DROP_NEWEST);
+    for (uint8_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(0, write(i));
+    }
+    EXPECT_EQ(-1, write(4));
+    EXPECT_EQ(-1, write(5));
+    auto m = metrics();
+    EXPECT_EQ(4, m.sendQueueDepth);
+    EXPECT_EQ(2, m.nrOfDroppedMessages);
+
+    EXPECT_EQ((std::vector<uint8_t>{0, 1, 2, 3}), readFrames(4));
+    waitForEmptyQueue();
+}
+
+TEST_F(PubSubTcpHandlerTestSuite, DropOldestPolicy) {
+    createHandler(4, PUBSUB_TCP_SEND_QUEUE_POLICY_DROP_OLDEST);
+    for (uint8_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(0, write(i));
+    }
+    auto m = metrics();
+    EXPECT_EQ(4, m.sendQueueDepth);
+    EXPECT_EQ(2, m.nrOfDroppedMessages);
+
+    EXPECT_EQ((std::vector<uint8_t>{2, 3, 4, 5}), readFrames(4));
+    waitForEmptyQueue();
+}
+
+TEST_F(PubSubTcpHandlerTestSuite, BlockPolicy) {
+    createHandler(2, PUBSUB_TCP_SEND_QUEUE_POLICY_BLOCK);
+    EXPECT_EQ(0, write(0));
+    EXPECT_EQ(0, write(1));
+
+    //the queue is full, so the write blocks until the reader makes room
+    auto blockedWrite = std::async(std::launch::async, [this]{ return write(2); });
+    EXPECT_EQ(std::future_status::timeout, blockedWrite.wait_for(std::chrono::milliseconds{100}));
+
+    EXPECT_EQ((std::vector<uint8_t>{0, 1, 2}), readFrames(3));
+    EXPECT_EQ(0, blockedWrite.get());
+    waitForEmptyQueue();
+    EXPECT_EQ(0, metrics().nrOfDroppedMessages);
+}
+
+TEST_F(PubSubTcpHandlerTestSuite, DisconnectPolicy) {
+    createHandler(2, PUBSUB_TCP_SEND_QUEUE_POLICY_DISCONNECT);
+    EXPECT_EQ(0, write(0));
+    EXPECT_EQ(0, write(1));
+    EXPECT_EQ(2, metrics().sendQueueDepth);
+
+    //a full queue closes the connection and discards the queued messages
+    EXPECT_EQ(-1, write(2));
+    metrics(0);
+    EXPECT_EQ(0, write(3)); //no connections left
+
+    std::vector<char> buf(prefilled);
+    readExactly(buf.data(), prefilled);
+    char c;
+    EXPECT_EQ(0, recv(readFd, &c, 1, 0)); //EOF
+}
+
+TEST_F(PubSubTcpHandlerTestSuite, DropOldestPolicyDropsCompleteMessages) {
+    createHandler(4, PUBSUB_TCP_SEND_QUEUE_POLICY_DROP_OLDEST, true);
+    EXPECT_EQ(0, write(0));
+    EXPECT_EQ(3, metrics().sendQueueDepth);
+
+    //the second message does not fit, so all segments of the first message are dropped
+    EXPECT_EQ(0, write(1));
+    auto m = metrics();
+    EXPECT_EQ(3, m.sendQueueDepth);
+    EXPECT_EQ(1, m.nrOfDroppedMessages);
+
+    EXPECT_EQ((std::vector<uint8_t>{1, 1, 1}), readSegmentedMessages(1));
+    waitForEmptyQueue();
+}
+
+TEST_F(PubSubTcpHandlerTestSuite, DropNewestPolicyDropsCompleteMessages) {
+    createHandler(4, PUBSUB_TCP_SEND_QUEUE_POLICY_DROP_NEWEST, true);
+    EXPECT_EQ(0, write(0));
+
+    //the already queued segment of the second message is removed again
+    EXPECT_EQ(-1, write(1));
+    auto m = metrics();
+    EXPECT_EQ(3, m.sendQueueDepth);
+    EXPECT_EQ(1, m.nrOfDroppedMessages);
+
+    EXPECT_EQ((std::vector<uint8_t>{0, 0, 0}), readSegmentedMessages(1));
+    waitForEmptyQueue();
+}
+
+TEST_F(PubSubTcpHandlerTestSuite, BlockPolicyWaitsWithoutSpinning) {
+    createHandler(2, PUBSUB_TCP_SEND_QUEUE_POLICY_BLOCK);
+    EXPECT_EQ(0, write(0));
+    EXPECT_EQ(0, write(1));
+
+    std::clock_t cpuStart = std::clock();
+    auto blockedWrite = std::async(std::launch::async, [this]{ return write(2); });
+    EXPECT_EQ(std::future_status::timeout, blockedWrite.wait_for(std::chrono::milliseconds{500}));
+    double cpuTimeInMs = 1000.0 * (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    EXPECT_LT(cpuTimeInMs, 250.0); //a busy loop would use ~500ms cpu time
+
+    EXPECT_EQ((std::vector<uint8_t>{0, 1, 2}), readFrames(3));
+    EXPECT_EQ(0, blockedWrite.get());
+    waitForEmptyQueue();
+}
+
+TEST_F(PubSubTcpHandlerTestSuite, BlockPolicyTimeout) {
+    createHandler(2, PUBSUB_TCP_SEND_QUEUE_POLICY_BLOCK);
+    pubsub_tcpHandler_setSendTimeOut(handler, 0.1);
+    EXPECT_EQ(0, write(0));
+    EXPECT_EQ(0, write(1));
+
+    //nobody reads, so the message is dropped after the send timeout
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(-1, write(2));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{100});
+    auto m = metrics();
+    EXPECT_EQ(2, m.sendQueueDepth);
+    EXPECT_EQ(1, m.nrOfDroppedMessages);
+
+    EXPECT_EQ((std::vector<uint8_t>{0, 1}), readFrames(2));
+    waitForEmptyQueue();
+}
@@ -56,6 +56,22 @@
 #define PUBSUB_TCP_SUBSCRIBER_RETRY_CNT_KEY     "PUBSUB_TCP_SUBSCRIBER_RETRY_COUNT"
 #define PUBSUB_TCP_SUBSCRIBER_RETRY_CNT_DEFAULT 5
 
+/**
+ * Size of the per connection send queue of a publisher (in messages). When set (> 0) a publisher only queues
+ * the message and the tcp handler thread sends it, so that a slow subscriber does not stall the publisher.
+ * 0 (default) disables the send queue.
+ * Can be set as framework property or in the topic properties.
+ */
+#define PUBSUB_TCP_PUBLISHER_SEND_QUEUE_SIZE_KEY        "PUBSUB_TCP_PUBLISHER_SEND_QUEUE_SIZE"
+#define PUBSUB_TCP_PUBLISHER_SEND_QUEUE_SIZE_DEFAULT    0
+
+/**
+ * Policy used when the send queue of a connection is full: "block", "drop-oldest", "drop-newest" or "disconnect".
+ * Can be set as framework property or in the topic properties.
+ */
+#define PUBSUB_TCP_PUBLISHER_SEND_QUEUE_POLICY_KEY      "PUBSUB_TCP_PUBLISHER_SEND_QUEUE_POLICY"
+#define PUBSUB_TCP_PUBLISHER_SEND_QUEUE_POLICY_DEFAULT  "block"
+
 
 //Time-out settings are only for BLOCKING connections
 #define PUBSUB_TCP_PUBLISHER_SNDTIMEO_KEY       "PUBSUB_TCP_PUBLISHER_SEND_TIMEOUT"
@@ -36,3 +36,20 @@ bool psa_tcp_isPassive(const char* buffer) {
     }
     return isPassive;
 }
+
+pubsub_tcpHandler_sendQueuePolicy_t psa_tcp_sendQueuePolicy(const char* buffer) {
+    pubsub_tcpHandler_sendQueuePolicy_t policy = PUBSUB_TCP_SEND_QUEUE_POLICY_BLOCK;
+    if (buffer != NULL) {
+        char buf[32];
+        snprintf(buf, 32, "%s", buffer);
+        char *trimmed = utils_stringTrim(buf);
+        if (strcasecmp("drop-oldest", trimmed) == 0) {
+            policy = PUBSUB_TCP_SEND_QUEUE_POLICY_DROP_OLDEST;
+        } else if (strcasecmp("drop-newest", trimmed) == 0) {
+            policy = PUBSUB_TCP_SEND_QUEUE_POLICY_DROP_NEWEST;
+        } else if (strcasecmp("disconnect", trimmed) == 0) {
+            policy = PUBSUB_TCP_SEND_QUEUE_POLICY_DISCONNECT;
+        }
+    }
+    return policy;
+}
@@ -22,6 +22,7 @@
 
 #include <utils.h>
 #include <hash_map.h>
+#include "pubsub_tcp_handler.h"
 
 typedef struct pubsub_tcp_endPointStore {
     celix_thread_mutex_t mutex;
@@ -29,5 +30,6 @@ typedef struct pubsub_tcp_endPointStore {
 } pubsub_tcp_endPointStore_t;
 
 bool psa_tcp_isPassive(const char* buffer);
+pubsub_tcpHandler_sendQueuePolicy_t psa_tcp_sendQueuePolicy(const char* buffer);
 
 #endif //CELIX_PUBSUB_TCP_COMMON_H
@@ -40,6 +40,7 @@
 #endif
 #include <limits.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
 #include "hash_map.h"
@@ -64,6 +65,19 @@
 #define L_ERROR(...) \
     celix_logHelper_log(handle->logHelper, CELIX_LOG_LEVEL_ERROR, __VA_ARGS__)
 
+//
+// Send queue administration, a queue entry contains a complete (part of a) message: header, payload, metadata and footer.
+// The first/last segment flags mark the message boundaries, so that only complete messages are dropped.
+// The buffers of the entries are reused.
+//
+typedef struct psa_tcp_send_queue_entry {
+    void *buffer;
+    size_t bufferSize;
+    size_t size;
+    bool firstSegment;
+    bool lastSegment;
+} psa_tcp_send_queue_entry_t;
+
 //
 // Entry administration
 //
@@ -93,7 +107,18 @@ typedef struct psa_tcp_connection_entry {
     void *readMetaBuffer;
     size_t writeMetaBufferSize;
     void *writeMetaBuffer;
+    size_t writeFrameBufferSize; // Capacity of the frame buffer (header + metadata + footer), see pubsub_protocol_service_t.encodeFrame
+    void *writeFrameBuffer;
     unsigned int retryCount;
+    unsigned int pollEvents; // Events the fd is registered with, without the write event
+    // Bounded send queue (ring buffer), drained by the handler thread. Protected by the writeMutex
+    psa_tcp_send_queue_entry_t *sendQueue;
+    unsigned int sendQueueSize;
+    unsigned int sendQueueHead;
+    unsigned int sendQueueDepth;
+    size_t sendQueueOffset; // Number of bytes of the head entry which are already send
+    unsigned long nrOfDroppedMessages;
+    bool writeEventEnabled;
     celix_thread_mutex_t writeMutex;
     struct msghdr readMsg;
 } psa_tcp_connection_entry_t;
@@ -119,12 +144,20 @@ struct pubsub_tcpHandler {
     void *processMessagePayload;
     celix_log_helper_t *logHelper;
     pubsub_protocol_service_t *protocol;
+    // protocol sizes are constant for a protocol service, so they are only queried once
+    size_t protocolHeaderSize;
+    size_t protocolHeaderBufferSize;
+    size_t protocolFooterSize;
+    size_t protocolSyncHeaderSize;
+    bool protocolSupportsSegmentation;
     unsigned int bufferSize;
     unsigned int maxMsgSize;
     unsigned int maxSendRetryCount;
     unsigned int maxRcvRetryCount;
     double sendTimeout;
     double rcvTimeout;
+    unsigned int sendQueueSize;
+    pubsub_tcpHandler_sendQueuePolicy_t sendQueuePolicy;
     celix_thread_t thread;
     bool running;
     bool enableReceiveEvent;
@@ -142,6 +175,7 @@ static inline bool pubsub_tcpHandler_readHeader(pubsub_tcpHandler_t *handle, int
 static inline void pubsub_tcpHandler_decodePayload(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry);
 static inline long int pubsub_tcpHandler_readPayload(pubsub_tcpHandler_t *handle, int fd, psa_tcp_connection_entry_t *entry);
 static inline void pubsub_tcpHandler_connectionHandler(pubsub_tcpHandler_t *handle, int fd);
+static inline bool pubsub_tcpHandler_writeHandler(pubsub_tcpHandler_t *handle, int fd);
 static inline void pubsub_tcpHandler_handler(pubsub_tcpHandler_t *handle);
 static void *pubsub_tcpHandler_thread(void *data);
 
@@ -165,6 +199,11 @@ pubsub_tcpHandler_t *pubsub_tcpHandler_create(pubsub_protocol_service_t *protoco
         handle->timeout = 2000; // default 2 sec
         handle->logHelper = logHelper;
         handle->protocol = protocol;
+        protocol->getHeaderSize(protocol->handle, &handle->protocolHeaderSize);
+        protocol->getHeaderBufferSize(protocol->handle, &handle->protocolHeaderBufferSize);
+        protocol->getFooterSize(protocol->handle, &handle->protocolFooterSize);
+        protocol->getSyncHeaderSize(protocol->handle, &handle->protocolSyncHeaderSize);
+        protocol->isMessageSegmentationSupported(protocol->handle, &handle->protocolSupportsSegmentation);
         handle->bufferSize = MAX_DEFAULT_BUFFER_SIZE;
         celixThreadRwlock_create(&handle->dbLock, 0);
         handle->running = true;
@@ -324,10 +363,8 @@ pubsub_tcpHandler_createEntry(pubsub_tcpHandler_t *handle, int fd, char *url, ch
             entry->addr = *addr;
         }
         entry->len = sizeof(struct sockaddr_in);
-        size_t headerSize = 0;
-        size_t footerSize = 0;
-        handle->protocol->getHeaderSize(handle->protocol->handle, &headerSize);
-        handle->protocol->getFooterSize(handle->protocol->handle, &footerSize);
+        size_t headerSize = handle->protocolHeaderSize;
+        size_t footerSize = handle->protocolFooterSize;
         entry->readHeaderBufferSize = headerSize;
         entry->writeHeaderBufferSize = headerSize;
 
@@ -348,6 +385,8 @@ pubsub_tcpHandler_createEntry(pubsub_tcpHandler_t *handle, int fd, char *url, ch
         if (entry->bufferSize) entry->buffer = calloc(sizeof(char), entry->bufferSize);
         memset(&entry->readMsg, 0x00, sizeof(struct msghdr));
         entry->readMsg.msg_iov = calloc(sizeof(struct iovec), IOV_MAX);
+        entry->sendQueueSize = handle->sendQueueSize;
+        if (entry->sendQueueSize) entry->sendQueue = calloc(entry->sendQueueSize, sizeof(psa_tcp_send_queue_entry_t));
     }
     return entry;
 }
@@ -368,7 +407,12 @@ pubsub_tcpHandler_freeEntry(psa_tcp_connection_entry_t *entry) {
         free(entry->writeFooterBuffer);
         free(entry->readMetaBuffer);
         free(entry->writeMetaBuffer);
+        free(entry->writeFrameBuffer);
         free(entry->readMsg.msg_iov);
+        for (unsigned int i = 0; i < entry->sendQueueSize; i++) {
+            free(entry->sendQueue[i].buffer);
+        }
+        free(entry->sendQueue);
         celixThreadMutex_destroy(&entry->writeMutex);
         free(entry);
     }
@@ -424,6 +468,7 @@ int pubsub_tcpHandler_connect(pubsub_tcpHandler_t *handle, char *url) {
             bzero(&event,  sizeof(struct epoll_event)); // zero the struct
             event.events = EPOLLIN | EPOLLRDHUP | EPOLLERR;
             event.data.fd = entry->fd;
+            entry->pollEvents = event.events;
             rc = epoll_ctl(handle->efd, EPOLL_CTL_ADD, entry->fd, &event);
 #endif
             if (rc < 0) {
@@ -748,6 +793,15 @@ void pubsub_tcpHandler_setReceiveTimeOut(pubsub_tcpHandler_t *handle, double tim
     }
 }
 
+void pubsub_tcpHandler_setSendQueue(pubsub_tcpHandler_t *handle, unsigned int size, pubsub_tcpHandler_sendQueuePolicy_t policy) {
+    if (handle != NULL) {
+        celixThreadRwlock_writeLock(&handle->dbLock);
+        handle->sendQueueSize = size;
+        handle->sendQueuePolicy = policy;
+        celixThreadRwlock_unlock(&handle->dbLock);
+    }
+}
+
 void pubsub_tcpHandler_enableReceiveEvent(pubsub_tcpHandler_t *handle,bool enable) {
     if (handle != NULL) {
         celixThreadRwlock_writeLock(&handle->dbLock);
@@ -764,14 +818,10 @@ static inline long int pubsub_tcpHandler_getMsgSize(psa_tcp_connection_entry_t *
 static inline 
 bool pubsub_tcpHandler_readHeader(pubsub_tcpHandler_t *handle, int fd, psa_tcp_connection_entry_t *entry, long int* msgSize) {
     bool result = false;
-    size_t syncSize = 0;
-    size_t protocolHeaderBufferSize = 0;
-    // Get Sync Size
-    handle->protocol->getSyncHeaderSize(handle->protocol->handle, &syncSize);
-    // Get HeaderSize of the Protocol Header
-    handle->protocol->getHeaderSize(handle->protocol->handle, &entry->readHeaderSize);
-    // Get HeaderBufferSize of the Protocol Header, when headerBufferSize == 0, the protocol header is included in the payload (needed for endpoints)
-    handle->protocol->getHeaderBufferSize(handle->protocol->handle, &protocolHeaderBufferSize);
+    size_t syncSize = handle->protocolSyncHeaderSize;
+    entry->readHeaderSize = handle->protocolHeaderSize;
+    // When headerBufferSize == 0, the protocol header is included in the payload (needed for endpoints)
+    size_t protocolHeaderBufferSize = handle->protocolHeaderBufferSize;
 
     // Ensure capacity in header buffer
     pubsub_tcpHandler_ensureReadBufferCapacity(handle, entry);
@@ -862,7 +912,7 @@ void pubsub_tcpHandler_decodePayload(pubsub_tcpHandler_t *handle, psa_tcp_connec
 static inline
 long int pubsub_tcpHandler_readPayload(pubsub_tcpHandler_t *handle, int fd, psa_tcp_connection_entry_t *entry) {
     entry->readMsg.msg_iovlen = 0;
-    handle->protocol->getFooterSize(handle->protocol->handle, &entry->readFooterSize);
+    entry->readFooterSize = handle->protocolFooterSize;
 
     // from the header can be determined how large buffers should be. Even before receiving all data these buffers can be allocated
     pubsub_tcpHandler_ensureReadBufferCapacity(handle, entry);
@@ -976,6 +1026,276 @@ int pubsub_tcpHandler_addReceiverConnectionCallback(pubsub_tcpHandler_t *handle,
     return result;
 }
 
+//
+// Checks the result of a sendmsg call on a connection.
+// Returns true if the connection should be closed.
+//
+static inline bool pubsub_tcpHandler_checkSendResult(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry,
+                                                     pubsub_protocol_message_t *message, long int nbytes, size_t msgPartSize) {
+    bool closeConnection = false;
+    //  When a specific socket keeps reporting errors can indicate a subscriber
+    //  which is not active anymore, the connection will remain until the retry
+    //  counter exceeds the maximum retry count.
+    //  Btw, also, SIGSTOP issued by a debugging tool can result in EINTR error.
+    if (nbytes == -1) {
+        if (entry->retryCount < handle->maxSendRetryCount) {
+            entry->retryCount++;
+            L_ERROR(
+                "[TCP Socket] Failed to send message (fd: %d), try again. Retry count %u of %u, error(%d): %s.",
+                entry->fd, entry->retryCount, handle->maxSendRetryCount, errno, strerror(errno));
+        } else {
+            L_ERROR(
+                "[TCP Socket] Failed to send message (fd: %d) after %u retries! Closing connection... Error: %s", entry->fd, handle->maxSendRetryCount, strerror(errno));
+            closeConnection = true;
+        }
+    } else if (msgPartSize) {
+        entry->retryCount = 0;
+        if (nbytes != msgPartSize) {
+            L_ERROR("[TCP Socket] seq: %d MsgSize not correct: %d != %d (%s)\n", message->header.seqNr, msgPartSize, nbytes, strerror(errno));
+        }
+    }
+    return closeConnection;
+}
+
+//
+// Enables/disables the write event of a connection, the handler thread drains the send queue on a write event.
+//
+static inline void pubsub_tcpHandler_setWriteEvent(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry, bool enable) {
+    if (entry->writeEventEnabled == enable || handle->efd < 0) {
+        return;
+    }
+#if defined(__APPLE__)
+    struct kevent ev;
+    EV_SET (&ev, entry->fd, EVFILT_WRITE, enable ? (EV_ADD | EV_ENABLE) : EV_DELETE, 0, 0, 0);
+    int rc = kevent (handle->efd, &ev, 1, NULL, 0, NULL);
+#else
+    struct epoll_event event;
+    bzero(&event, sizeof(struct epoll_event)); // zero the struct
+    event.events = entry->pollEvents | (enable ? EPOLLOUT : 0);
+    event.data.fd = entry->fd;
+    int rc = epoll_ctl(handle->efd, EPOLL_CTL_MOD, entry->fd, &event);
+#endif
+    if (rc < 0) {
+        L_ERROR("[TCP Socket] Cannot %s write event (fd: %d): %s\n", enable ? "enable" : "disable", entry->fd, strerror(errno));
+    } else {
+        entry->writeEventEnabled = enable;
+    }
+}
+
+//
+// Sends as much of the send queue as possible in a single sendmsg call.
+// Returns the number of bytes send or -1 on error. Note that writeMutex should be locked.
+//
+static inline long int pubsub_tcpHandler_flushSendQueue(psa_tcp_connection_entry_t *entry, int flags) {
+    struct msghdr msg;
+    struct iovec msg_iov[IOV_MAX];
+    memset(&msg, 0x00, sizeof(struct msghdr));
+    msg.msg_iov = msg_iov;
+    for (unsigned int i = 0; i < entry->sendQueueDepth && msg.msg_iovlen < IOV_MAX; i++) {
+        psa_tcp_send_queue_entry_t *queueEntry = &entry->sendQueue[(entry->sendQueueHead + i) % entry->sendQueueSize];
+        size_t offset = (i == 0) ? entry->sendQueueOffset : 0;
+        msg.msg_iov[msg.msg_iovlen].iov_base = (char *) queueEntry->buffer + offset;
+        msg.msg_iov[msg.msg_iovlen].iov_len = queueEntry->size - offset;
+        msg.msg_iovlen++;
+    }
+    if (msg.msg_iovlen == 0) {
+        return 0;
+    }
+    long int nbytes = sendmsg(entry->fd, &msg, flags | MSG_NOSIGNAL);
+    size_t remaining = (nbytes > 0) ? (size_t) nbytes : 0;
+    while (remaining && entry->sendQueueDepth) {
+        psa_tcp_send_queue_entry_t *queueEntry = &entry->sendQueue[entry->sendQueueHead];
+        size_t left = queueEntry->size - entry->sendQueueOffset;
+        if (remaining < left) {
+            entry->sendQueueOffset += remaining;
+            break;
+        }
+        remaining -= left;
+        entry->sendQueueOffset = 0;
+        entry->sendQueueHead = (entry->sendQueueHead + 1) % entry->sendQueueSize;
+        entry->sendQueueDepth--;
+    }
+    return nbytes;
+}
+
+static inline psa_tcp_send_queue_entry_t *pubsub_tcpHandler_sendQueueAt(psa_tcp_connection_entry_t *entry, unsigned int index) {
+    return &entry->sendQueue[(entry->sendQueueHead + index) % entry->sendQueueSize];
+}
+
+//
+// Drops the oldest complete message of the send queue which is not (partially) send yet.
+// Returns false if there is no such message. Note that writeMutex should be locked.
+//
+static bool pubsub_tcpHandler_dropOldestMessage(psa_tcp_connection_entry_t *entry) {
+    unsigned int index = 0;
+    if (entry->sendQueueDepth && (entry->sendQueueOffset || !pubsub_tcpHandler_sendQueueAt(entry, 0)->firstSegment)) {
+        // Skip the message which is being send, dropping (a part of) it would corrupt the stream
+        while (index < entry->sendQueueDepth && !pubsub_tcpHandler_sendQueueAt(entry, index)->lastSegment) {
+            index++;
+        }
+        index++;
+    }
+    unsigned int length = 0;
+    for (unsigned int i = index; i < entry->sendQueueDepth && length == 0; i++) {
+        if (pubsub_tcpHandler_sendQueueAt(entry, i)->lastSegment) {
+            length = i - index + 1;
+        }
+    }
+    if (length == 0) {
+        return false;
+    }
+    // Move the entries after the message forward, the buffers are swapped so they are reused
+    for (unsigned int i = index; i + length < entry->sendQueueDepth; i++) {
+        psa_tcp_send_queue_entry_t *queueEntry = pubsub_tcpHandler_sendQueueAt(entry, i);
+        psa_tcp_send_queue_entry_t *nextEntry = pubsub_tcpHandler_sendQueueAt(entry, i + length);
+        psa_tcp_send_queue_entry_t tmp = *queueEntry;
+        *queueEntry = *nextEntry;
+        *nextEntry = tmp;
+    }
+    entry->sendQueueDepth -= length;
+    entry->nrOfDroppedMessages++;
+    return true;
+}
+
+//
+// Drops the message which is being written, including the segments which are already queued.
+// Returns false if this is not possible, because the message is already (partially) send.
+// Note that writeMutex should be locked.
+//
+static bool pubsub_tcpHandler_dropCurrentMessage(psa_tcp_connection_entry_t *entry, bool firstSegment) {
+    unsigned int length = 0;
+    if (!firstSegment) {
+        // The already queued segments are at the tail of the queue
+        bool found = false;
+        while (length < entry->sendQueueDepth && !found) {
+            psa_tcp_send_queue_entry_t *queueEntry = pubsub_tcpHandler_sendQueueAt(entry, entry->sendQueueDepth - 1 - length);
+            if (queueEntry->lastSegment) {
+                break; // previous message, the first segment is already send
+            }
+            length++;
+            found = queueEntry->firstSegment;
+        }
+        if (!found || (length == entry->sendQueueDepth && entry->sendQueueOffset)) {
+            return false;
+        }
+    }
+    entry->sendQueueDepth -= length;
+    entry->nrOfDroppedMessages++;
+    return true;
+}
+
+//
+// Sends from the calling thread until there is room in the send queue. Waits until the socket is writable, with the
+// send timeout (or the handler timeout when no send timeout is configured) as maximum wait time.
+// Returns false if there is no room in the queue, closeConnection is set when the connection should be closed.
+// Note that writeMutex should be locked.
+//
+static bool pubsub_tcpHandler_waitForSendQueue(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry, bool *closeConnection) {
+    int timeoutInMs = (handle->sendTimeout > 0.0) ? (int) (handle->sendTimeout * 1000.0) : (int) handle->timeout;
+    while (entry->sendQueueDepth == entry->sendQueueSize && !*closeConnection) {
+        struct pollfd pfd;
+        pfd.fd = entry->fd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        int rc = poll(&pfd, 1, timeoutInMs);
+        if (rc == 0) {
+            L_WARN("[TCP Socket] Send queue of %s is full and the connection is not writable for %d ms", entry->url, timeoutInMs);
+            return false;
+        } else if (rc < 0 && errno == EINTR) {
+            continue;
+        }
+        long int nbytes = (rc < 0) ? -1 : pubsub_tcpHandler_flushSendQueue(entry, MSG_DONTWAIT);
+        if (nbytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            continue;
+        }
+        *closeConnection = pubsub_tcpHandler_checkSendResult(handle, entry, NULL, nbytes, 0);
+    }
+    return !*closeConnection;
+}
+
+//
+// Copies a (part of a) message in the send queue of the connection, when the queue is full the send queue policy is applied.
+// The policies only drop complete messages, a message which does not fit in the queue at all is dropped as a whole.
+// Returns the number of queued bytes or -1 if the message is dropped. Note that writeMutex should be locked.
+//
+static inline long int pubsub_tcpHandler_enqueue(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry,
+                                                 struct msghdr *msg, size_t msgSize, bool firstSegment,
+                                                 bool lastSegment, bool *closeConnection) {
+    *closeConnection = false;
+    bool dropCurrentMessage = false;
+    if (entry->sendQueueDepth == entry->sendQueueSize) {
+        switch (handle->sendQueuePolicy) {
+            case PUBSUB_TCP_SEND_QUEUE_POLICY_BLOCK:
+                dropCurrentMessage = !pubsub_tcpHandler_waitForSendQueue(handle, entry, closeConnection);
+                break;
+            case PUBSUB_TCP_SEND_QUEUE_POLICY_DROP_OLDEST:
+                dropCurrentMessage = !pubsub_tcpHandler_dropOldestMessage(entry);
+                break;
+            case PUBSUB_TCP_SEND_QUEUE_POLICY_DROP_NEWEST:
+                dropCurrentMessage = true;
+                break;
+            case PUBSUB_TCP_SEND_QUEUE_POLICY_DISCONNECT:
+                L_WARN("[TCP Socket] Send queue of %s is full (%u messages)! Closing connection...", entry->url, entry->sendQueueSize);
+                entry->nrOfDroppedMessages++;
+                *closeConnection = true;
+                return -1;
+        }
+        if (dropCurrentMessage && !*closeConnection && !pubsub_tcpHandler_dropCurrentMessage(entry, firstSegment)) {
+            // The message is already partially send, so the remaining segments have to be send
+            dropCurrentMessage = !pubsub_tcpHandler_waitForSendQueue(handle, entry, closeConnection);
+            if (dropCurrentMessage && !*closeConnection) {
+                L_ERROR("[TCP Socket] Cannot send the remaining segments of a partially send message to %s! Closing connection...", entry->url);
+                entry->nrOfDroppedMessages++;
+                *closeConnection = true;
+            }
+        }
+    }
+    if (*closeConnection || dropCurrentMessage) {
+        return -1;
+    }
+    psa_tcp_send_queue_entry_t *queueEntry = pubsub_tcpHandler_sendQueueAt(entry, entry->sendQueueDepth);
+    if (queueEntry->bufferSize < msgSize) {
+        char *buffer = realloc(queueEntry->buffer, msgSize);
+        if (buffer == NULL) {
+            L_ERROR("[TCP Socket] Cannot allocate send queue buffer of %zu bytes", msgSize);
+            if (!pubsub_tcpHandler_dropCurrentMessage(entry, firstSegment)) {
+                entry->nrOfDroppedMessages++;
+                *closeConnection = true;
+            }
+            return -1;
+        }
+        queueEntry->buffer = buffer;
+        queueEntry->bufferSize = msgSize;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < msg->msg_iovlen; i++) {
+        memcpy((char *) queueEntry->buffer + offset, msg->msg_iov[i].iov_base, msg->msg_iov[i].iov_len);
+        offset += msg->msg_iov[i].iov_len;
+    }
+    queueEntry->size = offset;
+    queueEntry->firstSegment = firstSegment;
+    queueEntry->lastSegment = lastSegment;
+    entry->sendQueueDepth++;
+    pubsub_tcpHandler_setWriteEvent(handle, entry, true);
+    return (long int) offset;
+}
+
+//
+// Sends a (part of a) message to a connection, or queues it when the connection has a send queue.
+// Returns the number of bytes send/queued or -1 on error, closeConnection is set when the connection should be closed.
+//
+static inline long int pubsub_tcpHandler_sendMsg(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry,
+                                                 pubsub_protocol_message_t *message, struct msghdr *msg, int flags,
+                                                 size_t msgPartSize, bool firstSegment, bool *closeConnection) {
+    if (entry->sendQueueSize) {
+        return pubsub_tcpHandler_enqueue(handle, entry, msg, msgPartSize, firstSegment,
+                                         message->header.isLastSegment != 0, closeConnection);
+    }
+    long int nbytes = sendmsg(entry->fd, msg, flags | MSG_NOSIGNAL);
+    *closeConnection = pubsub_tcpHandler_checkSendResult(handle, entry, message, nbytes, msgPartSize);
+    return nbytes;
+}
+
 //
 // Write large data to TCP. .
 //
@@ -1013,8 +1333,7 @@ int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_protocol_message
             }
 
             // check if message is not too large
-            bool isMessageSegmentationSupported = false;
-            handle->protocol->isMessageSegmentationSupported(handle->protocol->handle, &isMessageSegmentationSupported);
+            bool isMessageSegmentationSupported = handle->protocolSupportsSegmentation;
             if (!isMessageSegmentationSupported && (msg_iov_len > max_msg_iov_len || payloadSize > entry->maxMsgSize)) {
                 L_WARN("[TCP Socket] Failed to send message (fd: %d), Message segmentation is not supported\n", entry->fd);
                 celixThreadMutex_unlock(&entry->writeMutex);
@@ -1027,6 +1346,60 @@ int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_protocol_message
             message->header.payloadOffset = 0;
             message->header.isLastSegment = 1;
 
+            // Fast path: header, metadata and footer encoded in one pass into the per connection frame buffer,
+            // when the protocol supports this and the message does not need to be segmented.
+            if (handle->protocol->encodeFrame != NULL && handle->protocolHeaderBufferSize && msg_iov_len <= max_msg_iov_len) {
+                size_t headerLength = 0;
+                size_t trailerLength = 0;
+                celix_status_t status = handle->protocol->encodeFrame(handle->protocol->handle, message,
+                                                                      &entry->writeFrameBuffer, &entry->writeFrameBufferSize,
+                                                                      &headerLength, &trailerLength);
+                if (status == CELIX_SUCCESS && (headerLength + payloadSize + trailerLength) <= entry->maxMsgSize) {
+                    struct msghdr msg;
+                    struct iovec msg_iov[IOV_MAX];
+                    memset(&msg, 0x00, sizeof(struct msghdr));
+                    msg.msg_name = &entry->addr;
+                    msg.msg_namelen = entry->len;
+                    msg.msg_flags = flags;
+                    msg.msg_iov = msg_iov;
+
+                    char *frame = entry->writeFrameBuffer;
+                    msg.msg_iov[msg.msg_iovlen].iov_base = frame;
+                    msg.msg_iov[msg.msg_iovlen].iov_len = headerLength;
+                    msg.msg_iovlen++;
+                    if (payloadData) {
+                        msg.msg_iov[msg.msg_iovlen].iov_base = payloadData;
+                        msg.msg_iov[msg.msg_iovlen].iov_len = payloadSize;
+                        msg.msg_iovlen++;
+                    } else {
+                        for (size_t i = 0; i < msg_iov_len; i++) {
+                            msg.msg_iov[msg.msg_iovlen].iov_base = msgIoVec[i].iov_base;
+                            msg.msg_iov[msg.msg_iovlen].iov_len = msgIoVec[i].iov_len;
+                            msg.msg_iovlen++;
+                        }
+                    }
+                    if (trailerLength) {
+                        msg.msg_iov[msg.msg_iovlen].iov_base = &frame[headerLength];
+                        msg.msg_iov[msg.msg_iovlen].iov_len = trailerLength;
+                        msg.msg_iovlen++;
+                    }
+                    bool closeConnection = false;
+                    long int nbytes = pubsub_tcpHandler_sendMsg(handle, entry, message, &msg, flags, headerLength + payloadSize + trailerLength, true, &closeConnection);
+                    if (closeConnection) {
+                        connFdCloseQueue[nofConnToClose++] = entry->fd;
+                    }
+                    if (nbytes == -1) {
+                        result = -1; //At least one connection failed sending
+                    }
+                    if (payloadData && (payloadData != message->payload.payload)) {
+                        free(payloadData);
+                    }
+                    celixThreadMutex_unlock(&entry->writeMutex);
+                    continue;
+                }
+                message->header.metadataSize = 0;
+            }
+
             void *metadataData = NULL;
             size_t metadataSize = 0;
             if (message->metadata.metadata) {
@@ -1037,6 +1410,8 @@ int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_protocol_message
                     metadataSize = 0;
                 }
                 handle->protocol->encodeMetadata(handle->protocol->handle, message, &metadataData, &metadataSize);
+                entry->writeMetaBuffer = metadataData;
+                entry->writeMetaBufferSize = metadataSize;
             }
 
             message->header.metadataSize = metadataSize;
@@ -1047,6 +1422,7 @@ int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_protocol_message
             size_t msgIovOffset     = 0;
             bool allPayloadAdded = (payloadSize == 0);
             long int nbytes = LONG_MAX;
+            bool firstSegment = true;
             while (sendMsgSize < totalMsgSize && nbytes > 0) {
                 struct msghdr msg;
                 struct iovec msg_iov[IOV_MAX];
@@ -1062,12 +1438,9 @@ int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_protocol_message
                 message->header.metadataSize = 0;
                 message->header.isLastSegment = 0;
 
-                size_t protocolHeaderBufferSize = 0;
-                // Get HeaderBufferSize of the Protocol Header, when headerBufferSize == 0, the protocol header is included in the payload (needed for endpoints)
-                handle->protocol->getHeaderBufferSize(handle->protocol->handle, &protocolHeaderBufferSize);
-                size_t footerSize = 0;
-                // Get size of the Protocol Footer
-                handle->protocol->getFooterSize(handle->protocol->handle, &footerSize);
+                // When headerBufferSize == 0, the protocol header is included in the payload (needed for endpoints)
+                size_t protocolHeaderBufferSize = handle->protocolHeaderBufferSize;
+                size_t footerSize = handle->protocolFooterSize;
                 size_t maxMsgSize = entry->maxMsgSize - protocolHeaderBufferSize - footerSize;
 
                 // reserve space for the header if required, header is added later when size of message is known (message can split in parts)
@@ -1127,9 +1500,7 @@ int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_protocol_message
                 }
 
                 void *headerData = NULL;
-                size_t headerSize = 0;
-                // Get HeaderSize of the Protocol Header
-                handle->protocol->getHeaderSize(handle->protocol->handle, &headerSize);
+                size_t headerSize = handle->protocolHeaderSize;
 
                 // check if header is not part of the payload (=> headerBufferSize = 0)
                 if (protocolHeaderBufferSize) {
@@ -1167,29 +1538,15 @@ int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_protocol_message
                         msgPartSize += footerSize;
                     }
                 }
-                nbytes = sendmsg(entry->fd, &msg, flags | MSG_NOSIGNAL);
-
-                //  When a specific socket keeps reporting errors can indicate a subscriber
-                //  which is not active anymore, the connection will remain until the retry
-                //  counter exceeds the maximum retry count.
-                //  Btw, also, SIGSTOP issued by a debugging tool can result in EINTR error.
+                // Note: when a segment is dropped by the send queue policy, the whole message is dropped
+                bool closeConnection = false;
+                nbytes = pubsub_tcpHandler_sendMsg(handle, entry, message, &msg, flags, msgPartSize, firstSegment, &closeConnection);
+                firstSegment = false;
+                if (closeConnection) {
+                    connFdCloseQueue[nofConnToClose++] = entry->fd;
+                }
                 if (nbytes == -1) {
-                    if (entry->retryCount < handle->maxSendRetryCount) {
-                        entry->retryCount++;
-                        L_ERROR(
-                            "[TCP Socket] Failed to send message (fd: %d), try again. Retry count %u of %u, error(%d): %s.",
-                            entry->fd, entry->retryCount, handle->maxSendRetryCount, errno, strerror(errno));
-                    } else {
-                        L_ERROR(
-                            "[TCP Socket] Failed to send message (fd: %d) after %u retries! Closing connection... Error: %s", entry->fd, handle->maxSendRetryCount, strerror(errno));
-                        connFdCloseQueue[nofConnToClose++] = entry->fd;
-                    }
                     result = -1; //At least one connection failed sending
-                } else if (msgPartSize) {
-                    entry->retryCount = 0;
-                    if (nbytes != msgPartSize) {
-                        L_ERROR("[TCP Socket] seq: %d MsgSize not correct: %d != %d (%s)\n", message->header.seqNr, msgPartSize, nbytes, strerror(errno));
-                    }
                 }
                 // Note: serialized Payload is deleted by serializer
                 if (payloadData && (payloadData != message->payload.payload)) {
@@ -1207,6 +1564,30 @@ int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_protocol_message
     return result;
 }
 
+//
+// Get the send queue metrics of the connections
+//
+pubsub_admin_sender_connection_metrics_t *pubsub_tcpHandler_connectionMetrics(pubsub_tcpHandler_t *handle, unsigned int *nrOfConnections) {
+    celixThreadRwlock_readLock(&handle->dbLock);
+    unsigned int count = (unsigned int) hashMap_size(handle->connection_fd_map);
+    pubsub_admin_sender_connection_metrics_t *result = calloc(count, sizeof(*result));
+    unsigned int i = 0;
+    hash_map_iterator_t iter = hashMapIterator_construct(handle->connection_fd_map);
+    while (hashMapIterator_hasNext(&iter) && result != NULL) {
+        psa_tcp_connection_entry_t *entry = hashMapIterator_nextValue(&iter);
+        celixThreadMutex_lock(&entry->writeMutex);
+        snprintf(result[i].url, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", entry->url);
+        result[i].sendQueueSize = entry->sendQueueSize;
+        result[i].sendQueueDepth = entry->sendQueueDepth;
+        result[i].nrOfDroppedMessages = entry->nrOfDroppedMessages;
+        celixThreadMutex_unlock(&entry->writeMutex);
+        i++;
+    }
+    celixThreadRwlock_unlock(&handle->dbLock);
+    *nrOfConnections = (result != NULL) ? count : 0;
+    return result;
+}
+
 //
 // get interface URL
 //
@@ -1258,6 +1639,54 @@ char *pubsub_tcpHandler_get_connection_url(pubsub_tcpHandler_t *handle) {
     return url;
 }
 
+//
+// Registers an accepted connection entry (sender) with the event loop. Note that dbLock should be write locked.
+// On failure the entry (and its fd) is freed.
+//
+static inline
+int pubsub_tcpHandler_addConnectionEntry(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry) {
+#if defined(__APPLE__)
+    struct kevent ev;
+    EV_SET (&ev, entry->fd, EVFILT_READ, EV_ADD | EV_ENABLE , 0, 0, 0);
+    int rc = kevent (handle->efd, &ev, 1, NULL, 0, NULL);
+#else
+    struct epoll_event event;
+    bzero(&event, sizeof(event)); // zero the struct
+    event.events = EPOLLRDHUP | EPOLLERR;
+    if (handle->enableReceiveEvent) event.events |= EPOLLIN;
+    event.data.fd = entry->fd;
+    entry->pollEvents = event.events;
+    // Register Read to epoll
+    int rc = epoll_ctl(handle->efd, EPOLL_CTL_ADD, entry->fd, &event);
+#endif
+    if (rc < 0) {
+        pubsub_tcpHandler_freeEntry(entry);
+        L_ERROR("[TCP Socket] Cannot create epoll\n");
+    } else {
+        // Call Accept Connection callback
+        if (handle->acceptConnectMessageCallback)
+            handle->acceptConnectMessageCallback(handle->acceptConnectPayload, entry->url);
+        hashMap_put(handle->connection_fd_map, (void *) (intptr_t) entry->fd, entry);
+        hashMap_put(handle->connection_url_map, entry->url, entry);
+        L_INFO("[TCP Socket] New connection to url: %s: \n", entry->url);
+    }
+    return rc;
+}
+
+//
+// Add an already connected socket as connection (sender)
+//
+int pubsub_tcpHandler_addConnection(pubsub_tcpHandler_t *handle, int fd, char *url) {
+    celixThreadRwlock_writeLock(&handle->dbLock);
+    psa_tcp_connection_entry_t *entry = pubsub_tcpHandler_createEntry(handle, fd, url, NULL, NULL);
+    int rc = (entry != NULL) ? pubsub_tcpHandler_addConnectionEntry(handle, entry) : -1;
+    celixThreadRwlock_unlock(&handle->dbLock);
+    if (rc >= 0) {
+        pubsub_tcpHandler_connectionHandler(handle, fd);
+    }
+    return rc;
+}
+
 //
 // Handle non-blocking accept (sender)
 //
@@ -1279,31 +1708,7 @@ int pubsub_tcpHandler_acceptHandler(pubsub_tcpHandler_t *handle, psa_tcp_connect
         char *interface_url = pubsub_utils_url_get_url(&sin, NULL);
         char *url = pubsub_utils_url_get_url(&their_addr, NULL);
         psa_tcp_connection_entry_t *entry = pubsub_tcpHandler_createEntry(handle, fd, url, interface_url, &their_addr);
-#if defined(__APPLE__)
-        struct kevent ev;
-        EV_SET (&ev, entry->fd, EVFILT_READ, EV_ADD | EV_ENABLE , 0, 0, 0);
-        rc = kevent (handle->efd, &ev, 1, NULL, 0, NULL);
-#else
-        struct epoll_event event;
-        bzero(&event, sizeof(event)); // zero the struct
-        event.events = EPOLLRDHUP | EPOLLERR;
-        if (handle->enableReceiveEvent) event.events |= EPOLLIN;
-        event.data.fd = entry->fd;
-        // Register Read to epoll
-        rc = epoll_ctl(handle->efd, EPOLL_CTL_ADD, entry->fd, &event);
-#endif
-        if (rc < 0) {
-            pubsub_tcpHandler_freeEntry(entry);
-            free(entry);
-            L_ERROR("[TCP Socket] Cannot create epoll\n");
-        } else {
-            // Call Accept Connection callback
-            if (handle->acceptConnectMessageCallback)
-                handle->acceptConnectMessageCallback(handle->acceptConnectPayload, url);
-            hashMap_put(handle->connection_fd_map, (void *) (intptr_t) entry->fd, entry);
-            hashMap_put(handle->connection_url_map, entry->url, entry);
-            L_INFO("[TCP Socket] New connection to url: %s: \n", url);
-        }
+        rc = pubsub_tcpHandler_addConnectionEntry(handle, entry);
         free(url);
         free(interface_url);
     }
@@ -1328,6 +1733,35 @@ void pubsub_tcpHandler_connectionHandler(pubsub_tcpHandler_t *handle, int fd) {
     celixThreadRwlock_unlock(&handle->dbLock);
 }
 
+//
+// Handle write event (sender), drains the send queue of the connection.
+// Returns true when the connection is closed.
+//
+static inline
+bool pubsub_tcpHandler_writeHandler(pubsub_tcpHandler_t *handle, int fd) {
+    bool closeConnection = false;
+    celixThreadRwlock_readLock(&handle->dbLock);
+    psa_tcp_connection_entry_t *entry = hashMap_get(handle->connection_fd_map, (void *) (intptr_t) fd);
+    if (entry) {
+        celixThreadMutex_lock(&entry->writeMutex);
+        long int nbytes = pubsub_tcpHandler_flushSendQueue(entry, MSG_DONTWAIT);
+        if (nbytes > 0) {
+            entry->retryCount = 0;
+        } else if (nbytes == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            closeConnection = pubsub_tcpHandler_checkSendResult(handle, entry, NULL, nbytes, 0);
+        }
+        if (entry->sendQueueDepth == 0) {
+            pubsub_tcpHandler_setWriteEvent(handle, entry, false);
+        }
+        celixThreadMutex_unlock(&entry->writeMutex);
+    }
+    celixThreadRwlock_unlock(&handle->dbLock);
+    if (closeConnection) {
+        pubsub_tcpHandler_close(handle, fd);
+    }
+    return closeConnection;
+}
+
 #if defined(__APPLE__)
 //
 // The main socket event loop
@@ -1354,6 +1788,10 @@ void pubsub_tcpHandler_handler(pubsub_tcpHandler_t *handle) {
         if (events[i].ident == entry->fd)
           pendingConnectionEntry = entry;
       }
+      if (!pendingConnectionEntry && events[i].filter == EVFILT_WRITE) {
+        pubsub_tcpHandler_writeHandler(handle, events[i].ident);
+        continue;
+      }
       if (pendingConnectionEntry) {
         int fd = pubsub_tcpHandler_acceptHandler(handle, pendingConnectionEntry);
         pubsub_tcpHandler_connectionHandler(handle, fd);
@@ -1404,6 +1842,12 @@ void pubsub_tcpHandler_handler(pubsub_tcpHandler_t *handle) {
                 if (events[i].data.fd == entry->fd)
                     pendingConnectionEntry = entry;
             }
+            if (!pendingConnectionEntry && (events[i].events & EPOLLOUT)) {
+                // Drain the send queue, other events are skipped when the connection is closed
+                if (pubsub_tcpHandler_writeHandler(handle, events[i].data.fd)) {
+                    continue;
+                }
+            }
             if (pendingConnectionEntry) {
                int fd = pubsub_tcpHandler_acceptHandler(handle, pendingConnectionEntry);
                pubsub_tcpHandler_connectionHandler(handle, fd);
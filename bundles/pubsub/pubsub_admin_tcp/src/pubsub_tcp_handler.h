@@ -36,6 +36,11 @@
 #include "celix_threads.h"
 #include "pubsub_utils_url.h"
 #include <pubsub_protocol.h>
+#include <pubsub_admin_metrics.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 #ifndef MIN
 #define MIN(a, b) ((a<b) ? (a) : (b))
@@ -46,6 +51,18 @@
 #endif
 
 typedef struct pubsub_tcpHandler pubsub_tcpHandler_t;
+
+/**
+ * Policy applied by pubsub_tcpHandler_write when the send queue of a connection is full.
+ * Segmented messages are only dropped as a whole.
+ */
+typedef enum pubsub_tcpHandler_sendQueuePolicy {
+    PUBSUB_TCP_SEND_QUEUE_POLICY_BLOCK,       // flush the queue from the calling thread until there is room (waits at most the send timeout)
+    PUBSUB_TCP_SEND_QUEUE_POLICY_DROP_OLDEST, // drop the oldest completely queued (not partially sent) message
+    PUBSUB_TCP_SEND_QUEUE_POLICY_DROP_NEWEST, // drop the message that is being written
+    PUBSUB_TCP_SEND_QUEUE_POLICY_DISCONNECT   // close the connection
+} pubsub_tcpHandler_sendQueuePolicy_t;
+
 typedef void(*pubsub_tcpHandler_processMessage_callback_t)
     (void *payload, const pubsub_protocol_message_t *header, bool *release, struct timespec *receiveTime);
 typedef void (*pubsub_tcpHandler_receiverConnectMessage_callback_t)(void *payload, const char *url, bool lock);
@@ -58,6 +75,11 @@ int pubsub_tcpHandler_close(pubsub_tcpHandler_t *handle, int fd);
 int pubsub_tcpHandler_connect(pubsub_tcpHandler_t *handle, char *url);
 int pubsub_tcpHandler_disconnect(pubsub_tcpHandler_t *handle, char *url);
 int pubsub_tcpHandler_listen(pubsub_tcpHandler_t *handle, char *url);
+/**
+ * Adds an already connected socket (e.g. one end of a socketpair) as a (sender) connection, as if it was accepted.
+ * The handler becomes owner of the fd, also when adding fails.
+ */
+int pubsub_tcpHandler_addConnection(pubsub_tcpHandler_t *handle, int fd, char *url);
 int pubsub_tcpHandler_setReceiveBufferSize(pubsub_tcpHandler_t *handle, unsigned int size);
 int pubsub_tcpHandler_setMaxMsgSize(pubsub_tcpHandler_t *handle, unsigned int size);
 void pubsub_tcpHandler_setTimeout(pubsub_tcpHandler_t *handle, unsigned int timeout);
@@ -66,6 +88,12 @@ void pubsub_tcpHandler_setReceiveRetryCnt(pubsub_tcpHandler_t *handle, unsigned
 void pubsub_tcpHandler_setSendTimeOut(pubsub_tcpHandler_t *handle, double timeout);
 void pubsub_tcpHandler_setReceiveTimeOut(pubsub_tcpHandler_t *handle, double timeout);
 void pubsub_tcpHandler_enableReceiveEvent(pubsub_tcpHandler_t *handle, bool enable);
+/**
+ * Configures a bounded send queue per connection. When size > 0, pubsub_tcpHandler_write only
+ * queues the message and the handler thread sends it. When size is 0 (default), messages are send
+ * from the calling thread.
+ */
+void pubsub_tcpHandler_setSendQueue(pubsub_tcpHandler_t *handle, unsigned int size, pubsub_tcpHandler_sendQueuePolicy_t policy);
 
 int pubsub_tcpHandler_read(pubsub_tcpHandler_t *handle, int fd);
 int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle,
@@ -86,7 +114,15 @@ int pubsub_tcpHandler_addAcceptConnectionCallback(pubsub_tcpHandler_t *handle,
                                                   pubsub_tcpHandler_acceptConnectMessage_callback_t disconnectMessageCallback);
 char *pubsub_tcpHandler_get_interface_url(pubsub_tcpHandler_t *handle);
 char *pubsub_tcpHandler_get_connection_url(pubsub_tcpHandler_t *handle);
+/**
+ * Returns the send queue metrics of all connections, the caller is owner of the returned array.
+ */
+pubsub_admin_sender_connection_metrics_t *pubsub_tcpHandler_connectionMetrics(pubsub_tcpHandler_t *handle, unsigned int *nrOfConnections);
 void pubsub_tcpHandler_setThreadPriority(pubsub_tcpHandler_t *handle, long prio, const char *sched);
 void pubsub_tcpHandler_setThreadName(pubsub_tcpHandler_t *handle, const char *topic, const char *scope);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* _PUBSUB_TCP_BUFFER_HANDLER_H_ */
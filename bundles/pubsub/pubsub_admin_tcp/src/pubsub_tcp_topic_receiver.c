@@ -108,9 +108,16 @@ typedef struct psa_tcp_subscriber_metrics_entry_t {
     unsigned long nrOfMissingSeqNumbers;
 } psa_tcp_subscriber_metrics_entry_t;
 
+typedef struct psa_tcp_subscriber_latency_entry {
+    pubsub_latency_histogram_t wireLatency;
+    pubsub_latency_histogram_t deserializationLatency;
+    pubsub_latency_histogram_t callbackLatency;
+} psa_tcp_subscriber_latency_entry_t;
+
 typedef struct psa_tcp_subscriber_entry {
     hash_map_t *msgTypes; //map from serializer svc
     hash_map_t *metrics; //key = msg type id, value = hash_map (key = origin uuid, value = psa_tcp_subscriber_metrics_entry_t*
+    hash_map_t *latencies; //key = msg type id, value = psa_tcp_subscriber_latency_entry_t*
     hash_map_t *subscriberServices; //key = servide id, value = pubsub_subscriber_t*
     bool initialized; //true if the init function is called through the receive thread
 } psa_tcp_subscriber_entry_t;
@@ -293,6 +300,7 @@ void pubsub_tcpTopicReceiver_destroy(pubsub_tcp_topic_receiver_t *receiver) {
                     hashMap_destroy(origins, true, true);
                 }
                 hashMap_destroy(entry->metrics, false, false);
+                hashMap_destroy(entry->latencies, false, true);
                 free(entry);
             }
         }
@@ -462,11 +470,13 @@ static void pubsub_tcpTopicReceiver_addSubscriber(void *handle, void *svc, const
 
         if (rc == 0) {
             entry->metrics = hashMap_create(NULL, NULL, NULL, NULL);
+            entry->latencies = hashMap_create(NULL, NULL, NULL, NULL);
             hash_map_iterator_t iter = hashMapIterator_construct(entry->msgTypes);
             while (hashMapIterator_hasNext(&iter)) {
                 pubsub_msg_serializer_t *msgSer = hashMapIterator_nextValue(&iter);
                 hash_map_t *origins = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
                 hashMap_put(entry->metrics, (void *) (uintptr_t) msgSer->msgId, origins);
+                hashMap_put(entry->latencies, (void *) (uintptr_t) msgSer->msgId, calloc(1, sizeof(psa_tcp_subscriber_latency_entry_t)));
             }
         }
 
@@ -509,6 +519,7 @@ static void pubsub_tcpTopicReceiver_removeSubscriber(void *handle, void *svc __a
             hashMap_destroy(origins, true, true);
         }
         hashMap_destroy(entry->metrics, false, false);
+        hashMap_destroy(entry->latencies, false, true);
         hashMap_destroy(entry->subscriberServices, false, false);
         free(entry);
     }
@@ -517,10 +528,11 @@ static void pubsub_tcpTopicReceiver_removeSubscriber(void *handle, void *svc __a
 
 static inline void
 processMsgForSubscriberEntry(pubsub_tcp_topic_receiver_t *receiver, psa_tcp_subscriber_entry_t *entry,
-                             const pubsub_protocol_message_t *message, bool *releaseMsg, struct timespec *receiveTime __attribute__((unused))) {
+                             const pubsub_protocol_message_t *message, bool *releaseMsg, struct timespec *receiveTime) {
     //NOTE receiver->subscribers.mutex locked
     pubsub_msg_serializer_t *msgSer = hashMap_get(entry->msgTypes, (void *) (uintptr_t) (message->header.msgId));
-    bool monitor = receiver->metricsEnabled;
+    psa_tcp_subscriber_latency_entry_t *latency = receiver->metricsEnabled ? hashMap_get(entry->latencies, (void *) (uintptr_t) (message->header.msgId)) : NULL;
+    bool monitor = latency != NULL;
 
     //monitoring
     struct timespec beginSer;
@@ -542,6 +554,10 @@ processMsgForSubscriberEntry(pubsub_tcp_topic_receiver_t *receiver, psa_tcp_subs
             celix_status_t status = msgSer->deserialize(msgSer->handle, &deSerializeBuffer, 1, &deSerializedMsg);
             if (monitor) {
                 clock_gettime(CLOCK_REALTIME, &endSer);
+                pubsub_latencyHistogram_recordInterval(&latency->deserializationLatency, &beginSer, &endSer);
+                if (message->header.sendTime != 0) {
+                    pubsub_latencyHistogram_recordSinceTimestamp(&latency->wireLatency, message->header.sendTime, receiveTime);
+                }
             }
             // When received payload pointer is the same as deserializedMsg, set ownership of pointer to topic receiver
             if (message->payload.payload == deSerializedMsg) {
@@ -574,6 +590,11 @@ processMsgForSubscriberEntry(pubsub_tcp_topic_receiver_t *receiver, psa_tcp_subs
                             release = true;
                         }
                     }
+                    if (monitor) {
+                        struct timespec endCallback;
+                        clock_gettime(CLOCK_REALTIME, &endCallback);
+                        pubsub_latencyHistogram_recordInterval(&latency->callbackLatency, &endSer, &endCallback);
+                    }
                     if (release) {
                         msgSer->freeDeserializeMsg(msgSer->handle, deSerializedMsg);
                     }
@@ -671,7 +692,20 @@ pubsub_admin_receiver_metrics_t *pubsub_tcpTopicReceiver_metrics(pubsub_tcp_topi
         psa_tcp_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
         hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
         while (hashMapIterator_hasNext(&iter2)) {
-            hash_map_t *origins = hashMapIterator_nextValue(&iter2);
+            hash_map_entry_t *metricsEntry = hashMapIterator_nextEntry(&iter2);
+            hash_map_t *origins = hashMapEntry_getValue(metricsEntry);
+            unsigned int msgTypeId = (unsigned int) (uintptr_t) hashMapEntry_getKey(metricsEntry);
+            psa_tcp_subscriber_latency_entry_t *latency = hashMap_get(entry->latencies, (void *) (uintptr_t) msgTypeId);
+            pubsub_msg_serializer_t *msgTypeSer = hashMap_get(entry->msgTypes, (void *) (uintptr_t) msgTypeId);
+            result->msgTypes[i].typeId = msgTypeId;
+            if (msgTypeSer) {
+                snprintf(result->msgTypes[i].typeFqn, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", msgTypeSer->msgName);
+            }
+            if (latency) {
+                pubsub_latencyHistogram_copy(&latency->wireLatency, &result->msgTypes[i].wireLatency);
+                pubsub_latencyHistogram_copy(&latency->deserializationLatency, &result->msgTypes[i].deserializationLatency);
+                pubsub_latencyHistogram_copy(&latency->callbackLatency, &result->msgTypes[i].callbackLatency);
+            }
             result->msgTypes[i].origins = calloc((size_t) hashMap_size(origins), sizeof(*(result->msgTypes[i].origins)));
             result->msgTypes[i].nrOfOrigins = hashMap_size(origins);
             int k = 0;
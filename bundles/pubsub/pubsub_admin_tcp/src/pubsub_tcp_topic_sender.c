@@ -97,6 +97,8 @@ typedef struct psa_tcp_send_msg_entry {
         struct timespec lastMessageSend;
         double averageTimeBetweenMessagesInSeconds;
         double averageSerializationTimeInSeconds;
+        pubsub_latency_histogram_t serializationLatency; //lock free, not protected by mutex
+        pubsub_latency_histogram_t sendLatency; //lock free, not protected by mutex
     } metrics;
 } psa_tcp_send_msg_entry_t;
 
@@ -206,6 +208,18 @@ pubsub_tcp_topic_sender_t *pubsub_tcpTopicSender_create(
         pubsub_tcpHandler_setTimeout(sender->socketHandler, (unsigned int) timeout);
     }
 
+    if (sender->socketHandler != NULL) {
+        long queueSize = celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_TCP_PUBLISHER_SEND_QUEUE_SIZE_KEY, PUBSUB_TCP_PUBLISHER_SEND_QUEUE_SIZE_DEFAULT);
+        const char *queuePolicy = celix_bundleContext_getProperty(ctx, PUBSUB_TCP_PUBLISHER_SEND_QUEUE_POLICY_KEY, PUBSUB_TCP_PUBLISHER_SEND_QUEUE_POLICY_DEFAULT);
+        if (topicProperties != NULL) {
+            queueSize = celix_properties_getAsLong(topicProperties, PUBSUB_TCP_PUBLISHER_SEND_QUEUE_SIZE_KEY, queueSize);
+            queuePolicy = celix_properties_get(topicProperties, PUBSUB_TCP_PUBLISHER_SEND_QUEUE_POLICY_KEY, queuePolicy);
+        }
+        if (queueSize > 0) {
+            pubsub_tcpHandler_setSendQueue(sender->socketHandler, (unsigned int) queueSize, psa_tcp_sendQueuePolicy(queuePolicy));
+        }
+    }
+
     if (!sender->isPassive) {
         //setting up tcp socket for TCP TopicSender
         if (discUrl != NULL) {
@@ -468,7 +482,7 @@ pubsub_admin_sender_metrics_t *pubsub_tcpTopicSender_metrics(pubsub_tcp_topic_se
         }
     }
 
-    result->msgMetrics = calloc(count, sizeof(*result));
+    result->msgMetrics = calloc(count, sizeof(*result->msgMetrics));
 
     iter = hashMapIterator_construct(sender->boundedServices.map);
     int i = 0;
@@ -484,6 +498,8 @@ pubsub_admin_sender_metrics_t *pubsub_tcpTopicSender_metrics(pubsub_tcp_topic_se
             result->msgMetrics[i].averageSerializationTimeInSeconds = mEntry->metrics.averageSerializationTimeInSeconds;
             result->msgMetrics[i].averageTimeBetweenMessagesInSeconds = mEntry->metrics.averageTimeBetweenMessagesInSeconds;
             result->msgMetrics[i].lastMessageSend = mEntry->metrics.lastMessageSend;
+            pubsub_latencyHistogram_copy(&mEntry->metrics.serializationLatency, &result->msgMetrics[i].serializationLatency);
+            pubsub_latencyHistogram_copy(&mEntry->metrics.sendLatency, &result->msgMetrics[i].sendLatency);
             result->msgMetrics[i].bndId = entry->bndId;
             result->msgMetrics[i].typeId = mEntry->type;
             snprintf(result->msgMetrics[i].typeFqn, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", mEntry->msgSer->msgName);
@@ -494,6 +510,9 @@ pubsub_admin_sender_metrics_t *pubsub_tcpTopicSender_metrics(pubsub_tcp_topic_se
 
     celixThreadMutex_unlock(&sender->boundedServices.mutex);
     result->nrOfmsgMetrics = (int) count;
+    if (sender->socketHandler != NULL) {
+        result->connectionMetrics = pubsub_tcpHandler_connectionMetrics(sender->socketHandler, &result->nrOfConnectionMetrics);
+    }
     return result;
 }
 
@@ -552,12 +571,19 @@ psa_tcp_topicPublicationSend(void *handle, unsigned int msgTypeId, const void *i
             message.header.payloadPartSize = 0;
             message.header.payloadOffset = 0;
             message.header.metadataSize = 0;
+            clock_gettime(CLOCK_REALTIME, &sendTime);
+            message.header.sendTime = (uint64_t) sendTime.tv_sec * 1000000000ULL + (uint64_t) sendTime.tv_nsec;
             if (metadata != NULL)
                 message.metadata.metadata = metadata;
             entry->seqNr++;
             bool sendOk = true;
             {
                 int rc = pubsub_tcpHandler_write(sender->socketHandler, &message, serializedIoVecOutput, serializedIoVecOutputLen, 0);
+                if (monitor) {
+                    struct timespec sendEnd;
+                    clock_gettime(CLOCK_REALTIME, &sendEnd);
+                    pubsub_latencyHistogram_recordInterval(&entry->metrics.sendLatency, &sendTime, &sendEnd);
+                }
                 if (rc < 0) {
                     status = -1;
                     sendOk = false;
@@ -592,6 +618,7 @@ psa_tcp_topicPublicationSend(void *handle, unsigned int msgTypeId, const void *i
     }
 
     if (monitor && entry != NULL) {
+        pubsub_latencyHistogram_recordInterval(&entry->metrics.serializationLatency, &serializationStart, &serializationEnd);
         celixThreadMutex_lock(&entry->metrics.mutex);
         long n = entry->metrics.nrOfMessagesSend + entry->metrics.nrOfMessagesSendFailed;
         double diff = celix_difftime(&serializationStart, &serializationEnd);
@@ -0,0 +1,162 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * Throughput benchmark for the large UDP fragmentation layer over loopback multicast.
+ *
+ * Usage: pubsub_udpmc_large_udp_benchmark [msg size in bytes] [nr of messages] [multicast ip] [port]
+ * Output is a single comma separated line, so that results can be collected by scripts.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+
+#include "large_udp.h"
+
+#define BENCHMARK_DEFAULT_MSG_SIZE      1024
+#define BENCHMARK_DEFAULT_NR_OF_MSGS    100000
+#define BENCHMARK_DEFAULT_MC_IP         "224.100.0.1"
+#define BENCHMARK_DEFAULT_PORT          50123
+#define BENCHMARK_IDLE_TIMEOUT_IN_MS    1000
+
+typedef struct benchmark_receiver {
+    int fd;
+    unsigned int expected;
+    unsigned int received;
+    unsigned long long bytes;
+    struct timespec lastReceived;
+} benchmark_receiver_t;
+
+static double benchmark_elapsed(const struct timespec *start, const struct timespec *end) {
+    return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+static void benchmark_msgReceived(void *handle, void *data __attribute__((unused)), unsigned int size) {
+    benchmark_receiver_t *receiver = handle;
+    receiver->received += 1;
+    receiver->bytes += size;
+    clock_gettime(CLOCK_MONOTONIC, &receiver->lastReceived);
+}
+
+static void* benchmark_recvThread(void *data) {
+    benchmark_receiver_t *receiver = data;
+    largeUdp_t *handle = largeUdp_create(16);
+    int epollFd = epoll_create1(0);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = receiver->fd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, receiver->fd, &ev);
+
+    while (receiver->received < receiver->expected) {
+        struct epoll_event events[1];
+        int nfds = epoll_wait(epollFd, events, 1, BENCHMARK_IDLE_TIMEOUT_IN_MS);
+        if (nfds <= 0) {
+            break; //idle, remaining messages are lost
+        }
+        largeUdp_receive(handle, receiver->fd, benchmark_msgReceived, receiver);
+    }
+
+    close(epollFd);
+    largeUdp_destroy(handle);
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    size_t msgSize = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_MSG_SIZE;
+    unsigned int nrOfMsgs = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 10) : BENCHMARK_DEFAULT_NR_OF_MSGS;
+    const char *mcIp = argc > 3 ? argv[3] : BENCHMARK_DEFAULT_MC_IP;
+    int port = argc > 4 ? atoi(argv[4]) : BENCHMARK_DEFAULT_PORT;
+
+    struct sockaddr_in mcAddr;
+    memset(&mcAddr, 0, sizeof(mcAddr));
+    mcAddr.sin_family = AF_INET;
+    mcAddr.sin_addr.s_addr = inet_addr(mcIp);
+    mcAddr.sin_port = htons(port);
+
+    //receiver
+    benchmark_receiver_t receiver;
+    memset(&receiver, 0, sizeof(receiver));
+    receiver.expected = nrOfMsgs;
+    receiver.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    int reuse = 1;
+    int rcvBuf = 8 * 1024 * 1024;
+    setsockopt(receiver.fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    setsockopt(receiver.fd, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+    struct ip_mreq mreq;
+    mreq.imr_multiaddr.s_addr = inet_addr(mcIp);
+    mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+    struct sockaddr_in listenAddr;
+    memset(&listenAddr, 0, sizeof(listenAddr));
+    listenAddr.sin_family = AF_INET;
+    listenAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    listenAddr.sin_port = htons(port);
+    if (setsockopt(receiver.fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0 ||
+            bind(receiver.fd, (struct sockaddr*)&listenAddr, sizeof(listenAddr)) != 0) {
+        perror("large_udp_benchmark: cannot setup multicast receive socket");
+        return 1;
+    }
+
+    //sender
+    int sendFd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct in_addr ifAddr;
+    ifAddr.s_addr = htonl(INADDR_LOOPBACK);
+    unsigned char loop = 1;
+    setsockopt(sendFd, IPPROTO_IP, IP_MULTICAST_IF, &ifAddr, sizeof(ifAddr));
+    setsockopt(sendFd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    largeUdp_t *sendHandle = largeUdp_create(1);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, benchmark_recvThread, &receiver);
+
+    char *payload = calloc(1, msgSize);
+    unsigned int sendErrors = 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < nrOfMsgs; ++i) {
+        if (largeUdp_sendto(sendHandle, sendFd, payload, msgSize, 0, &mcAddr, sizeof(mcAddr)) < 0) {
+            sendErrors += 1;
+        }
+    }
+    struct timespec sendDone;
+    clock_gettime(CLOCK_MONOTONIC, &sendDone);
+    pthread_join(thread, NULL);
+
+    double sendTime = benchmark_elapsed(&start, &sendDone);
+    double recvTime = receiver.received > 0 ? benchmark_elapsed(&start, &receiver.lastReceived) : 0.0;
+    printf("msg_size=%zu,sent=%u,send_errors=%u,received=%u,send_msgs_per_sec=%.0f,recv_msgs_per_sec=%.0f,recv_mb_per_sec=%.2f\n",
+           msgSize, nrOfMsgs, sendErrors, receiver.received,
+           sendTime > 0 ? nrOfMsgs / sendTime : 0.0,
+           recvTime > 0 ? receiver.received / recvTime : 0.0,
+           recvTime > 0 ? (double)receiver.bytes / (1024.0 * 1024.0) / recvTime : 0.0);
+
+    free(payload);
+    largeUdp_destroy(sendHandle);
+    close(sendFd);
+    close(receiver.fd);
+    return 0;
+}
@@ -0,0 +1,201 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <vector>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+
+extern "C" {
+#include "large_udp.h"
+}
+
+/**
+ * Tests the reassembly of large UDP messages. The parts are written directly to one end of a datagram socketpair,
+ * so that tests can reorder, drop or corrupt parts.
+ */
+class LargeUdpTestSuite : public ::testing::Test {
+public:
+    //note should match the part header and max part size of large_udp.c
+    struct PartHeader {
+        unsigned int msg_ident;
+        unsigned int total_msg_size;
+        unsigned int part_msg_size;
+        unsigned int offset;
+    };
+    static constexpr unsigned int MAX_PART_SIZE = 65535 - (20 + 8 + sizeof(PartHeader));
+    static constexpr unsigned int MSG_SIZE = 2 * MAX_PART_SIZE + 100; //3 parts
+
+    LargeUdpTestSuite() {
+        int rc = socketpair(AF_UNIX, SOCK_DGRAM, 0, fds);
+        EXPECT_EQ(0, rc);
+        int bufSize = 4 * 1024 * 1024;
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize));
+        setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+    }
+
+    ~LargeUdpTestSuite() override {
+        if (handle != nullptr) {
+            largeUdp_destroy(handle);
+        }
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    LargeUdpTestSuite(LargeUdpTestSuite&&) = delete;
+    LargeUdpTestSuite(const LargeUdpTestSuite&) = delete;
+    LargeUdpTestSuite& operator=(LargeUdpTestSuite&&) = delete;
+    LargeUdpTestSuite& operator=(const LargeUdpTestSuite&) = delete;
+
+    static std::vector<char> createMsg(char fill) {
+        std::vector<char> msg(MSG_SIZE);
+        for (size_t i = 0; i < msg.size(); ++i) {
+            msg[i] = (char)(fill + i % 7);
+        }
+        return msg;
+    }
+
+    void sendPart(unsigned int ident, const std::vector<char>& msg, unsigned int partNr) {
+        PartHeader header{};
+        header.msg_ident = ident;
+        header.total_msg_size = (unsigned int)msg.size();
+        header.offset = partNr * MAX_PART_SIZE;
+        unsigned int remaining = header.total_msg_size - header.offset;
+        header.part_msg_size = remaining > MAX_PART_SIZE ? MAX_PART_SIZE : remaining;
+        sendRaw(header, msg.data() + header.offset, header.part_msg_size);
+    }
+
+    void sendRaw(const PartHeader& header, const char* payload, size_t payloadSize) {
+        std::vector<char> datagram(sizeof(header) + payloadSize);
+        memcpy(datagram.data(), &header, sizeof(header));
+        memcpy(datagram.data() + sizeof(header), payload, payloadSize);
+        ASSERT_EQ((ssize_t)datagram.size(), send(fds[0], datagram.data(), datagram.size(), 0));
+        //note receive after every part, so that the socket buffer does not overflow
+        ASSERT_EQ(1, largeUdp_receive(handle, fds[1], LargeUdpTestSuite::onMsg, this));
+    }
+
+    static void onMsg(void *handle, void *data, unsigned int size) {
+        auto* self = static_cast<LargeUdpTestSuite*>(handle);
+        auto* bytes = static_cast<char*>(data);
+        self->received.emplace_back(bytes, bytes + size);
+    }
+
+    int fds[2]{-1, -1};
+    largeUdp_t* handle{nullptr};
+    std::vector<std::vector<char>> received{};
+};
+
+TEST_F(LargeUdpTestSuite, SendAndReceive) {
+    handle = largeUdp_create(2);
+    auto msg = createMsg('a');
+    //note sendto sends all parts before the test receives them
+    ASSERT_EQ((int)(MSG_SIZE + 3 * sizeof(PartHeader)), largeUdp_sendto(handle, fds[0], msg.data(), msg.size(), 0, nullptr, 0));
+    EXPECT_EQ(3, largeUdp_receive(handle, fds[1], LargeUdpTestSuite::onMsg, this));
+    ASSERT_EQ(1, received.size());
+    EXPECT_EQ(msg, received[0]);
+}
+
+TEST_F(LargeUdpTestSuite, OutOfOrderParts) {
+    handle = largeUdp_create(2);
+    auto msg1 = createMsg('a');
+    auto msg2 = createMsg('k');
+
+    //interleaved and out of order
+    sendPart(1, msg1, 2);
+    sendPart(2, msg2, 1);
+    sendPart(1, msg1, 0);
+    sendPart(2, msg2, 2);
+    EXPECT_TRUE(received.empty());
+    sendPart(2, msg2, 0);
+    sendPart(1, msg1, 1);
+
+    ASSERT_EQ(2, received.size());
+    EXPECT_EQ(msg2, received[0]);
+    EXPECT_EQ(msg1, received[1]);
+}
+
+TEST_F(LargeUdpTestSuite, DroppedPart) {
+    handle = largeUdp_create(2);
+    auto msg1 = createMsg('a');
+    auto msg2 = createMsg('k');
+
+    sendPart(1, msg1, 0);
+    sendPart(1, msg1, 2); //part 1 is dropped
+    sendPart(2, msg2, 0);
+    sendPart(2, msg2, 1);
+    sendPart(2, msg2, 2);
+
+    //only the complete message is delivered, the incomplete message does not block the next message
+    ASSERT_EQ(1, received.size());
+    EXPECT_EQ(msg2, received[0]);
+}
+
+TEST_F(LargeUdpTestSuite, EvictOldestSlot) {
+    handle = largeUdp_create(2);
+    auto msg1 = createMsg('a');
+    auto msg2 = createMsg('k');
+    auto msg3 = createMsg('u');
+
+    sendPart(1, msg1, 0);
+    sendPart(2, msg2, 0);
+    sendPart(3, msg3, 0); //no free slot -> slot of msg1 (oldest) is reused
+
+    sendPart(2, msg2, 1);
+    sendPart(2, msg2, 2);
+    sendPart(3, msg3, 1);
+    sendPart(3, msg3, 2);
+    ASSERT_EQ(2, received.size());
+    EXPECT_EQ(msg2, received[0]);
+    EXPECT_EQ(msg3, received[1]);
+
+    //the remaining parts of the evicted msg1 cannot complete it anymore
+    sendPart(1, msg1, 1);
+    sendPart(1, msg1, 2);
+    EXPECT_EQ(2, received.size());
+}
+
+TEST_F(LargeUdpTestSuite, InvalidPartsAreDropped) {
+    handle = largeUdp_create(2);
+    auto msg = createMsg('a');
+
+    PartHeader header{};
+    header.msg_ident = 1;
+    header.total_msg_size = (unsigned int)msg.size();
+    header.offset = 0;
+    header.part_msg_size = MAX_PART_SIZE;
+    sendRaw(header, msg.data(), 100); //payload size does not match the part size
+
+    header.offset = (unsigned int)msg.size() + 1; //offset after the message
+    header.part_msg_size = 100;
+    sendRaw(header, msg.data(), 100);
+
+    header.offset = (unsigned int)msg.size() - 50; //part exceeds the message
+    sendRaw(header, msg.data(), 100);
+    EXPECT_TRUE(received.empty());
+
+    //the invalid parts did not corrupt the reassembly of msg
+    sendPart(1, msg, 0);
+    sendPart(1, msg, 1);
+    sendPart(1, msg, 2);
+    ASSERT_EQ(1, received.size());
+    EXPECT_EQ(msg, received[0]);
+}
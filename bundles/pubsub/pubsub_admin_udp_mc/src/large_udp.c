@@ -31,7 +31,6 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <errno.h>
-#include <array_list.h>
 #include <pthread.h>
 
 #define MAX_UDP_MSG_SIZE        65535 /* 2^16 -1 */
@@ -40,23 +39,11 @@
 //#define MTU_SIZE                1500
 #define MTU_SIZE                8000
 #define MAX_MSG_VECTOR_LEN      64
+#define MAX_SEND_BATCH_SIZE     8   /* nr of fragments handed to the kernel in a single sendmmsg call */
+#define MAX_RECV_BATCH_SIZE     16  /* nr of datagrams read in a single recvmmsg call */
 
 //#define NO_IP_FRAGMENTATION
 
-struct largeUdp {
-    unsigned int maxNrLists;
-    array_list_pt udpPartLists;
-    pthread_mutex_t dbLock;
-};
-
-typedef struct udpPartList {
-    unsigned int msg_ident;
-    unsigned int msg_size;
-    unsigned int nrPartsRemaining;
-    char *data;
-} udpPartList_t;
-
-
 typedef struct msg_part_header {
     unsigned int msg_ident;
     unsigned int total_msg_size;
@@ -70,6 +57,90 @@ typedef struct msg_part_header {
 #define MAX_PART_SIZE   (MAX_UDP_MSG_SIZE - (IP_HEADER_SIZE + UDP_HEADER_SIZE + sizeof(struct msg_part_header) ))
 #endif
 
+//receive buffers are 8 byte aligned, so that single datagram messages can be used in place
+#define RECV_BUFFER_STRIDE  ((MAX_PART_SIZE + 7) & ~((size_t)7))
+
+#if defined(__APPLE__)
+//no sendmmsg/recvmmsg available, fallback to a sendmsg/recvmsg per datagram
+struct mmsghdr {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+#endif
+
+/**
+ * Reassembly slot. The slots are preallocated and the data buffer of a slot is reused for subsequent messages,
+ * so that no allocation is needed in the receive path once the buffers have grown to the used message sizes.
+ */
+typedef struct udpPartSlot {
+    bool inUse;
+    unsigned int msg_ident;
+    unsigned int msg_size;
+    unsigned int nrPartsRemaining;
+    unsigned long lastUsed;
+    char *data;
+    size_t capacity;
+} udpPartSlot_t;
+
+typedef struct recvBatch {
+    msg_part_header_t headers[MAX_RECV_BATCH_SIZE];
+    struct iovec iovecs[MAX_RECV_BATCH_SIZE][2];
+    struct mmsghdr msgs[MAX_RECV_BATCH_SIZE];
+    char *payloads; //MAX_RECV_BATCH_SIZE * RECV_BUFFER_STRIDE
+} recvBatch_t;
+
+struct largeUdp {
+    unsigned int maxNrLists;
+    udpPartSlot_t *slots;
+    unsigned long useCounter;
+    recvBatch_t *recvBatch; //lazy created, only needed for receiving handles
+    pthread_mutex_t dbLock;
+};
+
+static int largeUdp_sendBatch(int fd, struct mmsghdr *msgs, unsigned int len) {
+    unsigned int sent = 0;
+    while (sent < len) {
+#if defined(__APPLE__)
+        ssize_t w = sendmsg(fd, &msgs[sent].msg_hdr, 0);
+        if (w >= 0) {
+            msgs[sent].msg_len = (unsigned int)w;
+        }
+        int n = w >= 0 ? 1 : -1;
+#else
+        int n = sendmmsg(fd, &msgs[sent], len - sent, 0);
+#endif
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("sendmmsg()");
+            return -1;
+        }
+        sent += n;
+    }
+    int written = 0;
+    for (unsigned int i = 0; i < len; ++i) {
+        written += msgs[i].msg_len;
+    }
+    return written;
+}
+
+static int largeUdp_recvBatch(int fd, struct mmsghdr *msgs, unsigned int len) {
+#if defined(__APPLE__)
+    unsigned int i;
+    for (i = 0; i < len; ++i) {
+        ssize_t r = recvmsg(fd, &msgs[i].msg_hdr, MSG_DONTWAIT);
+        if (r < 0) {
+            break;
+        }
+        msgs[i].msg_len = (unsigned int)r;
+    }
+    return i == 0 ? -1 : (int)i;
+#else
+    return recvmmsg(fd, msgs, len, MSG_DONTWAIT, NULL);
+#endif
+}
+
 //
 // Create a handle
 //
@@ -79,9 +150,10 @@ largeUdp_t *largeUdp_create(unsigned int maxNrUdpReceptions)
     largeUdp_t *handle = calloc(sizeof(*handle), 1);
     if (handle != NULL) {
         handle->maxNrLists = maxNrUdpReceptions;
-        if (arrayList_create(&handle->udpPartLists) != CELIX_SUCCESS) {
+        handle->slots = calloc(maxNrUdpReceptions, sizeof(*handle->slots));
+        if (handle->slots == NULL) {
             free(handle);
-            handle = NULL;
+            return NULL;
         }
         pthread_mutex_init(&handle->dbLock, 0);
     }
@@ -97,20 +169,16 @@ void largeUdp_destroy(largeUdp_t *handle)
     printf("### Destroying large UDP\n");
     if (handle != NULL) {
         pthread_mutex_lock(&handle->dbLock);
-        int nrUdpLists = arrayList_size(handle->udpPartLists);
-        int i;
-        for (i=0; i < nrUdpLists; i++) {
-            udpPartList_t *udpPartList = arrayList_remove(handle->udpPartLists, i);
-            if (udpPartList) {
-                if (udpPartList->data) {
-                    free(udpPartList->data);
-                    udpPartList->data = NULL;
-                }
-                free(udpPartList);
-            }
+        for (unsigned int i = 0; i < handle->maxNrLists; i++) {
+            free(handle->slots[i].data);
+        }
+        free(handle->slots);
+        handle->slots = NULL;
+        if (handle->recvBatch != NULL) {
+            free(handle->recvBatch->payloads);
+            free(handle->recvBatch);
+            handle->recvBatch = NULL;
         }
-        arrayList_destroy(handle->udpPartLists);
-        handle->udpPartLists = NULL;
         pthread_mutex_unlock(&handle->dbLock);
         pthread_mutex_destroy(&handle->dbLock);
         free(handle);
@@ -119,75 +187,76 @@ void largeUdp_destroy(largeUdp_t *handle)
 
 //
 // Write large data to UDP. This function splits the data in chunks and sends these chunks with a header over UDP.
+// The chunks are handed to the kernel in batches of MAX_SEND_BATCH_SIZE using sendmmsg.
 //
 int largeUdp_sendmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovec, int len, int flags, struct sockaddr_in *dest_addr, size_t addrlen)
 {
     int n;
-    int result = 0;
-    msg_part_header_t header;
-
-    int written = 0;
-    header.msg_ident = (unsigned int)random();
-    header.total_msg_size = 0;
+    unsigned int total_msg_size = 0;
     for (n = 0; n < len ;n++) {
-        header.total_msg_size += largeMsg_iovec[n].iov_len;
+        total_msg_size += largeMsg_iovec[n].iov_len;
     }
-    int nr_buffers = (header.total_msg_size / MAX_PART_SIZE) + 1;
-
-    struct iovec msg_iovec[MAX_MSG_VECTOR_LEN];
-    struct msghdr msg;
-    msg.msg_name = dest_addr;
-    msg.msg_namelen = addrlen;
-    msg.msg_flags = 0;
-    msg.msg_iov = msg_iovec;
-    msg.msg_iovlen = 2; // header and payload;
-    msg.msg_control = NULL;
-    msg.msg_controllen = 0;
+    if (len + 1 > MAX_MSG_VECTOR_LEN) {
+        fprintf(stderr, "ERROR: Too many input vectors (%d) for large UDP send\n", len);
+        return -1;
+    }
+    unsigned int msg_ident = (unsigned int)random();
+    int nr_buffers = (total_msg_size / MAX_PART_SIZE) + 1;
 
-    msg.msg_iov[0].iov_base = &header;
-    msg.msg_iov[0].iov_len = sizeof(header);
+    msg_part_header_t headers[MAX_SEND_BATCH_SIZE];
+    struct iovec msg_iovecs[MAX_SEND_BATCH_SIZE][MAX_MSG_VECTOR_LEN];
+    struct mmsghdr msgs[MAX_SEND_BATCH_SIZE];
+    memset(msgs, 0, sizeof(msgs));
 
+    int written = 0;
+    int recvPart = 0;
+    size_t remainingOffset = 0; //offset in largeMsg_iovec[recvPart]
+    int batchLen = 0;
     for (n = 0; n < nr_buffers; n++) {
-
-        header.part_msg_size = (((header.total_msg_size - n * MAX_PART_SIZE) >  MAX_PART_SIZE) ?  MAX_PART_SIZE  : (header.total_msg_size - n * MAX_PART_SIZE));
-        header.offset = n * MAX_PART_SIZE;
-        int remainingOffset = header.offset;
-        int recvPart = 0;
-        // find the start of the part
-        while (remainingOffset > largeMsg_iovec[recvPart].iov_len) {
-            remainingOffset -= largeMsg_iovec[recvPart].iov_len;
-            recvPart++;
-        }
-        int remainingData = header.part_msg_size;
-        int sendPart = 1;
-        msg.msg_iovlen = 1;
+        msg_part_header_t *header = &headers[batchLen];
+        header->msg_ident = msg_ident;
+        header->total_msg_size = total_msg_size;
+        header->offset = n * MAX_PART_SIZE;
+        header->part_msg_size = (((total_msg_size - header->offset) >  MAX_PART_SIZE) ?  MAX_PART_SIZE  : (total_msg_size - header->offset));
+
+        struct msghdr *msg = &msgs[batchLen].msg_hdr;
+        msg->msg_name = dest_addr;
+        msg->msg_namelen = addrlen;
+        msg->msg_iov = msg_iovecs[batchLen];
+        msg->msg_iov[0].iov_base = header;
+        msg->msg_iov[0].iov_len = sizeof(*header);
+        msg->msg_iovlen = 1;
 
         // fill in the output iovec from the input iovec in such a way that all UDP frames are filled maximal.
-        while (remainingData > 0) {
-            int partLen = ( (largeMsg_iovec[recvPart].iov_len - remainingOffset) <= remainingData ? (largeMsg_iovec[recvPart].iov_len -remainingOffset) : remainingData);
-            msg.msg_iov[sendPart].iov_base = largeMsg_iovec[recvPart].iov_base + remainingOffset;
-            msg.msg_iov[sendPart].iov_len = partLen;
+        size_t remainingData = header->part_msg_size;
+        while (remainingData > 0 && recvPart < len) {
+            size_t available = largeMsg_iovec[recvPart].iov_len - remainingOffset;
+            size_t partLen = available <= remainingData ? available : remainingData;
+            if (partLen > 0) {
+                msg->msg_iov[msg->msg_iovlen].iov_base = (char *) largeMsg_iovec[recvPart].iov_base + remainingOffset;
+                msg->msg_iov[msg->msg_iovlen].iov_len = partLen;
+                msg->msg_iovlen++;
+            }
             remainingData -= partLen;
-            remainingOffset = 0;
-            sendPart++;
-            recvPart++;
-            msg.msg_iovlen++;
-        }
-        int tmp, tmptot;
-        for (tmp = 0, tmptot=0; tmp < msg.msg_iovlen; tmp++) {
-            tmptot += msg.msg_iov[tmp].iov_len;
+            remainingOffset += partLen;
+            if (remainingOffset == largeMsg_iovec[recvPart].iov_len) {
+                remainingOffset = 0;
+                recvPart++;
+            }
         }
 
-        int w = sendmsg(fd, &msg, 0);
-        if (w == -1) {
-            perror("send()");
-            result =  -1;
-            break;
+        batchLen++;
+        if (batchLen == MAX_SEND_BATCH_SIZE || n == nr_buffers - 1) {
+            int w = largeUdp_sendBatch(fd, msgs, batchLen);
+            if (w == -1) {
+                return -1;
+            }
+            written += w;
+            batchLen = 0;
         }
-        written += w;
     }
 
-    return (result == 0 ? written : result);
+    return written;
 }
 
 //
@@ -195,172 +264,137 @@ int largeUdp_sendmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovec, i
 //
 int largeUdp_sendto(largeUdp_t *handle, int fd, void *buf, size_t count, int flags, struct sockaddr_in *dest_addr, size_t addrlen)
 {
-    int n;
-    int nr_buffers = (count / MAX_PART_SIZE) + 1;
-    int result = 0;
-    msg_part_header_t header;
-
-    int written = 0;
-    header.msg_ident = (unsigned int)random();
-    header.total_msg_size = count;
-    char *databuf = buf;
-
-    struct iovec msg_iovec[2];
-    struct msghdr msg;
-    msg.msg_name = dest_addr;
-    msg.msg_namelen = addrlen;
-    msg.msg_flags = 0;
-    msg.msg_iov = msg_iovec;
-    msg.msg_iovlen = 2; // header and payload;
-    msg.msg_control = NULL;
-    msg.msg_controllen = 0;
-
-    msg.msg_iov[0].iov_base = &header;
-    msg.msg_iov[0].iov_len = sizeof(header);
-
-    for (n = 0; n < nr_buffers; n++) {
+    struct iovec msg_iovec;
+    msg_iovec.iov_base = buf;
+    msg_iovec.iov_len = count;
+    return largeUdp_sendmsg(handle, fd, &msg_iovec, 1, flags, dest_addr, addrlen);
+}
 
-        header.part_msg_size = (((header.total_msg_size - n * MAX_PART_SIZE) >  MAX_PART_SIZE) ?  MAX_PART_SIZE  : (header.total_msg_size - n * MAX_PART_SIZE));
-        header.offset = n * MAX_PART_SIZE;
-        msg.msg_iov[1].iov_base = &databuf[header.offset];
-        msg.msg_iov[1].iov_len = header.part_msg_size;
-        int w = sendmsg(fd, &msg, 0);
-        if (w == -1) {
-            perror("send()");
-            result =  -1;
+static udpPartSlot_t* largeUdp_findOrClaimSlot(largeUdp_t *handle, const msg_part_header_t *header) {
+    udpPartSlot_t *freeSlot = NULL;
+    udpPartSlot_t *oldest = NULL;
+    for (unsigned int i = 0; i < handle->maxNrLists; ++i) {
+        udpPartSlot_t *slot = &handle->slots[i];
+        if (slot->inUse && slot->msg_ident == header->msg_ident) {
+            if (slot->msg_size == header->total_msg_size) {
+                return slot;
+            }
+            // Corruption occurred. Reuse the existing slot and build up a new administration.
+            freeSlot = slot;
             break;
+        } else if (!slot->inUse) {
+            if (freeSlot == NULL) {
+                freeSlot = slot;
+            }
+        } else if (oldest == NULL || slot->lastUsed < oldest->lastUsed) {
+            oldest = slot;
         }
-        written += w;
-        //usleep(1000); // TODO: If not slept a UDP buffer overflow occurs and parts are missing at the reception side (at least via localhost)
     }
 
-    return (result == 0 ? written : result);
-}
-
-//
-// Reads data from the filedescriptor which has date (determined by epoll()) and stores it in the internal structure
-// If the message is completely reassembled true is returned and the index and size have valid values
-//
-bool largeUdp_dataAvailable(largeUdp_t *handle, int fd, unsigned int *index, unsigned int *size) {
-    msg_part_header_t header;
-    int result = false;
-    // Only read the header, we don't know yet where to store the payload
-    if (recv(fd, &header, sizeof(header), MSG_PEEK) < 0) {
-        perror("read()");
-        return false;
+    udpPartSlot_t *slot = freeSlot;
+    if (slot == NULL) {
+        slot = oldest;
+        fprintf(stderr, "ERROR: Removing entry for id %d: %d parts not received\n", slot->msg_ident, slot->nrPartsRemaining);
     }
-
-    struct iovec msg_vec[2];
-    struct msghdr msg;
-    msg.msg_name = NULL;
-    msg.msg_namelen = 0;
-    msg.msg_flags = 0;
-    msg.msg_iov = msg_vec;
-    msg.msg_iovlen = 2; // header and payload;
-    msg.msg_control = NULL;
-    msg.msg_controllen = 0;
-
-    msg.msg_iov[0].iov_base = &header;
-    msg.msg_iov[0].iov_len = sizeof(header);
-
-    pthread_mutex_lock(&handle->dbLock);
-
-    int nrUdpLists = arrayList_size(handle->udpPartLists);
-    int i;
-    bool found = false;
-    for (i = 0; i < nrUdpLists; i++) {
-        udpPartList_t *udpPartList = arrayList_get(handle->udpPartLists, i);
-        if (udpPartList->msg_ident == header.msg_ident) {
-            found = true;
-
-            //sanity check
-            if (udpPartList->msg_size != header.total_msg_size) {
-                // Corruption occurred. Remove the existing administration and build up a new one.
-                arrayList_remove(handle->udpPartLists, i);
-                free(udpPartList->data);
-                free(udpPartList);
-                found = false;
-                break;
-            }
-
-            msg.msg_iov[1].iov_base = &udpPartList->data[header.offset];
-            msg.msg_iov[1].iov_len = header.part_msg_size;
-            if (recvmsg(fd, &msg, 0)<0) {
-                found=true;
-                result=false;
-                break;
-            }
-
-            udpPartList->nrPartsRemaining--;
-            if (udpPartList->nrPartsRemaining == 0) {
-                *index = i;
-                *size = udpPartList->msg_size;
-                result = true;
-                break;
-            } else {
-                result = false; // not complete
-                break;
-            }
+    if (slot->capacity < header->total_msg_size) {
+        char *data = realloc(slot->data, header->total_msg_size);
+        if (data == NULL) {
+            slot->inUse = false;
+            return NULL;
         }
+        slot->data = data;
+        slot->capacity = header->total_msg_size;
     }
+    slot->inUse = true;
+    slot->msg_ident = header->msg_ident;
+    slot->msg_size = header->total_msg_size;
+    slot->nrPartsRemaining = header->total_msg_size / MAX_PART_SIZE + 1;
+    return slot;
+}
 
-    if (found == false) {
-        udpPartList_t *udpPartList = NULL;
-        if (nrUdpLists == handle->maxNrLists) {
-            // remove list at index 0
-            udpPartList = arrayList_remove(handle->udpPartLists, 0);
-            fprintf(stderr, "ERROR: Removing entry for id %d: %d parts not received\n",udpPartList->msg_ident, udpPartList->nrPartsRemaining );
-            free(udpPartList->data);
-            free(udpPartList);
-            nrUdpLists--;
+static recvBatch_t* largeUdp_createRecvBatch(void) {
+    recvBatch_t *batch = calloc(1, sizeof(*batch));
+    if (batch != NULL) {
+        batch->payloads = malloc(MAX_RECV_BATCH_SIZE * RECV_BUFFER_STRIDE);
+        if (batch->payloads == NULL) {
+            free(batch);
+            return NULL;
         }
-        udpPartList = calloc(sizeof(*udpPartList), 1);
-        udpPartList->msg_ident =  header.msg_ident;
-        udpPartList->msg_size =  header.total_msg_size;
-        udpPartList->nrPartsRemaining = header.total_msg_size / MAX_PART_SIZE;
-        udpPartList->data = calloc(sizeof(char), header.total_msg_size);
-
-        msg.msg_iov[1].iov_base = &udpPartList->data[header.offset];
-        msg.msg_iov[1].iov_len = header.part_msg_size;
-        if (recvmsg(fd, &msg, 0)<0) {
-            free(udpPartList->data);
-            free(udpPartList);
-            result=false;
-        } else {
-            arrayList_add(handle->udpPartLists, udpPartList);
-
-            if (udpPartList->nrPartsRemaining == 0) {
-                *index = nrUdpLists;
-                *size = udpPartList->msg_size;
-                result = true;
-            } else {
-                result = false;
-            }
+        for (int i = 0; i < MAX_RECV_BATCH_SIZE; ++i) {
+            batch->iovecs[i][0].iov_base = &batch->headers[i];
+            batch->iovecs[i][0].iov_len = sizeof(batch->headers[i]);
+            batch->iovecs[i][1].iov_base = batch->payloads + i * RECV_BUFFER_STRIDE;
+            batch->iovecs[i][1].iov_len = MAX_PART_SIZE;
         }
-
     }
-
-    pthread_mutex_unlock(&handle->dbLock);
-
-    return result;
+    return batch;
 }
 
 //
-// Read out the message which is indicated available by the largeUdp_dataAvailable function
+// Reads all datagrams available on the filedescriptor (determined by epoll()) in batches and reassembles them in the
+// preallocated slots. Messages which fit in a single datagram are delivered directly from the receive buffer.
 //
-int largeUdp_read(largeUdp_t *handle, unsigned int index, void ** buffer, unsigned int size)
-{
-    int result = 0;
+int largeUdp_receive(largeUdp_t *handle, int fd, largeUdp_msgReceived_fp callback, void *callbackHandle) {
+    int total = 0;
     pthread_mutex_lock(&handle->dbLock);
+    if (handle->recvBatch == NULL) {
+        handle->recvBatch = largeUdp_createRecvBatch();
+        if (handle->recvBatch == NULL) {
+            pthread_mutex_unlock(&handle->dbLock);
+            return -1;
+        }
+    }
+    recvBatch_t *batch = handle->recvBatch;
+
+    int n = MAX_RECV_BATCH_SIZE;
+    while (n == MAX_RECV_BATCH_SIZE) {
+        for (int i = 0; i < MAX_RECV_BATCH_SIZE; ++i) {
+            memset(&batch->msgs[i], 0, sizeof(batch->msgs[i]));
+            batch->msgs[i].msg_hdr.msg_iov = batch->iovecs[i];
+            batch->msgs[i].msg_hdr.msg_iovlen = 2;
+        }
+        n = largeUdp_recvBatch(fd, batch->msgs, MAX_RECV_BATCH_SIZE);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("recvmmsg()");
+                total = total == 0 ? -1 : total;
+            }
+            break;
+        }
+        total += n;
+
+        for (int i = 0; i < n; ++i) {
+            msg_part_header_t *header = &batch->headers[i];
+            char *payload = batch->iovecs[i][1].iov_base;
+            unsigned int len = batch->msgs[i].msg_len;
+            if (len < sizeof(*header) ||
+                    len - sizeof(*header) != header->part_msg_size ||
+                    header->offset > header->total_msg_size ||
+                    header->part_msg_size > header->total_msg_size - header->offset) {
+                fprintf(stderr, "ERROR: Dropping invalid UDP part for id %d\n", header->msg_ident);
+                continue;
+            }
+
+            if (header->offset == 0 && header->part_msg_size == header->total_msg_size) {
+                //message fits in a single datagram, no reassembly needed
+                callback(callbackHandle, payload, header->total_msg_size);
+                continue;
+            }
 
-    udpPartList_t *udpPartList = arrayList_remove(handle->udpPartLists, index);
-    if (udpPartList) {
-        *buffer = udpPartList->data;
-        free(udpPartList);
-    } else {
-        result = -1;
+            udpPartSlot_t *slot = largeUdp_findOrClaimSlot(handle, header);
+            if (slot == NULL) {
+                continue;
+            }
+            memcpy(slot->data + header->offset, payload, header->part_msg_size);
+            slot->lastUsed = ++handle->useCounter;
+            slot->nrPartsRemaining--;
+            if (slot->nrPartsRemaining == 0) {
+                slot->inUse = false;
+                callback(callbackHandle, slot->data, slot->msg_size);
+            }
+        }
     }
-    pthread_mutex_unlock(&handle->dbLock);
 
-    return result;
+    pthread_mutex_unlock(&handle->dbLock);
+    return total;
 }
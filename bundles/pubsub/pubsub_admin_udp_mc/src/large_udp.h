@@ -35,12 +35,23 @@
 
 typedef struct largeUdp largeUdp_t;
 
+/**
+ * Called for every completely reassembled message.
+ * The data is owned by the largeUdp handle and is only valid during the callback.
+ */
+typedef void (*largeUdp_msgReceived_fp)(void *handle, void *data, unsigned int size);
+
 largeUdp_t *largeUdp_create(unsigned int maxNrUdpReceptions);
 void largeUdp_destroy(largeUdp_t *handle);
 
 int largeUdp_sendto(largeUdp_t *handle, int fd, void *buf, size_t count, int flags, struct sockaddr_in *dest_addr, size_t addrlen);
 int largeUdp_sendmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovec, int len, int flags, struct sockaddr_in *dest_addr, size_t addrlen);
-bool largeUdp_dataAvailable(largeUdp_t *handle, int fd, unsigned int *index, unsigned int *size);
-int largeUdp_read(largeUdp_t *handle, unsigned int index, void ** buffer, unsigned int size);
+
+/**
+ * Reads all datagrams currently queued on the (non blocking read) filedescriptor, using as few syscalls as possible,
+ * and reassembles them. For every completed message the provided callback is called.
+ * Returns the number of datagrams read or -1 on error.
+ */
+int largeUdp_receive(largeUdp_t *handle, int fd, largeUdp_msgReceived_fp callback, void *callbackHandle);
 
 #endif /* _LARGE_UDP_H_ */
@@ -110,6 +110,7 @@ typedef struct pubsub_udp_msg {
 static void pubsub_udpmcTopicReceiver_addSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
 static void pubsub_udpmcTopicReceiver_removeSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
 static void psa_udpmc_processMsg(pubsub_udpmc_topic_receiver_t *receiver, pubsub_udp_msg_t *msg);
+static void psa_udpmc_msgReceived(void *handle, void *data, unsigned int size);
 static void* psa_udpmc_recvThread(void * data);
 static void psa_udpmc_connectToAllRequestedConnections(pubsub_udpmc_topic_receiver_t *receiver);
 static void psa_udpmc_initializeAllSubscribers(pubsub_udpmc_topic_receiver_t *receiver);
@@ -429,24 +430,13 @@ static void* psa_udpmc_recvThread(void * data) {
 #endif
         int i;
         for (i = 0; i < nfds; i++ ) {
-            unsigned int index;
-            unsigned int size;
 #if defined(__APPLE__)
             int fd = events[i].ident;
 #else
             int fd = events[i].data.fd;
 #endif
-            if (largeUdp_dataAvailable(receiver->largeUdpHandle, fd, &index, &size) == true) {
-                // Handle data
-                pubsub_udp_msg_t *udpMsg = NULL;
-                if (largeUdp_read(receiver->largeUdpHandle, index, (void**) &udpMsg, size) != 0) {
-                    printf("[PSA_UDPMC]: ERROR largeUdp_read with index %d\n", index);
-                    continue;
-                }
-
-                psa_udpmc_processMsg(receiver, udpMsg);
-
-                free(udpMsg);
+            if (largeUdp_receive(receiver->largeUdpHandle, fd, psa_udpmc_msgReceived, receiver) < 0) {
+                L_WARN("[PSA_UDPMC]: Error receiving data on fd %i\n", fd);
             }
         }
 
@@ -466,6 +456,15 @@ static void* psa_udpmc_recvThread(void * data) {
     return NULL;
 }
 
+static void psa_udpmc_msgReceived(void *handle, void *data, unsigned int size) {
+    pubsub_udpmc_topic_receiver_t *receiver = handle;
+    if (size < sizeof(pubsub_udp_msg_t)) {
+        L_WARN("[PSA_UDPMC] Received message too small (%u bytes).\n", size);
+        return;
+    }
+    psa_udpmc_processMsg(receiver, data);
+}
+
 static void psa_udpmc_processMsg(pubsub_udpmc_topic_receiver_t *receiver, pubsub_udp_msg_t *msg) {
     celixThreadMutex_lock(&receiver->subscribers.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
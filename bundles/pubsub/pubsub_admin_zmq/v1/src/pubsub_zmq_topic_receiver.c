@@ -119,9 +119,16 @@ typedef struct psa_zmq_subscriber_metrics_entry_t {
     unsigned long nrOfMissingSeqNumbers;
 } psa_zmq_subscriber_metrics_entry_t;
 
+typedef struct psa_zmq_subscriber_latency_entry {
+    pubsub_latency_histogram_t wireLatency;
+    pubsub_latency_histogram_t deserializationLatency;
+    pubsub_latency_histogram_t callbackLatency;
+} psa_zmq_subscriber_latency_entry_t;
+
 typedef struct psa_zmq_subscriber_entry {
     hash_map_t *msgTypes; //map from serializer svc
     hash_map_t *metrics; //key = msg type id, value = hash_map (key = origin uuid, value = psa_zmq_subscriber_metrics_entry_t*
+    hash_map_t *latencies; //key = msg type id, value = psa_zmq_subscriber_latency_entry_t*
     hash_map_t *subscriberServices; //key = servide id, value = pubsub_subscriber_t*
     bool initialized; //true if the init function is called through the receive thread
 } psa_zmq_subscriber_entry_t;
@@ -300,15 +307,16 @@ void pubsub_zmqTopicReceiver_destroy(pubsub_zmq_topic_receiver_t *receiver) {
             if (entry != NULL)  {
                 receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
                 hashMap_destroy(entry->subscriberServices, false, false);
-                free(entry);
-            }
 
-            hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
-            while (hashMapIterator_hasNext(&iter2)) {
-                hash_map_t *origins = hashMapIterator_nextValue(&iter2);
-                hashMap_destroy(origins, true, true);
+                hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
+                while (hashMapIterator_hasNext(&iter2)) {
+                    hash_map_t *origins = hashMapIterator_nextValue(&iter2);
+                    hashMap_destroy(origins, true, true);
+                }
+                hashMap_destroy(entry->metrics, false, false);
+                hashMap_destroy(entry->latencies, false, true);
+                free(entry);
             }
-            hashMap_destroy(entry->metrics, false, false);
         }
         hashMap_destroy(receiver->subscribers.map, false, false);
 
@@ -448,11 +456,13 @@ static void pubsub_zmqTopicReceiver_addSubscriber(void *handle, void *svc, const
 
         if (rc == 0) {
             entry->metrics = hashMap_create(NULL, NULL, NULL, NULL);
+            entry->latencies = hashMap_create(NULL, NULL, NULL, NULL);
             hash_map_iterator_t iter = hashMapIterator_construct(entry->msgTypes);
             while (hashMapIterator_hasNext(&iter)) {
                 pubsub_msg_serializer_t *msgSer = hashMapIterator_nextValue(&iter);
                 hash_map_t *origins = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
                 hashMap_put(entry->metrics, (void*)(uintptr_t)msgSer->msgId, origins);
+                hashMap_put(entry->latencies, (void*)(uintptr_t)msgSer->msgId, calloc(1, sizeof(psa_zmq_subscriber_latency_entry_t)));
             }
         }
 
@@ -490,6 +500,7 @@ static void pubsub_zmqTopicReceiver_removeSubscriber(void *handle, void *svc, co
             hashMap_destroy(origins, true, true);
         }
         hashMap_destroy(entry->metrics, false, false);
+        hashMap_destroy(entry->latencies, false, true);
         hashMap_destroy(entry->subscriberServices, false, false);
         free(entry);
     }
@@ -499,7 +510,8 @@ static void pubsub_zmqTopicReceiver_removeSubscriber(void *handle, void *svc, co
 static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *receiver, psa_zmq_subscriber_entry_t* entry, pubsub_protocol_message_t *message, struct timespec *receiveTime) {
     //NOTE receiver->subscribers.mutex locked
     pubsub_msg_serializer_t* msgSer = hashMap_get(entry->msgTypes, (void*)(uintptr_t)(message->header.msgId));
-    bool monitor = receiver->metricsEnabled;
+    psa_zmq_subscriber_latency_entry_t *latency = receiver->metricsEnabled ? hashMap_get(entry->latencies, (void*)(uintptr_t)(message->header.msgId)) : NULL;
+    bool monitor = latency != NULL;
 
     //monitoring
     struct timespec beginSer;
@@ -520,6 +532,10 @@ static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *rec
             celix_status_t status = msgSer->deserialize(msgSer->handle, &deSerializeBuffer, 0, &deserializedMsg);
             if (monitor) {
                 clock_gettime(CLOCK_REALTIME, &endSer);
+                pubsub_latencyHistogram_recordInterval(&latency->deserializationLatency, &beginSer, &endSer);
+                if (message->header.sendTime != 0) {
+                    pubsub_latencyHistogram_recordSinceTimestamp(&latency->wireLatency, message->header.sendTime, receiveTime);
+                }
             }
             if (status == CELIX_SUCCESS) {
 
@@ -545,6 +561,11 @@ static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *rec
                             release = true;
                         }
                     }
+                    if (monitor) {
+                        struct timespec endCallback;
+                        clock_gettime(CLOCK_REALTIME, &endCallback);
+                        pubsub_latencyHistogram_recordInterval(&latency->callbackLatency, &endSer, &endCallback);
+                    }
                     if (release) {
                         msgSer->freeDeserializeMsg(msgSer->handle, deserializedMsg);
                     }
@@ -741,7 +762,20 @@ pubsub_admin_receiver_metrics_t* pubsub_zmqTopicReceiver_metrics(pubsub_zmq_topi
         psa_zmq_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
         hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
         while (hashMapIterator_hasNext(&iter2)) {
-            hash_map_t *origins = hashMapIterator_nextValue(&iter2);
+            hash_map_entry_t *metricsEntry = hashMapIterator_nextEntry(&iter2);
+            hash_map_t *origins = hashMapEntry_getValue(metricsEntry);
+            unsigned int msgTypeId = (unsigned int)(uintptr_t)hashMapEntry_getKey(metricsEntry);
+            psa_zmq_subscriber_latency_entry_t *latency = hashMap_get(entry->latencies, (void*)(uintptr_t)msgTypeId);
+            pubsub_msg_serializer_t *msgTypeSer = hashMap_get(entry->msgTypes, (void*)(uintptr_t)msgTypeId);
+            result->msgTypes[i].typeId = msgTypeId;
+            if (msgTypeSer) {
+                snprintf(result->msgTypes[i].typeFqn, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", msgTypeSer->msgName);
+            }
+            if (latency) {
+                pubsub_latencyHistogram_copy(&latency->wireLatency, &result->msgTypes[i].wireLatency);
+                pubsub_latencyHistogram_copy(&latency->deserializationLatency, &result->msgTypes[i].deserializationLatency);
+                pubsub_latencyHistogram_copy(&latency->callbackLatency, &result->msgTypes[i].callbackLatency);
+            }
             result->msgTypes[i].origins = calloc((size_t)hashMap_size(origins), sizeof(*(result->msgTypes[i].origins)));
             result->msgTypes[i].nrOfOrigins = hashMap_size(origins);
             int k = 0;
@@ -103,6 +103,8 @@ typedef struct psa_zmq_send_msg_entry {
         struct timespec lastMessageSend;
         double averageTimeBetweenMessagesInSeconds;
         double averageSerializationTimeInSeconds;
+        pubsub_latency_histogram_t serializationLatency; //lock free, not protected by mutex
+        pubsub_latency_histogram_t sendLatency; //lock free, not protected by mutex
     } metrics;
 } psa_zmq_send_msg_entry_t;
 
@@ -492,7 +494,7 @@ pubsub_admin_sender_metrics_t* pubsub_zmqTopicSender_metrics(pubsub_zmq_topic_se
         }
     }
 
-    result->msgMetrics = calloc(count, sizeof(*result));
+    result->msgMetrics = calloc(count, sizeof(*result->msgMetrics));
 
     iter = hashMapIterator_construct(sender->boundedServices.map);
     int i = 0;
@@ -508,6 +510,8 @@ pubsub_admin_sender_metrics_t* pubsub_zmqTopicSender_metrics(pubsub_zmq_topic_se
             result->msgMetrics[i].averageSerializationTimeInSeconds = mEntry->metrics.averageSerializationTimeInSeconds;
             result->msgMetrics[i].averageTimeBetweenMessagesInSeconds = mEntry->metrics.averageTimeBetweenMessagesInSeconds;
             result->msgMetrics[i].lastMessageSend = mEntry->metrics.lastMessageSend;
+            pubsub_latencyHistogram_copy(&mEntry->metrics.serializationLatency, &result->msgMetrics[i].serializationLatency);
+            pubsub_latencyHistogram_copy(&mEntry->metrics.sendLatency, &result->msgMetrics[i].sendLatency);
             result->msgMetrics[i].bndId = entry->bndId;
             result->msgMetrics[i].typeId = mEntry->type;
             snprintf(result->msgMetrics[i].typeFqn, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", mEntry->msgSer->msgName);
@@ -603,6 +607,8 @@ static int psa_zmq_topicPublicationSend(void* handle, unsigned int msgTypeId, co
                 message.header.payloadOffset = 0;
                 message.header.isLastSegment = 1;
                 message.header.convertEndianess = 0;
+                clock_gettime(CLOCK_REALTIME, &sendTime);
+                message.header.sendTime = (uint64_t) sendTime.tv_sec * 1000000000ULL + (uint64_t) sendTime.tv_nsec;
 
                 // increase seqNr
                 entry->seqNr++;
@@ -690,6 +696,11 @@ static int psa_zmq_topicPublicationSend(void* handle, unsigned int msgTypeId, co
 
                     __atomic_store_n(&entry->dataLocked, false, __ATOMIC_RELEASE);
                 }
+                if (monitor) {
+                    struct timespec sendEnd;
+                    clock_gettime(CLOCK_REALTIME, &sendEnd);
+                    pubsub_latencyHistogram_recordInterval(&entry->metrics.sendLatency, &sendTime, &sendEnd);
+                }
                 pubsubInterceptorHandler_invokePostSend(sender->interceptorsHandler, entry->msgSer->msgName, msgTypeId, inMsg, metadata);
 
                 if (message.metadata.metadata) {
@@ -718,6 +729,7 @@ static int psa_zmq_topicPublicationSend(void* handle, unsigned int msgTypeId, co
 
 
     if (monitor && entry != NULL) {
+        pubsub_latencyHistogram_recordInterval(&entry->metrics.serializationLatency, &serializationStart, &serializationEnd);
         celixThreadMutex_lock(&entry->metrics.mutex);
 
         long n = entry->metrics.nrOfMessagesSend + entry->metrics.nrOfMessagesSendFailed;
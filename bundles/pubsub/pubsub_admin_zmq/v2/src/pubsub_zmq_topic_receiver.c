@@ -95,6 +95,7 @@ struct pubsub_zmq_topic_receiver {
     struct {
         celix_thread_mutex_t mutex;
         hash_map_t *map; //key = bnd id, value = psa_zmq_subscriber_entry_t
+        hash_map_t *latencies; //key = msg type id, value = psa_zmq_subscriber_latency_entry_t*. Only filled if metrics are enabled
         bool allInitialized;
     } subscribers;
 };
@@ -105,6 +106,14 @@ typedef struct psa_zmq_requested_connection_entry {
     bool statically; //true if the connection is statically configured through the topic properties.
 } psa_zmq_requested_connection_entry_t;
 
+typedef struct psa_zmq_subscriber_latency_entry {
+    unsigned int msgTypeId;
+    char msgTypeFqn[PUBSUB_AMDIN_METRICS_NAME_MAX];
+    pubsub_latency_histogram_t wireLatency;
+    pubsub_latency_histogram_t deserializationLatency;
+    pubsub_latency_histogram_t callbackLatency;
+} psa_zmq_subscriber_latency_entry_t;
+
 typedef struct psa_zmq_subscriber_entry {
     hash_map_t *subscriberServices; //key = servide id, value = pubsub_subscriber_t*
     bool initialized; //true if the init function is called through the receive thread
@@ -207,6 +216,7 @@ pubsub_zmq_topic_receiver_t* pubsub_zmqTopicReceiver_create(celix_bundle_context
         celixThreadMutex_create(&receiver->recvThread.mutex, NULL);
 
         receiver->subscribers.map = hashMap_create(NULL, NULL, NULL, NULL);
+        receiver->subscribers.latencies = hashMap_create(NULL, NULL, NULL, NULL);
         receiver->requestedConnections.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
     }
 
@@ -287,6 +297,7 @@ void pubsub_zmqTopicReceiver_destroy(pubsub_zmq_topic_receiver_t *receiver) {
             }
         }
         hashMap_destroy(receiver->subscribers.map, false, false);
+        hashMap_destroy(receiver->subscribers.latencies, false, true);
         celixThreadMutex_unlock(&receiver->subscribers.mutex);
 
         celixThreadMutex_lock(&receiver->requestedConnections.mutex);
@@ -442,9 +453,9 @@ static void pubsub_zmqTopicReceiver_removeSubscriber(void *handle, void *svc, co
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
 }
 
-static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *receiver, psa_zmq_subscriber_entry_t* entry, pubsub_protocol_message_t *message, struct timespec *receiveTime) {
+static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *receiver, psa_zmq_subscriber_entry_t* entry, pubsub_protocol_message_t *message, psa_zmq_subscriber_latency_entry_t *latency) {
     //NOTE receiver->subscribers.mutex locked
-    bool monitor = receiver->metricsEnabled;
+    bool monitor = latency != NULL;
     psa_zmq_serializer_entry_t *msgSer = pubsub_zmqAdmin_acquireSerializerForMessageId(receiver->admin, receiver->serializerType, message->header.msgId);
 
     //monitoring
@@ -469,6 +480,10 @@ static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *rec
             celix_status_t status = msgSer->svc->deserialize(msgSer->svc->handle, &deSerializeBuffer, 0, &deserializedMsg);
             if (monitor) {
                 clock_gettime(CLOCK_REALTIME, &endSer);
+                pubsub_latencyHistogram_recordInterval(&latency->deserializationLatency, &beginSer, &endSer);
+                if (latency->msgTypeFqn[0] == '\0') {
+                    snprintf(latency->msgTypeFqn, sizeof(latency->msgTypeFqn), "%s", msgFqn);
+                }
             }
             if (status == CELIX_SUCCESS) {
                 uint32_t msgId = message->header.msgId;
@@ -492,6 +507,11 @@ static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *rec
                             release = true;
                         }
                     }
+                    if (monitor) {
+                        struct timespec endCallback;
+                        clock_gettime(CLOCK_REALTIME, &endCallback);
+                        pubsub_latencyHistogram_recordInterval(&latency->callbackLatency, &endSer, &endCallback);
+                    }
                     if (release) {
                         msgSer->svc->freeDeserializedMsg(msgSer->svc->handle, deserializedMsg);
                     }
@@ -511,11 +531,23 @@ static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *rec
 
 static inline void processMsg(pubsub_zmq_topic_receiver_t *receiver, pubsub_protocol_message_t *message, struct timespec *receiveTime) {
     celixThreadMutex_lock(&receiver->subscribers.mutex);
+    psa_zmq_subscriber_latency_entry_t *latency = NULL;
+    if (receiver->metricsEnabled) {
+        latency = hashMap_get(receiver->subscribers.latencies, (void*)(uintptr_t)message->header.msgId);
+        if (latency == NULL) {
+            latency = calloc(1, sizeof(*latency));
+            latency->msgTypeId = message->header.msgId;
+            hashMap_put(receiver->subscribers.latencies, (void*)(uintptr_t)message->header.msgId, latency);
+        }
+        if (message->header.sendTime != 0) {
+            pubsub_latencyHistogram_recordSinceTimestamp(&latency->wireLatency, message->header.sendTime, receiveTime);
+        }
+    }
     hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
     while (hashMapIterator_hasNext(&iter)) {
         psa_zmq_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
         if (entry != NULL) {
-            processMsgForSubscriberEntry(receiver, entry, message, receiveTime);
+            processMsgForSubscriberEntry(receiver, entry, message, latency);
         }
     }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
@@ -617,6 +649,23 @@ pubsub_admin_receiver_metrics_t* pubsub_zmqTopicReceiver_metrics(pubsub_zmq_topi
     pubsub_admin_receiver_metrics_t *result = calloc(1, sizeof(*result));
     snprintf(result->scope, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", receiver->scope == NULL ? PUBSUB_DEFAULT_ENDPOINT_SCOPE : receiver->scope);
     snprintf(result->topic, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", receiver->topic);
+
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    result->nrOfMsgTypes = (unsigned long)hashMap_size(receiver->subscribers.latencies);
+    result->msgTypes = calloc(result->nrOfMsgTypes, sizeof(*result->msgTypes));
+    int i = 0;
+    hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.latencies);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_zmq_subscriber_latency_entry_t *latency = hashMapIterator_nextValue(&iter);
+        result->msgTypes[i].typeId = latency->msgTypeId;
+        snprintf(result->msgTypes[i].typeFqn, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", latency->msgTypeFqn);
+        pubsub_latencyHistogram_copy(&latency->wireLatency, &result->msgTypes[i].wireLatency);
+        pubsub_latencyHistogram_copy(&latency->deserializationLatency, &result->msgTypes[i].deserializationLatency);
+        pubsub_latencyHistogram_copy(&latency->callbackLatency, &result->msgTypes[i].callbackLatency);
+        i += 1;
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+
     return result;
 }
 
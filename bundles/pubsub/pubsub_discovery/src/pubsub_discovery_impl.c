@@ -32,6 +32,7 @@
 #include "celix_properties.h"
 #include "celix_constants.h"
 #include "celix_threads.h"
+#include "celix_executor_service.h"
 #include "array_list.h"
 #include "utils.h"
 #include "celix_errno.h"
@@ -67,9 +68,8 @@ pubsub_discovery_t* pubsub_discovery_create(celix_bundle_context_t *context, cel
     celixThreadMutex_create(&disc->announcedEndpointsMutex, NULL);
     celixThreadMutex_create(&disc->discoveredEndpointsMutex, NULL);
 
-    celixThreadCondition_init(&disc->waitCond, NULL);
-    celixThreadMutex_create(&disc->runningMutex, NULL);
     disc->running = true;
+    disc->refreshTaskId = -1L;
 
 
     disc->verbose = celix_bundleContext_getPropertyAsBool(context, PUBSUB_ETCD_DISCOVERY_VERBOSE_KEY, PUBSUB_ETCD_DISCOVERY_DEFAULT_VERBOSE);
@@ -79,8 +79,15 @@ pubsub_discovery_t* pubsub_discovery_create(celix_bundle_context_t *context, cel
     long ttl = celix_bundleContext_getPropertyAsLong(context, PUBSUB_DISCOVERY_ETCD_TTL_KEY, PUBSUB_DISCOVERY_ETCD_TTL_DEFAULT);
 
     disc->etcdlib = etcdlib_create(etcdIp, etcdPort, ETCDLIB_NO_CURL_INITIALIZATION);
+    //note the TTL refresh runs on the framework executor, bound the blocking etcd batches
+    long refreshTimeout = celix_bundleContext_getPropertyAsLong(context, PUBSUB_ETCD_DISCOVERY_REFRESH_TIMEOUT_KEY, PUBSUB_ETCD_DISCOVERY_DEFAULT_REFRESH_TIMEOUT);
+    etcdlib_set_batch_timeout(disc->etcdlib, (int)refreshTimeout);
     disc->ttlForEntries = (int)ttl;
     disc->sleepInsecBetweenTTLRefresh = (int)(((float)ttl)/2.0);
+    if (disc->sleepInsecBetweenTTLRefresh < 1) {
+        //note an interval of 0 would schedule a one shot refresh
+        disc->sleepInsecBetweenTTLRefresh = 1;
+    }
     disc->pubsubPath = celix_bundleContext_getProperty(context, PUBSUB_DISCOVERY_SERVER_PATH_KEY, PUBSUB_DISCOVERY_SERVER_PATH_DEFAULT);
     disc->fwUUID = celix_bundleContext_getProperty(context, OSGI_FRAMEWORK_FRAMEWORK_UUID, NULL);
 
@@ -111,9 +118,6 @@ celix_status_t pubsub_discovery_destroy(pubsub_discovery_t *ps_discovery) {
     hashMap_destroy(ps_discovery->announcedEndpoints, false, false);
     celixThreadMutex_unlock(&ps_discovery->announcedEndpointsMutex);
     celixThreadMutex_destroy(&ps_discovery->announcedEndpointsMutex);
-    celixThreadCondition_destroy(&ps_discovery->waitCond);
-
-    celixThreadMutex_destroy(&ps_discovery->runningMutex);
 
     if (ps_discovery->etcdlib != NULL) {
         etcdlib_destroy(ps_discovery->etcdlib);
@@ -229,72 +233,101 @@ void* psd_watch(void *data) {
     long long mIndex = 0L;
     bool connected = false;
 
-    celixThreadMutex_lock(&disc->runningMutex);
-    bool running = disc->running;
-    celixThreadMutex_unlock(&disc->runningMutex);
-
-    while (running) {
+    while (__atomic_load_n(&disc->running, __ATOMIC_ACQUIRE)) {
         psd_watchSetupConnection(disc, &connected, &mIndex);
         psd_watchForChange(disc, &connected, &mIndex);
         psd_cleanupIfDisconnected(disc, &connected);
 
-        celixThreadMutex_lock(&disc->runningMutex);
-        if (!connected && disc->running) {
-            celixThreadCondition_timedwaitRelative(&disc->waitCond, &disc->runningMutex, 5, 0); //if not connected wait a few seconds
+        //if not connected wait a few seconds, in steps of 100ms so that stop is not delayed
+        for (int i = 0; !connected && i < 50 && __atomic_load_n(&disc->running, __ATOMIC_ACQUIRE); ++i) {
+            usleep(100000);
         }
-        running = disc->running;
-        celixThreadMutex_unlock(&disc->runningMutex);
     }
 
     return NULL;
 }
 
-void* psd_refresh(void *data) {
+static void psd_refresh(void *data) {
     pubsub_discovery_t *disc = data;
 
-    celixThreadMutex_lock(&disc->runningMutex);
-    bool running = disc->running;
-    celixThreadMutex_unlock(&disc->runningMutex);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
 
-    while (running) {
-        struct timespec start;
-        clock_gettime(CLOCK_MONOTONIC, &start);
+    celixThreadMutex_lock(&disc->announcedEndpointsMutex);
+    int size = hashMap_size(disc->announcedEndpoints);
+    pubsub_announce_entry_t **entries = calloc(size + 1, sizeof(*entries));
+    const char **keys = calloc(size + 1, sizeof(*keys));
+    char **values = calloc(size + 1, sizeof(*values));
+    int *rcs = calloc(size + 1, sizeof(*rcs));
+    int nrOfRefreshes = 0;
+    int nrOfSets = 0;
+
+    //refreshes are placed at the start, new (or lost) entries at the end of the arrays
+    hash_map_iterator_t iter = hashMapIterator_construct(disc->announcedEndpoints);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_announce_entry_t *entry = hashMapIterator_nextValue(&iter);
+        if (entry->isSet) {
+            entries[nrOfRefreshes] = entry;
+            keys[nrOfRefreshes] = entry->key;
+            nrOfRefreshes += 1;
+        } else {
+            nrOfSets += 1;
+            entries[size - nrOfSets] = entry;
+            keys[size - nrOfSets] = entry->key;
+            values[size - nrOfSets] = pubsub_discovery_createJsonEndpoint(entry->properties);
+        }
+    }
 
-        celixThreadMutex_lock(&disc->announcedEndpointsMutex);
-        hash_map_iterator_t iter = hashMapIterator_construct(disc->announcedEndpoints);
-        while (hashMapIterator_hasNext(&iter)) {
-            pubsub_announce_entry_t *entry = hashMapIterator_nextValue(&iter);
-            if (entry->isSet) {
-                //only refresh ttl -> no index update -> no watch trigger
-                int rc = etcdlib_refresh(disc->etcdlib, entry->key, disc->ttlForEntries);
-                if (rc != ETCDLIB_RC_OK) {
-                    L_WARN("[PSD] Warning: Cannot refresh etcd key %s\n", entry->key);
-                    entry->isSet = false;
-                    entry->errorCount += 1;
-                } else {
-                    entry->refreshCount += 1;
-                }
-            } else {
-                char *str = pubsub_discovery_createJsonEndpoint(entry->properties);
-                int rc = etcdlib_set(disc->etcdlib, entry->key, str, disc->ttlForEntries, false);
-                if (rc == ETCDLIB_RC_OK) {
-                    entry->isSet = true;
-                    entry->setCount += 1;
-                } else {
-                    L_WARN("[PSD] Warning: Cannot set endpoint in etcd for key %s\n", entry->key);
-                    entry->errorCount += 1;
-                }
-                free(str);
-            }
+    //only refresh ttl -> no index update -> no watch trigger. Note all keys are refreshed in one batch
+    etcdlib_refresh_multiple(disc->etcdlib, nrOfRefreshes, keys, disc->ttlForEntries, rcs);
+    for (int i = 0; i < nrOfRefreshes; ++i) {
+        pubsub_announce_entry_t *entry = entries[i];
+        if (rcs[i] != ETCDLIB_RC_OK) {
+            L_WARN("[PSD] Warning: Cannot refresh etcd key %s\n", entry->key);
+            entry->isSet = false;
+            entry->errorCount += 1;
+        } else {
+            entry->refreshCount += 1;
         }
-        celixThreadMutex_unlock(&disc->announcedEndpointsMutex);
+    }
 
-        celixThreadMutex_lock(&disc->runningMutex);
-        celixThreadCondition_timedwaitRelative(&disc->waitCond, &disc->runningMutex, disc->sleepInsecBetweenTTLRefresh, 0);
-        running = disc->running;
-        celixThreadMutex_unlock(&disc->runningMutex);
+    etcdlib_set_multiple(disc->etcdlib, nrOfSets, &keys[size - nrOfSets], (const char**)&values[size - nrOfSets], disc->ttlForEntries, &rcs[size - nrOfSets]);
+    for (int i = size - nrOfSets; i < size; ++i) {
+        pubsub_announce_entry_t *entry = entries[i];
+        if (rcs[i] == ETCDLIB_RC_OK) {
+            entry->isSet = true;
+            entry->setCount += 1;
+        } else {
+            L_WARN("[PSD] Warning: Cannot set endpoint in etcd for key %s\n", entry->key);
+            entry->errorCount += 1;
+        }
+        free(values[i]);
     }
-    return NULL;
+    celixThreadMutex_unlock(&disc->announcedEndpointsMutex);
+
+    free(entries);
+    free(keys);
+    free(values);
+    free(rcs);
+}
+
+static void psd_scheduleRefreshCallback(void *handle, void *svc) {
+    pubsub_discovery_t *disc = handle;
+    celix_executor_service_t *executor = svc;
+    disc->refreshTaskId = executor->schedule(executor->handle, CELIX_EXECUTOR_PRIORITY_NORMAL, 0, disc->sleepInsecBetweenTTLRefresh, disc, psd_refresh);
+}
+
+static void psd_submitRefreshCallback(void *handle, void *svc) {
+    celix_executor_service_t *executor = svc;
+    executor->submit(executor->handle, CELIX_EXECUTOR_PRIORITY_NORMAL, handle, psd_refresh);
+}
+
+static void psd_cancelRefreshCallback(void *handle, void *svc) {
+    pubsub_discovery_t *disc = handle;
+    celix_executor_service_t *executor = svc;
+    executor->cancel(executor->handle, disc->refreshTaskId);
+    executor->waitForTasks(executor->handle); //also wait for refreshes submitted by announceEndpoint
+    disc->refreshTaskId = -1L;
 }
 
 celix_status_t pubsub_discovery_start(pubsub_discovery_t *ps_discovery) {
@@ -302,8 +335,12 @@ celix_status_t pubsub_discovery_start(pubsub_discovery_t *ps_discovery) {
 
     celixThread_create(&ps_discovery->watchThread, NULL, psd_watch, ps_discovery);
     celixThread_setName(&ps_discovery->watchThread, "PubSub ETCD Watch");
-    celixThread_create(&ps_discovery->refreshTTLThread, NULL, psd_refresh, ps_discovery);
-    celixThread_setName(&ps_discovery->refreshTTLThread, "PubSub ETCD Refresh TTL");
+    //the TTL refresh is a periodic task on the framework executor, instead of a thread sleeping in a loop
+    celix_bundleContext_useService(ps_discovery->context, CELIX_EXECUTOR_SERVICE_NAME, ps_discovery, psd_scheduleRefreshCallback);
+    if (ps_discovery->refreshTaskId < 0) {
+        celix_logHelper_log(ps_discovery->logHelper, CELIX_LOG_LEVEL_ERROR, "[PSD] Cannot schedule the etcd TTL refresh");
+        status = CELIX_ILLEGAL_STATE;
+    }
 
     return status;
 }
@@ -311,13 +348,10 @@ celix_status_t pubsub_discovery_start(pubsub_discovery_t *ps_discovery) {
 celix_status_t pubsub_discovery_stop(pubsub_discovery_t *disc) {
     celix_status_t status = CELIX_SUCCESS;
 
-    celixThreadMutex_lock(&disc->runningMutex);
-    disc->running = false;
-    celixThreadCondition_broadcast(&disc->waitCond);
-    celixThreadMutex_unlock(&disc->runningMutex);
+    __atomic_store_n(&disc->running, false, __ATOMIC_RELEASE);
 
     celixThread_join(disc->watchThread, NULL);
-    celixThread_join(disc->refreshTTLThread, NULL);
+    celix_bundleContext_useService(disc->context, CELIX_EXECUTOR_SERVICE_NAME, disc, psd_cancelRefreshCallback);
 
     celixThreadMutex_lock(&disc->discoveredEndpointsMutex);
     hash_map_iterator_t iter = hashMapIterator_construct(disc->discoveredEndpoints);
@@ -405,9 +439,8 @@ celix_status_t pubsub_discovery_announceEndpoint(void *handle, const celix_prope
         hashMap_put(disc->announcedEndpoints, (void*)hashKey, entry);
         celixThreadMutex_unlock(&disc->announcedEndpointsMutex);
 
-        celixThreadMutex_lock(&disc->runningMutex);
-        celixThreadCondition_broadcast(&disc->waitCond);
-        celixThreadMutex_unlock(&disc->runningMutex);
+        //trigger an immediate refresh, so that the new entry is set in etcd
+        celix_bundleContext_useService(disc->context, CELIX_EXECUTOR_SERVICE_NAME, disc, psd_submitRefreshCallback);
     } else if (valid) {
         L_DEBUG("[PSD] Ignoring endpoint %s/%s because the visibility is not %s. Configured visibility is %s\n", scope == NULL ? "(null)" : scope, topic, PUBSUB_ENDPOINT_SYSTEM_VISIBILITY, visibility);
     }
@@ -32,6 +32,10 @@
 #define PUBSUB_ETCD_DISCOVERY_VERBOSE_KEY "PUBSUB_ETCD_DISCOVERY_VERBOSE"
 #define PUBSUB_ETCD_DISCOVERY_DEFAULT_VERBOSE false
 
+//max duration of one etcd batch (set or refresh) of the TTL refresh task, so that a framework executor thread is not blocked long
+#define PUBSUB_ETCD_DISCOVERY_REFRESH_TIMEOUT_KEY "PUBSUB_ETCD_DISCOVERY_REFRESH_TIMEOUT_IN_MS"
+#define PUBSUB_ETCD_DISCOVERY_DEFAULT_REFRESH_TIMEOUT 2000
+
 
 #define PUBSUB_DISCOVERY_SERVER_IP_KEY          "PUBSUB_DISCOVERY_ETCD_SERVER_IP"
 #define PUBSUB_DISCOVERY_SERVER_PORT_KEY        "PUBSUB_DISCOVERY_ETCD_SERVER_PORT"
@@ -57,11 +61,9 @@ typedef struct pubsub_discovery {
     celix_thread_mutex_t discoveredEndpointsListenersMutex;
     hash_map_pt discoveredEndpointsListeners; //key=svcId, value=pubsub_discovered_endpoint_listener_t
 
-    celix_thread_mutex_t runningMutex;
-    bool running;
-    celix_thread_cond_t  waitCond;
+    bool running; //atomic
     celix_thread_t watchThread;
-    celix_thread_t refreshTTLThread;
+    long refreshTaskId; //periodic TTL refresh task on the framework executor
 
     //configurable by config/env.
     const char *pubsubPath;
@@ -41,7 +41,7 @@ static const unsigned int PROTOCOL_WIRE_V1_ENVELOPE_VERSION = 1;
 
 static const unsigned int PROTOCOL_WIRE_V2_SYNC_HEADER = 0xABBADEAF;
 static const unsigned int PROTOCOL_WIRE_V2_SYNC_FOOTER = 0xDEAFABBA;
-static const unsigned int PROTOCOL_WIRE_V2_ENVELOPE_VERSION = 2;
+static const unsigned int PROTOCOL_WIRE_V2_ENVELOPE_VERSION = 3; //3: header contains send timestamp
 
 int pubsubProtocol_readChar(const unsigned char *data, int offset, uint8_t *val);
 int pubsubProtocol_readShort(const unsigned char *data, int offset, uint32_t convert, uint16_t *val);
@@ -55,6 +55,43 @@ int pubsubProtocol_writeLong(unsigned char *data, int offset, uint32_t convert,
 
 celix_status_t pubsubProtocol_encodePayload(pubsub_protocol_message_t *message, void **outBuffer, size_t *outLength);
 celix_status_t pubsubProtocol_encodeMetadata(pubsub_protocol_message_t *message, void **outBuffer, size_t *outLength);
+
+/**
+ * Encodes the message metadata into a caller owned buffer, starting at offset.
+ * The buffer is (re)allocated when it cannot hold offset + metadata + reserve bytes,
+ * so that a single buffer can be reused across messages.
+ *
+ * @param message message to use the metadata from
+ * @param buffer in/out buffer, can point to NULL
+ * @param bufferSize in/out capacity of the buffer
+ * @param offset offset in the buffer where the metadata is written
+ * @param reserve number of bytes which should be available after the metadata (e.g. for a footer)
+ * @param metadataLength output param for the length of the encoded metadata
+ * @return status code indicating failure or success
+ */
+celix_status_t pubsubProtocol_encodeMetadataInto(pubsub_protocol_message_t *message, void **buffer, size_t *bufferSize, size_t offset, size_t reserve, size_t *metadataLength);
+typedef celix_status_t (*pubsub_protocol_encode_part_fp)(void *handle, pubsub_protocol_message_t *message, void **outBuffer, size_t *outLength);
+
+/**
+ * Encodes header, metadata and footer of a message into a single caller owned buffer, as needed for the
+ * pubsub_protocol_service_t encodeFrame call. The wire protocol specific parts are encoded with the provided
+ * header and footer encode functions, which must write into the provided (non NULL) out buffer.
+ *
+ * @param handle handle passed to the encode functions
+ * @param message message to encode, the header metadataSize is updated
+ * @param headerSize (fixed) size of the encoded header
+ * @param footerSize (fixed) size of the encoded footer, can be 0
+ * @param encodeHeader function to encode the header
+ * @param encodeFooter function to encode the footer, only called if footerSize > 0
+ * @param buffer in/out buffer, can point to NULL
+ * @param bufferSize in/out capacity of the buffer
+ * @param headerLength output param for the length of the header at the start of the buffer
+ * @param trailerLength output param for the length of the metadata + footer directly after the header
+ * @return status code indicating failure or success
+ */
+celix_status_t pubsubProtocol_encodeFrameWith(void *handle, pubsub_protocol_message_t *message, size_t headerSize, size_t footerSize,
+                                              pubsub_protocol_encode_part_fp encodeHeader, pubsub_protocol_encode_part_fp encodeFooter,
+                                              void **buffer, size_t *bufferSize, size_t *headerLength, size_t *trailerLength);
 celix_status_t pubsubProtocol_decodePayload(void *data, size_t length, pubsub_protocol_message_t *message);
 celix_status_t pubsubProtocol_decodeMetadata(void *data, size_t length, pubsub_protocol_message_t *message);
 
@@ -21,51 +21,37 @@
 
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
 #include <ctype.h>
 #include "celix_byteswap.h"
 
-static celix_status_t pubsubProtocol_createNetstring(const char* string, char** netstringOut, int *netstringOutLength, int *netstringMemoryOutLength) {
-    celix_status_t status = CELIX_SUCCESS;
-
-    size_t str_len = strlen(string);
-    if (str_len == 0) {
-        // 0:,
-        if(*netstringOut == NULL) {
-            *netstringMemoryOutLength = 1024;
-            *netstringOut = calloc(1, 1024);
-            *netstringOutLength = 3;
+static celix_status_t pubsubProtocol_ensureCapacity(void **buffer, size_t *bufferSize, size_t needed) {
+    if (*buffer == NULL || *bufferSize < needed) {
+        size_t newSize = *bufferSize < 1024 ? 1024 : *bufferSize;
+        while (newSize < needed) {
+            newSize *= 2;
         }
-        if (*netstringOut == NULL) {
-            status = CELIX_ENOMEM;
-        } else {
-            *netstringOut[0] = '0';
-            *netstringOut[1] = ':';
-            *netstringOut[2] = ',';
-            *netstringOut[3] = '\0';
-        }
-    } else {
-        size_t numlen = ceil(log10(str_len + 1));
-        if(*netstringOut == NULL) {
-            *netstringMemoryOutLength = 1024;
-            *netstringOut = calloc(1, *netstringMemoryOutLength);
-            if (*netstringOut == NULL) {
-                return CELIX_ENOMEM;
-            }
-        } else if (*netstringMemoryOutLength < numlen + str_len + 2) {
-            free(*netstringOut);
-            while(*netstringMemoryOutLength < numlen + str_len + 2) {
-                *netstringMemoryOutLength *= 2;
-            }
-            *netstringOut = calloc(1, *netstringMemoryOutLength);
-            if (*netstringOut == NULL) {
-                return CELIX_ENOMEM;
-            }
+        void *tmp = realloc(*buffer, newSize);
+        if (tmp == NULL) {
+            return CELIX_ENOMEM;
         }
-        *netstringOutLength = numlen + str_len + 2;
-        sprintf(*netstringOut, "%zu:%s,", str_len, string);
+        *buffer = tmp;
+        *bufferSize = newSize;
     }
+    return CELIX_SUCCESS;
+}
 
+/* Writes `string` as netstring ("<len>:<string>,") at `idx` in the buffer, the buffer is grown when needed. */
+static celix_status_t pubsubProtocol_writeNetstring(const char *string, void **buffer, size_t *bufferSize, size_t *idx) {
+    size_t strLen = strlen(string);
+    // max 20 digits for the length + ':' + ',' + '\0' (written by snprintf)
+    celix_status_t status = pubsubProtocol_ensureCapacity(buffer, bufferSize, *idx + strLen + 23);
+    if (status == CELIX_SUCCESS) {
+        char *line = *buffer;
+        *idx += snprintf(line + *idx, 22, "%zu:", strLen);
+        memcpy(line + *idx, string, strLen);
+        *idx += strLen;
+        line[(*idx)++] = ',';
+    }
     return status;
 }
 
@@ -191,72 +177,62 @@ celix_status_t pubsubProtocol_encodePayload(pubsub_protocol_message_t *message,
 }
 
 celix_status_t pubsubProtocol_encodeMetadata(pubsub_protocol_message_t *message, void **outBuffer, size_t *outLength) {
-    celix_status_t status = CELIX_SUCCESS;
+    size_t bufferSize = *outBuffer == NULL ? 0 : *outLength;
+    return pubsubProtocol_encodeMetadataInto(message, outBuffer, &bufferSize, 0, 0, outLength);
+}
 
-    size_t lineMemoryLength = *outBuffer == NULL ? 1024 : *outLength;
-    unsigned char *line = *outBuffer == NULL ? calloc(1, lineMemoryLength) : *outBuffer;
-    size_t idx = 4;
-    size_t len = 0;
+celix_status_t pubsubProtocol_encodeMetadataInto(pubsub_protocol_message_t *message, void **buffer, size_t *bufferSize, size_t offset, size_t reserve, size_t *metadataLength) {
+    size_t idx = offset + sizeof(uint32_t);
+    celix_status_t status = pubsubProtocol_ensureCapacity(buffer, bufferSize, idx + reserve);
 
-    if (message->metadata.metadata != NULL && celix_properties_size(message->metadata.metadata) > 0) {
+    int size = 0;
+    if (status == CELIX_SUCCESS && message->metadata.metadata != NULL) {
+        size = celix_properties_size(message->metadata.metadata);
         const char *key;
-        char *keyNetString = NULL;
-        int netStringMemoryLength = 0;
-
         CELIX_PROPERTIES_FOR_EACH(message->metadata.metadata, key) {
             const char *val = celix_properties_get(message->metadata.metadata, key, "!Error!");
-
-            //refactoring these two copies to a function leads to a slow down of about 2x
-            int strlenKeyNetString = 0;
-            status = pubsubProtocol_createNetstring(key, &keyNetString, &strlenKeyNetString, &netStringMemoryLength);
-            if (status != CELIX_SUCCESS) {
-                break;
-            }
-
-            len += strlenKeyNetString;
-            if(lineMemoryLength < len + 1) {
-                lineMemoryLength *= 2;
-                unsigned char *tmp = realloc(line, lineMemoryLength);
-                if (!tmp) {
-                    free(line);
-                    status = CELIX_ENOMEM;
-                    break;
-                }
-                line = tmp;
+            status = pubsubProtocol_writeNetstring(key, buffer, bufferSize, &idx);
+            if (status == CELIX_SUCCESS) {
+                status = pubsubProtocol_writeNetstring(val, buffer, bufferSize, &idx);
             }
-            memcpy(line + idx, keyNetString, strlenKeyNetString);
-            idx += strlenKeyNetString;
-
-            status = pubsubProtocol_createNetstring(val, &keyNetString, &strlenKeyNetString, &netStringMemoryLength);
             if (status != CELIX_SUCCESS) {
                 break;
             }
-
-            len += strlenKeyNetString;
-            if(lineMemoryLength < len + 1) {
-                while(lineMemoryLength < len + 1) {
-                    lineMemoryLength *= 2;
-                }
-                unsigned char *tmp = realloc(line, lineMemoryLength);
-                if (!tmp) {
-                    free(line);
-                    status = CELIX_ENOMEM;
-                    break;
-                }
-                line = tmp;
-            }
-            memcpy(line + idx, keyNetString, strlenKeyNetString);
-            idx += strlenKeyNetString;
         }
-
-        free(keyNetString);
     }
-    int size = celix_properties_size(message->metadata.metadata);
-    pubsubProtocol_writeInt((unsigned char *) line, 0, true, size);
+    if (status == CELIX_SUCCESS) {
+        status = pubsubProtocol_ensureCapacity(buffer, bufferSize, idx + reserve);
+    }
+    if (status == CELIX_SUCCESS) {
+        pubsubProtocol_writeInt(*buffer, offset, true, size);
+        *metadataLength = idx - offset;
+    }
+    return status;
+}
 
-    *outBuffer = line;
-    *outLength = idx;
+celix_status_t pubsubProtocol_encodeFrameWith(void *handle, pubsub_protocol_message_t *message, size_t headerSize, size_t footerSize,
+                                              pubsub_protocol_encode_part_fp encodeHeader, pubsub_protocol_encode_part_fp encodeFooter,
+                                              void **buffer, size_t *bufferSize, size_t *headerLength, size_t *trailerLength) {
+    size_t metadataSize = 0;
+    celix_status_t status;
+    if (message->metadata.metadata != NULL) {
+        status = pubsubProtocol_encodeMetadataInto(message, buffer, bufferSize, headerSize, footerSize, &metadataSize);
+    } else {
+        status = pubsubProtocol_ensureCapacity(buffer, bufferSize, headerSize + footerSize);
+    }
 
+    if (status == CELIX_SUCCESS) {
+        message->header.metadataSize = metadataSize;
+        void *headerData = *buffer;
+        status = encodeHeader(handle, message, &headerData, headerLength);
+    }
+    if (status == CELIX_SUCCESS && footerSize > 0) {
+        void *footerData = (char *) *buffer + headerSize + metadataSize;
+        status = encodeFooter(handle, message, &footerData, &footerSize);
+    }
+    if (status == CELIX_SUCCESS) {
+        *trailerLength = metadataSize + footerSize;
+    }
     return status;
 }
 
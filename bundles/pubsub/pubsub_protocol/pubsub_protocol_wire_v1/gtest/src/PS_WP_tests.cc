@@ -283,3 +283,55 @@ TEST_F(WireProtocolV1Test, WireProtocolV1Test_DecodeFooter_Test) { // NOLINT(cer
     ASSERT_EQ(CELIX_SUCCESS, status);
     pubsubProtocol_destroy(wireprotocol);
 }
+
+TEST_F(WireProtocolV1Test, WireProtocolV1Test_EncodeFrame_Test) { // NOLINT(cert-err58-cpp)
+    pubsub_protocol_wire_v1_t *wireprotocol;
+    pubsubProtocol_create(&wireprotocol);
+
+    pubsub_protocol_message_t message;
+    memset(&message, 0, sizeof(message));
+    message.header.msgId = 1;
+    message.header.payloadSize = 2;
+    message.metadata.metadata = celix_properties_create();
+    celix_properties_set(message.metadata.metadata, "a", "b");
+
+    void *buffer = nullptr;
+    size_t bufferSize = 0;
+    size_t headerLength = 0;
+    size_t trailerLength = 0;
+    celix_status_t status = pubsubProtocol_encodeFrame(nullptr, &message, &buffer, &bufferSize, &headerLength, &trailerLength);
+    ASSERT_EQ(CELIX_SUCCESS, status);
+    ASSERT_EQ(24, headerLength);
+    ASSERT_EQ(12, trailerLength); //metadata, v1 has no footer
+    ASSERT_EQ(12, message.header.metadataSize);
+
+    //header and metadata must be decodable from the single buffer
+    pubsub_protocol_message_t decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    auto* data = static_cast<unsigned char*>(buffer);
+    ASSERT_EQ(CELIX_SUCCESS, pubsubProtocol_decodeHeader(nullptr, data, headerLength, &decoded));
+    EXPECT_EQ(1, decoded.header.msgId);
+    EXPECT_EQ(2, decoded.header.payloadSize);
+    EXPECT_EQ(12, decoded.header.metadataSize);
+    ASSERT_EQ(CELIX_SUCCESS, pubsubProtocol_v1_decodeMetadata(nullptr, data + headerLength, decoded.header.metadataSize, &decoded));
+    EXPECT_STREQ("b", celix_properties_get(decoded.metadata.metadata, "a", nullptr));
+
+    //buffer is reused for the next message
+    void* firstBuffer = buffer;
+    status = pubsubProtocol_encodeFrame(nullptr, &message, &buffer, &bufferSize, &headerLength, &trailerLength);
+    ASSERT_EQ(CELIX_SUCCESS, status);
+    EXPECT_EQ(firstBuffer, buffer);
+
+    //without metadata only the header is encoded
+    celix_properties_destroy(message.metadata.metadata);
+    message.metadata.metadata = nullptr;
+    status = pubsubProtocol_encodeFrame(nullptr, &message, &buffer, &bufferSize, &headerLength, &trailerLength);
+    ASSERT_EQ(CELIX_SUCCESS, status);
+    EXPECT_EQ(24, headerLength);
+    EXPECT_EQ(0, trailerLength);
+    EXPECT_EQ(0, message.header.metadataSize);
+
+    celix_properties_destroy(decoded.metadata.metadata);
+    free(buffer);
+    pubsubProtocol_destroy(wireprotocol);
+}
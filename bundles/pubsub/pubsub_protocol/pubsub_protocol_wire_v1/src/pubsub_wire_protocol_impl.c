@@ -163,10 +163,19 @@ celix_status_t pubsubProtocol_decodeHeader(void *handle, void *data, size_t leng
                 message->header.payloadPartSize = message->header.payloadSize;
                 message->header.payloadOffset   = 0;
                 message->header.isLastSegment   = 0x1;
+                message->header.sendTime        = 0;
             }
         }
     } else {
         status = CELIX_ILLEGAL_ARGUMENT;
     }
     return status;
-}
\ No newline at end of file
+}
+
+celix_status_t pubsubProtocol_encodeFrame(void *handle, pubsub_protocol_message_t *message, void **buffer, size_t *bufferSize, size_t *headerLength, size_t *trailerLength) {
+    size_t headerSize = 0;
+    size_t footerSize = 0;
+    pubsubProtocol_getHeaderSize(handle, &headerSize);
+    pubsubProtocol_getFooterSize(handle, &footerSize);
+    return pubsubProtocol_encodeFrameWith(handle, message, headerSize, footerSize, pubsubProtocol_encodeHeader, pubsubProtocol_encodeFooter, buffer, bufferSize, headerLength, trailerLength);
+}
@@ -50,6 +50,8 @@ celix_status_t pubsubProtocol_v1_decodePayload(void* handle, void *data, size_t
 celix_status_t pubsubProtocol_v1_decodeMetadata(void* handle, void *data, size_t length, pubsub_protocol_message_t *message);
 celix_status_t pubsubProtocol_decodeFooter(void* handle, void *data, size_t length, pubsub_protocol_message_t *message);
 
+celix_status_t pubsubProtocol_encodeFrame(void *handle, pubsub_protocol_message_t *message, void **buffer, size_t *bufferSize, size_t *headerLength, size_t *trailerLength);
+
 #ifdef __cplusplus
 }
 #endif
@@ -51,16 +51,17 @@ TEST_F(WireProtocolV2Test, WireProtocolV2Test_EncodeHeader_Test) { // NOLINT(cer
     message.header.payloadPartSize = 4;
     message.header.payloadOffset = 2;
     message.header.isLastSegment = 1;
+    message.header.sendTime = 5;
     message.header.convertEndianess = 1;
 
     void *headerData = nullptr;
     size_t headerLength = 0;
     celix_status_t status = pubsubProtocol_wire_v2_encodeHeader(nullptr, &message, &headerData, &headerLength);
 
-    unsigned char exp[40];
+    unsigned char exp[48];
     uint32_t s = bswap_32(0xABBADEAF);
     memcpy(exp, &s, sizeof(uint32_t));
-    uint32_t e = 0x02000000; //envelope version
+    uint32_t e = 0x03000000; //envelope version
     memcpy(exp+4, &e, sizeof(uint32_t));
     uint32_t m = 0x01000000; //msg id
     memcpy(exp+8, &m, sizeof(uint32_t));
@@ -78,10 +79,12 @@ TEST_F(WireProtocolV2Test, WireProtocolV2Test_EncodeHeader_Test) { // NOLINT(cer
     memcpy(exp+32, &ppo, sizeof(uint32_t));
     uint32_t ils = 0x01000000;
     memcpy(exp+36, &ils, sizeof(uint32_t));
+    uint64_t st = 0x0500000000000000; //send time
+    memcpy(exp+40, &st, sizeof(uint64_t));
 
     ASSERT_EQ(status, CELIX_SUCCESS);
-    ASSERT_EQ(40, headerLength);
-    for (int i = 0; i < 40; i++) {
+    ASSERT_EQ(48, headerLength);
+    for (int i = 0; i < 48; i++) {
         ASSERT_EQ(((unsigned char*) headerData)[i], exp[i]);
     }
 
@@ -93,10 +96,10 @@ TEST_F(WireProtocolV2Test, WireProtocolV2Test_DecodeHeader_Test) { // NOLINT(cer
     pubsub_protocol_wire_v2_t *wireprotocol;
     pubsubProtocol_wire_v2_create(&wireprotocol);
 
-    unsigned char exp[40];
+    unsigned char exp[48];
     uint32_t s = bswap_32(0xABBADEAF); //sync
     memcpy(exp, &s, sizeof(uint32_t));
-    uint32_t e = 0x02000000; //envelope version
+    uint32_t e = 0x03000000; //envelope version
     memcpy(exp+4, &e, sizeof(uint32_t));
     uint32_t m = 0x01000000; //msg id
     memcpy(exp+8, &m, sizeof(uint32_t));
@@ -114,10 +117,12 @@ TEST_F(WireProtocolV2Test, WireProtocolV2Test_DecodeHeader_Test) { // NOLINT(cer
     memcpy(exp+32, &ppo, sizeof(uint32_t));
     uint32_t ils = 0x01000000;
     memcpy(exp+36, &ils, sizeof(uint32_t));
+    uint64_t st = 0x0500000000000000; //send time
+    memcpy(exp+40, &st, sizeof(uint64_t));
 
     pubsub_protocol_message_t message;
 
-    celix_status_t status = pubsubProtocol_wire_v2_decodeHeader(nullptr, exp, 40, &message);
+    celix_status_t status = pubsubProtocol_wire_v2_decodeHeader(nullptr, exp, 48, &message);
 
     ASSERT_EQ(CELIX_SUCCESS, status);
     ASSERT_EQ(1, message.header.msgId);
@@ -129,6 +134,7 @@ TEST_F(WireProtocolV2Test, WireProtocolV2Test_DecodeHeader_Test) { // NOLINT(cer
     ASSERT_EQ(4, message.header.payloadPartSize);
     ASSERT_EQ(2, message.header.payloadOffset);
     ASSERT_EQ(1, message.header.isLastSegment);
+    ASSERT_EQ(5, message.header.sendTime);
     ASSERT_EQ(1, message.header.convertEndianess);
 
     pubsubProtocol_wire_v2_destroy(wireprotocol);
@@ -138,7 +144,7 @@ TEST_F(WireProtocolV2Test, WireProtocolV2Test_DecodeHeader_IncorrectSync_Test) {
     pubsub_protocol_wire_v2_t *wireprotocol;
     pubsubProtocol_wire_v2_create(&wireprotocol);
 
-    unsigned char exp[40];
+    unsigned char exp[48];
     uint32_t s = 0xBAABABBA;
     memcpy(exp, &s, sizeof(uint32_t));
     uint32_t e = 0x01000000;
@@ -156,7 +162,7 @@ TEST_F(WireProtocolV2Test, WireProtocolV2Test_DecodeHeader_IncorrectSync_Test) {
 
     pubsub_protocol_message_t message;
 
-    celix_status_t status = pubsubProtocol_wire_v2_decodeHeader(nullptr, exp, 40, &message);
+    celix_status_t status = pubsubProtocol_wire_v2_decodeHeader(nullptr, exp, 48, &message);
 
     ASSERT_EQ(CELIX_ILLEGAL_ARGUMENT, status);
 
@@ -167,7 +173,7 @@ TEST_F(WireProtocolV2Test, WireProtocolV2Test_DecodeHeader_IncorrectVersion_Test
     pubsub_protocol_wire_v2_t *wireprotocol;
     pubsubProtocol_wire_v2_create(&wireprotocol);
 
-    unsigned char exp[40];
+    unsigned char exp[48];
     uint32_t s = 0xABBADEAF;
     memcpy(exp, &s, sizeof(uint32_t));
     uint32_t e = 0x02000000;
@@ -185,7 +191,7 @@ TEST_F(WireProtocolV2Test, WireProtocolV2Test_DecodeHeader_IncorrectVersion_Test
 
     pubsub_protocol_message_t message;
 
-    celix_status_t status = pubsubProtocol_wire_v2_decodeHeader(nullptr, exp, 40, &message);
+    celix_status_t status = pubsubProtocol_wire_v2_decodeHeader(nullptr, exp, 48, &message);
 
     ASSERT_EQ(CELIX_ILLEGAL_ARGUMENT, status);
 
@@ -246,4 +252,49 @@ TEST_F(WireProtocolV2Test, WireProtocolV2Test_DecodeFooter_IncorrectSync_Test) {
     ASSERT_EQ(CELIX_ILLEGAL_ARGUMENT, status);
 
     pubsubProtocol_wire_v2_destroy(wireprotocol);
-}
\ No newline at end of file
+}
+TEST_F(WireProtocolV2Test, WireProtocolV2Test_EncodeFrame_Test) { // NOLINT(cert-err58-cpp)
+    pubsub_protocol_wire_v2_t *wireprotocol;
+    pubsubProtocol_wire_v2_create(&wireprotocol);
+
+    pubsub_protocol_message_t message;
+    memset(&message, 0, sizeof(message));
+    message.header.msgId = 1;
+    message.header.payloadSize = 2;
+    message.header.payloadPartSize = 2;
+    message.header.isLastSegment = 1;
+    message.metadata.metadata = celix_properties_create();
+    celix_properties_set(message.metadata.metadata, "a", "b");
+
+    void *buffer = nullptr;
+    size_t bufferSize = 0;
+    size_t headerLength = 0;
+    size_t trailerLength = 0;
+    celix_status_t status = pubsubProtocol_wire_v2_encodeFrame(nullptr, &message, &buffer, &bufferSize, &headerLength, &trailerLength);
+    ASSERT_EQ(CELIX_SUCCESS, status);
+    ASSERT_EQ(48, headerLength);
+    ASSERT_EQ(12 + 4, trailerLength); //metadata + footer
+    ASSERT_EQ(12, message.header.metadataSize);
+
+    //header, metadata and footer must be decodable from the single buffer
+    pubsub_protocol_message_t decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    auto* data = static_cast<unsigned char*>(buffer);
+    ASSERT_EQ(CELIX_SUCCESS, pubsubProtocol_wire_v2_decodeHeader(nullptr, data, headerLength, &decoded));
+    EXPECT_EQ(1, decoded.header.msgId);
+    EXPECT_EQ(12, decoded.header.metadataSize);
+    ASSERT_EQ(CELIX_SUCCESS, pubsubProtocol_wire_v2_decodeMetadata(nullptr, data + headerLength, decoded.header.metadataSize, &decoded));
+    EXPECT_STREQ("b", celix_properties_get(decoded.metadata.metadata, "a", nullptr));
+    EXPECT_EQ(CELIX_SUCCESS, pubsubProtocol_wire_v2_decodeFooter(nullptr, data + headerLength + decoded.header.metadataSize, 4, &decoded));
+
+    //buffer is reused for the next message
+    void* firstBuffer = buffer;
+    status = pubsubProtocol_wire_v2_encodeFrame(nullptr, &message, &buffer, &bufferSize, &headerLength, &trailerLength);
+    ASSERT_EQ(CELIX_SUCCESS, status);
+    EXPECT_EQ(firstBuffer, buffer);
+
+    celix_properties_destroy(decoded.metadata.metadata);
+    celix_properties_destroy(message.metadata.metadata);
+    free(buffer);
+    pubsubProtocol_wire_v2_destroy(wireprotocol);
+}
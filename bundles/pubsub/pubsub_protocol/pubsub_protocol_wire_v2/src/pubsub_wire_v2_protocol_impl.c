@@ -46,7 +46,7 @@ celix_status_t pubsubProtocol_wire_v2_destroy(pubsub_protocol_wire_v2_t* protoco
 }
 
 celix_status_t pubsubProtocol_wire_v2_getHeaderSize(void* handle, size_t *length) {
-    *length = sizeof(int) * 9 + sizeof(short) * 2; // header + sync + version = 36
+    *length = sizeof(int) * 9 + sizeof(short) * 2 + sizeof(uint64_t); // header + sync + version + send timestamp = 48
     return CELIX_SUCCESS;
 }
 
@@ -100,6 +100,7 @@ celix_status_t pubsubProtocol_wire_v2_encodeHeader(void *handle, pubsub_protocol
         idx = pubsubProtocol_writeInt(*outBuffer, idx, convert, message->header.payloadPartSize);
         idx = pubsubProtocol_writeInt(*outBuffer, idx, convert, message->header.payloadOffset);
         idx = pubsubProtocol_writeInt(*outBuffer, idx, convert, message->header.isLastSegment);
+        idx = pubsubProtocol_writeLong(*outBuffer, idx, convert, message->header.sendTime);
         *outLength = idx;
     }
 
@@ -160,7 +161,8 @@ celix_status_t pubsubProtocol_wire_v2_decodeHeader(void* handle, void *data, siz
                 idx = pubsubProtocol_readInt(data, idx, convert, &message->header.metadataSize);
                 idx = pubsubProtocol_readInt(data, idx, convert, &message->header.payloadPartSize);
                 idx = pubsubProtocol_readInt(data, idx, convert, &message->header.payloadOffset);
-                pubsubProtocol_readInt(data, idx, convert, &message->header.isLastSegment);
+                idx = pubsubProtocol_readInt(data, idx, convert, &message->header.isLastSegment);
+                pubsubProtocol_readLong(data, idx, convert, &message->header.sendTime);
             }
         }
     } else {
@@ -203,3 +205,11 @@ celix_status_t pubsubProtocol_wire_v2_decodePayload(void* handle __attribute__((
 celix_status_t pubsubProtocol_wire_v2_decodeMetadata(void* handle __attribute__((unused)), void *data, size_t length, pubsub_protocol_message_t *message) {
     return pubsubProtocol_decodeMetadata(data, length, message);
 }
+
+celix_status_t pubsubProtocol_wire_v2_encodeFrame(void *handle, pubsub_protocol_message_t *message, void **buffer, size_t *bufferSize, size_t *headerLength, size_t *trailerLength) {
+    size_t headerSize = 0;
+    size_t footerSize = 0;
+    pubsubProtocol_wire_v2_getHeaderSize(handle, &headerSize);
+    pubsubProtocol_wire_v2_getFooterSize(handle, &footerSize);
+    return pubsubProtocol_encodeFrameWith(handle, message, headerSize, footerSize, pubsubProtocol_wire_v2_encodeHeader, pubsubProtocol_wire_v2_encodeFooter, buffer, bufferSize, headerLength, trailerLength);
+}
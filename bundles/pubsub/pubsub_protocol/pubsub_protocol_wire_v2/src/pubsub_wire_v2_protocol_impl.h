@@ -51,6 +51,8 @@ celix_status_t pubsubProtocol_wire_v2_encodeMetadata(void* handle, pubsub_protoc
 celix_status_t pubsubProtocol_wire_v2_decodePayload(void* handle, void *data, size_t length, pubsub_protocol_message_t *message);
 celix_status_t pubsubProtocol_wire_v2_decodeMetadata(void* handle, void *data, size_t length, pubsub_protocol_message_t *message);
 
+celix_status_t pubsubProtocol_wire_v2_encodeFrame(void *handle, pubsub_protocol_message_t *message, void **buffer, size_t *bufferSize, size_t *headerLength, size_t *trailerLength);
+
 #ifdef __cplusplus
 }
 #endif
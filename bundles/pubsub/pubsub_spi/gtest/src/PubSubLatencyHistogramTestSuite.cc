@@ -0,0 +1,115 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#include <thread>
+#include <vector>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "pubsub_latency_histogram.h"
+
+class PubSubLatencyHistogramTestSuite : public ::testing::Test {
+public:
+    PubSubLatencyHistogramTestSuite() {
+        memset(&histogram, 0, sizeof(histogram));
+    }
+
+    pubsub_latency_histogram_t histogram{};
+};
+
+TEST_F(PubSubLatencyHistogramTestSuite, EmptyHistogram) {
+    EXPECT_EQ(0, pubsub_latencyHistogram_valueAtPercentile(&histogram, 50.0));
+    EXPECT_EQ(0.0, pubsub_latencyHistogram_mean(&histogram));
+}
+
+TEST_F(PubSubLatencyHistogramTestSuite, SmallValuesAreExact) {
+    for (uint64_t i = 1; i <= 10; ++i) {
+        pubsub_latencyHistogram_record(&histogram, i);
+    }
+    EXPECT_EQ(10, histogram.count);
+    EXPECT_EQ(55, histogram.sum);
+    EXPECT_EQ(10, histogram.max);
+    EXPECT_EQ(5, pubsub_latencyHistogram_valueAtPercentile(&histogram, 50.0));
+    EXPECT_EQ(10, pubsub_latencyHistogram_valueAtPercentile(&histogram, 100.0));
+    EXPECT_EQ(1, pubsub_latencyHistogram_valueAtPercentile(&histogram, 0.0));
+    EXPECT_DOUBLE_EQ(5.5, pubsub_latencyHistogram_mean(&histogram));
+}
+
+TEST_F(PubSubLatencyHistogramTestSuite, PercentilesWithinPrecision) {
+    //1..100000 us in ns
+    for (uint64_t i = 1; i <= 100000; ++i) {
+        pubsub_latencyHistogram_record(&histogram, i * 1000);
+    }
+    const double percentiles[] = {50.0, 90.0, 99.0, 99.9};
+    for (double p : percentiles) {
+        auto expected = static_cast<double>(p * 1000.0 * 1000.0);
+        auto value = static_cast<double>(pubsub_latencyHistogram_valueAtPercentile(&histogram, p));
+        EXPECT_GE(value, expected * 0.99) << "percentile " << p;
+        EXPECT_LE(value, expected * 1.13) << "percentile " << p; //sub bucket precision is 12.5%
+    }
+    EXPECT_EQ(100000000, pubsub_latencyHistogram_valueAtPercentile(&histogram, 100.0));
+}
+
+TEST_F(PubSubLatencyHistogramTestSuite, ValuesOutOfRangeAreCountedInLastBucket) {
+    pubsub_latencyHistogram_record(&histogram, UINT64_MAX);
+    EXPECT_EQ(1, histogram.buckets[PUBSUB_LATENCY_HISTOGRAM_NR_OF_BUCKETS - 1]);
+    EXPECT_EQ(UINT64_MAX, histogram.max);
+}
+
+TEST_F(PubSubLatencyHistogramTestSuite, RecordInterval) {
+    struct timespec start = {10, 900000000};
+    struct timespec end = {11, 100000000};
+    pubsub_latencyHistogram_recordInterval(&histogram, &start, &end);
+    EXPECT_EQ(1, histogram.count);
+    EXPECT_EQ(200000000, histogram.sum);
+
+    //negative intervals are ignored
+    pubsub_latencyHistogram_recordInterval(&histogram, &end, &start);
+    EXPECT_EQ(1, histogram.count);
+}
+
+TEST_F(PubSubLatencyHistogramTestSuite, RecordSinceTimestamp) {
+    struct timespec end = {11, 100000000};
+    pubsub_latencyHistogram_recordSinceTimestamp(&histogram, 10900000000ULL, &end);
+    EXPECT_EQ(1, histogram.count);
+    EXPECT_EQ(200000000, histogram.sum);
+
+    //timestamps after end are ignored
+    pubsub_latencyHistogram_recordSinceTimestamp(&histogram, 11100000001ULL, &end);
+    EXPECT_EQ(1, histogram.count);
+}
+
+TEST_F(PubSubLatencyHistogramTestSuite, ConcurrentRecording) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([this, t]{
+            for (uint64_t i = 0; i < 100000; ++i) {
+                pubsub_latencyHistogram_record(&histogram, i + t);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    pubsub_latency_histogram_t copy;
+    pubsub_latencyHistogram_copy(&histogram, &copy);
+    EXPECT_EQ(400000, copy.count);
+    EXPECT_EQ(100002, copy.max);
+}
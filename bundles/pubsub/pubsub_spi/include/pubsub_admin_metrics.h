@@ -23,6 +23,7 @@
 #include <uuid/uuid.h>
 #include <sys/time.h>
 #include "celix_array_list.h"
+#include "pubsub_latency_histogram.h"
 
 #define PUBSUB_ADMIN_METRICS_SERVICE_NAME   "pubsub_admin_metrics"
 
@@ -38,14 +39,25 @@ typedef struct pubsub_admin_sender_msg_type_metrics {
     struct timespec lastMessageSend;
     double averageTimeBetweenMessagesInSeconds;
     double averageSerializationTimeInSeconds;
+    pubsub_latency_histogram_t serializationLatency;
+    pubsub_latency_histogram_t sendLatency; //time spend in the admin to send (or queue) the serialized message
 } pubsub_admin_sender_msg_type_metrics_t;
 
+typedef struct pubsub_admin_sender_connection_metrics {
+    char url[PUBSUB_AMDIN_METRICS_NAME_MAX];
+    unsigned long sendQueueSize; //max number of queued messages for the connection, 0 if the connection has no send queue
+    unsigned long sendQueueDepth; //current number of queued messages for the connection
+    unsigned long nrOfDroppedMessages; //number of messages dropped because the send queue was full
+} pubsub_admin_sender_connection_metrics_t;
+
 typedef struct pubsub_admin_sender_metrics {
     char scope[PUBSUB_AMDIN_METRICS_NAME_MAX];
     char topic[PUBSUB_AMDIN_METRICS_NAME_MAX];
     unsigned long nrOfUnknownMessagesRetrieved;
     unsigned int nrOfmsgMetrics;
     pubsub_admin_sender_msg_type_metrics_t *msgMetrics; //size = nrOfMessageTypes
+    unsigned int nrOfConnectionMetrics;
+    pubsub_admin_sender_connection_metrics_t *connectionMetrics; //size = nrOfConnectionMetrics, optional (can be NULL)
 } pubsub_admin_sender_metrics_t;
 
 typedef struct pubsub_admin_receiver_metrics {
@@ -68,6 +80,9 @@ typedef struct pubsub_admin_receiver_metrics {
             double minDelayInSeconds;
             double maxDelayInSeconds;
         } *origins;
+        pubsub_latency_histogram_t wireLatency; //send timestamp (protocol header) to receive time, 0 entries if not supported by the protocol
+        pubsub_latency_histogram_t deserializationLatency;
+        pubsub_latency_histogram_t callbackLatency; //time spend in the subscriber receive callbacks
     } *msgTypes;
 } pubsub_admin_receiver_metrics_t;
 
@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_LATENCY_HISTOGRAM_H_
+#define PUBSUB_LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Log-bucketed (HDR style) latency histogram with values in nanoseconds.
+ *
+ * Every power of 2 is split in PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT linear sub buckets,
+ * which gives a relative precision of 1/8 (12.5%) over the complete range (1 ns - ~18 minutes).
+ * Values above the range are counted in the last bucket.
+ *
+ * Recording uses relaxed atomic operations only, so a histogram can be updated concurrently
+ * without a lock. A zero initialized histogram is empty.
+ */
+#define PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_BITS    3
+#define PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT   (1 << PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+#define PUBSUB_LATENCY_HISTOGRAM_MAX_VALUE_BITS     40
+#define PUBSUB_LATENCY_HISTOGRAM_NR_OF_BUCKETS \
+    ((PUBSUB_LATENCY_HISTOGRAM_MAX_VALUE_BITS - PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) * PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+
+typedef struct pubsub_latency_histogram {
+    uint64_t count;
+    uint64_t sum; //sum of all recorded values in ns
+    uint64_t max; //max recorded value in ns
+    uint64_t buckets[PUBSUB_LATENCY_HISTOGRAM_NR_OF_BUCKETS];
+} pubsub_latency_histogram_t;
+
+/**
+ * Records a value (in nanoseconds). Lock free and safe to call concurrently.
+ */
+void pubsub_latencyHistogram_record(pubsub_latency_histogram_t *histogram, uint64_t valueInNs);
+
+/**
+ * Records the time between start and end. Negative intervals (e.g. clock skew between hosts) are ignored.
+ */
+void pubsub_latencyHistogram_recordInterval(pubsub_latency_histogram_t *histogram, const struct timespec *start, const struct timespec *end);
+
+/**
+ * Records the time between a timestamp (in nanoseconds since epoch, CLOCK_REALTIME) and end.
+ * Negative intervals are ignored.
+ */
+void pubsub_latencyHistogram_recordSinceTimestamp(pubsub_latency_histogram_t *histogram, uint64_t timestampInNs, const struct timespec *end);
+
+/**
+ * Copies the histogram to out. The copy is not an atomic snapshot, but every counter is read atomically.
+ */
+void pubsub_latencyHistogram_copy(const pubsub_latency_histogram_t *histogram, pubsub_latency_histogram_t *out);
+
+/**
+ * Returns the value (in ns) at the given percentile (0.0 - 100.0), this is the highest value of the bucket
+ * the percentile falls in (capped by the max recorded value). Returns 0 for an empty histogram.
+ */
+uint64_t pubsub_latencyHistogram_valueAtPercentile(const pubsub_latency_histogram_t *histogram, double percentile);
+
+/**
+ * Returns the mean value in ns, or 0 for an empty histogram.
+ */
+double pubsub_latencyHistogram_mean(const pubsub_latency_histogram_t *histogram);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PUBSUB_LATENCY_HISTOGRAM_H_ */
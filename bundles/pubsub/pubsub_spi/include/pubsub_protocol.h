@@ -24,8 +24,8 @@
 #include "celix_properties.h"
 
 #define PUBSUB_PROTOCOL_SERVICE_NAME      "pubsub_protocol"
-#define PUBSUB_PROTOCOL_SERVICE_VERSION   "1.0.0"
-#define PUBSUB_PROTOCOL_SERVICE_RANGE     "[1,2)"
+#define PUBSUB_PROTOCOL_SERVICE_VERSION   "2.0.0"
+#define PUBSUB_PROTOCOL_SERVICE_RANGE     "[2,3)"
 
 typedef struct pubsub_protocol_header pubsub_protocol_header_t;
 
@@ -53,6 +53,10 @@ struct pubsub_protocol_header {
     uint32_t payloadPartSize;
     uint32_t payloadOffset;
     uint32_t isLastSegment;
+
+    /** Optional send timestamp in nanoseconds since epoch (CLOCK_REALTIME), set by the protocol admin.
+     *  0 if unknown or if the timestamp is not transmitted by the wire protocol */
+    uint64_t sendTime;
 };
 
 typedef struct pubsub_protocol_payload pubsub_protocol_payload_t;
@@ -232,6 +236,23 @@ typedef struct pubsub_protocol_service {
      * @return status code indicating failure or success
      */
     celix_status_t (*decodeFooter)(void* handle, void *data, size_t length, pubsub_protocol_message_t *message);
+
+    /**
+     * Optional (can be NULL). Encodes header, metadata and footer of a (not segmented) message in one pass into
+     * a single caller owned buffer, which can be reused across messages.
+     * The header is written at the start of the buffer, directly followed by the metadata and footer. The payload is
+     * expected to be sent between the header and the metadata (e.g. using iovecs), so it does not need to be copied.
+     * message.header.metadataSize is set by this call.
+     *
+     * @param handle handle for service
+     * @param message message to use header and metadata from
+     * @param buffer in/out caller owned buffer, (re)allocated when too small. Can point to NULL
+     * @param bufferSize in/out capacity of the buffer
+     * @param headerLength output param for the length of the encoded header (at the start of the buffer)
+     * @param trailerLength output param for the length of the encoded metadata and footer (directly after the header)
+     * @return status code indicating failure or success
+     */
+    celix_status_t (*encodeFrame)(void *handle, pubsub_protocol_message_t *message, void **buffer, size_t *bufferSize, size_t *headerLength, size_t *trailerLength);
 } pubsub_protocol_service_t;
 
 #endif /* PUBSUB_PROTOCOL_SERVICE_H_ */
@@ -42,6 +42,7 @@ void pubsub_freePubSubAdminMetrics(pubsub_admin_metrics_t *metrics) {
             for (int i = 0; i < celix_arrayList_size(metrics->senders); ++i) {
                 pubsub_admin_sender_metrics_t *m = celix_arrayList_get(metrics->senders, i);
                 free(m->msgMetrics);
+                free(m->connectionMetrics);
                 free(m);
             }
             celix_arrayList_destroy(metrics->senders);
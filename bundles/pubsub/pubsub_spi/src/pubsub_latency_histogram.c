@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdbool.h>
+
+#include "pubsub_latency_histogram.h"
+
+static inline unsigned int pubsub_latencyHistogram_bucketIndex(uint64_t value) {
+    if (value < PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+        return (unsigned int) value;
+    }
+    if (value >> PUBSUB_LATENCY_HISTOGRAM_MAX_VALUE_BITS) {
+        return PUBSUB_LATENCY_HISTOGRAM_NR_OF_BUCKETS - 1;
+    }
+    unsigned int msb = 63 - __builtin_clzll(value);
+    unsigned int shift = msb - PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+    unsigned int subBucket = (unsigned int) (value >> shift) & (PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1);
+    return (shift + 1) * PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + subBucket;
+}
+
+static inline uint64_t pubsub_latencyHistogram_bucketHighestValue(unsigned int index) {
+    if (index < PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+        return index;
+    }
+    unsigned int shift = index / PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1;
+    uint64_t lowest = (uint64_t) (PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + index % PUBSUB_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) << shift;
+    return lowest + ((uint64_t) 1 << shift) - 1;
+}
+
+void pubsub_latencyHistogram_record(pubsub_latency_histogram_t *histogram, uint64_t valueInNs) {
+    __atomic_fetch_add(&histogram->buckets[pubsub_latencyHistogram_bucketIndex(valueInNs)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->sum, valueInNs, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+    while (valueInNs > max && !__atomic_compare_exchange_n(&histogram->max, &max, valueInNs, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        //nop, max is updated by the failed compare exchange
+    }
+}
+
+void pubsub_latencyHistogram_recordInterval(pubsub_latency_histogram_t *histogram, const struct timespec *start, const struct timespec *end) {
+    int64_t diff = ((int64_t) end->tv_sec - (int64_t) start->tv_sec) * 1000000000LL + ((int64_t) end->tv_nsec - (int64_t) start->tv_nsec);
+    if (diff >= 0) {
+        pubsub_latencyHistogram_record(histogram, (uint64_t) diff);
+    }
+}
+
+void pubsub_latencyHistogram_recordSinceTimestamp(pubsub_latency_histogram_t *histogram, uint64_t timestampInNs, const struct timespec *end) {
+    uint64_t endInNs = (uint64_t) end->tv_sec * 1000000000ULL + (uint64_t) end->tv_nsec;
+    if (endInNs >= timestampInNs) {
+        pubsub_latencyHistogram_record(histogram, endInNs - timestampInNs);
+    }
+}
+
+void pubsub_latencyHistogram_copy(const pubsub_latency_histogram_t *histogram, pubsub_latency_histogram_t *out) {
+    out->count = 0;
+    for (unsigned int i = 0; i < PUBSUB_LATENCY_HISTOGRAM_NR_OF_BUCKETS; ++i) {
+        out->buckets[i] = __atomic_load_n(&histogram->buckets[i], __ATOMIC_RELAXED);
+        out->count += out->buckets[i];
+    }
+    out->sum = __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED);
+    out->max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+}
+
+uint64_t pubsub_latencyHistogram_valueAtPercentile(const pubsub_latency_histogram_t *histogram, double percentile) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+    percentile = percentile < 0.0 ? 0.0 : (percentile > 100.0 ? 100.0 : percentile);
+    uint64_t rank = (uint64_t) (percentile / 100.0 * (double) histogram->count + 0.5);
+    rank = rank == 0 ? 1 : rank;
+    uint64_t total = 0;
+    for (unsigned int i = 0; i < PUBSUB_LATENCY_HISTOGRAM_NR_OF_BUCKETS; ++i) {
+        total += histogram->buckets[i];
+        if (total >= rank) {
+            uint64_t value = pubsub_latencyHistogram_bucketHighestValue(i);
+            return value < histogram->max ? value : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+double pubsub_latencyHistogram_mean(const pubsub_latency_histogram_t *histogram) {
+    return histogram->count == 0 ? 0.0 : (double) histogram->sum / (double) histogram->count;
+}
@@ -1098,6 +1098,8 @@ static void pstm_setupTopicReceivers(pubsub_topology_manager_t *manager) {
     celix_arrayList_destroy(setupEntries);
 }
 
+//note not a framework scheduler task, the handling sets up and tears down topic senders/receivers (service
+//registrations and tracker callbacks) and a stop of this bundle on the framework event thread waits for its tasks
 static void *pstm_psaHandlingThread(void *data) {
     pubsub_topology_manager_t *manager = data;
 
@@ -1294,6 +1296,20 @@ static void fetchBundleName(void *handle, const bundle_t *bundle) {
     *out = celix_bundle_getSymbolicName(bundle);
 }
 
+static void pstm_printLatency(FILE *os, const char *name, const pubsub_latency_histogram_t *histogram) {
+    if (histogram->count == 0) {
+        return;
+    }
+    fprintf(os, "      |- %s latency (us): count = %lu, mean = %.1f, p50 = %.1f, p99 = %.1f, p99.9 = %.1f, max = %.1f\n",
+            name,
+            (unsigned long)histogram->count,
+            pubsub_latencyHistogram_mean(histogram) / 1000.0,
+            pubsub_latencyHistogram_valueAtPercentile(histogram, 50.0) / 1000.0,
+            pubsub_latencyHistogram_valueAtPercentile(histogram, 99.0) / 1000.0,
+            pubsub_latencyHistogram_valueAtPercentile(histogram, 99.9) / 1000.0,
+            histogram->max / 1000.0);
+}
+
 static celix_status_t pubsub_topologyManager_metrics(pubsub_topology_manager_t *manager, const char *commandLine __attribute__((unused)), FILE *os, FILE *errorStream __attribute__((unused))) {
     celix_array_list_t *psaMetrics = celix_arrayList_create();
     celixThreadMutex_lock(&manager->psaMetrics.mutex);
@@ -1324,8 +1340,15 @@ static celix_status_t pubsub_topologyManager_metrics(pubsub_topology_manager_t *
                 fprintf(os, "      |- serialization failed = %li\n", sm->msgMetrics[j].nrOfSerializationErrors);
                 fprintf(os, "      |- average serialization time = %f s\n", sm->msgMetrics[j].averageSerializationTimeInSeconds);
                 fprintf(os, "      |- average time between messages = %f s\n", sm->msgMetrics[j].averageTimeBetweenMessagesInSeconds);
+                pstm_printLatency(os, "serialization", &sm->msgMetrics[j].serializationLatency);
+                pstm_printLatency(os, "send", &sm->msgMetrics[j].sendLatency);
                 //TODO last msg send
             }
+            for (int j = 0; j < sm->nrOfConnectionMetrics; ++j) {
+                fprintf(os, "   |- Connection %s:\n", sm->connectionMetrics[j].url);
+                fprintf(os, "      |- send queue depth = %lu/%lu\n", sm->connectionMetrics[j].sendQueueDepth, sm->connectionMetrics[j].sendQueueSize);
+                fprintf(os, "      |- dropped messages = %lu\n", sm->connectionMetrics[j].nrOfDroppedMessages);
+            }
         }
         for (int k = 0; k < celix_arrayList_size(metrics->receivers); ++k) {
             pubsub_admin_receiver_metrics_t *rm = celix_arrayList_get(metrics->receivers, k);
@@ -1350,6 +1373,12 @@ static celix_status_t pubsub_topologyManager_metrics(pubsub_topology_manager_t *
                     fprintf(os, "      |- average serialization time = %fs\n", rm->msgTypes[j].origins[m].averageSerializationTimeInSeconds);
                     fprintf(os, "      |- average time between messages time = %fs\n", rm->msgTypes[j].origins[m].averageTimeBetweenMessagesInSeconds);
                 }
+                if (rm->msgTypes[j].wireLatency.count > 0 || rm->msgTypes[j].deserializationLatency.count > 0) {
+                    fprintf(os, "   |- Message '%s' latencies:\n", rm->msgTypes[j].typeFqn);
+                    pstm_printLatency(os, "wire", &rm->msgTypes[j].wireLatency);
+                    pstm_printLatency(os, "deserialization", &rm->msgTypes[j].deserializationLatency);
+                    pstm_printLatency(os, "callback", &rm->msgTypes[j].callbackLatency);
+                }
             }
         }
         pubsub_freePubSubAdminMetrics(metrics);
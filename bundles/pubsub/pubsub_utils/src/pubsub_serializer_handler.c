@@ -23,6 +23,7 @@
 #include <string.h>
 
 #include "celix_version.h"
+#include "celix_rcu_hash_map.h"
 #include "pubsub_message_serialization_service.h"
 #include "celix_log_helper.h"
 
@@ -50,8 +51,9 @@ struct pubsub_serializer_handler {
     long serializationSvcTrackerId;
     celix_log_helper_t *logHelper;
 
-    celix_thread_rwlock_t lock;
+    celix_thread_mutex_t mutex; //protects serializationServices, serializes the updates of highestRankingEntries
     hash_map_t *serializationServices; //key = msg id, value = sorted array list with pubsub_serialization_service_entry_t*
+    celix_rcu_hash_map_t *highestRankingEntries; //key = msg id, value = the first pubsub_serialization_service_entry_t* of serializationServices. Used for lock-free lookups.
 };
 
 static void addSerializationService(void *handle, void* svc, const celix_properties_t *props) {
@@ -80,12 +82,25 @@ int compareEntries(const void *a, const void *b) {
 }
 
 static pubsub_serialization_service_entry_t* findEntry(pubsub_serializer_handler_t* handler, uint32_t msgId) {
+    //NOTE should be called in a highestRankingEntries read section, the entry can be used until the read section ends
+    return celix_rcuHashMap_get(handler->highestRankingEntries, (void*)(uintptr_t)msgId);
+}
+
+/**
+ * Publishes the (new) highest ranking entry for the msg id. If the highest ranking entry is replaced or removed,
+ * this waits until the readers which could still use the old entry are done.
+ */
+static void updateHighestRankingEntry(pubsub_serializer_handler_t* handler, uint32_t msgId, celix_array_list_t* entries) {
     //NOTE assumes mutex is locked
-    celix_array_list_t* entries = hashMap_get(handler->serializationServices, (void*)(uintptr_t)msgId);
-    if (entries != NULL) {
-        return celix_arrayList_get(entries, 0); //NOTE if entries not null, always at least 1 entry
+    void* key = (void*)(uintptr_t)msgId;
+    if (entries == NULL || celix_arrayList_size(entries) == 0) {
+        celix_rcuHashMap_remove(handler->highestRankingEntries, key);
+    } else {
+        pubsub_serialization_service_entry_t* highest = celix_arrayList_get(entries, 0);
+        if (celix_rcuHashMap_get(handler->highestRankingEntries, key) != highest) {
+            celix_rcuHashMap_put(handler->highestRankingEntries, key, highest);
+        }
     }
-    return NULL;
 }
 
 static bool isCompatible(pubsub_serializer_handler_t* handler, pubsub_serialization_service_entry_t* entry, int serializedMajorVersion, int serializedMinorVersion) {
@@ -98,17 +113,6 @@ static bool isCompatible(pubsub_serializer_handler_t* handler, pubsub_serializat
     return compatible;
 }
 
-static const char* getMsgFqn(pubsub_serializer_handler_t* handler, uint32_t msgId) {
-    //NOTE assumes mutex is locked
-    const char *result = NULL;
-    celix_array_list_t* entries = hashMap_get(handler->serializationServices, (void*)(uintptr_t)msgId);
-    if (entries != NULL) {
-        pubsub_serialization_service_entry_t *entry = celix_arrayList_get(entries, 0); //NOTE if an entries exists, there is at least 1 entry.
-        result = entry->msgFqn;
-    }
-    return result;
-}
-
 pubsub_serializer_handler_t* pubsub_serializerHandler_create(celix_bundle_context_t* ctx, const char* serializerType, bool backwardCompatible) {
     pubsub_serializer_handler_t* handler = calloc(1, sizeof(*handler));
     handler->ctx = ctx;
@@ -116,8 +120,9 @@ pubsub_serializer_handler_t* pubsub_serializerHandler_create(celix_bundle_contex
 
     handler->logHelper = celix_logHelper_create(ctx, "celix_pubsub_serialization_handler");
 
-    celixThreadRwlock_create(&handler->lock, NULL);
+    celixThreadMutex_create(&handler->mutex, NULL);
     handler->serializationServices = hashMap_create(NULL, NULL, NULL, NULL);
+    handler->highestRankingEntries = celix_rcuHashMap_create(NULL, NULL);
 
     char *filter = NULL;
     asprintf(&filter, "(%s=%s)", PUBSUB_MESSAGE_SERIALIZATION_SERVICE_SERIALIZATION_TYPE_PROPERTY, serializerType);
@@ -138,7 +143,8 @@ pubsub_serializer_handler_t* pubsub_serializerHandler_create(celix_bundle_contex
 void pubsub_serializerHandler_destroy(pubsub_serializer_handler_t* handler) {
     if (handler != NULL) {
         celix_bundleContext_stopTracker(handler->ctx, handler->serializationSvcTrackerId);
-        celixThreadRwlock_destroy(&handler->lock);
+        celixThreadMutex_destroy(&handler->mutex);
+        celix_rcuHashMap_destroy(handler->highestRankingEntries);
         hash_map_iterator_t iter = hashMapIterator_construct(handler->serializationServices);
         while (hashMapIterator_hasNext(&iter)) {
             celix_array_list_t *entries = hashMapIterator_nextValue(&iter);
@@ -172,9 +178,10 @@ void pubsub_serializerHandler_addSerializationService(pubsub_serializer_handler_
         return;
     }
 
-    celixThreadRwlock_writeLock(&handler->lock);
+    celixThreadMutex_lock(&handler->mutex);
 
-    pubsub_serialization_service_entry_t* existingEntry = findEntry(handler, msgId);
+    celix_array_list_t *existingEntries = hashMap_get(handler->serializationServices, (void *) (uintptr_t) msgId);
+    pubsub_serialization_service_entry_t* existingEntry = existingEntries != NULL ? celix_arrayList_get(existingEntries, 0) : NULL;
 
     bool valid = true;
     if (existingEntry != NULL && strncmp(existingEntry->msgFqn, msgFqn, 1024*1024) != 0) {
@@ -205,10 +212,11 @@ void pubsub_serializerHandler_addSerializationService(pubsub_serializer_handler_
         celix_arrayList_sort(entries, compareEntries);
 
         hashMap_put(handler->serializationServices, (void *) (uintptr_t) msgId, entries);
+        updateHighestRankingEntry(handler, msgId, entries);
     } else {
         celix_version_destroy(msgVersion);
     }
-    celixThreadRwlock_unlock(&handler->lock);
+    celixThreadMutex_unlock(&handler->mutex);
 }
 
 void pubsub_serializerHandler_removeSerializationService(pubsub_serializer_handler_t* handler, pubsub_message_serialization_service_t* svc, const celix_properties_t* svcProperties) {
@@ -219,7 +227,7 @@ void pubsub_serializerHandler_removeSerializationService(pubsub_serializer_handl
         msgId = celix_utils_stringHash(msgFqn);
     }
 
-    celixThreadRwlock_writeLock(&handler->lock);
+    celixThreadMutex_lock(&handler->mutex);
     celix_array_list_t* entries = hashMap_get(handler->serializationServices, (void*)(uintptr_t)msgId);
     if (entries != NULL) {
         pubsub_serialization_service_entry_t *found = NULL;
@@ -232,6 +240,8 @@ void pubsub_serializerHandler_removeSerializationService(pubsub_serializer_handl
                 break;
             }
         }
+        //NOTE if found was the highest ranking entry, this waits until it is no longer used
+        updateHighestRankingEntry(handler, msgId, entries);
         if (found != NULL) {
             free(found->msgFqn);
             celix_version_destroy(found->msgVersion);
@@ -242,12 +252,12 @@ void pubsub_serializerHandler_removeSerializationService(pubsub_serializer_handl
             celix_arrayList_destroy(entries);
         }
     }
-    celixThreadRwlock_unlock(&handler->lock);
+    celixThreadMutex_unlock(&handler->mutex);
 }
 
 celix_status_t pubsub_serializerHandler_serialize(pubsub_serializer_handler_t* handler, uint32_t msgId, const void* input, struct iovec** output, size_t* outputIovLen) {
     celix_status_t status;
-    celixThreadRwlock_readLock(&handler->lock);
+    int token = celix_rcuHashMap_beginRead(handler->highestRankingEntries);
     pubsub_serialization_service_entry_t* entry = findEntry(handler, msgId);
     if (entry != NULL) {
         status = entry->svc->serialize(entry->svc->handle, input, output, outputIovLen);
@@ -255,13 +265,13 @@ celix_status_t pubsub_serializerHandler_serialize(pubsub_serializer_handler_t* h
         status = CELIX_ILLEGAL_ARGUMENT;
         L_ERROR("Cannot find message serialization service for msg id %u.", msgId);
     }
-    celixThreadRwlock_unlock(&handler->lock);
+    celix_rcuHashMap_endRead(handler->highestRankingEntries, token);
     return status;
 }
 
 celix_status_t pubsub_serializerHandler_freeSerializedMsg(pubsub_serializer_handler_t* handler, uint32_t msgId, struct iovec* input, size_t inputIovLen) {
     celix_status_t status = CELIX_SUCCESS;
-    celixThreadRwlock_readLock(&handler->lock);
+    int token = celix_rcuHashMap_beginRead(handler->highestRankingEntries);
     pubsub_serialization_service_entry_t* entry = findEntry(handler, msgId);
     if (entry != NULL) {
         entry->svc->freeSerializedMsg(entry->svc->handle, input, inputIovLen);
@@ -269,14 +279,14 @@ celix_status_t pubsub_serializerHandler_freeSerializedMsg(pubsub_serializer_hand
         status = CELIX_ILLEGAL_ARGUMENT;
         L_ERROR("Cannot find message serialization service for msg id %u.", msgId);
     }
-    celixThreadRwlock_unlock(&handler->lock);
+    celix_rcuHashMap_endRead(handler->highestRankingEntries, token);
     return status;
 
 }
 
 celix_status_t pubsub_serializerHandler_deserialize(pubsub_serializer_handler_t* handler, uint32_t msgId, int serializedMajorVersion, int serializedMinorVersion, const struct iovec* input, size_t inputIovLen, void** out) {
     celix_status_t status;
-    celixThreadRwlock_readLock(&handler->lock);
+    int token = celix_rcuHashMap_beginRead(handler->highestRankingEntries);
     pubsub_serialization_service_entry_t* entry = findEntry(handler, msgId);
     bool compatible = false;
     if (entry != NULL) {
@@ -293,13 +303,13 @@ celix_status_t pubsub_serializerHandler_deserialize(pubsub_serializer_handler_t*
         status = CELIX_ILLEGAL_ARGUMENT;
         L_ERROR("Cannot find message serialization service for msg id %u.", msgId);
     }
-    celixThreadRwlock_unlock(&handler->lock);
+    celix_rcuHashMap_endRead(handler->highestRankingEntries, token);
     return status;
 }
 
 celix_status_t pubsub_serializerHandler_freeDeserializedMsg(pubsub_serializer_handler_t* handler, uint32_t msgId, void* msg) {
     celix_status_t status = CELIX_SUCCESS;
-    celixThreadRwlock_readLock(&handler->lock);
+    int token = celix_rcuHashMap_beginRead(handler->highestRankingEntries);
     pubsub_serialization_service_entry_t* entry = findEntry(handler, msgId);
     if (entry != NULL) {
         entry->svc->freeDeserializedMsg(entry->svc->handle, msg);
@@ -307,32 +317,33 @@ celix_status_t pubsub_serializerHandler_freeDeserializedMsg(pubsub_serializer_ha
         status = CELIX_ILLEGAL_ARGUMENT;
         L_ERROR("Cannot find message serialization service for msg id %u.", msgId);
     }
-    celixThreadRwlock_unlock(&handler->lock);
+    celix_rcuHashMap_endRead(handler->highestRankingEntries, token);
     return status;
 }
 
 bool pubsub_serializerHandler_isMessageSupported(pubsub_serializer_handler_t* handler, uint32_t msgId, int majorVersion, int minorVersion) {
-    celixThreadRwlock_readLock(&handler->lock);
+    int token = celix_rcuHashMap_beginRead(handler->highestRankingEntries);
     bool compatible = false;
     pubsub_serialization_service_entry_t* entry = findEntry(handler, msgId);
     if (entry != NULL) {
         compatible = isCompatible(handler, entry, majorVersion, minorVersion);
     }
-    celixThreadRwlock_unlock(&handler->lock);
+    celix_rcuHashMap_endRead(handler->highestRankingEntries, token);
     return compatible;
 }
 
 char* pubsub_serializerHandler_getMsgFqn(pubsub_serializer_handler_t* handler, uint32_t msgId) {
-    celixThreadRwlock_readLock(&handler->lock);
-    char *msgFqn = celix_utils_strdup(getMsgFqn(handler, msgId));
-    celixThreadRwlock_unlock(&handler->lock);
+    int token = celix_rcuHashMap_beginRead(handler->highestRankingEntries);
+    pubsub_serialization_service_entry_t* entry = findEntry(handler, msgId);
+    char *msgFqn = entry != NULL ? celix_utils_strdup(entry->msgFqn) : NULL;
+    celix_rcuHashMap_endRead(handler->highestRankingEntries, token);
     return msgFqn;
 
 }
 
 uint32_t pubsub_serializerHandler_getMsgId(pubsub_serializer_handler_t* handler, const char* msgFqn) {
     uint32_t result = 0;
-    celixThreadRwlock_readLock(&handler->lock);
+    celixThreadMutex_lock(&handler->mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(handler->serializationServices);
     while (hashMapIterator_hasNext(&iter) && result == 0) {
         celix_array_list_t *entries = hashMapIterator_nextValue(&iter);
@@ -341,18 +352,18 @@ uint32_t pubsub_serializerHandler_getMsgId(pubsub_serializer_handler_t* handler,
             result = entry->msgId;
         }
     }
-    celixThreadRwlock_unlock(&handler->lock);
+    celixThreadMutex_unlock(&handler->mutex);
     return result;
 }
 
 size_t pubsub_serializerHandler_messageSerializationServiceCount(pubsub_serializer_handler_t* handler) {
     size_t count = 0;
-    celixThreadRwlock_readLock(&handler->lock);
+    celixThreadMutex_lock(&handler->mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(handler->serializationServices);
     while (hashMapIterator_hasNext(&iter)) {
         celix_array_list_t *entries = hashMapIterator_nextValue(&iter);
         count += celix_arrayList_size(entries);
     }
-    celixThreadRwlock_unlock(&handler->lock);
+    celixThreadMutex_unlock(&handler->mutex);
     return count;
 }
\ No newline at end of file
@@ -0,0 +1,407 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <curl/curl.h>
+
+#include "celix_api.h"
+#include "civetweb.h"
+
+extern "C" {
+#include "remote_constants.h"
+#include "discovery.h"
+#include "endpoint_descriptor_writer.h"
+}
+
+namespace {
+    constexpr auto WAIT_TIMEOUT = std::chrono::seconds{10};
+
+    /**
+     * Records the endpoints the poller adds and removes, see the discovery_add/removeDiscoveredEndpoint test doubles.
+     */
+    struct DiscoveredEndpoints {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        std::vector<std::string> added{};
+        std::vector<std::string> removed{};
+    };
+    DiscoveredEndpoints discovered{};
+}
+
+extern "C" celix_status_t discovery_addDiscoveredEndpoint(discovery_t*, endpoint_description_t *endpoint) {
+    std::lock_guard<std::mutex> lck{discovered.mutex};
+    discovered.added.emplace_back(endpoint->id);
+    discovered.cond.notify_all();
+    return CELIX_SUCCESS;
+}
+
+extern "C" celix_status_t discovery_removeDiscoveredEndpoint(discovery_t*, endpoint_description_t *endpoint) {
+    std::lock_guard<std::mutex> lck{discovered.mutex};
+    discovered.removed.emplace_back(endpoint->id);
+    discovered.cond.notify_all();
+    return CELIX_SUCCESS;
+}
+
+/**
+ * Minimal discovery server, which serves a configurable endpoint document. Supports ETags (incl. long-polls), unless
+ * the ETag is empty.
+ */
+class TestDiscoveryServer {
+public:
+    TestDiscoveryServer() {
+        mg_callbacks callbacks{};
+        callbacks.begin_request = handleRequest;
+        for (int port = 9110; ctx == nullptr && port < 9130; ++port) {
+            std::string listeningPort = "127.0.0.1:" + std::to_string(port);
+            const char *options[] = {"listening_ports", listeningPort.c_str(), "num_threads", "5", nullptr};
+            ctx = mg_start(&callbacks, this, options);
+            url = "http://127.0.0.1:" + std::to_string(port) + "/discovery";
+        }
+        EXPECT_NE(ctx, nullptr);
+    }
+
+    ~TestDiscoveryServer() {
+        {
+            std::lock_guard<std::mutex> lck{mutex};
+            stopping = true;
+            cond.notify_all();
+        }
+        mg_stop(ctx);
+    }
+
+    void setDocument(std::string doc, std::string newEtag) {
+        std::lock_guard<std::mutex> lck{mutex};
+        document = std::move(doc);
+        etag = std::move(newEtag);
+        cond.notify_all();
+    }
+
+    /**
+     * Waits till the predicate, called with the server lock taken, is true.
+     */
+    template<typename P>
+    bool waitFor(P predicate) {
+        std::unique_lock<std::mutex> lck{mutex};
+        return cond.wait_for(lck, WAIT_TIMEOUT, predicate);
+    }
+
+    std::mutex mutex{};
+    std::condition_variable cond{};
+    std::string url{};
+    std::string document{};
+    std::string etag{};
+    std::vector<std::string> ifNoneMatchHeaders{}; //If-None-Match header of every request, empty if not present
+    std::vector<std::string> queries{}; //query string of every request
+    int nrOfNotModifiedReplies = 0;
+    int nrOfDocumentReplies = 0;
+    bool stopping = false;
+private:
+    static int handleRequest(struct mg_connection *conn) {
+        const struct mg_request_info *info = mg_get_request_info(conn);
+        auto *server = static_cast<TestDiscoveryServer*>(info->user_data);
+        const char *ifNoneMatch = mg_get_header(conn, "If-None-Match");
+        int wait = 0;
+        char waitStr[16];
+        if (info->query_string != nullptr && mg_get_var(info->query_string, strlen(info->query_string), "wait", waitStr, sizeof(waitStr)) > 0) {
+            wait = atoi(waitStr);
+        }
+
+        std::unique_lock<std::mutex> lck{server->mutex};
+        server->ifNoneMatchHeaders.emplace_back(ifNoneMatch != nullptr ? ifNoneMatch : "");
+        server->queries.emplace_back(info->query_string != nullptr ? info->query_string : "");
+        server->cond.notify_all();
+
+        auto notModified = [server, ifNoneMatch]{ return !server->etag.empty() && ifNoneMatch != nullptr && server->etag == ifNoneMatch; };
+        if (notModified() && wait > 0) {
+            server->cond.wait_for(lck, std::chrono::seconds{wait}, [server, &notModified]{ return server->stopping || !notModified(); });
+        }
+        if (notModified()) {
+            server->nrOfNotModifiedReplies += 1;
+            mg_printf(conn, "HTTP/1.1 304 Not Modified\r\nETag: %s\r\n\r\n", server->etag.c_str());
+        } else {
+            server->nrOfDocumentReplies += 1;
+            std::string etagHeader = server->etag.empty() ? "" : "ETag: " + server->etag + "\r\n";
+            mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Type: application/xml;charset=utf-8\r\nContent-Length: %zu\r\n%s\r\n",
+                      server->document.size(), etagHeader.c_str());
+            mg_write(conn, server->document.c_str(), server->document.size());
+        }
+        server->cond.notify_all();
+        return 1;
+    }
+
+    struct mg_context *ctx = nullptr;
+};
+
+class EndpointDiscoveryPollerTestSuite : public ::testing::Test {
+public:
+    EndpointDiscoveryPollerTestSuite() {
+        auto* props = celix_properties_create();
+        celix_properties_set(props, OSGI_FRAMEWORK_FRAMEWORK_STORAGE, ".rsa_discovery_common_cache");
+        celix_properties_set(props, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(props, "DISCOVERY_CFG_POLL_INTERVAL", "1");
+        celix_properties_set(props, "DISCOVERY_CFG_POLL_TIMEOUT", "5");
+        celix_properties_set(props, DISCOVERY_SERVER_IP, "127.0.0.1");
+        celix_properties_set(props, DISCOVERY_SERVER_PORT, "9130");
+        celix_properties_set(props, DISCOVERY_POLL_ENDPOINTS, "");
+        auto* fwPtr = celix_frameworkFactory_createFramework(props);
+        auto* ctxPtr = celix_framework_getFrameworkContext(fwPtr);
+        fw = std::shared_ptr<celix_framework_t>{fwPtr, [](auto* f) {celix_frameworkFactory_destroyFramework(f);}};
+        ctx = std::shared_ptr<celix_bundle_context_t>{ctxPtr, [](auto*){/*nop*/}};
+
+        discovery = std::shared_ptr<discovery_t>{(discovery_t*)calloc(1, sizeof(discovery_t)), [](discovery_t *d) {
+            celix_logHelper_destroy(d->loghelper);
+            free(d);
+        }};
+        discovery->context = ctx.get();
+        discovery->loghelper = celix_logHelper_create(ctx.get(), "test_rsa_discovery_common");
+
+        std::lock_guard<std::mutex> lck{discovered.mutex};
+        discovered.added.clear();
+        discovered.removed.clear();
+    }
+
+    ~EndpointDiscoveryPollerTestSuite() override {
+        if (poller != nullptr) {
+            endpointDiscoveryPoller_destroy(poller);
+        }
+    }
+
+    void createPoller(const std::string& url) {
+        ASSERT_EQ(CELIX_SUCCESS, endpointDiscoveryPoller_create(discovery.get(), ctx.get(), "", &poller));
+        ASSERT_EQ(CELIX_SUCCESS, endpointDiscoveryPoller_addDiscoveryEndpoint(poller, (char*)url.c_str()));
+    }
+
+    static std::string createDocument(const std::vector<std::string>& endpointIds) {
+        array_list_pt endpoints = nullptr;
+        arrayList_create(&endpoints);
+        for (const auto& id : endpointIds) {
+            auto* props = celix_properties_create();
+            celix_properties_set(props, OSGI_RSA_ENDPOINT_ID, id.c_str());
+            celix_properties_set(props, OSGI_RSA_ENDPOINT_SERVICE_ID, "42");
+            celix_properties_set(props, OSGI_RSA_ENDPOINT_FRAMEWORK_UUID, "test-framework-uuid");
+            celix_properties_set(props, OSGI_FRAMEWORK_OBJECTCLASS, "org.apache.celix.Test");
+            celix_properties_set(props, OSGI_RSA_SERVICE_IMPORTED_CONFIGS, "org.amdatu.remote.admin.http");
+            endpoint_description_t *endpoint = nullptr;
+            EXPECT_EQ(CELIX_SUCCESS, endpointDescription_create(props, &endpoint));
+            arrayList_add(endpoints, endpoint);
+        }
+
+        endpoint_descriptor_writer_t *writer = nullptr;
+        EXPECT_EQ(CELIX_SUCCESS, endpointDescriptorWriter_create(&writer));
+        char *doc = nullptr;
+        EXPECT_EQ(CELIX_SUCCESS, endpointDescriptorWriter_writeDocument(writer, endpoints, &doc));
+        std::string result = doc != nullptr ? doc : "";
+        endpointDescriptorWriter_destroy(writer); //note also frees the document
+        for (unsigned int i = 0; i < arrayList_size(endpoints); ++i) {
+            endpointDescription_destroy((endpoint_description_t*)arrayList_get(endpoints, i));
+        }
+        arrayList_destroy(endpoints);
+        return result;
+    }
+
+    template<typename P>
+    static bool waitForDiscovered(P predicate) {
+        std::unique_lock<std::mutex> lck{discovered.mutex};
+        return discovered.cond.wait_for(lck, WAIT_TIMEOUT, predicate);
+    }
+
+    static std::vector<std::string> added() {
+        std::lock_guard<std::mutex> lck{discovered.mutex};
+        return discovered.added;
+    }
+
+    static std::vector<std::string> removed() {
+        std::lock_guard<std::mutex> lck{discovered.mutex};
+        return discovered.removed;
+    }
+
+    std::shared_ptr<celix_framework_t> fw{};
+    std::shared_ptr<celix_bundle_context_t> ctx{};
+    std::shared_ptr<discovery_t> discovery{};
+    std::unique_ptr<TestDiscoveryServer> server{std::make_unique<TestDiscoveryServer>()}; //note outlives the poller
+    endpoint_discovery_poller_t *poller = nullptr;
+};
+
+TEST_F(EndpointDiscoveryPollerTestSuite, NotModifiedKeepsEndpoints) {
+    server->setDocument(createDocument({"A", "B"}), "\"1\"");
+    createPoller(server->url);
+    std::vector<std::string> expected{"A", "B"};
+    EXPECT_EQ(expected, added());
+
+    //note two 304 replies, so the poller handled at least one of them
+    EXPECT_TRUE(server->waitFor([this]{ return server->nrOfNotModifiedReplies >= 2; }));
+    EXPECT_EQ(expected, added());
+    EXPECT_TRUE(removed().empty());
+
+    std::lock_guard<std::mutex> lck{server->mutex};
+    EXPECT_EQ(1, server->nrOfDocumentReplies);
+    EXPECT_EQ("", server->ifNoneMatchHeaders[0]);
+    EXPECT_EQ("", server->queries[0]);
+    EXPECT_EQ("\"1\"", server->ifNoneMatchHeaders[1]);
+    EXPECT_EQ("wait=1", server->queries[1]); //long-poll
+}
+
+TEST_F(EndpointDiscoveryPollerTestSuite, ChangedETagUpdatesEndpoints) {
+    server->setDocument(createDocument({"A", "B"}), "\"1\"");
+    createPoller(server->url);
+
+    //note also wakes up a pending long-poll
+    server->setDocument(createDocument({"B", "C"}), "\"2\"");
+    EXPECT_TRUE(waitForDiscovered([]{ return discovered.added.size() == 3 && discovered.removed.size() == 1; }));
+    std::vector<std::string> expectedAdded{"A", "B", "C"};
+    std::vector<std::string> expectedRemoved{"A"};
+    EXPECT_EQ(expectedAdded, added());
+    EXPECT_EQ(expectedRemoved, removed());
+
+    //next poll uses the new ETag and keeps the endpoints
+    EXPECT_TRUE(server->waitFor([this]{ return server->ifNoneMatchHeaders.back() == "\"2\"" && server->nrOfNotModifiedReplies >= 1; }));
+    EXPECT_EQ(expectedAdded, added());
+    EXPECT_EQ(expectedRemoved, removed());
+}
+
+TEST_F(EndpointDiscoveryPollerTestSuite, NoETagFallsBackToPeriodicPolling) {
+    server->setDocument(createDocument({"A"}), "");
+    createPoller(server->url);
+    std::vector<std::string> expectedAdded{"A"};
+    EXPECT_EQ(expectedAdded, added());
+
+    server->setDocument(createDocument({"B"}), "");
+    EXPECT_TRUE(waitForDiscovered([]{ return discovered.added.size() == 2 && discovered.removed.size() == 1; }));
+    expectedAdded.emplace_back("B");
+    std::vector<std::string> expectedRemoved{"A"};
+    EXPECT_EQ(expectedAdded, added());
+    EXPECT_EQ(expectedRemoved, removed());
+
+    //only plain GET requests, no conditional requests or long-polls
+    std::lock_guard<std::mutex> lck{server->mutex};
+    EXPECT_EQ(0, server->nrOfNotModifiedReplies);
+    for (size_t i = 0; i < server->queries.size(); ++i) {
+        EXPECT_EQ("", server->ifNoneMatchHeaders[i]);
+        EXPECT_EQ("", server->queries[i]);
+    }
+}
+
+static size_t storeETag(char *buffer, size_t size, size_t nitems, void *data) {
+    std::string header{buffer, size * nitems};
+    if (header.compare(0, 5, "ETag:") == 0) {
+        auto* out = static_cast<std::string*>(data);
+        *out = header.substr(header.find('"'), header.rfind('"') - header.find('"') + 1);
+    }
+    return size * nitems;
+}
+
+static size_t storeBody(char *buffer, size_t size, size_t nmemb, void *data) {
+    static_cast<std::string*>(data)->append(buffer, size * nmemb);
+    return size * nmemb;
+}
+
+/**
+ * Does a GET request and returns the http status code. The ETag and body of the response are stored in etag and body.
+ */
+static long httpGet(const std::string& url, const std::string& ifNoneMatch, std::string* etag, std::string* body) {
+    CURL *curl = curl_easy_init();
+    struct curl_slist *headers = nullptr;
+    if (!ifNoneMatch.empty()) {
+        headers = curl_slist_append(headers, ("If-None-Match: " + ifNoneMatch).c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, storeETag);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, etag);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, storeBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, body);
+    long httpCode = 0;
+    EXPECT_EQ(CURLE_OK, curl_easy_perform(curl));
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+    return httpCode;
+}
+
+TEST_F(EndpointDiscoveryPollerTestSuite, ServerRepliesNotModifiedForCurrentETag) {
+    endpoint_discovery_server_t *discoveryServer = nullptr;
+    ASSERT_EQ(CELIX_SUCCESS, endpointDiscoveryServer_create(discovery.get(), ctx.get(), "/discovery", "9130", "127.0.0.1", &discoveryServer));
+    char url[1024];
+    ASSERT_EQ(CELIX_SUCCESS, endpointDiscoveryServer_getUrl(discoveryServer, url));
+
+    std::string etag1{};
+    std::string body{};
+    EXPECT_EQ(200, httpGet(url, "", &etag1, &body));
+    EXPECT_FALSE(etag1.empty());
+
+    std::string etag2{};
+    EXPECT_EQ(304, httpGet(url, etag1, &etag2, &body));
+    EXPECT_EQ(etag1, etag2);
+
+    //note a changed endpoint list results in a new ETag
+    auto* props = celix_properties_create();
+    celix_properties_set(props, OSGI_RSA_ENDPOINT_ID, "A");
+    celix_properties_set(props, OSGI_RSA_ENDPOINT_SERVICE_ID, "42");
+    celix_properties_set(props, OSGI_RSA_ENDPOINT_FRAMEWORK_UUID, "test-framework-uuid");
+    celix_properties_set(props, OSGI_FRAMEWORK_OBJECTCLASS, "org.apache.celix.Test");
+    endpoint_description_t *endpoint = nullptr;
+    ASSERT_EQ(CELIX_SUCCESS, endpointDescription_create(props, &endpoint));
+    endpointDiscoveryServer_addEndpoint(discoveryServer, endpoint);
+    body.clear();
+    std::string etag3{};
+    EXPECT_EQ(200, httpGet(url, etag1, &etag3, &body));
+    EXPECT_NE(etag1, etag3);
+    EXPECT_NE(std::string::npos, body.find("\"A\""));
+
+    endpointDiscoveryServer_destroy(discoveryServer);
+    endpointDescription_destroy(endpoint);
+}
+
+TEST_F(EndpointDiscoveryPollerTestSuite, ServerLongPollReturnsOnChange) {
+    endpoint_discovery_server_t *discoveryServer = nullptr;
+    ASSERT_EQ(CELIX_SUCCESS, endpointDiscoveryServer_create(discovery.get(), ctx.get(), "/discovery", "9130", "127.0.0.1", &discoveryServer));
+    char url[1024];
+    ASSERT_EQ(CELIX_SUCCESS, endpointDiscoveryServer_getUrl(discoveryServer, url));
+    createPoller(url);
+    EXPECT_TRUE(added().empty());
+
+    //the poller picks up added and removed endpoints through (long-)polls with the ETag of the discoveryServer
+    auto* props = celix_properties_create();
+    celix_properties_set(props, OSGI_RSA_ENDPOINT_ID, "A");
+    celix_properties_set(props, OSGI_RSA_ENDPOINT_SERVICE_ID, "42");
+    celix_properties_set(props, OSGI_RSA_ENDPOINT_FRAMEWORK_UUID, "test-framework-uuid");
+    celix_properties_set(props, OSGI_FRAMEWORK_OBJECTCLASS, "org.apache.celix.Test");
+    endpoint_description_t *endpoint = nullptr;
+    ASSERT_EQ(CELIX_SUCCESS, endpointDescription_create(props, &endpoint));
+    endpointDiscoveryServer_addEndpoint(discoveryServer, endpoint);
+    EXPECT_TRUE(waitForDiscovered([]{ return discovered.added.size() == 1; }));
+
+    endpointDiscoveryServer_removeEndpoint(discoveryServer, endpoint);
+    EXPECT_TRUE(waitForDiscovered([]{ return discovered.removed.size() == 1; }));
+
+    endpointDiscoveryPoller_destroy(poller);
+    poller = nullptr;
+    endpointDiscoveryServer_destroy(discoveryServer);
+    endpointDescription_destroy(endpoint);
+}
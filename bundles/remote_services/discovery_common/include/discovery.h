@@ -45,6 +45,7 @@
 #define DISCOVERY_SERVER_PATH       "DISCOVERY_CFG_SERVER_PATH"
 #define DISCOVERY_POLL_ENDPOINTS    "DISCOVERY_CFG_POLL_ENDPOINTS"
 #define DISCOVERY_SERVER_MAX_EP     "DISCOVERY_CFG_SERVER_MAX_EP"
+#define DISCOVERY_SERVER_THREADS    "DISCOVERY_CFG_SERVER_THREADS"
 
 struct discovery {
     celix_bundle_context_t *context;
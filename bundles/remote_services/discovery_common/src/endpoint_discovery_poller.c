@@ -28,12 +28,14 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 
 #include <curl/curl.h>
 
 #include "bundle_context.h"
 #include "celix_log_helper.h"
+#include "celix_utils.h"
 #include "utils.h"
 
 #include "endpoint_descriptor_reader.h"
@@ -46,10 +48,43 @@
 #define DISCOVERY_POLL_TIMEOUT "DISCOVERY_CFG_POLL_TIMEOUT"
 #define DEFAULT_POLL_TIMEOUT "10" // seconds
 
+// max time the poller thread blocks, before checking whether it should stop or start new polls
+#define POLLER_THREAD_WAIT_MS 100
+
+/**
+ * Poll state for a single discovery endpoint (url). Protected by the pollerLock.
+ */
+typedef struct endpoint_discovery_poller_entry {
+	hash_map_pt endpoints; //key = endpoint id (owned by the endpoint), value = endpoint_description_t*
+	char *etag; //ETag of the last received endpoint document, NULL if the discovery server does not provide one
+	struct timespec nextPoll;
+} endpoint_discovery_poller_entry_t;
+
+struct MemoryStruct {
+	char *memory;
+	size_t size;
+};
+
+/**
+ * A (possibly long-polling) GET request for a discovery endpoint. Only used by the poller thread, or during a
+ * synchronous poll.
+ */
+typedef struct endpoint_discovery_poller_request {
+	char *url; //discovery endpoint url
+	CURL *curl;
+	struct curl_slist *headers;
+	struct MemoryStruct chunk;
+	char *etag; //ETag of the response
+	struct timespec start;
+	unsigned int wait; //requested long-poll wait time in seconds, 0 for a plain GET
+} endpoint_discovery_poller_request_t;
+
 static void *endpointDiscoveryPoller_performPeriodicPoll(void *data);
-celix_status_t endpointDiscoveryPoller_poll(endpoint_discovery_poller_t *poller, char *url, array_list_pt currentEndpoints);
-static celix_status_t endpointDiscoveryPoller_getEndpoints(endpoint_discovery_poller_t *poller, char *url, array_list_pt *updatedEndpoints);
-static celix_status_t endpointDiscoveryPoller_endpointDescriptionEquals(const void *endpointPtr, const void *comparePtr, bool *equals);
+celix_status_t endpointDiscoveryPoller_poll(endpoint_discovery_poller_t *poller, char *url, endpoint_discovery_poller_entry_t *entry);
+static endpoint_discovery_poller_request_t* endpointDiscoveryPoller_createRequest(endpoint_discovery_poller_t *poller, const char *url, const char *etag, unsigned int wait);
+static void endpointDiscoveryPoller_destroyRequest(endpoint_discovery_poller_request_t *request);
+static void endpointDiscoveryPoller_handleResponse(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry, endpoint_discovery_poller_request_t *request, CURLcode res);
+static void endpointDiscoveryPoller_updateEndpoints(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry, array_list_pt updatedEndpoints);
 
 /**
  * Allocates memory and initializes a new endpoint_discovery_poller instance.
@@ -191,18 +226,21 @@ celix_status_t endpointDiscoveryPoller_addDiscoveryEndpoint(endpoint_discovery_p
 	}
 
 	// Avoid memory leaks when adding an already existing URL...
-	array_list_pt endpoints = hashMap_get(poller->entries, url);
-	if (endpoints == NULL) {
-		status = arrayList_createWithEquals(endpointDiscoveryPoller_endpointDescriptionEquals, &endpoints);
-
-		if (status == CELIX_SUCCESS) {
-            celix_logHelper_debug(*poller->loghelper, "ENDPOINT_POLLER: add new discovery endpoint with url %s", url);
-			hashMap_put(poller->entries, strdup(url), endpoints);
-			endpointDiscoveryPoller_poll(poller, url, endpoints);
+	endpoint_discovery_poller_entry_t *entry = hashMap_get(poller->entries, url);
+	if (entry == NULL) {
+		entry = calloc(1, sizeof(*entry));
+
+		if (entry != NULL) {
+			entry->endpoints = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+			celix_logHelper_debug(*poller->loghelper, "ENDPOINT_POLLER: add new discovery endpoint with url %s", url);
+			hashMap_put(poller->entries, strdup(url), entry);
+			endpointDiscoveryPoller_poll(poller, url, entry);
+		} else {
+			status = CELIX_ENOMEM;
 		}
 	}
 
-	status = celixThreadMutex_unlock(&poller->pollerLock);
+	celixThreadMutex_unlock(&poller->pollerLock);
 
 	return status;
 }
@@ -225,16 +263,18 @@ celix_status_t endpointDiscoveryPoller_removeDiscoveryEndpoint(endpoint_discover
 
             celix_logHelper_debug(*poller->loghelper, "ENDPOINT_POLLER: remove discovery endpoint with url %s", url);
 
-			array_list_pt entries = hashMap_remove(poller->entries, url);
+			endpoint_discovery_poller_entry_t *pollEntry = hashMap_remove(poller->entries, url);
 
-			if (entries != NULL) {
-				for (unsigned int i = arrayList_size(entries); i > 0; i--) {
-					endpoint_description_t *endpoint = arrayList_get(entries, i - 1);
+			if (pollEntry != NULL) {
+				hash_map_iterator_t iter = hashMapIterator_construct(pollEntry->endpoints);
+				while (hashMapIterator_hasNext(&iter)) {
+					endpoint_description_t *endpoint = hashMapIterator_nextValue(&iter);
 					discovery_removeDiscoveredEndpoint(poller->discovery, endpoint);
-					arrayList_remove(entries, i - 1);
 					endpointDescription_destroy(endpoint);
 				}
-				arrayList_destroy(entries);
+				hashMap_destroy(pollEntry->endpoints, false, false);
+				free(pollEntry->etag);
+				free(pollEntry);
 			}
 
 			free(origKey);
@@ -245,92 +285,221 @@ celix_status_t endpointDiscoveryPoller_removeDiscoveryEndpoint(endpoint_discover
 	return status;
 }
 
+/**
+ * Synchronously polls (plain GET, no long-poll) a discovery endpoint. Should be called with the pollerLock taken.
+ */
+celix_status_t endpointDiscoveryPoller_poll(endpoint_discovery_poller_t *poller, char *url, endpoint_discovery_poller_entry_t *entry) {
+	celix_status_t status = CELIX_SUCCESS;
 
+	endpoint_discovery_poller_request_t *request = endpointDiscoveryPoller_createRequest(poller, url, entry->etag, 0);
+	if (request == NULL) {
+		status = CELIX_ILLEGAL_STATE;
+	} else {
+		CURLcode res = curl_easy_perform(request->curl);
+		endpointDiscoveryPoller_handleResponse(poller, entry, request, res);
+		endpointDiscoveryPoller_destroyRequest(request);
+	}
 
+	return status;
+}
 
-celix_status_t endpointDiscoveryPoller_poll(endpoint_discovery_poller_t *poller, char *url, array_list_pt currentEndpoints) {
-	celix_status_t status;
-	array_list_pt updatedEndpoints = NULL;
+/**
+ * Applies a new endpoint list of a discovery endpoint. Endpoints are matched on their id using a hash map, so this is
+ * linear in the number of endpoints. Should be called with the pollerLock taken.
+ */
+static void endpointDiscoveryPoller_updateEndpoints(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry, array_list_pt updatedEndpoints) {
+	hash_map_pt updated = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+	for (int i = 0; i < arrayList_size(updatedEndpoints); i++) {
+		endpoint_description_t *endpoint = arrayList_get(updatedEndpoints, i);
+		if (hashMap_containsKey(updated, endpoint->id)) {
+			endpointDescription_destroy(endpoint); //duplicate id
+		} else {
+			hashMap_put(updated, endpoint->id, endpoint);
+		}
+	}
 
-	// create an arraylist with a custom equality test to ensure we can find endpoints properly...
-	arrayList_createWithEquals(endpointDiscoveryPoller_endpointDescriptionEquals, &updatedEndpoints);
-	status = endpointDiscoveryPoller_getEndpoints(poller, url, &updatedEndpoints);
+	hash_map_iterator_t iter = hashMapIterator_construct(entry->endpoints);
+	while (hashMapIterator_hasNext(&iter)) {
+		endpoint_description_t *endpoint = hashMapIterator_nextValue(&iter);
+		if (!hashMap_containsKey(updated, endpoint->id)) {
+			hashMapIterator_remove(&iter);
+			discovery_removeDiscoveredEndpoint(poller->discovery, endpoint);
+			endpointDescription_destroy(endpoint);
+		}
+	}
 
-	if (status == CELIX_SUCCESS) {
-		if (updatedEndpoints != NULL) {
-			for (unsigned int i = arrayList_size(currentEndpoints); i > 0; i--) {
-				endpoint_description_t *endpoint = arrayList_get(currentEndpoints, i - 1);
+	iter = hashMapIterator_construct(updated);
+	while (hashMapIterator_hasNext(&iter)) {
+		endpoint_description_t *endpoint = hashMapIterator_nextValue(&iter);
+		if (!hashMap_containsKey(entry->endpoints, endpoint->id)) {
+			hashMap_put(entry->endpoints, endpoint->id, endpoint);
+			discovery_addDiscoveredEndpoint(poller->discovery, endpoint);
+		} else {
+			endpointDescription_destroy(endpoint);
+		}
+	}
 
-				if (!arrayList_contains(updatedEndpoints, endpoint)) {
-					status = discovery_removeDiscoveredEndpoint(poller->discovery, endpoint);
-					arrayList_remove(currentEndpoints, i - 1);
-					endpointDescription_destroy(endpoint);
-				}
-			}
+	hashMap_destroy(updated, false, false);
+}
 
-			for (int i = arrayList_size(updatedEndpoints); i > 0; i--) {
-				endpoint_description_t *endpoint = arrayList_remove(updatedEndpoints, 0);
+/**
+ * Handles the response of a (long) poll. Should be called with the pollerLock taken.
+ */
+static void endpointDiscoveryPoller_handleResponse(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry, endpoint_discovery_poller_request_t *request, CURLcode res) {
+	long httpCode = 0;
+	curl_easy_getinfo(request->curl, CURLINFO_RESPONSE_CODE, &httpCode);
+
+	struct timespec now = celix_gettime(CLOCK_MONOTONIC);
+	entry->nextPoll = now;
+
+	if (res != CURLE_OK) {
+        celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: unable to read endpoints from %s, reason: %s", request->url, curl_easy_strerror(res));
+		entry->nextPoll.tv_sec += poller->poll_interval;
+	} else if (httpCode == 304) {
+		//not modified. note that long-polls are not repeated faster than the requested wait time
+		entry->nextPoll = request->start;
+		entry->nextPoll.tv_sec += request->wait > 0 ? request->wait : poller->poll_interval;
+	} else if (httpCode != 200) {
+		//note the known endpoints are kept, the etag is cleared so that the next poll is a plain GET
+		celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: unable to read endpoints from %s, got HTTP status %li", request->url, httpCode);
+		free(entry->etag);
+		entry->etag = NULL;
+		entry->nextPoll.tv_sec += poller->poll_interval;
+	} else {
+		array_list_pt updatedEndpoints = NULL;
+		arrayList_create(&updatedEndpoints);
 
-				if (!arrayList_contains(currentEndpoints, endpoint)) {
-					arrayList_add(currentEndpoints, endpoint);
-					status = discovery_addDiscoveredEndpoint(poller->discovery, endpoint);
-				} else {
-					endpointDescription_destroy(endpoint);
+		endpoint_descriptor_reader_t *reader = NULL;
+		celix_status_t status = endpointDescriptorReader_create(poller, &reader);
+		if (status == CELIX_SUCCESS) {
+			status = endpointDescriptorReader_parseDocument(reader, request->chunk.memory, &updatedEndpoints);
+		}
+		if (reader) {
+			endpointDescriptorReader_destroy(reader);
+		}
 
-				}
+		if (status == CELIX_SUCCESS) {
+			endpointDiscoveryPoller_updateEndpoints(poller, entry, updatedEndpoints);
+
+			free(entry->etag);
+			entry->etag = request->etag;
+			request->etag = NULL;
+		} else {
+			celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: unable to parse the endpoints from %s", request->url);
+			for (int i = 0; i < arrayList_size(updatedEndpoints); i++) {
+				endpointDescription_destroy(arrayList_get(updatedEndpoints, i));
 			}
+			free(entry->etag);
+			entry->etag = NULL;
+		}
+		arrayList_destroy(updatedEndpoints);
+
+		if (entry->etag == NULL) {
+			//note discovery server without ETag support (or an invalid response), fall back to periodic polling
+			entry->nextPoll.tv_sec += poller->poll_interval;
 		}
 	}
+}
 
-	if (updatedEndpoints != NULL) {
-		arrayList_destroy(updatedEndpoints);
+static void endpointDiscoveryPoller_startRequests(endpoint_discovery_poller_t *poller, CURLM *multi, hash_map_pt requests) {
+	struct timespec now = celix_gettime(CLOCK_MONOTONIC);
+
+	hash_map_iterator_t iter = hashMapIterator_construct(poller->entries);
+	while (hashMapIterator_hasNext(&iter)) {
+		hash_map_entry_pt mapEntry = hashMapIterator_nextEntry(&iter);
+		const char *url = hashMapEntry_getKey(mapEntry);
+		endpoint_discovery_poller_entry_t *entry = hashMapEntry_getValue(mapEntry);
+
+		bool due = now.tv_sec > entry->nextPoll.tv_sec || (now.tv_sec == entry->nextPoll.tv_sec && now.tv_nsec >= entry->nextPoll.tv_nsec);
+		if (due && !hashMap_containsKey(requests, url)) {
+			//note if the discovery server supports ETags, it holds the request until something changes (long-poll)
+			endpoint_discovery_poller_request_t *request = endpointDiscoveryPoller_createRequest(poller, url, entry->etag, entry->etag != NULL ? poller->poll_interval : 0);
+			if (request != NULL) {
+				hashMap_put(requests, request->url, request);
+				curl_multi_add_handle(multi, request->curl);
+			} else {
+				entry->nextPoll = now;
+				entry->nextPoll.tv_sec += poller->poll_interval;
+			}
+		}
 	}
 
-	return status;
+	//abort requests for removed discovery endpoints
+	iter = hashMapIterator_construct(requests);
+	while (hashMapIterator_hasNext(&iter)) {
+		endpoint_discovery_poller_request_t *request = hashMapIterator_nextValue(&iter);
+		if (!hashMap_containsKey(poller->entries, request->url)) {
+			hashMapIterator_remove(&iter);
+			curl_multi_remove_handle(multi, request->curl);
+			endpointDiscoveryPoller_destroyRequest(request);
+		}
+	}
 }
 
+//note not a framework scheduler task, this thread drives the curl multi handle of the (long-)poll requests in flight
 static void *endpointDiscoveryPoller_performPeriodicPoll(void *data) {
 	endpoint_discovery_poller_t *poller = (endpoint_discovery_poller_t *) data;
 
-	useconds_t interval = (useconds_t) (poller->poll_interval * 1000000L);
+	//note all discovery endpoints are polled concurrently, so a long-poll on one endpoint does not delay the others
+	CURLM *multi = curl_multi_init();
+	hash_map_pt requests = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL); //key = url (owned by request), value = request
 
-	while (poller->running) {
-		usleep(interval);
+	while (poller->running && multi != NULL) {
 		celix_status_t status = celixThreadMutex_lock(&poller->pollerLock);
-
 		if (status != CELIX_SUCCESS) {
             celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: failed to obtain lock; retrying...");
 		} else {
-			hash_map_iterator_pt iterator = hashMapIterator_create(poller->entries);
-
-			while (hashMapIterator_hasNext(iterator)) {
-				hash_map_entry_pt entry = hashMapIterator_nextEntry(iterator);
-
-				char *url = hashMapEntry_getKey(entry);
-				array_list_pt currentEndpoints = hashMapEntry_getValue(entry);
+			endpointDiscoveryPoller_startRequests(poller, multi, requests);
+			celixThreadMutex_unlock(&poller->pollerLock);
+		}
 
-				endpointDiscoveryPoller_poll(poller, url, currentEndpoints);
+		int stillRunning = 0;
+		curl_multi_perform(multi, &stillRunning);
+		if (hashMap_size(requests) == 0) {
+			usleep(POLLER_THREAD_WAIT_MS * 1000);
+			continue;
+		}
+		curl_multi_wait(multi, NULL, 0, POLLER_THREAD_WAIT_MS, NULL);
+		curl_multi_perform(multi, &stillRunning);
+
+		CURLMsg *msg = NULL;
+		int msgsLeft = 0;
+		while ((msg = curl_multi_info_read(multi, &msgsLeft)) != NULL) {
+			if (msg->msg != CURLMSG_DONE) {
+				continue;
+			}
+			endpoint_discovery_poller_request_t *request = NULL;
+			curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&request);
+			CURLcode res = msg->data.result;
+			curl_multi_remove_handle(multi, msg->easy_handle);
+
+			if (request != NULL) {
+				hashMap_remove(requests, request->url);
+				celixThreadMutex_lock(&poller->pollerLock);
+				endpoint_discovery_poller_entry_t *entry = hashMap_get(poller->entries, request->url);
+				if (entry != NULL) {
+					endpointDiscoveryPoller_handleResponse(poller, entry, request, res);
+				}
+				celixThreadMutex_unlock(&poller->pollerLock);
+				endpointDiscoveryPoller_destroyRequest(request);
 			}
-
-			hashMapIterator_destroy(iterator);
 		}
+	}
 
-		status = celixThreadMutex_unlock(&poller->pollerLock);
-		if (status != CELIX_SUCCESS) {
-            celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: failed to release lock; retrying...");
-		}
+	hash_map_iterator_t iter = hashMapIterator_construct(requests);
+	while (hashMapIterator_hasNext(&iter)) {
+		endpoint_discovery_poller_request_t *request = hashMapIterator_nextValue(&iter);
+		curl_multi_remove_handle(multi, request->curl);
+		endpointDiscoveryPoller_destroyRequest(request);
+	}
+	hashMap_destroy(requests, false, false);
+	if (multi != NULL) {
+		curl_multi_cleanup(multi);
 	}
 
 	return NULL;
 }
 
-
-
-struct MemoryStruct {
-	char *memory;
-	size_t size;
-};
-
 static size_t endpointDiscoveryPoller_writeMemory(void *contents, size_t size, size_t nmemb, void *memoryPtr) {
 	size_t realsize = size * nmemb;
 	struct MemoryStruct *mem = (struct MemoryStruct *)memoryPtr;
@@ -348,65 +517,79 @@ static size_t endpointDiscoveryPoller_writeMemory(void *contents, size_t size, s
 	return realsize;
 }
 
-static celix_status_t endpointDiscoveryPoller_getEndpoints(endpoint_discovery_poller_t *poller, char *url, array_list_pt *updatedEndpoints) {
-	celix_status_t status = CELIX_SUCCESS;
-
-
-	CURL *curl = NULL;
-	CURLcode res = CURLE_OK;
-
-	struct MemoryStruct chunk;
-	chunk.memory = malloc(1);
-	chunk.size = 0;
+static size_t endpointDiscoveryPoller_writeHeader(char *buffer, size_t size, size_t nitems, void *data) {
+	endpoint_discovery_poller_request_t *request = data;
+	size_t length = size * nitems;
 
-	curl = curl_easy_init();
-	if (!curl) {
-		status = CELIX_ILLEGAL_STATE;
-	} else {
-		curl_easy_setopt(curl, CURLOPT_URL, url);
-		curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
-		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, endpointDiscoveryPoller_writeMemory);
-		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-		curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
-		curl_easy_setopt(curl, CURLOPT_TIMEOUT, poller->poll_timeout);
-		res = curl_easy_perform(curl);
-
-		curl_easy_cleanup(curl);
+	if (length > 5 && strncasecmp(buffer, "ETag:", 5) == 0) {
+		const char *value = buffer + 5;
+		size_t valueLength = length - 5;
+		while (valueLength > 0 && (*value == ' ' || *value == '\t')) {
+			value++;
+			valueLength--;
+		}
+		while (valueLength > 0 && (value[valueLength - 1] == '\r' || value[valueLength - 1] == '\n' || value[valueLength - 1] == ' ')) {
+			valueLength--;
+		}
+		free(request->etag);
+		request->etag = strndup(value, valueLength);
 	}
 
-	// process endpoints file
-	if (res == CURLE_OK) {
-		endpoint_descriptor_reader_t *reader = NULL;
+	return length;
+}
 
-		status = endpointDescriptorReader_create(poller, &reader);
-		if (status == CELIX_SUCCESS) {
-			status = endpointDescriptorReader_parseDocument(reader, chunk.memory, updatedEndpoints);
-		}
+static endpoint_discovery_poller_request_t* endpointDiscoveryPoller_createRequest(endpoint_discovery_poller_t *poller, const char *url, const char *etag, unsigned int wait) {
+	endpoint_discovery_poller_request_t *request = calloc(1, sizeof(*request));
+	if (request == NULL) {
+		return NULL;
+	}
+	request->url = strdup(url);
+	request->chunk.memory = malloc(1);
+	request->chunk.size = 0;
+	request->start = celix_gettime(CLOCK_MONOTONIC);
+	request->wait = etag != NULL ? wait : 0;
+	request->curl = curl_easy_init();
+	if (request->url == NULL || request->chunk.memory == NULL || request->curl == NULL) {
+		endpointDiscoveryPoller_destroyRequest(request);
+		return NULL;
+	}
 
-		if (reader) {
-			endpointDescriptorReader_destroy(reader);
+	char *requestUrl = NULL;
+	if (request->wait > 0) {
+		if (asprintf(&requestUrl, "%s%swait=%u", url, strchr(url, '?') != NULL ? "&" : "?", request->wait) < 0) {
+			requestUrl = NULL;
 		}
-	} else {
-        celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: unable to read endpoints from %s, reason: %s", url, curl_easy_strerror(res));
 	}
-
-	// clean up endpoints file
-	if (chunk.memory) {
-		free(chunk.memory);
+	if (etag != NULL) {
+		char header[256];
+		snprintf(header, sizeof(header), "If-None-Match: %s", etag);
+		request->headers = curl_slist_append(request->headers, header);
 	}
 
-	return status;
+	curl_easy_setopt(request->curl, CURLOPT_URL, requestUrl != NULL ? requestUrl : url);
+	curl_easy_setopt(request->curl, CURLOPT_NOSIGNAL, 1);
+	curl_easy_setopt(request->curl, CURLOPT_HTTPHEADER, request->headers);
+	curl_easy_setopt(request->curl, CURLOPT_WRITEFUNCTION, endpointDiscoveryPoller_writeMemory);
+	curl_easy_setopt(request->curl, CURLOPT_WRITEDATA, (void *)&request->chunk);
+	curl_easy_setopt(request->curl, CURLOPT_HEADERFUNCTION, endpointDiscoveryPoller_writeHeader);
+	curl_easy_setopt(request->curl, CURLOPT_HEADERDATA, (void *)request);
+	curl_easy_setopt(request->curl, CURLOPT_PRIVATE, (void *)request);
+	curl_easy_setopt(request->curl, CURLOPT_CONNECTTIMEOUT, 5L);
+	curl_easy_setopt(request->curl, CURLOPT_TIMEOUT, (long)(poller->poll_timeout + request->wait));
+	free(requestUrl); //note curl copies the url
+
+	return request;
 }
 
-static celix_status_t endpointDiscoveryPoller_endpointDescriptionEquals(const void *endpointPtr, const void *comparePtr, bool *equals) {
-	endpoint_description_t *endpoint = (endpoint_description_t *) endpointPtr;
-	endpoint_description_t *compare = (endpoint_description_t *) comparePtr;
-
-	if (strcmp(endpoint->id, compare->id) == 0) {
-		*equals = true;
-	} else {
-		*equals = false;
+static void endpointDiscoveryPoller_destroyRequest(endpoint_discovery_poller_request_t *request) {
+	if (request != NULL) {
+		if (request->curl != NULL) {
+			curl_easy_cleanup(request->curl);
+		}
+		curl_slist_free_all(request->headers);
+		free(request->chunk.memory);
+		free(request->etag);
+		free(request->url);
+		free(request);
 	}
-
-	return CELIX_SUCCESS;
 }
@@ -26,6 +26,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #ifndef ANDROID
@@ -34,13 +35,16 @@
 #include "civetweb.h"
 #include "celix_errno.h"
 #include "utils.h"
+#include "celix_utils.h"
 #include "celix_log_helper.h"
 #include "discovery.h"
 #include "endpoint_descriptor_writer.h"
 
 // defines how often the webserver is restarted (with an increased port number)
 #define MAX_NUMBER_OF_RESTARTS     15
-#define DEFAULT_SERVER_THREADS     "5"
+#define DEFAULT_SERVER_THREADS     10
+// max time in seconds a long-poll request (a GET with If-None-Match and a wait query parameter) is held
+#define MAX_LONG_POLL_WAIT         30
 
 #define CIVETWEB_REQUEST_NOT_HANDLED 0
 #define CIVETWEB_REQUEST_HANDLED 1
@@ -49,6 +53,13 @@ static const char *response_headers =
         "HTTP/1.1 200 OK\r\n"
         "Cache: no-cache\r\n"
         "Content-Type: application/xml;charset=utf-8\r\n"
+        "Content-Length: %zu\r\n"
+        "%s"
+        "\r\n";
+
+static const char *not_modified_headers =
+        "HTTP/1.1 304 Not Modified\r\n"
+        "ETag: %s\r\n"
         "\r\n";
 
 struct endpoint_discovery_server {
@@ -56,6 +67,12 @@ struct endpoint_discovery_server {
     hash_map_pt entries; // key = endpointId, value = endpoint_descriptor_pt
 
     celix_thread_mutex_t serverLock;
+    celix_thread_cond_t changedCond; // signalled when the entries change or the server stops
+    unsigned long version; // increased for every change of the entries
+    unsigned long instanceId; // part of the ETag, so that ETags of a previous server instance never match
+    bool stopping;
+    int longPolls; // number of requests currently held by a long-poll
+    int maxLongPolls; // max number of concurrent long-polls, so that at least one webserver thread stays available
 
     const char *path;
     const char *port;
@@ -84,6 +101,7 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
     char *detectedIp = NULL;
     const char *path = NULL;
     const char *retries = NULL;
+    const char *threads = NULL;
 
     int max_ep_num = MAX_NUMBER_OF_RESTARTS;
 
@@ -102,6 +120,10 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
     if (status != CELIX_SUCCESS) {
         return CELIX_BUNDLE_EXCEPTION;
     }
+    celixThreadCondition_init(&(*server)->changedCond, NULL);
+    (*server)->version = 0;
+    (*server)->instanceId = (unsigned long)time(NULL);
+    (*server)->stopping = false;
 
     bundleContext_getProperty(context, DISCOVERY_SERVER_IP, &ip);
 #ifndef ANDROID
@@ -153,6 +175,21 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
         }
     }
 
+    long numThreads = DEFAULT_SERVER_THREADS;
+    bundleContext_getProperty(context, DISCOVERY_SERVER_THREADS, &threads);
+    if (threads != NULL) {
+        errno = 0;
+        numThreads = strtol(threads, NULL, 10);
+        if (errno != 0 || numThreads <= 1) {
+            celix_logHelper_warning(*(*server)->loghelper, "Invalid %s value %s, using %i", DISCOVERY_SERVER_THREADS, threads, DEFAULT_SERVER_THREADS);
+            numThreads = DEFAULT_SERVER_THREADS;
+        }
+    }
+    char numThreadsStr[16];
+    snprintf(numThreadsStr, sizeof(numThreadsStr), "%li", numThreads);
+    (*server)->longPolls = 0;
+    (*server)->maxLongPolls = (int)numThreads - 1;
+
     (*server)->path = format_path(path);
 
     const struct mg_callbacks callbacks = {
@@ -165,7 +202,7 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
     do {
         const char *options[] = {
                 "listening_ports", port,
-                "num_threads", DEFAULT_SERVER_THREADS,
+                "num_threads", numThreadsStr,
                 NULL
         };
 
@@ -214,6 +251,12 @@ celix_status_t endpointDiscoveryServer_getUrl(endpoint_discovery_server_t *serve
 celix_status_t endpointDiscoveryServer_destroy(endpoint_discovery_server_t *server) {
     celix_status_t status;
 
+    // release pending long-polls...
+    celixThreadMutex_lock(&server->serverLock);
+    server->stopping = true;
+    celixThreadCondition_broadcast(&server->changedCond);
+    celixThreadMutex_unlock(&server->serverLock);
+
     // stop & block until the actual server is shut down...
     if (server->ctx != NULL) {
         mg_stop(server->ctx);
@@ -226,6 +269,7 @@ celix_status_t endpointDiscoveryServer_destroy(endpoint_discovery_server_t *serv
 
     status = celixThreadMutex_unlock(&server->serverLock);
     status = celixThreadMutex_destroy(&server->serverLock);
+    celixThreadCondition_destroy(&server->changedCond);
 
     free((void*) server->path);
     free((void*) server->port);
@@ -251,6 +295,10 @@ celix_status_t endpointDiscoveryServer_addEndpoint(endpoint_discovery_server_t *
         celix_logHelper_info(*server->loghelper, "exposing new endpoint \"%s\"...", endpointId);
 
         hashMap_put(server->entries, endpointId, endpoint);
+        server->version += 1;
+        celixThreadCondition_broadcast(&server->changedCond);
+    } else {
+        free(endpointId);
     }
 
     status = celixThreadMutex_unlock(&server->serverLock);
@@ -279,6 +327,9 @@ celix_status_t endpointDiscoveryServer_removeEndpoint(endpoint_discovery_server_
 
         // we've made this key, see _addEndpoint above...
         free((void*) key);
+
+        server->version += 1;
+        celixThreadCondition_broadcast(&server->changedCond);
     }
 
     status = celixThreadMutex_unlock(&server->serverLock);
@@ -328,7 +379,11 @@ static celix_status_t endpointDiscoveryServer_getEndpoints(endpoint_discovery_se
     return status;
 }
 
-static int endpointDiscoveryServer_writeEndpoints(struct mg_connection* conn, array_list_pt endpoints) {
+static void endpointDiscoveryServer_formatETag(endpoint_discovery_server_t *server, char *etag, size_t size) {
+    snprintf(etag, size, "\"%lx-%lu\"", server->instanceId, server->version);
+}
+
+static int endpointDiscoveryServer_writeEndpoints(struct mg_connection* conn, array_list_pt endpoints, const char *etag) {
     celix_status_t status;
     int rv = CIVETWEB_REQUEST_NOT_HANDLED;
 
@@ -339,8 +394,13 @@ static int endpointDiscoveryServer_writeEndpoints(struct mg_connection* conn, ar
         char *buffer = NULL;
         status = endpointDescriptorWriter_writeDocument(writer, endpoints, &buffer);
         if (buffer) {
-            mg_write(conn, response_headers, strlen(response_headers));
-            mg_write(conn, buffer, strlen(buffer));
+            char etagHeader[128] = "";
+            if (etag != NULL) {
+                snprintf(etagHeader, sizeof(etagHeader), "ETag: %s\r\n", etag);
+            }
+            size_t length = strlen(buffer);
+            mg_printf(conn, response_headers, length, etagHeader);
+            mg_write(conn, buffer, length);
         }
 
         rv = CIVETWEB_REQUEST_HANDLED;
@@ -353,18 +413,44 @@ static int endpointDiscoveryServer_writeEndpoints(struct mg_connection* conn, ar
     return rv;
 }
 
-// returns all endpoints as XML...
-static int endpointDiscoveryServer_returnAllEndpoints(endpoint_discovery_server_t *server, struct mg_connection* conn) {
+// returns all endpoints as XML, or 304 if the ETag provided by the client (If-None-Match) is still current.
+// If the client also provides a wait time, a 304 is delayed until the endpoints change or the wait time expires (long-poll).
+// Every long-poll occupies a webserver thread, if already maxLongPolls requests are waiting the 304 is returned directly;
+// the poller will not poll again before its wait time expired.
+static int endpointDiscoveryServer_returnAllEndpoints(endpoint_discovery_server_t *server, struct mg_connection* conn, const char *ifNoneMatch, int wait) {
     int status = CIVETWEB_REQUEST_NOT_HANDLED;
 
     array_list_pt endpoints = NULL;
 
     if (celixThreadMutex_lock(&server->serverLock) == CELIX_SUCCESS) {
-        endpointDiscoveryServer_getEndpoints(server, NULL, &endpoints);
-        if (endpoints) {
-            status = endpointDiscoveryServer_writeEndpoints(conn, endpoints);
+        char etag[64];
+        endpointDiscoveryServer_formatETag(server, etag, sizeof(etag));
+
+        if (ifNoneMatch != NULL && strcmp(ifNoneMatch, etag) == 0 && wait > 0 && server->longPolls < server->maxLongPolls) {
+            server->longPolls++;
+            unsigned long version = server->version;
+            struct timespec start = celix_gettime(CLOCK_MONOTONIC);
+            double remaining = wait > MAX_LONG_POLL_WAIT ? MAX_LONG_POLL_WAIT : wait;
+            while (server->version == version && !server->stopping && remaining > 0) {
+                long seconds = (long)remaining;
+                long nanoseconds = (long)((remaining - seconds) * 1000000000.0);
+                celixThreadCondition_timedwaitRelative(&server->changedCond, &server->serverLock, seconds, nanoseconds);
+                remaining = (wait > MAX_LONG_POLL_WAIT ? MAX_LONG_POLL_WAIT : wait) - celix_elapsedtime(CLOCK_MONOTONIC, start);
+            }
+            server->longPolls--;
+            endpointDiscoveryServer_formatETag(server, etag, sizeof(etag));
+        }
 
-            arrayList_destroy(endpoints);
+        if (ifNoneMatch != NULL && strcmp(ifNoneMatch, etag) == 0) {
+            mg_printf(conn, not_modified_headers, etag);
+            status = CIVETWEB_REQUEST_HANDLED;
+        } else {
+            endpointDiscoveryServer_getEndpoints(server, NULL, &endpoints);
+            if (endpoints) {
+                status = endpointDiscoveryServer_writeEndpoints(conn, endpoints, etag);
+
+                arrayList_destroy(endpoints);
+            }
         }
 
 
@@ -383,7 +469,7 @@ static int endpointDiscoveryServer_returnEndpoint(endpoint_discovery_server_t *s
     if (celixThreadMutex_lock(&server->serverLock) == CELIX_SUCCESS) {
         endpointDiscoveryServer_getEndpoints(server, endpoint_id, &endpoints);
         if (endpoints) {
-            status = endpointDiscoveryServer_writeEndpoints(conn, endpoints);
+            status = endpointDiscoveryServer_writeEndpoints(conn, endpoints, NULL);
 
             arrayList_destroy(endpoints);
         }
@@ -408,7 +494,13 @@ static int endpointDiscoveryServer_callback(struct mg_connection* conn) {
         if (strncmp(server->path, uri, strlen(server->path)) == 0) {
             // Be lenient when it comes to the trailing slash...
             if (path_len == uri_len || (uri_len == (path_len + 1) && uri[path_len] == '/')) {
-                status = endpointDiscoveryServer_returnAllEndpoints(server, conn);
+                int wait = 0;
+                char waitStr[16];
+                if (request_info->query_string != NULL &&
+                    mg_get_var(request_info->query_string, strlen(request_info->query_string), "wait", waitStr, sizeof(waitStr)) > 0) {
+                    wait = atoi(waitStr);
+                }
+                status = endpointDiscoveryServer_returnAllEndpoints(server, conn, mg_get_header(conn, "If-None-Match"), wait);
             } else {
                 const char* endpoint_id = uri + path_len + 1; // right after the slash...
 
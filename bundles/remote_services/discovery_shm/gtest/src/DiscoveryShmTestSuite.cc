@@ -0,0 +1,254 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/shm.h>
+
+extern "C" {
+#include "discovery_shm.h"
+}
+
+//note same as the (private) table limits and hash function in discovery_shm.c
+constexpr unsigned int MAX_LOAD = (SHM_DATA_MAX_ENTRIES / 4) * 3;
+
+static uint32_t fnv1a(const std::string& key) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+class DiscoveryShmTestSuite : public ::testing::Test {
+public:
+    DiscoveryShmTestSuite() {
+        //note the shm segment has a fixed key, remove a segment left behind by a previous (crashed) run
+        shmData_t *stale = nullptr;
+        if (discoveryShm_attach(&stale) == CELIX_SUCCESS) {
+            discoveryShm_destroy(stale);
+            shmdt(stale);
+        }
+        EXPECT_EQ(CELIX_SUCCESS, discoveryShm_create(&data));
+    }
+
+    ~DiscoveryShmTestSuite() override {
+        discoveryShm_destroy(data);
+        shmdt(data);
+    }
+
+    celix_status_t set(const std::string& key, const std::string& value) {
+        return discoveryShm_set(data, (char*)key.c_str(), (char*)value.c_str());
+    }
+
+    celix_status_t remove(const std::string& key) {
+        return discoveryShm_remove(data, (char*)key.c_str());
+    }
+
+    std::string get(const std::string& key) {
+        char value[SHM_ENTRY_MAX_VALUE_LENGTH];
+        return discoveryShm_get(data, (char*)key.c_str(), value) == CELIX_SUCCESS ? value : "<not found>";
+    }
+
+    /**
+     * Returns the changes since generation as key -> value map, with "<removed>" as value for removed keys.
+     */
+    std::map<std::string, std::string> getChanges(uint32_t* generation, bool* fullSync) {
+        array_list_pt changes = nullptr;
+        arrayList_create(&changes);
+        EXPECT_EQ(CELIX_SUCCESS, discoveryShm_getChanges(data, generation, changes, fullSync));
+        std::map<std::string, std::string> result{};
+        for (unsigned int i = 0; i < arrayList_size(changes); ++i) {
+            auto* change = static_cast<discovery_shm_change_t*>(arrayList_get(changes, i));
+            result[change->key] = change->removed ? "<removed>" : change->value;
+            free(change);
+        }
+        arrayList_destroy(changes);
+        return result;
+    }
+
+    /**
+     * Returns a key, not equal to key, which is placed in the same table slot as key.
+     */
+    static std::string collidingKey(const std::string& key) {
+        uint32_t slot = fnv1a(key) % SHM_DATA_MAX_ENTRIES;
+        for (int i = 0; ; ++i) {
+            std::string candidate = "collision-" + std::to_string(i);
+            if (candidate != key && fnv1a(candidate) % SHM_DATA_MAX_ENTRIES == slot) {
+                return candidate;
+            }
+        }
+    }
+
+    shmData_t *data = nullptr;
+};
+
+TEST_F(DiscoveryShmTestSuite, SetGetAndRemove) {
+    EXPECT_EQ("<not found>", get("key1"));
+    EXPECT_EQ(CELIX_SUCCESS, set("key1", "value1"));
+    EXPECT_EQ(CELIX_SUCCESS, set("key2", "value2"));
+    EXPECT_EQ("value1", get("key1"));
+    EXPECT_EQ("value2", get("key2"));
+
+    EXPECT_EQ(CELIX_SUCCESS, set("key1", "updated"));
+    EXPECT_EQ("updated", get("key1"));
+
+    EXPECT_EQ(CELIX_SUCCESS, remove("key1"));
+    EXPECT_EQ("<not found>", get("key1"));
+    EXPECT_EQ("value2", get("key2"));
+    EXPECT_NE(CELIX_SUCCESS, remove("key1"));
+
+    //a colliding key is found after the removed entry (tombstone) of key1
+    std::string key3 = collidingKey("key2");
+    EXPECT_EQ(CELIX_SUCCESS, set(key3, "value3"));
+    EXPECT_EQ(CELIX_SUCCESS, remove("key2"));
+    EXPECT_EQ("value3", get(key3));
+}
+
+TEST_F(DiscoveryShmTestSuite, GetChanges) {
+    uint32_t generation = 0;
+    bool fullSync = false;
+    EXPECT_EQ(CELIX_SUCCESS, set("key1", "value1"));
+    EXPECT_EQ(CELIX_SUCCESS, set("key2", "value2"));
+
+    //never synced -> all entries
+    auto changes = getChanges(&generation, &fullSync);
+    EXPECT_TRUE(fullSync);
+    std::map<std::string, std::string> expected{{"key1", "value1"}, {"key2", "value2"}};
+    EXPECT_EQ(expected, changes);
+    EXPECT_NE(0, generation);
+
+    //no changes
+    uint32_t previousGeneration = generation;
+    changes = getChanges(&generation, &fullSync);
+    EXPECT_FALSE(fullSync);
+    EXPECT_TRUE(changes.empty());
+    EXPECT_EQ(previousGeneration, generation);
+
+    //refreshing an entry with the same value is not a change
+    EXPECT_EQ(CELIX_SUCCESS, set("key1", "value1"));
+    EXPECT_TRUE(getChanges(&generation, &fullSync).empty());
+
+    //only the changed, added and removed entries
+    EXPECT_EQ(CELIX_SUCCESS, set("key1", "updated"));
+    EXPECT_EQ(CELIX_SUCCESS, set("key3", "value3"));
+    EXPECT_EQ(CELIX_SUCCESS, remove("key2"));
+    changes = getChanges(&generation, &fullSync);
+    EXPECT_FALSE(fullSync);
+    expected = {{"key1", "updated"}, {"key2", "<removed>"}, {"key3", "value3"}};
+    EXPECT_EQ(expected, changes);
+}
+
+TEST_F(DiscoveryShmTestSuite, ReuseOfOwnTombstone) {
+    uint32_t generation = 0;
+    bool fullSync = false;
+    EXPECT_EQ(CELIX_SUCCESS, set("key1", "value1"));
+    getChanges(&generation, &fullSync);
+
+    //re-adding a removed key reuses its own tombstone, no removal is lost
+    EXPECT_EQ(CELIX_SUCCESS, remove("key1"));
+    EXPECT_EQ(CELIX_SUCCESS, set("key1", "value2"));
+    auto changes = getChanges(&generation, &fullSync);
+    EXPECT_FALSE(fullSync);
+    std::map<std::string, std::string> expected{{"key1", "value2"}};
+    EXPECT_EQ(expected, changes);
+}
+
+TEST_F(DiscoveryShmTestSuite, ReuseOfTombstoneForcesFullSync) {
+    uint32_t generation = 0;
+    bool fullSync = false;
+    EXPECT_EQ(CELIX_SUCCESS, set("key1", "value1"));
+    EXPECT_EQ(CELIX_SUCCESS, set("key2", "value2"));
+    getChanges(&generation, &fullSync);
+
+    //a colliding key reuses the tombstone of key1, so its removal can no longer be reported
+    EXPECT_EQ(CELIX_SUCCESS, remove("key1"));
+    std::string other = collidingKey("key1");
+    EXPECT_EQ(CELIX_SUCCESS, set(other, "value3"));
+    EXPECT_EQ("value3", get(other));
+
+    auto changes = getChanges(&generation, &fullSync);
+    EXPECT_TRUE(fullSync);
+    std::map<std::string, std::string> expected{{"key2", "value2"}, {other, "value3"}};
+    EXPECT_EQ(expected, changes);
+
+    //a watcher which already saw the removal is not affected
+    EXPECT_EQ(CELIX_SUCCESS, set("key4", "value4"));
+    changes = getChanges(&generation, &fullSync);
+    EXPECT_FALSE(fullSync);
+    expected = {{"key4", "value4"}};
+    EXPECT_EQ(expected, changes);
+}
+
+TEST_F(DiscoveryShmTestSuite, FullTable) {
+    for (unsigned int i = 0; i < MAX_LOAD; ++i) {
+        ASSERT_EQ(CELIX_SUCCESS, set("key" + std::to_string(i), "value"));
+    }
+    EXPECT_EQ(CELIX_ILLEGAL_STATE, set("one too many", "value"));
+
+    //existing entries can still be updated
+    EXPECT_EQ(CELIX_SUCCESS, set("key0", "updated"));
+    EXPECT_EQ("updated", get("key0"));
+
+    //and after a removal there is room for a new entry again
+    EXPECT_EQ(CELIX_SUCCESS, remove("key1"));
+    EXPECT_EQ(CELIX_SUCCESS, set("one too many", "value"));
+    EXPECT_EQ("value", get("one too many"));
+    EXPECT_EQ(CELIX_ILLEGAL_STATE, set("two too many", "value"));
+}
+
+TEST_F(DiscoveryShmTestSuite, GetChangesAcrossRebuild) {
+    uint32_t generation = 0;
+    bool fullSync = false;
+    for (unsigned int i = 0; i < MAX_LOAD; ++i) {
+        ASSERT_EQ(CELIX_SUCCESS, set("key" + std::to_string(i), "value"));
+    }
+    for (unsigned int i = 0; i < 10; ++i) {
+        ASSERT_EQ(CELIX_SUCCESS, remove("key" + std::to_string(i)));
+    }
+    getChanges(&generation, &fullSync);
+    uint32_t synced = generation;
+
+    //too many used and removed slots, so adding a new key rebuilds the table and drops all tombstones
+    ASSERT_EQ(CELIX_SUCCESS, remove("key10"));
+    ASSERT_EQ(CELIX_SUCCESS, set("new key", "value"));
+    EXPECT_EQ("value", get("new key"));
+    EXPECT_EQ("value", get("key11"));
+    EXPECT_EQ("<not found>", get("key10"));
+
+    //the removal of key10 is lost, so a full sync is needed
+    auto changes = getChanges(&generation, &fullSync);
+    EXPECT_TRUE(fullSync);
+    EXPECT_EQ(MAX_LOAD - 11 + 1, changes.size());
+    EXPECT_EQ(0, changes.count("key10"));
+    EXPECT_EQ(1, changes.count("new key"));
+    EXPECT_NE(synced, generation);
+
+    //after the full sync changes are incremental again
+    ASSERT_EQ(CELIX_SUCCESS, remove("new key"));
+    changes = getChanges(&generation, &fullSync);
+    EXPECT_FALSE(fullSync);
+    std::map<std::string, std::string> expected{{"new key", "<removed>"}};
+    EXPECT_EQ(expected, changes);
+}
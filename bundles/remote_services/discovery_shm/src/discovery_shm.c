@@ -28,70 +28,150 @@
 #include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
 #include <time.h>
+#include <unistd.h>
 
 #include <sys/types.h>
-#include <sys/sem.h>
 #include <sys/shm.h>
 
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
 #include <celix_errno.h>
 #include <celix_threads.h>
 
 #include "discovery_shm.h"
 
-#define DISCOVERY_SHM_MEMSIZE 262144
 #define DISCOVERY_SHM_FILENAME "/dev/null"
-#define DISCOVERY_SHM_FTOK_ID 50
-#define DISCOVERY_SEM_FILENAME "/dev/null"
-#define DISCOVERY_SEM_FTOK_ID 54
+// note: differs from the id of the previous (flat array) layout, so both layouts never share a segment
+#define DISCOVERY_SHM_FTOK_ID 51
+#define DISCOVERY_SHM_MAGIC 0x44534832 /* "DSH2" */
+
+// max number of used and removed (tombstone) slots before the table is rebuilt
+#define DISCOVERY_SHM_MAX_LOAD ((SHM_DATA_MAX_ENTRIES / 4) * 3)
+
+#define SHM_ENTRY_EMPTY     0
+#define SHM_ENTRY_USED      1
+#define SHM_ENTRY_REMOVED   2
 
 struct shmEntry {
-    char key[SHM_ENTRY_MAX_KEY_LENGTH];
-    char value[SHM_ENTRY_MAX_VALUE_LENGTH];
+    uint32_t state;
+    uint32_t hash;
+    uint32_t generation; // generation of the last change of this entry
 
     time_t expires;
+
+    char key[SHM_ENTRY_MAX_KEY_LENGTH];
+    char value[SHM_ENTRY_MAX_VALUE_LENGTH];
 };
 
 typedef struct shmEntry shmEntry;
 
+/*
+ * Open addressing hash table (linear probing) in shared memory.
+ * Every change increases the generation, which is also used as futex word to notify watchers.
+ * Removed entries are kept as tombstones (with their key and generation), so that watchers can
+ * retrieve removals. If a tombstone is reused (or the table is rebuilt), watchers which did not
+ * see that removal yet need a full sync; this is tracked with resyncGeneration.
+ */
 struct shmData {
-    shmEntry entries[SHM_DATA_MAX_ENTRIES];
-    int numOfEntries;
+    uint32_t magic;
+    uint32_t generation;
+    uint32_t resyncGeneration;
+    uint32_t numOfEntries;
+    uint32_t numOfRemovedEntries;
+    time_t lastPurge;
     int shmId;
 
     celix_thread_mutex_t globalLock;
-};
-
-void* shmAddress;
 
-static celix_status_t discoveryShm_removeWithIndex(shmData_t *data, int index);
+    shmEntry entries[SHM_DATA_MAX_ENTRIES];
+};
 
 /* returns the ftok key to identify shared memory*/
 static key_t discoveryShm_getKey() {
     return ftok(DISCOVERY_SHM_FILENAME, DISCOVERY_SHM_FTOK_ID);
 }
 
+/* FNV-1a, note a hash independent of the (library) version of utils is needed, since the table is shared between processes */
+static uint32_t discoveryShm_hash(const char *key) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *c = (const unsigned char *) key; *c != '\0'; ++c) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* generations wrap around, 0 is reserved for 'never synced' */
+static bool discoveryShm_isAfter(uint32_t generation, uint32_t reference) {
+    return (int32_t) (generation - reference) > 0;
+}
+
+static void discoveryShm_notify(shmData_t *data) {
+#ifdef __linux__
+    syscall(SYS_futex, &data->generation, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+    (void) data;
+#endif
+}
+
+/* must be called with the globalLock taken */
+static uint32_t discoveryShm_nextGeneration(shmData_t *data) {
+    uint32_t generation = data->generation + 1;
+    if (generation == 0) {
+        generation = 1;
+    }
+    __atomic_store_n(&data->generation, generation, __ATOMIC_RELEASE);
+    return generation;
+}
+
+static celix_status_t discoveryShm_lock(shmData_t *data) {
+    int rc = pthread_mutex_lock(&data->globalLock);
+#ifdef __linux__
+    if (rc == EOWNERDEAD) {
+        // the previous owner died while holding the lock, the table itself is kept consistent per entry
+        rc = pthread_mutex_consistent(&data->globalLock);
+    }
+#endif
+    return rc == 0 ? CELIX_SUCCESS : CELIX_BUNDLE_EXCEPTION;
+}
+
+static void discoveryShm_unlock(shmData_t *data) {
+    pthread_mutex_unlock(&data->globalLock);
+}
+
 /* creates a new shared memory block */
 celix_status_t discoveryShm_create(shmData_t **data) {
-    celix_status_t status;
-
-    shmData_t *shmData = calloc(1, sizeof(*shmData));
+    celix_status_t status = CELIX_SUCCESS;
     key_t shmKey = discoveryShm_getKey();
+    int shmId;
+    shmData_t *shmData = NULL;
 
-    if (!shmData) {
-        status = CELIX_ENOMEM;
-    } else if ((shmData->shmId = shmget(shmKey, DISCOVERY_SHM_MEMSIZE, IPC_CREAT | 0666)) < 0) {
-        status = CELIX_BUNDLE_EXCEPTION;
-    } else if ((shmAddress = shmat(shmData->shmId, 0, 0)) == (char*) -1) {
+    if ((shmId = shmget(shmKey, sizeof(shmData_t), IPC_CREAT | IPC_EXCL | 0666)) < 0) {
+        // created concurrently by another process?
+        return errno == EEXIST ? discoveryShm_attach(data) : CELIX_BUNDLE_EXCEPTION;
+    } else if ((shmData = shmat(shmId, 0, 0)) == (void*) -1) {
         status = CELIX_BUNDLE_EXCEPTION;
     } else {
         celix_thread_mutexattr_t threadAttr;
 
-        shmData->numOfEntries = 0;
+        // note a new segment is zero initialized
+        shmData->shmId = shmId;
+        shmData->generation = 1;
+        shmData->resyncGeneration = 1;
 
         status = celixThreadMutexAttr_create(&threadAttr);
 
-#ifdef LINUX
+        if (status == CELIX_SUCCESS) {
+            status = pthread_mutexattr_setpshared(&threadAttr, PTHREAD_PROCESS_SHARED);
+        }
+
+#ifdef __linux__
         if (status == CELIX_SUCCESS) {
             // This is Linux specific
             status = pthread_mutexattr_setrobust(&threadAttr, PTHREAD_MUTEX_ROBUST);
@@ -103,109 +183,190 @@ celix_status_t discoveryShm_create(shmData_t **data) {
         }
 
         if (status == CELIX_SUCCESS) {
-            memcpy(shmAddress, shmData, sizeof(struct shmData));
-            (*data) = shmAddress;
+            __atomic_store_n(&shmData->magic, DISCOVERY_SHM_MAGIC, __ATOMIC_RELEASE);
+            (*data) = shmData;
+        } else {
+            shmdt(shmData);
+            shmctl(shmId, IPC_RMID, 0);
         }
     }
 
-    free(shmData);
-
     return status;
 }
 
 celix_status_t discoveryShm_attach(shmData_t **data) {
     celix_status_t status = CELIX_SUCCESS;
-    key_t shmKey = ftok(DISCOVERY_SHM_FILENAME, DISCOVERY_SHM_FTOK_ID);
+    key_t shmKey = discoveryShm_getKey();
     int shmId = -1;
 
-    if ((shmId = shmget(shmKey, DISCOVERY_SHM_MEMSIZE, 0666)) < 0) {
-        status = CELIX_BUNDLE_EXCEPTION;
+    if ((shmId = shmget(shmKey, sizeof(shmData_t), 0666)) < 0) {
+        return CELIX_BUNDLE_EXCEPTION;
     }
 
     /* shmat has a curious return value of (void*)-1 in case of error */
-    void *mem=shmat(shmId, 0, 0);
-    if(mem==((void*)-1)){
-	status = CELIX_BUNDLE_EXCEPTION;
-    }
-    else{
-	(*data)=mem;
+    shmData_t *mem = shmat(shmId, 0, 0);
+    if (mem == ((void*) -1)) {
+        status = CELIX_BUNDLE_EXCEPTION;
+    } else {
+        // the creating process could still be initializing
+        int retries = 100;
+        while (__atomic_load_n(&mem->magic, __ATOMIC_ACQUIRE) != DISCOVERY_SHM_MAGIC && retries-- > 0) {
+            usleep(10000);
+        }
+
+        if (mem->magic != DISCOVERY_SHM_MAGIC) {
+            shmdt(mem);
+            status = CELIX_BUNDLE_EXCEPTION;
+        } else {
+            (*data) = mem;
+        }
     }
 
     return status;
 }
 
-static celix_status_t discoveryShm_getwithIndex(shmData_t *data, char* key, char* value, int* index) {
-    celix_status_t status = CELIX_BUNDLE_EXCEPTION;
-    time_t currentTime = time(NULL);
+/* returns the index of the entry with key or -1 */
+static int discoveryShm_find(shmData_t *data, const char *key, uint32_t hash, bool includeExpired) {
     unsigned int i;
+    time_t currentTime = time(NULL);
 
-    for (i = 0; i < data->numOfEntries && status != CELIX_SUCCESS; i++) {
-        shmEntry entry = data->entries[i];
-        // check if entry is still valid
-        if (data->entries[i].expires < currentTime) {
-            discoveryShm_removeWithIndex(data, i);
-        } else if (strcmp(entry.key, key) == 0) {
-            if (value) {
-                strcpy(value, entry.value);
-            }
-            if (index) {
-                (*index) = i;
-            }
-            status = CELIX_SUCCESS;
+    for (i = 0; i < SHM_DATA_MAX_ENTRIES; i++) {
+        int index = (hash + i) % SHM_DATA_MAX_ENTRIES;
+        shmEntry *entry = &data->entries[index];
+
+        if (entry->state == SHM_ENTRY_EMPTY) {
+            break;
+        } else if (entry->state == SHM_ENTRY_USED && entry->hash == hash && strcmp(entry->key, key) == 0) {
+            return (!includeExpired && entry->expires < currentTime) ? -1 : index;
         }
     }
 
-    return status;
+    return -1;
 }
 
-celix_status_t discoveryShm_getKeys(shmData_t *data, char** keys, int* size) {
-    celix_status_t status;
+/* must be called with the globalLock taken */
+static void discoveryShm_removeWithIndex(shmData_t *data, int index) {
+    shmEntry *entry = &data->entries[index];
 
-    status = celixThreadMutex_lock(&data->globalLock);
+    entry->state = SHM_ENTRY_REMOVED;
+    entry->value[0] = '\0';
+    entry->generation = discoveryShm_nextGeneration(data);
+    data->numOfEntries--;
+    data->numOfRemovedEntries++;
+}
 
-    if (status == CELIX_SUCCESS) {
-    	unsigned int i = 0;
-        for (i = 0; i < data->numOfEntries; i++) {
-            shmEntry entry = data->entries[i];
+/* removes all expired entries, at most once a second. Must be called with the globalLock taken */
+static bool discoveryShm_purgeExpired(shmData_t *data) {
+    bool purged = false;
+    time_t currentTime = time(NULL);
 
-            if (strlen(entry.key)>0) {
-                snprintf(keys[i], SHM_ENTRY_MAX_KEY_LENGTH, "%s", entry.key);
+    if (data->lastPurge != currentTime) {
+        unsigned int i;
+
+        data->lastPurge = currentTime;
+        for (i = 0; i < SHM_DATA_MAX_ENTRIES && data->numOfEntries > 0; i++) {
+            if (data->entries[i].state == SHM_ENTRY_USED && data->entries[i].expires < currentTime) {
+                discoveryShm_removeWithIndex(data, i);
+                purged = true;
             }
         }
+    }
+
+    return purged;
+}
 
-        (*size) = i;
+/* reinserts all used entries, dropping the tombstones. Must be called with the globalLock taken */
+static celix_status_t discoveryShm_rebuild(shmData_t *data) {
+    unsigned int i, j;
+    shmEntry *entries = malloc(data->numOfEntries * sizeof(*entries));
 
-        celixThreadMutex_unlock(&data->globalLock);
+    if (entries == NULL) {
+        return CELIX_ENOMEM;
     }
 
-    return status;
+    for (i = 0, j = 0; i < SHM_DATA_MAX_ENTRIES; i++) {
+        if (data->entries[i].state == SHM_ENTRY_USED) {
+            entries[j++] = data->entries[i];
+        }
+    }
+
+    memset(data->entries, 0, sizeof(data->entries));
+    for (i = 0; i < j; i++) {
+        unsigned int index = entries[i].hash % SHM_DATA_MAX_ENTRIES;
+        while (data->entries[index].state != SHM_ENTRY_EMPTY) {
+            index = (index + 1) % SHM_DATA_MAX_ENTRIES;
+        }
+        data->entries[index] = entries[i];
+    }
+    data->numOfRemovedEntries = 0;
+
+    // all removals are gone, so every watcher needs a full sync
+    data->resyncGeneration = discoveryShm_nextGeneration(data);
+
+    free(entries);
+
+    return CELIX_SUCCESS;
 }
 
 celix_status_t discoveryShm_set(shmData_t *data, char *key, char* value) {
     celix_status_t status;
-    int index = -1;
+    uint32_t hash = discoveryShm_hash(key);
 
-    if (data->numOfEntries >= SHM_DATA_MAX_ENTRIES) {
-        status = CELIX_ILLEGAL_STATE;
-    } else {
-        status = celixThreadMutex_lock(&data->globalLock);
+    status = discoveryShm_lock(data);
 
-        if (status == CELIX_SUCCESS) {
-            // check if key already there
-            status = discoveryShm_getwithIndex(data, key, NULL, &index);
-            if (status != CELIX_SUCCESS) {
-                index = data->numOfEntries;
+    if (status == CELIX_SUCCESS) {
+        bool changed = discoveryShm_purgeExpired(data);
+        // check if key already there
+        int index = discoveryShm_find(data, key, hash, true);
 
-                snprintf(data->entries[index].key, SHM_ENTRY_MAX_KEY_LENGTH, "%s", key);
-                data->numOfEntries++;
+        if (index < 0 && data->numOfEntries >= DISCOVERY_SHM_MAX_LOAD) {
+            status = CELIX_ILLEGAL_STATE;
+        } else if (index < 0) {
+            unsigned int i;
 
-                 status = CELIX_SUCCESS;
+            if (data->numOfEntries + data->numOfRemovedEntries >= DISCOVERY_SHM_MAX_LOAD) {
+                status = discoveryShm_rebuild(data);
             }
 
-            snprintf(data->entries[index].value, SHM_ENTRY_MAX_VALUE_LENGTH, "%s", value);
-            data->entries[index].expires = (time(NULL) + SHM_ENTRY_DEFAULT_TTL);
+            for (i = 0; i < SHM_DATA_MAX_ENTRIES && status == CELIX_SUCCESS; i++) {
+                unsigned int candidate = (hash + i) % SHM_DATA_MAX_ENTRIES;
+                shmEntry *entry = &data->entries[candidate];
+
+                if (entry->state == SHM_ENTRY_REMOVED && strcmp(entry->key, key) != 0 && discoveryShm_isAfter(entry->generation, data->resyncGeneration)) {
+                    // the removal of entry->key will be lost for watchers which did not see it yet
+                    data->resyncGeneration = entry->generation;
+                }
+                if (entry->state != SHM_ENTRY_USED) {
+                    if (entry->state == SHM_ENTRY_REMOVED) {
+                        data->numOfRemovedEntries--;
+                    }
+                    entry->state = SHM_ENTRY_USED;
+                    entry->hash = hash;
+                    snprintf(entry->key, SHM_ENTRY_MAX_KEY_LENGTH, "%s", key);
+                    entry->value[0] = '\0';
+                    data->numOfEntries++;
+                    index = candidate;
+                    break;
+                }
+            }
+        }
 
-            celixThreadMutex_unlock(&data->globalLock);
+        if (index >= 0) {
+            shmEntry *entry = &data->entries[index];
+
+            if (strncmp(entry->value, value, SHM_ENTRY_MAX_VALUE_LENGTH - 1) != 0) {
+                snprintf(entry->value, SHM_ENTRY_MAX_VALUE_LENGTH, "%s", value);
+                entry->generation = discoveryShm_nextGeneration(data);
+                changed = true;
+            }
+            // note that only refreshing the time-to-live is not a change
+            entry->expires = (time(NULL) + SHM_ENTRY_DEFAULT_TTL);
+        }
+
+        discoveryShm_unlock(data);
+
+        if (changed) {
+            discoveryShm_notify(data);
         }
     }
 
@@ -215,54 +376,115 @@ celix_status_t discoveryShm_set(shmData_t *data, char *key, char* value) {
 celix_status_t discoveryShm_get(shmData_t *data, char* key, char* value) {
     celix_status_t status;
 
-    status = celixThreadMutex_lock(&data->globalLock);
+    status = discoveryShm_lock(data);
 
     if (status == CELIX_SUCCESS) {
-        status = discoveryShm_getwithIndex(data, key, value, NULL);
+        int index = discoveryShm_find(data, key, discoveryShm_hash(key), false);
+
+        if (index < 0) {
+            status = CELIX_BUNDLE_EXCEPTION;
+        } else if (value) {
+            strcpy(value, data->entries[index].value);
+        }
 
-        celixThreadMutex_unlock(&data->globalLock);
+        discoveryShm_unlock(data);
     }
 
     return status;
 }
 
-static celix_status_t discoveryShm_removeWithIndex(shmData_t *data, int index) {
-    celix_status_t status = CELIX_SUCCESS;
+celix_status_t discoveryShm_remove(shmData_t *data, char* key) {
+    celix_status_t status;
 
-    data->numOfEntries--;
-    if (index < data->numOfEntries) {
-        memcpy((void*) &data->entries[index], (void*) &data->entries[index + 1], ((data->numOfEntries - index) * sizeof(struct shmEntry)));
+    status = discoveryShm_lock(data);
+
+    if (status == CELIX_SUCCESS) {
+        int index = discoveryShm_find(data, key, discoveryShm_hash(key), true);
+
+        if (index < 0) {
+            status = CELIX_BUNDLE_EXCEPTION;
+        } else {
+            discoveryShm_removeWithIndex(data, index);
+        }
+
+        discoveryShm_unlock(data);
+
+        if (status == CELIX_SUCCESS) {
+            discoveryShm_notify(data);
+        }
     }
 
     return status;
 }
 
-celix_status_t discoveryShm_remove(shmData_t *data, char* key) {
+celix_status_t discoveryShm_getChanges(shmData_t *data, uint32_t *generation, array_list_pt changes, bool *fullSync) {
     celix_status_t status;
-    int index = -1;
 
-    status = celixThreadMutex_lock(&data->globalLock);
+    if (__atomic_load_n(&data->generation, __ATOMIC_ACQUIRE) == *generation) {
+        // nothing changed, no need to take the lock
+        *fullSync = false;
+        return CELIX_SUCCESS;
+    }
+
+    status = discoveryShm_lock(data);
 
     if (status == CELIX_SUCCESS) {
-        status = discoveryShm_getwithIndex(data, key, NULL, &index);
+        unsigned int i;
+        time_t currentTime = time(NULL);
+        bool full = *generation == 0 || discoveryShm_isAfter(data->resyncGeneration, *generation);
+
+        for (i = 0; i < SHM_DATA_MAX_ENTRIES && status == CELIX_SUCCESS; i++) {
+            shmEntry *entry = &data->entries[i];
+            bool added = entry->state == SHM_ENTRY_USED && entry->expires >= currentTime;
+            bool removed = entry->state == SHM_ENTRY_REMOVED && !full;
+
+            if ((added || removed) && (full || discoveryShm_isAfter(entry->generation, *generation))) {
+                discovery_shm_change_t *change = calloc(1, sizeof(*change));
+
+                if (change == NULL) {
+                    status = CELIX_ENOMEM;
+                } else {
+                    snprintf(change->key, SHM_ENTRY_MAX_KEY_LENGTH, "%s", entry->key);
+                    snprintf(change->value, SHM_ENTRY_MAX_VALUE_LENGTH, "%s", entry->value);
+                    change->removed = removed;
+                    arrayList_add(changes, change);
+                }
+            }
+        }
 
         if (status == CELIX_SUCCESS) {
-            status = discoveryShm_removeWithIndex(data, index);
+            *generation = data->generation;
+            *fullSync = full;
         }
 
-        celixThreadMutex_unlock(&data->globalLock);
+        discoveryShm_unlock(data);
     }
 
     return status;
 }
 
+celix_status_t discoveryShm_waitForChange(shmData_t *data, uint32_t generation, unsigned int timeoutInMs) {
+    if (__atomic_load_n(&data->generation, __ATOMIC_ACQUIRE) == generation) {
+#ifdef __linux__
+        // note not FUTEX_PRIVATE_FLAG, the futex word is shared between processes
+        struct timespec timeout = {timeoutInMs / 1000, (timeoutInMs % 1000) * 1000000L};
+        syscall(SYS_futex, &data->generation, FUTEX_WAIT, generation, &timeout, NULL, 0);
+#else
+        usleep(timeoutInMs * 1000);
+#endif
+    }
+
+    return CELIX_SUCCESS;
+}
+
 celix_status_t discoveryShm_detach(shmData_t *data) {
     celix_status_t status = CELIX_BUNDLE_EXCEPTION;
 
     if (data->numOfEntries == 0) {
         status = discoveryShm_destroy(data);
     }
-    else if (shmdt(shmAddress) == 0) {
+
+    if (shmdt(data) == 0 && status != CELIX_SUCCESS) {
         status = CELIX_SUCCESS;
     }
 
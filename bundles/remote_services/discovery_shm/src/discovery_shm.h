@@ -27,7 +27,11 @@
 #ifndef _DISCOVERY_SHM_H_
 #define _DISCOVERY_SHM_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <celix_errno.h>
+#include <array_list.h>
 
 #define SHM_ENTRY_MAX_KEY_LENGTH	256
 #define SHM_ENTRY_MAX_VALUE_LENGTH	256
@@ -35,18 +39,40 @@
 // defines the time-to-live in seconds
 #define SHM_ENTRY_DEFAULT_TTL		60
 
-// we currently support 64 separate discovery instances
-#define SHM_DATA_MAX_ENTRIES		64
+// max number of discovery instances (entries) in the shared hash table. Kept at most 75% full.
+#define SHM_DATA_MAX_ENTRIES		4096
 
 typedef struct shmData shmData_t;
 
+/*
+ * A change as returned by discoveryShm_getChanges. If removed is true, value is empty.
+ */
+typedef struct discovery_shm_change {
+    char key[SHM_ENTRY_MAX_KEY_LENGTH];
+    char value[SHM_ENTRY_MAX_VALUE_LENGTH];
+    bool removed;
+} discovery_shm_change_t;
+
 /* creates a new shared memory block */
 celix_status_t discoveryShm_create(shmData_t **data);
 celix_status_t discoveryShm_attach(shmData_t **data);
 celix_status_t discoveryShm_set(shmData_t *data, char *key, char* value);
 celix_status_t discoveryShm_get(shmData_t *data, char* key, char* value);
-celix_status_t discoveryShm_getKeys(shmData_t *data, char** keys, int* size);
 celix_status_t discoveryShm_remove(shmData_t *data, char* key);
+
+/*
+ * Returns the entries added, changed or removed since generation (0 means: never synced) as
+ * discovery_shm_change_t elements (to be freed by the caller) and updates generation.
+ * If fullSync is set, the changes could not be determined and all entries are returned; entries
+ * known by the caller but not in changes have been removed.
+ */
+celix_status_t discoveryShm_getChanges(shmData_t *data, uint32_t *generation, array_list_pt changes, bool *fullSync);
+
+/*
+ * Waits until the shared memory is changed after generation, or timeoutInMs has passed.
+ */
+celix_status_t discoveryShm_waitForChange(shmData_t *data, uint32_t generation, unsigned int timeoutInMs);
+
 celix_status_t discoveryShm_detach(shmData_t *data);
 celix_status_t discoveryShm_destroy(shmData_t *data);
 
@@ -29,9 +29,12 @@
 #include <unistd.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
 
 
 #include "celix_log.h"
+#include "hash_map.h"
+#include "utils.h"
 #include "celix_constants.h"
 #include "discovery_impl.h"
 
@@ -48,12 +51,20 @@
 #define MAX_ROOTNODE_LENGTH		 64
 #define MAX_LOCALNODE_LENGTH	256
 
+// interval (in seconds) in which the own registration is refreshed, must be well below SHM_ENTRY_DEFAULT_TTL
+#define REFRESH_INTERVAL        5
+// max time (in ms) to wait for a change, bounds the time needed to stop the watcher
+#define MAX_WAIT_TIME_MS        1000
+
 
 struct shm_watcher {
     shmData_t *shmData;
     celix_thread_t watcherThread;
     celix_thread_mutex_t watcherLock;
 
+    uint32_t generation; // generation of the shared memory the endpoints are synced with
+    hash_map_pt endpoints; // key = shm key, value = url of the discovery endpoint
+
     volatile bool running;
 };
 
@@ -88,68 +99,87 @@ static celix_status_t discoveryShmWatcher_getLocalNodePath(celix_bundle_context_
     return status;
 }
 
-/* retrieves all endpoints from shm and syncs them with the ones already available */
-static celix_status_t discoveryShmWatcher_syncEndpoints(discovery_t *discovery) {
-    celix_status_t status = CELIX_SUCCESS;
+static void discoveryShmWatcher_removeEndpoint(discovery_t *discovery, const char *key) {
     shm_watcher_t *watcher = discovery->pImpl->watcher;
-    char** shmKeyArr = calloc(SHM_DATA_MAX_ENTRIES, sizeof(*shmKeyArr));
-    array_list_pt registeredKeyArr = NULL;
+    hash_map_entry_pt entry = hashMap_getEntry(watcher->endpoints, (void*) key);
 
-    int i, j, shmSize;
+    if (entry != NULL) {
+        char *knownKey = hashMapEntry_getKey(entry);
+        char *url = hashMap_remove(watcher->endpoints, (void*) key);
 
-    for (i = 0; i < SHM_DATA_MAX_ENTRIES; i++) {
-        shmKeyArr[i] = calloc(SHM_ENTRY_MAX_KEY_LENGTH, sizeof(*shmKeyArr[i]));
+        endpointDiscoveryPoller_removeDiscoveryEndpoint(discovery->poller, url);
+        free(knownKey);
+        free(url);
     }
+}
 
-    arrayList_create(&registeredKeyArr);
+static void discoveryShmWatcher_setEndpoint(discovery_t *discovery, const char *key, const char *url) {
+    shm_watcher_t *watcher = discovery->pImpl->watcher;
+    char *knownUrl = hashMap_get(watcher->endpoints, (void*) key);
 
-    // get all urls available in shm
-    discoveryShm_getKeys(watcher->shmData, shmKeyArr, &shmSize);
+    if (knownUrl == NULL || strcmp(knownUrl, url) != 0) {
+        discoveryShmWatcher_removeEndpoint(discovery, key);
+        hashMap_put(watcher->endpoints, strdup(key), strdup(url));
+        endpointDiscoveryPoller_addDiscoveryEndpoint(discovery->poller, (char*) url);
+    }
+}
+
+/* retrieves the endpoints changed in shm and syncs them with the ones already available */
+static celix_status_t discoveryShmWatcher_syncEndpoints(discovery_t *discovery) {
+    celix_status_t status;
+    shm_watcher_t *watcher = discovery->pImpl->watcher;
+    array_list_pt changes = NULL;
+    bool fullSync = false;
+    int i;
 
-    // get all locally registered endpoints
-    endpointDiscoveryPoller_getDiscoveryEndpoints(discovery->poller, registeredKeyArr);
+    arrayList_create(&changes);
 
-    // add discovery points which are in shm, but not local yet
-    for (i = 0; i < shmSize; i++) {
-        char url[SHM_ENTRY_MAX_VALUE_LENGTH];
+    status = discoveryShm_getChanges(watcher->shmData, &watcher->generation, changes, &fullSync);
 
-        if (discoveryShm_get(watcher->shmData, shmKeyArr[i], &url[0]) == CELIX_SUCCESS) {
-            bool elementFound = false;
+    if (status == CELIX_SUCCESS) {
+        hash_map_pt present = fullSync ? hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL) : NULL;
 
-            for (j = 0; j < arrayList_size(registeredKeyArr) && elementFound == false; j++) {
+        for (i = 0; i < arrayList_size(changes); i++) {
+            discovery_shm_change_t *change = arrayList_get(changes, i);
 
-                if (strcmp(url, (char*) arrayList_get(registeredKeyArr, j)) == 0) {
-                    free(arrayList_remove(registeredKeyArr, j));
-                    elementFound = true;
+            if (change->removed) {
+                discoveryShmWatcher_removeEndpoint(discovery, change->key);
+            } else {
+                discoveryShmWatcher_setEndpoint(discovery, change->key, change->value);
+                if (present != NULL) {
+                    hashMap_put(present, change->key, change->key);
                 }
             }
+        }
+
+        if (present != NULL) {
+            // remove those which are not in shm anymore
+            hash_map_iterator_pt iter = hashMapIterator_create(watcher->endpoints);
+            array_list_pt removed = NULL;
 
-            if (elementFound == false) {
-                endpointDiscoveryPoller_addDiscoveryEndpoint(discovery->poller, url);
+            arrayList_create(&removed);
+            while (hashMapIterator_hasNext(iter)) {
+                char *key = hashMapIterator_nextKey(iter);
+                if (!hashMap_containsKey(present, key)) {
+                    arrayList_add(removed, key);
+                }
             }
-        }
-    }
+            hashMapIterator_destroy(iter);
 
-    // remove those which are not in shm
-    for (i = 0; i < arrayList_size(registeredKeyArr); i++) {
-        char* regUrl = arrayList_get(registeredKeyArr, i);
+            for (i = 0; i < arrayList_size(removed); i++) {
+                discoveryShmWatcher_removeEndpoint(discovery, arrayList_get(removed, i));
+            }
 
-        if (regUrl != NULL) {
-            endpointDiscoveryPoller_removeDiscoveryEndpoint(discovery->poller, regUrl);
+            arrayList_destroy(removed);
+            hashMap_destroy(present, false, false);
         }
     }
 
-    for (i = 0; i < SHM_DATA_MAX_ENTRIES; i++) {
-        free(shmKeyArr[i]);
+    for (i = 0; i < arrayList_size(changes); i++) {
+        free(arrayList_get(changes, i));
     }
 
-    free(shmKeyArr);
-
-    for (j = 0; j < arrayList_size(registeredKeyArr); j++) {
-        free(arrayList_get(registeredKeyArr, j));
-    }
-
-    arrayList_destroy(registeredKeyArr);
+    arrayList_destroy(changes);
 
     return status;
 }
@@ -168,14 +198,23 @@ static void* discoveryShmWatcher_run(void* data) {
         snprintf(url, MAX_LOCALNODE_LENGTH, "http://%s:%s/%s", DEFAULT_SERVER_IP, DEFAULT_SERVER_PORT, DEFAULT_SERVER_PATH);
     }
 
+    time_t nextRefresh = 0;
+
     while (watcher->running) {
-        // register own framework
-        if (discoveryShm_set(watcher->shmData, localNodePath, url) != CELIX_SUCCESS) {
-            celix_logHelper_log(discovery->loghelper, CELIX_LOG_LEVEL_WARNING, "Cannot set local discovery registration.");
+        time_t now = time(NULL);
+
+        if (now >= nextRefresh) {
+            // register own framework, also refreshes the time-to-live
+            if (discoveryShm_set(watcher->shmData, localNodePath, url) != CELIX_SUCCESS) {
+                celix_logHelper_log(discovery->loghelper, CELIX_LOG_LEVEL_WARNING, "Cannot set local discovery registration.");
+            }
+            nextRefresh = now + REFRESH_INTERVAL;
         }
 
         discoveryShmWatcher_syncEndpoints(discovery);
-        sleep(5);
+
+        // woken up immediately when another discovery instance changes the shared memory
+        discoveryShm_waitForChange(watcher->shmData, watcher->generation, MAX_WAIT_TIME_MS);
     }
 
     return NULL;
@@ -190,6 +229,7 @@ celix_status_t discoveryShmWatcher_create(discovery_t *discovery) {
     if (!watcher) {
         status = CELIX_ENOMEM;
     } else {
+        watcher->endpoints = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
         status = discoveryShm_attach(&(watcher->shmData));
 
         if (status != CELIX_SUCCESS) {
@@ -207,6 +247,7 @@ celix_status_t discoveryShmWatcher_create(discovery_t *discovery) {
         }
         else{
         	discovery->pImpl->watcher = NULL;
+        	hashMap_destroy(watcher->endpoints, false, false);
         	free(watcher);
         }
 
@@ -243,6 +284,7 @@ celix_status_t discoveryShmWatcher_destroy(discovery_t *discovery) {
 
     if (status == CELIX_SUCCESS) {
         discoveryShm_detach(watcher->shmData);
+        hashMap_destroy(watcher->endpoints, true, true);
         free(watcher);
     }
     else {
@@ -63,6 +63,23 @@ typedef struct remote_example {
 
     int (*createAdditionalRemoteService)(void *handle);
 
+    /**
+     * Blocks for the provided time in milliseconds. Used to test concurrent remote calls.
+     */
+    int (*sleepFor)(void *handle, int32_t timeInMs);
+
+    /**
+     * Asynchronous variant of sleepFor. If 0 is returned, the callback is called when the sleep is done.
+     * Used to test asynchronous remote calls.
+     */
+    int (*sleepForAsync)(void *handle, int32_t timeInMs, void (*callback)(void *callbackData, int status), void *callbackData);
+
+    /**
+     * Returns the highest number of sleepFor calls which were in progress at the same time, since the previous
+     * getMaxConcurrentSleeps call. Used to test that remote calls are handled concurrently.
+     */
+    int (*getMaxConcurrentSleeps)(void *handle, int32_t *out);
+
 } remote_example_t;
 
 #endif //CELIX_REMOTE_EXAMPLE_H
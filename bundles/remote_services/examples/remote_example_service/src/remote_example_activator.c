@@ -44,6 +44,9 @@ celix_status_t remoteExampleBndStart(struct activator *act, celix_bundle_context
         act->service.action = (void*)remoteExample_action;
         act->service.setComplex = (void*)remoteExample_setComplex;
         act->service.createAdditionalRemoteService = (void*)remoteExample_createAdditionalRemoteService;
+        act->service.sleepFor = (void*)remoteExample_sleepFor;
+        act->service.sleepForAsync = (void*)remoteExample_sleepForAsync;
+        act->service.getMaxConcurrentSleeps = (void*)remoteExample_getMaxConcurrentSleeps;
 
         celix_properties_t *properties = celix_properties_create();
         celix_properties_set(properties, OSGI_RSA_SERVICE_EXPORTED_INTERFACES, REMOTE_EXAMPLE_NAME);
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <pthread.h>
+#include <unistd.h>
 #include <remote_constants.h>
 
 #include "remote_example.h"
@@ -34,6 +35,9 @@ struct remote_example_impl {
 
     remote_example_t additionalSvc;
     long additionalSvcId;
+
+    int32_t activeSleeps;
+    int32_t maxActiveSleeps; //since the last getMaxConcurrentSleeps call
 };
 
 remote_example_impl_t* remoteExample_create(celix_bundle_context_t* ctx) {
@@ -53,6 +57,9 @@ remote_example_impl_t* remoteExample_create(celix_bundle_context_t* ctx) {
     impl->additionalSvc.action = (void*)remoteExample_action;
     impl->additionalSvc.setComplex = (void*)remoteExample_setComplex;
     impl->additionalSvc.createAdditionalRemoteService = (void*)remoteExample_createAdditionalRemoteService;
+    impl->additionalSvc.sleepFor = (void*)remoteExample_sleepFor;
+    impl->additionalSvc.sleepForAsync = (void*)remoteExample_sleepForAsync;
+    impl->additionalSvc.getMaxConcurrentSleeps = (void*)remoteExample_getMaxConcurrentSleeps;
 
     return impl;
 }
@@ -173,4 +180,38 @@ int remoteExample_createAdditionalRemoteService(remote_example_impl_t* impl) {
         }
     }
     return rc;
-}
\ No newline at end of file
+}
+int remoteExample_sleepFor(remote_example_impl_t* impl, int32_t timeInMs) {
+    pthread_mutex_lock(&impl->mutex);
+    impl->activeSleeps += 1;
+    if (impl->activeSleeps > impl->maxActiveSleeps) {
+        impl->maxActiveSleeps = impl->activeSleeps;
+    }
+    pthread_mutex_unlock(&impl->mutex);
+
+    if (timeInMs > 0) {
+        usleep((useconds_t)timeInMs * 1000);
+    }
+
+    pthread_mutex_lock(&impl->mutex);
+    impl->activeSleeps -= 1;
+    pthread_mutex_unlock(&impl->mutex);
+    return 0;
+}
+
+int remoteExample_sleepForAsync(remote_example_impl_t* impl, int32_t timeInMs, void (*callback)(void *callbackData, int status), void *callbackData) {
+    //note completing the callback before returning is also a valid asynchronous implementation
+    int rc = remoteExample_sleepFor(impl, timeInMs);
+    if (callback != NULL) {
+        callback(callbackData, rc);
+    }
+    return 0;
+}
+
+int remoteExample_getMaxConcurrentSleeps(remote_example_impl_t* impl, int32_t *out) {
+    pthread_mutex_lock(&impl->mutex);
+    *out = impl->maxActiveSleeps;
+    impl->maxActiveSleeps = impl->activeSleeps;
+    pthread_mutex_unlock(&impl->mutex);
+    return 0;
+}
@@ -37,6 +37,9 @@ int remoteExample_setName2(remote_example_impl_t* impl, const char *n, char **ou
 int remoteExample_action(remote_example_impl_t* impl);
 int remoteExample_setComplex(remote_example_impl_t *impl, struct complex_input_example *exmpl, struct complex_output_example **out);
 int remoteExample_createAdditionalRemoteService(remote_example_impl_t* impl);
+int remoteExample_sleepFor(remote_example_impl_t* impl, int32_t timeInMs);
+int remoteExample_sleepForAsync(remote_example_impl_t* impl, int32_t timeInMs, void (*callback)(void *callbackData, int status), void *callbackData);
+int remoteExample_getMaxConcurrentSleeps(remote_example_impl_t* impl, int32_t *out);
 
 //TODO complex
 #endif //CELIX_REMOTE_EXAMPLE_IMPL_H
@@ -148,6 +148,26 @@ extern "C" {
         ASSERT_TRUE(ok);
     };
 
+    static void testConcurrentRemoteCalls(void *handle __attribute__((unused)), void *svc) {
+        auto *tst = static_cast<tst_service_t *>(svc);
+
+        bool discovered = tst->isRemoteExampleDiscovered(tst->handle);
+        ASSERT_TRUE(discovered);
+
+        bool ok = tst->testConcurrentRemoteCalls(tst->handle);
+        ASSERT_TRUE(ok);
+    };
+
+    static void testAsyncRemoteCalls(void *handle __attribute__((unused)), void *svc) {
+        auto *tst = static_cast<tst_service_t *>(svc);
+
+        bool discovered = tst->isRemoteExampleDiscovered(tst->handle);
+        ASSERT_TRUE(discovered);
+
+        bool ok = tst->testAsyncRemoteCalls(tst->handle);
+        ASSERT_TRUE(ok);
+    };
+
 }
 
 template<typename F>
@@ -208,3 +228,11 @@ TEST_F(RsaDfiClientServerTests, CreateDestroyComponentWithRemoteService) {
 TEST_F(RsaDfiClientServerTests, AddRemoteServiceInRemoteService) {
     test(testAddRemoteServiceInRemoteService);
 }
+
+TEST_F(RsaDfiClientServerTests, ConcurrentRemoteCalls) {
+    test(testConcurrentRemoteCalls);
+}
+
+TEST_F(RsaDfiClientServerTests, AsyncRemoteCalls) {
+    test(testAsyncRemoteCalls);
+}
@@ -19,6 +19,7 @@
 
 #include "gtest/gtest.h"
 
+#include <curl/curl.h>
 #include <remote_constants.h>
 #include "celix_api.h"
 #include "calculator_service.h"
@@ -29,6 +30,7 @@ extern "C" {
 #include "calculator_service.h"
 
 #define TST_CONFIGURATION_TYPE "org.amdatu.remote.admin.http"
+#define TST_ENDPOINT_URL "org.amdatu.remote.admin.http.url"
 
     static celix_framework_t *framework = NULL;
     static celix_bundle_context_t *context = NULL;
@@ -106,6 +108,64 @@ extern "C" {
         ASSERT_TRUE(called);
     }
 
+    static size_t discardResponse(void *contents __attribute__((unused)), size_t size, size_t nmemb, void *userp __attribute__((unused))) {
+        return size * nmemb;
+    }
+
+    static void testKeepAliveCallback(void *handle __attribute__((unused)), void *svc) {
+        auto* rsa = static_cast<remote_service_admin_service_t*>(svc);
+
+        char strSvcId[64];
+        snprintf(strSvcId, 64, "%li", calcSvcId);
+
+        celix_array_list_t *svcRegistration = NULL;
+        int rc = rsa->exportService(rsa->admin, strSvcId, NULL, &svcRegistration);
+        ASSERT_EQ(CELIX_SUCCESS, rc);
+        ASSERT_EQ(1, celix_arrayList_size(svcRegistration));
+        auto* registration = static_cast<export_registration_t*>(celix_arrayList_get(svcRegistration, 0));
+
+        export_reference_t *ref = NULL;
+        rc = rsa->exportRegistration_getExportReference(registration, &ref);
+        ASSERT_EQ(CELIX_SUCCESS, rc);
+        endpoint_description_t *endpoint = NULL;
+        rc = rsa->exportReference_getExportedEndpoint(ref, &endpoint);
+        ASSERT_EQ(CELIX_SUCCESS, rc);
+        const char *url = celix_properties_get(endpoint->properties, TST_ENDPOINT_URL, NULL);
+        ASSERT_TRUE(url != NULL);
+
+        //two calls with the same curl handle, the second call should reuse the kept-alive connection
+        const char *request = R"({"m":"add(DD)D", "a": [1.0,2.0]})";
+        CURL *curl = curl_easy_init();
+        ASSERT_TRUE(curl != NULL);
+        curl_easy_setopt(curl, CURLOPT_URL, url);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discardResponse);
+        for (int i = 0; i < 2; ++i) {
+            EXPECT_EQ(CURLE_OK, curl_easy_perform(curl));
+            long nrOfConnects = -1;
+            curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &nrOfConnects);
+            EXPECT_EQ(i == 0 ? 1 : 0, nrOfConnects);
+        }
+        curl_easy_cleanup(curl);
+
+        free(ref);
+        rc = rsa->exportRegistration_close(rsa->admin, registration);
+        ASSERT_EQ(CELIX_SUCCESS, rc);
+        celix_arrayList_destroy(svcRegistration);
+    }
+
+    static void testKeepAlive(void) {
+        celix_service_use_options_t opts{};
+        opts.filter.serviceName = OSGI_RSA_REMOTE_SERVICE_ADMIN;
+        opts.use = testKeepAliveCallback;
+        opts.filter.ignoreServiceLanguage = true;
+        opts.waitTimeoutInSeconds = 0.25;
+        bool called = celix_bundleContext_useServiceWithOptions(context, &opts);
+        ASSERT_TRUE(called);
+    }
+
     static void testImportServiceCallback(void *handle __attribute__((unused)), void *svc) {
         auto *rsa = static_cast<remote_service_admin_service_t *>(svc);
 
@@ -209,3 +269,7 @@ TEST_F(RsaDfiTests, ImportService) {
 TEST_F(RsaDfiTests, TestBundles) {
     testBundles();
 }
+
+TEST_F(RsaDfiTests, KeepAliveConnectionIsReused) {
+    testKeepAlive();
+}
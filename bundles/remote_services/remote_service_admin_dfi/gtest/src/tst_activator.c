@@ -299,6 +299,123 @@ static bool testCreateRemoteServiceInRemoteCall(void *handle) {
     return rc == 0;
 }
 
+#define CONCURRENT_NR_OF_THREADS 4
+#define CONCURRENT_NR_OF_CALLS 3
+#define CONCURRENT_SLEEP_TIME_IN_MS 100
+
+static void* bndConcurrentCallThread(void *data) {
+    remote_example_t *remoteExample = data;
+    intptr_t nrOfFailures = 0;
+    for (int i = 0; i < CONCURRENT_NR_OF_CALLS; ++i) {
+        int rc = remoteExample->sleepFor(remoteExample->handle, CONCURRENT_SLEEP_TIME_IN_MS);
+        if (rc != 0) {
+            nrOfFailures += 1;
+        }
+    }
+    return (void*)nrOfFailures;
+}
+
+static bool bndTestConcurrentRemoteCalls(void *handle) {
+    struct activator *act = handle;
+
+    pthread_mutex_lock(&act->mutex);
+    remote_example_t *remoteExample = act->remoteExample;
+    pthread_mutex_unlock(&act->mutex);
+    if (remoteExample == NULL) {
+        fprintf(stderr, "remote example service not available");
+        return false;
+    }
+
+    //note the remote example tracker is active for the duration of the test, so the (proxy) service stays valid
+    int32_t maxConcurrentSleeps = 0;
+    remoteExample->getMaxConcurrentSleeps(remoteExample->handle, &maxConcurrentSleeps); //reset
+    intptr_t nrOfFailures = 0;
+    TIMED_EXPR(
+        pthread_t threads[CONCURRENT_NR_OF_THREADS];
+        for (int i = 0; i < CONCURRENT_NR_OF_THREADS; ++i) {
+            pthread_create(&threads[i], NULL, bndConcurrentCallThread, remoteExample);
+        }
+        for (int i = 0; i < CONCURRENT_NR_OF_THREADS; ++i) {
+            void *result = NULL;
+            pthread_join(threads[i], &result);
+            nrOfFailures += (intptr_t)result;
+        }
+    );
+
+    int rc = remoteExample->getMaxConcurrentSleeps(remoteExample->handle, &maxConcurrentSleeps);
+    printf("%i threads doing %i remote calls of %i ms took %f ms, max %i calls were handled concurrently\n",
+           CONCURRENT_NR_OF_THREADS, CONCURRENT_NR_OF_CALLS, CONCURRENT_SLEEP_TIME_IN_MS, diff, maxConcurrentSleeps);
+
+    //calls should be handled in parallel by the remote service
+    return nrOfFailures == 0 && rc == 0 && maxConcurrentSleeps > 1;
+}
+
+#define ASYNC_NR_OF_CALLS 8
+#define ASYNC_SLEEP_TIME_IN_MS 100
+
+struct async_calls_state {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int nrOfDone;
+    int nrOfFailures;
+};
+
+static void bndAsyncCallDone(void *callbackData, int status) {
+    struct async_calls_state *state = callbackData;
+    pthread_mutex_lock(&state->mutex);
+    state->nrOfDone += 1;
+    if (status != 0) {
+        state->nrOfFailures += 1;
+    }
+    pthread_cond_broadcast(&state->cond);
+    pthread_mutex_unlock(&state->mutex);
+}
+
+static bool bndTestAsyncRemoteCalls(void *handle) {
+    struct activator *act = handle;
+
+    pthread_mutex_lock(&act->mutex);
+    remote_example_t *remoteExample = act->remoteExample;
+    pthread_mutex_unlock(&act->mutex);
+    if (remoteExample == NULL) {
+        fprintf(stderr, "remote example service not available");
+        return false;
+    }
+
+    struct async_calls_state state;
+    memset(&state, 0, sizeof(state));
+    pthread_mutex_init(&state.mutex, NULL);
+    pthread_cond_init(&state.cond, NULL);
+
+    int32_t maxConcurrentSleeps = 0;
+    remoteExample->getMaxConcurrentSleeps(remoteExample->handle, &maxConcurrentSleeps); //reset
+
+    //note all calls are done from this thread, the proxy returns directly and the callbacks are called from the rsa send threads
+    int nrOfCalls = 0;
+    TIMED_EXPR(
+        for (int i = 0; i < ASYNC_NR_OF_CALLS; ++i) {
+            int rc = remoteExample->sleepForAsync(remoteExample->handle, ASYNC_SLEEP_TIME_IN_MS, bndAsyncCallDone, &state);
+            if (rc == 0) {
+                nrOfCalls += 1;
+            }
+        }
+        pthread_mutex_lock(&state.mutex);
+        while (state.nrOfDone < nrOfCalls) {
+            pthread_cond_wait(&state.cond, &state.mutex);
+        }
+        pthread_mutex_unlock(&state.mutex);
+    );
+
+    int rc = remoteExample->getMaxConcurrentSleeps(remoteExample->handle, &maxConcurrentSleeps);
+    printf("%i async remote calls of %i ms took %f ms, max %i calls were handled concurrently\n",
+           ASYNC_NR_OF_CALLS, ASYNC_SLEEP_TIME_IN_MS, diff, maxConcurrentSleeps);
+
+    pthread_mutex_destroy(&state.mutex);
+    pthread_cond_destroy(&state.cond);
+
+    return nrOfCalls == ASYNC_NR_OF_CALLS && state.nrOfFailures == 0 && rc == 0 && maxConcurrentSleeps > 1;
+}
+
 static celix_status_t bndStart(struct activator *act, celix_bundle_context_t* ctx) {
     //initialize service struct
     act->ctx = ctx;
@@ -314,6 +431,8 @@ static celix_status_t bndStart(struct activator *act, celix_bundle_context_t* ct
     act->testSvc.testRemoteComplex = bndTestRemoteComplex;
     act->testSvc.testCreateRemoteServiceInRemoteCall = testCreateRemoteServiceInRemoteCall;
     act->testSvc.testCreateDestroyComponentWithRemoteService = bndTestCreateDestroyComponentWithRemoteService;
+    act->testSvc.testConcurrentRemoteCalls = bndTestConcurrentRemoteCalls;
+    act->testSvc.testAsyncRemoteCalls = bndTestAsyncRemoteCalls;
 
     act->testSvc.testCreateRemoteServiceInRemoteCall = testCreateRemoteServiceInRemoteCall;
 
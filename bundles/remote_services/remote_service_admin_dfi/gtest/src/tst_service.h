@@ -35,6 +35,8 @@ struct tst_service {
     bool (*testRemoteComplex)(void *handle);
     bool (*testCreateDestroyComponentWithRemoteService)(void *handle);
     bool (*testCreateRemoteServiceInRemoteCall)(void *handle);
+    bool (*testConcurrentRemoteCalls)(void *handle);
+    bool (*testAsyncRemoteCalls)(void *handle);
 };
 
 typedef struct tst_service tst_service_t;
@@ -21,9 +21,11 @@
 #include <dyn_interface.h>
 #include <remote_constants.h>
 #include <remote_service_admin.h>
+#include <remote_proxy.h>
 #include <service_tracker_customizer.h>
 #include <service_tracker.h>
 #include <json_rpc.h>
+#include <avrobin_rpc.h>
 #include "celix_constants.h"
 #include "export_registration_dfi.h"
 #include "dfi_utils.h"
@@ -48,6 +50,7 @@ struct export_registration {
     void *service; //protected by mutex
     long trackerId; //protected by mutex
     int useCount; //protected by mutex
+    int serviceUseCount; //protected by mutex. Nr of calls using the service outside the mutex.
 
     //TODO add tracker and lock
     bool closed;
@@ -121,6 +124,21 @@ celix_status_t exportRegistration_create(celix_log_helper_t *helper, service_ref
         }
     }
 
+    if (status == CELIX_SUCCESS) {
+        //the completion of asynchronous methods is waited for at most the remote call timeout (in seconds)
+        const char *timeout = celix_properties_get(endpoint->properties, OSGI_RSA_REMOTE_PROXY_TIMEOUT, NULL);
+        if (timeout == NULL) {
+            timeout = celix_bundleContext_getProperty(context, OSGI_RSA_REMOTE_PROXY_TIMEOUT, NULL);
+        }
+        int timeoutInMs = timeout != NULL ? atoi(timeout) * 1000 : 0;
+        struct methods_head *methods = NULL;
+        dynInterface_methods(reg->intf, &methods);
+        struct method_entry *entry = NULL;
+        TAILQ_FOREACH(entry, methods, entries) {
+            dynFunction_setAsyncTimeout(entry->dynFunc, timeoutInMs);
+        }
+    }
+
     if (status == CELIX_SUCCESS) {
         *out = reg;
     } else {
@@ -153,6 +171,45 @@ void exportRegistration_waitTillNotUsed(export_registration_t *export) {
     celixThreadMutex_unlock(&export->mutex);
 }
 
+/**
+ * Marks the service as in use. The call to the service is done without holding the mutex,
+ * the serviceUseCount ensures the service is not removed while in use.
+ */
+static void* exportRegistration_acquireService(export_registration_t *export, celix_status_t *status) {
+    void *service = NULL;
+    celixThreadMutex_lock(&export->mutex);
+    if (export->active && export->service != NULL) {
+        service = export->service;
+        export->serviceUseCount += 1;
+    } else if (!export->active) {
+        *status = CELIX_ILLEGAL_STATE;
+        celix_logHelper_warning(export->helper, "Cannot call an inactive service export");
+    } else {
+        *status = CELIX_ILLEGAL_STATE;
+        celix_logHelper_error(export->helper, "export service pointer is NULL");
+    }
+    celixThreadMutex_unlock(&export->mutex);
+    return service;
+}
+
+static void exportRegistration_releaseService(export_registration_t *export) {
+    celixThreadMutex_lock(&export->mutex);
+    export->serviceUseCount -= 1;
+    celixThreadCondition_broadcast(&export->cond);
+    celixThreadMutex_unlock(&export->mutex);
+}
+
+static void exportRegistration_logCall(export_registration_t *export, const char *payload, celix_status_t status) {
+    if (export->logFile != NULL) {
+        static int callCount = 0;
+        int callNr = __atomic_fetch_add(&callCount, 1, __ATOMIC_RELAXED);
+        char *name = NULL;
+        dynInterface_getName(export->intf, &name);
+        fprintf(export->logFile, "REMOTE CALL %i\n\tservice=%s\n\tservice_id=%s\n\trequest_payload=%s\n\tstatus=%i\n", callNr, name, export->servId, payload, status);
+        fflush(export->logFile);
+    }
+}
+
 celix_status_t exportRegistration_call(export_registration_t *export, char *data, int datalength, celix_properties_t *metadata, char **responseOut, int *responseLength) {
     int status = CELIX_SUCCESS;
 
@@ -164,30 +221,17 @@ celix_status_t exportRegistration_call(export_registration_t *export, char *data
         if (json_unpack(js_request, "{s:s}", "m", &sig) == 0) {
             bool cont = remoteInterceptorHandler_invokePreExportCall(export->interceptorsHandler, export->exportReference.endpoint->properties, sig, &metadata);
             if (cont) {
-                celixThreadMutex_lock(&export->mutex);
-                if (export->active && export->service != NULL) {
-                    status = jsonRpc_call(export->intf, export->service, data, responseOut);
-                } else if (!export->active) {
-                    status = CELIX_ILLEGAL_STATE;
-                    celix_logHelper_warning(export->helper, "Cannot call an inactive service export");
-                } else {
-                    status = CELIX_ILLEGAL_STATE;
-                    celix_logHelper_error(export->helper, "export service pointer is NULL");
+                void *service = exportRegistration_acquireService(export, &status);
+                if (service != NULL) {
+                    status = jsonRpc_call(export->intf, service, data, responseOut);
+                    exportRegistration_releaseService(export);
                 }
-                celixThreadMutex_unlock(&export->mutex);
 
                 remoteInterceptorHandler_invokePostExportCall(export->interceptorsHandler, export->exportReference.endpoint->properties, sig, metadata);
             }
 
             //printf("calling for '%s'\n");
-            if (export->logFile != NULL) {
-                static int callCount = 0;
-                char *name = NULL;
-                dynInterface_getName(export->intf, &name);
-                fprintf(export->logFile, "REMOTE CALL %i\n\tservice=%s\n\tservice_id=%s\n\trequest_payload=%s\n\tstatus=%i\n", callCount, name, export->servId, data, status);
-                fflush(export->logFile);
-                callCount += 1;
-            }
+            exportRegistration_logCall(export, data, status);
         }
     } else {
         status = CELIX_ILLEGAL_ARGUMENT;
@@ -198,6 +242,51 @@ celix_status_t exportRegistration_call(export_registration_t *export, char *data
     return status;
 }
 
+celix_status_t exportRegistration_callBinary(export_registration_t *export, const uint8_t *data, size_t dataLength, celix_properties_t *metadata, uint8_t **responseOut, size_t *responseLength) {
+    celix_status_t status = CELIX_SUCCESS;
+
+    //note only the fixed size header is read to find the method signature needed for the interceptors
+    uint32_t methodId = 0;
+    if (dataLength >= sizeof(methodId)) {
+        methodId = ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+    } else {
+        status = CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    const char *sig = NULL;
+    if (status == CELIX_SUCCESS) {
+        struct methods_head *methods = NULL;
+        dynInterface_methods(export->intf, &methods);
+        struct method_entry *entry = NULL;
+        TAILQ_FOREACH(entry, methods, entries) {
+            if (avrobinRpc_methodId(entry->id) == methodId) {
+                sig = entry->id;
+                break;
+            }
+        }
+        if (sig == NULL) {
+            status = CELIX_ILLEGAL_ARGUMENT;
+            celix_logHelper_error(export->helper, "Cannot find method with id %u", methodId);
+        }
+    }
+
+    if (status == CELIX_SUCCESS) {
+        bool cont = remoteInterceptorHandler_invokePreExportCall(export->interceptorsHandler, export->exportReference.endpoint->properties, sig, &metadata);
+        if (cont) {
+            void *service = exportRegistration_acquireService(export, &status);
+            if (service != NULL) {
+                status = avrobinRpc_call(export->intf, service, data, dataLength, responseOut, responseLength);
+                exportRegistration_releaseService(export);
+            }
+
+            remoteInterceptorHandler_invokePostExportCall(export->interceptorsHandler, export->exportReference.endpoint->properties, sig, metadata);
+        }
+        exportRegistration_logCall(export, "<avrobin>", status);
+    }
+
+    return status;
+}
+
 static celix_status_t exportRegistration_findAndParseInterfaceDescriptor(celix_log_helper_t *helper, celix_bundle_context_t * const context, celix_bundle_t * const bundle, char const * const name, dyn_interface_type **out) {
     FILE* descriptor = NULL;
 
@@ -315,6 +404,10 @@ static void exportRegistration_removeServ(void *data, void *service) {
     celixThreadMutex_lock(&reg->mutex);
     if (reg->service == service) {
         reg->service = NULL;
+        //wait till calls in progress are done with the service, new calls will not see the service anymore
+        while (reg->serviceUseCount > 0) {
+            celixThreadCondition_wait(&reg->cond, &reg->mutex);
+        }
     }
     celixThreadMutex_unlock(&reg->mutex);
 }
@@ -20,6 +20,8 @@
 #ifndef CELIX_EXPORT_REGISTRATION_DFI_H
 #define CELIX_EXPORT_REGISTRATION_DFI_H
 
+#include <stdint.h>
+#include <stddef.h>
 
 #include "export_registration.h"
 #include "celix_log_helper.h"
@@ -34,6 +36,11 @@ void exportRegistration_setActive(export_registration_t *registration, bool acti
 
 celix_status_t exportRegistration_call(export_registration_t *export, char *data, int datalength, celix_properties_t *metadata, char **response, int *responseLength);
 
+/**
+ * Calls the exported service using a binary (avrobin rpc) request. See avrobin_rpc.h for the request and reply layout.
+ */
+celix_status_t exportRegistration_callBinary(export_registration_t *export, const uint8_t *data, size_t dataLength, celix_properties_t *metadata, uint8_t **response, size_t *responseLength);
+
 void exportRegistration_increaseUsage(export_registration_t *export);
 void exportRegistration_decreaseUsage(export_registration_t *export);
 void exportRegistration_waitTillNotUsed(export_registration_t *export);
@@ -18,8 +18,10 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <jansson.h>
 #include <json_rpc.h>
+#include <avrobin_rpc.h>
 #include <assert.h>
 #include "version.h"
 #include "json_serializer.h"
@@ -36,9 +38,13 @@ struct import_registration {
     const char *classObject; //NOTE owned by endpoint
     version_pt version;
 
-    celix_thread_mutex_t mutex; //protects send & sendhandle
+    celix_thread_mutex_t mutex; //protects send, sendhandle, sendAsync, sendAsyncHandle & nrOfActiveCalls
+    celix_thread_cond_t cond;
     send_func_type send;
     void *sendHandle;
+    send_async_func_type sendAsync;
+    void *sendAsyncHandle;
+    int nrOfActiveCalls; //note the send is done outside the mutex, so that calls through one proxy can run concurrently
 
     service_factory_pt factory;
     service_registration_t *factoryReg;
@@ -48,6 +54,8 @@ struct import_registration {
 
     remote_interceptors_handler_t *interceptorsHandler;
 
+    bool useBinary; //whether the binary (avrobin) rpc encoding is used for calls
+
     FILE *logFile;
 };
 
@@ -57,6 +65,30 @@ struct service_proxy {
     size_t count;
 };
 
+/**
+ * A prepared invoke request, either json rpc (a string) or binary avrobin rpc.
+ */
+struct import_request {
+    char *data;
+    size_t length;
+    bool binary;
+};
+
+/**
+ * State of an asynchronous call, which outlives the proxy function call.
+ * The output (and handle) argument values are copied, because the original args only live during the proxy call.
+ */
+struct import_async_call {
+    import_registration_t *import;
+    struct method_entry *entry;
+    struct import_request request;
+    celix_properties_t *metadata;
+    dyn_function_callback_fp callback;
+    void *callbackData;
+    void **args;
+    void **argValues;
+};
+
 static celix_status_t importRegistration_findAndParseInterfaceDescriptor(celix_bundle_context_t * const context, celix_bundle_t * const bundle, char const * const name, dyn_interface_type **out);
 
 static celix_status_t importRegistration_createProxy(import_registration_t *import, celix_bundle_t *bundle,
@@ -64,8 +96,13 @@ static celix_status_t importRegistration_createProxy(import_registration_t *impo
 static void importRegistration_proxyFunc(void *userData, void *args[], void *returnVal);
 static void importRegistration_destroyProxy(struct service_proxy *proxy);
 static void importRegistration_clearProxies(import_registration_t *import);
-static const char* importRegistration_getUrl(import_registration_t *reg);
 static const char* importRegistration_getServiceName(import_registration_t *reg);
+static celix_status_t importRegistration_prepareRequest(import_registration_t *import, struct method_entry *entry, void *args[], struct import_request *request);
+static int importRegistration_handleReply(import_registration_t *import, struct method_entry *entry, void *args[], const struct import_request *request, celix_properties_t *metadata, char *reply, size_t replyLength, int rc);
+static int importRegistration_sendAsync(import_registration_t *import, struct method_entry *entry, void *args[], struct import_request *request, send_async_func_type sendAsync, void *sendAsyncHandle);
+static void importRegistration_asyncCallDone(void *doneData, char *reply, size_t replyLength, int replyStatus);
+static void importRegistration_callFinished(import_registration_t *import);
+static void importRegistration_getCallback(struct method_entry *entry, void *args[], dyn_function_callback_fp *callback, void **callbackData);
 
 celix_status_t importRegistration_create(celix_bundle_context_t *context, endpoint_description_t *endpoint, const char *classObject, const char* serviceVersion, FILE *logFile, import_registration_t **out) {
     celix_status_t status = CELIX_SUCCESS;
@@ -84,6 +121,7 @@ celix_status_t importRegistration_create(celix_bundle_context_t *context, endpoi
         remoteInterceptorsHandler_create(context, &reg->interceptorsHandler);
 
         celixThreadMutex_create(&reg->mutex, NULL);
+        celixThreadCondition_init(&reg->cond, NULL);
         celixThreadMutex_create(&reg->proxiesMutex, NULL);
         status = version_createVersionFromString((char*)serviceVersion,&(reg->version));
 
@@ -91,6 +129,10 @@ celix_status_t importRegistration_create(celix_bundle_context_t *context, endpoi
         reg->factory->getService = (void *)importRegistration_getService;
         reg->factory->ungetService = (void *)importRegistration_ungetService;
         reg->logFile = logFile;
+
+        const char *encodings = celix_properties_get(endpoint->properties, RSA_DFI_ENDPOINT_ENCODINGS, "");
+        reg->useBinary = celix_bundleContext_getPropertyAsBool(context, RSA_DFI_BINARY_RPC_KEY, RSA_DFI_BINARY_RPC_DEFAULT) &&
+                strstr(encodings, RSA_DFI_ENCODING_AVROBIN) != NULL;
     } else {
         status = CELIX_ENOMEM;
     }
@@ -118,6 +160,25 @@ celix_status_t importRegistration_setSendFn(import_registration_t *reg,
     return CELIX_SUCCESS;
 }
 
+celix_status_t importRegistration_setSendAsyncFn(import_registration_t *reg,
+                                                 send_async_func_type sendAsync,
+                                                 void *handle) {
+    celixThreadMutex_lock(&reg->mutex);
+    reg->sendAsync = sendAsync;
+    reg->sendAsyncHandle = handle;
+    celixThreadMutex_unlock(&reg->mutex);
+
+    return CELIX_SUCCESS;
+}
+
+static void importRegistration_waitTillNoActiveCalls(import_registration_t *import) {
+    celixThreadMutex_lock(&import->mutex);
+    while (import->nrOfActiveCalls > 0) {
+        celixThreadCondition_wait(&import->cond, &import->mutex);
+    }
+    celixThreadMutex_unlock(&import->mutex);
+}
+
 static void importRegistration_clearProxies(import_registration_t *import) {
     if (import != NULL) {
         pthread_mutex_lock(&import->proxiesMutex);
@@ -144,6 +205,7 @@ void importRegistration_destroy(import_registration_t *import) {
         remoteInterceptorsHandler_destroy(import->interceptorsHandler);
 
         pthread_mutex_destroy(&import->mutex);
+        celixThreadCondition_destroy(&import->cond);
         pthread_mutex_destroy(&import->proxiesMutex);
 
         if (import->factory != NULL) {
@@ -176,6 +238,8 @@ celix_status_t importRegistration_stop(import_registration_t *import) {
         import->factoryReg = NULL;
     }
 
+    //proxies (and the send handle) must outlive calls still in progress
+    importRegistration_waitTillNoActiveCalls(import);
     importRegistration_clearProxies(import);
 
     return status;
@@ -324,58 +388,202 @@ static void importRegistration_proxyFunc(void *userData, void *args[], void *ret
     struct method_entry *entry = userData;
     import_registration_t *import = *((void **)args[0]);
 
-    if (import == NULL || import->send == NULL) {
+    send_func_type send = NULL;
+    void *sendHandle = NULL;
+    send_async_func_type sendAsync = NULL;
+    void *sendAsyncHandle = NULL;
+    if (import != NULL) {
+        celixThreadMutex_lock(&import->mutex);
+        send = import->send;
+        sendHandle = import->sendHandle;
+        sendAsync = import->sendAsync;
+        sendAsyncHandle = import->sendAsyncHandle;
+        import->nrOfActiveCalls += 1;
+        celixThreadMutex_unlock(&import->mutex);
+    }
+
+    if (import == NULL || send == NULL) {
         status = CELIX_ILLEGAL_ARGUMENT;
     }
 
 
-    char *invokeRequest = NULL;
+    struct import_request request = {NULL, 0, false};
     if (status == CELIX_SUCCESS) {
-        status = jsonRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, &invokeRequest);
-        //printf("Need to send following json '%s'\n", invokeRequest);
+        status = importRegistration_prepareRequest(import, entry, args, &request);
     }
 
-
-    if (status == CELIX_SUCCESS) {
+    bool isAsync = status == CELIX_SUCCESS && dynFunction_isAsync(entry->dynFunc);
+    if (isAsync && sendAsync != NULL) {
+        int rc = importRegistration_sendAsync(import, entry, args, &request, sendAsync, sendAsyncHandle);
+        *(int *) returnVal = rc;
+        if (rc == CELIX_SUCCESS) {
+            //note the invoke request and the active call are released when the async call is done
+            return;
+        }
+        free(request.data);
+    } else if (status == CELIX_SUCCESS) {
         char *reply = NULL;
+        size_t replyLength = 0;
         int rc = 0;
         //printf("sending request\n");
         celix_properties_t *metadata = NULL;
         bool cont = remoteInterceptorHandler_invokePreProxyCall(import->interceptorsHandler, import->endpoint->properties, entry->name, &metadata);
         if (cont) {
-            celixThreadMutex_lock(&import->mutex);
-            if (import->send != NULL) {
-                import->send(import->sendHandle, import->endpoint, invokeRequest, metadata, &reply, &rc);
-            }
-            celixThreadMutex_unlock(&import->mutex);
+            const char *contentType = request.binary ? RSA_DFI_CONTENT_TYPE_AVROBIN : RSA_DFI_CONTENT_TYPE_JSON;
+            send(sendHandle, import->endpoint, contentType, request.data, request.length, metadata, &reply, &replyLength, &rc);
             //printf("request sended. got reply '%s' with status %i\n", reply, rc);
-
-            if (rc == 0 && dynFunction_hasReturn(entry->dynFunc)) {
-                //fjprintf("Handling reply '%s'\n", reply);
-                status = jsonRpc_handleReply(entry->dynFunc, reply, args);
+            rc = importRegistration_handleReply(import, entry, args, &request, metadata, reply, replyLength, rc);
+            if (isAsync && rc == 0) {
+                //no async send available, complete the async call before returning
+                dyn_function_callback_fp callback = NULL;
+                void *callbackData = NULL;
+                importRegistration_getCallback(entry, args, &callback, &callbackData);
+                if (callback != NULL) {
+                    callback(callbackData, rc);
+                }
             }
-
             *(int *) returnVal = rc;
+        } else if (metadata != NULL) {
+            celix_properties_destroy(metadata);
+        }
+        free(request.data); //Allocated by jsonRpc_prepareInvokeRequest or avrobinRpc_prepareInvokeRequest
+    }
+
+    if (status != CELIX_SUCCESS) {
+        //TODO log error
+    }
+
+    if (import != NULL) {
+        importRegistration_callFinished(import);
+    }
+}
+
+static void importRegistration_callFinished(import_registration_t *import) {
+    celixThreadMutex_lock(&import->mutex);
+    import->nrOfActiveCalls -= 1;
+    celixThreadCondition_broadcast(&import->cond);
+    celixThreadMutex_unlock(&import->mutex);
+}
 
-            remoteInterceptorHandler_invokePostProxyCall(import->interceptorsHandler, import->endpoint->properties, entry->name, metadata);
+/**
+ * Handles the reply of a remote call, invokes the post proxy call interceptors and frees the reply and metadata.
+ * Returns the status of the remote call.
+ */
+static int importRegistration_handleReply(import_registration_t *import, struct method_entry *entry, void *args[], const struct import_request *request, celix_properties_t *metadata, char *reply, size_t replyLength, int rc) {
+    if (rc == 0 && request->binary) {
+        avrobinRpc_handleReply(entry->dynFunc, (const uint8_t*)reply, replyLength, args);
+    } else if (rc == 0 && dynFunction_hasReturn(entry->dynFunc)) {
+        //fjprintf("Handling reply '%s'\n", reply);
+        jsonRpc_handleReply(entry->dynFunc, reply, args);
+    }
+
+    remoteInterceptorHandler_invokePostProxyCall(import->interceptorsHandler, import->endpoint->properties, entry->name, metadata);
+    if (metadata != NULL) {
+        celix_properties_destroy(metadata);
+    }
+
+    if (import->logFile != NULL) {
+        static int callCount = 0;
+        int callNr = __atomic_fetch_add(&callCount, 1, __ATOMIC_RELAXED);
+        const char *url = importRegistration_getUrl(import);
+        const char *svcName = importRegistration_getServiceName(import);
+        fprintf(import->logFile, "REMOTE CALL NR %i\n\turl=%s\n\tservice=%s\n\tpayload=%s\n\treturn_code=%i\n\treply=%s\n",
+                                   callNr, url, svcName, request->binary ? "<avrobin>" : request->data, rc, request->binary ? "<avrobin>" : reply);
+        fflush(import->logFile);
+    }
+    free(reply); //Allocated in remoteServiceAdmin_send through curl call
+    return rc;
+}
+
+static celix_status_t importRegistration_prepareRequest(import_registration_t *import, struct method_entry *entry, void *args[], struct import_request *request) {
+    if (import->useBinary) {
+        uint8_t *data = NULL;
+        size_t length = 0;
+        if (avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, &data, &length) == 0) {
+            request->data = (char*)data;
+            request->length = length;
+            request->binary = true;
+            return CELIX_SUCCESS;
         }
+        //note not all types are supported by avrobin (e.g. untyped pointers), fall back to json rpc
+    }
+    celix_status_t status = jsonRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, &request->data);
+    if (status == CELIX_SUCCESS) {
+        request->length = strlen(request->data);
+        request->binary = false;
+    }
+    return status;
+}
 
-        if (import->logFile != NULL) {
-            static int callCount = 0;
-            const char *url = importRegistration_getUrl(import);
-            const char *svcName = importRegistration_getServiceName(import);
-            fprintf(import->logFile, "REMOTE CALL NR %i\n\turl=%s\n\tservice=%s\n\tpayload=%s\n\treturn_code=%i\n\treply=%s\n",
-                                       callCount, url, svcName, invokeRequest, rc, reply);
-            fflush(import->logFile);
-            callCount += 1;
+static void importRegistration_getCallback(struct method_entry *entry, void *args[], dyn_function_callback_fp *callback, void **callbackData) {
+    int nrOfArgs = dynFunction_nrOfArguments(entry->dynFunc);
+    for (int i = 0; i < nrOfArgs; ++i) {
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(entry->dynFunc, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__CALLBACK) {
+            *callback = *(dyn_function_callback_fp *) args[i];
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__CALLBACK_DATA) {
+            *callbackData = *(void **) args[i];
         }
-        free(invokeRequest); //Allocated by json_dumps in jsonRpc_prepareInvokeRequest
-        free(reply); //Allocated by json_dumps in remoteServiceAdmin_send through curl call
     }
+}
 
-    if (status != CELIX_SUCCESS) {
-        //TODO log error
+static int importRegistration_sendAsync(import_registration_t *import, struct method_entry *entry, void *args[], struct import_request *request, send_async_func_type sendAsync, void *sendAsyncHandle) {
+    int nrOfArgs = dynFunction_nrOfArguments(entry->dynFunc);
+    struct import_async_call *call = calloc(1, sizeof(*call));
+    void **argsMem = calloc(2 * (size_t)nrOfArgs, sizeof(void *));
+    if (call == NULL || argsMem == NULL) {
+        free(call);
+        free(argsMem);
+        return CELIX_ENOMEM;
+    }
+    call->import = import;
+    call->entry = entry;
+    call->request = *request;
+    call->args = argsMem;
+    call->argValues = argsMem + nrOfArgs;
+    importRegistration_getCallback(entry, args, &call->callback, &call->callbackData);
+    for (int i = 0; i < nrOfArgs; ++i) {
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(entry->dynFunc, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__HANDLE ||
+            meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT ||
+            meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+            call->argValues[i] = *(void **) args[i];
+            call->args[i] = &call->argValues[i];
+        } //note input arguments are already serialized in the invoke request
+    }
+
+    int rc = CELIX_SUCCESS;
+    bool cont = remoteInterceptorHandler_invokePreProxyCall(import->interceptorsHandler, import->endpoint->properties, entry->name, &call->metadata);
+    if (cont) {
+        const char *contentType = request->binary ? RSA_DFI_CONTENT_TYPE_AVROBIN : RSA_DFI_CONTENT_TYPE_JSON;
+        rc = sendAsync(sendAsyncHandle, import->endpoint, contentType, request->data, request->length, call->metadata, call, importRegistration_asyncCallDone);
+    } else {
+        rc = CELIX_SERVICE_EXCEPTION;
     }
+
+    if (rc != CELIX_SUCCESS) {
+        if (call->metadata != NULL) {
+            celix_properties_destroy(call->metadata);
+        }
+        free(call->args);
+        free(call);
+    }
+    return rc;
+}
+
+static void importRegistration_asyncCallDone(void *doneData, char *reply, size_t replyLength, int replyStatus) {
+    struct import_async_call *call = doneData;
+    import_registration_t *import = call->import;
+
+    int rc = importRegistration_handleReply(import, call->entry, call->args, &call->request, call->metadata, reply, replyLength, replyStatus);
+    if (call->callback != NULL) {
+        call->callback(call->callbackData, rc);
+    }
+
+    free(call->request.data);
+    free(call->args);
+    free(call);
+    importRegistration_callFinished(import);
 }
 
 celix_status_t importRegistration_ungetService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **out) {
@@ -446,7 +654,7 @@ celix_status_t importReference_getImportedService(import_reference_t *reference)
     return status;
 }
 
-static const char* importRegistration_getUrl(import_registration_t *reg) {
+const char* importRegistration_getUrl(import_registration_t *reg) {
     return celix_properties_get(reg->endpoint->properties, RSA_DFI_ENDPOINT_URL, "!Error!");
 }
 
@@ -25,7 +25,18 @@
 
 #include <celix_errno.h>
 
-typedef void (*send_func_type)(void *handle, endpoint_description_t *endpointDescription, char *request, celix_properties_t *metadata, char **reply, int* replyStatus);
+typedef void (*send_func_type)(void *handle, endpoint_description_t *endpointDescription, const char *contentType, const char *request, size_t requestLength, celix_properties_t *metadata, char **reply, size_t *replyLength, int* replyStatus);
+
+/**
+ * Called when an asynchronous send is completed. The reply is owned by the callee.
+ */
+typedef void (*send_done_func_type)(void *doneData, char *reply, size_t replyLength, int replyStatus);
+
+/**
+ * Queues a send. If CELIX_SUCCESS is returned, the done function will be called exactly once (from another thread).
+ * The request and metadata must stay valid until the done function is called.
+ */
+typedef celix_status_t (*send_async_func_type)(void *handle, endpoint_description_t *endpointDescription, const char *contentType, const char *request, size_t requestLength, celix_properties_t *metadata, void *doneData, send_done_func_type done);
 
 celix_status_t importRegistration_create(celix_bundle_context_t *context, endpoint_description_t *description, const char *classObject, const char* serviceVersion, FILE *logFile,
                                          import_registration_t **import);
@@ -35,9 +46,21 @@ void importRegistration_destroy(import_registration_t *import);
 celix_status_t importRegistration_setSendFn(import_registration_t *reg,
                                             send_func_type,
                                             void *handle);
+/**
+ * Sets the function used for asynchronous interface methods (methods with a am=callback argument).
+ * If not set, asynchronous methods are sent synchronously and the callback is called before the proxy call returns.
+ */
+celix_status_t importRegistration_setSendAsyncFn(import_registration_t *reg,
+                                                 send_async_func_type sendAsync,
+                                                 void *handle);
 celix_status_t importRegistration_start(import_registration_t *import);
 celix_status_t importRegistration_stop(import_registration_t *import);
 
+/**
+ * Returns the endpoint url (RSA_DFI_ENDPOINT_URL) of the imported service.
+ */
+const char* importRegistration_getUrl(import_registration_t *reg);
+
 celix_status_t importRegistration_getService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **service);
 celix_status_t importRegistration_ungetService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **service);
 
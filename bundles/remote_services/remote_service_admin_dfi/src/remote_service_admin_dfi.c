@@ -25,17 +25,20 @@
 #include <netdb.h>
 #include <ifaddrs.h>
 #include <string.h>
+#include <pthread.h>
 #include <uuid/uuid.h>
 #include <curl/curl.h>
 
 #include <jansson.h>
 #include "json_serializer.h"
+#include "avrobin_serializer.h"
 #include "utils.h"
 
 #include "import_registration_dfi.h"
 #include "export_registration_dfi.h"
 #include "remote_service_admin_dfi.h"
 #include "json_rpc.h"
+#include "avrobin_rpc.h"
 
 #include "remote_constants.h"
 #include "celix_constants.h"
@@ -73,6 +76,7 @@ struct remote_service_admin {
 
     celix_thread_rwlock_t exportedServicesLock;
     hash_map_pt exportedServices;
+    hash_map_pt exportsBySvcId; //key = service id, value = export_registration_t*. Protected by exportedServicesLock
 
     //NOTE stopExportsMutex, stopExports, stopExportsActive, stopExportsCond and stopExportsThread are only used if CELIX_RSA_USE_STOP_EXPORT_THREAD is set to true
     celix_thread_mutex_t stopExportsMutex;
@@ -91,11 +95,46 @@ struct remote_service_admin {
 
     FILE *logFile;
     void *curlShare;
-    pthread_mutex_t curlMutexConnect;
     pthread_mutex_t curlMutexCookie;
     pthread_mutex_t curlMutexDns;
+
+    //NOTE the curl easy handles are pooled per endpoint url, so that a handle (and its open keep-alive connection)
+    //can be reused for the next call to the same endpoint.
+    celix_thread_mutex_t curlPoolsLock; //protects curlPools
+    hash_map_pt curlPools; //key = endpoint url (owned), value = celix_array_list_t* of idle CURL* handles
+    long curlPoolSize; //max idle handles per endpoint
+
+    bool binaryRpc; //whether exported endpoints advertise (and imports use) the binary avrobin encoding
+
+    pthread_key_t requestBufferKey; //value = rsa_dfi_request_buffer_t* of the current webserver thread
+
+    //NOTE asynchronous remote calls are queued and sent by a small pool of send threads.
+    celix_thread_mutex_t asyncSendMutex; //protects asyncSends and asyncSendActive
+    celix_thread_cond_t asyncSendCond;
+    celix_array_list_t *asyncSends; //entries rsa_dfi_async_send_t*
+    bool asyncSendActive;
+    int nrOfAsyncSendThreads;
+    celix_thread_t *asyncSendThreads;
 };
 
+/**
+ * Per webserver thread buffer used to read request bodies, so that a request does not need a fresh allocation.
+ */
+typedef struct rsa_dfi_request_buffer {
+    char *data;
+    size_t capacity;
+} rsa_dfi_request_buffer_t;
+
+typedef struct rsa_dfi_async_send {
+    endpoint_description_t *endpointDescription;
+    const char *contentType;
+    const char *request;
+    size_t requestLength;
+    celix_properties_t *metadata;
+    void *doneData;
+    send_done_func_type done;
+} rsa_dfi_async_send_t;
+
 struct post {
     const char *readptr;
     size_t size;
@@ -110,26 +149,43 @@ struct get {
 #define OSGI_RSA_REMOTE_PROXY_FACTORY   "remote_proxy_factory"
 #define OSGI_RSA_REMOTE_PROXY_TIMEOUT   "remote_proxy_timeout"
 
+//note Content-Length is always provided, so that the (pooled) client connections can be kept alive
 static const char *data_response_headers =
         "HTTP/1.1 200 OK\r\n"
                 "Cache: no-cache\r\n"
-                "Content-Type: application/json\r\n"
+                "Content-Type: %s\r\n"
+                "Content-Length: %zu\r\n"
                 "\r\n";
 
 static const char *no_content_response_headers =
-        "HTTP/1.1 204 OK\r\n";
+        "HTTP/1.1 204 OK\r\n"
+                "Content-Length: 0\r\n"
+                "\r\n";
 
 static const unsigned int DEFAULT_TIMEOUT = 0;
 
+//request buffers which grew larger than this are released after the request
+static const size_t MAX_RETAINED_REQUEST_BUFFER_SIZE = 64 * 1024;
+
 static int remoteServiceAdmin_callback(struct mg_connection *conn);
 static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_service_admin_t *admin, service_reference_pt reference, celix_properties_t *props, char *interface, endpoint_description_t **description);
-static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_t *endpointDescription, char *request, celix_properties_t *metadata, char **reply, int* replyStatus);
+static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_t *endpointDescription, const char *contentType, const char *request, size_t requestLength, celix_properties_t *metadata, char **reply, size_t *replyLength, int* replyStatus);
 static celix_status_t remoteServiceAdmin_getIpAddress(char* interface, char** ip);
 static size_t remoteServiceAdmin_readCallback(void *ptr, size_t size, size_t nmemb, void *userp);
+static CURL* remoteServiceAdmin_acquireCurl(remote_service_admin_t *admin, const char *url);
+static void remoteServiceAdmin_releaseCurl(remote_service_admin_t *admin, const char *url, CURL *curl, bool reusable);
+static void remoteServiceAdmin_removeCurlPool(remote_service_admin_t *admin, const char *url);
 static size_t remoteServiceAdmin_write(void *contents, size_t size, size_t nmemb, void *userp);
+static unsigned long remoteServiceAdmin_getExportedServiceId(export_registration_t *export);
+static rsa_dfi_request_buffer_t* remoteServiceAdmin_getRequestBuffer(remote_service_admin_t *admin, size_t size);
+static void remoteServiceAdmin_releaseRequestBuffer(rsa_dfi_request_buffer_t *buffer);
+static void remoteServiceAdmin_destroyRequestBuffer(void *buffer);
 static void remoteServiceAdmin_log(remote_service_admin_t *admin, int level, const char *file, int line, const char *msg, ...);
 static void remoteServiceAdmin_setupStopExportsThread(remote_service_admin_t* admin);
 static void remoteServiceAdmin_teardownStopExportsThread(remote_service_admin_t* admin);
+static void remoteServiceAdmin_setupAsyncSendThreads(remote_service_admin_t* admin);
+static void remoteServiceAdmin_teardownAsyncSendThreads(remote_service_admin_t* admin);
+static celix_status_t remoteServiceAdmin_sendAsync(void *handle, endpoint_description_t *endpointDescription, const char *contentType, const char *request, size_t requestLength, celix_properties_t *metadata, void *doneData, send_done_func_type done);
 
 static void remoteServiceAdmin_curlshare_lock(CURL *handle, curl_lock_data data, curl_lock_access laccess, void *userptr)
 {
@@ -138,9 +194,6 @@ static void remoteServiceAdmin_curlshare_lock(CURL *handle, curl_lock_data data,
     (void)laccess;
     remote_service_admin_t *rsa = userptr;
     switch(data) {
-        case CURL_LOCK_DATA_CONNECT:
-            pthread_mutex_lock(&rsa->curlMutexConnect);
-            break;
         case CURL_LOCK_DATA_COOKIE:
             pthread_mutex_lock(&rsa->curlMutexCookie);
             break;
@@ -158,9 +211,6 @@ static void remoteServiceAdmin_curlshare_unlock(CURL *handle, curl_lock_data dat
     (void)data;
     remote_service_admin_t *rsa = userptr;
     switch(data) {
-        case CURL_LOCK_DATA_CONNECT:
-            pthread_mutex_unlock(&rsa->curlMutexConnect);
-            break;
         case CURL_LOCK_DATA_COOKIE:
             pthread_mutex_unlock(&rsa->curlMutexCookie);
             break;
@@ -182,6 +232,7 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
     } else {
         (*admin)->context = context;
         (*admin)->exportedServices = hashMap_create(NULL, NULL, NULL, NULL);
+        (*admin)->exportsBySvcId = hashMap_create(NULL, NULL, NULL, NULL);
          arrayList_create(&(*admin)->importedServices);
 
          celixThreadRwlock_create(&(*admin)->exportedServicesLock, NULL);
@@ -194,6 +245,8 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
         dynInterface_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
         jsonSerializer_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
         jsonRpc_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
+        avrobinSerializer_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
+        avrobinRpc_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
 
         long port = celix_bundleContext_getPropertyAsLong(context, RSA_PORT_KEY, RSA_PORT_DEFAULT);
         const char *ip = celix_bundleContext_getProperty(context, RSA_IP_KEY, RSA_IP_DEFAULT);
@@ -216,8 +269,8 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
             free(detectedIp);
         }
 
+        //note connections are not shared, every pooled curl handle keeps its own (keep-alive) connection.
         (*admin)->curlShare = curl_share_init();
-        curl_share_setopt((*admin)->curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
         curl_share_setopt((*admin)->curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_COOKIE);
         curl_share_setopt((*admin)->curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
         curl_share_setopt((*admin)->curlShare, CURLSHOPT_USERDATA, *admin);
@@ -225,11 +278,6 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
         curl_share_setopt((*admin)->curlShare, CURLSHOPT_LOCKFUNC, remoteServiceAdmin_curlshare_lock);
         curl_share_setopt((*admin)->curlShare, CURLSHOPT_UNLOCKFUNC, remoteServiceAdmin_curlshare_unlock);
 
-        if(status == CELIX_SUCCESS && pthread_mutex_init(&(*admin)->curlMutexConnect, NULL) != 0) {
-            fprintf(stderr, "Could not initialize mutex connect\n");
-            status = EPERM;
-        }
-
         if(status == CELIX_SUCCESS && pthread_mutex_init(&(*admin)->curlMutexCookie, NULL) != 0) {
             fprintf(stderr, "Could not initialize mutex cookie\n");
             status = EPERM;
@@ -240,20 +288,42 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
             status = EPERM;
         }
 
+        celixThreadMutex_create(&(*admin)->curlPoolsLock, NULL);
+        (*admin)->curlPools = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+        (*admin)->curlPoolSize = celix_bundleContext_getPropertyAsLong(context, RSA_DFI_CURL_POOL_SIZE_KEY, RSA_DFI_CURL_POOL_SIZE_DEFAULT);
+        (*admin)->binaryRpc = celix_bundleContext_getPropertyAsBool(context, RSA_DFI_BINARY_RPC_KEY, RSA_DFI_BINARY_RPC_DEFAULT);
+
         remoteServiceAdmin_setupStopExportsThread(*admin);
+        remoteServiceAdmin_setupAsyncSendThreads(*admin);
 
         // Prepare callbacks structure. We have only one callback, the rest are NULL.
         struct mg_callbacks callbacks;
         memset(&callbacks, 0, sizeof(callbacks));
         callbacks.begin_request = remoteServiceAdmin_callback;
 
+        pthread_key_create(&(*admin)->requestBufferKey, remoteServiceAdmin_destroyRequestBuffer);
+
         char newPort[10];
         snprintf(newPort, 10, "%li", port);
 
+        //note an idle keep-alive connection occupies a webserver thread (until the request timeout), so by default
+        //there is a thread for every pooled connection of an importing framework plus RSA_DFI_NUM_THREADS_DEFAULT threads.
+        char numThreads[16];
+        long defaultNrOfThreads = (*admin)->curlPoolSize + RSA_DFI_NUM_THREADS_DEFAULT;
+        long nrOfThreads = celix_bundleContext_getPropertyAsLong(context, RSA_DFI_NUM_THREADS_KEY, defaultNrOfThreads);
+        if (nrOfThreads <= 0) {
+            nrOfThreads = defaultNrOfThreads;
+        } else if (nrOfThreads <= (*admin)->curlPoolSize) {
+            celix_logHelper_log((*admin)->loghelper, CELIX_LOG_LEVEL_WARNING,
+                                "RSA: %s (%li) is not larger than %s (%li), idle keep-alive connections can occupy all webserver threads",
+                                RSA_DFI_NUM_THREADS_KEY, nrOfThreads, RSA_DFI_CURL_POOL_SIZE_KEY, (*admin)->curlPoolSize);
+        }
+        snprintf(numThreads, sizeof(numThreads), "%li", nrOfThreads);
+
         unsigned int port_counter = 0;
         do {
 
-            const char *options[] = { "listening_ports", newPort, "num_threads", "5", NULL};
+            const char *options[] = { "listening_ports", newPort, "num_threads", numThreads, "enable_keep_alive", "yes", NULL};
 
             (*admin)->ctx = mg_start(&callbacks, (*admin), options);
 
@@ -296,8 +366,21 @@ celix_status_t remoteServiceAdmin_destroy(remote_service_admin_t **admin)
 
     free((*admin)->ip);
     free((*admin)->port);
+
+    hash_map_iterator_t iter = hashMapIterator_construct((*admin)->curlPools);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
+        celix_array_list_t *idleHandles = hashMapEntry_getValue(entry);
+        for (int i = 0; i < celix_arrayList_size(idleHandles); ++i) {
+            curl_easy_cleanup(celix_arrayList_get(idleHandles, i));
+        }
+        celix_arrayList_destroy(idleHandles);
+        free(hashMapEntry_getKey(entry));
+    }
+    hashMap_destroy((*admin)->curlPools, false, false);
+    celixThreadMutex_destroy(&(*admin)->curlPoolsLock);
+
     curl_share_cleanup((*admin)->curlShare);
-    pthread_mutex_destroy(&(*admin)->curlMutexConnect);
     pthread_mutex_destroy(&(*admin)->curlMutexCookie);
     pthread_mutex_destroy(&(*admin)->curlMutexDns);
     free(*admin);
@@ -353,6 +436,65 @@ static void remoteServiceAdmin_teardownStopExportsThread(remote_service_admin_t*
     }
 }
 
+static void* remoteServiceAdmin_asyncSendThread(void *data) {
+    remote_service_admin_t* admin = data;
+
+    celixThreadMutex_lock(&admin->asyncSendMutex);
+    while (true) {
+        while (admin->asyncSendActive && celix_arrayList_size(admin->asyncSends) == 0) {
+            celixThreadCondition_wait(&admin->asyncSendCond, &admin->asyncSendMutex);
+        }
+        if (celix_arrayList_size(admin->asyncSends) == 0) {
+            break; //not active and all queued sends are done
+        }
+        rsa_dfi_async_send_t *send = celix_arrayList_get(admin->asyncSends, 0);
+        celix_arrayList_removeAt(admin->asyncSends, 0);
+        celixThreadMutex_unlock(&admin->asyncSendMutex);
+
+        char *reply = NULL;
+        size_t replyLength = 0;
+        int replyStatus = 0;
+        remoteServiceAdmin_send(admin, send->endpointDescription, send->contentType, send->request, send->requestLength, send->metadata, &reply, &replyLength, &replyStatus);
+        send->done(send->doneData, reply, replyLength, replyStatus);
+        free(send);
+
+        celixThreadMutex_lock(&admin->asyncSendMutex);
+    }
+    celixThreadMutex_unlock(&admin->asyncSendMutex);
+
+    return NULL;
+}
+
+static void remoteServiceAdmin_setupAsyncSendThreads(remote_service_admin_t* admin) {
+    celixThreadMutex_create(&admin->asyncSendMutex, NULL);
+    celixThreadCondition_init(&admin->asyncSendCond, NULL);
+    admin->asyncSends = celix_arrayList_create();
+    admin->asyncSendActive = true;
+    long nrOfThreads = celix_bundleContext_getPropertyAsLong(admin->context, RSA_DFI_ASYNC_SEND_THREADS_KEY, RSA_DFI_ASYNC_SEND_THREADS_DEFAULT);
+    admin->nrOfAsyncSendThreads = nrOfThreads > 0 ? (int)nrOfThreads : 1;
+    admin->asyncSendThreads = calloc((size_t)admin->nrOfAsyncSendThreads, sizeof(celix_thread_t));
+    for (int i = 0; i < admin->nrOfAsyncSendThreads; ++i) {
+        celixThread_create(&admin->asyncSendThreads[i], NULL, remoteServiceAdmin_asyncSendThread, admin);
+        celixThread_setName(&admin->asyncSendThreads[i], "RSA async send");
+    }
+}
+
+static void remoteServiceAdmin_teardownAsyncSendThreads(remote_service_admin_t* admin) {
+    celixThreadMutex_lock(&admin->asyncSendMutex);
+    admin->asyncSendActive = false;
+    celixThreadCondition_broadcast(&admin->asyncSendCond);
+    celixThreadMutex_unlock(&admin->asyncSendMutex);
+    for (int i = 0; i < admin->nrOfAsyncSendThreads; ++i) {
+        celixThread_join(admin->asyncSendThreads[i], NULL);
+    }
+    free(admin->asyncSendThreads);
+    admin->asyncSendThreads = NULL;
+    admin->nrOfAsyncSendThreads = 0;
+    celix_arrayList_destroy(admin->asyncSends);
+    celixThreadMutex_destroy(&admin->asyncSendMutex);
+    celixThreadCondition_destroy(&admin->asyncSendCond);
+}
+
 static void remoteServiceAdmin_stopExport(remote_service_admin_t *admin, export_registration_t* export) {
     if (export != NULL) {
         if (CELIX_RSA_USE_STOP_EXPORT_THREAD) {
@@ -385,6 +527,7 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
         arrayList_destroy(exports);
     }
     hashMapIterator_destroy(iter);
+    hashMap_clear(admin->exportsBySvcId, false, false);
     celixThreadRwlock_unlock(&admin->exportedServicesLock);
 
     remoteServiceAdmin_teardownStopExportsThread(admin);
@@ -401,13 +544,17 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
     }
     celixThreadMutex_unlock(&admin->importedServicesLock);
 
+    remoteServiceAdmin_teardownAsyncSendThreads(admin);
+
     if (admin->ctx != NULL) {
         celix_logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_INFO, "RSA: Stopping webserver...");
         mg_stop(admin->ctx);
         admin->ctx = NULL;
     }
+    pthread_key_delete(admin->requestBufferKey);
 
     hashMap_destroy(admin->exportedServices, false, false);
+    hashMap_destroy(admin->exportsBySvcId, false, false);
     arrayList_destroy(admin->importedServices);
 
     celix_logHelper_destroy(admin->loghelper);
@@ -457,29 +604,7 @@ static int remoteServiceAdmin_callback(struct mg_connection *conn) {
             }
 
             celixThreadRwlock_readLock(&rsa->exportedServicesLock);
-
-            //find endpoint
-            hash_map_iterator_pt iter = hashMapIterator_create(rsa->exportedServices);
-            while (hashMapIterator_hasNext(iter)) {
-                hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
-                array_list_pt exports = hashMapEntry_getValue(entry);
-                int expIt = 0;
-                for (expIt = 0; expIt < arrayList_size(exports); expIt++) {
-                    export_registration_t *check = arrayList_get(exports, expIt);
-                    export_reference_t * ref = NULL;
-                    exportRegistration_getExportReference(check, &ref);
-                    endpoint_description_t * checkEndpoint = NULL;
-                    exportReference_getExportedEndpoint(ref, &checkEndpoint);
-                    if (serviceId == checkEndpoint->serviceId) {
-                        export = check;
-                        free(ref);
-                        break;
-                    }
-                    free(ref);
-                }
-            }
-            hashMapIterator_destroy(iter);
-
+            export = hashMap_get(rsa->exportsBySvcId, (void*)(uintptr_t)serviceId);
             if (export != NULL) {
                 exportRegistration_increaseUsage(export);
             } else {
@@ -492,27 +617,42 @@ static int remoteServiceAdmin_callback(struct mg_connection *conn) {
 
         if (export != NULL) {
             uint64_t datalength = request_info->content_length;
-            char* data = malloc(datalength + 1);
-            mg_read(conn, data, datalength);
-            data[datalength] = '\0';
+            rsa_dfi_request_buffer_t *buffer = remoteServiceAdmin_getRequestBuffer(rsa, datalength + 1);
+            char* data = buffer != NULL ? buffer->data : NULL;
+            if (data != NULL) {
+                mg_read(conn, data, datalength);
+                data[datalength] = '\0';
+            }
+
+            const char *contentType = mg_get_header(conn, "Content-Type");
+            bool binary = contentType != NULL && strcmp(contentType, RSA_DFI_CONTENT_TYPE_AVROBIN) == 0;
 
             char *response = NULL;
-            int responceLength = 0;
-            int rc = exportRegistration_call(export, data, -1, metadata, &response, &responceLength);
+            size_t responseLength = 0;
+            int rc;
+            if (data == NULL) {
+                rc = CELIX_ENOMEM;
+            } else if (binary) {
+                rc = exportRegistration_callBinary(export, (const uint8_t*)data, datalength, metadata, (uint8_t**)&response, &responseLength);
+            } else {
+                int jsonResponseLength = 0;
+                rc = exportRegistration_call(export, data, -1, metadata, &response, &jsonResponseLength);
+                responseLength = response != NULL ? strlen(response) : 0;
+            }
             if (rc != CELIX_SUCCESS) {
                 RSA_LOG_ERROR(rsa, "Error trying to invoke remove service, got error %i\n", rc);
             }
 
             if (rc == CELIX_SUCCESS && response != NULL) {
-                mg_write(conn, data_response_headers, strlen(data_response_headers));
-                mg_write(conn, response, strlen(response));
+                mg_printf(conn, data_response_headers, binary ? RSA_DFI_CONTENT_TYPE_AVROBIN : RSA_DFI_CONTENT_TYPE_JSON, responseLength);
+                mg_write(conn, response, responseLength);
                 free(response);
             } else {
                 mg_write(conn, no_content_response_headers, strlen(no_content_response_headers));
             }
             result = 1;
 
-            free(data);
+            remoteServiceAdmin_releaseRequestBuffer(buffer);
             exportRegistration_decreaseUsage(export);
 
             //TODO free metadata?
@@ -613,6 +753,10 @@ celix_status_t remoteServiceAdmin_exportService(remote_service_admin_t *admin, c
         if (status == CELIX_SUCCESS) {
             celixThreadRwlock_writeLock(&admin->exportedServicesLock);
             hashMap_put(admin->exportedServices, reference, *registrations);
+            for (int i = 0; i < arrayList_size(*registrations); ++i) {
+                export_registration_t *registration = arrayList_get(*registrations, i);
+                hashMap_put(admin->exportsBySvcId, (void*)(uintptr_t)remoteServiceAdmin_getExportedServiceId(registration), registration);
+            }
             celixThreadRwlock_unlock(&admin->exportedServicesLock);
         } else {
             arrayList_destroy(*registrations);
@@ -641,6 +785,12 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_t *
             arrayList_destroy(exports);
         }
 
+        endpoint_description_t *endpoint = NULL;
+        exportReference_getExportedEndpoint(ref, &endpoint);
+        if (endpoint != NULL && hashMap_get(admin->exportsBySvcId, (void*)(uintptr_t)endpoint->serviceId) == registration) {
+            hashMap_remove(admin->exportsBySvcId, (void*)(uintptr_t)endpoint->serviceId);
+        }
+
         remoteServiceAdmin_stopExport(admin, registration);
         celixThreadRwlock_unlock(&admin->exportedServicesLock);
 
@@ -699,6 +849,7 @@ static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_servic
     celix_properties_set(endpointProperties, OSGI_RSA_SERVICE_IMPORTED, "true");
     celix_properties_set(endpointProperties, OSGI_RSA_SERVICE_IMPORTED_CONFIGS, (char*) RSA_DFI_CONFIGURATION_TYPE);
     celix_properties_set(endpointProperties, RSA_DFI_ENDPOINT_URL, url);
+    celix_properties_set(endpointProperties, RSA_DFI_ENDPOINT_ENCODINGS, admin->binaryRpc ? RSA_DFI_ENCODING_AVROBIN "," RSA_DFI_ENCODING_JSON : RSA_DFI_ENCODING_JSON);
 
     if (props != NULL) {
         hash_map_iterator_pt propIter = hashMapIterator_create(props);
@@ -826,6 +977,7 @@ celix_status_t remoteServiceAdmin_importService(remote_service_admin_t *admin, e
         }
         if (status == CELIX_SUCCESS && import != NULL) {
             importRegistration_setSendFn(import, (send_func_type) remoteServiceAdmin_send, admin);
+            importRegistration_setSendAsyncFn(import, remoteServiceAdmin_sendAsync, admin);
         }
 
         if (status == CELIX_SUCCESS && import != NULL) {
@@ -858,6 +1010,7 @@ celix_status_t remoteServiceAdmin_removeImportedService(remote_service_admin_t *
         if (current == registration) {
             arrayList_remove(admin->importedServices, i);
             importRegistration_close(current);
+            remoteServiceAdmin_removeCurlPool(admin, importRegistration_getUrl(current));
             importRegistration_destroy(current);
             break;
         }
@@ -867,11 +1020,11 @@ celix_status_t remoteServiceAdmin_removeImportedService(remote_service_admin_t *
     return status;
 }
 
-static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_t *endpointDescription, char *request, celix_properties_t *metadata, char **reply, int* replyStatus) {
+static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_t *endpointDescription, const char *contentType, const char *request, size_t requestLength, celix_properties_t *metadata, char **reply, size_t *replyLength, int* replyStatus) {
     remote_service_admin_t * rsa = handle;
     struct post post;
     post.readptr = request;
-    post.size = strlen(request);
+    post.size = requestLength;
     post.read = 0;
 
     struct get get;
@@ -902,11 +1055,14 @@ static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description
     CURL *curl;
     CURLcode res;
 
-    curl = curl_easy_init();
+    curl = remoteServiceAdmin_acquireCurl(rsa, url);
     if(!curl) {
         status = CELIX_ILLEGAL_STATE;
     } else {
         struct curl_slist *metadataHeader = NULL;
+        char contentTypeHeader[128];
+        snprintf(contentTypeHeader, sizeof(contentTypeHeader), "Content-Type: %s", contentType);
+        metadataHeader = curl_slist_append(metadataHeader, contentTypeHeader);
         if (metadata != NULL && celix_properties_size(metadata) > 0) {
             const char *key = NULL;
             CELIX_PROPERTIES_FOR_EACH(metadata, key) {
@@ -918,11 +1074,12 @@ static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description
                 snprintf(header, length, "X-RSA-Metadata-%s: %s", key, val);
                 metadataHeader = curl_slist_append(metadataHeader, header);
             }
-
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, metadataHeader);
         }
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, metadataHeader);
 
         curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
+        curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
         curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout);
         curl_easy_setopt(curl, CURLOPT_URL, url);
         curl_easy_setopt(curl, CURLOPT_POST, 1L);
@@ -936,15 +1093,105 @@ static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description
         res = curl_easy_perform(curl);
 
         *reply = get.writeptr;
+        *replyLength = get.size;
         *replyStatus = res;
 
-        curl_easy_cleanup(curl);
+        //only reuse handles of successful calls, a failed call could have left the connection in an unknown state
+        remoteServiceAdmin_releaseCurl(rsa, url, curl, res == CURLE_OK);
         curl_slist_free_all(metadataHeader);
     }
 
     return status;
 }
 
+static celix_status_t remoteServiceAdmin_sendAsync(void *handle, endpoint_description_t *endpointDescription, const char *contentType, const char *request, size_t requestLength, celix_properties_t *metadata, void *doneData, send_done_func_type done) {
+    remote_service_admin_t *rsa = handle;
+    rsa_dfi_async_send_t *send = calloc(1, sizeof(*send));
+    if (send == NULL) {
+        return CELIX_ENOMEM;
+    }
+    send->endpointDescription = endpointDescription;
+    send->contentType = contentType;
+    send->request = request;
+    send->requestLength = requestLength;
+    send->metadata = metadata;
+    send->doneData = doneData;
+    send->done = done;
+
+    celix_status_t status = CELIX_SUCCESS;
+    celixThreadMutex_lock(&rsa->asyncSendMutex);
+    if (rsa->asyncSendActive) {
+        celix_arrayList_add(rsa->asyncSends, send);
+        celixThreadCondition_signal(&rsa->asyncSendCond);
+    } else {
+        status = CELIX_ILLEGAL_STATE;
+    }
+    celixThreadMutex_unlock(&rsa->asyncSendMutex);
+
+    if (status != CELIX_SUCCESS) {
+        free(send);
+    }
+    return status;
+}
+
+static CURL* remoteServiceAdmin_acquireCurl(remote_service_admin_t *admin, const char *url) {
+    CURL *curl = NULL;
+    celixThreadMutex_lock(&admin->curlPoolsLock);
+    celix_array_list_t *idleHandles = hashMap_get(admin->curlPools, url);
+    if (idleHandles != NULL && celix_arrayList_size(idleHandles) > 0) {
+        int last = celix_arrayList_size(idleHandles) - 1;
+        curl = celix_arrayList_get(idleHandles, last);
+        celix_arrayList_removeAt(idleHandles, last);
+    }
+    celixThreadMutex_unlock(&admin->curlPoolsLock);
+
+    if (curl == NULL) {
+        curl = curl_easy_init();
+    }
+    return curl;
+}
+
+static void remoteServiceAdmin_releaseCurl(remote_service_admin_t *admin, const char *url, CURL *curl, bool reusable) {
+    if (reusable) {
+        //note curl_easy_reset keeps the live connections and caches of the handle, only the options are reset
+        curl_easy_reset(curl);
+        celixThreadMutex_lock(&admin->curlPoolsLock);
+        celix_array_list_t *idleHandles = hashMap_get(admin->curlPools, url);
+        if (idleHandles == NULL) {
+            idleHandles = celix_arrayList_create();
+            hashMap_put(admin->curlPools, strdup(url), idleHandles);
+        }
+        if (celix_arrayList_size(idleHandles) < admin->curlPoolSize) {
+            celix_arrayList_add(idleHandles, curl);
+            curl = NULL;
+        }
+        celixThreadMutex_unlock(&admin->curlPoolsLock);
+    }
+    if (curl != NULL) {
+        curl_easy_cleanup(curl);
+    }
+}
+
+static void remoteServiceAdmin_removeCurlPool(remote_service_admin_t *admin, const char *url) {
+    celixThreadMutex_lock(&admin->curlPoolsLock);
+    hash_map_entry_pt entry = hashMap_getEntry(admin->curlPools, url);
+    char *key = NULL;
+    celix_array_list_t *idleHandles = NULL;
+    if (entry != NULL) {
+        key = hashMapEntry_getKey(entry);
+        idleHandles = hashMap_remove(admin->curlPools, url);
+    }
+    celixThreadMutex_unlock(&admin->curlPoolsLock);
+
+    if (idleHandles != NULL) {
+        for (int i = 0; i < celix_arrayList_size(idleHandles); ++i) {
+            curl_easy_cleanup(celix_arrayList_get(idleHandles, i));
+        }
+        celix_arrayList_destroy(idleHandles);
+    }
+    free(key);
+}
+
 static size_t remoteServiceAdmin_readCallback(void *voidBuffer, size_t size, size_t nmemb, void *userp) {
     struct post *post = userp;
     size_t buffSize = size * nmemb;
@@ -958,16 +1205,70 @@ static size_t remoteServiceAdmin_readCallback(void *voidBuffer, size_t size, siz
     return readSize;
 }
 
+static unsigned long remoteServiceAdmin_getExportedServiceId(export_registration_t *export) {
+    unsigned long serviceId = 0;
+    export_reference_t *ref = NULL;
+    exportRegistration_getExportReference(export, &ref);
+    if (ref != NULL) {
+        endpoint_description_t *endpoint = NULL;
+        exportReference_getExportedEndpoint(ref, &endpoint);
+        if (endpoint != NULL) {
+            serviceId = endpoint->serviceId;
+        }
+        free(ref);
+    }
+    return serviceId;
+}
+
+static rsa_dfi_request_buffer_t* remoteServiceAdmin_getRequestBuffer(remote_service_admin_t *admin, size_t size) {
+    rsa_dfi_request_buffer_t *buffer = pthread_getspecific(admin->requestBufferKey);
+    if (buffer == NULL) {
+        buffer = calloc(1, sizeof(*buffer));
+        if (buffer == NULL) {
+            return NULL;
+        }
+        pthread_setspecific(admin->requestBufferKey, buffer);
+    }
+    if (buffer->capacity < size) {
+        char *data = realloc(buffer->data, size);
+        if (data == NULL) {
+            return NULL;
+        }
+        buffer->data = data;
+        buffer->capacity = size;
+    }
+    return buffer;
+}
+
+static void remoteServiceAdmin_releaseRequestBuffer(rsa_dfi_request_buffer_t *buffer) {
+    if (buffer != NULL && buffer->capacity > MAX_RETAINED_REQUEST_BUFFER_SIZE) {
+        //note keep the buffer struct, but do not hold on to the memory of a (rare) large request
+        free(buffer->data);
+        buffer->data = NULL;
+        buffer->capacity = 0;
+    }
+}
+
+static void remoteServiceAdmin_destroyRequestBuffer(void *data) {
+    rsa_dfi_request_buffer_t *buffer = data;
+    if (buffer != NULL) {
+        free(buffer->data);
+        free(buffer);
+    }
+}
+
 static size_t remoteServiceAdmin_write(void *contents, size_t size, size_t nmemb, void *userp) {
     size_t realsize = size * nmemb;
     struct get *mem = (struct get *)userp;
 
-    mem->writeptr =malloc(realsize + 1);
-    if (mem->writeptr == NULL) {
+    //note the reply can arrive in multiple chunks
+    char *newptr = realloc(mem->writeptr, mem->size + realsize + 1);
+    if (newptr == NULL) {
         /* out of memory! */
-        fprintf(stderr, "not enough memory (malloc returned NULL)");
+        fprintf(stderr, "not enough memory (realloc returned NULL)");
         return 0;
     } else {
+        mem->writeptr = newptr;
         memcpy(&(mem->writeptr[mem->size]), contents, realsize);
         mem->size += realsize;
         mem->writeptr[mem->size] = 0;
@@ -33,11 +33,32 @@
 #define RSA_LOG_CALLS_FILE_KEY          "RSA_LOG_CALLS_FILE"
 #define RSA_LOG_CALLS_FILE_DEFAULT      "stdout"
 
+#define RSA_DFI_CURL_POOL_SIZE_KEY      "RSA_DFI_CURL_POOL_SIZE"
+#define RSA_DFI_CURL_POOL_SIZE_DEFAULT  8
+
+#define RSA_DFI_ASYNC_SEND_THREADS_KEY      "RSA_DFI_ASYNC_SEND_THREADS"
+#define RSA_DFI_ASYNC_SEND_THREADS_DEFAULT  4
+
+//Note the default number of webserver threads is RSA_DFI_CURL_POOL_SIZE + RSA_DFI_NUM_THREADS_DEFAULT, because an idle
+//keep-alive connection of a (pooled) client occupies a webserver thread.
+#define RSA_DFI_NUM_THREADS_KEY         "RSA_DFI_NUM_THREADS"
+#define RSA_DFI_NUM_THREADS_DEFAULT     5
+
+#define RSA_DFI_BINARY_RPC_KEY          "RSA_DFI_BINARY_RPC"
+#define RSA_DFI_BINARY_RPC_DEFAULT      true
+
 
 
 
 #define RSA_DFI_CONFIGURATION_TYPE      "org.amdatu.remote.admin.http"
 #define RSA_DFI_ENDPOINT_URL            "org.amdatu.remote.admin.http.url"
+#define RSA_DFI_ENDPOINT_ENCODINGS      "org.apache.celix.remote.admin.dfi.encodings"
+
+#define RSA_DFI_ENCODING_AVROBIN        "avrobin"
+#define RSA_DFI_ENCODING_JSON           "json"
+
+#define RSA_DFI_CONTENT_TYPE_JSON       "application/json"
+#define RSA_DFI_CONTENT_TYPE_AVROBIN    "application/x-celix-avrobin"
 
 
 
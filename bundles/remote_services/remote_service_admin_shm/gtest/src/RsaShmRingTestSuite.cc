@@ -0,0 +1,305 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "remote_service_admin_shm_ring.h"
+
+class RsaShmRingTestSuite : public ::testing::Test {
+public:
+    static constexpr size_t MEM_SIZE = 4 * 4096;
+
+    RsaShmRingTestSuite() {
+        //note shared mapping, so that forked child processes use the same ring
+        memory = mmap(nullptr, MEM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        EXPECT_NE(memory, MAP_FAILED);
+    }
+
+    ~RsaShmRingTestSuite() override {
+        munmap(memory, MEM_SIZE);
+    }
+
+    rsa_shm_ring_t* createRing(unsigned int nrOfSlots) {
+        rsa_shm_ring_t *ring = nullptr;
+        EXPECT_EQ(CELIX_SUCCESS, rsaShmRing_init(memory, MEM_SIZE, nrOfSlots, &ring));
+        return ring;
+    }
+
+    /**
+     * Handles nrOfRequests requests by replying "reply:<request>" with reply status 42.
+     * The slot index of every taken request is added to slots.
+     */
+    static void handleRequests(rsa_shm_ring_t *ring, int nrOfRequests, std::vector<unsigned int>* slots) {
+        for (int i = 0; i < nrOfRequests; ++i) {
+            unsigned int slot;
+            const char *request;
+            size_t requestLength;
+            ASSERT_EQ(CELIX_SUCCESS, rsaShmRing_takeRequest(ring, &slot, &request, &requestLength));
+            std::string reply = std::string{"reply:"} + std::string{request, requestLength};
+            EXPECT_EQ(CELIX_SUCCESS, rsaShmRing_reply(ring, slot, reply.c_str(), reply.size(), 42));
+            if (slots != nullptr) {
+                slots->push_back(slot);
+            }
+        }
+    }
+
+    static celix_status_t call(rsa_shm_ring_t *ring, const std::string& request, std::string* reply = nullptr) {
+        char *out = nullptr;
+        size_t outLength = 0;
+        int replyStatus = 0;
+        celix_status_t status = rsaShmRing_call(ring, request.c_str(), request.size(), &out, &outLength, &replyStatus);
+        if (status == CELIX_SUCCESS) {
+            EXPECT_EQ(42, replyStatus);
+            EXPECT_EQ(strlen(out), outLength);
+            if (reply != nullptr) {
+                *reply = std::string{out, outLength};
+            }
+            free(out);
+        }
+        return status;
+    }
+
+    static void waitForNrOfFreeSlots(rsa_shm_ring_t *ring, unsigned int nrOfFreeSlots) {
+        while (rsaShmRing_nrOfFreeSlots(ring) != nrOfFreeSlots) {
+            std::this_thread::yield();
+        }
+    }
+
+    void* memory;
+};
+
+TEST_F(RsaShmRingTestSuite, InitAndAttach) {
+    rsa_shm_ring_t *ring = createRing(4);
+    EXPECT_EQ(4, rsaShmRing_nrOfFreeSlots(ring));
+    EXPECT_GT(rsaShmRing_maxPayloadSize(ring), 3000);
+    EXPECT_LT(rsaShmRing_maxPayloadSize(ring), MEM_SIZE / 4);
+
+    rsa_shm_ring_t *attached = nullptr;
+    EXPECT_EQ(CELIX_SUCCESS, rsaShmRing_attach(memory, MEM_SIZE, &attached));
+    EXPECT_EQ(ring, attached);
+    EXPECT_EQ(CELIX_ILLEGAL_ARGUMENT, rsaShmRing_attach(memory, 128, &attached));
+
+    memset(memory, 0, MEM_SIZE);
+    EXPECT_EQ(CELIX_ILLEGAL_ARGUMENT, rsaShmRing_attach(memory, MEM_SIZE, &attached));
+    EXPECT_EQ(CELIX_ILLEGAL_ARGUMENT, rsaShmRing_init(memory, MEM_SIZE, 0, &ring));
+    EXPECT_EQ(CELIX_ILLEGAL_ARGUMENT, rsaShmRing_init(memory, MEM_SIZE, MEM_SIZE, &ring));
+}
+
+TEST_F(RsaShmRingTestSuite, CallReplyAndRelease) {
+    rsa_shm_ring_t *ring = createRing(4);
+    std::thread handler{handleRequests, ring, 1, nullptr};
+
+    std::string reply;
+    EXPECT_EQ(CELIX_SUCCESS, call(ring, "hello", &reply));
+    EXPECT_EQ("reply:hello", reply);
+    handler.join();
+
+    //slot released after the reply is read
+    EXPECT_EQ(4, rsaShmRing_nrOfFreeSlots(ring));
+    rsaShmRing_stop(ring);
+}
+
+TEST_F(RsaShmRingTestSuite, SlotsWrapAround) {
+    rsa_shm_ring_t *ring = createRing(3);
+    std::vector<unsigned int> slots{};
+    std::thread handler{handleRequests, ring, 10, &slots};
+
+    //more sequential calls than slots, only possible if every slot is released
+    for (int i = 0; i < 10; ++i) {
+        std::string reply;
+        EXPECT_EQ(CELIX_SUCCESS, call(ring, "call" + std::to_string(i), &reply));
+        EXPECT_EQ("reply:call" + std::to_string(i), reply);
+    }
+    handler.join();
+
+    std::vector<unsigned int> expected{0, 1, 2, 0, 1, 2, 0, 1, 2, 0};
+    EXPECT_EQ(expected, slots);
+    EXPECT_EQ(3, rsaShmRing_nrOfFreeSlots(ring));
+    rsaShmRing_stop(ring);
+}
+
+TEST_F(RsaShmRingTestSuite, ConcurrentCalls) {
+    rsa_shm_ring_t *ring = createRing(2);
+    const int nrOfCallers = 4;
+    const int nrOfCalls = 200;
+    std::thread handler1{handleRequests, ring, nrOfCallers * nrOfCalls / 2, nullptr};
+    std::thread handler2{handleRequests, ring, nrOfCallers * nrOfCalls / 2, nullptr};
+
+    std::vector<std::thread> callers{};
+    for (int c = 0; c < nrOfCallers; ++c) {
+        callers.emplace_back([ring, c, nrOfCalls]{
+            for (int i = 0; i < nrOfCalls; ++i) {
+                std::string request = std::to_string(c) + "-" + std::to_string(i);
+                std::string reply;
+                EXPECT_EQ(CELIX_SUCCESS, call(ring, request, &reply));
+                EXPECT_EQ("reply:" + request, reply);
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    handler1.join();
+    handler2.join();
+    EXPECT_EQ(2, rsaShmRing_nrOfFreeSlots(ring));
+    rsaShmRing_stop(ring);
+}
+
+TEST_F(RsaShmRingTestSuite, RequestTooLarge) {
+    rsa_shm_ring_t *ring = createRing(4);
+    std::string request(rsaShmRing_maxPayloadSize(ring) + 1, 'x');
+    EXPECT_EQ(CELIX_ILLEGAL_ARGUMENT, call(ring, request));
+    EXPECT_EQ(4, rsaShmRing_nrOfFreeSlots(ring));
+    rsaShmRing_stop(ring);
+}
+
+TEST_F(RsaShmRingTestSuite, StopReleasesPendingRequest) {
+    rsa_shm_ring_t *ring = createRing(4);
+    celix_status_t status = CELIX_SUCCESS;
+    std::thread caller{[&status, ring]{ status = call(ring, "never handled"); }};
+
+    waitForNrOfFreeSlots(ring, 3);
+    rsaShmRing_stop(ring);
+    caller.join();
+    EXPECT_EQ(CELIX_ILLEGAL_STATE, status);
+    EXPECT_EQ(4, rsaShmRing_nrOfFreeSlots(ring));
+
+    //new calls fail without claiming a slot
+    EXPECT_EQ(CELIX_ILLEGAL_STATE, call(ring, "too late"));
+    EXPECT_EQ(4, rsaShmRing_nrOfFreeSlots(ring));
+}
+
+TEST_F(RsaShmRingTestSuite, StopReleasesProcessingRequestAfterReply) {
+    rsa_shm_ring_t *ring = createRing(4);
+    celix_status_t status = CELIX_SUCCESS;
+    std::thread caller{[&status, ring]{ status = call(ring, "request"); }};
+
+    unsigned int slot;
+    const char *request;
+    size_t requestLength;
+    ASSERT_EQ(CELIX_SUCCESS, rsaShmRing_takeRequest(ring, &slot, &request, &requestLength));
+    rsaShmRing_stop(ring);
+    caller.join();
+    EXPECT_EQ(CELIX_ILLEGAL_STATE, status);
+
+    //the caller gave up, but the slot is still in use by the handler
+    EXPECT_EQ(3, rsaShmRing_nrOfFreeSlots(ring));
+    EXPECT_EQ(CELIX_ILLEGAL_STATE, rsaShmRing_reply(ring, slot, "reply", 5, 42));
+    EXPECT_EQ(4, rsaShmRing_nrOfFreeSlots(ring));
+}
+
+TEST_F(RsaShmRingTestSuite, ReclaimSlotOfDeadCaller) {
+    rsa_shm_ring_t *ring = createRing(2);
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        //claims a slot and waits for a reply which never comes
+        call(ring, "from child");
+        _exit(0);
+    }
+
+    waitForNrOfFreeSlots(ring, 1);
+    EXPECT_EQ(0, rsaShmRing_reclaimSlots(ring)); //caller still alive
+    EXPECT_EQ(1, rsaShmRing_nrOfFreeSlots(ring));
+
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    EXPECT_EQ(1, rsaShmRing_reclaimSlots(ring));
+    EXPECT_EQ(2, rsaShmRing_nrOfFreeSlots(ring));
+
+    //ring still usable, the (reclaimed) request of the dead caller is not handled
+    std::vector<unsigned int> slots{};
+    std::thread handler{handleRequests, ring, 1, &slots};
+    std::string reply;
+    EXPECT_EQ(CELIX_SUCCESS, call(ring, "from parent", &reply));
+    EXPECT_EQ("reply:from parent", reply);
+    handler.join();
+    EXPECT_EQ(2, rsaShmRing_nrOfFreeSlots(ring));
+    rsaShmRing_stop(ring);
+}
+
+TEST_F(RsaShmRingTestSuite, CallReclaimsSlotsOfDeadCallers) {
+    rsa_shm_ring_t *ring = createRing(1);
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        call(ring, "from child");
+        _exit(0);
+    }
+    waitForNrOfFreeSlots(ring, 0);
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+
+    //no free slot, the call reclaims the slot of the dead child after the wait timeout.
+    //note the request of the dead child can already be handled, in that case its reply is reclaimed
+    std::thread handler{[ring]{
+        std::string request{};
+        while (request != "from parent") {
+            unsigned int slot;
+            const char *data;
+            size_t length;
+            ASSERT_EQ(CELIX_SUCCESS, rsaShmRing_takeRequest(ring, &slot, &data, &length));
+            request = std::string{data, length};
+            std::string reply = "reply:" + request;
+            rsaShmRing_reply(ring, slot, reply.c_str(), reply.size(), 42);
+        }
+    }};
+    std::string reply;
+    EXPECT_EQ(CELIX_SUCCESS, call(ring, "from parent", &reply));
+    EXPECT_EQ("reply:from parent", reply);
+    handler.join();
+    EXPECT_EQ(1, rsaShmRing_nrOfFreeSlots(ring));
+    rsaShmRing_stop(ring);
+}
+
+TEST_F(RsaShmRingTestSuite, CallFailsIfHandlerDies) {
+    rsa_shm_ring_t *ring = createRing(2);
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        //takes a request and dies without replying
+        unsigned int slot;
+        const char *request;
+        size_t requestLength;
+        rsaShmRing_takeRequest(ring, &slot, &request, &requestLength);
+        _exit(0);
+    }
+
+    celix_status_t status = CELIX_SUCCESS;
+    std::thread caller{[&status, ring]{ status = call(ring, "request"); }};
+    waitpid(child, nullptr, 0); //note a zombie process still exists
+    caller.join();
+    EXPECT_EQ(CELIX_ILLEGAL_STATE, status);
+    EXPECT_EQ(2, rsaShmRing_nrOfFreeSlots(ring));
+    rsaShmRing_stop(ring);
+}
@@ -28,17 +28,19 @@
 #define REMOTE_SERVICE_ADMIN_SHM_IMPL_H_
 
 #include "remote_service_admin_impl.h"
+#include "remote_service_admin_shm_ring.h"
 #include "log_helper.h"
 
 #define RSA_SHM_MEMSIZE 1310720
 #define RSA_SHM_PATH_PROPERTYNAME "shmPath"
-#define RSA_SEM_PATH_PROPERTYNAME "semPath"
 #define RSA_SHM_FTOK_ID_PROPERTYNAME "shmFtokId"
-#define RSA_SEM_FTOK_ID_PROPERTYNAME "semFtokId"
 #define RSA_SHM_DEFAULTPATH "/dev/null"
-#define RSA_SEM_DEFAULTPATH "/dev/null"
 #define RSA_SHM_DEFAULT_FTOK_ID "52"
-#define RSA_SEM_DEFAULT_FTOK_ID "54"
+
+#define RSA_SHM_NR_OF_SLOTS_KEY "RSA_SHM_NR_OF_SLOTS"
+#define RSA_SHM_NR_OF_SLOTS_DEFAULT 16
+#define RSA_SHM_NR_OF_THREADS_KEY "RSA_SHM_NR_OF_THREADS"
+#define RSA_SHM_NR_OF_THREADS_DEFAULT 4
 
 #define RSA_FILEPATH_LENGTH 255
 
@@ -47,22 +49,24 @@
 #define P_tmpdir "/tmp"
 #endif
 
-union semun {
-    int val; /* Value for SETVAL */
-    struct semid_ds *buf; /* Buffer for IPC_STAT, IPC_SET */
-    unsigned short *array; /* Array for GETALL, SETALL */
-    struct seminfo *__buf; /* Buffer for IPC_INFO */
-};
-
 struct recv_shm_thread {
     remote_service_admin_t *admin;
     endpoint_description_t *endpointDescription;
 };
 
+/**
+ * The threads handling the calls of one exported service.
+ */
+struct recv_shm_threads {
+    struct recv_shm_thread data; //shared by all threads
+    int nrOfThreads;
+    celix_thread_t *threads;
+};
+
 struct ipc_segment {
-    int semId;
     int shmId;
     void *shmBaseAddress;
+    rsa_shm_ring_t *ring; //request/response slots in the shared memory
 };
 
 struct remote_service_admin {
@@ -78,8 +82,10 @@ struct remote_service_admin {
     hash_map_pt exportedIpcSegment;
     hash_map_pt importedIpcSegment;
 
-    hash_map_pt pollThread;
-    hash_map_pt pollThreadRunning;
+    hash_map_pt pollThread; //key = endpoint description, value = struct recv_shm_threads*
+
+    unsigned int nrOfSlots;
+    int nrOfThreads;
 
     struct mg_context *ctx;
 };
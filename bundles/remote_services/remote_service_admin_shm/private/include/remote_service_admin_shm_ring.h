@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * remote_service_admin_shm_ring.h
+ *
+ *  \copyright  Apache License, Version 2.0
+ */
+
+#ifndef REMOTE_SERVICE_ADMIN_SHM_RING_H_
+#define REMOTE_SERVICE_ADMIN_SHM_RING_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "celix_errno.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A ring of request/response slots placed in a (SysV) shared memory segment.
+ *
+ * Every slot holds one in-flight call, so multiple importers (processes or threads) can call an exported service
+ * concurrently and multiple exporter threads can handle the calls. Slots are claimed and handed over with atomic
+ * compare-and-swap on the slot state; waiting is done with (process shared) futexes, so an uncontended call does not
+ * need any system call besides the wake-ups.
+ *
+ * Payloads are length prefixed. For convenience the received request and reply are NUL terminated.
+ *
+ * Every slot records the pid of the calling and handling process, together with the slot generation (increased for
+ * every claim). This way slots left behind by a crashed process can be reclaimed, see rsaShmRing_reclaimSlots.
+ */
+typedef struct rsa_shm_ring rsa_shm_ring_t;
+
+/**
+ * Initializes a ring in the provided (shared) memory. Called by the exporting side.
+ * The slot payload size is derived from memSize and nrOfSlots.
+ */
+celix_status_t rsaShmRing_init(void *memory, size_t memSize, unsigned int nrOfSlots, rsa_shm_ring_t **ring);
+
+/**
+ * Attaches to a ring initialized by rsaShmRing_init. Called by the importing side.
+ */
+celix_status_t rsaShmRing_attach(void *memory, size_t memSize, rsa_shm_ring_t **ring);
+
+/**
+ * Marks the ring as stopped and wakes up all waiting callers and handlers.
+ * Pending and new calls will return CELIX_ILLEGAL_STATE.
+ */
+void rsaShmRing_stop(rsa_shm_ring_t *ring);
+
+/**
+ * Returns the max payload size of a request or reply.
+ */
+size_t rsaShmRing_maxPayloadSize(rsa_shm_ring_t *ring);
+
+/**
+ * Returns the number of free slots. Mainly intended for diagnostics.
+ */
+unsigned int rsaShmRing_nrOfFreeSlots(rsa_shm_ring_t *ring);
+
+/**
+ * Calls the exporting side: claims a free slot (waiting if all slots are in use), writes the request and waits for the reply.
+ * The reply is allocated and must be freed by the caller.
+ *
+ * The slot is always released, also if the call fails. Returns CELIX_ILLEGAL_STATE if the ring is stopped or if the
+ * process handling the request died.
+ */
+celix_status_t rsaShmRing_call(rsa_shm_ring_t *ring, const char *request, size_t requestLength, char **reply, size_t *replyLength, int *replyStatus);
+
+/**
+ * Waits for a request and claims it. Can be called concurrently by multiple handler threads.
+ * Returns CELIX_ILLEGAL_STATE if the ring is stopped.
+ */
+celix_status_t rsaShmRing_takeRequest(rsa_shm_ring_t *ring, unsigned int *slot, const char **request, size_t *requestLength);
+
+/**
+ * Writes the reply for a request taken with rsaShmRing_takeRequest and wakes up the caller.
+ * Returns CELIX_ILLEGAL_STATE if the caller already gave up on the call (the slot is then released).
+ */
+celix_status_t rsaShmRing_reply(rsa_shm_ring_t *ring, unsigned int slot, const char *reply, size_t replyLength, int replyStatus);
+
+/**
+ * Releases the slots of calls whose calling or handling process no longer exists.
+ * Called by rsaShmRing_call if no slot became free within the wait timeout.
+ * Returns the number of released slots.
+ */
+unsigned int rsaShmRing_reclaimSlots(rsa_shm_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REMOTE_SERVICE_ADMIN_SHM_RING_H_ */
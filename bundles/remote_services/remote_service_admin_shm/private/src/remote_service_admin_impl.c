@@ -30,7 +30,6 @@
 #include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
-#include <sys/sem.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <unistd.h>
@@ -45,13 +44,12 @@
 #include "celix_constants.h"
 #include "utils.h"
 #include "bundle_context.h"
+#include "celix_bundle_context.h"
 #include "bundle.h"
 #include "service_reference.h"
 #include "service_registration.h"
 
-static celix_status_t remoteServiceAdmin_lock(int semId, int semNr);
-static celix_status_t remoteServiceAdmin_unlock(int semId, int semNr);
-static int remoteServiceAdmin_getCount(int semId, int semNr);
+static void remoteServiceAdmin_stopReceiveThreads(struct recv_shm_threads *pollThreads);
 
 celix_status_t remoteServiceAdmin_installEndpoint(remote_service_admin_t *admin, export_registration_t *registration, service_reference_pt reference, char *interface);
 celix_status_t remoteServiceAdmin_createEndpointDescription(remote_service_admin_t *admin, service_reference_pt reference, celix_properties_t *endpointProperties, char *interface, endpoint_description_t **description);
@@ -79,7 +77,11 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
 		(*admin)->exportedIpcSegment = hashMap_create(NULL, NULL, NULL, NULL);
 		(*admin)->importedIpcSegment = hashMap_create(NULL, NULL, NULL, NULL);
 		(*admin)->pollThread = hashMap_create(NULL, NULL, NULL, NULL);
-		(*admin)->pollThreadRunning = hashMap_create(NULL, NULL, NULL, NULL);
+
+		long nrOfSlots = celix_bundleContext_getPropertyAsLong(context, RSA_SHM_NR_OF_SLOTS_KEY, RSA_SHM_NR_OF_SLOTS_DEFAULT);
+		long nrOfThreads = celix_bundleContext_getPropertyAsLong(context, RSA_SHM_NR_OF_THREADS_KEY, RSA_SHM_NR_OF_THREADS_DEFAULT);
+		(*admin)->nrOfSlots = nrOfSlots > 0 ? (unsigned int) nrOfSlots : RSA_SHM_NR_OF_SLOTS_DEFAULT;
+		(*admin)->nrOfThreads = nrOfThreads > 0 ? (int) nrOfThreads : RSA_SHM_NR_OF_THREADS_DEFAULT;
 
 		if (logHelper_create(context, &(*admin)->loghelper) == CELIX_SUCCESS) {
 		}
@@ -96,7 +98,6 @@ celix_status_t remoteServiceAdmin_destroy(remote_service_admin_t **admin) {
 	hashMap_destroy((*admin)->exportedIpcSegment, false, false);
 	hashMap_destroy((*admin)->importedIpcSegment, false, false);
 	hashMap_destroy((*admin)->pollThread, false, false);
-	hashMap_destroy((*admin)->pollThreadRunning, false, false);
 
 	free(*admin);
 
@@ -151,32 +152,22 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
 	hashMapIterator_destroy(iter);
 	celixThreadMutex_unlock(&admin->importedServicesLock);
 
-	// set stop-thread-variable
-	iter = hashMapIterator_create(admin->pollThreadRunning);
-	while (hashMapIterator_hasNext(iter)) {
-		bool *pollThreadRunning = hashMapIterator_nextValue(iter);
-		*pollThreadRunning = false;
-	}
-	hashMapIterator_destroy(iter);
-
-	// release lock
+	// stop the request rings, this wakes up and stops the receive threads
 	iter = hashMapIterator_create(admin->exportedIpcSegment);
 	while (hashMapIterator_hasNext(iter)) {
 		ipc_segment_pt ipc = hashMapIterator_nextValue(iter);
-		remoteServiceAdmin_unlock(ipc->semId, 1);
+		rsaShmRing_stop(ipc->ring);
 	}
 	hashMapIterator_destroy(iter);
 
 	// wait till threads has stopped
 	iter = hashMapIterator_create(admin->pollThread);
 	while (hashMapIterator_hasNext(iter)) {
-		celix_thread_t *pollThread = hashMapIterator_nextValue(iter);
-
-		if (pollThread != NULL) {
-			status = celixThread_join(*pollThread, NULL);
-		}
+		struct recv_shm_threads *pollThreads = hashMapIterator_nextValue(iter);
+		remoteServiceAdmin_stopReceiveThreads(pollThreads);
 	}
 	hashMapIterator_destroy(iter);
+	hashMap_clear(admin->pollThread, false, false);
 
 	iter = hashMapIterator_create(admin->importedIpcSegment);
 	while (hashMapIterator_hasNext(iter)) {
@@ -200,99 +191,48 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
 	return status;
 }
 
-static int remoteServiceAdmin_getCount(int semId, int semNr) {
-	int token = -1;
-	unsigned short semVals[3];
-	union semun semArg;
-
-	semArg.array = semVals;
-
-	if (semctl(semId, 0, GETALL, semArg) == 0) {
-		token = semArg.array[semNr];
-	}
-
-	return token;
-}
-
-static celix_status_t remoteServiceAdmin_lock(int semId, int semNr) {
-	celix_status_t status = CELIX_SUCCESS;
-	int semOpStatus = 0;
-	struct sembuf semOperation;
-
-	semOperation.sem_num = semNr;
-	semOperation.sem_op = -1;
-	semOperation.sem_flg = 0;
-
-	do {
-		status = CELIX_SUCCESS;
-
-		if ((semOpStatus = semop(semId, &semOperation, 1)) != 0) {
-			status = CELIX_BUNDLE_EXCEPTION;
-		}
-	} while (semOpStatus == -1 && errno == EINTR);
-
-	return status;
-}
-
-static celix_status_t remoteServiceAdmin_unlock(int semId, int semNr) {
-	celix_status_t status = CELIX_SUCCESS;
-	int semOpStatus = 0;
-	struct sembuf semOperation;
-
-	semOperation.sem_num = semNr;
-	semOperation.sem_op = 1;
-	semOperation.sem_flg = 0;
-
-	do {
-		status = CELIX_SUCCESS;
-
-		if ((semOpStatus = semop(semId, &semOperation, 1)) != 0) {
-			status = CELIX_BUNDLE_EXCEPTION;
-		}
-	} while (semOpStatus == -1 && errno == EINTR);
-
-	return status;
-}
-
 celix_status_t remoteServiceAdmin_send(remote_service_admin_t *admin, endpoint_description_t *recpEndpoint, char *request, char **reply, int *replyStatus) {
 	celix_status_t status = CELIX_SUCCESS;
 	ipc_segment_pt ipc = NULL;
 
 	if ((ipc = hashMap_get(admin->importedIpcSegment, recpEndpoint->service)) != NULL) {
-		int semid = ipc->semId;
+		size_t replyLength = 0;
 
-		/* lock critical area */
-		remoteServiceAdmin_lock(semid, 0);
-
-		/* write method and data */
-		strcpy(ipc->shmBaseAddress, request);
-
-		/* Check the status of the send-receive semaphore and reset them if not correct */
-		if (remoteServiceAdmin_getCount(ipc->semId, 1) > 0) {
-			semctl(semid, 1, SETVAL, (int) 0);
-		}
-		if (remoteServiceAdmin_getCount(ipc->semId, 2) > 0) {
-			semctl(semid, 2, SETVAL, (int) 0);
+		/* claims a free request slot, so concurrent calls do not wait for each other */
+		status = rsaShmRing_call(ipc->ring, request, strlen(request), reply, &replyLength, replyStatus);
+		if (status == CELIX_ILLEGAL_ARGUMENT) {
+			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "send : size of message bigger than shared memory slot (%zu bytes). NOT SENDING.", rsaShmRing_maxPayloadSize(ipc->ring));
 		}
+	} else {
+		status = CELIX_ILLEGAL_STATE; /* could not find ipc segment */
+	}
 
-		/* Inform receiver we are invoking the remote service */
-		remoteServiceAdmin_unlock(semid, 1);
-
-		/* Wait until the receiver finished his operations */
-		remoteServiceAdmin_lock(semid, 2);
+	return status;
+}
 
-		/* read reply */
-		*reply = strdup(ipc->shmBaseAddress);
+static celix_status_t remoteServiceAdmin_handleRequest(remote_service_admin_t *admin, endpoint_description_t *exportedEndpointDesc, const char *request, char **reply) {
+	celix_status_t status = CELIX_ILLEGAL_STATE;
+	hash_map_iterator_pt iter = hashMapIterator_create(admin->exportedServices);
 
-		/* TODO: fix replyStatus */
-		*replyStatus = 0;
+	while (hashMapIterator_hasNext(iter)) {
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+		array_list_pt exports = hashMapEntry_getValue(entry);
+		int expIt = 0;
 
-		/* release critical area */
-		remoteServiceAdmin_unlock(semid, 0);
+		for (expIt = 0; expIt < arrayList_size(exports); expIt++) {
+			export_registration_t *export = arrayList_get(exports, expIt);
 
-	} else {
-		status = CELIX_ILLEGAL_STATE; /* could not find ipc segment */
+			if (strcmp(exportedEndpointDesc->service, export->endpointDescription->service) != 0) {
+				continue;
+			} else if (export->endpoint != NULL) {
+				//note the request is only read and stays valid (in its slot) until the reply is written
+				status = export->endpoint->handleRequest(export->endpoint->endpoint, (char *) request, reply);
+			} else {
+				logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "receiveFromSharedMemory : No endpoint set for %s.", export->endpointDescription->service);
+			}
+		}
 	}
+	hashMapIterator_destroy(iter);
 
 	return status;
 }
@@ -306,58 +246,40 @@ static void * remoteServiceAdmin_receiveFromSharedMemory(void *data) {
 	ipc_segment_pt ipc;
 
 	if ((ipc = hashMap_get(admin->exportedIpcSegment, exportedEndpointDesc->service)) != NULL) {
-		bool *pollThreadRunning = hashMap_get(admin->pollThreadRunning, exportedEndpointDesc);
-
-		while (*pollThreadRunning == true) {
-			if ((remoteServiceAdmin_lock(ipc->semId, 1) == CELIX_SUCCESS) && (*pollThreadRunning == true)) {
-
-				// TODO: align data size
-				char *data = calloc(1024, sizeof(*data));
-				strcpy(data, ipc->shmBaseAddress);
-
-				hash_map_iterator_pt iter = hashMapIterator_create(admin->exportedServices);
-
-				while (hashMapIterator_hasNext(iter)) {
-					hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
-					array_list_pt exports = hashMapEntry_getValue(entry);
-					int expIt = 0;
-
-					for (expIt = 0; expIt < arrayList_size(exports); expIt++) {
-						export_registration_t *export = arrayList_get(exports, expIt);
-
-						if ((strcmp(exportedEndpointDesc->service, export->endpointDescription->service) == 0) && (export->endpoint != NULL)) {
-							char *reply = NULL;
-
-							/* TODO: fix handling of handleRequest return value*/
-									export->endpoint->handleRequest(export->endpoint->endpoint, data, &reply);
-
-									if (reply != NULL) {
-										if ((strlen(reply) * sizeof(char)) >= RSA_SHM_MEMSIZE) {
-											logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "receiveFromSharedMemory : size of message bigger than shared memory message. NOT SENDING.");
-										} else {
-											strcpy(ipc->shmBaseAddress, reply);
-										}
-										free(reply);
-									}
-						} else {
-							logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "receiveFromSharedMemory : No endpoint set for %s.", export->endpointDescription->service);
-						}
-					}
+		unsigned int slot = 0;
+		const char *request = NULL;
+		size_t requestLength = 0;
+
+		/* multiple receive threads take requests from the same ring, until the ring is stopped */
+		while (rsaShmRing_takeRequest(ipc->ring, &slot, &request, &requestLength) == CELIX_SUCCESS) {
+			char *reply = NULL;
+			celix_status_t status = remoteServiceAdmin_handleRequest(admin, exportedEndpointDesc, request, &reply);
+
+			if (reply != NULL) {
+				if (rsaShmRing_reply(ipc->ring, slot, reply, strlen(reply), status) == CELIX_ILLEGAL_ARGUMENT) {
+					logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "receiveFromSharedMemory : size of message bigger than shared memory slot. NOT SENDING.");
 				}
-				hashMapIterator_destroy(iter);
-				free(data);
-
-				remoteServiceAdmin_unlock(ipc->semId, 2);
-
+				free(reply);
+			} else {
+				rsaShmRing_reply(ipc->ring, slot, NULL, 0, status != CELIX_SUCCESS ? status : CELIX_SERVICE_EXCEPTION);
 			}
 		}
 	}
 
-	free(data);
-
 	return NULL;
 }
 
+static void remoteServiceAdmin_stopReceiveThreads(struct recv_shm_threads *pollThreads) {
+	if (pollThreads != NULL) {
+		int i;
+		for (i = 0; i < pollThreads->nrOfThreads; i++) {
+			celixThread_join(pollThreads->threads[i], NULL);
+		}
+		free(pollThreads->threads);
+		free(pollThreads);
+	}
+}
+
 celix_status_t remoteServiceAdmin_getSharedIdentifierFile(remote_service_admin_t *admin, char *fwUuid, char* servicename, char* outFile) {
 	celix_status_t status = CELIX_SUCCESS;
 	snprintf(outFile, RSA_FILEPATH_LENGTH, "%s/%s/%s", P_tmpdir, fwUuid, servicename);
@@ -528,24 +450,28 @@ celix_status_t remoteServiceAdmin_exportService(remote_service_admin_t *admin, c
 				exportRegistration_startTracking(registration);
 
 				if (remoteServiceAdmin_createOrAttachShm(admin->exportedIpcSegment, admin, registration->endpointDescription, true) == CELIX_SUCCESS) {
-					recv_shm_thread_pt recvThreadData = NULL;
+					struct recv_shm_threads *pollThreads = calloc(1, sizeof(*pollThreads));
+					celix_thread_t *threads = calloc(admin->nrOfThreads, sizeof(*threads));
 
-					if ((recvThreadData = calloc(1, sizeof(*recvThreadData))) == NULL) {
+					if (pollThreads == NULL || threads == NULL) {
+						free(pollThreads);
+						free(threads);
 						status = CELIX_ENOMEM;
 					} else {
-						recvThreadData->admin = admin;
-						recvThreadData->endpointDescription = registration->endpointDescription;
-
-						celix_thread_t* pollThread = calloc(1, sizeof(*pollThread));
-						bool *pollThreadRunningPtr = calloc(1, sizeof(*pollThreadRunningPtr));
-						*pollThreadRunningPtr = true;
-
-						hashMap_put(admin->pollThreadRunning, registration->endpointDescription, pollThreadRunningPtr);
-
-						// start receiving thread
-						status = celixThread_create(pollThread, NULL, remoteServiceAdmin_receiveFromSharedMemory, recvThreadData);
+						pollThreads->data.admin = admin;
+						pollThreads->data.endpointDescription = registration->endpointDescription;
+						pollThreads->threads = threads;
+
+						// start receiving threads
+						int i;
+						for (i = 0; i < admin->nrOfThreads && status == CELIX_SUCCESS; i++) {
+							status = celixThread_create(&pollThreads->threads[i], NULL, remoteServiceAdmin_receiveFromSharedMemory, &pollThreads->data);
+							if (status == CELIX_SUCCESS) {
+								pollThreads->nrOfThreads += 1;
+							}
+						}
 
-						hashMap_put(admin->pollThread, registration->endpointDescription, pollThread);
+						hashMap_put(admin->pollThread, registration->endpointDescription, pollThreads);
 					}
 				}
 			}
@@ -572,8 +498,6 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_t *
 	status = exportRegistration_getExportReference(registration, &ref);
 
 	if (status == CELIX_SUCCESS) {
-		bool *pollThreadRunning = NULL;
-
 		service_reference_pt servRef;
 		celixThreadMutex_lock(&admin->exportedServicesLock);
 		exportReference_getExportedService(ref, &servRef);
@@ -585,33 +509,17 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_t *
 
 		exportRegistration_close(registration);
 
-		if ((pollThreadRunning = hashMap_get(admin->pollThreadRunning, registration->endpointDescription)) != NULL) {
-			*pollThreadRunning = false;
-
-			if ((ipc = hashMap_get(admin->exportedIpcSegment, registration->endpointDescription->service)) != NULL) {
-				celix_thread_t* pollThread;
-
-				remoteServiceAdmin_unlock(ipc->semId, 1);
+		if ((ipc = hashMap_get(admin->exportedIpcSegment, registration->endpointDescription->service)) != NULL) {
+			struct recv_shm_threads *pollThreads = hashMap_remove(admin->pollThread, registration->endpointDescription);
 
-				if ((pollThread = hashMap_get(admin->pollThread, registration->endpointDescription)) != NULL) {
-					status = celixThread_join(*pollThread, NULL);
+			rsaShmRing_stop(ipc->ring);
+			remoteServiceAdmin_stopReceiveThreads(pollThreads);
 
-					if (status == CELIX_SUCCESS) {
-						semctl(ipc->semId, 1 , IPC_RMID);
-						shmctl(ipc->shmId, IPC_RMID, 0);
+			remoteServiceAdmin_deleteIpcSegment(ipc);
+			remoteServiceAdmin_removeSharedIdentityFile(admin, registration->endpointDescription->frameworkUUID, registration->endpointDescription->service);
 
-						remoteServiceAdmin_removeSharedIdentityFile(admin, registration->endpointDescription->frameworkUUID, registration->endpointDescription->service);
-
-						hashMap_remove(admin->pollThreadRunning, registration->endpointDescription);
-						hashMap_remove(admin->exportedIpcSegment, registration->endpointDescription->service);
-						hashMap_remove(admin->pollThread, registration->endpointDescription);
-
-						free(pollThreadRunning);
-						free(pollThread);
-						free(ipc);
-					}
-				}
-			}
+			hashMap_remove(admin->exportedIpcSegment, registration->endpointDescription->service);
+			free(ipc);
 		}
 		exportRegistration_destroy(&registration);
 	}
@@ -636,7 +544,8 @@ celix_status_t remoteServiceAdmin_detachIpcSegment(ipc_segment_pt ipc) {
 }
 
 celix_status_t remoteServiceAdmin_deleteIpcSegment(ipc_segment_pt ipc) {
-	return ((semctl(ipc->semId, 1 /*ignored*/, IPC_RMID) != -1) && (shmctl(ipc->shmId, IPC_RMID, 0) != -1)) ? CELIX_SUCCESS : CELIX_BUNDLE_EXCEPTION;
+	shmdt(ipc->shmBaseAddress);
+	return (shmctl(ipc->shmId, IPC_RMID, 0) != -1) ? CELIX_SUCCESS : CELIX_BUNDLE_EXCEPTION;
 }
 
 celix_status_t remoteServiceAdmin_createOrAttachShm(hash_map_pt ipcSegment, remote_service_admin_t *admin, endpoint_description_t *endpointDescription, bool createIfNotFound) {
@@ -650,21 +559,12 @@ celix_status_t remoteServiceAdmin_createOrAttachShm(hash_map_pt ipcSegment, remo
 	char *shmPath = NULL;
 	char *shmFtokId = NULL;
 
-	char *semPath = NULL;
-	char *semFtokId = NULL;
-
 	if ((shmPath = (char*)properties_get(endpointProperties, (char *) RSA_SHM_PATH_PROPERTYNAME)) == NULL) {
 		logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "No value found for key %s in endpointProperties.", RSA_SHM_PATH_PROPERTYNAME);
 		status = CELIX_BUNDLE_EXCEPTION;
 	} else if ((shmFtokId = (char*)properties_get(endpointProperties, (char *) RSA_SHM_FTOK_ID_PROPERTYNAME)) == NULL) {
 		logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "No value found for key %s in endpointProperties.", RSA_SHM_FTOK_ID_PROPERTYNAME);
 		status = CELIX_BUNDLE_EXCEPTION;
-	} else if ((semPath = (char*)properties_get(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME)) == NULL) {
-		logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "No value found for key %s in endpointProperties.", RSA_SEM_PATH_PROPERTYNAME);
-		status = CELIX_BUNDLE_EXCEPTION;
-	} else if ((semFtokId = (char*)properties_get(endpointProperties, (char *) RSA_SEM_FTOK_ID_PROPERTYNAME)) == NULL) {
-		logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "No value found for key %s in endpointProperties.", RSA_SEM_FTOK_ID_PROPERTYNAME);
-		status = CELIX_BUNDLE_EXCEPTION;
 	} else {
 		key_t shmKey = ftok(shmPath, atoi(shmFtokId));
 		ipc = calloc(1, sizeof(*ipc));
@@ -695,24 +595,19 @@ celix_status_t remoteServiceAdmin_createOrAttachShm(hash_map_pt ipcSegment, remo
 	}
 
 	if(ipc != NULL && status == CELIX_SUCCESS){
+		// the exporting side (re)initializes the request slots, the importing side attaches to them
+		if (createIfNotFound == true) {
+			status = rsaShmRing_init(ipc->shmBaseAddress, RSA_SHM_MEMSIZE, admin->nrOfSlots, &ipc->ring);
+		} else {
+			status = rsaShmRing_attach(ipc->shmBaseAddress, RSA_SHM_MEMSIZE, &ipc->ring);
+		}
 
-		key_t semkey = ftok(semPath, atoi(semFtokId));
-		int semflg = (createIfNotFound == true) ? (0666 | IPC_CREAT) : (0666);
-		int semid = semget(semkey, 3, semflg);
-
-		if (semid != -1) {
-			// only reset semaphores if a create was supposed
-			if ((createIfNotFound == true) && ((semctl(semid, 0, SETVAL, (int) 1) == -1) || (semctl(semid, 1, SETVAL, (int) 0) == -1) || (semctl(semid, 2, SETVAL, (int) 0) == -1))) {
-				logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "error while initialize semaphores.");
-			}
-
-			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "semaphores w/ key %s and id %i added.", endpointDescription->service, semid);
-			ipc->semId = semid;
-
+		if (status == CELIX_SUCCESS) {
+			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "shared memory request slots for %s ready.", endpointDescription->service);
 			hashMap_put(ipcSegment, endpointDescription->service, ipc);
 		} else {
-			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "error getting semaphores.");
-			status = CELIX_BUNDLE_EXCEPTION;
+			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "error while initializing shared memory request slots.");
+			shmdt(ipc->shmBaseAddress);
 		}
 	}
 
@@ -771,19 +666,6 @@ celix_status_t remoteServiceAdmin_installEndpoint(remote_service_admin_t *admin,
 	if (celix_properties_get(endpointProperties, (char *) RSA_SHM_FTOK_ID_PROPERTYNAME, NULL) == NULL) {
 		celix_properties_set(endpointProperties, (char *) RSA_SHM_FTOK_ID_PROPERTYNAME, (char *) RSA_SHM_DEFAULT_FTOK_ID);
 	}
-	if (celix_properties_get(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME, NULL) == NULL) {
-		char sharedIdentifierFile[RSA_FILEPATH_LENGTH];
-
-		if (remoteServiceAdmin_getSharedIdentifierFile(admin, (char*)uuid, interface, sharedIdentifierFile) == CELIX_SUCCESS) {
-			celix_properties_set(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME, sharedIdentifierFile);
-		} else {
-			celix_properties_set(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME, (char *) RSA_SEM_DEFAULTPATH);
-		}
-	}
-	if (celix_properties_get(endpointProperties, (char *) RSA_SEM_FTOK_ID_PROPERTYNAME, NULL) == NULL) {
-		celix_properties_set(endpointProperties, (char *) RSA_SEM_FTOK_ID_PROPERTYNAME, (char *) RSA_SEM_DEFAULT_FTOK_ID);
-	}
-
 	endpoint_description_t *endpointDescription = NULL;
 	remoteServiceAdmin_createEndpointDescription(admin, reference, endpointProperties, interface, &endpointDescription);
 	exportRegistration_setEndpointDescription(registration, endpointDescription);
@@ -0,0 +1,424 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * remote_service_admin_shm_ring.c
+ *
+ *  \copyright  Apache License, Version 2.0
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "remote_service_admin_shm_ring.h"
+
+#define RSA_SHM_RING_MAGIC 0x52534132 /* "RSA2" */
+#define RSA_SHM_RING_ALIGNMENT 64
+#define RSA_SHM_RING_WAIT_TIMEOUT_NS (100 * 1000 * 1000)
+
+#define RSA_SHM_SLOT_STATE_BITS 8
+#define RSA_SHM_SLOT_STATE_MASK ((1u << RSA_SHM_SLOT_STATE_BITS) - 1)
+#define RSA_SHM_SLOT_GENERATION_MASK (UINT32_MAX >> RSA_SHM_SLOT_STATE_BITS)
+
+enum rsa_shm_slot_state {
+	RSA_SHM_SLOT_FREE = 0,
+	RSA_SHM_SLOT_CLAIMED = 1,
+	RSA_SHM_SLOT_REQUEST = 2,
+	RSA_SHM_SLOT_PROCESSING = 3,
+	RSA_SHM_SLOT_REPLY = 4,
+	RSA_SHM_SLOT_ABANDONED = 5 //caller gave up, the handler releases the slot when replying
+};
+
+/**
+ * Process using a slot. The generation is stored (with release semantics) after the pid, so a reader that sees the
+ * current slot generation also sees the matching pid.
+ */
+struct rsa_shm_slot_user {
+	int32_t pid;
+	uint32_t generation;
+};
+
+/**
+ * Slot header, followed by the payload.
+ * The state word holds the slot state in the lower bits and the slot generation in the upper bits. It is also the
+ * futex word the caller waits on. Because of the generation a stale compare-and-swap on a reused slot always fails.
+ */
+struct rsa_shm_slot {
+	uint32_t state;
+	int32_t replyStatus;
+	uint32_t length;
+	uint32_t reserved;
+	struct rsa_shm_slot_user owner;
+	struct rsa_shm_slot_user handler;
+	char data[];
+};
+
+/**
+ * Ring header, placed at the start of the shared memory and followed by the slots.
+ * Note that only offsets/sizes are stored, because the memory is attached at different addresses in different processes.
+ */
+struct rsa_shm_ring {
+	uint32_t magic;
+	uint32_t nrOfSlots;
+	uint32_t slotSize; //size of a slot including its header
+	uint32_t running;
+	uint32_t requestSeq; //futex word handlers wait on, increased for every posted request
+	uint32_t freeSeq; //futex word callers wait on if no slot is free, increased for every freed slot
+	uint32_t nextSlot; //hint where to start looking for a free slot
+} __attribute__((aligned(RSA_SHM_RING_ALIGNMENT)));
+
+static inline uint32_t rsaShmRing_stateWord(uint32_t generation, enum rsa_shm_slot_state state) {
+	return (generation << RSA_SHM_SLOT_STATE_BITS) | (uint32_t)state;
+}
+
+static inline enum rsa_shm_slot_state rsaShmRing_stateOf(uint32_t word) {
+	return (enum rsa_shm_slot_state)(word & RSA_SHM_SLOT_STATE_MASK);
+}
+
+static inline uint32_t rsaShmRing_generationOf(uint32_t word) {
+	return word >> RSA_SHM_SLOT_STATE_BITS;
+}
+
+static size_t rsaShmRing_headerSize(void) {
+	return (sizeof(struct rsa_shm_ring) + RSA_SHM_RING_ALIGNMENT - 1) & ~((size_t)RSA_SHM_RING_ALIGNMENT - 1);
+}
+
+static struct rsa_shm_slot* rsaShmRing_slot(rsa_shm_ring_t *ring, unsigned int index) {
+	return (struct rsa_shm_slot*)((char*)ring + rsaShmRing_headerSize() + (size_t)index * ring->slotSize);
+}
+
+/**
+ * Waits till the futex word changes or the wait timeout expires. Returns true if the timeout expired.
+ */
+static bool rsaShmRing_futexWait(uint32_t *addr, uint32_t expected) {
+	//note not FUTEX_PRIVATE_FLAG, the futex word is shared between processes
+	struct timespec timeout = {0, RSA_SHM_RING_WAIT_TIMEOUT_NS};
+	long rc = syscall(SYS_futex, addr, FUTEX_WAIT, expected, &timeout, NULL, 0);
+	return rc == -1 && errno == ETIMEDOUT;
+}
+
+static void rsaShmRing_futexWake(uint32_t *addr, int nrOfWaiters) {
+	syscall(SYS_futex, addr, FUTEX_WAKE, nrOfWaiters, NULL, NULL, 0);
+}
+
+static bool rsaShmRing_isRunning(rsa_shm_ring_t *ring) {
+	return __atomic_load_n(&ring->running, __ATOMIC_ACQUIRE) != 0;
+}
+
+static void rsaShmRing_setUser(struct rsa_shm_slot_user *user, uint32_t generation) {
+	__atomic_store_n(&user->pid, (int32_t)getpid(), __ATOMIC_RELAXED);
+	__atomic_store_n(&user->generation, generation, __ATOMIC_RELEASE);
+}
+
+/**
+ * Returns true if the user of the given slot generation is known and no longer exists.
+ */
+static bool rsaShmRing_isUserGone(struct rsa_shm_slot_user *user, uint32_t generation) {
+	if (__atomic_load_n(&user->generation, __ATOMIC_ACQUIRE) != generation) {
+		return false; //not (yet) set for this generation
+	}
+	pid_t pid = __atomic_load_n(&user->pid, __ATOMIC_RELAXED);
+	return pid > 0 && kill(pid, 0) == -1 && errno == ESRCH;
+}
+
+/**
+ * Releases the slot if it is still in the expected state. Returns false if the slot state changed.
+ */
+static bool rsaShmRing_releaseSlot(rsa_shm_ring_t *ring, struct rsa_shm_slot *slot, uint32_t expected) {
+	uint32_t freeWord = rsaShmRing_stateWord(rsaShmRing_generationOf(expected), RSA_SHM_SLOT_FREE);
+	if (!__atomic_compare_exchange_n(&slot->state, &expected, freeWord, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+		return false;
+	}
+	__atomic_fetch_add(&ring->freeSeq, 1, __ATOMIC_ACQ_REL);
+	rsaShmRing_futexWake(&ring->freeSeq, 1);
+	return true;
+}
+
+celix_status_t rsaShmRing_init(void *memory, size_t memSize, unsigned int nrOfSlots, rsa_shm_ring_t **out) {
+	size_t headerSize = rsaShmRing_headerSize();
+	if (memory == NULL || nrOfSlots == 0 || memSize <= headerSize) {
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+	size_t slotSize = ((memSize - headerSize) / nrOfSlots) & ~((size_t)RSA_SHM_RING_ALIGNMENT - 1);
+	if (slotSize <= sizeof(struct rsa_shm_slot) || slotSize > UINT32_MAX) {
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	rsa_shm_ring_t *ring = memory;
+	memset(ring, 0, headerSize + slotSize * nrOfSlots);
+	ring->nrOfSlots = nrOfSlots;
+	ring->slotSize = (uint32_t)slotSize;
+	ring->running = 1;
+	__atomic_store_n(&ring->magic, RSA_SHM_RING_MAGIC, __ATOMIC_RELEASE);
+
+	*out = ring;
+	return CELIX_SUCCESS;
+}
+
+celix_status_t rsaShmRing_attach(void *memory, size_t memSize, rsa_shm_ring_t **out) {
+	rsa_shm_ring_t *ring = memory;
+	if (ring == NULL || memSize <= rsaShmRing_headerSize() || __atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != RSA_SHM_RING_MAGIC) {
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+	if (ring->nrOfSlots == 0 || rsaShmRing_headerSize() + (size_t)ring->nrOfSlots * ring->slotSize > memSize) {
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+	*out = ring;
+	return CELIX_SUCCESS;
+}
+
+void rsaShmRing_stop(rsa_shm_ring_t *ring) {
+	__atomic_store_n(&ring->running, 0, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&ring->requestSeq, 1, __ATOMIC_ACQ_REL);
+	__atomic_fetch_add(&ring->freeSeq, 1, __ATOMIC_ACQ_REL);
+	rsaShmRing_futexWake(&ring->requestSeq, INT_MAX);
+	rsaShmRing_futexWake(&ring->freeSeq, INT_MAX);
+	for (unsigned int i = 0; i < ring->nrOfSlots; ++i) {
+		rsaShmRing_futexWake(&rsaShmRing_slot(ring, i)->state, INT_MAX);
+	}
+}
+
+size_t rsaShmRing_maxPayloadSize(rsa_shm_ring_t *ring) {
+	//note reserve one byte for the NUL terminator
+	return ring->slotSize - sizeof(struct rsa_shm_slot) - 1;
+}
+
+unsigned int rsaShmRing_nrOfFreeSlots(rsa_shm_ring_t *ring) {
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < ring->nrOfSlots; ++i) {
+		if (rsaShmRing_stateOf(__atomic_load_n(&rsaShmRing_slot(ring, i)->state, __ATOMIC_RELAXED)) == RSA_SHM_SLOT_FREE) {
+			count += 1;
+		}
+	}
+	return count;
+}
+
+static bool rsaShmRing_claimSlot(rsa_shm_ring_t *ring, unsigned int *index, uint32_t *generation) {
+	unsigned int start = __atomic_fetch_add(&ring->nextSlot, 1, __ATOMIC_RELAXED);
+	for (unsigned int i = 0; i < ring->nrOfSlots; ++i) {
+		unsigned int candidate = (start + i) % ring->nrOfSlots;
+		struct rsa_shm_slot *slot = rsaShmRing_slot(ring, candidate);
+		uint32_t expected = __atomic_load_n(&slot->state, __ATOMIC_RELAXED);
+		if (rsaShmRing_stateOf(expected) != RSA_SHM_SLOT_FREE) {
+			continue;
+		}
+		uint32_t gen = (rsaShmRing_generationOf(expected) + 1) & RSA_SHM_SLOT_GENERATION_MASK;
+		if (__atomic_compare_exchange_n(&slot->state, &expected, rsaShmRing_stateWord(gen, RSA_SHM_SLOT_CLAIMED), false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			rsaShmRing_setUser(&slot->owner, gen);
+			*index = candidate;
+			*generation = gen;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Gives up on a posted call. A request that is not yet taken and a reply that is not yet read are released directly,
+ * a request that is being processed is marked abandoned and released by the handler when replying (or directly if
+ * the handler is gone).
+ */
+static void rsaShmRing_cancelCall(rsa_shm_ring_t *ring, struct rsa_shm_slot *slot, uint32_t generation) {
+	for (;;) {
+		uint32_t word = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+		if (rsaShmRing_generationOf(word) != generation) {
+			return; //already reclaimed
+		}
+		switch (rsaShmRing_stateOf(word)) {
+			case RSA_SHM_SLOT_CLAIMED:
+			case RSA_SHM_SLOT_REQUEST:
+			case RSA_SHM_SLOT_REPLY:
+				if (rsaShmRing_releaseSlot(ring, slot, word)) {
+					return;
+				}
+				break;
+			case RSA_SHM_SLOT_PROCESSING:
+				if (rsaShmRing_isUserGone(&slot->handler, generation)) {
+					if (rsaShmRing_releaseSlot(ring, slot, word)) {
+						return;
+					}
+				} else if (__atomic_compare_exchange_n(&slot->state, &word, rsaShmRing_stateWord(generation, RSA_SHM_SLOT_ABANDONED), false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+					return;
+				}
+				break;
+			default:
+				return;
+		}
+	}
+}
+
+celix_status_t rsaShmRing_call(rsa_shm_ring_t *ring, const char *request, size_t requestLength, char **reply, size_t *replyLength, int *replyStatus) {
+	if (requestLength > rsaShmRing_maxPayloadSize(ring)) {
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	unsigned int index = 0;
+	uint32_t generation = 0;
+	for (;;) {
+		uint32_t seq = __atomic_load_n(&ring->freeSeq, __ATOMIC_ACQUIRE);
+		if (!rsaShmRing_isRunning(ring)) {
+			return CELIX_ILLEGAL_STATE; //note no slot claimed yet
+		}
+		if (rsaShmRing_claimSlot(ring, &index, &generation)) {
+			break;
+		}
+		if (rsaShmRing_futexWait(&ring->freeSeq, seq)) {
+			//no slot freed within the timeout, check for slots left behind by crashed processes
+			rsaShmRing_reclaimSlots(ring);
+		}
+	}
+
+	struct rsa_shm_slot *slot = rsaShmRing_slot(ring, index);
+	memcpy(slot->data, request, requestLength);
+	slot->data[requestLength] = '\0';
+	slot->length = (uint32_t)requestLength;
+	slot->replyStatus = 0;
+	__atomic_store_n(&slot->state, rsaShmRing_stateWord(generation, RSA_SHM_SLOT_REQUEST), __ATOMIC_RELEASE);
+	__atomic_fetch_add(&ring->requestSeq, 1, __ATOMIC_ACQ_REL);
+	rsaShmRing_futexWake(&ring->requestSeq, 1);
+
+	uint32_t word;
+	bool timedOut = false;
+	while (rsaShmRing_stateOf(word = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE)) != RSA_SHM_SLOT_REPLY) {
+		if (rsaShmRing_generationOf(word) != generation || rsaShmRing_stateOf(word) == RSA_SHM_SLOT_FREE) {
+			return CELIX_ILLEGAL_STATE; //slot reclaimed, because the handler died
+		}
+		bool handlerGone = timedOut && rsaShmRing_stateOf(word) == RSA_SHM_SLOT_PROCESSING && rsaShmRing_isUserGone(&slot->handler, generation);
+		if (!rsaShmRing_isRunning(ring) || handlerGone) {
+			rsaShmRing_cancelCall(ring, slot, generation);
+			return CELIX_ILLEGAL_STATE;
+		}
+		timedOut = rsaShmRing_futexWait(&slot->state, word);
+	}
+
+	celix_status_t status = CELIX_SUCCESS;
+	size_t length = slot->length;
+	*reply = malloc(length + 1);
+	if (*reply == NULL) {
+		status = CELIX_ENOMEM;
+	} else {
+		memcpy(*reply, slot->data, length);
+		(*reply)[length] = '\0';
+		*replyLength = length;
+		*replyStatus = slot->replyStatus;
+	}
+	rsaShmRing_releaseSlot(ring, slot, word);
+	return status;
+}
+
+celix_status_t rsaShmRing_takeRequest(rsa_shm_ring_t *ring, unsigned int *index, const char **request, size_t *requestLength) {
+	for (;;) {
+		uint32_t seq = __atomic_load_n(&ring->requestSeq, __ATOMIC_ACQUIRE);
+		if (!rsaShmRing_isRunning(ring)) {
+			return CELIX_ILLEGAL_STATE;
+		}
+		for (unsigned int i = 0; i < ring->nrOfSlots; ++i) {
+			struct rsa_shm_slot *slot = rsaShmRing_slot(ring, i);
+			uint32_t expected = __atomic_load_n(&slot->state, __ATOMIC_RELAXED);
+			if (rsaShmRing_stateOf(expected) != RSA_SHM_SLOT_REQUEST) {
+				continue;
+			}
+			uint32_t generation = rsaShmRing_generationOf(expected);
+			if (__atomic_compare_exchange_n(&slot->state, &expected, rsaShmRing_stateWord(generation, RSA_SHM_SLOT_PROCESSING), false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+				rsaShmRing_setUser(&slot->handler, generation);
+				*index = i;
+				*request = slot->data;
+				*requestLength = slot->length;
+				return CELIX_SUCCESS;
+			}
+		}
+		rsaShmRing_futexWait(&ring->requestSeq, seq);
+	}
+}
+
+celix_status_t rsaShmRing_reply(rsa_shm_ring_t *ring, unsigned int index, const char *reply, size_t replyLength, int replyStatus) {
+	celix_status_t status = CELIX_SUCCESS;
+	struct rsa_shm_slot *slot = rsaShmRing_slot(ring, index);
+	if (replyLength > rsaShmRing_maxPayloadSize(ring)) {
+		status = CELIX_ILLEGAL_ARGUMENT;
+		slot->length = 0;
+		slot->replyStatus = CELIX_ILLEGAL_ARGUMENT;
+	} else {
+		if (replyLength > 0) {
+			memcpy(slot->data, reply, replyLength);
+		}
+		slot->length = (uint32_t)replyLength;
+		slot->replyStatus = replyStatus;
+	}
+
+	for (;;) {
+		uint32_t word = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+		uint32_t generation = rsaShmRing_generationOf(word);
+		if (rsaShmRing_stateOf(word) == RSA_SHM_SLOT_PROCESSING) {
+			if (__atomic_compare_exchange_n(&slot->state, &word, rsaShmRing_stateWord(generation, RSA_SHM_SLOT_REPLY), false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+				rsaShmRing_futexWake(&slot->state, INT_MAX);
+				return status;
+			}
+		} else if (rsaShmRing_stateOf(word) == RSA_SHM_SLOT_ABANDONED) {
+			if (rsaShmRing_releaseSlot(ring, slot, word)) {
+				return CELIX_ILLEGAL_STATE;
+			}
+		} else {
+			return CELIX_ILLEGAL_STATE;
+		}
+	}
+}
+
+unsigned int rsaShmRing_reclaimSlots(rsa_shm_ring_t *ring) {
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < ring->nrOfSlots; ++i) {
+		struct rsa_shm_slot *slot = rsaShmRing_slot(ring, i);
+		uint32_t word = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+		uint32_t generation = rsaShmRing_generationOf(word);
+		bool release = false;
+		switch (rsaShmRing_stateOf(word)) {
+			case RSA_SHM_SLOT_CLAIMED:
+			case RSA_SHM_SLOT_REQUEST:
+			case RSA_SHM_SLOT_REPLY:
+				release = rsaShmRing_isUserGone(&slot->owner, generation);
+				break;
+			case RSA_SHM_SLOT_PROCESSING:
+				if (rsaShmRing_isUserGone(&slot->handler, generation)) {
+					release = true;
+				} else if (rsaShmRing_isUserGone(&slot->owner, generation)) {
+					//let the handler release the slot when replying
+					__atomic_compare_exchange_n(&slot->state, &word, rsaShmRing_stateWord(generation, RSA_SHM_SLOT_ABANDONED), false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+				}
+				break;
+			case RSA_SHM_SLOT_ABANDONED:
+				release = rsaShmRing_isUserGone(&slot->handler, generation);
+				break;
+			default:
+				break;
+		}
+		if (release && rsaShmRing_releaseSlot(ring, slot, word)) {
+			//wake up a (still living) caller waiting for the reply
+			rsaShmRing_futexWake(&slot->state, INT_MAX);
+			count += 1;
+		}
+	}
+	return count;
+}
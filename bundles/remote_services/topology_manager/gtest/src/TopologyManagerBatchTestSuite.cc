@@ -0,0 +1,319 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "celix_api.h"
+
+extern "C" {
+#include "celix_log_helper.h"
+#include "remote_constants.h"
+#include "remote_service_admin.h"
+#include "endpoint_listener.h"
+#include "topology_manager.h"
+}
+
+/**
+ * Tests the batching of imports and exports by the topology manager, using a fake remote service admin and
+ * endpoint listeners. Note the framework is started without a TOPOLOGY_MANAGER_BATCH_WINDOW config, so the
+ * default batch window is used.
+ */
+class TopologyManagerBatchTestSuite : public ::testing::Test {
+public:
+    struct FakeExport {
+        endpoint_description_t endpoint;
+    };
+
+    struct FakeListener {
+        TopologyManagerBatchTestSuite* test;
+        std::string name;
+        endpoint_listener_t svc;
+        long svcId;
+        service_reference_pt ref;
+    };
+
+    TopologyManagerBatchTestSuite() {
+        auto* props = celix_properties_create();
+        celix_properties_set(props, OSGI_FRAMEWORK_FRAMEWORK_STORAGE, ".tm_batch_test_cache");
+        celix_properties_set(props, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        fw = std::shared_ptr<celix_framework_t>{celix_frameworkFactory_createFramework(props), [](celix_framework_t* f) {
+            celix_frameworkFactory_destroyFramework(f);
+        }};
+        ctx = celix_framework_getFrameworkContext(fw.get());
+
+        logHelper = celix_logHelper_create(ctx, "test_tm_batch");
+        void* scope = nullptr;
+        EXPECT_EQ(CELIX_SUCCESS, topologyManager_create(ctx, logHelper, &tm, &scope));
+
+        rsa.admin = (remote_service_admin_t*)this;
+        rsa.exportService = exportService;
+        rsa.exportRegistration_close = exportRegistrationClose;
+        rsa.exportRegistration_getExportReference = getExportReference;
+        rsa.exportReference_getExportedEndpoint = getExportedEndpoint;
+        rsa.importService = importService;
+        rsa.importRegistration_close = importRegistrationClose;
+        topologyManager_rsaAdded(tm, nullptr, &rsa);
+
+        for (const char* name : {"listener1", "listener2"}) {
+            auto* listener = new FakeListener{};
+            listener->test = this;
+            listener->name = name;
+            listener->svc.handle = listener;
+            listener->svc.endpointAdded = endpointAdded;
+            listener->svc.endpointRemoved = endpointRemoved;
+            auto* svcProps = celix_properties_create();
+            celix_properties_set(svcProps, OSGI_ENDPOINT_LISTENER_SCOPE, "(service.exported.interfaces=*)");
+            listener->svcId = celix_bundleContext_registerService(ctx, &listener->svc, OSGI_ENDPOINT_LISTENER_SERVICE, svcProps);
+            listener->ref = getServiceReference(OSGI_ENDPOINT_LISTENER_SERVICE, listener->svcId);
+            topologyManager_endpointListenerAdded(tm, listener->ref, &listener->svc);
+            listeners.push_back(listener);
+        }
+    }
+
+    ~TopologyManagerBatchTestSuite() override {
+        for (auto* endpoint : endpoints) {
+            topologyManager_removeImportedService(tm, endpoint, nullptr);
+        }
+        for (auto& entry : exportedServices) {
+            topologyManager_removeExportedService(tm, entry.second, nullptr);
+            bundleContext_ungetServiceReference(ctx, entry.second);
+            celix_bundleContext_unregisterService(ctx, entry.first);
+        }
+        for (auto* listener : listeners) {
+            topologyManager_endpointListenerRemoved(tm, listener->ref, &listener->svc);
+            bundleContext_ungetService(ctx, listener->ref, nullptr);
+            bundleContext_ungetServiceReference(ctx, listener->ref);
+            celix_bundleContext_unregisterService(ctx, listener->svcId);
+            delete listener;
+        }
+        topologyManager_rsaRemoved(tm, nullptr, &rsa);
+        topologyManager_destroy(tm);
+        celix_logHelper_destroy(logHelper);
+
+        for (auto* endpoint : endpoints) {
+            celix_properties_destroy(endpoint->properties);
+            free(endpoint->id);
+            free(endpoint);
+        }
+        for (auto* export_ : exports) {
+            celix_properties_destroy(export_->endpoint.properties);
+            free(export_->endpoint.id);
+            delete export_;
+        }
+        for (auto* list : exportLists) {
+            arrayList_destroy(list);
+        }
+    }
+
+    service_reference_pt getServiceReference(const char* serviceName, long svcId) {
+        array_list_pt refs = nullptr;
+        std::string filter = std::string{"("} + OSGI_FRAMEWORK_SERVICE_ID + "=" + std::to_string(svcId) + ")";
+        bundleContext_getServiceReferences(ctx, serviceName, filter.c_str(), &refs);
+        EXPECT_EQ(1, arrayList_size(refs));
+        auto* ref = static_cast<service_reference_pt>(arrayList_get(refs, 0));
+        arrayList_destroy(refs);
+        return ref;
+    }
+
+    service_reference_pt registerExportedService(const std::string& name) {
+        auto* props = celix_properties_create();
+        celix_properties_set(props, OSGI_RSA_SERVICE_EXPORTED_INTERFACES, "*");
+        long svcId = celix_bundleContext_registerService(ctx, (void*)0x42, "test_service", props);
+        serviceNames[svcId] = name;
+        auto* ref = getServiceReference("test_service", svcId);
+        exportedServices[svcId] = ref;
+        return ref;
+    }
+
+    endpoint_description_t* createEndpoint(const std::string& id) {
+        auto* endpoint = (endpoint_description_t*)calloc(1, sizeof(endpoint_description_t));
+        endpoint->id = strdup(id.c_str());
+        endpoint->properties = celix_properties_create();
+        celix_properties_set(endpoint->properties, OSGI_RSA_ENDPOINT_ID, id.c_str());
+        endpoints.push_back(endpoint);
+        return endpoint;
+    }
+
+    void addEvent(const std::string& event) {
+        std::lock_guard<std::mutex> lock{mutex};
+        events.push_back(event);
+        cond.notify_all();
+    }
+
+    long count(const std::string& prefix) {
+        return std::count_if(events.begin(), events.end(), [&](const std::string& event) {
+            return event.compare(0, prefix.size(), prefix) == 0;
+        });
+    }
+
+    /**
+     * Waits until the expected number of events with the given prefix happened and returns a copy of all events.
+     */
+    std::vector<std::string> waitForEvents(const std::string& prefix, long expectedCount) {
+        std::unique_lock<std::mutex> lock{mutex};
+        bool found = cond.wait_for(lock, std::chrono::seconds{5}, [&]{ return count(prefix) >= expectedCount; });
+        EXPECT_TRUE(found) << "Timeout waiting for " << expectedCount << " '" << prefix << "' events";
+        return events;
+    }
+
+    static celix_status_t exportService(remote_service_admin_t* admin, char* serviceId, celix_properties_t* /*properties*/, array_list_pt* registrations) {
+        auto* test = (TopologyManagerBatchTestSuite*)admin;
+        auto* export_ = new FakeExport{};
+        std::string id = "export-" + test->serviceNames[atol(serviceId)];
+        export_->endpoint.id = strdup(id.c_str());
+        export_->endpoint.properties = celix_properties_create();
+        celix_properties_set(export_->endpoint.properties, OSGI_RSA_ENDPOINT_ID, id.c_str());
+        celix_properties_set(export_->endpoint.properties, OSGI_RSA_SERVICE_EXPORTED_INTERFACES, "*");
+        arrayList_create(registrations);
+        arrayList_add(*registrations, export_);
+        {
+            std::lock_guard<std::mutex> lock{test->mutex};
+            test->exports.push_back(export_);
+            test->exportLists.push_back(*registrations);
+        }
+        test->addEvent("exported " + id);
+        return CELIX_SUCCESS;
+    }
+
+    static celix_status_t exportRegistrationClose(remote_service_admin_t* admin, export_registration_t* registration) {
+        auto* test = (TopologyManagerBatchTestSuite*)admin;
+        test->addEvent(std::string{"closed "} + ((FakeExport*)registration)->endpoint.id);
+        return CELIX_SUCCESS;
+    }
+
+    static celix_status_t getExportReference(export_registration_t* registration, export_reference_t** reference) {
+        //note the topology manager frees the reference
+        auto** ref = (FakeExport**)malloc(sizeof(FakeExport*));
+        *ref = (FakeExport*)registration;
+        *reference = (export_reference_t*)ref;
+        return CELIX_SUCCESS;
+    }
+
+    static celix_status_t getExportedEndpoint(export_reference_t* reference, endpoint_description_t** endpoint) {
+        *endpoint = &(*(FakeExport**)reference)->endpoint;
+        return CELIX_SUCCESS;
+    }
+
+    static celix_status_t importService(remote_service_admin_t* admin, endpoint_description_t* endpoint, import_registration_t** registration) {
+        auto* test = (TopologyManagerBatchTestSuite*)admin;
+        *registration = (import_registration_t*)endpoint;
+        test->addEvent(std::string{"imported "} + endpoint->id);
+        return CELIX_SUCCESS;
+    }
+
+    static celix_status_t importRegistrationClose(remote_service_admin_t* admin, import_registration_t* registration) {
+        auto* test = (TopologyManagerBatchTestSuite*)admin;
+        test->addEvent(std::string{"closed "} + ((endpoint_description_t*)registration)->id);
+        return CELIX_SUCCESS;
+    }
+
+    static celix_status_t endpointAdded(void* handle, endpoint_description_t* endpoint, char* /*matchedFilter*/) {
+        auto* listener = (FakeListener*)handle;
+        listener->test->addEvent("added " + std::string{endpoint->id} + " to " + listener->name);
+        return CELIX_SUCCESS;
+    }
+
+    static celix_status_t endpointRemoved(void* handle, endpoint_description_t* endpoint, char* /*matchedFilter*/) {
+        auto* listener = (FakeListener*)handle;
+        listener->test->addEvent("removed " + std::string{endpoint->id} + " from " + listener->name);
+        return CELIX_SUCCESS;
+    }
+
+    std::shared_ptr<celix_framework_t> fw{};
+    celix_bundle_context_t* ctx{};
+    celix_log_helper_t* logHelper{};
+    topology_manager_t* tm{};
+    remote_service_admin_service_t rsa{};
+    std::vector<FakeListener*> listeners{};
+    std::map<long, service_reference_pt> exportedServices{};
+    std::map<long, std::string> serviceNames{};
+    std::vector<endpoint_description_t*> endpoints{};
+
+    std::mutex mutex{}; //protects below
+    std::condition_variable cond{};
+    std::vector<std::string> events{};
+    std::vector<FakeExport*> exports{};
+    std::vector<array_list_pt> exportLists{};
+};
+
+TEST_F(TopologyManagerBatchTestSuite, ApplyAllChangesOfOneWindow) {
+    for (const char* name : {"a", "b", "c"}) {
+        topologyManager_addExportedService(tm, registerExportedService(name), nullptr);
+        topologyManager_addImportedService(tm, createEndpoint(std::string{"import-"} + name), nullptr);
+    }
+
+    auto events = waitForEvents("added", 6);
+    events = waitForEvents("imported", 3);
+    for (const char* name : {"a", "b", "c"}) {
+        EXPECT_EQ(1, std::count(events.begin(), events.end(), std::string{"imported import-"} + name));
+        EXPECT_EQ(1, std::count(events.begin(), events.end(), std::string{"exported export-"} + name));
+        for (const char* listener : {"listener1", "listener2"}) {
+            EXPECT_EQ(1, std::count(events.begin(), events.end(), std::string{"added export-"} + name + " to " + listener));
+        }
+    }
+
+    //all services are exported before the endpoint listeners are notified, once for the whole batch
+    size_t lastExported = 0;
+    size_t firstAdded = events.size();
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events[i].compare(0, 8, "exported") == 0) {
+            lastExported = i;
+        } else if (events[i].compare(0, 5, "added") == 0) {
+            firstAdded = std::min(firstAdded, i);
+        }
+    }
+    EXPECT_LT(lastExported, firstAdded);
+}
+
+TEST_F(TopologyManagerBatchTestSuite, RemoveBeforeWindowEndsCancelsChange) {
+    auto* refA = registerExportedService("a");
+    auto* refB = registerExportedService("b");
+    auto* endpointA = createEndpoint("import-a");
+    auto* endpointB = createEndpoint("import-b");
+    topologyManager_addExportedService(tm, refA, nullptr);
+    topologyManager_addExportedService(tm, refB, nullptr);
+    topologyManager_addImportedService(tm, endpointA, nullptr);
+    topologyManager_addImportedService(tm, endpointB, nullptr);
+
+    //removed in the same batch window -> never exported/imported
+    topologyManager_removeExportedService(tm, refA, nullptr);
+    topologyManager_removeImportedService(tm, endpointA, nullptr);
+
+    auto events = waitForEvents("added", 2);
+    events = waitForEvents("imported", 1);
+    std::vector<std::string> expected{
+        "imported import-b",
+        "exported export-b",
+        "added export-b to listener1",
+        "added export-b to listener2",
+    };
+    std::sort(events.begin(), events.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(expected, events);
+}
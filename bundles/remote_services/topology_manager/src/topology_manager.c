@@ -39,6 +39,8 @@
 #include "filter.h"
 #include "listener_hook_service.h"
 #include "utils.h"
+#include "celix_utils.h"
+#include "celix_bundle_context.h"
 #include "service_reference.h"
 #include "service_registration.h"
 #include "celix_log_helper.h"
@@ -66,13 +68,32 @@ struct topology_manager {
 	scope_pt scope;
 
 	celix_log_helper_t *loghelper;
+
+	// changes collected by addImportedService/addExportedService, applied in batches by the batchThread
+	celix_thread_mutex_t pendingLock;
+	celix_thread_cond_t pendingCond;
+	hash_map_pt pendingImports; // key = endpoint_description_t*, value = same
+	hash_map_pt pendingExports; // key = service_reference_pt, value = same
+	long batchWindowInMs;
+	bool running;
+	celix_thread_t batchThread;
 };
 
+// the export registrations of one rsa, used to notify the endpoint listeners for a batch of exports at once
+typedef struct topology_manager_rsa_exports {
+	remote_service_admin_service_t *rsa;
+	array_list_pt registrations;
+} topology_manager_rsa_exports_t;
+
 celix_status_t topologyManager_exportScopeChanged(void *handle, char *service_name);
 celix_status_t topologyManager_importScopeChanged(void *handle, char *service_name);
-celix_status_t topologyManager_notifyListenersEndpointAdded(topology_manager_pt manager, remote_service_admin_service_t *rsa, array_list_pt registrations);
+celix_status_t topologyManager_notifyListenersEndpointsAdded(topology_manager_pt manager, array_list_pt rsaExports);
 celix_status_t topologyManager_notifyListenersEndpointRemoved(topology_manager_pt manager, remote_service_admin_service_t *rsa, export_registration_t *export);
 
+static void* topologyManager_batchThread(void *data);
+static celix_status_t topologyManager_importEndpoints(topology_manager_pt manager, array_list_pt endpoints);
+static celix_status_t topologyManager_exportServices(topology_manager_pt manager, array_list_pt references);
+
 celix_status_t topologyManager_create(celix_bundle_context_t *context, celix_log_helper_t *logHelper, topology_manager_pt *manager, void **scope) {
 	celix_status_t status = CELIX_SUCCESS;
 
@@ -110,6 +131,16 @@ celix_status_t topologyManager_create(celix_bundle_context_t *context, celix_log
 
 	(*manager)->loghelper = logHelper;
 
+	celixThreadMutex_create(&(*manager)->pendingLock, NULL);
+	celixThreadCondition_init(&(*manager)->pendingCond, NULL);
+	(*manager)->pendingImports = hashMap_create(NULL, NULL, NULL, NULL);
+	(*manager)->pendingExports = hashMap_create(NULL, NULL, NULL, NULL);
+	(*manager)->batchWindowInMs = celix_bundleContext_getPropertyAsLong(context, TOPOLOGY_MANAGER_BATCH_WINDOW_KEY, TOPOLOGY_MANAGER_BATCH_WINDOW_DEFAULT);
+	(*manager)->running = (*manager)->batchWindowInMs > 0;
+	if ((*manager)->running) {
+		celixThread_create(&(*manager)->batchThread, NULL, topologyManager_batchThread, *manager);
+		celixThread_setName(&(*manager)->batchThread, "TM batch");
+	}
 
 	return status;
 }
@@ -117,6 +148,19 @@ celix_status_t topologyManager_create(celix_bundle_context_t *context, celix_log
 celix_status_t topologyManager_destroy(topology_manager_pt manager) {
 	celix_status_t status = CELIX_SUCCESS;
 
+	celixThreadMutex_lock(&manager->pendingLock);
+	bool running = manager->running;
+	manager->running = false;
+	celixThreadCondition_broadcast(&manager->pendingCond);
+	celixThreadMutex_unlock(&manager->pendingLock);
+	if (running) {
+		celixThread_join(manager->batchThread, NULL);
+	}
+	hashMap_destroy(manager->pendingImports, false, false);
+	hashMap_destroy(manager->pendingExports, false, false);
+	celixThreadCondition_destroy(&manager->pendingCond);
+	celixThreadMutex_destroy(&manager->pendingLock);
+
 	celixThreadMutex_lock(&manager->listenerListLock);
 	hashMap_destroy(manager->listenerList, false, false);
 
@@ -157,6 +201,11 @@ celix_status_t topologyManager_closeImports(topology_manager_pt manager) {
 
 	status = celixThreadMutex_lock(&manager->importedServicesLock);
 
+	// drop the not yet imported endpoints, the endpoint descriptions are owned by discovery
+	celixThreadMutex_lock(&manager->pendingLock);
+	hashMap_clear(manager->pendingImports, false, false);
+	celixThreadMutex_unlock(&manager->pendingLock);
+
 	hash_map_iterator_pt iter = hashMapIterator_create(manager->importedServices);
 	while (hashMapIterator_hasNext(iter)) {
 		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
@@ -240,6 +289,8 @@ celix_status_t topologyManager_rsaAdded(void * handle, service_reference_pt unus
 
 	// add already exported services to new rsa
     celixThreadMutex_lock(&manager->exportedServicesLock);
+    array_list_pt rsaExports = NULL;
+    arrayList_create(&rsaExports);
     hash_map_iterator_pt exportedServicesIterator = hashMapIterator_create(manager->exportedServices);
 
     while (hashMapIterator_hasNext(exportedServicesIterator)) {
@@ -263,11 +314,22 @@ celix_status_t topologyManager_rsaAdded(void * handle, service_reference_pt unus
             }
 
             hashMap_put(exports, rsa, endpoints);
-            topologyManager_notifyListenersEndpointAdded(manager, rsa, endpoints);
+
+            topology_manager_rsa_exports_t *rsaExport = calloc(1, sizeof(*rsaExport));
+            rsaExport->rsa = rsa;
+            rsaExport->registrations = endpoints;
+            arrayList_add(rsaExports, rsaExport);
         }
     }
 
     hashMapIterator_destroy(exportedServicesIterator);
+
+    topologyManager_notifyListenersEndpointsAdded(manager, rsaExports);
+    for (int i = 0; i < arrayList_size(rsaExports); i++) {
+        free(arrayList_get(rsaExports, i));
+    }
+    arrayList_destroy(rsaExports);
+
     celixThreadMutex_unlock(&manager->exportedServicesLock);
 	return CELIX_SUCCESS;
 }
@@ -475,35 +537,72 @@ celix_status_t topologyManager_addImportedService(void *handle, endpoint_descrip
 	celix_status_t status = CELIX_SUCCESS;
 	topology_manager_pt manager = handle;
 
-	celix_logHelper_log(manager->loghelper, CELIX_LOG_LEVEL_INFO, "TOPOLOGY_MANAGER: Add imported service (%s; %s).", endpoint->service, endpoint->id);
+	celixThreadMutex_lock(&manager->pendingLock);
+	bool batched = manager->running;
+	if (batched) {
+		hashMap_put(manager->pendingImports, endpoint, endpoint);
+		celixThreadCondition_broadcast(&manager->pendingCond);
+	}
+	celixThreadMutex_unlock(&manager->pendingLock);
+
+	if (!batched && celixThreadMutex_lock(&manager->importedServicesLock) == CELIX_SUCCESS) {
+		array_list_pt endpoints = NULL;
+		arrayList_create(&endpoints);
+		arrayList_add(endpoints, endpoint);
+		status = topologyManager_importEndpoints(manager, endpoints);
+		arrayList_destroy(endpoints);
+		celixThreadMutex_unlock(&manager->importedServicesLock);
+	}
 
-	if (celixThreadMutex_lock(&manager->importedServicesLock) == CELIX_SUCCESS) {
+	return status;
+}
+
+/**
+ * Imports the endpoints with all RSAs, taking the rsaListLock once for the whole batch.
+ * Note the importedServicesLock must be taken.
+ */
+static celix_status_t topologyManager_importEndpoints(topology_manager_pt manager, array_list_pt endpoints) {
+	celix_status_t status = CELIX_SUCCESS;
+	int nrOfEndpoints = arrayList_size(endpoints);
+	hash_map_pt *imports = calloc(nrOfEndpoints, sizeof(*imports));
+	bool *allowed = calloc(nrOfEndpoints, sizeof(*allowed));
+	bool anyAllowed = false;
+
+	for (int i = 0; i < nrOfEndpoints; i++) {
+		endpoint_description_t *endpoint = arrayList_get(endpoints, i);
+
+		celix_logHelper_log(manager->loghelper, CELIX_LOG_LEVEL_INFO, "TOPOLOGY_MANAGER: Add imported service (%s; %s).", endpoint->service, endpoint->id);
 
-		hash_map_pt imports = hashMap_create(NULL, NULL, NULL, NULL);
-		hashMap_put(manager->importedServices, endpoint, imports);
+		imports[i] = hashMap_create(NULL, NULL, NULL, NULL);
+		hashMap_put(manager->importedServices, endpoint, imports[i]);
 
-		if (scope_allowImport(manager->scope, endpoint)) {
-			if (celixThreadMutex_lock(&manager->rsaListLock) == CELIX_SUCCESS) {
-				int size = arrayList_size(manager->rsaList);
+		allowed[i] = scope_allowImport(manager->scope, endpoint);
+		anyAllowed = anyAllowed || allowed[i];
+	}
+
+	if (anyAllowed && celixThreadMutex_lock(&manager->rsaListLock) == CELIX_SUCCESS) {
+		int size = arrayList_size(manager->rsaList);
+
+		for (int iter = 0; iter < size; iter++) {
+			remote_service_admin_service_t *rsa = arrayList_get(manager->rsaList, iter);
 
-				for (int iter = 0; iter < size; iter++) {
+			for (int i = 0; i < nrOfEndpoints; i++) {
+				if (allowed[i]) {
 					import_registration_t *import = NULL;
-					remote_service_admin_service_t *rsa = arrayList_get(manager->rsaList, iter);
-					celix_status_t substatus = rsa->importService(rsa->admin, endpoint, &import);
+					celix_status_t substatus = rsa->importService(rsa->admin, arrayList_get(endpoints, i), &import);
 					if (substatus == CELIX_SUCCESS) {
-						hashMap_put(imports, rsa, import);
+						hashMap_put(imports[i], rsa, import);
 					} else {
 						status = substatus;
 					}
 				}
-				celixThreadMutex_unlock(&manager->rsaListLock);
 			}
-
 		}
-
-		celixThreadMutex_unlock(&manager->importedServicesLock);
+		celixThreadMutex_unlock(&manager->rsaListLock);
 	}
 
+	free(imports);
+	free(allowed);
 
 	return status;
 }
@@ -514,7 +613,12 @@ celix_status_t topologyManager_removeImportedService(void *handle, endpoint_desc
 
 	celix_logHelper_log(manager->loghelper, CELIX_LOG_LEVEL_INFO, "TOPOLOGY_MANAGER: Remove imported service (%s; %s).", endpoint->service, endpoint->id);
 
-	if (celixThreadMutex_lock(&manager->importedServicesLock) == CELIX_SUCCESS) {
+	// not imported yet -> only cancel the pending import
+	celixThreadMutex_lock(&manager->pendingLock);
+	bool pending = hashMap_remove(manager->pendingImports, endpoint) != NULL;
+	celixThreadMutex_unlock(&manager->pendingLock);
+
+	if (!pending && celixThreadMutex_lock(&manager->importedServicesLock) == CELIX_SUCCESS) {
 
 		hash_map_iterator_pt iter = hashMapIterator_create(manager->importedServices);
 		while (hashMapIterator_hasNext(iter)) {
@@ -552,46 +656,95 @@ celix_status_t topologyManager_removeImportedService(void *handle, endpoint_desc
 celix_status_t topologyManager_addExportedService(void * handle, service_reference_pt reference, void * service __attribute__((unused))) {
     topology_manager_pt manager = handle;
 	celix_status_t status = CELIX_SUCCESS;
-    long serviceId = serviceReference_getServiceId(reference);
-    char serviceIdStr[64];
-    snprintf(serviceIdStr, 64, "%li", serviceId);
-	celix_properties_t *serviceProperties = NULL;
 
 	const char *export = NULL;
     serviceReference_getProperty(reference, OSGI_RSA_SERVICE_EXPORTED_INTERFACES, &export);
     assert(export != NULL);
 
-	celix_logHelper_log(manager->loghelper, CELIX_LOG_LEVEL_INFO, "TOPOLOGY_MANAGER: Add exported service (%li).", serviceId);
+	celixThreadMutex_lock(&manager->pendingLock);
+	bool batched = manager->running;
+	if (batched) {
+		hashMap_put(manager->pendingExports, reference, reference);
+		celixThreadCondition_broadcast(&manager->pendingCond);
+	}
+	celixThreadMutex_unlock(&manager->pendingLock);
+
+	if (!batched && celixThreadMutex_lock(&manager->exportedServicesLock) == CELIX_SUCCESS) {
+		array_list_pt references = NULL;
+		arrayList_create(&references);
+		arrayList_add(references, reference);
+		status = topologyManager_exportServices(manager, references);
+		arrayList_destroy(references);
+		celixThreadMutex_unlock(&manager->exportedServicesLock);
+	}
 
-	if (celixThreadMutex_lock(&manager->exportedServicesLock) == CELIX_SUCCESS) {
-		scope_getExportProperties(manager->scope, reference, &serviceProperties);
-		hash_map_pt exports = hashMap_create(NULL, NULL, NULL, NULL);
-		hashMap_put(manager->exportedServices, reference, exports);
+	return status;
+}
 
-		if (celixThreadMutex_lock(&manager->rsaListLock) == CELIX_SUCCESS) {
-			int size = arrayList_size(manager->rsaList);
+/**
+ * Exports the services with all RSAs and notifies the endpoint listeners once for all created endpoints.
+ * Note the exportedServicesLock must be taken.
+ */
+static celix_status_t topologyManager_exportServices(topology_manager_pt manager, array_list_pt references) {
+	celix_status_t status = CELIX_SUCCESS;
+	int nrOfServices = arrayList_size(references);
+	hash_map_pt *exports = calloc(nrOfServices, sizeof(*exports));
+	celix_properties_t **serviceProperties = calloc(nrOfServices, sizeof(*serviceProperties));
+	char (*serviceIds)[64] = calloc(nrOfServices, sizeof(*serviceIds));
+	array_list_pt rsaExports = NULL;
 
-			if (size == 0) {
-				celix_logHelper_log(manager->loghelper, CELIX_LOG_LEVEL_WARNING, "TOPOLOGY_MANAGER: No RSA available yet.");
-			}
+	arrayList_create(&rsaExports);
+
+	for (int i = 0; i < nrOfServices; i++) {
+		service_reference_pt reference = arrayList_get(references, i);
+		long serviceId = serviceReference_getServiceId(reference);
+		snprintf(serviceIds[i], sizeof(serviceIds[i]), "%li", serviceId);
+
+		celix_logHelper_log(manager->loghelper, CELIX_LOG_LEVEL_INFO, "TOPOLOGY_MANAGER: Add exported service (%li).", serviceId);
+
+		scope_getExportProperties(manager->scope, reference, &serviceProperties[i]);
+		exports[i] = hashMap_create(NULL, NULL, NULL, NULL);
+		hashMap_put(manager->exportedServices, reference, exports[i]);
+	}
+
+	if (celixThreadMutex_lock(&manager->rsaListLock) == CELIX_SUCCESS) {
+		int size = arrayList_size(manager->rsaList);
 
-			for (int iter = 0; iter < size; iter++) {
-				remote_service_admin_service_t *rsa = arrayList_get(manager->rsaList, iter);
+		if (size == 0) {
+			celix_logHelper_log(manager->loghelper, CELIX_LOG_LEVEL_WARNING, "TOPOLOGY_MANAGER: No RSA available yet.");
+		}
+
+		for (int iter = 0; iter < size; iter++) {
+			remote_service_admin_service_t *rsa = arrayList_get(manager->rsaList, iter);
 
+			for (int i = 0; i < nrOfServices; i++) {
 				array_list_pt endpoints = NULL;
-				celix_status_t substatus = rsa->exportService(rsa->admin, serviceIdStr, serviceProperties, &endpoints);
+				celix_status_t substatus = rsa->exportService(rsa->admin, serviceIds[i], serviceProperties[i], &endpoints);
 
 				if (substatus == CELIX_SUCCESS) {
-					hashMap_put(exports, rsa, endpoints);
-					topologyManager_notifyListenersEndpointAdded(manager, rsa, endpoints);
+					hashMap_put(exports[i], rsa, endpoints);
+
+					topology_manager_rsa_exports_t *rsaExport = calloc(1, sizeof(*rsaExport));
+					rsaExport->rsa = rsa;
+					rsaExport->registrations = endpoints;
+					arrayList_add(rsaExports, rsaExport);
 				} else {
 					status = substatus;
 				}
 			}
-			celixThreadMutex_unlock(&manager->rsaListLock);
 		}
-		celixThreadMutex_unlock(&manager->exportedServicesLock);
+		celixThreadMutex_unlock(&manager->rsaListLock);
+	}
+
+	topologyManager_notifyListenersEndpointsAdded(manager, rsaExports);
+
+	for (int i = 0; i < arrayList_size(rsaExports); i++) {
+		free(arrayList_get(rsaExports, i));
 	}
+	arrayList_destroy(rsaExports);
+	free(exports);
+	free(serviceProperties);
+	free(serviceIds);
 
 	return status;
 }
@@ -603,7 +756,12 @@ celix_status_t topologyManager_removeExportedService(void * handle, service_refe
 
 	celix_logHelper_log(manager->loghelper, CELIX_LOG_LEVEL_INFO, "TOPOLOGY_MANAGER: Remove exported service (%li).", serviceId);
 
-	if (celixThreadMutex_lock(&manager->exportedServicesLock) == CELIX_SUCCESS) {
+	// not exported yet -> only cancel the pending export
+	celixThreadMutex_lock(&manager->pendingLock);
+	bool pending = hashMap_remove(manager->pendingExports, reference) != NULL;
+	celixThreadMutex_unlock(&manager->pendingLock);
+
+	if (!pending && celixThreadMutex_lock(&manager->exportedServicesLock) == CELIX_SUCCESS) {
 		hash_map_pt exports = hashMap_get(manager->exportedServices, reference);
 		if (exports) {
 			hash_map_iterator_pt iter = hashMapIterator_create(exports);
@@ -745,9 +903,13 @@ celix_status_t topologyManager_endpointListenerRemoved(void * handle, service_re
 	return status;
 }
 
-celix_status_t topologyManager_notifyListenersEndpointAdded(topology_manager_pt manager, remote_service_admin_service_t *rsa, array_list_pt registrations) {
+celix_status_t topologyManager_notifyListenersEndpointsAdded(topology_manager_pt manager, array_list_pt rsaExports) {
 	celix_status_t status = CELIX_SUCCESS;
 
+	if (arrayList_size(rsaExports) == 0) {
+		return status;
+	}
+
 	if (celixThreadMutex_lock(&manager->listenerListLock) == CELIX_SUCCESS) {
 
 		hash_map_iterator_pt iter = hashMapIterator_create(manager->listenerList);
@@ -760,21 +922,25 @@ celix_status_t topologyManager_notifyListenersEndpointAdded(topology_manager_pt
 
 			status = bundleContext_getService(manager->context, reference, (void **) &epl);
 			if (status == CELIX_SUCCESS) {
+				// the scope filter is created once per listener for the whole batch
 				filter_pt filter = filter_create(scope);
 
-				int regSize = arrayList_size(registrations);
-				for (int regIt = 0; regIt < regSize; regIt++) {
-					export_registration_t *export = arrayList_get(registrations, regIt);
-					endpoint_description_t *endpoint = NULL;
-					celix_status_t substatus = topologyManager_getEndpointDescriptionForExportRegistration(rsa, export, &endpoint);
-					if (substatus == CELIX_SUCCESS) {
-						bool matchResult = false;
-						filter_match(filter, endpoint->properties, &matchResult);
-						if (matchResult) {
-							status = epl->endpointAdded(epl->handle, endpoint, (char*)scope);
+				for (int exportIt = 0; exportIt < arrayList_size(rsaExports); exportIt++) {
+					topology_manager_rsa_exports_t *rsaExport = arrayList_get(rsaExports, exportIt);
+					int regSize = arrayList_size(rsaExport->registrations);
+					for (int regIt = 0; regIt < regSize; regIt++) {
+						export_registration_t *export = arrayList_get(rsaExport->registrations, regIt);
+						endpoint_description_t *endpoint = NULL;
+						celix_status_t substatus = topologyManager_getEndpointDescriptionForExportRegistration(rsaExport->rsa, export, &endpoint);
+						if (substatus == CELIX_SUCCESS) {
+							bool matchResult = false;
+							filter_match(filter, endpoint->properties, &matchResult);
+							if (matchResult) {
+								status = epl->endpointAdded(epl->handle, endpoint, (char*)scope);
+							}
+						} else {
+							status = substatus;
 						}
-					} else {
-						status = substatus;
 					}
 				}
 				filter_destroy(filter);
@@ -941,3 +1107,79 @@ celix_status_t topologyManager_listenerRemoved(void *handle, array_list_pt liste
 	return status;
 }
 
+static void topologyManager_applyPendingImports(topology_manager_pt manager) {
+	// the pending imports are taken while holding the importedServicesLock, so that a removeImportedService
+	// for an endpoint in this batch waits until the batch is applied.
+	celixThreadMutex_lock(&manager->importedServicesLock);
+	celixThreadMutex_lock(&manager->pendingLock);
+	hash_map_pt pending = manager->pendingImports;
+	manager->pendingImports = hashMap_create(NULL, NULL, NULL, NULL);
+	celixThreadMutex_unlock(&manager->pendingLock);
+
+	if (hashMap_size(pending) > 0) {
+		array_list_pt endpoints = NULL;
+		arrayList_create(&endpoints);
+		hash_map_iterator_t iter = hashMapIterator_construct(pending);
+		while (hashMapIterator_hasNext(&iter)) {
+			arrayList_add(endpoints, hashMapIterator_nextKey(&iter));
+		}
+		topologyManager_importEndpoints(manager, endpoints);
+		arrayList_destroy(endpoints);
+	}
+
+	celixThreadMutex_unlock(&manager->importedServicesLock);
+	hashMap_destroy(pending, false, false);
+}
+
+static void topologyManager_applyPendingExports(topology_manager_pt manager) {
+	// see topologyManager_applyPendingImports
+	celixThreadMutex_lock(&manager->exportedServicesLock);
+	celixThreadMutex_lock(&manager->pendingLock);
+	hash_map_pt pending = manager->pendingExports;
+	manager->pendingExports = hashMap_create(NULL, NULL, NULL, NULL);
+	celixThreadMutex_unlock(&manager->pendingLock);
+
+	if (hashMap_size(pending) > 0) {
+		array_list_pt references = NULL;
+		arrayList_create(&references);
+		hash_map_iterator_t iter = hashMapIterator_construct(pending);
+		while (hashMapIterator_hasNext(&iter)) {
+			arrayList_add(references, hashMapIterator_nextKey(&iter));
+		}
+		topologyManager_exportServices(manager, references);
+		arrayList_destroy(references);
+	}
+
+	celixThreadMutex_unlock(&manager->exportedServicesLock);
+	hashMap_destroy(pending, false, false);
+}
+
+static void* topologyManager_batchThread(void *data) {
+	topology_manager_pt manager = data;
+
+	celixThreadMutex_lock(&manager->pendingLock);
+	while (manager->running) {
+		if (hashMap_size(manager->pendingImports) == 0 && hashMap_size(manager->pendingExports) == 0) {
+			celixThreadCondition_wait(&manager->pendingCond, &manager->pendingLock);
+			continue;
+		}
+
+		// collect more changes during the batch window
+		struct timespec start = celix_gettime(CLOCK_MONOTONIC);
+		double remaining = manager->batchWindowInMs / 1000.0;
+		while (manager->running && remaining > 0) {
+			long seconds = (long) remaining;
+			celixThreadCondition_timedwaitRelative(&manager->pendingCond, &manager->pendingLock, seconds, (long) ((remaining - seconds) * 1000000000.0));
+			remaining = manager->batchWindowInMs / 1000.0 - celix_elapsedtime(CLOCK_MONOTONIC, start);
+		}
+		celixThreadMutex_unlock(&manager->pendingLock);
+
+		topologyManager_applyPendingImports(manager);
+		topologyManager_applyPendingExports(manager);
+
+		celixThreadMutex_lock(&manager->pendingLock);
+	}
+	celixThreadMutex_unlock(&manager->pendingLock);
+
+	return NULL;
+}
@@ -35,6 +35,13 @@
 
 #define OSGI_RSA_REMOTE_SERVICE_ADMIN "remote_service_admin"
 
+/**
+ * Time (in ms) changes (imported endpoints and exported services) are collected, before they are
+ * applied as one batch. 0 means every change is applied directly.
+ */
+#define TOPOLOGY_MANAGER_BATCH_WINDOW_KEY       "TOPOLOGY_MANAGER_BATCH_WINDOW"
+#define TOPOLOGY_MANAGER_BATCH_WINDOW_DEFAULT   20
+
 typedef struct topology_manager topology_manager_t;
 typedef struct topology_manager *topology_manager_pt;
 
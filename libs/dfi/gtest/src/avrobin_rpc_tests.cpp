@@ -0,0 +1,321 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "dyn_common.h"
+#include "dyn_type.h"
+#include "dyn_interface.h"
+#include "avrobin_serializer.h"
+#include "avrobin_rpc.h"
+
+static void stdLog(void*, int level, const char *file, int line, const char *msg, ...) {
+    va_list ap;
+    const char *levels[5] = {"NIL", "ERROR", "WARNING", "INFO", "DEBUG"};
+    fprintf(stderr, "%s: FILE:%s, LINE:%i, MSG:",levels[level], file, line);
+    va_start(ap, msg);
+    vfprintf(stderr, msg, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+}
+
+static int avrobinRpcTest_add(void*, double a, double b, double *result) {
+    *result = a + b;
+    return 0;
+}
+
+static int avrobinRpcTest_sub(void*, double, double, double *) {
+    return 42; //note used to test an error status
+}
+
+struct avrobinRpcTest_seq {
+    uint32_t cap;
+    uint32_t len;
+    double *buf;
+};
+
+struct avrobinRpcTest_statsResult {
+    double average;
+    double min;
+    double max;
+    struct avrobinRpcTest_seq input;
+};
+
+static int avrobinRpcTest_stats(void*, struct avrobinRpcTest_seq input, struct avrobinRpcTest_statsResult **out) {
+    auto result = static_cast<avrobinRpcTest_statsResult*>(calloc(1, sizeof(avrobinRpcTest_statsResult)));
+    double total = 0.0;
+    result->min = input.len > 0 ? input.buf[0] : 0.0;
+    result->max = result->min;
+    for (uint32_t i = 0; i < input.len; ++i) {
+        total += input.buf[i];
+        result->min = input.buf[i] < result->min ? input.buf[i] : result->min;
+        result->max = input.buf[i] > result->max ? input.buf[i] : result->max;
+    }
+    result->average = input.len > 0 ? total / input.len : 0.0;
+    result->input.buf = static_cast<double*>(calloc(input.len, sizeof(double)));
+    memcpy(result->input.buf, input.buf, input.len * sizeof(double));
+    result->input.len = input.len;
+    result->input.cap = input.len;
+    *out = result;
+    return 0;
+}
+
+static int avrobinRpcTest_getName(void*, char** result) {
+    *result = strdup("allocatedInFunction");
+    return 0;
+}
+
+struct avrobinRpcTest_calculator {
+    void *handle;
+    int (*add)(void *, double, double, double *);
+    int (*sub)(void *, double, double, double *);
+    int (*sqrt)(void *, double, double *);
+    int (*stats)(void *, struct avrobinRpcTest_seq, struct avrobinRpcTest_statsResult **);
+};
+
+struct avrobinRpcTest_example4 {
+    void *handle;
+    int (*getName)(void *, char** name);
+};
+
+static dyn_interface_type* avrobinRpcTest_parseInterface(const char *file) {
+    dyn_interface_type *intf = nullptr;
+    FILE *desc = fopen(file, "r");
+    if (desc != nullptr) {
+        dynInterface_parse(desc, &intf);
+        fclose(desc);
+    }
+    return intf;
+}
+
+static struct method_entry* avrobinRpcTest_findMethod(dyn_interface_type *intf, const char *name) {
+    struct methods_head *head = nullptr;
+    dynInterface_methods(intf, &head);
+    struct method_entry *entry = nullptr;
+    TAILQ_FOREACH(entry, head, entries) {
+        if (strcmp(entry->name, name) == 0) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+}
+
+class AvrobinRpcTests : public ::testing::Test {
+public:
+    AvrobinRpcTests() {
+        int lvl = 1;
+        dynCommon_logSetup(stdLog, nullptr, lvl);
+        dynType_logSetup(stdLog, nullptr,lvl);
+        dynFunction_logSetup(stdLog, nullptr,lvl);
+        dynInterface_logSetup(stdLog, nullptr,lvl);
+        avrobinSerializer_logSetup(stdLog, nullptr, lvl);
+        avrobinRpc_logSetup(stdLog, nullptr, lvl);
+    }
+    ~AvrobinRpcTests() override = default;
+};
+
+TEST_F(AvrobinRpcTests, MethodIdIsStable) {
+    EXPECT_EQ(avrobinRpc_methodId("add(DD)D"), avrobinRpc_methodId("add(DD)D"));
+    EXPECT_NE(avrobinRpc_methodId("add(DD)D"), avrobinRpc_methodId("sub(DD)D"));
+}
+
+TEST_F(AvrobinRpcTests, CallPreAllocatedOutput) {
+    dyn_interface_type *intf = avrobinRpcTest_parseInterface("descriptors/example1.descriptor");
+    ASSERT_TRUE(intf != nullptr);
+    struct method_entry *entry = avrobinRpcTest_findMethod(intf, "add");
+    ASSERT_TRUE(entry != nullptr);
+
+    void *handle = nullptr;
+    double a = 1.0;
+    double b = 2.0;
+    double result = 0.0;
+    void *out = &result;
+    void *args[4] = {&handle, &a, &b, &out};
+
+    uint8_t *request = nullptr;
+    size_t requestLength = 0;
+    int rc = avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, &request, &requestLength);
+    ASSERT_EQ(0, rc);
+
+    avrobinRpcTest_calculator serv {nullptr, avrobinRpcTest_add, nullptr, nullptr, nullptr};
+    uint8_t *reply = nullptr;
+    size_t replyLength = 0;
+    rc = avrobinRpc_call(intf, &serv, request, requestLength, &reply, &replyLength);
+    ASSERT_EQ(0, rc);
+
+    rc = avrobinRpc_handleReply(entry->dynFunc, reply, replyLength, args);
+    ASSERT_EQ(0, rc);
+    EXPECT_EQ(3.0, result);
+
+    free(request);
+    free(reply);
+    dynInterface_destroy(intf);
+}
+
+TEST_F(AvrobinRpcTests, CallWithErrorStatus) {
+    dyn_interface_type *intf = avrobinRpcTest_parseInterface("descriptors/example1.descriptor");
+    ASSERT_TRUE(intf != nullptr);
+    struct method_entry *entry = avrobinRpcTest_findMethod(intf, "sub");
+    ASSERT_TRUE(entry != nullptr);
+
+    void *handle = nullptr;
+    double a = 1.0;
+    double b = 2.0;
+    double result = 0.0;
+    void *out = &result;
+    void *args[4] = {&handle, &a, &b, &out};
+
+    uint8_t *request = nullptr;
+    size_t requestLength = 0;
+    int rc = avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, &request, &requestLength);
+    ASSERT_EQ(0, rc);
+
+    avrobinRpcTest_calculator serv {nullptr, nullptr, avrobinRpcTest_sub, nullptr, nullptr};
+    uint8_t *reply = nullptr;
+    size_t replyLength = 0;
+    rc = avrobinRpc_call(intf, &serv, request, requestLength, &reply, &replyLength);
+    ASSERT_EQ(0, rc);
+    ASSERT_EQ(8, replyLength); //status + empty result
+    EXPECT_EQ(42, reply[3]);
+
+    rc = avrobinRpc_handleReply(entry->dynFunc, reply, replyLength, args);
+    ASSERT_EQ(0, rc);
+    EXPECT_EQ(0.0, result);
+
+    free(request);
+    free(reply);
+    dynInterface_destroy(intf);
+}
+
+TEST_F(AvrobinRpcTests, CallOutput) {
+    dyn_interface_type *intf = avrobinRpcTest_parseInterface("descriptors/example1.descriptor");
+    ASSERT_TRUE(intf != nullptr);
+    struct method_entry *entry = avrobinRpcTest_findMethod(intf, "stats");
+    ASSERT_TRUE(entry != nullptr);
+
+    void *handle = nullptr;
+    double values[3] = {1.0, 2.0, 3.0};
+    avrobinRpcTest_seq input {3, 3, values};
+    avrobinRpcTest_statsResult *result = nullptr;
+    void *out = &result;
+    void *args[3] = {&handle, &input, &out};
+
+    uint8_t *request = nullptr;
+    size_t requestLength = 0;
+    int rc = avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, &request, &requestLength);
+    ASSERT_EQ(0, rc);
+
+    avrobinRpcTest_calculator serv {nullptr, nullptr, nullptr, nullptr, avrobinRpcTest_stats};
+    uint8_t *reply = nullptr;
+    size_t replyLength = 0;
+    rc = avrobinRpc_call(intf, &serv, request, requestLength, &reply, &replyLength);
+    ASSERT_EQ(0, rc);
+
+    rc = avrobinRpc_handleReply(entry->dynFunc, reply, replyLength, args);
+    ASSERT_EQ(0, rc);
+    ASSERT_TRUE(result != nullptr);
+    EXPECT_EQ(2.0, result->average);
+    EXPECT_EQ(1.0, result->min);
+    EXPECT_EQ(3.0, result->max);
+    ASSERT_EQ(3, result->input.len);
+    EXPECT_EQ(3.0, result->input.buf[2]);
+
+    free(result->input.buf);
+    free(result);
+    free(request);
+    free(reply);
+    dynInterface_destroy(intf);
+}
+
+TEST_F(AvrobinRpcTests, CallOutputText) {
+    dyn_interface_type *intf = avrobinRpcTest_parseInterface("descriptors/example4.descriptor");
+    ASSERT_TRUE(intf != nullptr);
+    struct method_entry *entry = avrobinRpcTest_findMethod(intf, "getName");
+    ASSERT_TRUE(entry != nullptr);
+
+    void *handle = nullptr;
+    char *result = nullptr;
+    void *out = &result;
+    void *args[2] = {&handle, &out};
+
+    uint8_t *request = nullptr;
+    size_t requestLength = 0;
+    int rc = avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, &request, &requestLength);
+    ASSERT_EQ(0, rc);
+
+    avrobinRpcTest_example4 serv {nullptr, avrobinRpcTest_getName};
+    uint8_t *reply = nullptr;
+    size_t replyLength = 0;
+    rc = avrobinRpc_call(intf, &serv, request, requestLength, &reply, &replyLength);
+    ASSERT_EQ(0, rc);
+
+    rc = avrobinRpc_handleReply(entry->dynFunc, reply, replyLength, args);
+    ASSERT_EQ(0, rc);
+    ASSERT_STREQ("allocatedInFunction", result);
+
+    free(result);
+    free(request);
+    free(reply);
+    dynInterface_destroy(intf);
+}
+
+TEST_F(AvrobinRpcTests, CallUnknownMethod) {
+    dyn_interface_type *intf = avrobinRpcTest_parseInterface("descriptors/example1.descriptor");
+    ASSERT_TRUE(intf != nullptr);
+
+    const uint8_t request[8] = {0xde, 0xad, 0xbe, 0xef, 0, 0, 0, 0};
+    avrobinRpcTest_calculator serv {nullptr, avrobinRpcTest_add, nullptr, nullptr, nullptr};
+    uint8_t *reply = nullptr;
+    size_t replyLength = 0;
+    int rc = avrobinRpc_call(intf, &serv, request, sizeof(request), &reply, &replyLength);
+    EXPECT_NE(0, rc);
+
+    rc = avrobinRpc_call(intf, &serv, request, 3, &reply, &replyLength); //truncated header
+    EXPECT_NE(0, rc);
+
+    dynInterface_destroy(intf);
+}
+
+TEST_F(AvrobinRpcTests, PrepareUnsupportedTypeKeepsOwnership) {
+    dyn_function_type *dynFunc = nullptr;
+    int rc = dynFunction_parseWithStr("setName(#am=handle;PtP)N", nullptr, &dynFunc);
+    ASSERT_EQ(0, rc);
+
+    void *handle = nullptr;
+    char *name = strdup("name");
+    void *untyped = nullptr;
+    void *args[3] = {&handle, &name, &untyped};
+
+    uint8_t *request = nullptr;
+    size_t requestLength = 0;
+    rc = avrobinRpc_prepareInvokeRequest(dynFunc, "setName(tP)V", args, &request, &requestLength);
+    EXPECT_NE(0, rc);
+    EXPECT_STREQ("name", name); //note not freed, the caller can still fall back to json rpc
+
+    free(name);
+    dynFunction_destroy(dynFunc);
+}
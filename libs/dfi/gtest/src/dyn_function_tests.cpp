@@ -20,6 +20,10 @@
 #include "gtest/gtest.h"
 
 #include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <ffi.h>
 #include "dyn_example_functions.h"
 
 #include "dyn_common.h"
@@ -290,3 +294,71 @@ TEST_F(DynFunctionTests, InvalidDynFuncTest) {
     EXPECT_TRUE(func_invalid());
 }
 
+extern "C" {
+struct delayed_callback_call {
+    int delayInMs;
+    dyn_function_callback_fp callback;
+    void *callbackData;
+};
+
+static int nrOfDelayedCallbacks = 0;
+
+static void* delayedCallbackThread(void *data) {
+    auto call = static_cast<delayed_callback_call*>(data);
+    usleep(call->delayInMs * 1000);
+    call->callback(call->callbackData, 42);
+    free(call);
+    __atomic_add_fetch(&nrOfDelayedCallbacks, 1, __ATOMIC_RELEASE);
+    return nullptr;
+}
+
+static int delayedCallback(int delayInMs, dyn_function_callback_fp callback, void *callbackData) {
+    auto call = static_cast<delayed_callback_call*>(calloc(1, sizeof(delayed_callback_call)));
+    call->delayInMs = delayInMs;
+    call->callback = callback;
+    call->callbackData = callbackData;
+    pthread_t thread;
+    pthread_create(&thread, nullptr, delayedCallbackThread, call);
+    pthread_detach(thread);
+    return 0;
+}
+
+static bool func_asyncTimeout() {
+    dyn_function_type *dynFunc = nullptr;
+    void (*fp)(void) = (void(*)(void)) delayedCallback;
+    int rc = dynFunction_parseWithStr("delayedCallback(I#am=callback;P#am=callbackData;P)N", nullptr, &dynFunc);
+    if (rc != 0) {
+        return false;
+    }
+    dynFunction_setAsyncTimeout(dynFunc, 50);
+
+    //completion callback after the timeout
+    int delayInMs = 500;
+    void *callback = nullptr;
+    void *callbackData = nullptr;
+    void *args[3] = {&delayInMs, &callback, &callbackData};
+    ffi_sarg returnValue = 1;
+    int timeoutRc = dynFunction_callAndWait(dynFunc, fp, &returnValue, args);
+
+    //completion callback before the timeout, the status of the callback is returned
+    delayInMs = 10;
+    returnValue = 1;
+    int completedRc = dynFunction_callAndWait(dynFunc, fp, &returnValue, args);
+    int completedStatus = (int)returnValue;
+
+    //wait for the late completion callback, which should be ignored
+    for (int i = 0; i < 200 && __atomic_load_n(&nrOfDelayedCallbacks, __ATOMIC_ACQUIRE) < 2; ++i) {
+        usleep(10000);
+    }
+    dynFunction_destroy(dynFunc);
+
+    return timeoutRc == ETIMEDOUT && completedRc == 0 && completedStatus == 42 &&
+           __atomic_load_n(&nrOfDelayedCallbacks, __ATOMIC_ACQUIRE) == 2;
+}
+}
+
+TEST_F(DynFunctionTests, AsyncTimeoutTest) {
+    //NOTE only using libffi with extern C, because combining libffi with EXPECT_*/ASSERT_* call leads to
+    //corrupted memory. Note that libffi is a function for interfacing with C not C++
+    EXPECT_TRUE(func_asyncTimeout());
+}
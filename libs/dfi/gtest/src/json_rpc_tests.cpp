@@ -28,6 +28,8 @@ extern "C" {
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include <ffi.h>
 
@@ -98,6 +100,36 @@ static void stdLog(void*, int level, const char *file, int line, const char *msg
         return 0;
     }
 
+    struct add_async_call {
+        double a;
+        double b;
+        double *result;
+        dyn_function_callback_fp callback;
+        void *callbackData;
+    };
+
+    void* addAsyncThread(void *data) {
+        auto call = static_cast<add_async_call*>(data);
+        usleep(10000);
+        *call->result = call->a + call->b;
+        call->callback(call->callbackData, 0);
+        free(call);
+        return nullptr;
+    }
+
+    int addAsync(void*, double a, double b, double *result, dyn_function_callback_fp callback, void *callbackData) {
+        auto call = static_cast<add_async_call*>(calloc(1, sizeof(add_async_call)));
+        call->a = a;
+        call->b = b;
+        call->result = result;
+        call->callback = callback;
+        call->callbackData = callbackData;
+        pthread_t thread;
+        pthread_create(&thread, nullptr, addAsyncThread, call);
+        pthread_detach(thread);
+        return 0;
+    }
+
     int getName_example4(void*, char** result) {
         *result = strdup("allocatedInFunction");
         return 0;
@@ -179,6 +211,60 @@ static void stdLog(void*, int level, const char *file, int line, const char *msg
         int (*getName_example4)(void *, char** name);
     };
 
+    struct tst_serv_example5 {
+        void *handle;
+        int (*addAsync)(void *, double, double, double *, dyn_function_callback_fp, void *);
+    };
+
+    void prepareTestAsync(void) {
+        dyn_function_type *dynFunc = nullptr;
+        int rc = dynFunction_parseWithStr("addAsync(#am=handle;PDD#am=pre;*D#am=callback;P#am=callbackData;P)N", nullptr, &dynFunc);
+        ASSERT_EQ(0, rc);
+        ASSERT_TRUE(dynFunction_isAsync(dynFunc));
+        ASSERT_EQ(DYN_FUNCTION_ARGUMENT_META__CALLBACK, dynFunction_argumentMetaForIndex(dynFunc, 4));
+        ASSERT_EQ(DYN_FUNCTION_ARGUMENT_META__CALLBACK_DATA, dynFunction_argumentMetaForIndex(dynFunc, 5));
+
+        void *handle = nullptr;
+        double arg1 = 1.0;
+        double arg2 = 2.0;
+        double out = 0.0;
+        void *outPtr = &out;
+        void *callback = nullptr;
+        void *callbackData = nullptr;
+        void *args[6] = {&handle, &arg1, &arg2, &outPtr, &callback, &callbackData};
+
+        char *result = nullptr;
+        rc = jsonRpc_prepareInvokeRequest(dynFunc, "addAsync", args, &result);
+        ASSERT_EQ(0, rc);
+        json_t *request = json_loads(result, 0, nullptr);
+        ASSERT_TRUE(request != nullptr);
+        ASSERT_EQ(2, json_array_size(json_object_get(request, "a"))); //note callback args are not serialized
+        json_decref(request);
+
+        free(result);
+        dynFunction_destroy(dynFunc);
+    }
+
+    void callTestAsync(void) {
+        dyn_interface_type *intf = nullptr;
+        FILE *desc = fopen("descriptors/example5.descriptor", "r");
+        ASSERT_TRUE(desc != nullptr);
+        int rc = dynInterface_parse(desc, &intf);
+        ASSERT_EQ(0, rc);
+        fclose(desc);
+
+        char *result = nullptr;
+        tst_serv_example5 serv {nullptr, addAsync};
+
+        //note jsonRpc_call waits for the completion callback of the asynchronous function
+        rc = jsonRpc_call(intf, &serv, R"({"m":"addAsync(DD)D", "a": [1.0,2.0]})", &result);
+        ASSERT_EQ(0, rc);
+        ASSERT_TRUE(strstr(result, "3.0") != nullptr);
+
+        free(result);
+        dynInterface_destroy(intf);
+    }
+
     void callTestPreAllocated(void) {
         dyn_interface_type *intf = nullptr;
         FILE *desc = fopen("descriptors/example1.descriptor", "r");
@@ -420,3 +506,11 @@ TEST_F(JsonRpcTests, handleOutChar) {
     handleTestOutChar();
 }
 
+TEST_F(JsonRpcTests, prepareAsync) {
+    prepareTestAsync();
+}
+
+TEST_F(JsonRpcTests, callAsync) {
+    callTestAsync();
+}
+
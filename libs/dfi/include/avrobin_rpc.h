@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __AVROBIN_RPC_H_
+#define __AVROBIN_RPC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dfi_log_util.h"
+#include "dyn_type.h"
+#include "dyn_function.h"
+#include "dyn_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Binary (avrobin) alternative to json rpc.
+ *
+ * Request layout (integers are 32 bit big endian):
+ *  - method id (avrobinRpc_methodId of the method signature id)
+ *  - nr of input arguments
+ *  - per input argument: length, avrobin serialized argument
+ *
+ * Reply layout:
+ *  - status of the called function
+ *  - length of the result (0 if there is no result), avrobin serialized result
+ *
+ * Because the method id is in a fixed header, the callee can dispatch without parsing the arguments first.
+ */
+
+//logging
+DFI_SETUP_LOG_HEADER(avrobinRpc);
+
+/**
+ * Returns the 32 bit method id for a method signature id (e.g. "add(DD)D").
+ */
+uint32_t avrobinRpc_methodId(const char *id);
+
+int avrobinRpc_call(dyn_interface_type *intf, void *service, const uint8_t *request, size_t requestLength, uint8_t **out, size_t *outLength);
+
+/**
+ * Prepares a binary invoke request.
+ * Ownership of (non const) text input arguments is only taken if the request is successfully prepared, so that a
+ * caller can fall back to jsonRpc_prepareInvokeRequest if an argument type is not supported by avrobin.
+ */
+int avrobinRpc_prepareInvokeRequest(dyn_function_type *func, const char *id, void *args[], uint8_t **out, size_t *outLength);
+int avrobinRpc_handleReply(dyn_function_type *func, const uint8_t *reply, size_t replyLength, void *args[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
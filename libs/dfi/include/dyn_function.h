@@ -23,6 +23,11 @@
 #include "dyn_type.h"
 #include "dfi_log_util.h"
 
+/**
+ * The default time dynFunction_callAndWait waits for the completion of an asynchronous function.
+ */
+#define DYN_FUNCTION_DEFAULT_ASYNC_TIMEOUT_IN_MS 30000
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -35,6 +40,12 @@ extern "C" {
  * am=handle #void pointer for the handle
  * am=pre #output pointer with memory pre-allocated
  * am=out #output pointer
+ * am=callback #void pointer for a completion callback with the signature void (*)(void *callbackData, int status)
+ * am=callbackData #void pointer for the data provided to the completion callback
+ *
+ * A function with a callback argument is an asynchronous function. If an asynchronous function returns 0, the
+ * callee must call the callback exactly once when the function is completed. Output arguments must stay valid until
+ * the callback is called.
  *
  * text argument (t) can also be annotated to be considered const string.
  * Normally a text argument will be handled as char*, meaning that the callee is expected to take of ownership.
@@ -51,9 +62,16 @@ enum dyn_function_argument_meta {
     DYN_FUNCTION_ARGUMENT_META__STD = 0,
     DYN_FUNCTION_ARGUMENT_META__HANDLE = 1,
     DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT = 2,
-    DYN_FUNCTION_ARGUMENT_META__OUTPUT = 3
+    DYN_FUNCTION_ARGUMENT_META__OUTPUT = 3,
+    DYN_FUNCTION_ARGUMENT_META__CALLBACK = 4,
+    DYN_FUNCTION_ARGUMENT_META__CALLBACK_DATA = 5
 };
 
+/**
+ * The completion callback of an asynchronous function (a function with a am=callback argument).
+ */
+typedef void (*dyn_function_callback_fp)(void *callbackData, int status);
+
 int dynFunction_parse(FILE *descriptorStream, struct types_head *refTypes, dyn_function_type **dynFunc);
 int dynFunction_parseWithStr(const char *descriptor, struct types_head *refTypes, dyn_function_type **dynFunc);
 
@@ -65,6 +83,24 @@ dyn_type * dynFunction_returnType(dyn_function_type *dynFunction);
 void dynFunction_destroy(dyn_function_type *dynFunc);
 int dynFunction_call(dyn_function_type *dynFunc, void(*fn)(void), void *returnValue, void **argValues);
 
+/**
+ * Calls the function and, if the function is asynchronous, waits for its completion.
+ * For an asynchronous function the callback and callbackData argument values are provided by this function and
+ * if the function returns 0, the return value is set to the status provided to the completion callback.
+ * Asynchronous functions must have a native int (N) return type.
+ *
+ * Returns 0 on success or ETIMEDOUT if the completion callback is not called within the async timeout
+ * (see dynFunction_setAsyncTimeout). After a timeout the function can still use its arguments, so the caller must
+ * not free them.
+ */
+int dynFunction_callAndWait(dyn_function_type *dynFunc, void(*fn)(void), void *returnValue, void **argValues);
+
+/**
+ * Sets the time dynFunction_callAndWait waits for the completion of the asynchronous function.
+ * A timeout <= 0 resets it to DYN_FUNCTION_DEFAULT_ASYNC_TIMEOUT_IN_MS.
+ */
+void dynFunction_setAsyncTimeout(dyn_function_type *dynFunc, int timeoutInMs);
+
 int dynFunction_createClosure(dyn_function_type *func, void (*bind)(void *, void **, void*), void *userData, void(**fn)(void));
 int dynFunction_getFnPointer(dyn_function_type *func, void (**fn)(void));
 
@@ -74,6 +110,11 @@ int dynFunction_getFnPointer(dyn_function_type *func, void (**fn)(void));
  */
 bool dynFunction_hasReturn(dyn_function_type *dynFunction);
 
+/**
+ * Returns whether the function is asynchronous, i.e. has a am=callback argument.
+ */
+bool dynFunction_isAsync(dyn_function_type *dynFunction);
+
 // Avpr parsing
 dyn_function_type * dynFunction_parseAvprWithStr(const char * avpr, const char * fqn);
 dyn_function_type * dynFunction_parseAvpr(FILE * avprStream, const char * fqn);
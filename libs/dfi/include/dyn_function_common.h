@@ -39,6 +39,7 @@ struct _dyn_function_type {
     ffi_type **ffiArguments;
     dyn_type *funcReturn;
     ffi_cif cif;
+    int asyncTimeoutInMs; //<= 0 means DYN_FUNCTION_DEFAULT_ASYNC_TIMEOUT_IN_MS
 
     //closure part
     ffi_closure *ffiClosure;
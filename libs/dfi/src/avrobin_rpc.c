@@ -0,0 +1,406 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "avrobin_rpc.h"
+#include "avrobin_serializer.h"
+#include "dyn_type.h"
+#include "dyn_interface.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+#include <ffi.h>
+#include <dyn_type_common.h>
+
+static const int OK = 0;
+static const int ERROR = 1;
+
+DFI_SETUP_LOG(avrobinRpc);
+
+typedef void (*gen_func_type)(void);
+
+struct generic_service_layout {
+    void *handle;
+    gen_func_type methods[];
+};
+
+static void avrobinRpc_writeUint32(FILE *stream, uint32_t val) {
+    uint8_t buf[4] = {(uint8_t)(val >> 24), (uint8_t)(val >> 16), (uint8_t)(val >> 8), (uint8_t)val};
+    fwrite(buf, 1, sizeof(buf), stream);
+}
+
+static int avrobinRpc_readUint32(const uint8_t *data, size_t length, size_t *offset, uint32_t *val) {
+    if (length < 4 || *offset > length - 4) {
+        LOG_ERROR("Unexpected end of binary rpc data");
+        return ERROR;
+    }
+    const uint8_t *buf = data + *offset;
+    *val = ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+    *offset += 4;
+    return OK;
+}
+
+/**
+ * Reads a length prefixed block and returns a pointer to the block data.
+ */
+static int avrobinRpc_readBlock(const uint8_t *data, size_t length, size_t *offset, const uint8_t **block, size_t *blockLength) {
+    uint32_t len = 0;
+    int status = avrobinRpc_readUint32(data, length, offset, &len);
+    if (status == OK && len > length - *offset) {
+        LOG_ERROR("Binary rpc block length %u exceeds the data length", len);
+        status = ERROR;
+    }
+    if (status == OK) {
+        *block = data + *offset;
+        *blockLength = len;
+        *offset += len;
+    }
+    return status;
+}
+
+static void avrobinRpc_writeBlock(FILE *stream, const uint8_t *block, size_t blockLength) {
+    avrobinRpc_writeUint32(stream, (uint32_t)blockLength);
+    if (blockLength > 0) {
+        fwrite(block, 1, blockLength, stream);
+    }
+}
+
+uint32_t avrobinRpc_methodId(const char *id) {
+    //FNV-1a
+    uint32_t hash = 2166136261u;
+    for (const char *c = id; *c != '\0'; ++c) {
+        hash ^= (uint8_t)*c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int avrobinRpc_call(dyn_interface_type *intf, void *service, const uint8_t *request, size_t requestLength, uint8_t **out, size_t *outLength) {
+    int status = OK;
+
+    size_t offset = 0;
+    uint32_t methodId = 0;
+    uint32_t nrOfInputArgs = 0;
+    status = avrobinRpc_readUint32(request, requestLength, &offset, &methodId);
+    if (status == OK) {
+        status = avrobinRpc_readUint32(request, requestLength, &offset, &nrOfInputArgs);
+    }
+
+    struct method_entry *method = NULL;
+    if (status == OK) {
+        struct methods_head *methods = NULL;
+        dynInterface_methods(intf, &methods);
+        struct method_entry *entry = NULL;
+        TAILQ_FOREACH(entry, methods, entries) {
+            if (avrobinRpc_methodId(entry->id) == methodId) {
+                method = entry;
+                break;
+            }
+        }
+        if (method == NULL) {
+            status = ERROR;
+            LOG_ERROR("Cannot find method with id %u", methodId);
+        }
+    }
+
+    if (status == OK && dynType_descriptorType(dynFunction_returnType(method->dynFunc)) != 'N') {
+        //NOTE To be able to handle exception only N as returnType is supported
+        LOG_ERROR("Only interface methods with a native int are supported. Found type '%c'", (char)dynType_descriptorType(dynFunction_returnType(method->dynFunc)));
+        status = ERROR;
+    }
+
+    if (status != OK) {
+        return status;
+    }
+
+    struct generic_service_layout *serv = service;
+    void *handle = serv->handle;
+    void (*fp)(void) = serv->methods[method->index];
+    dyn_function_type *func = method->dynFunc;
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+
+    void *args[nrOfArgs];
+    memset(args, 0, sizeof(args));
+
+    void *ptr = NULL;
+    //note the output is heap allocated, because an asynchronous function can still use it after a timeout
+    void **outputSlot = calloc(1, sizeof(*outputSlot));
+    void *ptrToPtr = outputSlot;
+    if (outputSlot == NULL) {
+        status = ERROR;
+    }
+
+    //setup and deserialize input
+    uint32_t inputIndex = 0;
+    int i;
+    for (i = 0; i < nrOfArgs && status == OK; ++i) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__STD) {
+            const uint8_t *block = NULL;
+            size_t blockLength = 0;
+            if (inputIndex++ >= nrOfInputArgs) {
+                LOG_ERROR("Not enough input arguments in binary request");
+                status = ERROR;
+            } else {
+                status = avrobinRpc_readBlock(request, requestLength, &offset, &block, &blockLength);
+            }
+            if (status == OK) {
+                void *inPtr = NULL;
+                status = avrobinSerializer_deserialize(argType, block, blockLength, &inPtr);
+                args[i] = inPtr;
+            }
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+            void **instPtr = calloc(1, sizeof(void*));
+            void *inst = NULL;
+            dyn_type *subType = NULL;
+            dynType_typedPointer_getTypedType(argType, &subType);
+            dynType_alloc(subType, &inst);
+            *instPtr = inst;
+            args[i] = instPtr;
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+            args[i] = &ptrToPtr;
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__HANDLE) {
+            args[i] = &handle;
+        } //note callback arguments are provided by dynFunction_callAndWait
+    }
+
+    ffi_sarg returnVal = 1;
+    if (status == OK) {
+        status = dynFunction_callAndWait(func, fp, (void *) &returnVal, args);
+    }
+    if (status == ETIMEDOUT) {
+        //note the function can still use its arguments, so these are not freed
+        LOG_ERROR("Timeout calling function '%s'", method->id);
+        return status;
+    }
+    if (outputSlot != NULL) {
+        ptr = *outputSlot;
+        free(outputSlot);
+    }
+
+    int funcCallStatus = (int)returnVal;
+    if (status == OK && funcCallStatus != 0) {
+        LOG_WARNING("Error calling remote endpoint function, got error code %i", funcCallStatus);
+    }
+
+    //free input args
+    for (i = 0; i < nrOfArgs; ++i) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__STD && args[i] != NULL) {
+            if (dynType_descriptorType(argType) == 't' && status == OK) {
+                const char* isConst = dynType_getMetaInfo(argType, "const");
+                if (isConst != NULL && strncmp("true", isConst, 5) == 0) {
+                    dynType_free(argType, args[i]);
+                } else {
+                    //char* -> callee is now owner, no free for char seq needed
+                    //will free the actual pointer
+                    free(args[i]);
+                }
+            } else {
+                dynType_free(argType, args[i]);
+            }
+        }
+    }
+
+    //serialize and free output
+    uint8_t *result = NULL;
+    size_t resultLength = 0;
+    for (i = 0; i < nrOfArgs; ++i) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT && args[i] != NULL) {
+            if (status == OK && funcCallStatus == 0) {
+                status = avrobinSerializer_serialize(argType, args[i], &result, &resultLength);
+            }
+            dyn_type *subType = NULL;
+            dynType_typedPointer_getTypedType(argType, &subType);
+            void **ptrToInst = (void**)args[i];
+            dynType_free(subType, *ptrToInst);
+            free(ptrToInst);
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT && ptr != NULL) {
+            dyn_type *typedType = NULL;
+            dynType_typedPointer_getTypedType(argType, &typedType);
+            if (dynType_descriptorType(typedType) == 't') {
+                if (status == OK && funcCallStatus == 0) {
+                    status = avrobinSerializer_serialize(typedType, (void*) &ptr, &result, &resultLength);
+                }
+                free(ptr);
+            } else {
+                dyn_type *typedTypedType = NULL;
+                dynType_typedPointer_getTypedType(typedType, &typedTypedType);
+                if (status == OK && funcCallStatus == 0) {
+                    status = avrobinSerializer_serialize(typedTypedType, ptr, &result, &resultLength);
+                }
+                dynType_free(typedTypedType, ptr);
+            }
+            ptr = NULL;
+        }
+    }
+
+    if (status == OK) {
+        FILE *stream = open_memstream((char**)out, outLength);
+        if (stream != NULL) {
+            avrobinRpc_writeUint32(stream, (uint32_t)funcCallStatus);
+            avrobinRpc_writeBlock(stream, funcCallStatus == 0 ? result : NULL, funcCallStatus == 0 ? resultLength : 0);
+            fclose(stream);
+        } else {
+            LOG_ERROR("Error creating mem stream for binary reply");
+            status = ERROR;
+        }
+    }
+    free(result);
+
+    return status;
+}
+
+int avrobinRpc_prepareInvokeRequest(dyn_function_type *func, const char *id, void *args[], uint8_t **out, size_t *outLength) {
+    int status = OK;
+
+    LOG_DEBUG("Calling remote function '%s'\n", id);
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+    uint32_t nrOfInputArgs = 0;
+    int i;
+    for (i = 0; i < nrOfArgs; ++i) {
+        if (dynFunction_argumentMetaForIndex(func, i) == DYN_FUNCTION_ARGUMENT_META__STD) {
+            nrOfInputArgs += 1;
+        }
+    }
+
+    uint8_t *request = NULL;
+    size_t requestLength = 0;
+    FILE *stream = open_memstream((char**)&request, &requestLength);
+    if (stream == NULL) {
+        LOG_ERROR("Error creating mem stream for binary request");
+        return ERROR;
+    }
+
+    avrobinRpc_writeUint32(stream, avrobinRpc_methodId(id));
+    avrobinRpc_writeUint32(stream, nrOfInputArgs);
+    for (i = 0; i < nrOfArgs && status == OK; ++i) {
+        dyn_type *type = dynFunction_argumentTypeForIndex(func, i);
+        if (dynFunction_argumentMetaForIndex(func, i) == DYN_FUNCTION_ARGUMENT_META__STD) {
+            uint8_t *arg = NULL;
+            size_t argLength = 0;
+            status = avrobinSerializer_serialize(type, args[i], &arg, &argLength);
+            if (status == OK) {
+                avrobinRpc_writeBlock(stream, arg, argLength);
+                free(arg);
+            }
+        }
+    }
+    fclose(stream);
+
+    if (status == OK) {
+        //note only take ownership of the text arguments if the request is prepared
+        for (i = 0; i < nrOfArgs; ++i) {
+            dyn_type *type = dynFunction_argumentTypeForIndex(func, i);
+            if (dynFunction_argumentMetaForIndex(func, i) == DYN_FUNCTION_ARGUMENT_META__STD && dynType_descriptorType(type) == 't') {
+                const char *metaArgument = dynType_getMetaInfo(type, "const");
+                if (metaArgument == NULL || strncmp("true", metaArgument, 5) != 0) {
+                    char **str = args[i];
+                    free(*str); //char * as input -> got ownership -> free it.
+                }
+            }
+        }
+        *out = request;
+        *outLength = requestLength;
+    } else {
+        free(request);
+    }
+
+    return status;
+}
+
+int avrobinRpc_handleReply(dyn_function_type *func, const uint8_t *reply, size_t replyLength, void *args[]) {
+    size_t offset = 0;
+    uint32_t funcCallStatus = 0;
+    const uint8_t *result = NULL;
+    size_t resultLength = 0;
+    int status = avrobinRpc_readUint32(reply, replyLength, &offset, &funcCallStatus);
+    if (status == OK) {
+        status = avrobinRpc_readBlock(reply, replyLength, &offset, &result, &resultLength);
+    }
+    if (status != OK) {
+        return status;
+    }
+    if (funcCallStatus != 0) {
+        LOG_WARNING("Remote function returned error code %i", (int)funcCallStatus);
+        return status;
+    }
+
+    bool replyHandled = false;
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+    int i;
+    for (i = 0; i < nrOfArgs && status == OK; i += 1) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+            void *tmp = NULL;
+            void **out = (void **) args[i];
+            if (resultLength == 0) {
+                LOG_WARNING("Expected result in binary reply");
+            } else if (dynType_descriptorType(argType) == 't') {
+                status = avrobinSerializer_deserialize(argType, result, resultLength, &tmp);
+                if (tmp != NULL) {
+                    size_t size = strnlen(((char *) *(char**) tmp), 1024 * 1024);
+                    memcpy(*out, *(void**) tmp, size);
+                }
+                replyHandled = true;
+            } else {
+                dynType_typedPointer_getTypedType(argType, &argType);
+                status = avrobinSerializer_deserialize(argType, result, resultLength, &tmp);
+                if (tmp != NULL) {
+                    memcpy(*out, tmp, dynType_size(argType));
+                }
+                replyHandled = true;
+            }
+            dynType_free(argType, tmp);
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+            dyn_type *subType = NULL;
+            dynType_typedPointer_getTypedType(argType, &subType);
+            if (resultLength == 0) {
+                LOG_WARNING("Expected result in binary reply");
+            } else if (dynType_descriptorType(subType) == 't') {
+                char ***out = (char ***) args[i];
+                char **ptrToString = NULL;
+                status = avrobinSerializer_deserialize(subType, result, resultLength, (void**)&ptrToString);
+                if (ptrToString != NULL) {
+                    **out = *ptrToString;
+                    free(ptrToString);
+                }
+                replyHandled = true;
+            } else {
+                dyn_type *subSubType = NULL;
+                dynType_typedPointer_getTypedType(subType, &subSubType);
+                void ***out = (void ***) args[i];
+                status = avrobinSerializer_deserialize(subSubType, result, resultLength, *out);
+                replyHandled = true;
+            }
+        }
+    }
+
+    if (resultLength > 0 && !replyHandled) {
+        LOG_WARNING("Binary reply has a result output, but this is not handled by the remote function!");
+    }
+
+    return status;
+}
@@ -23,7 +23,10 @@
 #include <strings.h>
 #include <stdlib.h>
 #include <ffi.h>
+#include <errno.h>
 #include <dyn_type_common.h>
+#include "celix_threads.h"
+#include "celix_utils.h"
 
 static const int OK = 0;
 static const int MEM_ERROR = 1;
@@ -73,6 +76,10 @@ int dynFunction_parse(FILE *descriptor, struct types_head *refTypes, dyn_functio
                 arg->argumentMeta = DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT;
             } else if (strcmp(meta, "out") == 0) {
                 arg->argumentMeta = DYN_FUNCTION_ARGUMENT_META__OUTPUT;
+            } else if (strcmp(meta, "callback") == 0) {
+                arg->argumentMeta = DYN_FUNCTION_ARGUMENT_META__CALLBACK;
+            } else if (strcmp(meta, "callbackData") == 0) {
+                arg->argumentMeta = DYN_FUNCTION_ARGUMENT_META__CALLBACK_DATA;
             } else {
                 LOG_WARNING("unknown argument meta '%s' encountered", meta);
                 arg->argumentMeta = DYN_FUNCTION_ARGUMENT_META__STD;
@@ -241,6 +248,96 @@ int dynFunction_call(dyn_function_type *dynFunc, void(*fn)(void), void *returnVa
     return 0;
 }
 
+/**
+ * Used to wait for the completion callback of an asynchronous function.
+ * Heap allocated, because after a timeout the (late) completion callback is ignored and frees the completion.
+ */
+struct dyn_function_completion {
+    celix_thread_mutex_t mutex;
+    celix_thread_cond_t cond;
+    bool done;
+    bool abandoned; //the waiting call timed out
+    int status;
+};
+
+static void dynFunction_destroyCompletion(struct dyn_function_completion *completion) {
+    celixThreadMutex_destroy(&completion->mutex);
+    celixThreadCondition_destroy(&completion->cond);
+    free(completion);
+}
+
+static void dynFunction_completionCallback(void *callbackData, int status) {
+    struct dyn_function_completion *completion = callbackData;
+    celixThreadMutex_lock(&completion->mutex);
+    bool abandoned = completion->abandoned;
+    completion->status = status;
+    completion->done = true;
+    celixThreadCondition_broadcast(&completion->cond);
+    celixThreadMutex_unlock(&completion->mutex);
+    if (abandoned) {
+        LOG_WARNING("Completion callback of function called after the timeout, status %i is ignored", status);
+        dynFunction_destroyCompletion(completion);
+    }
+}
+
+int dynFunction_callAndWait(dyn_function_type *dynFunc, void(*fn)(void), void *returnValue, void **argValues) {
+    if (!dynFunction_isAsync(dynFunc)) {
+        return dynFunction_call(dynFunc, fn, returnValue, argValues);
+    }
+
+    struct dyn_function_completion *completion = calloc(1, sizeof(*completion));
+    if (completion == NULL) {
+        LOG_ERROR("Error allocating memory for the completion of an async function");
+        return 1;
+    }
+    celixThreadMutex_create(&completion->mutex, NULL);
+    celixThreadCondition_init(&completion->cond, NULL);
+    dyn_function_callback_fp completionCallback = dynFunction_completionCallback;
+    void *completionData = completion;
+
+    dyn_function_argument_type *arg = NULL;
+    TAILQ_FOREACH(arg, &dynFunc->arguments, entries) {
+        if (arg->argumentMeta == DYN_FUNCTION_ARGUMENT_META__CALLBACK) {
+            argValues[arg->index] = &completionCallback;
+        } else if (arg->argumentMeta == DYN_FUNCTION_ARGUMENT_META__CALLBACK_DATA) {
+            argValues[arg->index] = &completionData;
+        }
+    }
+
+    ffi_sarg *rc = returnValue;
+    *rc = 1;
+    ffi_call(&dynFunc->cif, fn, returnValue, argValues);
+    if (*rc == 0) {
+        int timeoutInMs = dynFunc->asyncTimeoutInMs > 0 ? dynFunc->asyncTimeoutInMs : DYN_FUNCTION_DEFAULT_ASYNC_TIMEOUT_IN_MS;
+        struct timespec start = celix_gettime(CLOCK_MONOTONIC);
+        celixThreadMutex_lock(&completion->mutex);
+        double remaining = timeoutInMs / 1000.0;
+        while (!completion->done && remaining > 0) {
+            long seconds = (long)remaining;
+            celixThreadCondition_timedwaitRelative(&completion->cond, &completion->mutex, seconds, (long)((remaining - seconds) * 1000000000.0));
+            remaining = timeoutInMs / 1000.0 - celix_elapsedtime(CLOCK_MONOTONIC, start);
+        }
+        bool timedOut = !completion->done;
+        if (timedOut) {
+            completion->abandoned = true;
+        } else {
+            *rc = completion->status;
+        }
+        celixThreadMutex_unlock(&completion->mutex);
+        if (timedOut) {
+            LOG_ERROR("Timeout (%i ms) waiting for the completion of function '%s'", timeoutInMs, dynFunc->name != NULL ? dynFunc->name : "");
+            return ETIMEDOUT;
+        }
+    }
+
+    dynFunction_destroyCompletion(completion);
+    return 0;
+}
+
+void dynFunction_setAsyncTimeout(dyn_function_type *dynFunc, int timeoutInMs) {
+    dynFunc->asyncTimeoutInMs = timeoutInMs;
+}
+
 static void dynFunction_ffiBind(ffi_cif *cif, void *ret, void *args[], void *userData) {
     dyn_function_type *dynFunc = userData;
     dynFunc->bind(dynFunc->userData, args, ret);
@@ -309,4 +406,14 @@ dyn_type * dynFunction_returnType(dyn_function_type *dynFunction) {
 bool dynFunction_hasReturn(dyn_function_type *dynFunction) {
     dyn_type *t = dynFunction_returnType(dynFunction);
     return t->descriptor != 'V';
+}
+
+bool dynFunction_isAsync(dyn_function_type *dynFunction) {
+    dyn_function_argument_type *arg = NULL;
+    TAILQ_FOREACH(arg, &dynFunction->arguments, entries) {
+        if (arg->argumentMeta == DYN_FUNCTION_ARGUMENT_META__CALLBACK) {
+            return true;
+        }
+    }
+    return false;
 }
\ No newline at end of file
@@ -23,6 +23,7 @@
 #include "dyn_interface.h"
 #include <jansson.h>
 #include <assert.h>
+#include <errno.h>
 #include <stdint.h>
 #include <string.h>
 #include <ffi.h>
@@ -105,7 +106,12 @@ int jsonRpc_call(dyn_interface_type *intf, void *service, const char *request, c
 	int index = 0;
 
 	void *ptr = NULL;
-	void *ptrToPtr = &ptr;
+	//note the output is heap allocated, because an asynchronous function can still use it after a timeout
+	void **outputSlot = calloc(1, sizeof(*outputSlot));
+	void *ptrToPtr = outputSlot;
+	if (outputSlot == NULL) {
+		status = ERROR;
+	}
 
 	//setup and deserialize input
 	for (i = 0; i < nrOfArgs; ++i) {
@@ -128,6 +134,8 @@ int jsonRpc_call(dyn_interface_type *intf, void *service, const char *request, c
 			args[i] = &ptrToPtr;
 		} else if (meta == DYN_FUNCTION_ARGUMENT_META__HANDLE) {
 			args[i] = &handle;
+		} else {
+			args[i] = NULL; //note callback arguments are provided by dynFunction_callAndWait
 		}
 
 		if (status != OK) {
@@ -147,7 +155,16 @@ int jsonRpc_call(dyn_interface_type *intf, void *service, const char *request, c
 	ffi_sarg returnVal = 1;
 
 	if (status == OK) {
-		status = dynFunction_call(func, fp, (void *) &returnVal, args);
+		status = dynFunction_callAndWait(func, fp, (void *) &returnVal, args);
+	}
+	if (status == ETIMEDOUT) {
+		//note the function can still use its arguments, so these are not freed
+		LOG_ERROR("Timeout calling function '%s'", method->id);
+		return status;
+	}
+	if (outputSlot != NULL) {
+		ptr = *outputSlot;
+		free(outputSlot);
 	}
 
 	int funcCallStatus = (int)returnVal;
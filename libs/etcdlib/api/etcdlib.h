@@ -26,6 +26,7 @@ extern "C"
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /*
  * If set etcdlib will _not_ initialize curl
@@ -116,6 +117,39 @@ int etcdlib_set(etcdlib_t *etcdlib, const char* key, const char* value, int ttl,
  */
 int etcdlib_refresh(etcdlib_t *etcdlib, const char *key, int ttl);
 
+/**
+ * @desc Setting multiple Etcd-key/values in one batch. The requests are performed concurrently over a small
+ * set of keep-alive connections, instead of one blocking request (round trip) per key.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
+ * @param size_t size. The number of keys.
+ * @param const char* const keys[]. The Etcd-keys (Note: a leading '/' should be avoided)
+ * @param const char* const values[]. The Etcd-values. If NULL only the ttl of the (existing) keys is refreshed, see etcdlib_refresh_multiple.
+ * @param int ttl. If non-zero this is used as the TTL value
+ * @param int rcs[]. If not NULL, the return code (0 on success) per key.
+ * @return 0 if all keys are set, non zero otherwise
+ */
+int etcdlib_set_multiple(etcdlib_t *etcdlib, size_t size, const char* const keys[], const char* const values[], int ttl, int rcs[]);
+
+/**
+ * @desc Bounds the duration of etcdlib_set_multiple and etcdlib_refresh_multiple, including waiting for other
+ * requests of this ETCD-LIB instance. Requests which did not complete in time get a ETCDLIB_RC_TIMEOUT return code.
+ * @param etcdlib_t* etcdlib. The ETCD-LIB instance.
+ * @param int timeoutInMs. The max duration of a batch in milliseconds. If <= 0 (default) only the per request
+ * curl timeouts are used.
+ */
+void etcdlib_set_batch_timeout(etcdlib_t *etcdlib, int timeoutInMs);
+
+/**
+ * @desc Refresh the ttl of multiple existing keys in one batch, see etcdlib_set_multiple.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
+ * @param size_t size. The number of keys.
+ * @param const char* const keys[]. The etcd keys to refresh.
+ * @param int ttl. The ttl value to use.
+ * @param int rcs[]. If not NULL, the return code (0 on success) per key.
+ * @return 0 if all keys are refreshed, non zero otherwise.
+ */
+int etcdlib_refresh_multiple(etcdlib_t *etcdlib, size_t size, const char* const keys[], int ttl, int rcs[]);
+
 /**
  * @desc Setting an Etcd-key/value and checks if there is a different previous value
  * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
@@ -18,11 +18,13 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <curl/curl.h>
 #include <jansson.h>
 #include <pthread.h>
+#include <time.h>
 
 #include "etcd.h"
 
@@ -43,11 +45,23 @@
 #define DEFAULT_CURL_TIMEOUT          10
 #define DEFAULT_CURL_CONNECT_TIMEOUT  10
 
+//max number of concurrent requests (and connections) used by etcdlib_set_multiple/etcdlib_refresh_multiple
+#define MAX_PARALLEL_REQUESTS         8
+
 struct etcdlib_struct {
 	char *host;
 	int port;
 	CURL *curl;
     pthread_mutex_t mutex;
+
+    //separate (keep-alive) handle for watches, so that a pending watch does not block other requests
+    CURL *watchCurl;
+    pthread_mutex_t watchMutex;
+
+    //multi handle + easy handles for batched requests, protected by mutex. Note the multi handle keeps the connections alive between batches
+    CURLM *multi;
+    CURL *batchCurls[MAX_PARALLEL_REQUESTS];
+    int batchTimeoutInMs; //if > 0 the max duration of a batch, including waiting for the mutex
 };
 
 typedef enum {
@@ -65,12 +79,25 @@ struct MemoryStruct {
     size_t headerSize;
 };
 
+struct BatchRequest {
+	char *url;
+	char *request;
+	const char *value; //NULL for a ttl refresh
+	struct MemoryStruct reply;
+	int handle; //index in batchCurls
+};
+
 
 /**
  * Static function declarations
  */
 static int performRequest(CURL **curl, pthread_mutex_t *mutex, char* url, request_t request, void* reqData, void* repData);
+static void setupRequest(CURL *curl, char* url, request_t request, void* reqData, void* repData);
 static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp);
+static char* createSetRequest(const char* value, int ttl, bool prevExist);
+static char* createRefreshRequest(int ttl);
+static int parseSetReply(const char* reply, const char* value);
+static int parseRefreshReply(const char* reply);
 /**
  * External function definition
  */
@@ -92,6 +119,11 @@ int etcd_init(const char* server, int port, int flags) {
 	}
     g_etcdlib.curl = NULL;
     pthread_mutex_init(&g_etcdlib.mutex, NULL);
+    g_etcdlib.watchCurl = NULL;
+    pthread_mutex_init(&g_etcdlib.watchMutex, NULL);
+    g_etcdlib.multi = NULL;
+    memset(g_etcdlib.batchCurls, 0, sizeof(g_etcdlib.batchCurls));
+    g_etcdlib.batchTimeoutInMs = 0;
 
 	if ((flags & ETCDLIB_NO_CURL_INITIALIZATION) == 0) {
 		//NO_CURL_INITIALIZATION flag not set
@@ -107,11 +139,13 @@ etcdlib_t* etcdlib_create(const char* server, int port, int flags) {
 		curl_global_init(CURL_GLOBAL_ALL);
 	}
 
-	etcdlib_t *lib = malloc(sizeof(*lib));
+	etcdlib_t *lib = calloc(1, sizeof(*lib));
 	lib->host = strndup(server, 1024 * 1024 * 10);
 	lib->port = port;
 	lib->curl = NULL;
     pthread_mutex_init(&lib->mutex, NULL);
+    lib->watchCurl = NULL;
+    pthread_mutex_init(&lib->watchMutex, NULL);
 
 	return lib;
 }
@@ -123,7 +157,21 @@ void etcdlib_destroy(etcdlib_t *etcdlib) {
             curl_easy_cleanup(etcdlib->curl);
             etcdlib->curl = NULL;
         }
+        if(etcdlib->watchCurl != NULL) {
+            curl_easy_cleanup(etcdlib->watchCurl);
+            etcdlib->watchCurl = NULL;
+        }
+        for (int i = 0; i < MAX_PARALLEL_REQUESTS; ++i) {
+            if (etcdlib->batchCurls[i] != NULL) {
+                curl_easy_cleanup(etcdlib->batchCurls[i]);
+            }
+        }
+        if (etcdlib->multi != NULL) {
+            curl_multi_cleanup(etcdlib->multi);
+            etcdlib->multi = NULL;
+        }
         pthread_mutex_destroy(&etcdlib->mutex);
+        pthread_mutex_destroy(&etcdlib->watchMutex);
     }
     free(etcdlib);
 }
@@ -337,15 +385,9 @@ int etcd_set(const char* key, const char* value, int ttl, bool prevExist) {
 
 int etcdlib_set(etcdlib_t *etcdlib, const char* key, const char* value, int ttl, bool prevExist) {
 
-	json_error_t error;
-	json_t* js_root = NULL;
-	json_t* js_node = NULL;
-	json_t* js_value = NULL;
 	int retVal = ETCDLIB_RC_ERROR;
 	char *url;
-	size_t req_len = strlen(value) + MAX_OVERHEAD_LENGTH;
-	char request[req_len];
-	char* requestPtr = request;
+	char *request;
 	int res;
 	struct MemoryStruct reply;
 
@@ -361,37 +403,16 @@ int etcdlib_set(etcdlib_t *etcdlib, const char* key, const char* value, int ttl,
 
 	asprintf(&url, "http://%s:%d/v2/keys/%s", etcdlib->host, etcdlib->port, key);
 
-	requestPtr += snprintf(requestPtr, req_len, "value=%s", value);
-	if (ttl > 0) {
-		requestPtr += snprintf(requestPtr, req_len-(requestPtr-request), ";ttl=%d", ttl);
-	}
-
-	if (prevExist) {
-		requestPtr += snprintf(requestPtr, req_len-(requestPtr-request), ";prevExist=true");
-	}
+	request = createSetRequest(value, ttl, prevExist);
 
 	res = performRequest(&etcdlib->curl, &etcdlib->mutex, url, PUT, request, (void*) &reply);
 	if(url) {
 		free(url);
 	}
+	free(request);
 
 	if (res == CURLE_OK) {
-		js_root = json_loads(reply.memory, 0, &error);
-
-		if (js_root != NULL) {
-			js_node = json_object_get(js_root, ETCD_JSON_NODE);
-		}
-		if (js_node != NULL) {
-			js_value = json_object_get(js_node, ETCD_JSON_VALUE);
-		}
-		if (js_value != NULL && json_is_string(js_value)) {
-			if(strcmp(json_string_value(js_value), value) == 0) {
-				retVal = ETCDLIB_RC_OK;
-			}
-		}
-		if (js_root != NULL) {
-			json_decref(js_root);
-		}
+		retVal = parseSetReply(reply.memory, value);
 	}
 
 	if (reply.memory) {
@@ -409,8 +430,7 @@ int etcd_refresh(const char* key, int ttl) {
 int etcdlib_refresh(etcdlib_t *etcdlib, const char *key, int ttl) {
 	int retVal = ETCDLIB_RC_ERROR;
 	char *url;
-	size_t req_len = MAX_OVERHEAD_LENGTH;
-	char request[req_len];
+	char *request;
 
 	int res;
 	struct MemoryStruct reply;
@@ -426,30 +446,16 @@ int etcdlib_refresh(etcdlib_t *etcdlib, const char *key, int ttl) {
     reply.headerSize = 0; /* no data at this point */
 
 	asprintf(&url, "http://%s:%d/v2/keys/%s", etcdlib->host, etcdlib->port, key);
-	snprintf(request, req_len, "ttl=%d;prevExists=true;refresh=true", ttl);
+	request = createRefreshRequest(ttl);
 
 	res = performRequest(&etcdlib->curl, &etcdlib->mutex, url, PUT, request, (void*) &reply);
 	if(url) {
 		free(url);
 	}
+	free(request);
 
 	if (res == CURLE_OK && reply.memory != NULL) {
-		json_error_t error;
-		json_t *root = json_loads(reply.memory, 0, &error);
-		if (root != NULL) {
-			json_t *errorCode = json_object_get(root, ETCD_JSON_ERRORCODE);
-			if (errorCode == NULL) {
-				//no curl error and no etcd errorcode reply -> OK
-				retVal = ETCDLIB_RC_OK;
-			} else {
-                fprintf(stderr, "[ETCDLIB] errorcode %lli\n", json_integer_value(errorCode));
-				retVal = ETCDLIB_RC_ERROR;
-			}
-			json_decref(root);
-		} else {
-			retVal = ETCDLIB_RC_ERROR;
-			fprintf(stderr, "[ETCDLIB] Error: %s is not json", reply.memory);
-		}
+		retVal = parseRefreshReply(reply.memory);
 	}
 
 	if (reply.memory) {
@@ -459,6 +465,162 @@ int etcdlib_refresh(etcdlib_t *etcdlib, const char *key, int ttl) {
 	return retVal;
 }
 
+void etcdlib_set_batch_timeout(etcdlib_t *etcdlib, int timeoutInMs) {
+	etcdlib->batchTimeoutInMs = timeoutInMs;
+}
+
+static long remainingMs(const struct timespec *deadline) {
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (deadline->tv_sec - now.tv_sec) * 1000L + (deadline->tv_nsec - now.tv_nsec) / 1000000L;
+}
+
+int etcdlib_set_multiple(etcdlib_t *etcdlib, size_t size, const char* const keys[], const char* const values[], int ttl, int rcs[]) {
+	int retVal = ETCDLIB_RC_OK;
+	struct BatchRequest *requests = calloc(size, sizeof(*requests));
+	bool handleInUse[MAX_PARALLEL_REQUESTS] = {false};
+	size_t next = 0;
+	size_t done = 0;
+	int active = 0;
+
+	if (size == 0) {
+		free(requests);
+		return ETCDLIB_RC_OK;
+	} else if (requests == NULL) {
+		return ETCDLIB_RC_ERROR;
+	}
+
+	for (size_t i = 0; i < size; ++i) {
+		const char *key = keys[i];
+		/* Skip leading '/', etcd cannot handle this. */
+		while(*key == '/') {
+			key++;
+		}
+		asprintf(&requests[i].url, "http://%s:%d/v2/keys/%s", etcdlib->host, etcdlib->port, key);
+		requests[i].value = values == NULL ? NULL : values[i];
+		requests[i].request = requests[i].value == NULL ? createRefreshRequest(ttl) : createSetRequest(requests[i].value, ttl, false);
+		requests[i].reply.memory = calloc(1, 1);
+		requests[i].handle = -1;
+		if (rcs != NULL) {
+			rcs[i] = ETCDLIB_RC_ERROR;
+		}
+	}
+
+	//note CLOCK_REALTIME, because of pthread_mutex_timedlock
+	bool hasDeadline = etcdlib->batchTimeoutInMs > 0;
+	bool locked = true;
+	struct timespec deadline = {0, 0};
+	if (hasDeadline) {
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += etcdlib->batchTimeoutInMs / 1000;
+		deadline.tv_nsec += (etcdlib->batchTimeoutInMs % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec += 1;
+			deadline.tv_nsec -= 1000000000L;
+		}
+		if (pthread_mutex_timedlock(&etcdlib->mutex, &deadline) != 0) {
+			locked = false;
+			for (size_t i = 0; rcs != NULL && i < size; ++i) {
+				rcs[i] = ETCDLIB_RC_TIMEOUT;
+			}
+			retVal = ETCDLIB_RC_TIMEOUT;
+			done = size; //skip the requests
+		}
+	} else {
+		pthread_mutex_lock(&etcdlib->mutex);
+	}
+	if (locked && etcdlib->multi == NULL) {
+		etcdlib->multi = curl_multi_init();
+		curl_multi_setopt(etcdlib->multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long) MAX_PARALLEL_REQUESTS);
+	}
+
+	while (done < size) {
+		//start requests until all handles are in use
+		for (int h = 0; h < MAX_PARALLEL_REQUESTS && next < size; ++h) {
+			long remaining = hasDeadline ? remainingMs(&deadline) : 0;
+			if (hasDeadline && remaining <= 0) {
+				//batch deadline passed, do not start the remaining requests
+				if (rcs != NULL) {
+					rcs[next] = ETCDLIB_RC_TIMEOUT;
+				}
+				retVal = ETCDLIB_RC_TIMEOUT;
+				next += 1;
+				done += 1;
+			} else if (!handleInUse[h]) {
+				if (etcdlib->batchCurls[h] == NULL) {
+					etcdlib->batchCurls[h] = curl_easy_init();
+				} else {
+					curl_easy_reset(etcdlib->batchCurls[h]);
+				}
+				setupRequest(etcdlib->batchCurls[h], requests[next].url, PUT, requests[next].request, &requests[next].reply);
+				if (hasDeadline) {
+					curl_easy_setopt(etcdlib->batchCurls[h], CURLOPT_TIMEOUT_MS, remaining);
+					curl_easy_setopt(etcdlib->batchCurls[h], CURLOPT_CONNECTTIMEOUT_MS, remaining);
+				}
+				curl_easy_setopt(etcdlib->batchCurls[h], CURLOPT_PRIVATE, &requests[next]);
+				curl_multi_add_handle(etcdlib->multi, etcdlib->batchCurls[h]);
+				requests[next].handle = h;
+				handleInUse[h] = true;
+				active += 1;
+				next += 1;
+			}
+		}
+
+		int stillRunning = 0;
+		curl_multi_perform(etcdlib->multi, &stillRunning);
+
+		CURLMsg *msg;
+		int msgsLeft = 0;
+		while ((msg = curl_multi_info_read(etcdlib->multi, &msgsLeft)) != NULL) {
+			if (msg->msg == CURLMSG_DONE) {
+				struct BatchRequest *request = NULL;
+				CURLcode res = msg->data.result;
+				CURL *curl = msg->easy_handle;
+				curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char**) &request);
+				curl_multi_remove_handle(etcdlib->multi, curl);
+
+				int rc;
+				if (res == CURLE_OK) {
+					rc = request->value == NULL ? parseRefreshReply(request->reply.memory) : parseSetReply(request->reply.memory, request->value);
+				} else {
+					fprintf(stderr, "[etclib] Curl error for %s @ PUT: %s\n", request->url, curl_easy_strerror(res));
+					rc = res == CURLE_OPERATION_TIMEDOUT ? ETCDLIB_RC_TIMEOUT : ETCDLIB_RC_ERROR;
+				}
+				if (rcs != NULL) {
+					rcs[request - requests] = rc;
+				}
+				if (rc != ETCDLIB_RC_OK) {
+					retVal = rc;
+				}
+
+				handleInUse[request->handle] = false;
+				active -= 1;
+				done += 1;
+			}
+		}
+
+		if (active > 0) {
+			curl_multi_wait(etcdlib->multi, NULL, 0, 1000, NULL);
+		}
+	}
+	if (locked) {
+		pthread_mutex_unlock(&etcdlib->mutex);
+	}
+
+	for (size_t i = 0; i < size; ++i) {
+		free(requests[i].url);
+		free(requests[i].request);
+		free(requests[i].reply.memory);
+	}
+	free(requests);
+
+	return retVal;
+}
+
+int etcdlib_refresh_multiple(etcdlib_t *etcdlib, size_t size, const char* const keys[], int ttl, int rcs[]) {
+	return etcdlib_set_multiple(etcdlib, size, keys, NULL, ttl, rcs);
+}
+
 int etcd_set_with_check(const char* key, const char* value, int ttl, bool always_write) {
 	return etcdlib_set_with_check(&g_etcdlib, key, value, ttl, always_write);
 }
@@ -517,11 +679,15 @@ int etcdlib_watch(etcdlib_t *etcdlib, const char* key, long long index, char** a
 		asprintf(&url, "http://%s:%d/v2/keys/%s?wait=true&recursive=true", etcdlib->host, etcdlib->port, key);
 
 	// don't use shared curl/mutex for watch, that will lock everything.
-	CURL *curl = NULL;
-
-	res = performRequest(&curl, NULL, url, GET, NULL, (void*) &reply);
-
-    curl_easy_cleanup(curl);
+	// reuse the (keep-alive) watch handle, unless another thread is already watching
+	if (pthread_mutex_trylock(&etcdlib->watchMutex) == 0) {
+		res = performRequest(&etcdlib->watchCurl, NULL, url, GET, NULL, (void*) &reply);
+		pthread_mutex_unlock(&etcdlib->watchMutex);
+	} else {
+		CURL *curl = NULL;
+		res = performRequest(&curl, NULL, url, GET, NULL, (void*) &reply);
+		curl_easy_cleanup(curl);
+	}
 
 	if(url)
 		free(url);
@@ -675,28 +841,7 @@ static int performRequest(CURL **curl, pthread_mutex_t *mutex, char* url, reques
 	    curl_easy_reset(*curl);
     }
 
-    curl_easy_setopt(*curl, CURLOPT_NOSIGNAL, 1);
-    curl_easy_setopt(*curl, CURLOPT_TIMEOUT, DEFAULT_CURL_TIMEOUT);
-    curl_easy_setopt(*curl, CURLOPT_CONNECTTIMEOUT, DEFAULT_CURL_CONNECT_TIMEOUT);
-    curl_easy_setopt(*curl, CURLOPT_FOLLOWLOCATION, 1L);
-    //curl_easy_setopt(*curl, CURLOPT_VERBOSE, 1L);
-    curl_easy_setopt(*curl, CURLOPT_URL, url);
-    curl_easy_setopt(*curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(*curl, CURLOPT_WRITEDATA, repData);
-    if (((struct MemoryStruct*)repData)->header) {
-        curl_easy_setopt(*curl, CURLOPT_HEADERDATA, repData);
-        curl_easy_setopt(*curl, CURLOPT_HEADERFUNCTION, WriteHeaderCallback);
-    }
-
-    if (request == PUT) {
-        curl_easy_setopt(*curl, CURLOPT_CUSTOMREQUEST, "PUT");
-        curl_easy_setopt(*curl, CURLOPT_POST, 1L);
-        curl_easy_setopt(*curl, CURLOPT_POSTFIELDS, reqData);
-    } else if (request == DELETE) {
-        curl_easy_setopt(*curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    } else if (request == GET) {
-        curl_easy_setopt(*curl, CURLOPT_CUSTOMREQUEST, "GET");
-    }
+    setupRequest(*curl, url, request, reqData, repData);
 
 	res = curl_easy_perform(*curl);
 
@@ -714,3 +859,100 @@ static int performRequest(CURL **curl, pthread_mutex_t *mutex, char* url, reques
 
     return res;
 }
+
+static void setupRequest(CURL *curl, char* url, request_t request, void* reqData, void* repData) {
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, DEFAULT_CURL_TIMEOUT);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, DEFAULT_CURL_CONNECT_TIMEOUT);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    //curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, repData);
+    if (((struct MemoryStruct*)repData)->header) {
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, repData);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, WriteHeaderCallback);
+    }
+
+    if (request == PUT) {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, reqData);
+    } else if (request == DELETE) {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+    } else if (request == GET) {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "GET");
+    }
+}
+
+static char* createSetRequest(const char* value, int ttl, bool prevExist) {
+	size_t req_len = strlen(value) + MAX_OVERHEAD_LENGTH;
+	char* request = malloc(req_len);
+	char* requestPtr = request;
+
+	requestPtr += snprintf(requestPtr, req_len, "value=%s", value);
+	if (ttl > 0) {
+		requestPtr += snprintf(requestPtr, req_len-(requestPtr-request), ";ttl=%d", ttl);
+	}
+
+	if (prevExist) {
+		requestPtr += snprintf(requestPtr, req_len-(requestPtr-request), ";prevExist=true");
+	}
+
+	return request;
+}
+
+static char* createRefreshRequest(int ttl) {
+	char* request = malloc(MAX_OVERHEAD_LENGTH);
+	snprintf(request, MAX_OVERHEAD_LENGTH, "ttl=%d;prevExists=true;refresh=true", ttl);
+	return request;
+}
+
+static int parseSetReply(const char* reply, const char* value) {
+	json_error_t error;
+	json_t* js_root = NULL;
+	json_t* js_node = NULL;
+	json_t* js_value = NULL;
+	int retVal = ETCDLIB_RC_ERROR;
+
+	js_root = json_loads(reply, 0, &error);
+
+	if (js_root != NULL) {
+		js_node = json_object_get(js_root, ETCD_JSON_NODE);
+	}
+	if (js_node != NULL) {
+		js_value = json_object_get(js_node, ETCD_JSON_VALUE);
+	}
+	if (js_value != NULL && json_is_string(js_value)) {
+		if(strcmp(json_string_value(js_value), value) == 0) {
+			retVal = ETCDLIB_RC_OK;
+		}
+	}
+	if (js_root != NULL) {
+		json_decref(js_root);
+	}
+
+	return retVal;
+}
+
+static int parseRefreshReply(const char* reply) {
+	int retVal;
+	json_error_t error;
+	json_t *root = json_loads(reply, 0, &error);
+	if (root != NULL) {
+		json_t *errorCode = json_object_get(root, ETCD_JSON_ERRORCODE);
+		if (errorCode == NULL) {
+			//no curl error and no etcd errorcode reply -> OK
+			retVal = ETCDLIB_RC_OK;
+		} else {
+			fprintf(stderr, "[ETCDLIB] errorcode %lli\n", json_integer_value(errorCode));
+			retVal = ETCDLIB_RC_ERROR;
+		}
+		json_decref(root);
+	} else {
+		retVal = ETCDLIB_RC_ERROR;
+		fprintf(stderr, "[ETCDLIB] Error: %s is not json", reply);
+	}
+	return retVal;
+}
@@ -107,6 +107,55 @@ int waitforchangetest() {
 	return res;
 }
 
+int batchtest() {
+	int res = 0;
+	const int size = 100;
+	char *keys[size];
+	char *values[size];
+	int rcs[size];
+
+	for (int i = 0; i < size; ++i) {
+		asprintf(&keys[i], "batch/key%d", i);
+		asprintf(&values[i], "value%d", i);
+	}
+
+	if (etcdlib_set_multiple(etcdlib, size, (const char**)keys, (const char**)values, 30, rcs) != ETCDLIB_RC_OK) {
+		printf("etcdlib test error: expected all keys to be set\n");
+		res = -1;
+	}
+	for (int i = 0; i < size && res == 0; ++i) {
+		char *value = NULL;
+		etcdlib_get(etcdlib, keys[i], &value, NULL);
+		if (rcs[i] != ETCDLIB_RC_OK || value == NULL || strcmp(value, values[i]) != 0) {
+			printf("etcdlib test error: expected %s got %s\n", values[i], value);
+			res = -1;
+		}
+		free(value);
+	}
+
+	if (res == 0 && etcdlib_refresh_multiple(etcdlib, size, (const char**)keys, 30, rcs) != ETCDLIB_RC_OK) {
+		printf("etcdlib test error: expected all keys to be refreshed\n");
+		res = -1;
+	}
+
+	//refreshing a non existing key should fail, without affecting the other keys
+	const char *refreshKeys[] = {"batch/key0", "batch/doesnotexist"};
+	if (res == 0 && (etcdlib_refresh_multiple(etcdlib, 2, refreshKeys, 30, rcs) == ETCDLIB_RC_OK || rcs[0] != ETCDLIB_RC_OK || rcs[1] == ETCDLIB_RC_OK)) {
+		printf("etcdlib test error: expected refresh of non existing key to fail\n");
+		res = -1;
+	}
+
+	for (int i = 0; i < size; ++i) {
+		if (etcdlib_del(etcdlib, keys[i]) != ETCDLIB_RC_OK && res == 0) {
+			printf("etcdlib test error: expected %s to be deleted\n", keys[i]);
+			res = -1;
+		}
+		free(keys[i]);
+		free(values[i]);
+	}
+	return res;
+}
+
 int main (void) {
 	etcdlib = etcdlib_create("localhost", 2379, 0);
 
@@ -141,6 +190,7 @@ int main (void) {
 
 	int res = simplewritetest(); if(res) return res; else printf("simplewrite test success\n");
 	res = waitforchangetest(); if(res) return res;else printf("waitforchange1 test success\n");
+	res = batchtest(); if(res) return res;else printf("batch test success\n");
 
 	etcdlib_destroy(etcdlib);
 
@@ -0,0 +1,290 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+
+#include "celix_api.h"
+
+class CelixExecutorTestSuite : public ::testing::Test {
+public:
+    celix_framework_t* fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    celix_properties_t *properties = nullptr;
+
+    CelixExecutorTestSuite() : CelixExecutorTestSuite{"4"} {}
+
+    explicit CelixExecutorTestSuite(const char *nrOfThreads) {
+        properties = properties_create();
+        properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        properties_set(properties, "org.osgi.framework.storage", ".cacheBundleContextTestFramework");
+        properties_set(properties, CELIX_FRAMEWORK_EXECUTOR_NR_OF_THREADS, nrOfThreads);
+
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = framework_getContext(fw);
+    }
+
+    ~CelixExecutorTestSuite() override {
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    CelixExecutorTestSuite(CelixExecutorTestSuite&&) = delete;
+    CelixExecutorTestSuite(const CelixExecutorTestSuite&) = delete;
+    CelixExecutorTestSuite& operator=(CelixExecutorTestSuite&&) = delete;
+    CelixExecutorTestSuite& operator=(const CelixExecutorTestSuite&) = delete;
+};
+
+class CelixExecutorSingleThreadTestSuite : public CelixExecutorTestSuite {
+public:
+    CelixExecutorSingleThreadTestSuite() : CelixExecutorTestSuite{"1"} {}
+};
+
+/**
+ * Counts the task executions. Tests wait on the count instead of sleeping, so that they do not depend on timing.
+ */
+struct executor_test_data {
+    std::mutex mutex{};
+    std::condition_variable cond{};
+    int count = 0; //protected by mutex
+    std::chrono::steady_clock::time_point lastExecution{}; //protected by mutex
+    celix_executor_service_t *svc = nullptr;
+
+    int getCount() {
+        std::lock_guard<std::mutex> lock{mutex};
+        return count;
+    }
+
+    bool waitForCount(int expected) {
+        std::unique_lock<std::mutex> lock{mutex};
+        return cond.wait_for(lock, std::chrono::seconds{10}, [&]{ return count >= expected; });
+    }
+};
+
+static void executorTest_count(void *handle) {
+    auto *data = static_cast<executor_test_data*>(handle);
+    std::lock_guard<std::mutex> lock{data->mutex};
+    data->count += 1;
+    data->lastExecution = std::chrono::steady_clock::now();
+    data->cond.notify_all();
+}
+
+/**
+ * Schedules a one shot task with the provided delay and waits until it is executed.
+ * Used to check that no other (cancelled) tasks are executed in the meantime.
+ */
+static void executorTest_waitForScheduledTask(celix_bundle_context_t *ctx, double delayInSeconds) {
+    executor_test_data marker{};
+    struct marker_data {
+        executor_test_data *marker;
+        double delay;
+    } md{&marker, delayInSeconds};
+    bool called = celix_bundleContext_useService(ctx, CELIX_EXECUTOR_SERVICE_NAME, &md, [](void *handle, void *svc) {
+        auto *executor = static_cast<celix_executor_service_t*>(svc);
+        auto *d = static_cast<marker_data*>(handle);
+        EXPECT_GT(executor->schedule(executor->handle, CELIX_EXECUTOR_PRIORITY_NORMAL, d->delay, 0, d->marker, executorTest_count), 0);
+    });
+    EXPECT_TRUE(called);
+    EXPECT_TRUE(marker.waitForCount(1));
+}
+
+TEST_F(CelixExecutorTestSuite, SubmitTasks) {
+    executor_test_data data{};
+    bool called = celix_bundleContext_useService(ctx, CELIX_EXECUTOR_SERVICE_NAME, &data, [](void *handle, void *svc) {
+        auto *executor = static_cast<celix_executor_service_t*>(svc);
+        for (int i = 0; i < 1000; ++i) {
+            auto prio = (celix_executor_priority_e)(i % 3);
+            EXPECT_EQ(CELIX_SUCCESS, executor->submit(executor->handle, prio, handle, executorTest_count));
+        }
+        executor->waitForTasks(executor->handle);
+    });
+    EXPECT_TRUE(called);
+    EXPECT_EQ(1000, data.getCount());
+}
+
+TEST_F(CelixExecutorTestSuite, SubmitTasksFromTask) {
+    executor_test_data data{};
+    bool called = celix_bundleContext_useService(ctx, CELIX_EXECUTOR_SERVICE_NAME, &data, [](void *handle, void *svc) {
+        auto *executor = static_cast<celix_executor_service_t*>(svc);
+        auto *d = static_cast<executor_test_data*>(handle);
+        d->svc = executor;
+        executor->submit(executor->handle, CELIX_EXECUTOR_PRIORITY_NORMAL, handle, [](void *h) {
+            //note tasks submitted from a task are queued on the current thread and can be stolen by the other threads
+            auto *d = static_cast<executor_test_data*>(h);
+            for (int i = 0; i < 100; ++i) {
+                d->svc->submit(d->svc->handle, CELIX_EXECUTOR_PRIORITY_HIGH, h, executorTest_count);
+            }
+            d->svc->waitForTasks(d->svc->handle); //should not wait for the current task
+            EXPECT_EQ(100, d->getCount());
+        });
+        executor->waitForTasks(executor->handle);
+    });
+    EXPECT_TRUE(called);
+    EXPECT_EQ(100, data.getCount());
+}
+
+TEST_F(CelixExecutorTestSuite, ScheduleTasks) {
+    executor_test_data oneShot{};
+    executor_test_data periodic{};
+    long periodicId = -1L;
+
+    celix_bundleContext_useService(ctx, CELIX_EXECUTOR_SERVICE_NAME, &oneShot, [](void *handle, void *svc) {
+        auto *executor = static_cast<celix_executor_service_t*>(svc);
+        long id = executor->schedule(executor->handle, CELIX_EXECUTOR_PRIORITY_NORMAL, 0.01, 0, handle, executorTest_count);
+        EXPECT_GT(id, 0);
+    });
+    struct schedule_data {
+        executor_test_data *periodic;
+        long *id;
+    } sd{&periodic, &periodicId};
+    celix_bundleContext_useService(ctx, CELIX_EXECUTOR_SERVICE_NAME, &sd, [](void *handle, void *svc) {
+        auto *executor = static_cast<celix_executor_service_t*>(svc);
+        auto *d = static_cast<schedule_data*>(handle);
+        *d->id = executor->schedule(executor->handle, CELIX_EXECUTOR_PRIORITY_LOW, 0, 0.005, d->periodic, executorTest_count);
+    });
+    EXPECT_GT(periodicId, 0);
+
+    EXPECT_TRUE(oneShot.waitForCount(1));
+    EXPECT_TRUE(periodic.waitForCount(3));
+
+    bool cancelled = false;
+    struct cancel_data {
+        long id;
+        bool *cancelled;
+    } cd{periodicId, &cancelled};
+    celix_bundleContext_useService(ctx, CELIX_EXECUTOR_SERVICE_NAME, &cd, [](void *handle, void *svc) {
+        auto *executor = static_cast<celix_executor_service_t*>(svc);
+        auto *d = static_cast<cancel_data*>(handle);
+        *d->cancelled = executor->cancel(executor->handle, d->id);
+        EXPECT_FALSE(executor->cancel(executor->handle, d->id)); //already cancelled
+    });
+    EXPECT_TRUE(cancelled);
+
+    //note cancel waits for an active execution, so the count is final
+    int count = periodic.getCount();
+    executorTest_waitForScheduledTask(ctx, 0.05);
+    EXPECT_EQ(count, periodic.getCount()); //no executions after cancel
+    EXPECT_EQ(1, oneShot.getCount());
+}
+
+TEST_F(CelixExecutorTestSuite, SchedulerStatistics) {
+    executor_test_data data{};
+    auto start = std::chrono::steady_clock::now();
+    celix_bundleContext_useService(ctx, CELIX_EXECUTOR_SERVICE_NAME, &data, [](void *handle, void *svc) {
+        auto *executor = static_cast<celix_executor_service_t*>(svc);
+        executor->schedule(executor->handle, CELIX_EXECUTOR_PRIORITY_NORMAL, 0.05, 0, handle, executorTest_count);
+        executor->schedule(executor->handle, CELIX_EXECUTOR_PRIORITY_NORMAL, 1000, 0, handle, executorTest_count);
+    });
+
+    EXPECT_TRUE(data.waitForCount(1));
+    {
+        std::lock_guard<std::mutex> lock{data.mutex};
+        EXPECT_EQ(1, data.count);
+        EXPECT_GE(data.lastExecution - start, std::chrono::milliseconds{50}); //timers should not fire early
+    }
+
+    celix_executor_scheduler_statistics_t stats{};
+    celix_bundleContext_useService(ctx, CELIX_EXECUTOR_SERVICE_NAME, &stats, [](void *handle, void *svc) {
+        auto *executor = static_cast<celix_executor_service_t*>(svc);
+        executor->getSchedulerStatistics(executor->handle, static_cast<celix_executor_scheduler_statistics_t*>(handle));
+    });
+    EXPECT_EQ(1, stats.nrOfScheduledTasks);
+    EXPECT_EQ(1, stats.nrOfExecutions);
+    EXPECT_EQ(0, stats.nrOfSkippedExecutions);
+    EXPECT_GE(stats.maxLagInSeconds, stats.averageLagInSeconds);
+}
+
+TEST_F(CelixExecutorTestSuite, CancelScheduledTasksOfStoppedBundle) {
+    long bndId = celix_bundleContext_installBundle(ctx, SIMPLE_TEST_BUNDLE1_LOCATION, true);
+    ASSERT_GE(bndId, 0);
+
+    executor_test_data data{};
+    celix_framework_useBundle(fw, true, bndId, &data, [](void *handle, const celix_bundle_t *bnd) {
+        celix_bundle_context_t *bndCtx = nullptr;
+        bundle_getContext((celix_bundle_t*)bnd, &bndCtx);
+        ASSERT_NE(nullptr, bndCtx);
+        celix_bundleContext_useService(bndCtx, CELIX_EXECUTOR_SERVICE_NAME, handle, [](void *handle, void *svc) {
+            auto *executor = static_cast<celix_executor_service_t*>(svc);
+            long id = executor->schedule(executor->handle, CELIX_EXECUTOR_PRIORITY_NORMAL, 0, 0.005, handle, executorTest_count);
+            EXPECT_GT(id, 0);
+        });
+    });
+
+    EXPECT_TRUE(data.waitForCount(1));
+
+    //note stopping the bundle waits for an active execution, so the count is final
+    celix_bundleContext_stopBundle(ctx, bndId);
+    int count = data.getCount();
+    executorTest_waitForScheduledTask(ctx, 0.05);
+    EXPECT_EQ(count, data.getCount()); //scheduled task cancelled when the bundle is stopped
+}
+
+TEST_F(CelixExecutorSingleThreadTestSuite, CancelQueuedScheduledTaskFromTask) {
+    executor_test_data data{};
+    executor_test_data scheduled{};
+    struct cancel_data {
+        executor_test_data *data;
+        executor_test_data *scheduled;
+    } cd{&data, &scheduled};
+    bool called = celix_bundleContext_useService(ctx, CELIX_EXECUTOR_SERVICE_NAME, &cd, [](void *handle, void *svc) {
+        auto *executor = static_cast<celix_executor_service_t*>(svc);
+        auto *d = static_cast<cancel_data*>(handle);
+        d->data->svc = executor;
+        executor->submit(executor->handle, CELIX_EXECUTOR_PRIORITY_NORMAL, handle, [](void *h) {
+            //note the only executor thread runs this task, so the scheduled task is queued but cannot start
+            auto *d = static_cast<cancel_data*>(h);
+            auto *svc = d->data->svc;
+            long id = svc->schedule(svc->handle, CELIX_EXECUTOR_PRIORITY_HIGH, 0, 0.001, d->scheduled, executorTest_count);
+            EXPECT_GT(id, 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds{50});
+            EXPECT_TRUE(svc->cancel(svc->handle, id)); //should not wait for the queued execution
+            executorTest_count(d->data);
+        });
+    });
+    EXPECT_TRUE(called);
+    EXPECT_TRUE(data.waitForCount(1));
+
+    executorTest_waitForScheduledTask(ctx, 0.05);
+    EXPECT_EQ(0, scheduled.getCount()); //queued execution skipped
+}
+
+TEST_F(CelixExecutorSingleThreadTestSuite, SchedulerLagIncludesQueuedTime) {
+    executor_test_data data{};
+    bool called = celix_bundleContext_useService(ctx, CELIX_EXECUTOR_SERVICE_NAME, &data, [](void *handle, void *svc) {
+        auto *executor = static_cast<celix_executor_service_t*>(svc);
+        executor->schedule(executor->handle, CELIX_EXECUTOR_PRIORITY_NORMAL, 0.01, 0, handle, executorTest_count);
+        executor->submit(executor->handle, CELIX_EXECUTOR_PRIORITY_NORMAL, nullptr, [](void *) {
+            //keep the only executor thread busy, while the scheduled task is due
+            std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        });
+    });
+    EXPECT_TRUE(called);
+    EXPECT_TRUE(data.waitForCount(1));
+
+    celix_executor_scheduler_statistics_t stats{};
+    celix_bundleContext_useService(ctx, CELIX_EXECUTOR_SERVICE_NAME, &stats, [](void *handle, void *svc) {
+        auto *executor = static_cast<celix_executor_service_t*>(svc);
+        executor->getSchedulerStatistics(executor->handle, static_cast<celix_executor_scheduler_statistics_t*>(handle));
+    });
+    EXPECT_EQ(1, stats.nrOfExecutions);
+    EXPECT_GE(stats.maxLagInSeconds, 0.05);
+}
@@ -258,6 +258,56 @@ TEST_F(DependencyManagerTestSuite, AddSvcDepAfterBuild) {
     celix_bundleContext_unregisterService(ctx, svcId2);
 }
 
+class CmpWithPropertiesView {
+public:
+    void setService(const TestService*, const celix::dm::PropertiesView& props) {
+        rank = props.getAsLong("rank", -1);
+    }
+
+    long rank = -1;
+};
+
+TEST_F(DependencyManagerTestSuite, PropertiesViewCallbacks) {
+    celix::dm::DependencyManager dm{ctx};
+    auto& cmp = dm.createComponent<CmpWithPropertiesView>(std::make_shared<CmpWithPropertiesView>(), "test1");
+
+    std::atomic<int> count{0};
+    std::string value{};
+    std::size_t size = 0;
+    celix::dm::Properties copy{};
+    cmp.createCServiceDependency<TestService>("TestService")
+            .setCallbacks(
+                    std::function<void(const TestService*, const celix::dm::PropertiesView&)>{[&](const TestService*, const celix::dm::PropertiesView& props) {
+                        count++;
+                        value = props.get("key", "");
+                        size = props.size();
+                        copy = props.toProperties();
+                    }},
+                    std::function<void(const TestService*, const celix::dm::PropertiesView&)>{[&count](const TestService*, const celix::dm::PropertiesView& props) {
+                        EXPECT_TRUE(props.getAsBool("bool", false));
+                        count--;
+                    }});
+    cmp.createCServiceDependency<TestService>("TestService")
+            .setCallbacks(&CmpWithPropertiesView::setService);
+    cmp.build();
+
+    TestService svc{};
+    auto* props = celix_properties_create();
+    celix_properties_set(props, "key", "value");
+    celix_properties_setLong(props, "rank", 42);
+    celix_properties_setBool(props, "bool", true);
+    long svcId = celix_bundleContext_registerService(ctx, &svc, "TestService", props);
+
+    EXPECT_EQ(1, count);
+    EXPECT_EQ("value", value);
+    EXPECT_EQ(copy.size(), size);
+    EXPECT_EQ("42", copy["rank"]);
+    EXPECT_EQ(42, cmp.getInstance().rank);
+
+    celix_bundleContext_unregisterService(ctx, svcId);
+    EXPECT_EQ(0, count);
+}
+
 TEST_F(DependencyManagerTestSuite, InCompleteBuildShouldNotLeak) {
     celix::dm::DependencyManager dm{ctx};
     dm.createComponent<TestComponent>(std::make_shared<TestComponent>(), "test1"); //note not build
@@ -27,6 +27,9 @@
 #include <condition_variable>
 #include <string.h>
 #include <future>
+#include <vector>
+#include <atomic>
+#include <functional>
 
 #include "celix_api.h"
 #include "celix_framework_factory.h"
@@ -489,6 +492,56 @@ TEST_F(CelixBundleContextServicesTests, servicesTrackerTest) {
     celix_bundleContext_unregisterService(ctx, svcId2);
 }
 
+TEST_F(CelixBundleContextServicesTests, concurrentUseServicesWhileUnregistering) {
+    //After unregister returns, a service should not be in use by the lock-free use calls of a tracker
+    struct test_svc {
+        std::atomic<bool> valid;
+    };
+    auto *tracker = celix_serviceTracker_create(ctx, "calc", nullptr, nullptr);
+    std::atomic<bool> running{true};
+    std::atomic<int> errors{0};
+    std::atomic<int> nrOfStartedUsers{0};
+
+    auto checkValid = [](void *handle, void *svc) {
+        if (!static_cast<test_svc*>(svc)->valid.load()) {
+            (*static_cast<std::atomic<int>*>(handle))++;
+        }
+    };
+    std::vector<std::thread> users{};
+    for (int t = 0; t < 4; ++t) {
+        users.emplace_back([&]{
+            nrOfStartedUsers++;
+            while (running.load()) {
+                celix_serviceTracker_useServices(tracker, "calc", &errors, checkValid, nullptr, nullptr);
+                celix_serviceTracker_useHighestRankingService(tracker, "calc", &errors, checkValid, nullptr, nullptr);
+            }
+        });
+    }
+
+    while (nrOfStartedUsers.load() < 4) {
+        std::this_thread::yield();
+    }
+    test_svc other{};
+    other.valid = true;
+    long otherSvcId = celix_bundleContext_registerService(ctx, &other, "calc", nullptr);
+    for (int i = 0; i < 100; ++i) {
+        auto *svc = new test_svc{};
+        svc->valid = true;
+        long svcId = celix_bundleContext_registerService(ctx, svc, "calc", nullptr);
+        EXPECT_GE(svcId, 0);
+        celix_bundleContext_unregisterService(ctx, svcId);
+        svc->valid = false; //would be seen by a user which still uses the service
+        delete svc;
+    }
+    running = false;
+    for (auto& user : users) {
+        user.join();
+    }
+    EXPECT_EQ(0, errors.load());
+    celix_bundleContext_unregisterService(ctx, otherSvcId);
+    celix_serviceTracker_destroy(tracker);
+}
+
 TEST_F(CelixBundleContextServicesTests, servicesTrackerTestAsync) {
     std::atomic<int> count {0};
     auto add = [](void *handle, void *svc) {
@@ -826,6 +879,171 @@ TEST_F(CelixBundleContextServicesTests, servicesTrackerSetTest) {
     ASSERT_EQ(4, count); //check if the set is called the expected times
 }
 
+TEST_F(CelixBundleContextServicesTests, useHighestRankingService) {
+    long svcId1 = celix_bundleContext_registerService(ctx, (void*)0x100, "NA", nullptr); //ranking 0
+    auto *props2 = celix_properties_create();
+    celix_properties_setLong(props2, OSGI_FRAMEWORK_SERVICE_RANKING, 10);
+    long svcId2 = celix_bundleContext_registerService(ctx, (void*)0x200, "NA", props2);
+    auto *props3 = celix_properties_create();
+    celix_properties_setLong(props3, OSGI_FRAMEWORK_SERVICE_RANKING, 5);
+    long svcId3 = celix_bundleContext_registerService(ctx, (void*)0x300, "NA", props3);
+    auto *props4 = celix_properties_create();
+    celix_properties_setLong(props4, OSGI_FRAMEWORK_SERVICE_RANKING, 10);
+    long svcId4 = celix_bundleContext_registerService(ctx, (void*)0x400, "NA", props4); //same ranking, higher svc id
+
+    auto *tracker = celix_serviceTracker_create(ctx, "NA", nullptr, nullptr);
+    long used = 0;
+    auto use = [](void *handle, void *svc) {
+        *static_cast<long*>(handle) = (long)svc;
+    };
+    EXPECT_TRUE(celix_serviceTracker_useHighestRankingService(tracker, "NA", &used, use, nullptr, nullptr));
+    EXPECT_EQ(0x200, used);
+    EXPECT_TRUE(celix_bundleContext_useService(ctx, "NA", &used, use));
+    EXPECT_EQ(0x200, used);
+
+    //use services is called in ranking order
+    std::vector<long> order{};
+    celix_serviceTracker_useServices(tracker, "NA", &order, [](void *handle, void *svc) {
+        static_cast<std::vector<long>*>(handle)->push_back((long)svc);
+    }, nullptr, nullptr);
+    EXPECT_EQ((std::vector<long>{0x200, 0x400, 0x300, 0x100}), order);
+
+    celix_bundleContext_unregisterService(ctx, svcId2);
+    EXPECT_TRUE(celix_serviceTracker_useHighestRankingService(tracker, "NA", &used, use, nullptr, nullptr));
+    EXPECT_EQ(0x400, used);
+    EXPECT_FALSE(celix_serviceTracker_useHighestRankingService(tracker, "other", &used, use, nullptr, nullptr));
+
+    celix_serviceTracker_destroy(tracker);
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    celix_bundleContext_unregisterService(ctx, svcId3);
+    celix_bundleContext_unregisterService(ctx, svcId4);
+}
+
+TEST_F(CelixBundleContextServicesTests, servicesTrackerSetOnModifiedRanking) {
+    struct set_data {
+        long current = 0;
+        int count = 0;
+    } data{};
+    auto set = [](void *handle, void *svc) {
+        auto *d = static_cast<set_data*>(handle);
+        d->current = (long)svc;
+        d->count += 1;
+    };
+    auto useOrder = [](service_tracker_t *tracker) {
+        std::vector<long> order{};
+        celix_serviceTracker_useServices(tracker, "NA", &order, [](void *handle, void *svc) {
+            static_cast<std::vector<long>*>(handle)->push_back((long)svc);
+        }, nullptr, nullptr);
+        return order;
+    };
+
+    //note using the deprecated api, to get the service registrations. The language is set for the default tracker filter
+    auto createProps = [](long ranking) {
+        auto *props = celix_properties_create();
+        celix_properties_set(props, CELIX_FRAMEWORK_SERVICE_LANGUAGE, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE);
+        celix_properties_setLong(props, OSGI_FRAMEWORK_SERVICE_RANKING, ranking);
+        return props;
+    };
+    service_registration_t *reg1 = nullptr;
+    service_registration_t *reg2 = nullptr;
+    bundleContext_registerService(ctx, "NA", (void*)0x100, createProps(0), &reg1);
+    bundleContext_registerService(ctx, "NA", (void*)0x200, createProps(5), &reg2);
+    ASSERT_NE(nullptr, reg1);
+    ASSERT_NE(nullptr, reg2);
+
+    celix_service_tracking_options_t opts{};
+    opts.callbackHandle = &data;
+    opts.filter.serviceName = "NA";
+    opts.set = set;
+    long trackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+    ASSERT_TRUE(trackerId >= 0);
+    auto *tracker = celix_serviceTracker_create(ctx, "NA", nullptr, nullptr);
+    EXPECT_EQ(0x200, data.current);
+    EXPECT_EQ((std::vector<long>{0x200, 0x100}), useOrder(tracker));
+    int count = data.count; //note set can be called for svc1 and svc2 when the tracker is opened
+
+    //modify ranking of svc1 to the highest ranking -> re-ordered and set called with svc1
+    EXPECT_EQ(CELIX_SUCCESS, serviceRegistration_setProperties(reg1, createProps(10)));
+    EXPECT_EQ(0x100, data.current);
+    EXPECT_EQ(count + 1, data.count);
+    EXPECT_EQ((std::vector<long>{0x100, 0x200}), useOrder(tracker));
+    long used = 0;
+    EXPECT_TRUE(celix_serviceTracker_useHighestRankingService(tracker, "NA", &used, [](void *handle, void *svc) {
+        *static_cast<long*>(handle) = (long)svc;
+    }, nullptr, nullptr));
+    EXPECT_EQ(0x100, used);
+
+    //modify properties without changing the ranking -> no set call
+    auto *props1 = createProps(10);
+    celix_properties_set(props1, "key", "value");
+    EXPECT_EQ(CELIX_SUCCESS, serviceRegistration_setProperties(reg1, props1));
+    EXPECT_EQ(count + 1, data.count);
+
+    //lower ranking of svc1 -> svc2 is the highest ranking service again
+    EXPECT_EQ(CELIX_SUCCESS, serviceRegistration_setProperties(reg1, createProps(-1)));
+    EXPECT_EQ(0x200, data.current);
+    EXPECT_EQ(count + 2, data.count);
+    EXPECT_EQ((std::vector<long>{0x200, 0x100}), useOrder(tracker));
+
+    celix_serviceTracker_destroy(tracker);
+    celix_bundleContext_stopTracker(ctx, trackerId);
+    serviceRegistration_unregister(reg1);
+    serviceRegistration_unregister(reg2);
+}
+
+TEST_F(CelixBundleContextServicesTests, setPropertiesWhileUsingServiceProperties) {
+    auto createProps = [](long value) {
+        auto *props = celix_properties_create();
+        celix_properties_set(props, CELIX_FRAMEWORK_SERVICE_LANGUAGE, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE);
+        celix_properties_setLong(props, "value", value);
+        return props;
+    };
+    service_registration_t *reg = nullptr;
+    bundleContext_registerService(ctx, "NA", (void*)0x100, createProps(0), &reg);
+    ASSERT_NE(nullptr, reg);
+    auto *tracker = celix_serviceTracker_create(ctx, "NA", nullptr, nullptr);
+
+    //replace the properties in the use callback -> the used properties stay valid till the callback returns
+    struct use_data {
+        service_registration_t *reg;
+        std::function<celix_properties_t*(long)> createProps;
+        long before;
+        long after;
+    } data{reg, createProps, -1, -1};
+    celix_serviceTracker_useServices(tracker, "NA", &data, nullptr, [](void *handle, void */*svc*/, const celix_properties_t *props) {
+        auto *d = static_cast<use_data*>(handle);
+        d->before = celix_properties_getAsLong(props, "value", -1);
+        serviceRegistration_setProperties(d->reg, d->createProps(1));
+        d->after = celix_properties_getAsLong(props, "value", -1);
+    }, nullptr);
+    EXPECT_EQ(0, data.before);
+    EXPECT_EQ(0, data.after);
+
+    //replace the properties concurrently with using them
+    std::atomic<bool> stop{false};
+    std::thread user{[&] {
+        while (!stop) {
+            celix_serviceTracker_useServices(tracker, "NA", nullptr, nullptr, [](void */*handle*/, void */*svc*/, const celix_properties_t *props) {
+                EXPECT_GE(celix_properties_getAsLong(props, "value", -1), 1);
+            }, nullptr);
+        }
+    }};
+    for (long i = 2; i < 200; ++i) {
+        EXPECT_EQ(CELIX_SUCCESS, serviceRegistration_setProperties(reg, createProps(i)));
+    }
+    stop = true;
+    user.join();
+
+    long value = -1;
+    celix_serviceTracker_useServices(tracker, "NA", &value, nullptr, [](void *handle, void */*svc*/, const celix_properties_t *props) {
+        *static_cast<long*>(handle) = celix_properties_getAsLong(props, "value", -1);
+    }, nullptr);
+    EXPECT_EQ(199, value);
+
+    celix_serviceTracker_destroy(tracker);
+    serviceRegistration_unregister(reg);
+}
+
 TEST_F(CelixBundleContextServicesTests, trackAllServices) {
     std::atomic<size_t> count{0};
 
@@ -849,7 +1067,7 @@ TEST_F(CelixBundleContextServicesTests, trackAllServices) {
     };
     long trackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
     EXPECT_GE(trackerId, 0);
-    EXPECT_EQ(4, count.load());
+    EXPECT_EQ(5, count.load()); //4 + the framework provided executor service
 
     celix_bundleContext_unregisterService(ctx, svcId1);
     celix_bundleContext_unregisterService(ctx, svcId2);
@@ -1184,7 +1402,7 @@ TEST_F(CelixBundleContextServicesTests, onlyCallAsyncCallbackWithAsyncApi) {
     long svcId = celix_bundleContext_registerServiceWithOptions(ctx, &opts2);
     EXPECT_GT(svcId, 0);
     celix_bundleContext_waitForEvents(ctx);
-    celix_bundleContext_unregisterService(ctx, trkId);
+    celix_bundleContext_unregisterService(ctx, svcId);
 
     celix_bundle_tracking_options_t opts3{};
     opts3.trackerCreatedCallback = [](void *) {
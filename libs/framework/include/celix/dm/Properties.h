@@ -22,6 +22,96 @@
 #include <map>
 #include <string>
 
+#include "celix_properties.h"
+
 namespace celix { namespace dm {
     using Properties = std::map<std::string, std::string>;
+
+    /**
+     * A non-owning, read-only view on the C properties of a service.
+     *
+     * Used for the service dependency callbacks, so that the service properties do not have to be copied
+     * into a celix::dm::Properties map for every set/add/remove callback.
+     * Note that a PropertiesView is only valid during the callback it is provided to;
+     * use toProperties() to keep a copy of the properties.
+     */
+    class PropertiesView {
+    public:
+        explicit PropertiesView(const celix_properties_t* props) : cProps{props} {}
+
+        /**
+         * Returns the value for the provided key or the defaultValue if the key is not present.
+         */
+        const char* get(const char* key, const char* defaultValue = nullptr) const {
+            return cProps == nullptr ? defaultValue : celix_properties_get(cProps, key, defaultValue);
+        }
+
+        const char* get(const std::string& key, const char* defaultValue = nullptr) const {
+            return get(key.c_str(), defaultValue);
+        }
+
+        /**
+         * Returns the value for the provided key as long or the defaultValue if the key is not present or
+         * is not a valid long.
+         */
+        long getAsLong(const char* key, long defaultValue) const {
+            return cProps == nullptr ? defaultValue : celix_properties_getAsLong(cProps, key, defaultValue);
+        }
+
+        /**
+         * Returns the value for the provided key as double or the defaultValue if the key is not present or
+         * is not a valid double.
+         */
+        double getAsDouble(const char* key, double defaultValue) const {
+            return cProps == nullptr ? defaultValue : celix_properties_getAsDouble(cProps, key, defaultValue);
+        }
+
+        /**
+         * Returns the value for the provided key as bool or the defaultValue if the key is not present or
+         * is not a valid bool.
+         */
+        bool getAsBool(const char* key, bool defaultValue) const {
+            return cProps == nullptr ? defaultValue : celix_properties_getAsBool(cProps, key, defaultValue);
+        }
+
+        std::size_t size() const {
+            return cProps == nullptr ? 0 : (std::size_t)celix_properties_size(cProps);
+        }
+
+        bool empty() const {
+            return size() == 0;
+        }
+
+        /**
+         * Calls f(const char* key, const char* value) for every entry.
+         */
+        template<typename F>
+        void forEach(F&& f) const {
+            if (cProps != nullptr) {
+                celix_properties_iterator_t iter = celix_propertiesIterator_construct(cProps);
+                while (celix_propertiesIterator_hasNext(&iter)) {
+                    const char* key = celix_propertiesIterator_nextKey(&iter);
+                    f(key, celix_properties_get(cProps, key, "")); //note. C++ does not allow nullptr entries for std::string
+                }
+            }
+        }
+
+        /**
+         * Creates a (owning) copy of the properties.
+         */
+        Properties toProperties() const {
+            Properties result{};
+            forEach([&result](const char* key, const char* value) {
+                result[key] = value;
+            });
+            return result;
+        }
+
+        /**
+         * Returns the underlining C properties. Can be nullptr.
+         */
+        const celix_properties_t* cProperties() const { return cProps; }
+    private:
+        const celix_properties_t* cProps;
+    };
 }}
@@ -172,6 +172,22 @@ namespace celix { namespace dm {
          */
         CServiceDependency<T,I>& setCallbacks(std::function<void(const I* service, Properties&& properties)> set);
 
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The service properties are provided as a non-owning view, so no copy of the properties is made.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        CServiceDependency<T,I>& setCallbacks(void (T::*set)(const I* service, const PropertiesView& properties));
+
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The service properties are provided as a non-owning view, so no copy of the properties is made.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        CServiceDependency<T,I>& setCallbacks(std::function<void(const I* service, const PropertiesView& properties)> set);
+
         /**
          * Set the add and remove callback for when the services of service dependency are added or removed.
          *
@@ -199,6 +215,28 @@ namespace celix { namespace dm {
                 std::function<void(const I* service, Properties&& properties)> remove
         );
 
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The service properties are provided as a non-owning view, so no copy of the properties is made.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        CServiceDependency<T,I>& setCallbacks(
+                void (T::*add)(const I* service, const PropertiesView& properties),
+                void (T::*remove)(const I* service, const PropertiesView& properties)
+        );
+
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The service properties are provided as a non-owning view, so no copy of the properties is made.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        CServiceDependency<T,I>& setCallbacks(
+                std::function<void(const I* service, const PropertiesView& properties)> add,
+                std::function<void(const I* service, const PropertiesView& properties)> remove
+        );
+
         /**
          * Specify if the service dependency should add a service.lang filter part if it is not already present
          * For C service dependencies 'service.lang=C' will be added.
@@ -216,12 +254,13 @@ namespace celix { namespace dm {
         std::string filter {};
         std::string versionRange {};
 
-        std::function<void(const I* service, Properties&& properties)> setFp{nullptr};
-        std::function<void(const I* service, Properties&& properties)> addFp{nullptr};
-        std::function<void(const I* service, Properties&& properties)> removeFp{nullptr};
+        std::function<void(const I* service, const PropertiesView& properties)> setFp{nullptr};
+        std::function<void(const I* service, const PropertiesView& properties)> addFp{nullptr};
+        std::function<void(const I* service, const PropertiesView& properties)> removeFp{nullptr};
 
+        static std::function<void(const I*, const PropertiesView&)> toViewCallback(std::function<void(const I*, Properties&&)> fp);
         void setupCallbacks();
-        int invokeCallback(std::function<void(const I*, Properties&&)> fp, const celix_properties_t *props, const void* service);
+        int invokeCallback(const std::function<void(const I*, const PropertiesView&)>& fp, const celix_properties_t *props, const void* service);
 
         void setupService();
     };
@@ -280,6 +319,22 @@ namespace celix { namespace dm {
          */
         ServiceDependency<T,I>& setCallbacks(std::function<void(I* service, Properties&& properties)> set);
 
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The service properties are provided as a non-owning view, so no copy of the properties is made.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        ServiceDependency<T,I>& setCallbacks(void (T::*set)(I* service, const PropertiesView& properties));
+
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The service properties are provided as a non-owning view, so no copy of the properties is made.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        ServiceDependency<T,I>& setCallbacks(std::function<void(I* service, const PropertiesView& properties)> set);
+
         /**
          * Set the add and remove callback for when the services of service dependency are added or removed.
          *
@@ -307,6 +362,28 @@ namespace celix { namespace dm {
                 std::function<void(I* service, Properties&& properties)> remove
         );
 
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The service properties are provided as a non-owning view, so no copy of the properties is made.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        ServiceDependency<T,I>& setCallbacks(
+                void (T::*add)(I* service, const PropertiesView& properties),
+                void (T::*remove)(I* service, const PropertiesView& properties)
+        );
+
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The service properties are provided as a non-owning view, so no copy of the properties is made.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        ServiceDependency<T,I>& setCallbacks(
+                std::function<void(I* service, const PropertiesView& properties)> add,
+                std::function<void(I* service, const PropertiesView& properties)> remove
+        );
+
         /**
          * Specify if the service dependency is required. Default is false
          *
@@ -344,13 +421,14 @@ namespace celix { namespace dm {
         std::string versionRange {};
         std::string modifiedFilter {};
 
-        std::function<void(I* service, Properties&& properties)> setFp{nullptr};
-        std::function<void(I* service, Properties&& properties)> addFp{nullptr};
-        std::function<void(I* service, Properties&& properties)> removeFp{nullptr};
+        std::function<void(I* service, const PropertiesView& properties)> setFp{nullptr};
+        std::function<void(I* service, const PropertiesView& properties)> addFp{nullptr};
+        std::function<void(I* service, const PropertiesView& properties)> removeFp{nullptr};
 
+        static std::function<void(I*, const PropertiesView&)> toViewCallback(std::function<void(I*, Properties&&)> fp);
         void setupService();
         void setupCallbacks();
-        int invokeCallback(std::function<void(I*, Properties&&)> fp, const celix_properties_t *props, const void* service);
+        int invokeCallback(const std::function<void(I*, const PropertiesView&)>& fp, const celix_properties_t *props, const void* service);
     };
 }}
 
@@ -101,25 +101,41 @@ CServiceDependency<T,I>& CServiceDependency<T,I>::setStrategy(DependencyUpdateSt
 //set callbacks
 template<class T, typename I>
 CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(void (T::*set)(const I* service)) {
-    this->setCallbacks([this, set](const I* service, [[gnu::unused]] Properties&& properties) {
+    this->setCallbacks(std::function<void(const I*, const PropertiesView&)>{[this, set](const I* service, const PropertiesView& /*properties*/) {
         T *cmp = this->componentInstance;
         (cmp->*set)(service);
-    });
+    }});
     return *this;
 }
 
 template<class T, typename I>
 CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(void (T::*set)(const I* service, Properties&& properties)) {
-    this->setCallbacks([this, set](const I* service, Properties&& properties) {
+    this->setCallbacks(std::function<void(const I*, const PropertiesView&)>{[this, set](const I* service, const PropertiesView& properties) {
         T *cmp = this->componentInstance;
-        (cmp->*set)(service, std::move(properties));
-    });
+        (cmp->*set)(service, properties.toProperties());
+    }});
+    return *this;
+}
+
+template<class T, typename I>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(void (T::*set)(const I* service, const PropertiesView& properties)) {
+    this->setCallbacks(std::function<void(const I*, const PropertiesView&)>{[this, set](const I* service, const PropertiesView& properties) {
+        T *cmp = this->componentInstance;
+        (cmp->*set)(service, properties);
+    }});
     return *this;
 }
 
 template<class T, typename I>
 CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(std::function<void(const I* service, Properties&& properties)> set) {
-    this->setFp = set;
+    this->setFp = toViewCallback(std::move(set));
+    this->setupCallbacks();
+    return *this;
+}
+
+template<class T, typename I>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(std::function<void(const I* service, const PropertiesView& properties)> set) {
+    this->setFp = std::move(set);
     this->setupCallbacks();
     return *this;
 }
@@ -130,14 +146,14 @@ CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(
         void (T::*add)(const I* service),
         void (T::*remove)(const I* service)) {
     this->setCallbacks(
-            [this, add](const I* service, [[gnu::unused]] Properties&& properties) {
+            std::function<void(const I*, const PropertiesView&)>{[this, add](const I* service, const PropertiesView& /*properties*/) {
                 T *cmp = this->componentInstance;
                 (cmp->*add)(service);
-            },
-            [this, remove](const I* service, [[gnu::unused]] Properties&& properties) {
+            }},
+            std::function<void(const I*, const PropertiesView&)>{[this, remove](const I* service, const PropertiesView& /*properties*/) {
                 T *cmp = this->componentInstance;
                 (cmp->*remove)(service);
-            }
+            }}
     );
     return *this;
 }
@@ -148,26 +164,66 @@ CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(
         void (T::*remove)(const I* service, Properties&& properties)
 ) {
     this->setCallbacks(
-            [this, add](const I* service, Properties&& properties) {
+            std::function<void(const I*, const PropertiesView&)>{[this, add](const I* service, const PropertiesView& properties) {
                 T *cmp = this->componentInstance;
-                (cmp->*add)(service, std::move(properties));
-            },
-            [this, remove](const I* service, Properties&& properties) {
+                (cmp->*add)(service, properties.toProperties());
+            }},
+            std::function<void(const I*, const PropertiesView&)>{[this, remove](const I* service, const PropertiesView& properties) {
                 T *cmp = this->componentInstance;
-                (cmp->*remove)(service, std::move(properties));
-            }
+                (cmp->*remove)(service, properties.toProperties());
+            }}
+    );
+    return *this;
+}
+
+template<class T, typename I>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(
+        void (T::*add)(const I* service, const PropertiesView& properties),
+        void (T::*remove)(const I* service, const PropertiesView& properties)
+) {
+    this->setCallbacks(
+            std::function<void(const I*, const PropertiesView&)>{[this, add](const I* service, const PropertiesView& properties) {
+                T *cmp = this->componentInstance;
+                (cmp->*add)(service, properties);
+            }},
+            std::function<void(const I*, const PropertiesView&)>{[this, remove](const I* service, const PropertiesView& properties) {
+                T *cmp = this->componentInstance;
+                (cmp->*remove)(service, properties);
+            }}
     );
     return *this;
 }
 
 template<class T, typename I>
-CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(std::function<void(const I* service, Properties&& properties)> add, std::function<void(const I* service, Properties&& properties)> remove) {
-    this->addFp = add;
-    this->removeFp = remove;
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(
+        std::function<void(const I* service, Properties&& properties)> add,
+        std::function<void(const I* service, Properties&& properties)> remove) {
+    this->addFp = toViewCallback(std::move(add));
+    this->removeFp = toViewCallback(std::move(remove));
     this->setupCallbacks();
     return *this;
 }
 
+template<class T, typename I>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(
+        std::function<void(const I* service, const PropertiesView& properties)> add,
+        std::function<void(const I* service, const PropertiesView& properties)> remove) {
+    this->addFp = std::move(add);
+    this->removeFp = std::move(remove);
+    this->setupCallbacks();
+    return *this;
+}
+
+template<class T, typename I>
+std::function<void(const I*, const PropertiesView&)> CServiceDependency<T,I>::toViewCallback(std::function<void(const I*, Properties&&)> fp) {
+    if (!fp) {
+        return nullptr;
+    }
+    //note legacy callbacks get an owning copy of the properties.
+    return [fp](const I* service, const PropertiesView& properties) {
+        fp(service, properties.toProperties());
+    };
+}
 
 template<class T, typename I>
 void CServiceDependency<T,I>::setupCallbacks() {
@@ -207,28 +263,13 @@ void CServiceDependency<T,I>::setupCallbacks() {
 }
 
 template<class T, typename I>
-int CServiceDependency<T,I>::invokeCallback(std::function<void(const I*, Properties&&)> fp, const celix_properties_t *props, const void* service) {
-    Properties properties {};
-    const char* key {nullptr};
-    const char* value {nullptr};
-
-    if (props != nullptr) {
-        hash_map_iterator_t iter = hashMapIterator_construct((hash_map_pt)props);
-        while(hashMapIterator_hasNext(&iter)) {
-            key = (const char*) hashMapIterator_nextKey(&iter);
-            value = celix_properties_get(props, key, ""); //note. C++ does not allow nullptr entries for std::string
-            //std::cout << "got property " << key << "=" << value << "\n";
-            properties[key] = value;
-        }
-    }
-
-    const I* srv = (const I*) service;
-
-    fp(srv, std::move(properties));
+int CServiceDependency<T,I>::invokeCallback(const std::function<void(const I*, const PropertiesView&)>& fp, const celix_properties_t *props, const void* service) {
+    auto* svc = (const I*) service;
+    PropertiesView properties{props};
+    fp(svc, properties);
     return 0;
 }
 
-
 template<class T, class I>
 CServiceDependency<T,I>& CServiceDependency<T,I>::build() {
     this->runBuild();
@@ -329,25 +370,41 @@ ServiceDependency<T,I>& ServiceDependency<T,I>::setAddLanguageFilter(bool addLan
 //set callbacks
 template<class T, class I>
 ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(void (T::*set)(I* service)) {
-    this->setCallbacks([this, set](I* srv, [[gnu::unused]] Properties&& props) {
+    this->setCallbacks(std::function<void(I*, const PropertiesView&)>{[this, set](I* service, const PropertiesView& /*properties*/) {
         T *cmp = this->componentInstance;
-        (cmp->*set)(srv);
-    });
+        (cmp->*set)(service);
+    }});
     return *this;
 }
 
 template<class T, class I>
 ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(void (T::*set)(I* service, Properties&& properties)) {
-    this->setCallbacks([this, set](I* srv, Properties&& props) {
+    this->setCallbacks(std::function<void(I*, const PropertiesView&)>{[this, set](I* service, const PropertiesView& properties) {
         T *cmp = this->componentInstance;
-        (cmp->*set)(srv, std::move(props));
-    });
+        (cmp->*set)(service, properties.toProperties());
+    }});
+    return *this;
+}
+
+template<class T, class I>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(void (T::*set)(I* service, const PropertiesView& properties)) {
+    this->setCallbacks(std::function<void(I*, const PropertiesView&)>{[this, set](I* service, const PropertiesView& properties) {
+        T *cmp = this->componentInstance;
+        (cmp->*set)(service, properties);
+    }});
     return *this;
 }
 
 template<class T, class I>
 ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(std::function<void(I* service, Properties&& properties)> set) {
-    this->setFp = set;
+    this->setFp = toViewCallback(std::move(set));
+    this->setupCallbacks();
+    return *this;
+}
+
+template<class T, class I>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(std::function<void(I* service, const PropertiesView& properties)> set) {
+    this->setFp = std::move(set);
     this->setupCallbacks();
     return *this;
 }
@@ -358,14 +415,14 @@ ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(
         void (T::*add)(I* service),
         void (T::*remove)(I* service)) {
     this->setCallbacks(
-            [this, add](I* srv, [[gnu::unused]] Properties&& props) {
+            std::function<void(I*, const PropertiesView&)>{[this, add](I* service, const PropertiesView& /*properties*/) {
                 T *cmp = this->componentInstance;
-                (cmp->*add)(srv);
-            },
-            [this, remove](I* srv, [[gnu::unused]] Properties&& props) {
+                (cmp->*add)(service);
+            }},
+            std::function<void(I*, const PropertiesView&)>{[this, remove](I* service, const PropertiesView& /*properties*/) {
                 T *cmp = this->componentInstance;
-                (cmp->*remove)(srv);
-            }
+                (cmp->*remove)(service);
+            }}
     );
     return *this;
 }
@@ -376,14 +433,32 @@ ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(
         void (T::*remove)(I* service, Properties&& properties)
 ) {
     this->setCallbacks(
-            [this, add](I* srv, Properties&& props) {
+            std::function<void(I*, const PropertiesView&)>{[this, add](I* service, const PropertiesView& properties) {
                 T *cmp = this->componentInstance;
-                (cmp->*add)(srv, std::move(props));
-            },
-            [this, remove](I* srv, Properties&& props) {
+                (cmp->*add)(service, properties.toProperties());
+            }},
+            std::function<void(I*, const PropertiesView&)>{[this, remove](I* service, const PropertiesView& properties) {
                 T *cmp = this->componentInstance;
-                (cmp->*remove)(srv, std::move(props));
-            }
+                (cmp->*remove)(service, properties.toProperties());
+            }}
+    );
+    return *this;
+}
+
+template<class T, class I>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(
+        void (T::*add)(I* service, const PropertiesView& properties),
+        void (T::*remove)(I* service, const PropertiesView& properties)
+) {
+    this->setCallbacks(
+            std::function<void(I*, const PropertiesView&)>{[this, add](I* service, const PropertiesView& properties) {
+                T *cmp = this->componentInstance;
+                (cmp->*add)(service, properties);
+            }},
+            std::function<void(I*, const PropertiesView&)>{[this, remove](I* service, const PropertiesView& properties) {
+                T *cmp = this->componentInstance;
+                (cmp->*remove)(service, properties);
+            }}
     );
     return *this;
 }
@@ -392,12 +467,33 @@ template<class T, class I>
 ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(
         std::function<void(I* service, Properties&& properties)> add,
         std::function<void(I* service, Properties&& properties)> remove) {
-    this->addFp = add;
-    this->removeFp = remove;
+    this->addFp = toViewCallback(std::move(add));
+    this->removeFp = toViewCallback(std::move(remove));
+    this->setupCallbacks();
+    return *this;
+}
+
+template<class T, class I>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(
+        std::function<void(I* service, const PropertiesView& properties)> add,
+        std::function<void(I* service, const PropertiesView& properties)> remove) {
+    this->addFp = std::move(add);
+    this->removeFp = std::move(remove);
     this->setupCallbacks();
     return *this;
 }
 
+template<class T, class I>
+std::function<void(I*, const PropertiesView&)> ServiceDependency<T,I>::toViewCallback(std::function<void(I*, Properties&&)> fp) {
+    if (!fp) {
+        return nullptr;
+    }
+    //note legacy callbacks get an owning copy of the properties.
+    return [fp](I* service, const PropertiesView& properties) {
+        fp(service, properties.toProperties());
+    };
+}
+
 template<class T, class I>
 ServiceDependency<T,I>& ServiceDependency<T,I>::setRequired(bool req) {
     celix_dmServiceDependency_setRequired(this->cServiceDependency(), req);
@@ -411,24 +507,10 @@ ServiceDependency<T,I>& ServiceDependency<T,I>::setStrategy(DependencyUpdateStra
 }
 
 template<class T, class I>
-int ServiceDependency<T,I>::invokeCallback(std::function<void(I*, Properties&&)> fp, const celix_properties_t *props, const void* service) {
-    I *svc = (I*)service;
-
-    Properties properties {};
-    const char* key {nullptr};
-    const char* value {nullptr};
-
-    if (props != nullptr) {
-        hash_map_iterator_t iter = hashMapIterator_construct((hash_map_pt)props);
-        while(hashMapIterator_hasNext(&iter)) {
-            key = (const char*) hashMapIterator_nextKey(&iter);
-            value = celix_properties_get(props, key, "");
-            //std::cout << "got property " << key << "=" << value << "\n";
-            properties[key] = value;
-        }
-    }
-
-    fp(svc, std::move(properties)); //explicit move of lvalue properties.
+int ServiceDependency<T,I>::invokeCallback(const std::function<void(I*, const PropertiesView&)>& fp, const celix_properties_t *props, const void* service) {
+    auto* svc = (I*) service;
+    PropertiesView properties{props};
+    fp(svc, properties);
     return 0;
 }
 
@@ -37,6 +37,7 @@
 #include "celix_framework.h"
 #include "celix_framework_factory.h"
 #include "celix_launcher.h"
+#include "celix_executor_service.h"
 
 #include "celix_dependency_manager.h"
 #include "celix_dm_component.h"
@@ -85,6 +85,12 @@ static const char *const CELIX_LOAD_BUNDLES_WITH_NODELETE = "CELIX_LOAD_BUNDLES_
  */
 static const char *const CELIX_SYSTEM_BUNDLE_ARCHIVE_PATH = "CELIX_SYSTEM_BUNDLE_ARCHIVE_PATH";
 
+/**
+ * The number of threads of the framework executor (see celix_executor_service.h).
+ * Default (or if <= 0) the number of online cores is used.
+ */
+static const char *const CELIX_FRAMEWORK_EXECUTOR_NR_OF_THREADS = "CELIX_FRAMEWORK_EXECUTOR_NR_OF_THREADS";
+
 
 #define CELIX_AUTO_START_0 "CELIX_AUTO_START_0"
 #define CELIX_AUTO_START_1 "CELIX_AUTO_START_1"
@@ -0,0 +1,138 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_EXECUTOR_SERVICE_H_
+#define CELIX_EXECUTOR_SERVICE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "celix_errno.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CELIX_EXECUTOR_SERVICE_NAME         "celix_executor_service"
+#define CELIX_EXECUTOR_SERVICE_VERSION      "1.1.0"
+#define CELIX_EXECUTOR_SERVICE_USE_RANGE    "[1.0.0,2.0.0)"
+
+/**
+ * The priority of an executor task.
+ * Queued tasks with a higher priority are always picked up before queued tasks with a lower priority.
+ */
+typedef enum celix_executor_priority {
+    CELIX_EXECUTOR_PRIORITY_HIGH    = 0,
+    CELIX_EXECUTOR_PRIORITY_NORMAL  = 1,
+    CELIX_EXECUTOR_PRIORITY_LOW     = 2
+} celix_executor_priority_e;
+
+/**
+ * Statistics of the framework scheduler, shared by all bundles.
+ */
+typedef struct celix_executor_scheduler_statistics {
+    size_t nrOfScheduledTasks;      //The number of currently scheduled tasks
+    size_t nrOfExecutions;          //The number of times a scheduled task was due and executed
+    size_t nrOfSkippedExecutions;   //The number of periodic executions skipped, because the previous execution was still busy
+    double averageLagInSeconds;     //The average time between the due time and the start of the execution of a scheduled task
+    double maxLagInSeconds;         //The max time between the due time and the start of the execution of a scheduled task
+} celix_executor_scheduler_statistics_t;
+
+/**
+ * The executor service is registered by the framework bundle and executes tasks on a framework owned,
+ * work-stealing thread pool. Bundles can use this service instead of creating their own threads.
+ *
+ * The service is a service factory, every bundle gets its own instance. When a bundle is stopped the framework
+ * cancels the scheduled tasks of that bundle and waits until all its submitted tasks are done,
+ * before the bundle library can be unloaded.
+ *
+ * The number of threads can be configured with the CELIX_FRAMEWORK_EXECUTOR_NR_OF_THREADS framework property,
+ * default the number of online cores is used. The threads are started on first use, so a framework without
+ * executor users has no executor threads.
+ *
+ * Delayed and periodic tasks are kept in a timer wheel with a 1ms resolution, handled by a single scheduler thread
+ * for the whole framework. Bundles should use schedule instead of threads that sleep in a loop.
+ *
+ * Tasks should not block for a long time, because that reduces the number of threads available for other bundles.
+ */
+typedef struct celix_executor_service {
+    void *handle;
+
+    /**
+     * Submit a task for execution.
+     * If called from an executor task, the new task is queued on the current thread so that it is probably
+     * executed by the same thread; idle threads will steal queued tasks from busy threads.
+     *
+     * @param handle The service handle.
+     * @param priority The task priority.
+     * @param taskData The data provided to the task. Should be valid until the task is done.
+     * @param task The task.
+     * @return CELIX_SUCCESS or CELIX_ILLEGAL_STATE if the executor is stopped.
+     */
+    celix_status_t (*submit)(void *handle, celix_executor_priority_e priority, void *taskData, void (*task)(void *taskData));
+
+    /**
+     * Schedule a task for delayed and optionally periodic execution.
+     * A periodic task is never executed concurrently with itself; if a previous execution is still busy when the
+     * task is due, that execution round is skipped.
+     *
+     * @param handle The service handle.
+     * @param priority The task priority.
+     * @param delayInSeconds The delay before the first execution.
+     * @param intervalInSeconds The interval between executions or <= 0 for a one shot task.
+     * @param taskData The data provided to the task. Should be valid until the task is cancelled or done.
+     * @param task The task.
+     * @return The id (> 0) of the scheduled task or -1 if the executor is stopped.
+     */
+    long (*schedule)(void *handle, celix_executor_priority_e priority, double delayInSeconds, double intervalInSeconds, void *taskData, void (*task)(void *taskData));
+
+    /**
+     * Cancel a scheduled task.
+     * If the task is currently executing, this call waits until the execution is done. Unless cancel is called from
+     * the task itself, then the current execution is the last one.
+     * An execution which is due, but not yet started (e.g. because all executor threads are busy), is skipped.
+     *
+     * @param handle The service handle.
+     * @param scheduledTaskId The id of the scheduled task.
+     * @return True if the task is cancelled, false if the task was not found (e.g. an already executed one shot task).
+     */
+    bool (*cancel)(void *handle, long scheduledTaskId);
+
+    /**
+     * Wait until all tasks submitted (or executed for a schedule) using this service instance are done.
+     * If called from an executor task, the calling task itself is not waited for.
+     *
+     * @param handle The service handle.
+     */
+    void (*waitForTasks)(void *handle);
+
+    /**
+     * Get the statistics of the framework scheduler, e.g. to monitor the timer lag.
+     *
+     * @param handle The service handle.
+     * @param stats Output argument for the statistics.
+     */
+    void (*getSchedulerStatistics)(void *handle, celix_executor_scheduler_statistics_t *stats);
+} celix_executor_service_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_EXECUTOR_SERVICE_H_ */
@@ -39,6 +39,12 @@ FRAMEWORK_EXPORT celix_status_t serviceRegistration_unregister(service_registrat
 FRAMEWORK_EXPORT celix_status_t
 serviceRegistration_getProperties(service_registration_t *registration, celix_properties_t **properties);
 
+/**
+ * Replaces the properties of the registered service (takes ownership) and fires a MODIFIED service event.
+ * Service trackers re-order the tracked services if the service ranking is changed.
+ * The replaced properties are freed when they are no longer used by service tracker callbacks, so properties
+ * retrieved with serviceRegistration_getProperties are only valid until they are replaced.
+ */
 FRAMEWORK_EXPORT celix_status_t
 serviceRegistration_setProperties(service_registration_t *registration, celix_properties_t *properties);
 
@@ -51,10 +51,16 @@ FRAMEWORK_EXPORT celix_status_t serviceTracker_close(service_tracker_t *tracker)
 
 FRAMEWORK_EXPORT celix_status_t serviceTracker_destroy(service_tracker_t *tracker);
 
+/**
+ * Returns the service reference of the highest ranking tracked service or NULL.
+ */
 FRAMEWORK_EXPORT service_reference_pt serviceTracker_getServiceReference(service_tracker_t *tracker);
 
 FRAMEWORK_EXPORT celix_array_list_t *serviceTracker_getServiceReferences(service_tracker_t *tracker);
 
+/**
+ * Returns the highest ranking tracked service or NULL.
+ */
 FRAMEWORK_EXPORT void *serviceTracker_getService(service_tracker_t *tracker);
 
 FRAMEWORK_EXPORT celix_array_list_t *serviceTracker_getServices(service_tracker_t *tracker);
@@ -855,11 +855,8 @@ static void bundleContext_cleanupServiceRegistration(bundle_context_t* ctx) {
 
     celixThreadMutex_lock(&ctx->mutex);
     for (int i = 0; i < celix_arrayList_size(ctx->svcRegistrations); ++i) {
-        service_registration_pt reg = celix_arrayList_get(ctx->svcRegistrations, i);
-        long svcId = serviceRegistration_getServiceId(reg);
-        const char* svcName = NULL;
-        serviceRegistration_getServiceName(reg, &svcName);
-        fw_log(ctx->framework->logger, CELIX_LOG_LEVEL_ERROR, "Dangling service registration with svcId %li, for bundle %s and with service name %s. Add missing 'celix_bundleContext_unregisterService' calls.", svcId, symbolicName, svcName);
+        long svcId = celix_arrayList_getLong(ctx->svcRegistrations, i); //note svcRegistrations contains svc ids
+        fw_log(ctx->framework->logger, CELIX_LOG_LEVEL_ERROR, "Dangling service registration with svcId %li, for bundle %s. Add missing 'celix_bundleContext_unregisterService' calls.", svcId, symbolicName);
         if (danglingSvcIds == NULL) {
             danglingSvcIds = celix_arrayList_create();
         }
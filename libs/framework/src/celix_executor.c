@@ -0,0 +1,836 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdint.h>
+
+#include "celix_executor.h"
+#include "celix_array_list.h"
+#include "hash_map.h"
+#include "celix_threads.h"
+#include "celix_utils.h"
+#include "celix_bundle.h"
+
+#define CELIX_EXECUTOR_NR_OF_PRIORITIES     3
+#define CELIX_EXECUTOR_INITIAL_DEQUE_SIZE   16
+#define CELIX_EXECUTOR_TIMER_TICK_IN_MS     1
+#define CELIX_EXECUTOR_TIMER_WHEEL_SIZE     512 //power of 2, i.e. a wheel revolution of 512ms
+
+typedef struct celix_executor_client celix_executor_client_t;
+typedef struct celix_executor_scheduled_task celix_executor_scheduled_task_t;
+typedef struct celix_executor_worker celix_executor_worker_t;
+
+typedef struct celix_executor_task {
+    void *data;
+    void (*fn)(void *data);
+    celix_executor_client_t *client;
+    celix_executor_scheduled_task_t *scheduled; //NULL for submitted tasks
+    struct celix_executor_task *prev; //task which was running on the current thread, when this task was started
+} celix_executor_task_t;
+
+//Ring buffer of tasks. The owning worker pushes/pops at the back, other workers steal from the front.
+typedef struct celix_executor_deque {
+    celix_executor_task_t *tasks;
+    size_t capacity; //power of 2
+    size_t head;
+    size_t size;
+} celix_executor_deque_t;
+
+struct celix_executor_worker {
+    celix_executor_t *executor;
+    size_t index;
+    celix_thread_t thread;
+    celix_thread_mutex_t mutex; //protects the deques
+    celix_executor_deque_t deques[CELIX_EXECUTOR_NR_OF_PRIORITIES];
+};
+
+//Per bundle service instance
+struct celix_executor_client {
+    celix_executor_t *executor;
+    long bndId;
+    long outstandingTasks; //atomic, submitted and not yet completed tasks
+    celix_executor_service_t svc;
+};
+
+struct celix_executor_scheduled_task {
+    long id;
+    celix_executor_client_t *client;
+    celix_executor_priority_e priority;
+    void *data;
+    void (*fn)(void *data);
+    uint64_t intervalInTicks; //0 for one shot tasks
+    uint64_t dueTick;
+    celix_executor_scheduled_task_t *wheelNext; //next task in the same timer wheel slot
+    celix_executor_scheduled_task_t *wheelPrev;
+    bool active; //submitted to the workers and not yet done
+    bool started; //the active execution is started by a worker
+    uint64_t activeDueTick; //due tick of the active execution, used for the lag statistics
+    bool cancelled;
+    bool cancelWaiting; //a cancel call is waiting for the active execution and will free the task
+};
+
+struct celix_executor {
+    celix_framework_logger_t *logger;
+    celix_service_factory_t factory;
+
+    size_t nrOfWorkers;
+    celix_executor_worker_t **workers;
+
+    bool running; //atomic
+    bool workersStarted; //atomic, the worker threads are started on the first submit
+    celix_thread_mutex_t startMutex; //protects starting the worker threads
+    size_t nextWorker; //atomic, round robin index for submits from non worker threads
+    long queuedTasks; //atomic
+    long queuedTasksPerPriority[CELIX_EXECUTOR_NR_OF_PRIORITIES]; //atomic
+    long idleWorkers; //atomic
+
+    celix_thread_mutex_t idleMutex;
+    celix_thread_cond_t idleCond;
+
+    struct {
+        celix_thread_mutex_t mutex; //protects below and the fields of the scheduled tasks
+        celix_thread_cond_t cond;
+        celix_thread_t thread;
+        bool threadStarted; //the scheduler thread is started on the first schedule
+        bool running;
+        long nextId;
+        struct timespec startTime; //time of tick 0
+        uint64_t processedTick; //the timer wheel slots are processed up to and including this tick
+        celix_executor_scheduled_task_t *wheel[CELIX_EXECUTOR_TIMER_WHEEL_SIZE]; //hashed timer wheel, slot = dueTick % size
+        hash_map_t *tasks; //key = scheduled task id, value = celix_executor_scheduled_task_t*. The tasks in the wheel
+        celix_executor_scheduler_statistics_t stats;
+        double totalLagInSeconds;
+    } scheduler;
+
+    struct {
+        celix_thread_mutex_t mutex; //protects below
+        celix_thread_cond_t cond; //broadcast when the outstanding tasks of a client drops to 0
+        celix_array_list_t *list; //entry = celix_executor_client_t*
+    } clients;
+};
+
+static __thread celix_executor_worker_t *celix_executor_currentWorker = NULL;
+static __thread celix_executor_task_t *celix_executor_currentTask = NULL;
+
+static void* celix_executor_workerThread(void *data);
+static void* celix_executor_schedulerThread(void *data);
+static celix_status_t celix_executor_submitTask(celix_executor_t *executor, celix_executor_priority_e priority, celix_executor_task_t *task);
+static bool celix_executor_startScheduledTask(celix_executor_t *executor, celix_executor_scheduled_task_t *scheduled);
+static void celix_executor_waitForClient(celix_executor_client_t *client);
+static void* celix_executor_getService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
+static void celix_executor_ungetService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
+static celix_status_t celix_executor_submit(void *handle, celix_executor_priority_e priority, void *taskData, void (*task)(void *taskData));
+static long celix_executor_schedule(void *handle, celix_executor_priority_e priority, double delayInSeconds, double intervalInSeconds, void *taskData, void (*task)(void *taskData));
+static bool celix_executor_cancel(void *handle, long scheduledTaskId);
+static void celix_executor_waitForTasks(void *handle);
+static void celix_executor_getSchedulerStatistics(void *handle, celix_executor_scheduler_statistics_t *stats);
+
+
+/**********************************************************************************************************************
+ * deque
+ **********************************************************************************************************************/
+
+static void celix_executor_dequePushBack(celix_executor_deque_t *deque, const celix_executor_task_t *task) {
+    if (deque->size == deque->capacity) {
+        size_t newCapacity = deque->capacity == 0 ? CELIX_EXECUTOR_INITIAL_DEQUE_SIZE : deque->capacity * 2;
+        celix_executor_task_t *newTasks = malloc(newCapacity * sizeof(*newTasks));
+        for (size_t i = 0; i < deque->size; ++i) {
+            newTasks[i] = deque->tasks[(deque->head + i) & (deque->capacity - 1)];
+        }
+        free(deque->tasks);
+        deque->tasks = newTasks;
+        deque->capacity = newCapacity;
+        deque->head = 0;
+    }
+    deque->tasks[(deque->head + deque->size) & (deque->capacity - 1)] = *task;
+    deque->size += 1;
+}
+
+static bool celix_executor_dequePopBack(celix_executor_deque_t *deque, celix_executor_task_t *out) {
+    if (deque->size == 0) {
+        return false;
+    }
+    deque->size -= 1;
+    *out = deque->tasks[(deque->head + deque->size) & (deque->capacity - 1)];
+    return true;
+}
+
+static bool celix_executor_dequePopFront(celix_executor_deque_t *deque, celix_executor_task_t *out) {
+    if (deque->size == 0) {
+        return false;
+    }
+    *out = deque->tasks[deque->head];
+    deque->head = (deque->head + 1) & (deque->capacity - 1);
+    deque->size -= 1;
+    return true;
+}
+
+
+/**********************************************************************************************************************
+ * executor
+ **********************************************************************************************************************/
+
+celix_executor_t* celix_executor_create(celix_framework_logger_t *logger, long nrOfThreads) {
+    if (nrOfThreads <= 0) {
+        nrOfThreads = sysconf(_SC_NPROCESSORS_ONLN);
+        if (nrOfThreads <= 0) {
+            nrOfThreads = 1;
+        }
+    }
+
+    celix_executor_t *executor = calloc(1, sizeof(*executor));
+    executor->logger = logger;
+    executor->factory.handle = executor;
+    executor->factory.getService = celix_executor_getService;
+    executor->factory.ungetService = celix_executor_ungetService;
+    executor->running = true;
+    executor->nrOfWorkers = (size_t)nrOfThreads;
+    celixThreadMutex_create(&executor->startMutex, NULL);
+    celixThreadMutex_create(&executor->idleMutex, NULL);
+    celixThreadCondition_init(&executor->idleCond, NULL);
+
+    celixThreadMutex_create(&executor->scheduler.mutex, NULL);
+    celixThreadCondition_init(&executor->scheduler.cond, NULL);
+    executor->scheduler.running = true;
+    executor->scheduler.nextId = 1L;
+    executor->scheduler.startTime = celix_gettime(CLOCK_MONOTONIC);
+    executor->scheduler.tasks = hashMap_create(NULL, NULL, NULL, NULL);
+
+    celixThreadMutex_create(&executor->clients.mutex, NULL);
+    celixThreadCondition_init(&executor->clients.cond, NULL);
+    executor->clients.list = celix_arrayList_create();
+
+    executor->workers = calloc(executor->nrOfWorkers, sizeof(*executor->workers));
+    for (size_t i = 0; i < executor->nrOfWorkers; ++i) {
+        celix_executor_worker_t *worker = calloc(1, sizeof(*worker));
+        worker->executor = executor;
+        worker->index = i;
+        celixThreadMutex_create(&worker->mutex, NULL);
+        executor->workers[i] = worker;
+    }
+
+    return executor;
+}
+
+/**
+ * Starts the worker threads if not already started. Returns false if the executor is stopped.
+ * Note the threads are started lazily, so that a framework whose bundles do not use the executor
+ * does not pay for a thread pool.
+ */
+static bool celix_executor_ensureWorkersStarted(celix_executor_t *executor) {
+    if (__atomic_load_n(&executor->workersStarted, __ATOMIC_ACQUIRE)) {
+        return true;
+    }
+    celixThreadMutex_lock(&executor->startMutex);
+    bool running = __atomic_load_n(&executor->running, __ATOMIC_SEQ_CST);
+    if (running && !__atomic_load_n(&executor->workersStarted, __ATOMIC_ACQUIRE)) {
+        for (size_t i = 0; i < executor->nrOfWorkers; ++i) {
+            celix_executor_worker_t *worker = executor->workers[i];
+            celixThread_create(&worker->thread, NULL, celix_executor_workerThread, worker);
+            celixThread_setName(&worker->thread, "CelixExecutor");
+        }
+        __atomic_store_n(&executor->workersStarted, true, __ATOMIC_RELEASE);
+        fw_log(executor->logger, CELIX_LOG_LEVEL_TRACE, "Started executor with %zu threads", executor->nrOfWorkers);
+    }
+    celixThreadMutex_unlock(&executor->startMutex);
+    return running;
+}
+
+void celix_executor_destroy(celix_executor_t *executor) {
+    if (executor == NULL) {
+        return;
+    }
+
+    celixThreadMutex_lock(&executor->scheduler.mutex);
+    executor->scheduler.running = false;
+    bool schedulerStarted = executor->scheduler.threadStarted;
+    celixThreadCondition_broadcast(&executor->scheduler.cond);
+    celixThreadMutex_unlock(&executor->scheduler.mutex);
+    if (schedulerStarted) {
+        celixThread_join(executor->scheduler.thread, NULL);
+    }
+
+    //note workers execute the already queued tasks before stopping
+    celixThreadMutex_lock(&executor->idleMutex);
+    __atomic_store_n(&executor->running, false, __ATOMIC_SEQ_CST);
+    celixThreadCondition_broadcast(&executor->idleCond);
+    celixThreadMutex_unlock(&executor->idleMutex);
+    //note after running is false no workers are started anymore
+    celixThreadMutex_lock(&executor->startMutex);
+    bool workersStarted = __atomic_load_n(&executor->workersStarted, __ATOMIC_ACQUIRE);
+    celixThreadMutex_unlock(&executor->startMutex);
+    for (size_t i = 0; workersStarted && i < executor->nrOfWorkers; ++i) {
+        celixThread_join(executor->workers[i]->thread, NULL);
+    }
+
+    for (size_t i = 0; i < executor->nrOfWorkers; ++i) {
+        celix_executor_worker_t *worker = executor->workers[i];
+        for (int p = 0; p < CELIX_EXECUTOR_NR_OF_PRIORITIES; ++p) {
+            free(worker->deques[p].tasks);
+        }
+        celixThreadMutex_destroy(&worker->mutex);
+        free(worker);
+    }
+    free(executor->workers);
+
+    fw_log(executor->logger, CELIX_LOG_LEVEL_TRACE, "Scheduler executions: %zu, skipped: %zu, average lag: %fs, max lag: %fs",
+           executor->scheduler.stats.nrOfExecutions, executor->scheduler.stats.nrOfSkippedExecutions,
+           executor->scheduler.stats.averageLagInSeconds, executor->scheduler.stats.maxLagInSeconds);
+    hashMap_destroy(executor->scheduler.tasks, false, true);
+    celixThreadCondition_destroy(&executor->scheduler.cond);
+    celixThreadMutex_destroy(&executor->scheduler.mutex);
+
+    int nrOfClients = celix_arrayList_size(executor->clients.list);
+    for (int i = 0; i < nrOfClients; ++i) {
+        celix_executor_client_t *client = celix_arrayList_get(executor->clients.list, i);
+        if (client->bndId != 0) {
+            fw_log(executor->logger, CELIX_LOG_LEVEL_WARNING, "Executor service instance for bundle %li not cleaned up", client->bndId);
+        }
+        free(client);
+    }
+    celix_arrayList_destroy(executor->clients.list);
+    celixThreadCondition_destroy(&executor->clients.cond);
+    celixThreadMutex_destroy(&executor->clients.mutex);
+
+    celixThreadCondition_destroy(&executor->idleCond);
+    celixThreadMutex_destroy(&executor->idleMutex);
+    celixThreadMutex_destroy(&executor->startMutex);
+    free(executor);
+}
+
+celix_service_factory_t* celix_executor_getServiceFactory(celix_executor_t *executor) {
+    return &executor->factory;
+}
+
+static celix_status_t celix_executor_submitTask(celix_executor_t *executor, celix_executor_priority_e priority, celix_executor_task_t *task) {
+    if (!celix_executor_ensureWorkersStarted(executor)) {
+        return CELIX_ILLEGAL_STATE;
+    }
+    if (priority < CELIX_EXECUTOR_PRIORITY_HIGH || priority > CELIX_EXECUTOR_PRIORITY_LOW) {
+        priority = CELIX_EXECUTOR_PRIORITY_NORMAL;
+    }
+
+    //Tasks submitted from a worker are queued on that worker, other submits are spread round robin
+    celix_executor_worker_t *worker = celix_executor_currentWorker;
+    if (worker == NULL || worker->executor != executor) {
+        size_t index = __atomic_fetch_add(&executor->nextWorker, 1, __ATOMIC_RELAXED);
+        worker = executor->workers[index % executor->nrOfWorkers];
+    }
+
+    __atomic_add_fetch(&task->client->outstandingTasks, 1, __ATOMIC_SEQ_CST);
+    //note counters are increased before the task is queued, so that they are never lower than the queued tasks
+    __atomic_add_fetch(&executor->queuedTasksPerPriority[priority], 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&executor->queuedTasks, 1, __ATOMIC_SEQ_CST);
+
+    celixThreadMutex_lock(&worker->mutex);
+    celix_executor_dequePushBack(&worker->deques[priority], task);
+    celixThreadMutex_unlock(&worker->mutex);
+
+    if (__atomic_load_n(&executor->idleWorkers, __ATOMIC_SEQ_CST) > 0) {
+        celixThreadMutex_lock(&executor->idleMutex);
+        celixThreadCondition_signal(&executor->idleCond);
+        celixThreadMutex_unlock(&executor->idleMutex);
+    }
+    return CELIX_SUCCESS;
+}
+
+/**
+ * Takes the next task, highest priority first. For a priority first the own deque is tried (newest task first),
+ * then the deques of the other workers are tried (oldest task first).
+ */
+static bool celix_executor_takeTask(celix_executor_worker_t *worker, celix_executor_task_t *out) {
+    celix_executor_t *executor = worker->executor;
+    for (int p = 0; p < CELIX_EXECUTOR_NR_OF_PRIORITIES; ++p) {
+        if (__atomic_load_n(&executor->queuedTasksPerPriority[p], __ATOMIC_ACQUIRE) <= 0) {
+            continue;
+        }
+        celixThreadMutex_lock(&worker->mutex);
+        bool found = celix_executor_dequePopBack(&worker->deques[p], out);
+        celixThreadMutex_unlock(&worker->mutex);
+        for (size_t i = 1; !found && i < executor->nrOfWorkers; ++i) {
+            celix_executor_worker_t *victim = executor->workers[(worker->index + i) % executor->nrOfWorkers];
+            celixThreadMutex_lock(&victim->mutex);
+            found = celix_executor_dequePopFront(&victim->deques[p], out);
+            celixThreadMutex_unlock(&victim->mutex);
+        }
+        if (found) {
+            __atomic_sub_fetch(&executor->queuedTasksPerPriority[p], 1, __ATOMIC_SEQ_CST);
+            __atomic_sub_fetch(&executor->queuedTasks, 1, __ATOMIC_SEQ_CST);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void celix_executor_taskDone(celix_executor_t *executor, celix_executor_task_t *task) {
+    celix_executor_scheduled_task_t *scheduled = task->scheduled;
+    if (scheduled != NULL) {
+        celixThreadMutex_lock(&executor->scheduler.mutex);
+        scheduled->active = false;
+        scheduled->started = false;
+        bool freeScheduled;
+        if (scheduled->cancelled) {
+            freeScheduled = !scheduled->cancelWaiting; //note if a cancel is waiting, the cancel frees the task
+        } else {
+            freeScheduled = scheduled->intervalInTicks == 0; //one shot tasks are not in the timer wheel anymore
+        }
+        if (freeScheduled) {
+            free(scheduled);
+        }
+        celixThreadCondition_broadcast(&executor->scheduler.cond);
+        celixThreadMutex_unlock(&executor->scheduler.mutex);
+    }
+
+    if (__atomic_sub_fetch(&task->client->outstandingTasks, 1, __ATOMIC_SEQ_CST) <= 1) {
+        //note also broadcast for 1, because waitForTasks called from a task waits until only the task itself is left.
+        //Waits from nested tasks (see celix_executor_waitForClient) use a timed wait.
+        celixThreadMutex_lock(&executor->clients.mutex);
+        celixThreadCondition_broadcast(&executor->clients.cond);
+        celixThreadMutex_unlock(&executor->clients.mutex);
+    }
+}
+
+static void celix_executor_runTask(celix_executor_t *executor, celix_executor_task_t *task) {
+    task->prev = celix_executor_currentTask; //note != NULL if the task is run while waiting in another task
+    celix_executor_currentTask = task;
+    if (task->scheduled == NULL || celix_executor_startScheduledTask(executor, task->scheduled)) {
+        task->fn(task->data);
+    }
+    celix_executor_currentTask = task->prev;
+    celix_executor_taskDone(executor, task);
+}
+
+static void* celix_executor_workerThread(void *data) {
+    celix_executor_worker_t *worker = data;
+    celix_executor_t *executor = worker->executor;
+    celix_executor_currentWorker = worker;
+
+    while (true) {
+        celix_executor_task_t task;
+        if (celix_executor_takeTask(worker, &task)) {
+            celix_executor_runTask(executor, &task);
+            continue;
+        }
+
+        celixThreadMutex_lock(&executor->idleMutex);
+        __atomic_add_fetch(&executor->idleWorkers, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&executor->queuedTasks, __ATOMIC_SEQ_CST) <= 0 && __atomic_load_n(&executor->running, __ATOMIC_SEQ_CST)) {
+            celixThreadCondition_wait(&executor->idleCond, &executor->idleMutex);
+        }
+        __atomic_sub_fetch(&executor->idleWorkers, 1, __ATOMIC_SEQ_CST);
+        bool stop = !__atomic_load_n(&executor->running, __ATOMIC_SEQ_CST) && __atomic_load_n(&executor->queuedTasks, __ATOMIC_SEQ_CST) <= 0;
+        celixThreadMutex_unlock(&executor->idleMutex);
+        if (stop) {
+            break;
+        }
+    }
+
+    celix_executor_currentWorker = NULL;
+    return NULL;
+}
+
+
+/**********************************************************************************************************************
+ * scheduler
+ **********************************************************************************************************************/
+
+//note rounds up, so that timers never fire early
+static uint64_t celix_executor_ceilTicks(double ticks) {
+    if (ticks <= 0) {
+        return 0;
+    }
+    uint64_t result = (uint64_t)ticks;
+    return (double)result < ticks ? result + 1 : result;
+}
+
+static double celix_executor_secondsToTicks(double seconds) {
+    return seconds * 1000.0 / CELIX_EXECUTOR_TIMER_TICK_IN_MS;
+}
+
+static double celix_executor_elapsedTicks(celix_executor_t *executor) {
+    return celix_elapsedtime(CLOCK_MONOTONIC, executor->scheduler.startTime) * 1000.0 / CELIX_EXECUTOR_TIMER_TICK_IN_MS;
+}
+
+//note should be called with the scheduler mutex locked
+static void celix_executor_wheelAdd(celix_executor_t *executor, celix_executor_scheduled_task_t *scheduled) {
+    if (scheduled->dueTick <= executor->scheduler.processedTick) {
+        scheduled->dueTick = executor->scheduler.processedTick + 1;
+    }
+    celix_executor_scheduled_task_t **slot = &executor->scheduler.wheel[scheduled->dueTick & (CELIX_EXECUTOR_TIMER_WHEEL_SIZE - 1)];
+    scheduled->wheelPrev = NULL;
+    scheduled->wheelNext = *slot;
+    if (*slot != NULL) {
+        (*slot)->wheelPrev = scheduled;
+    }
+    *slot = scheduled;
+}
+
+//note should be called with the scheduler mutex locked
+static void celix_executor_wheelRemove(celix_executor_t *executor, celix_executor_scheduled_task_t *scheduled) {
+    if (scheduled->wheelPrev != NULL) {
+        scheduled->wheelPrev->wheelNext = scheduled->wheelNext;
+    } else {
+        executor->scheduler.wheel[scheduled->dueTick & (CELIX_EXECUTOR_TIMER_WHEEL_SIZE - 1)] = scheduled->wheelNext;
+    }
+    if (scheduled->wheelNext != NULL) {
+        scheduled->wheelNext->wheelPrev = scheduled->wheelPrev;
+    }
+    scheduled->wheelNext = NULL;
+    scheduled->wheelPrev = NULL;
+}
+
+//note should be called with the scheduler mutex locked
+static void celix_executor_fireScheduledTask(celix_executor_t *executor, celix_executor_scheduled_task_t *scheduled) {
+    celix_executor_task_t task;
+    task.data = scheduled->data;
+    task.fn = scheduled->fn;
+    task.client = scheduled->client;
+    task.scheduled = scheduled;
+    task.prev = NULL;
+    scheduled->active = true;
+    scheduled->started = false;
+    scheduled->activeDueTick = scheduled->dueTick;
+    celix_status_t status = celix_executor_submitTask(executor, scheduled->priority, &task);
+    if (status != CELIX_SUCCESS) {
+        scheduled->active = false;
+    }
+}
+
+//note should be called with the scheduler mutex locked
+static void celix_executor_processTick(celix_executor_t *executor, uint64_t tick, double nowInTicks) {
+    celix_executor_scheduled_task_t *scheduled = executor->scheduler.wheel[tick & (CELIX_EXECUTOR_TIMER_WHEEL_SIZE - 1)];
+    while (scheduled != NULL) {
+        celix_executor_scheduled_task_t *next = scheduled->wheelNext;
+        if (scheduled->dueTick <= tick) { //else due in a later wheel revolution
+            celix_executor_wheelRemove(executor, scheduled);
+            if (scheduled->intervalInTicks > 0) {
+                if (!scheduled->active) {
+                    celix_executor_fireScheduledTask(executor, scheduled);
+                } else {
+                    //previous execution still busy -> skip this round
+                    executor->scheduler.stats.nrOfSkippedExecutions += 1;
+                }
+                scheduled->dueTick += scheduled->intervalInTicks;
+                if ((double)scheduled->dueTick <= nowInTicks) {
+                    //behind schedule, do not try to catch up
+                    scheduled->dueTick = (uint64_t)nowInTicks + scheduled->intervalInTicks;
+                }
+                celix_executor_wheelAdd(executor, scheduled);
+            } else {
+                hashMap_remove(executor->scheduler.tasks, (void*)scheduled->id);
+                executor->scheduler.stats.nrOfScheduledTasks -= 1;
+                celix_executor_fireScheduledTask(executor, scheduled);
+                if (!scheduled->active) {
+                    free(scheduled); //could not be submitted, executor is stopping
+                }
+            }
+        }
+        scheduled = next;
+    }
+}
+
+static void* celix_executor_schedulerThread(void *data) {
+    celix_executor_t *executor = data;
+
+    celixThreadMutex_lock(&executor->scheduler.mutex);
+    while (executor->scheduler.running) {
+        double nowInTicks = celix_executor_elapsedTicks(executor);
+        uint64_t now = (uint64_t)nowInTicks;
+        if (now - executor->scheduler.processedTick > CELIX_EXECUTOR_TIMER_WHEEL_SIZE) {
+            //note all slots are processed in one revolution, tasks in skipped ticks are due and handled in a later slot
+            executor->scheduler.processedTick = now - CELIX_EXECUTOR_TIMER_WHEEL_SIZE;
+        }
+        while (executor->scheduler.processedTick < now) {
+            executor->scheduler.processedTick += 1;
+            celix_executor_processTick(executor, executor->scheduler.processedTick, nowInTicks);
+        }
+
+        //wait till the next non empty slot or, if all slots are empty, till a task is scheduled
+        uint64_t nextTick = 0;
+        for (uint64_t i = 1; hashMap_size(executor->scheduler.tasks) > 0 && i <= CELIX_EXECUTOR_TIMER_WHEEL_SIZE; ++i) {
+            if (executor->scheduler.wheel[(now + i) & (CELIX_EXECUTOR_TIMER_WHEEL_SIZE - 1)] != NULL) {
+                nextTick = now + i;
+                break;
+            }
+        }
+        if (nextTick == 0) {
+            celixThreadCondition_wait(&executor->scheduler.cond, &executor->scheduler.mutex);
+        } else {
+            double waitTime = ((double)nextTick - nowInTicks) * CELIX_EXECUTOR_TIMER_TICK_IN_MS / 1000.0;
+            long seconds = (long)waitTime;
+            long nanoseconds = (long)((waitTime - (double)seconds) * 1000000000.0);
+            celixThreadCondition_timedwaitRelative(&executor->scheduler.cond, &executor->scheduler.mutex, seconds, nanoseconds);
+        }
+    }
+    celixThreadMutex_unlock(&executor->scheduler.mutex);
+
+    return NULL;
+}
+
+/**
+ * Called by a worker before a scheduled task is executed. Returns false if the task is cancelled after it was
+ * submitted, in that case the execution is skipped. The lag is measured here, so that it includes the time the
+ * task was queued.
+ */
+static bool celix_executor_startScheduledTask(celix_executor_t *executor, celix_executor_scheduled_task_t *scheduled) {
+    celixThreadMutex_lock(&executor->scheduler.mutex);
+    bool start = !scheduled->cancelled;
+    if (start) {
+        scheduled->started = true;
+        double lag = (celix_executor_elapsedTicks(executor) - (double)scheduled->activeDueTick) * CELIX_EXECUTOR_TIMER_TICK_IN_MS / 1000.0;
+        lag = lag < 0 ? 0 : lag;
+        celix_executor_scheduler_statistics_t *stats = &executor->scheduler.stats;
+        stats->nrOfExecutions += 1;
+        executor->scheduler.totalLagInSeconds += lag;
+        stats->averageLagInSeconds = executor->scheduler.totalLagInSeconds / (double)stats->nrOfExecutions;
+        stats->maxLagInSeconds = lag > stats->maxLagInSeconds ? lag : stats->maxLagInSeconds;
+    }
+    celixThreadMutex_unlock(&executor->scheduler.mutex);
+    return start;
+}
+
+//note should be called with the scheduler mutex locked
+static void celix_executor_removeScheduledTask(celix_executor_t *executor, celix_executor_scheduled_task_t *scheduled) {
+    celix_executor_wheelRemove(executor, scheduled);
+    hashMap_remove(executor->scheduler.tasks, (void*)scheduled->id);
+    executor->scheduler.stats.nrOfScheduledTasks -= 1;
+}
+
+//note should be called with the scheduler mutex locked. Returns true if the scheduled task can be freed by the caller.
+static bool celix_executor_cancelScheduledTask(celix_executor_t *executor, celix_executor_scheduled_task_t *scheduled) {
+    scheduled->cancelled = true;
+    for (celix_executor_task_t *t = celix_executor_currentTask; t != NULL; t = t->prev) {
+        if (t->scheduled == scheduled) {
+            return false; //cancelled from the task itself, freed when the current execution is done
+        }
+    }
+    if (scheduled->active && !scheduled->started) {
+        //queued, but not yet started. The execution is skipped and frees the task, see celix_executor_startScheduledTask.
+        //note waiting here could dead lock, e.g. if called from a task and all workers are busy.
+        return false;
+    }
+    scheduled->cancelWaiting = true;
+    while (scheduled->active) {
+        celixThreadCondition_wait(&executor->scheduler.cond, &executor->scheduler.mutex);
+    }
+    return true;
+}
+
+
+/**********************************************************************************************************************
+ * service
+ **********************************************************************************************************************/
+
+static void* celix_executor_getService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties __attribute__((unused))) {
+    celix_executor_t *executor = handle;
+    long bndId = celix_bundle_getId(requestingBundle);
+    celix_executor_client_t *client = NULL;
+
+    celixThreadMutex_lock(&executor->clients.mutex);
+    for (int i = 0; i < celix_arrayList_size(executor->clients.list); ++i) {
+        celix_executor_client_t *visit = celix_arrayList_get(executor->clients.list, i);
+        if (visit->bndId == bndId) {
+            client = visit;
+            break;
+        }
+    }
+    if (client == NULL) {
+        client = calloc(1, sizeof(*client));
+        client->executor = executor;
+        client->bndId = bndId;
+        client->svc.handle = client;
+        client->svc.submit = celix_executor_submit;
+        client->svc.schedule = celix_executor_schedule;
+        client->svc.cancel = celix_executor_cancel;
+        client->svc.waitForTasks = celix_executor_waitForTasks;
+        client->svc.getSchedulerStatistics = celix_executor_getSchedulerStatistics;
+        celix_arrayList_add(executor->clients.list, client);
+    }
+    celixThreadMutex_unlock(&executor->clients.mutex);
+
+    return &client->svc;
+}
+
+static void celix_executor_ungetService(void *handle __attribute__((unused)), const celix_bundle_t *requestingBundle __attribute__((unused)), const celix_properties_t *svcProperties __attribute__((unused))) {
+    //nop, the service instance of a bundle is kept until the bundle is stopped, so that (scheduled) tasks
+    //outlive a single service usage (e.g. celix_bundleContext_useService).
+}
+
+void celix_executor_bundleStopped(celix_executor_t *executor, long bndId) {
+    celix_executor_client_t *client = NULL;
+    celixThreadMutex_lock(&executor->clients.mutex);
+    for (int i = 0; i < celix_arrayList_size(executor->clients.list); ++i) {
+        celix_executor_client_t *visit = celix_arrayList_get(executor->clients.list, i);
+        if (visit->bndId == bndId) {
+            client = visit;
+            celix_arrayList_removeAt(executor->clients.list, i);
+            break;
+        }
+    }
+    celixThreadMutex_unlock(&executor->clients.mutex);
+
+    if (client == NULL) {
+        return; //bundle did not use the executor
+    }
+
+    int nrOfCancelled = 0;
+    celixThreadMutex_lock(&executor->scheduler.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(executor->scheduler.tasks);
+    while (hashMapIterator_hasNext(&iter)) {
+        celix_executor_scheduled_task_t *scheduled = hashMapIterator_nextValue(&iter);
+        if (scheduled->client == client) {
+            celix_executor_removeScheduledTask(executor, scheduled);
+            //note cancel can release the mutex, so restart iteration
+            if (celix_executor_cancelScheduledTask(executor, scheduled)) {
+                free(scheduled);
+            }
+            nrOfCancelled += 1;
+            iter = hashMapIterator_construct(executor->scheduler.tasks);
+        }
+    }
+    celixThreadMutex_unlock(&executor->scheduler.mutex);
+
+    if (nrOfCancelled > 0) {
+        fw_log(executor->logger, CELIX_LOG_LEVEL_WARNING, "Cancelled %i scheduled task(s) of stopped bundle %li", nrOfCancelled, bndId);
+    }
+
+    celix_executor_waitForClient(client);
+    free(client);
+}
+
+static celix_status_t celix_executor_submit(void *handle, celix_executor_priority_e priority, void *taskData, void (*task)(void *taskData)) {
+    celix_executor_client_t *client = handle;
+    if (task == NULL) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    celix_executor_task_t t;
+    t.data = taskData;
+    t.fn = task;
+    t.client = client;
+    t.scheduled = NULL;
+    t.prev = NULL;
+    return celix_executor_submitTask(client->executor, priority, &t);
+}
+
+static long celix_executor_schedule(void *handle, celix_executor_priority_e priority, double delayInSeconds, double intervalInSeconds, void *taskData, void (*task)(void *taskData)) {
+    celix_executor_client_t *client = handle;
+    celix_executor_t *executor = client->executor;
+    if (task == NULL) {
+        return -1L;
+    }
+
+    celix_executor_scheduled_task_t *scheduled = calloc(1, sizeof(*scheduled));
+    scheduled->client = client;
+    scheduled->priority = priority;
+    scheduled->data = taskData;
+    scheduled->fn = task;
+    scheduled->intervalInTicks = celix_executor_ceilTicks(celix_executor_secondsToTicks(intervalInSeconds));
+
+    long id = -1L;
+    celixThreadMutex_lock(&executor->scheduler.mutex);
+    if (executor->scheduler.running) {
+        id = executor->scheduler.nextId++;
+        scheduled->id = id;
+        double delay = delayInSeconds > 0 ? celix_executor_secondsToTicks(delayInSeconds) : 0;
+        scheduled->dueTick = celix_executor_ceilTicks(celix_executor_elapsedTicks(executor) + delay);
+        celix_executor_wheelAdd(executor, scheduled);
+        hashMap_put(executor->scheduler.tasks, (void*)id, scheduled);
+        executor->scheduler.stats.nrOfScheduledTasks += 1;
+        if (!executor->scheduler.threadStarted) {
+            celixThread_create(&executor->scheduler.thread, NULL, celix_executor_schedulerThread, executor);
+            celixThread_setName(&executor->scheduler.thread, "CelixScheduler");
+            executor->scheduler.threadStarted = true;
+        }
+        celixThreadCondition_broadcast(&executor->scheduler.cond);
+    }
+    celixThreadMutex_unlock(&executor->scheduler.mutex);
+
+    if (id < 0) {
+        free(scheduled);
+    }
+    return id;
+}
+
+static bool celix_executor_cancel(void *handle, long scheduledTaskId) {
+    celix_executor_client_t *client = handle;
+    celix_executor_t *executor = client->executor;
+    bool cancelled = false;
+
+    celixThreadMutex_lock(&executor->scheduler.mutex);
+    celix_executor_scheduled_task_t *scheduled = hashMap_get(executor->scheduler.tasks, (void*)scheduledTaskId);
+    if (scheduled != NULL && scheduled->client == client) {
+        celix_executor_removeScheduledTask(executor, scheduled);
+        if (celix_executor_cancelScheduledTask(executor, scheduled)) {
+            free(scheduled);
+        }
+        cancelled = true;
+    }
+    celixThreadMutex_unlock(&executor->scheduler.mutex);
+
+    return cancelled;
+}
+
+static void celix_executor_waitForClient(celix_executor_client_t *client) {
+    celix_executor_t *executor = client->executor;
+    celix_executor_worker_t *worker = celix_executor_currentWorker;
+    if (worker != NULL && worker->executor != executor) {
+        worker = NULL;
+    }
+
+    //note if called from a task, the tasks of the client running on the current thread are not waited for
+    long self = 0;
+    for (celix_executor_task_t *t = celix_executor_currentTask; t != NULL; t = t->prev) {
+        self += t->client == client ? 1 : 0;
+    }
+
+    while (worker != NULL && __atomic_load_n(&client->outstandingTasks, __ATOMIC_SEQ_CST) > self) {
+        //called from a task -> help executing tasks instead of blocking a worker thread, which could dead lock
+        celix_executor_task_t task;
+        if (celix_executor_takeTask(worker, &task)) {
+            celix_executor_runTask(executor, &task);
+        } else {
+            celixThreadMutex_lock(&executor->clients.mutex);
+            if (__atomic_load_n(&client->outstandingTasks, __ATOMIC_SEQ_CST) > self) {
+                celixThreadCondition_timedwaitRelative(&executor->clients.cond, &executor->clients.mutex, 0, 1000000 /*1ms*/);
+            }
+            celixThreadMutex_unlock(&executor->clients.mutex);
+        }
+    }
+
+    celixThreadMutex_lock(&executor->clients.mutex);
+    while (__atomic_load_n(&client->outstandingTasks, __ATOMIC_SEQ_CST) > self) {
+        celixThreadCondition_wait(&executor->clients.cond, &executor->clients.mutex);
+    }
+    celixThreadMutex_unlock(&executor->clients.mutex);
+}
+
+static void celix_executor_waitForTasks(void *handle) {
+    celix_executor_waitForClient(handle);
+}
+
+static void celix_executor_getSchedulerStatistics(void *handle, celix_executor_scheduler_statistics_t *stats) {
+    celix_executor_client_t *client = handle;
+    celix_executor_t *executor = client->executor;
+    celixThreadMutex_lock(&executor->scheduler.mutex);
+    *stats = executor->scheduler.stats;
+    celixThreadMutex_unlock(&executor->scheduler.mutex);
+}
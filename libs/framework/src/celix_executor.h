@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_CELIX_EXECUTOR_H
+#define CELIX_CELIX_EXECUTOR_H
+
+#include "celix_log.h"
+#include "celix_service_factory.h"
+#include "celix_executor_service.h"
+
+/**
+ * The framework executor: a work-stealing thread pool with task priorities and a scheduler thread for
+ * delayed/periodic tasks. Provided to bundles as celix_executor_service_t using a service factory.
+ */
+typedef struct celix_executor celix_executor_t;
+
+/**
+ * Create the executor.
+ * The worker threads are started on the first submitted task and the scheduler thread on the first scheduled task.
+ * @param logger The framework logger.
+ * @param nrOfThreads The number of worker threads. If <= 0 the number of online cores is used.
+ */
+celix_executor_t* celix_executor_create(celix_framework_logger_t *logger, long nrOfThreads);
+
+/**
+ * Stops the executor. Cancels all scheduled tasks, executes the already submitted tasks and joins all threads.
+ */
+void celix_executor_destroy(celix_executor_t *executor);
+
+/**
+ * Returns the service factory which creates a celix_executor_service_t instance per bundle.
+ */
+celix_service_factory_t* celix_executor_getServiceFactory(celix_executor_t *executor);
+
+/**
+ * Called by the framework when a bundle is stopped.
+ * Cancels the scheduled tasks of the bundle and waits until the submitted tasks of the bundle are done.
+ */
+void celix_executor_bundleStopped(celix_executor_t *executor, long bndId);
+
+#endif //CELIX_CELIX_EXECUTOR_H
@@ -27,7 +27,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <limits.h>
 #include <assert.h>
 
 #include "celix_constants.h"
@@ -35,7 +34,6 @@
 #include "dm_service_dependency_impl.h"
 #include "dm_component_impl.h"
 
-#define DEFAULT_RANKING     0
 #define DM_SERVICE_DEPENDENCY_DEFAULT_STRATEGY DM_SERVICE_DEPENDENCY_STRATEGY_SUSPEND
 
 static celix_status_t serviceDependency_addedService(void *_ptr, service_reference_pt reference, void *service);
@@ -468,44 +466,10 @@ celix_status_t serviceDependency_setAvailable(celix_dm_service_dependency_t *dep
 celix_status_t serviceDependency_invokeSet(celix_dm_service_dependency_t *dependency, dm_event_pt event) {
 	celix_status_t status = CELIX_SUCCESS;
 	assert(dependency->isStarted == true);
-	array_list_pt serviceReferences = NULL;
-	int i;
-	int curRanking = INT_MIN;
-	service_reference_pt curServRef = NULL;
 	void *service = NULL;
 
-	serviceReferences = serviceTracker_getServiceReferences(dependency->tracker);
-
-	/* Find the service with the highest ranking */
-	for (i = 0; i < arrayList_size(serviceReferences); i++) {
-		service_reference_pt serviceReference = arrayList_get(serviceReferences, i);
-		const char* ranking_value;
-		int ranking = 0;
-
-		status = serviceReference_getProperty(serviceReference, ((char *) OSGI_FRAMEWORK_SERVICE_RANKING), &ranking_value);
-
-		if (status == CELIX_SUCCESS) {
-			if (ranking_value == NULL) {
-				ranking = DEFAULT_RANKING;
-			} else {
-				char *end;
-				ranking = strtol(ranking_value, &end, 10);
-				if (end == ranking_value) {
-					ranking = DEFAULT_RANKING;
-				}
-			}
-
-			if (ranking > curRanking) {
-				curRanking = ranking;
-				curServRef = serviceReference;
-			}
-		} else {
-			break;
-		}
-
-	}
-
-	arrayList_destroy(serviceReferences);
+	/* The tracked services are ordered on ranking, so the first tracked service is the highest ranking service */
+	service_reference_pt curServRef = serviceTracker_getServiceReference(dependency->tracker);
 
 	if (status == CELIX_SUCCESS) {
 		if (curServRef) {
@@ -256,6 +256,7 @@ celix_status_t framework_create(framework_pt *out, properties_pt config) {
     framework->bundleListeners = celix_arrayList_create();
     framework->frameworkListeners = celix_arrayList_create();
     framework->dispatcher.dynamicEventQueue = celix_arrayList_create();
+    framework->executor.svcId = -1L;
 
     //create and store framework uuid
     char uuid[37];
@@ -1046,6 +1047,10 @@ celix_status_t fw_stopBundle(framework_pt framework, long bndId, bool record) {
 
             if (bndId > 0) {
 	            celix_bundleContext_cleanup(entry->bnd->context);
+                if (framework->executor.executor != NULL) {
+                    //cancel scheduled and wait for submitted tasks, before the bundle library can be unloaded
+                    celix_executor_bundleStopped(framework->executor.executor, bndId);
+                }
                 if (status == CELIX_SUCCESS) {
                     module_pt module = NULL;
                     const char *symbolicName = NULL;
@@ -1835,6 +1840,14 @@ static void* framework_shutdown(void *framework) {
         fw_bundleEntry_decreaseUseCount(fwEntry);
     }
 
+    //stop executor, note after all bundles are stopped
+    if (fw->executor.executor != NULL) {
+        celix_framework_unregister(fw, fw->bundle, fw->executor.svcId);
+        celix_executor_destroy(fw->executor.executor);
+        fw->executor.executor = NULL;
+        fw->executor.svcId = -1L;
+    }
+
     //join dispatcher thread
     celixThreadMutex_lock(&fw->dispatcher.mutex);
     fw->dispatcher.active = false;
@@ -2099,8 +2112,18 @@ celix_status_t fw_invokeFrameworkListener(framework_pt framework, framework_list
 }
 
 static celix_status_t frameworkActivator_start(void * userData, bundle_context_t *context) {
-    // nothing to do
-    return CELIX_SUCCESS;
+    framework_pt framework;
+    celix_status_t status = bundleContext_getFramework(context, &framework);
+    if (status == CELIX_SUCCESS && framework->executor.executor == NULL) {
+        long nrOfThreads = celix_properties_getAsLong(framework->configurationMap, CELIX_FRAMEWORK_EXECUTOR_NR_OF_THREADS, 0);
+        framework->executor.executor = celix_executor_create(framework->logger, nrOfThreads);
+
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, CELIX_FRAMEWORK_SERVICE_VERSION, CELIX_EXECUTOR_SERVICE_VERSION);
+        celix_properties_set(props, CELIX_FRAMEWORK_SERVICE_LANGUAGE, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE);
+        framework->executor.svcId = celix_framework_registerService(framework, framework->bundle, CELIX_EXECUTOR_SERVICE_NAME, NULL, celix_executor_getServiceFactory(framework->executor.executor), props);
+    }
+    return status;
 }
 
 static celix_status_t frameworkActivator_stop(void * userData, bundle_context_t *context) {
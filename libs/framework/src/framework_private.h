@@ -40,6 +40,7 @@
 
 #include "celix_threads.h"
 #include "service_registry.h"
+#include "celix_executor.h"
 
 #define CELIX_FRAMEWORK_STATIC_EVENT_QUEUE_SIZE 256
 
@@ -147,6 +148,11 @@ struct celix_framework {
     celix_framework_logger_t* logger;
 
     long nextGenericEventId;
+
+    struct {
+        celix_executor_t *executor; //framework thread pool, provided to bundles as celix_executor_service_t
+        long svcId;
+    } executor;
 };
 
 FRAMEWORK_EXPORT celix_status_t fw_getProperty(framework_pt framework, const char* name, const char* defaultValue, const char** value);
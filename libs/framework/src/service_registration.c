@@ -29,6 +29,7 @@ static celix_status_t serviceRegistration_initializeProperties(service_registrat
 static celix_status_t serviceRegistration_createInternal(registry_callback_t callback, bundle_pt bundle, const char* serviceName, unsigned long serviceId,
         const void * serviceObject, properties_pt dictionary, enum celix_service_type svcType, service_registration_pt *registration);
 static celix_status_t serviceRegistration_destroy(service_registration_pt registration);
+static void serviceRegistration_freeRetiredPropertiesIfUnused(service_registration_pt registration);
 
 service_registration_pt serviceRegistration_create(registry_callback_t callback, bundle_pt bundle, const char* serviceName, unsigned long serviceId, const void * serviceObject, properties_pt dictionary) {
     service_registration_pt registration = NULL;
@@ -107,6 +108,12 @@ static celix_status_t serviceRegistration_destroy(service_registration_pt regist
     registration->callback.unregister = NULL;
 
 	properties_destroy(registration->properties);
+	if (registration->retiredProperties != NULL) {
+		for (int i = 0; i < celix_arrayList_size(registration->retiredProperties); ++i) {
+			properties_destroy(celix_arrayList_get(registration->retiredProperties, i));
+		}
+		celix_arrayList_destroy(registration->retiredProperties);
+	}
 	celixThreadRwlock_unlock(&registration->lock);
     celixThreadRwlock_destroy(&registration->lock);
 	free(registration);
@@ -129,7 +136,7 @@ static celix_status_t serviceRegistration_initializeProperties(service_registrat
 		properties_set(dictionary, (char *) OSGI_FRAMEWORK_OBJECTCLASS, registration->className);
 	}
 
-	registration->properties = dictionary;
+	__atomic_store_n(&registration->properties, dictionary, __ATOMIC_SEQ_CST);
 
 	return CELIX_SUCCESS;
 }
@@ -230,14 +237,64 @@ celix_status_t serviceRegistration_getProperties(service_registration_pt registr
 
 celix_status_t serviceRegistration_setProperties(service_registration_pt registration, properties_pt properties) {
     celix_status_t status;
+    registry_callback_t callback;
+    callback.modified = NULL;
 
     celixThreadRwlock_writeLock(&registration->lock);
+    properties_pt old = registration->properties;
     status = serviceRegistration_initializeProperties(registration, properties);
+    if (old != NULL && old != registration->properties) {
+        //note old properties can still be used in properties read sections
+        if (registration->retiredProperties == NULL) {
+            registration->retiredProperties = celix_arrayList_create();
+        }
+        celix_arrayList_add(registration->retiredProperties, old);
+        __atomic_add_fetch(&registration->nrOfRetiredProperties, 1, __ATOMIC_SEQ_CST);
+    }
+    if (registration->svcObj != NULL && !registration->isUnregistering) { //note valid and not unregistering
+        callback = registration->callback;
+    }
     celixThreadRwlock_unlock(&registration->lock);
 
+    serviceRegistration_freeRetiredPropertiesIfUnused(registration);
+
+    if (status == CELIX_SUCCESS && callback.modified != NULL) {
+        callback.modified(callback.handle, registration);
+    }
+
 	return status;
 }
 
+properties_pt serviceRegistration_beginPropertiesRead(service_registration_pt registration) {
+    __atomic_add_fetch(&registration->propertiesReaders, 1, __ATOMIC_SEQ_CST);
+    //note seq_cst (instead of acquire), so that the load cannot be ordered before the readers increment
+    return __atomic_load_n(&registration->properties, __ATOMIC_SEQ_CST);
+}
+
+void serviceRegistration_endPropertiesRead(service_registration_pt registration) {
+    size_t readers = __atomic_sub_fetch(&registration->propertiesReaders, 1, __ATOMIC_SEQ_CST);
+    if (readers == 0 && __atomic_load_n(&registration->nrOfRetiredProperties, __ATOMIC_SEQ_CST) > 0) {
+        serviceRegistration_freeRetiredPropertiesIfUnused(registration);
+    }
+}
+
+/**
+ * Frees the replaced properties if no properties read section is active.
+ * Replaced properties cannot be loaded by new readers, so readers which can still use them are counted in
+ * propertiesReaders.
+ */
+static void serviceRegistration_freeRetiredPropertiesIfUnused(service_registration_pt registration) {
+    celixThreadRwlock_writeLock(&registration->lock);
+    if (registration->retiredProperties != NULL && __atomic_load_n(&registration->propertiesReaders, __ATOMIC_SEQ_CST) == 0) {
+        for (int i = 0; i < celix_arrayList_size(registration->retiredProperties); ++i) {
+            properties_destroy(celix_arrayList_get(registration->retiredProperties, i));
+        }
+        celix_arrayList_clear(registration->retiredProperties);
+        __atomic_store_n(&registration->nrOfRetiredProperties, 0, __ATOMIC_SEQ_CST);
+    }
+    celixThreadRwlock_unlock(&registration->lock);
+}
+
 
 celix_status_t serviceRegistration_getBundle(service_registration_pt registration, bundle_pt *bundle) {
     celix_status_t status = CELIX_SUCCESS;
@@ -35,7 +35,10 @@ struct serviceRegistration {
 
 	char * className;
 	bundle_pt bundle;
-	properties_pt properties;
+	properties_pt properties; //written with lock (atomic access), see serviceRegistration_beginPropertiesRead
+	celix_array_list_t *retiredProperties; //replaced properties, freed when there are no properties readers (protected by lock)
+	size_t nrOfRetiredProperties; //size of retiredProperties (atomic access)
+	size_t propertiesReaders; //nr of active properties read sections (atomic access)
 	unsigned long serviceId;
 
 	bool isUnregistering;
@@ -65,6 +68,19 @@ void serviceRegistration_invalidate(service_registration_pt registration);
 celix_status_t serviceRegistration_getService(service_registration_pt registration, bundle_pt bundle, const void **service);
 celix_status_t serviceRegistration_ungetService(service_registration_pt registration, bundle_pt bundle, const void **service);
 
+/**
+ * Begins a properties read section and returns the current properties of the registration.
+ * Properties replaced with serviceRegistration_setProperties are not freed as long as there are properties read
+ * sections active, so the returned properties stay valid until serviceRegistration_endPropertiesRead is called.
+ * Properties read sections can be nested.
+ */
+properties_pt serviceRegistration_beginPropertiesRead(service_registration_pt registration);
+
+/**
+ * Ends a properties read section. The last reader frees the replaced properties.
+ */
+void serviceRegistration_endPropertiesRead(service_registration_pt registration);
+
 celix_status_t serviceRegistration_getBundle(service_registration_pt registration, bundle_pt *bundle);
 celix_status_t serviceRegistration_getServiceName(service_registration_pt registration, const char **serviceName);
 
@@ -35,6 +35,7 @@ static celix_status_t serviceRegistry_addHooks(service_registry_pt registry, con
 static celix_status_t serviceRegistry_removeHook(service_registry_pt registry, service_registration_pt registration);
 static void serviceRegistry_logWarningServiceReferenceUsageCount(service_registry_pt registry, bundle_pt bundle, service_reference_pt ref, size_t usageCount, size_t refCount);
 static celix_status_t serviceRegistry_getUsingBundles(service_registry_pt registry, service_registration_pt reg, array_list_pt *bundles);
+static void serviceRegistry_servicePropertiesModified(service_registry_pt registry, service_registration_pt registration);
 static celix_status_t serviceRegistry_getServiceReference_internal(service_registry_pt registry, bundle_pt owner, service_registration_pt registration, service_reference_pt *out);
 static void celix_serviceRegistry_serviceChanged(celix_service_registry_t *registry, celix_service_event_type_t eventType, service_registration_pt registration);
 static void serviceRegistry_callHooksForListenerFilter(service_registry_pt registry, celix_bundle_t *owner, const celix_filter_t *filter, bool removed);
@@ -63,6 +64,7 @@ celix_status_t serviceRegistry_create(framework_pt framework, service_registry_p
         reg->callback.handle = reg;
         reg->callback.getUsingBundles = (void *)serviceRegistry_getUsingBundles;
         reg->callback.unregister = (void *) serviceRegistry_unregisterService;
+        reg->callback.modified = (void *) serviceRegistry_servicePropertiesModified;
 
 		reg->serviceRegistrations = hashMap_create(NULL, NULL, NULL, NULL);
 		reg->framework = framework;
@@ -230,6 +232,12 @@ static celix_status_t serviceRegistry_registerServiceInternal(service_registry_p
 	return CELIX_SUCCESS;
 }
 
+static void serviceRegistry_servicePropertiesModified(service_registry_pt registry, service_registration_pt registration) {
+    //note the MODIFIED event should not overtake the REGISTERED event(s)
+    celix_waitForPendingRegisteredEvents(registry, serviceRegistration_getServiceId(registration));
+    celix_serviceRegistry_serviceChanged(registry, OSGI_FRAMEWORK_SERVICE_EVENT_MODIFIED, registration);
+}
+
 celix_status_t serviceRegistry_unregisterService(service_registry_pt registry, bundle_pt bundle, service_registration_pt registration) {
 	// array_list_t clients;
 	celix_array_list_t *regs;
@@ -750,10 +758,12 @@ static void serviceRegistry_callHooksForListenerFilter(service_registry_pt regis
     info.context = ctx;
     info.removed = removed;
     info.filter = celix_filter_getFilterString(filter);
-    celix_array_list_t *infos = celix_arrayList_create();
+    celix_array_list_storage_t infosStorage;
+    celix_array_list_t *infos = celix_arrayList_createInStorage(&infosStorage);
     celix_arrayList_add(infos, &info);
 
-    celix_array_list_t *hookRegistrations = celix_arrayList_create();
+    celix_array_list_storage_t hookRegistrationsStorage;
+    celix_array_list_t *hookRegistrations = celix_arrayList_createInStorage(&hookRegistrationsStorage);
 
     celixThreadRwlock_readLock(&registry->lock);
     unsigned size = arrayList_size(registry->listenerHooks);
@@ -846,6 +856,7 @@ static celix_service_registry_listener_hook_entry_t* celix_createHookEntry(long
     celix_service_registry_listener_hook_entry_t* entry = calloc(1, sizeof(*entry));
     entry->svcId = svcId;
     entry->hook = hook;
+    entry->useCount = 1; //new entry -> count on 1
     celixThreadMutex_create(&entry->mutex, NULL);
     celixThreadCondition_init(&entry->cond, NULL);
     return entry;
@@ -853,14 +864,15 @@ static celix_service_registry_listener_hook_entry_t* celix_createHookEntry(long
 
 static void celix_waitAndDestroyHookEntry(celix_service_registry_listener_hook_entry_t *entry) {
     if (entry != NULL) {
+        celix_decreaseCountHook(entry); //release the registry count
         celixThreadMutex_lock(&entry->mutex);
         int waitCount = 0;
-        while (entry->useCount > 0) {
+        while (!entry->unused) {
             celixThreadCondition_timedwaitRelative(&entry->cond, &entry->mutex, 1, 0); //wait for 1 second
             waitCount += 1;
             if (waitCount >= 5) {
                 fw_log(celix_frameworkLogger_globalLogger(), CELIX_LOG_LEVEL_WARNING,
-                        "Still waiting for service listener hook use count to become zero. Waiting for %i seconds. Use Count is %i, svc id is %li", waitCount, (int)entry->useCount, entry->svcId);
+                        "Still waiting for service listener hook use count to become zero. Waiting for %i seconds. Use Count is %i, svc id is %li", waitCount, (int)__atomic_load_n(&entry->useCount, __ATOMIC_RELAXED), entry->svcId);
             }
         }
         celixThreadMutex_unlock(&entry->mutex);
@@ -873,16 +885,14 @@ static void celix_waitAndDestroyHookEntry(celix_service_registry_listener_hook_e
 }
 static void celix_increaseCountHook(celix_service_registry_listener_hook_entry_t *entry) {
     if (entry != NULL) {
-        celixThreadMutex_lock(&entry->mutex);
-        entry->useCount += 1;
-        celixThreadCondition_broadcast(&entry->cond);
-        celixThreadMutex_unlock(&entry->mutex);
+        __atomic_add_fetch(&entry->useCount, 1, __ATOMIC_RELAXED);
     }
 }
 static void celix_decreaseCountHook(celix_service_registry_listener_hook_entry_t *entry) {
-    if (entry != NULL) {
+    if (entry != NULL && __atomic_sub_fetch(&entry->useCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        //last release, only possible after the hook is removed -> wake up celix_waitAndDestroyHookEntry
         celixThreadMutex_lock(&entry->mutex);
-        entry->useCount -= 1;
+        entry->unused = true;
         celixThreadCondition_broadcast(&entry->cond);
         celixThreadMutex_unlock(&entry->mutex);
     }
@@ -890,17 +900,15 @@ static void celix_decreaseCountHook(celix_service_registry_listener_hook_entry_t
 
 static void celix_increaseCountServiceListener(celix_service_registry_service_listener_entry_t *entry) {
     if (entry != NULL) {
-        celixThreadMutex_lock(&entry->mutex);
-        entry->useCount += 1;
-        celixThreadCondition_broadcast(&entry->cond);
-        celixThreadMutex_unlock(&entry->mutex);
+        __atomic_add_fetch(&entry->useCount, 1, __ATOMIC_RELAXED);
     }
 }
 
 static void celix_decreaseCountServiceListener(celix_service_registry_service_listener_entry_t *entry) {
-    if (entry != NULL) {
+    if (entry != NULL && __atomic_sub_fetch(&entry->useCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        //last release, only possible after the listener is removed -> wake up celix_waitAndDestroyServiceListener
         celixThreadMutex_lock(&entry->mutex);
-        entry->useCount -= 1;
+        entry->unused = true;
         celixThreadCondition_broadcast(&entry->cond);
         celixThreadMutex_unlock(&entry->mutex);
     }
@@ -908,7 +916,7 @@ static void celix_decreaseCountServiceListener(celix_service_registry_service_li
 
 static inline void celix_waitAndDestroyServiceListener(celix_service_registry_service_listener_entry_t *entry) {
     celixThreadMutex_lock(&entry->mutex);
-    while (entry->useCount != 0) {
+    while (!entry->unused) {
         celixThreadCondition_wait(&entry->cond, &entry->mutex);
     }
     celixThreadMutex_unlock(&entry->mutex);
@@ -1011,7 +1019,8 @@ celix_array_list_t* celix_serviceRegisrty_findServices(
     }
 
     celix_array_list_t *result = celix_arrayList_create();
-    celix_array_list_t* matchedRegistrations = celix_arrayList_create();
+    celix_array_list_storage_t matchedRegistrationsStorage;
+    celix_array_list_t* matchedRegistrations = celix_arrayList_createInStorage(&matchedRegistrationsStorage);
 
     celixThreadRwlock_readLock(&registry->lock);
 
@@ -1118,7 +1127,8 @@ celix_status_t celix_serviceRegistry_addServiceListener(celix_service_registry_t
     celixThreadMutex_create(&entry->mutex, NULL);
     celixThreadCondition_init(&entry->cond, NULL);
 
-    celix_array_list_t *references =  celix_arrayList_create();
+    celix_array_list_storage_t referencesStorage;
+    celix_array_list_t *references = celix_arrayList_createInStorage(&referencesStorage);
 
     celixThreadRwlock_writeLock(&registry->lock);
     celix_arrayList_add(registry->serviceListeners, entry); //use count 1
@@ -1169,7 +1179,6 @@ celix_status_t celix_serviceRegistry_addServiceListener(celix_service_registry_t
 
     serviceRegistry_callHooksForListenerFilter(registry, bundle, entry->filter, false);
 
-    celix_decreaseCountServiceListener(entry); //use count decreased, can be 0
     return CELIX_SUCCESS;
 }
 
@@ -1189,6 +1198,7 @@ celix_status_t celix_serviceRegistry_removeServiceListener(celix_service_registr
 
     if (entry != NULL) {
         serviceRegistry_callHooksForListenerFilter(registry, entry->bundle, entry->filter, true);
+        celix_decreaseCountServiceListener(entry); //release the registry count
         celix_waitAndDestroyServiceListener(entry);
     } else {
         fw_log(registry->framework->logger, CELIX_LOG_LEVEL_ERROR, "Cannot remove service listener, listener not found");
@@ -1200,8 +1210,11 @@ celix_status_t celix_serviceRegistry_removeServiceListener(celix_service_registr
 static void celix_serviceRegistry_serviceChanged(celix_service_registry_t *registry, celix_service_event_type_t eventType, service_registration_pt registration) {
     celix_service_registry_service_listener_entry_t *entry;
 
-    celix_array_list_t* retainedEntries = celix_arrayList_create();
-    celix_array_list_t* matchedEntries = celix_arrayList_create();
+    //note stack lists, no heap allocation is needed for up to CELIX_ARRAY_LIST_INLINE_CAPACITY listeners
+    celix_array_list_storage_t retainedEntriesStorage;
+    celix_array_list_storage_t matchedEntriesStorage;
+    celix_array_list_t* retainedEntries = celix_arrayList_createInStorage(&retainedEntriesStorage);
+    celix_array_list_t* matchedEntries = celix_arrayList_createInStorage(&matchedEntriesStorage);
 
     celixThreadRwlock_readLock(&registry->lock);
     for (int i = 0; i < celix_arrayList_size(registry->serviceListeners); ++i) {
@@ -1214,12 +1227,13 @@ static void celix_serviceRegistry_serviceChanged(celix_service_registry_t *regis
     for (int i = 0; i < celix_arrayList_size(retainedEntries); ++i) {
         entry = celix_arrayList_get(retainedEntries, i);
         int matched = 0;
-        celix_properties_t *props = NULL;
         bool matchResult = false;
-        serviceRegistration_getProperties(registration, &props);
+        //note properties read section, because the properties can be replaced concurrently
+        celix_properties_t *props = serviceRegistration_beginPropertiesRead(registration);
         if (entry->filter != NULL) {
             filter_match(entry->filter, props, &matchResult);
         }
+        serviceRegistration_endPropertiesRead(registration);
         matched = (entry->filter == NULL) || matchResult;
         if (matched) {
             celix_arrayList_add(matchedEntries, entry);
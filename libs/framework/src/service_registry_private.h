@@ -86,18 +86,20 @@ struct celix_serviceRegistry {
 typedef struct celix_service_registry_listener_hook_entry {
     long svcId;
     celix_listener_hook_service_t *hook;
-    celix_thread_mutex_t mutex; //protects below
+    unsigned int useCount; //atomic access, the registry holds 1 count until the hook is removed
+    celix_thread_mutex_t mutex; //protects unused, only used on the destroy path
     celix_thread_cond_t cond;
-    unsigned int useCount;
+    bool unused; //true if the use count dropped to 0
 } celix_service_registry_listener_hook_entry_t;
 
 typedef struct celix_service_registry_service_listener_entry {
     celix_bundle_t *bundle;
     celix_filter_t *filter;
     celix_service_listener_t *listener;
-    celix_thread_mutex_t mutex; //protects below
+    unsigned int useCount; //atomic access, the registry holds 1 count until the listener is removed
+    celix_thread_mutex_t mutex; //protects unused, only used on the destroy path
     celix_thread_cond_t cond;
-    unsigned int useCount;
+    bool unused; //true if the use count dropped to 0
 } celix_service_registry_service_listener_entry_t;
 
 struct usageCount {
@@ -21,6 +21,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "service_reference_private.h"
+#include "service_registration_private.h"
 #include "framework_private.h"
 #include <assert.h>
 #include <unistd.h>
@@ -52,13 +53,41 @@ static void* shutdownServiceTrackerInstanceHandler(void *data);
 static void serviceTracker_serviceChanged(void *handle, celix_service_event_t *event);
 
 
-static inline celix_tracked_entry_t* tracked_create(service_reference_pt ref, void *svc, celix_properties_t *props, celix_bundle_t *bnd) {
+/**
+ * Returns the current properties of the tracked service. The properties stay valid until tracked_endPropertiesRead,
+ * also if the properties of the service are replaced in the meantime.
+ */
+static inline const celix_properties_t* tracked_beginPropertiesRead(celix_tracked_entry_t *tracked) {
+    return tracked->registration == NULL ? NULL : serviceRegistration_beginPropertiesRead(tracked->registration);
+}
+
+static inline void tracked_endPropertiesRead(celix_tracked_entry_t *tracked) {
+    if (tracked->registration != NULL) {
+        serviceRegistration_endPropertiesRead(tracked->registration);
+    }
+}
+
+static inline long tracked_readServiceRanking(celix_tracked_entry_t *tracked) {
+    const celix_properties_t *props = tracked_beginPropertiesRead(tracked);
+    long ranking = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_RANKING, 0);
+    tracked_endPropertiesRead(tracked);
+    return ranking;
+}
+
+static inline celix_tracked_entry_t* tracked_create(service_reference_pt ref, void *svc, service_registration_t *reg, celix_bundle_t *bnd) {
     celix_tracked_entry_t *tracked = calloc(1, sizeof(*tracked));
     tracked->reference = ref;
     tracked->service = svc;
-    tracked->properties = props;
+    tracked->registration = reg;
+    if (reg != NULL) {
+        serviceRegistration_retain(reg);
+    }
     tracked->serviceOwner = bnd;
-    tracked->serviceName = celix_properties_get(props, OSGI_FRAMEWORK_OBJECTCLASS, "Error");
+    const celix_properties_t *props = tracked_beginPropertiesRead(tracked);
+    tracked->serviceName = celix_utils_strdup(celix_properties_get(props, OSGI_FRAMEWORK_OBJECTCLASS, "Error"));
+    tracked->serviceId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1);
+    tracked->serviceRanking = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_RANKING, 0);
+    tracked_endPropertiesRead(tracked);
 
     tracked->useCount = 1;
     celixThreadMutex_create(&tracked->mutex, NULL);
@@ -67,32 +96,81 @@ static inline celix_tracked_entry_t* tracked_create(service_reference_pt ref, vo
 }
 
 static inline void tracked_retain(celix_tracked_entry_t *tracked) {
-    celixThreadMutex_lock(&tracked->mutex);
-    tracked->useCount += 1;
-    celixThreadMutex_unlock(&tracked->mutex);
+    __atomic_add_fetch(&tracked->useCount, 1, __ATOMIC_RELAXED);
 }
 
 static inline void tracked_release(celix_tracked_entry_t *tracked) {
-    celixThreadMutex_lock(&tracked->mutex);
-    assert(tracked->useCount > 0);
-    tracked->useCount -= 1;
-    celixThreadCondition_signal(&tracked->useCond);
-    celixThreadMutex_unlock(&tracked->mutex);
+    size_t count = __atomic_fetch_sub(&tracked->useCount, 1, __ATOMIC_ACQ_REL);
+    assert(count > 0);
+    if (count == 1) {
+        //last release, only possible after the entry is untracked -> wake up tracked_waitAndDestroy
+        celixThreadMutex_lock(&tracked->mutex);
+        tracked->unused = true;
+        celixThreadCondition_signal(&tracked->useCond);
+        celixThreadMutex_unlock(&tracked->mutex);
+    }
 }
 
 static inline void tracked_waitAndDestroy(celix_tracked_entry_t *tracked) {
     celixThreadMutex_lock(&tracked->mutex);
-    while (tracked->useCount != 0) {
+    while (!tracked->unused) {
         celixThreadCondition_wait(&tracked->useCond, &tracked->mutex);
     }
     celixThreadMutex_unlock(&tracked->mutex);
 
     //destroy
+    if (tracked->registration != NULL) {
+        serviceRegistration_release(tracked->registration);
+    }
+    free(tracked->serviceName);
     celixThreadMutex_destroy(&tracked->mutex);
     celixThreadCondition_destroy(&tracked->useCond);
     free(tracked);
 }
 
+/**
+ * Adds the tracked entry to the trackedServices on the position for its ranking and service id, so that the highest
+ * ranking service is always the first entry. Called with the tracker mutex.
+ */
+static void serviceTracker_addOrdered(service_tracker_t *tracker, celix_tracked_entry_t *tracked) {
+    int size = celix_arrayList_size(tracker->trackedServices);
+    int index = 0;
+    while (index < size) {
+        celix_tracked_entry_t *visit = celix_arrayList_get(tracker->trackedServices, index);
+        if (utils_compareServiceIdsAndRanking(tracked->serviceId, tracked->serviceRanking, visit->serviceId, visit->serviceRanking) < 0) {
+            break;
+        }
+        ++index;
+    }
+    arrayList_addIndex(tracker->trackedServices, index, tracked);
+}
+
+/**
+ * Publishes a new snapshot of the trackedServices. Called with the tracker mutex.
+ * The returned old snapshot should be retired with serviceTracker_retireSnapshot, after unlocking the tracker mutex.
+ */
+static celix_tracked_snapshot_t* serviceTracker_publishSnapshot(service_tracker_t *tracker) {
+    celix_tracked_snapshot_t *snapshot = NULL;
+    int size = celix_arrayList_size(tracker->trackedServices);
+    if (size > 0) {
+        snapshot = malloc(sizeof(*snapshot) + sizeof(snapshot->entries[0]) * size);
+        snapshot->size = size;
+        for (int i = 0; i < size; ++i) {
+            snapshot->entries[i] = celix_arrayList_get(tracker->trackedServices, i);
+        }
+    }
+    return __atomic_exchange_n(&tracker->snapshot, snapshot, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Waits until the old snapshot is no longer used by the use functions and frees it.
+ * After this, entries which are not in the current snapshot cannot be retained anymore.
+ */
+static void serviceTracker_retireSnapshot(service_tracker_t *tracker, celix_tracked_snapshot_t *old) {
+    celix_rcu_synchronize(tracker->rcu);
+    free(old);
+}
+
 celix_status_t serviceTracker_create(bundle_context_pt context, const char * service, service_tracker_customizer_pt customizer, service_tracker_pt *tracker) {
 	celix_status_t status = CELIX_SUCCESS;
 
@@ -129,6 +207,7 @@ celix_status_t serviceTracker_createWithFilter(bundle_context_pt context, const
 
     celixThreadMutex_create(&tracker->mutex, NULL);
     tracker->currentHighestServiceId = -1;
+    tracker->rcu = celix_rcu_create();
 
     tracker->listener.handle = tracker;
     tracker->listener.serviceChanged = (void *) serviceTracker_serviceChanged;
@@ -157,6 +236,8 @@ celix_status_t serviceTracker_destroy(service_tracker_pt tracker) {
     celixThreadCondition_destroy(&tracker->cond);
     celix_arrayList_destroy(tracker->trackedServices);
     celix_arrayList_destroy(tracker->untrackingServices);
+    free(tracker->snapshot);
+    celix_rcu_destroy(tracker->rcu);
     free(tracker);
 	return CELIX_SUCCESS;
 }
@@ -199,15 +280,19 @@ celix_status_t serviceTracker_close(service_tracker_t* tracker) {
     do {
         celixThreadMutex_lock(&tracker->mutex);
         celix_tracked_entry_t* tracked = NULL;
+        celix_tracked_snapshot_t* oldSnapshot = NULL;
         nrOfTrackedEntries = celix_arrayList_size(tracker->trackedServices);
         if (nrOfTrackedEntries > 0) {
-            tracked = celix_arrayList_get(tracker->trackedServices, 0);
-            celix_arrayList_removeAt(tracker->trackedServices, 0);
+            //untrack the lowest ranking service first, so that the highest ranking service stays set until the last untrack
+            tracked = celix_arrayList_get(tracker->trackedServices, nrOfTrackedEntries - 1);
+            celix_arrayList_removeAt(tracker->trackedServices, nrOfTrackedEntries - 1);
             celix_arrayList_add(tracker->untrackingServices, tracked);
+            oldSnapshot = serviceTracker_publishSnapshot(tracker);
         }
         celixThreadMutex_unlock(&tracker->mutex);
 
         if (tracked != NULL) {
+            serviceTracker_retireSnapshot(tracker, oldSnapshot);
             int currentSize = nrOfTrackedEntries - 1;
             if (currentSize == 0) {
                 serviceTracker_checkAndInvokeSetService(tracker, NULL, NULL, NULL);
@@ -370,6 +455,7 @@ static celix_status_t serviceTracker_track(service_tracker_t* tracker, service_r
 	celix_status_t status = CELIX_SUCCESS;
 
     celix_tracked_entry_t *found = NULL;
+    celix_tracked_snapshot_t *oldSnapshot = NULL;
 
     bundleContext_retainServiceReference(tracker->context, reference);
 
@@ -381,6 +467,18 @@ static celix_status_t serviceTracker_track(service_tracker_t* tracker, service_r
         if (equals) {
             //NOTE it is possible to get two REGISTERED events, second one can be ignored.
             found = visit;
+            long ranking = visit->serviceRanking;
+            if (event != NULL && event->type == OSGI_FRAMEWORK_SERVICE_EVENT_MODIFIED) {
+                ranking = tracked_readServiceRanking(visit);
+            }
+            if (ranking != visit->serviceRanking) {
+                //ranking modified, move entry to the new position
+                celix_arrayList_removeAt(tracker->trackedServices, i);
+                visit->serviceRanking = ranking;
+                serviceTracker_addOrdered(tracker, visit);
+                oldSnapshot = serviceTracker_publishSnapshot(tracker);
+                tracked_retain(visit); //keep the entry (and its service name) until the set callback is updated
+            }
             break;
         }
     }
@@ -394,26 +492,32 @@ static celix_status_t serviceTracker_track(service_tracker_t* tracker, service_r
             assert(reference != NULL);
 
             service_registration_t *reg = NULL;
-            properties_t *props = NULL;
             bundle_t *bnd = NULL;
 
             serviceReference_getBundle(reference, &bnd);
             serviceReference_getServiceRegistration(reference, &reg);
-            if (reg != NULL) {
-                serviceRegistration_getProperties(reg, &props);
-            }
 
-            celix_tracked_entry_t *tracked = tracked_create(reference, service, props, bnd); //use count 1
+            celix_tracked_entry_t *tracked = tracked_create(reference, service, reg, bnd); //use count 1
 
             celixThreadMutex_lock(&tracker->mutex);
-            arrayList_add(tracker->trackedServices, tracked);
+            //note re-read the ranking with the tracker mutex, a modified event handled before this is not applied on the entry
+            tracked->serviceRanking = tracked_readServiceRanking(tracked);
+            serviceTracker_addOrdered(tracker, tracked);
+            oldSnapshot = serviceTracker_publishSnapshot(tracker);
             celixThreadMutex_unlock(&tracker->mutex);
+            serviceTracker_retireSnapshot(tracker, oldSnapshot);
 
             serviceTracker_invokeAddService(tracker, tracked);
             celix_serviceTracker_useHighestRankingService(tracker, tracked->serviceName, tracker, NULL, NULL, serviceTracker_checkAndInvokeSetService);
         }
     } else {
         bundleContext_ungetServiceReference(tracker->context, reference);
+        if (oldSnapshot != NULL) {
+            //ranking of the found entry is modified, the highest ranking service can be changed.
+            serviceTracker_retireSnapshot(tracker, oldSnapshot);
+            celix_serviceTracker_useHighestRankingService(tracker, found->serviceName, tracker, NULL, NULL, serviceTracker_checkAndInvokeSetService);
+            tracked_release(found);
+        }
     }
 
     framework_logIfError(tracker->context->framework->logger, status, NULL, "Cannot track reference");
@@ -470,12 +574,14 @@ static celix_status_t serviceTracker_invokeAddService(service_tracker_t *tracker
     if (tracker->add != NULL) {
         tracker->add(handle, tracked->service);
     }
+    const celix_properties_t *props = tracked_beginPropertiesRead(tracked);
     if (tracker->addWithProperties != NULL) {
-        tracker->addWithProperties(handle, tracked->service, tracked->properties);
+        tracker->addWithProperties(handle, tracked->service, props);
     }
     if (tracker->addWithOwner != NULL) {
-        tracker->addWithOwner(handle, tracked->service, tracked->properties, tracked->serviceOwner);
+        tracker->addWithOwner(handle, tracked->service, props, tracked->serviceOwner);
     }
+    tracked_endPropertiesRead(tracked);
     return status;
 }
 
@@ -505,6 +611,7 @@ static celix_status_t serviceTracker_invokeAddingService(service_tracker_t *trac
 static celix_status_t serviceTracker_untrack(service_tracker_t* tracker, service_reference_pt reference) {
     celix_status_t status = CELIX_SUCCESS;
     celix_tracked_entry_t *remove = NULL;
+    celix_tracked_snapshot_t *oldSnapshot = NULL;
     const char *serviceName = NULL;
 
     celixThreadMutex_lock(&tracker->mutex);
@@ -518,6 +625,7 @@ static celix_status_t serviceTracker_untrack(service_tracker_t* tracker, service
             //remove from trackedServices to prevent getting this service, but don't destroy yet, can be in use
             celix_arrayList_removeAt(tracker->trackedServices, i);
             celix_arrayList_add(tracker->untrackingServices, remove);
+            oldSnapshot = serviceTracker_publishSnapshot(tracker);
             break;
         }
     }
@@ -525,6 +633,7 @@ static celix_status_t serviceTracker_untrack(service_tracker_t* tracker, service
     celixThreadMutex_unlock(&tracker->mutex);
 
     if (remove != NULL) {
+        serviceTracker_retireSnapshot(tracker, oldSnapshot);
         if (size == 0) {
             serviceTracker_checkAndInvokeSetService(tracker, NULL, NULL, NULL);
         } else {
@@ -582,12 +691,14 @@ static celix_status_t serviceTracker_invokeRemovingService(service_tracker_t *tr
     if (tracker->remove != NULL) {
         tracker->remove(handle, tracked->service);
     }
+    const celix_properties_t *props = tracked_beginPropertiesRead(tracked);
     if (tracker->addWithProperties != NULL) {
-        tracker->removeWithProperties(handle, tracked->service, tracked->properties);
+        tracker->removeWithProperties(handle, tracked->service, props);
     }
     if (tracker->removeWithOwner != NULL) {
-        tracker->removeWithOwner(handle, tracked->service, tracked->properties, tracked->serviceOwner);
+        tracker->removeWithOwner(handle, tracked->service, props, tracked->serviceOwner);
     }
+    tracked_endPropertiesRead(tracked);
 
     if (status == CELIX_SUCCESS) {
         status = bundleContext_ungetService(tracker->context, tracked->reference, &ungetSuccess);
@@ -655,6 +766,7 @@ celix_service_tracker_t* celix_serviceTracker_createWithOptions(
 
             celixThreadMutex_create(&tracker->mutex, NULL);
             tracker->currentHighestServiceId = -1;
+            tracker->rcu = celix_rcu_create();
 
             tracker->listener.handle = tracker;
             tracker->listener.serviceChanged = (void *) serviceTracker_serviceChanged;
@@ -663,6 +775,7 @@ celix_service_tracker_t* celix_serviceTracker_createWithOptions(
             if (tracker->filter == NULL) {
                 framework_log(tracker->context->framework->logger, CELIX_LOG_LEVEL_ERROR, __FUNCTION__, __BASE_FILE__, __LINE__,
                               "Error cannot create filter.");
+                celix_rcu_destroy(tracker->rcu);
                 free(tracker->serviceName);
                 free(tracker);
                 return NULL;
@@ -692,41 +805,41 @@ bool celix_serviceTracker_useHighestRankingService(service_tracker_t *tracker,
     bool called = false;
     celix_tracked_entry_t *tracked = NULL;
     celix_tracked_entry_t *highest = NULL;
-    long highestRank = 0;
     unsigned int i;
 
-    //first lock tracker and get highest tracked entry
-    celixThreadMutex_lock(&tracker->mutex);
-    unsigned int size = arrayList_size(tracker->trackedServices);
+    //first get highest tracked entry from the published snapshot, no tracker lock needed
+    int token = celix_rcu_beginRead(tracker->rcu);
+    celix_tracked_snapshot_t *snapshot = __atomic_load_n(&tracker->snapshot, __ATOMIC_SEQ_CST);
+    unsigned int size = snapshot == NULL ? 0 : (unsigned int)snapshot->size;
 
     for (i = 0; i < size; i++) {
-        tracked = (celix_tracked_entry_t *) arrayList_get(tracker->trackedServices, i);
+        tracked = snapshot->entries[i];
         if (serviceName != NULL && tracked->serviceName != NULL && strncmp(tracked->serviceName, serviceName, 10*1024) == 0) {
-            const char *val = properties_getWithDefault(tracked->properties, OSGI_FRAMEWORK_SERVICE_RANKING, "0");
-            long rank = strtol(val, NULL, 10);
-            if (highest == NULL || rank > highestRank) {
-                highest = tracked;
-            }
+            //note the tracked entries are ordered on ranking, so the first match is the highest ranking service
+            highest = tracked;
+            break;
         }
     }
     if (highest != NULL) {
-        //highest found lock tracked entry and increase use count
+        //highest found increase use count, so that the entry cannot be destroyed until used
         tracked_retain(highest);
     }
-    //unlock tracker so that the tracked entry can be removed from the trackedServices list if unregistered.
-    celixThreadMutex_unlock(&tracker->mutex);
+    //end read section so that the tracked entry can be removed from the trackedServices if unregistered.
+    celix_rcu_endRead(tracker->rcu, token);
 
     if (highest != NULL) {
         //got service, call, decrease use count an signal useCond after.
         if (use != NULL) {
             use(callbackHandle, highest->service);
         }
+        const celix_properties_t *props = tracked_beginPropertiesRead(highest);
         if (useWithProperties != NULL) {
-            useWithProperties(callbackHandle, highest->service, highest->properties);
+            useWithProperties(callbackHandle, highest->service, props);
         }
         if (useWithOwner != NULL) {
-            useWithOwner(callbackHandle, highest->service, highest->properties, highest->serviceOwner);
+            useWithOwner(callbackHandle, highest->service, props, highest->serviceOwner);
         }
+        tracked_endPropertiesRead(highest);
         called = true;
         tracked_release(highest);
     }
@@ -742,18 +855,19 @@ size_t celix_serviceTracker_useServices(
         void (*useWithProperties)(void *handle, void *svc, const celix_properties_t *props),
         void (*useWithOwner)(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner)) {
     size_t count = 0;
-    //first lock tracker, get tracked entries and increase use count
-    celixThreadMutex_lock(&tracker->mutex);
-    int size = celix_arrayList_size(tracker->trackedServices);
+    //first get tracked entries from the published snapshot and increase use count, no tracker lock needed
+    int token = celix_rcu_beginRead(tracker->rcu);
+    celix_tracked_snapshot_t *snapshot = __atomic_load_n(&tracker->snapshot, __ATOMIC_SEQ_CST);
+    int size = snapshot == NULL ? 0 : snapshot->size;
     count = (size_t)size;
-    celix_tracked_entry_t *entries[size];
+    celix_tracked_entry_t *entries[size > 0 ? size : 1];
     for (int i = 0; i < size; i++) {
-        celix_tracked_entry_t *tracked = (celix_tracked_entry_t *) arrayList_get(tracker->trackedServices, i);
+        celix_tracked_entry_t *tracked = snapshot->entries[i];
         tracked_retain(tracked);
         entries[i] = tracked;
     }
-    //unlock tracker so that the tracked entry can be removed from the trackedServices list if unregistered.
-    celixThreadMutex_unlock(&tracker->mutex);
+    //end read section so that the tracked entry can be removed from the trackedServices if unregistered.
+    celix_rcu_endRead(tracker->rcu, token);
 
     //then use entries and decrease use count
     for (int i = 0; i < size; i++) {
@@ -762,12 +876,14 @@ size_t celix_serviceTracker_useServices(
         if (use != NULL) {
             use(callbackHandle, entry->service);
         }
+        const celix_properties_t *props = tracked_beginPropertiesRead(entry);
         if (useWithProperties != NULL) {
-            useWithProperties(callbackHandle, entry->service, entry->properties);
+            useWithProperties(callbackHandle, entry->service, props);
         }
         if (useWithOwner != NULL) {
-            useWithOwner(callbackHandle, entry->service, entry->properties, entry->serviceOwner);
+            useWithOwner(callbackHandle, entry->service, props, entry->serviceOwner);
         }
+        tracked_endPropertiesRead(entry);
 
         tracked_release(entry);
     }
@@ -22,6 +22,15 @@
 
 #include "service_tracker.h"
 #include "celix_types.h"
+#include "celix_rcu.h"
+
+/**
+ * Immutable copy of the trackedServices, published for the use functions so that these do not need the tracker mutex.
+ */
+typedef struct celix_tracked_snapshot {
+    int size;
+    struct celix_tracked_entry *entries[];
+} celix_tracked_snapshot_t;
 
 struct celix_serviceTracker {
 	bundle_context_t *context;
@@ -58,22 +67,29 @@ struct celix_serviceTracker {
 
     celix_thread_mutex_t mutex; //projects below
     celix_thread_cond_t  cond;
-    celix_array_list_t *trackedServices;
+    celix_array_list_t *trackedServices; //ordered on service ranking (highest first) and service id (lowest first)
     celix_array_list_t *untrackingServices;
     bool open;
     long currentHighestServiceId;
+
+    celix_rcu_t *rcu;
+    celix_tracked_snapshot_t *snapshot; //published snapshot of trackedServices, NULL if empty (atomic access)
 };
 
 typedef struct celix_tracked_entry {
 	service_reference_pt reference;
 	void *service;
-	const char *serviceName;
-	properties_t *properties;
+	char *serviceName;
+	service_registration_t *registration; //retained, the properties are read with tracked_beginPropertiesRead
 	bundle_t *serviceOwner;
+    long serviceId;
+    long serviceRanking; //parsed once, updated on a modified service event (with the tracker mutex)
+
+    size_t useCount; //atomic access, the tracker holds 1 count until the entry is untracked
 
-    celix_thread_mutex_t mutex; //protects useCount
+    celix_thread_mutex_t mutex; //protects unused, only used on the destroy path
 	celix_thread_cond_t useCond;
-    size_t useCount;
+    bool unused; //true if the use count dropped to 0
 } celix_tracked_entry_t;
 
 
@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * String hash benchmark, compares the (stable) djb2 celix_utils_stringHash with celix_utils_stringFastHash.
+ *
+ * For two key sets (typical service properties and long, remote service endpoint like, keys) the raw hash
+ * throughput and the hash_map_t lookup throughput are measured for both hash functions.
+ *
+ * Usage: string_hash_benchmark [nr of lookups]
+ * Output is a comma separated line per key set and hash, so that results can be collected by scripts.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "celix_utils.h"
+#include "utils.h"
+#include "hash_map.h"
+
+#define BENCHMARK_DEFAULT_NR_OF_LOOKUPS     10000000L
+
+static const char* const BENCHMARK_SERVICE_KEYS[] = {
+        "objectClass",
+        "service.id",
+        "service.bundleid",
+        "service.ranking",
+        "service.scope",
+        "service.version",
+        "service.lang",
+        "service.exported.interfaces",
+        "service.exported.configs",
+        "service.imported",
+        "endpoint.id",
+        "pubsub.topic",
+        "pubsub.scope",
+        "pubsub.serializer",
+        "celix.shell.command.name",
+        "celix.shell.command.usage",
+        "celix.shell.command.description",
+        "org.osgi.framework.storage",
+        NULL
+};
+
+static const char* const BENCHMARK_ENDPOINT_KEYS[] = {
+        "endpoint.framework.uuid.9c6e3f5a-5b6e-4b7e-8a3d-1f2e3d4c5b6a",
+        "org.amdatu.remote.admin.http.url.http://127.0.0.1:8888/services/calculator",
+        "celix.rsa.dfi.interface.descriptor.calculator.avpr",
+        "pubsub.endpoint.uuid.2e3f4a5b-6c7d-8e9f-0a1b-2c3d4e5f6a7b/ping/default",
+        "service.exported.configs.org.amdatu.remote.admin.http",
+        "service.imported.configs.org.amdatu.remote.admin.http",
+        NULL
+};
+
+typedef struct benchmark_hash {
+    const char *name;
+    unsigned int (*hash)(const void *string);
+} benchmark_hash_t;
+
+static double benchmark_elapsed(const struct timespec *start, const struct timespec *end) {
+    return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+static void benchmark_run(const char *keySetName, const char* const *keys, const benchmark_hash_t *hash, long nrOfLookups) {
+    int nrOfKeys = 0;
+    while (keys[nrOfKeys] != NULL) {
+        ++nrOfKeys;
+    }
+
+    //note lookups use copies of the keys, so that the pointer compare in the equals does not hide the string compare
+    char **lookupKeys = calloc((size_t)nrOfKeys, sizeof(*lookupKeys));
+    hash_map_t *map = hashMap_create(hash->hash, NULL, utils_stringEquals, NULL);
+    for (int i = 0; i < nrOfKeys; ++i) {
+        hashMap_put(map, (void*)keys[i], (void*)keys[i]);
+        lookupKeys[i] = strdup(keys[i]);
+    }
+
+    struct timespec start;
+    struct timespec end;
+    unsigned int sum = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < nrOfLookups; ++i) {
+        sum += hash->hash(lookupKeys[i % nrOfKeys]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double hashTime = benchmark_elapsed(&start, &end);
+
+    long nrOfMisses = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < nrOfLookups; ++i) {
+        if (hashMap_get(map, lookupKeys[i % nrOfKeys]) == NULL) {
+            nrOfMisses += 1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double lookupTime = benchmark_elapsed(&start, &end);
+
+    printf("keys=%s,hash=%s,nr_of_keys=%i,hashes_per_s=%.0f,lookups_per_s=%.0f,misses=%li,checksum=%u\n",
+           keySetName, hash->name, nrOfKeys, (double)nrOfLookups / hashTime, (double)nrOfLookups / lookupTime, nrOfMisses, sum);
+
+    hashMap_destroy(map, false, false);
+    for (int i = 0; i < nrOfKeys; ++i) {
+        free(lookupKeys[i]);
+    }
+    free(lookupKeys);
+}
+
+int main(int argc, char **argv) {
+    long nrOfLookups = argc > 1 ? atol(argv[1]) : BENCHMARK_DEFAULT_NR_OF_LOOKUPS;
+    if (nrOfLookups <= 0) {
+        fprintf(stderr, "Usage: %s [nr of lookups]\n", argv[0]);
+        return 1;
+    }
+
+    benchmark_hash_t hashes[] = {
+            {.name = "djb2", .hash = utils_stringHash},
+            {.name = "fast", .hash = utils_stringFastHash}
+    };
+    for (size_t i = 0; i < sizeof(hashes) / sizeof(hashes[0]); ++i) {
+        benchmark_run("service", BENCHMARK_SERVICE_KEYS, &hashes[i], nrOfLookups);
+        benchmark_run("endpoint", BENCHMARK_ENDPOINT_KEYS, &hashes[i], nrOfLookups);
+    }
+    return 0;
+}
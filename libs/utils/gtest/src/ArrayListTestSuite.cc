@@ -0,0 +1,122 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+
+#include "celix_array_list.h"
+#include "array_list.h"
+
+class ArrayListTestSuite : public ::testing::Test {};
+
+static void* toPtr(long val) {
+    return (void*)(uintptr_t)val;
+}
+
+TEST_F(ArrayListTestSuite, GrowFromInlineStorage) {
+    auto *list = celix_arrayList_create();
+    for (long i = 0; i < 100; ++i) {
+        celix_arrayList_addLong(list, i);
+        EXPECT_EQ(i + 1, celix_arrayList_size(list));
+    }
+    for (long i = 0; i < 100; ++i) {
+        EXPECT_EQ(i, celix_arrayList_getLong(list, (int)i));
+    }
+
+    //remove back to below the inline capacity
+    for (long i = 99; i >= 5; --i) {
+        celix_arrayList_removeAt(list, (int)i);
+    }
+    arrayList_trimToSize(list);
+    EXPECT_EQ(5, celix_arrayList_size(list));
+    for (long i = 0; i < 5; ++i) {
+        EXPECT_EQ(i, celix_arrayList_getLong(list, (int)i));
+    }
+    celix_arrayList_addLong(list, 42);
+    EXPECT_EQ(42, celix_arrayList_getLong(list, 5));
+    celix_arrayList_destroy(list);
+}
+
+TEST_F(ArrayListTestSuite, ListInStorage) {
+    celix_array_list_storage_t storage;
+    auto *list = celix_arrayList_createInStorage(&storage);
+    for (long i = 0; i < CELIX_ARRAY_LIST_INLINE_CAPACITY; ++i) {
+        celix_arrayList_add(list, toPtr(i + 1));
+    }
+    EXPECT_EQ(CELIX_ARRAY_LIST_INLINE_CAPACITY, celix_arrayList_size(list));
+    celix_arrayList_remove(list, toPtr(1));
+    EXPECT_EQ(toPtr(2), celix_arrayList_get(list, 0));
+    celix_arrayList_destroy(list);
+
+    //a list in storage can also grow beyond the inline capacity, destroy frees the grown entries
+    list = celix_arrayList_createInStorage(&storage);
+    for (long i = 0; i < 3 * CELIX_ARRAY_LIST_INLINE_CAPACITY; ++i) {
+        celix_arrayList_add(list, toPtr(i + 1));
+    }
+    for (long i = 0; i < 3 * CELIX_ARRAY_LIST_INLINE_CAPACITY; ++i) {
+        EXPECT_EQ(toPtr(i + 1), celix_arrayList_get(list, (int)i));
+    }
+    celix_arrayList_destroy(list);
+}
+
+TEST_F(ArrayListTestSuite, TypedEntries) {
+    auto *list = celix_arrayList_create();
+    celix_arrayList_addInt(list, -1);
+    celix_arrayList_addLong(list, -2L);
+    celix_arrayList_addUInt(list, 3U);
+    celix_arrayList_addULong(list, 4UL);
+    celix_arrayList_addFloat(list, 5.0f);
+    celix_arrayList_addDouble(list, 6.0);
+    celix_arrayList_addBool(list, true);
+    celix_arrayList_addSize(list, 8);
+    EXPECT_EQ(-1, celix_arrayList_getInt(list, 0));
+    EXPECT_EQ(-2L, celix_arrayList_getLong(list, 1));
+    EXPECT_EQ(3U, celix_arrayList_getUInt(list, 2));
+    EXPECT_EQ(4UL, celix_arrayList_getULong(list, 3));
+    EXPECT_EQ(5.0f, celix_arrayList_getFloat(list, 4));
+    EXPECT_EQ(6.0, celix_arrayList_getDouble(list, 5));
+    EXPECT_TRUE(celix_arrayList_getBool(list, 6));
+    EXPECT_EQ(8, celix_arrayList_getSize(list, 7));
+
+    celix_arrayList_removeLong(list, -2L);
+    EXPECT_EQ(7, celix_arrayList_size(list));
+    EXPECT_EQ(3U, celix_arrayList_getUInt(list, 1)); //note removed with a full entry move
+    EXPECT_EQ(6.0, celix_arrayList_getDouble(list, 4));
+    celix_arrayList_destroy(list);
+}
+
+TEST_F(ArrayListTestSuite, AddIndexAndSort) {
+    array_list_pt list = nullptr;
+    arrayList_create(&list);
+    for (long i = 20; i > 0; --i) {
+        arrayList_addIndex(list, 0, toPtr(i));
+    }
+    for (long i = 0; i < 20; ++i) {
+        EXPECT_EQ(toPtr(i + 1), arrayList_get(list, (unsigned int)i));
+    }
+    celix_arrayList_sort(list, [](const void *a, const void *b) -> int {
+        auto la = (long)(uintptr_t)a;
+        auto lb = (long)(uintptr_t)b;
+        return la < lb ? 1 : (la > lb ? -1 : 0); //descending
+    });
+    for (long i = 0; i < 20; ++i) {
+        EXPECT_EQ(toPtr(20 - i), arrayList_get(list, (unsigned int)i));
+    }
+    arrayList_destroy(list);
+}
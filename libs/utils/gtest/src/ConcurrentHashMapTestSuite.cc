@@ -0,0 +1,240 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "celix_rcu_hash_map.h"
+#include "celix_striped_hash_map.h"
+#include "utils.h"
+
+class ConcurrentHashMapTestSuite : public ::testing::Test {};
+
+static void* toKey(long val) {
+    return (void*)(uintptr_t)val;
+}
+
+TEST_F(ConcurrentHashMapTestSuite, RcuHashMapPutGetRemove) {
+    auto *map = celix_rcuHashMap_create(nullptr, nullptr);
+    EXPECT_EQ(0, celix_rcuHashMap_size(map));
+    EXPECT_EQ(nullptr, celix_rcuHashMap_get(map, toKey(1)));
+
+    long values[100];
+    for (long i = 0; i < 100; ++i) {
+        values[i] = i;
+        EXPECT_EQ(nullptr, celix_rcuHashMap_put(map, toKey(i), &values[i]));
+    }
+    EXPECT_EQ(100, celix_rcuHashMap_size(map));
+    for (long i = 0; i < 100; ++i) {
+        EXPECT_EQ(&values[i], celix_rcuHashMap_get(map, toKey(i)));
+    }
+    EXPECT_TRUE(celix_rcuHashMap_hasKey(map, toKey(0))); //note key 0 is a valid key
+    EXPECT_FALSE(celix_rcuHashMap_hasKey(map, toKey(100)));
+
+    long replacement = 42;
+    EXPECT_EQ(&values[1], celix_rcuHashMap_put(map, toKey(1), &replacement));
+    EXPECT_EQ(&replacement, celix_rcuHashMap_get(map, toKey(1)));
+    EXPECT_EQ(100, celix_rcuHashMap_size(map));
+
+    for (long i = 0; i < 100; i += 2) {
+        EXPECT_NE(nullptr, celix_rcuHashMap_remove(map, toKey(i)));
+    }
+    EXPECT_EQ(nullptr, celix_rcuHashMap_remove(map, toKey(0)));
+    EXPECT_EQ(50, celix_rcuHashMap_size(map));
+    for (long i = 3; i < 100; i += 2) {
+        EXPECT_EQ(&values[i], celix_rcuHashMap_get(map, toKey(i)));
+    }
+
+    long sum = 0;
+    celix_rcuHashMap_forEach(map, &sum, [](void *handle, const void */*key*/, void *value) {
+        *static_cast<long*>(handle) += *static_cast<long*>(value);
+    });
+    EXPECT_EQ(2500 - 1 + 42, sum); //sum of odd values below 100, with 1 replaced by 42
+
+    celix_rcuHashMap_destroy(map);
+}
+
+TEST_F(ConcurrentHashMapTestSuite, RcuHashMapStringKeys) {
+    auto *map = celix_rcuHashMap_create(utils_stringHash, utils_stringEquals);
+    char key1[] = "key";
+    char key2[] = "key";
+    int value = 1;
+    celix_rcuHashMap_put(map, key1, &value);
+    EXPECT_EQ(&value, celix_rcuHashMap_get(map, key2));
+    EXPECT_EQ(&value, celix_rcuHashMap_remove(map, key2));
+    EXPECT_EQ(0, celix_rcuHashMap_size(map));
+    celix_rcuHashMap_destroy(map);
+}
+
+TEST_F(ConcurrentHashMapTestSuite, RcuHashMapRemoveWaitsForReaders) {
+    //A removed value should not be in use by a reader after remove returns, so it can be "destroyed"
+    auto *map = celix_rcuHashMap_create(nullptr, nullptr);
+    std::atomic<bool> running{true};
+    std::atomic<int> errors{0};
+    std::atomic<int> nrOfStartedReaders{0};
+
+    std::vector<std::thread> readers{};
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]{
+            nrOfStartedReaders++;
+            while (running.load()) {
+                int token = celix_rcuHashMap_beginRead(map);
+                auto *value = static_cast<std::atomic<long>*>(celix_rcuHashMap_get(map, toKey(1)));
+                if (value != nullptr && value->load() != 1) {
+                    errors++;
+                }
+                celix_rcuHashMap_endRead(map, token);
+            }
+        });
+    }
+
+    while (nrOfStartedReaders.load() < 4) {
+        std::this_thread::yield();
+    }
+    for (int i = 0; i < 200; ++i) {
+        auto *value = new std::atomic<long>{1};
+        celix_rcuHashMap_put(map, toKey(1), value);
+        celix_rcuHashMap_put(map, toKey(i + 2), value); //grow and rehash the snapshot
+        celix_rcuHashMap_remove(map, toKey(i + 2));
+        EXPECT_EQ(value, celix_rcuHashMap_remove(map, toKey(1)));
+        value->store(0); //would be seen by a reader which still uses the value
+        delete value;
+    }
+    running = false;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(0, errors.load());
+    celix_rcuHashMap_destroy(map);
+}
+
+TEST_F(ConcurrentHashMapTestSuite, RcuHashMapUpdateFromReadSection) {
+    auto *map = celix_rcuHashMap_create(nullptr, nullptr);
+    int value = 1;
+    celix_rcuHashMap_put(map, toKey(1), &value);
+    int token = celix_rcuHashMap_beginRead(map);
+    EXPECT_EQ(&value, celix_rcuHashMap_remove(map, toKey(1))); //should not deadlock
+    celix_rcuHashMap_put(map, toKey(2), &value);
+    celix_rcuHashMap_endRead(map, token);
+    EXPECT_EQ(1, celix_rcuHashMap_size(map));
+    celix_rcuHashMap_put(map, toKey(3), &value); //frees the retired snapshots
+    EXPECT_EQ(2, celix_rcuHashMap_size(map));
+    celix_rcuHashMap_destroy(map);
+}
+
+TEST_F(ConcurrentHashMapTestSuite, RcuHashMapUpdateFromReadSectionOfOtherMap) {
+    //A read section of map1 should not prevent that an update of map2 waits for the readers of map2
+    auto *map1 = celix_rcuHashMap_create(nullptr, nullptr);
+    auto *map2 = celix_rcuHashMap_create(nullptr, nullptr);
+    int value = 1;
+    celix_rcuHashMap_put(map1, toKey(1), &value);
+    celix_rcuHashMap_put(map2, toKey(1), &value);
+
+    std::atomic<bool> readerStarted{false};
+    std::atomic<bool> readerDone{false};
+    std::thread reader{[&]{
+        int token = celix_rcuHashMap_beginRead(map2);
+        readerStarted = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        readerDone = true;
+        celix_rcuHashMap_endRead(map2, token);
+    }};
+    while (!readerStarted.load()) {
+        std::this_thread::yield();
+    }
+
+    int token1 = celix_rcuHashMap_beginRead(map1);
+    int token2 = celix_rcuHashMap_beginRead(map2);
+    EXPECT_EQ(&value, celix_rcuHashMap_remove(map2, toKey(1))); //nested read section of map2, should not deadlock
+    celix_rcuHashMap_endRead(map2, token2);
+    EXPECT_FALSE(readerDone.load());
+    celix_rcuHashMap_put(map2, toKey(2), &value); //only in a read section of map1, should wait for the map2 reader
+    EXPECT_TRUE(readerDone.load());
+    EXPECT_EQ(&value, celix_rcuHashMap_remove(map1, toKey(1))); //read section of map1, should not deadlock
+    celix_rcuHashMap_endRead(map1, token1);
+
+    reader.join();
+    EXPECT_EQ(0, celix_rcuHashMap_size(map1));
+    EXPECT_EQ(1, celix_rcuHashMap_size(map2));
+    celix_rcuHashMap_destroy(map1);
+    celix_rcuHashMap_destroy(map2);
+}
+
+TEST_F(ConcurrentHashMapTestSuite, StripedHashMapPutGetRemove) {
+    auto *map = celix_stripedHashMap_create(nullptr, nullptr, 5 /*rounded to 8*/);
+    long values[100];
+    for (long i = 0; i < 100; ++i) {
+        values[i] = i;
+        EXPECT_EQ(nullptr, celix_stripedHashMap_put(map, toKey(i), &values[i]));
+    }
+    EXPECT_EQ(100, celix_stripedHashMap_size(map));
+    EXPECT_EQ(&values[5], celix_stripedHashMap_get(map, toKey(5)));
+    EXPECT_TRUE(celix_stripedHashMap_hasKey(map, toKey(0)));
+    EXPECT_FALSE(celix_stripedHashMap_hasKey(map, toKey(100)));
+
+    long other = 42;
+    EXPECT_EQ(&values[5], celix_stripedHashMap_putIfAbsent(map, toKey(5), &other));
+    EXPECT_EQ(&values[5], celix_stripedHashMap_put(map, toKey(5), &other));
+    EXPECT_EQ(&other, celix_stripedHashMap_get(map, toKey(5)));
+
+    long used = 0;
+    EXPECT_TRUE(celix_stripedHashMap_use(map, toKey(5), &used, [](void *handle, void *value) {
+        *static_cast<long*>(handle) = *static_cast<long*>(value);
+    }));
+    EXPECT_EQ(42, used);
+    EXPECT_FALSE(celix_stripedHashMap_use(map, toKey(100), &used, [](void*, void*) {}));
+
+    EXPECT_EQ(&other, celix_stripedHashMap_remove(map, toKey(5)));
+    EXPECT_EQ(nullptr, celix_stripedHashMap_remove(map, toKey(5)));
+    EXPECT_EQ(99, celix_stripedHashMap_size(map));
+
+    size_t count = 0;
+    celix_stripedHashMap_forEach(map, &count, [](void *handle, const void*, void*) {
+        (*static_cast<size_t*>(handle))++;
+    });
+    EXPECT_EQ(99, count);
+
+    celix_stripedHashMap_destroy(map);
+}
+
+TEST_F(ConcurrentHashMapTestSuite, StripedHashMapConcurrentUpdates) {
+    auto *map = celix_stripedHashMap_create(nullptr, nullptr, 0);
+    std::vector<std::thread> threads{};
+    for (long t = 0; t < 4; ++t) {
+        threads.emplace_back([map, t]{
+            for (long i = 0; i < 1000; ++i) {
+                long key = t * 1000 + i + 1;
+                celix_stripedHashMap_put(map, toKey(key), toKey(key));
+                EXPECT_EQ(toKey(key), celix_stripedHashMap_get(map, toKey(key)));
+                if (i % 2 == 0) {
+                    celix_stripedHashMap_remove(map, toKey(key));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(2000, celix_stripedHashMap_size(map));
+    celix_stripedHashMap_destroy(map);
+}
@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <cstring>
+
+#include "celix_utils.h"
+#include "celix_properties.h"
+
+class StringHashTestSuite : public ::testing::Test {};
+
+TEST_F(StringHashTestSuite, StringHashIsStable) {
+    //note the string hash is used for pubsub msg ids and should not change
+    EXPECT_EQ(193485963, celix_utils_stringHash("abc"));
+    EXPECT_EQ(1532304168, celix_utils_stringHash("abc123def456ghi789jkl012mno345pqr678stu901vwx234yz"));
+}
+
+TEST_F(StringHashTestSuite, FastHashOnAllLengthsAndAlignments) {
+    char buf[256];
+    for (size_t i = 0; i < sizeof(buf); ++i) {
+        buf[i] = (char)('a' + (i * 7) % 26);
+    }
+
+    std::set<unsigned int> hashes{};
+    for (size_t len = 0; len < 120; ++len) {
+        unsigned int hash = celix_utils_memHash(buf, len);
+        hashes.insert(hash);
+        for (size_t offset = 1; offset < 8; ++offset) {
+            //same content on a different (unaligned) address, should give the same hash
+            char copy[256];
+            memcpy(copy + offset, buf, len);
+            EXPECT_EQ(hash, celix_utils_memHash(copy + offset, len));
+        }
+    }
+    EXPECT_EQ(120, hashes.size()); //all prefixes have a different hash
+
+    std::string str{"service.ranking"};
+    EXPECT_EQ(celix_utils_memHash(str.c_str(), str.size()), celix_utils_stringFastHash(str.c_str()));
+}
+
+TEST_F(StringHashTestSuite, FastHashDistribution) {
+    std::set<unsigned int> hashes{};
+    std::set<unsigned int> buckets{}; //low 10 bits, as used for a power of 2 table
+    for (int i = 0; i < 10000; ++i) {
+        std::string key = "celix.service.property." + std::to_string(i);
+        unsigned int hash = celix_utils_stringFastHash(key.c_str());
+        hashes.insert(hash);
+        buckets.insert(hash & 1023U);
+    }
+    EXPECT_GE(hashes.size(), 9990);
+    EXPECT_EQ(1024, buckets.size());
+}
+
+TEST_F(StringHashTestSuite, StringEquals) {
+    const char *str = "service.id";
+    char copy[] = "service.id";
+    EXPECT_TRUE(celix_utils_stringEquals(str, str));
+    EXPECT_TRUE(celix_utils_stringEquals(str, copy));
+    EXPECT_FALSE(celix_utils_stringEquals(str, "service.ids"));
+    EXPECT_FALSE(celix_utils_stringEquals(str, "service.i"));
+    EXPECT_FALSE(celix_utils_stringEquals(str, nullptr));
+    EXPECT_FALSE(celix_utils_stringEquals(nullptr, str));
+    EXPECT_TRUE(celix_utils_stringEquals(nullptr, nullptr));
+}
+
+TEST_F(StringHashTestSuite, PropertiesLookup) {
+    auto *props = celix_properties_create();
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        celix_properties_setLong(props, key.c_str(), i);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        EXPECT_EQ(i, celix_properties_getAsLong(props, key.c_str(), -1));
+    }
+    EXPECT_EQ(-1, celix_properties_getAsLong(props, "key1000", -1));
+    celix_properties_destroy(props);
+}
@@ -43,6 +43,20 @@ typedef union celix_array_list_entry {
 
 typedef struct celix_array_list celix_array_list_t;
 
+/**
+ * The number of entries an array list can contain without an additional heap allocation for the entries.
+ */
+#define CELIX_ARRAY_LIST_INLINE_CAPACITY 10
+
+/**
+ * Storage for an array list which is not heap allocated, e.g. a list on the stack. Should be treated as opaque,
+ * see celix_arrayList_createInStorage.
+ */
+typedef struct celix_array_list_storage {
+    void* reserved[7];
+    celix_array_list_entry_t inlineData[CELIX_ARRAY_LIST_INLINE_CAPACITY];
+} celix_array_list_storage_t;
+
 typedef bool (*celix_arrayList_equals_fp)(celix_array_list_entry_t, celix_array_list_entry_t);
 
 typedef int (*celix_arrayList_sort_fp)(const void *, const void *);
@@ -52,6 +66,18 @@ celix_array_list_t* celix_arrayList_create();
 
 celix_array_list_t* celix_arrayList_createWithEquals(celix_arrayList_equals_fp equals);
 
+/**
+ * Creates an array list in the provided storage. As long as the list contains at most
+ * CELIX_ARRAY_LIST_INLINE_CAPACITY entries, no heap allocation is done.
+ *
+ * The list should still be destroyed with celix_arrayList_destroy, which only frees the entries if the list has
+ * grown beyond the inline capacity. The storage should outlive the list.
+ *
+ * @param storage The storage for the list, e.g. a celix_array_list_storage_t on the stack.
+ * @return The list (located in the storage).
+ */
+celix_array_list_t* celix_arrayList_createInStorage(celix_array_list_storage_t *storage);
+
 void celix_arrayList_destroy(celix_array_list_t *list);
 
 int celix_arrayList_size(const celix_array_list_t *list);
@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_RCU_H_
+#define CELIX_RCU_H_
+
+#include <stdbool.h>
+
+#include "exports.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Epoch based read-copy-update reclamation, as used by the celix_rcu_hash_map_t.
+ *
+ * Readers announce a read section by incrementing a (per thread spread) reader count and never take a lock.
+ * A writer publishes a new version of the data atomically and calls celix_rcu_synchronize, after which no reader
+ * can use the old version anymore and it can be freed.
+ */
+typedef struct celix_rcu celix_rcu_t;
+
+UTILS_EXPORT celix_rcu_t* celix_rcu_create(void);
+
+/**
+ * Destroys the rcu. There should be no active read sections.
+ */
+UTILS_EXPORT void celix_rcu_destroy(celix_rcu_t *rcu);
+
+/**
+ * Starts a read section and returns the token which should be provided to celix_rcu_endRead.
+ * Read sections can be nested.
+ */
+UTILS_EXPORT int celix_rcu_beginRead(celix_rcu_t *rcu);
+
+/**
+ * Ends a read section.
+ */
+UTILS_EXPORT void celix_rcu_endRead(celix_rcu_t *rcu, int token);
+
+/**
+ * Returns whether the calling thread is in a read section of the provided rcu.
+ */
+UTILS_EXPORT bool celix_rcu_inReadSection(const celix_rcu_t *rcu);
+
+/**
+ * Waits until all read sections, which could have started before this call, have ended.
+ * Should not be called from a read section of the same rcu (see celix_rcu_inReadSection), because that would
+ * wait on itself.
+ */
+UTILS_EXPORT void celix_rcu_synchronize(celix_rcu_t *rcu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_RCU_H_ */
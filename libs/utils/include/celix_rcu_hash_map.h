@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_RCU_HASH_MAP_H_
+#define CELIX_RCU_HASH_MAP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "exports.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A read-copy-update hash map for read-mostly data, e.g. registries which are updated on service (un)registration
+ * and read for every call or message.
+ *
+ * Readers use an immutable snapshot of the map and never take a lock; a read section only increments a reader
+ * count. Writers are serialized, create a new snapshot, publish it atomically and wait until the readers which
+ * could still use the old snapshot are done (epoch based reclamation). So after a put or remove returns, the
+ * replaced/removed value is no longer used by readers and can be destroyed.
+ *
+ * Updates copy the whole map, so this map is not suited for data which is updated often.
+ * Keys and values are not owned by the map.
+ */
+typedef struct celix_rcu_hash_map celix_rcu_hash_map_t;
+
+/**
+ * Creates a rcu hash map.
+ *
+ * @param keyHash The hash function for the keys. If NULL the key pointer value is used as hash.
+ * @param keyEquals The equals function for the keys, returns non zero if equal. If NULL keys are compared on
+ *                  pointer value (e.g. for keys like (void*)svcId).
+ */
+UTILS_EXPORT celix_rcu_hash_map_t* celix_rcuHashMap_create(unsigned int (*keyHash)(const void *key), int (*keyEquals)(const void *key1, const void *key2));
+
+/**
+ * Destroys the map. Should not be called concurrently with other calls on the map.
+ */
+UTILS_EXPORT void celix_rcuHashMap_destroy(celix_rcu_hash_map_t *map);
+
+/**
+ * Starts a read section and returns the token which should be provided to celix_rcuHashMap_endRead.
+ * Values found in a read section can be used until the read section ends. Read sections can be nested.
+ */
+UTILS_EXPORT int celix_rcuHashMap_beginRead(celix_rcu_hash_map_t *map);
+
+/**
+ * Ends a read section.
+ */
+UTILS_EXPORT void celix_rcuHashMap_endRead(celix_rcu_hash_map_t *map, int token);
+
+/**
+ * Returns the value for the key or NULL if not present.
+ * If the value can be removed and destroyed concurrently, this should be called in a read section.
+ */
+UTILS_EXPORT void* celix_rcuHashMap_get(celix_rcu_hash_map_t *map, const void *key);
+
+/**
+ * Returns whether the map contains the key.
+ */
+UTILS_EXPORT bool celix_rcuHashMap_hasKey(celix_rcu_hash_map_t *map, const void *key);
+
+/**
+ * Returns the number of entries in the map.
+ */
+UTILS_EXPORT size_t celix_rcuHashMap_size(celix_rcu_hash_map_t *map);
+
+/**
+ * Calls the callback for every entry in the (current snapshot of the) map, in a read section.
+ * The callback should not update the map.
+ */
+UTILS_EXPORT void celix_rcuHashMap_forEach(celix_rcu_hash_map_t *map, void *handle, void (*callback)(void *handle, const void *key, void *value));
+
+/**
+ * Puts the value for the key, replacing the existing value.
+ * Waits until the readers which could still use a replaced value are done.
+ *
+ * If called from a read section the wait is skipped (a thread cannot wait on itself) and the old snapshot is
+ * freed by a later writer; in that case a replaced value can still be used by other readers.
+ *
+ * @return The replaced value or NULL.
+ */
+UTILS_EXPORT void* celix_rcuHashMap_put(celix_rcu_hash_map_t *map, void *key, void *value);
+
+/**
+ * Removes the entry for the key.
+ * Waits until the readers which could still use the removed value are done, see celix_rcuHashMap_put.
+ *
+ * @return The removed value or NULL.
+ */
+UTILS_EXPORT void* celix_rcuHashMap_remove(celix_rcu_hash_map_t *map, const void *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_RCU_HASH_MAP_H_ */
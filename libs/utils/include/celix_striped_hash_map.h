@@ -0,0 +1,109 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_STRIPED_HASH_MAP_H_
+#define CELIX_STRIPED_HASH_MAP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "exports.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A thread safe hash map which is split in stripes, every stripe is a hash map with its own read/write lock.
+ * The stripe is selected on the key hash, so operations on keys in different stripes do not contend.
+ *
+ * Contrary to the celix_rcu_hash_map_t, updates are cheap, but readers do take a (stripe) read lock.
+ * Keys and values are not owned by the map.
+ */
+typedef struct celix_striped_hash_map celix_striped_hash_map_t;
+
+/**
+ * Creates a striped hash map.
+ *
+ * @param keyHash The hash function for the keys. If NULL the key pointer value is used as hash.
+ * @param keyEquals The equals function for the keys, returns non zero if equal. If NULL keys are compared on
+ *                  pointer value (e.g. for keys like (void*)svcId).
+ * @param nrOfStripes The number of stripes, rounded up to a power of 2. If 0 a default of 16 is used.
+ */
+UTILS_EXPORT celix_striped_hash_map_t* celix_stripedHashMap_create(unsigned int (*keyHash)(const void *key), int (*keyEquals)(const void *key1, const void *key2), size_t nrOfStripes);
+
+/**
+ * Destroys the map. Should not be called concurrently with other calls on the map.
+ */
+UTILS_EXPORT void celix_stripedHashMap_destroy(celix_striped_hash_map_t *map);
+
+/**
+ * Returns the value for the key or NULL if not present.
+ * Note that the value can be removed concurrently, use celix_stripedHashMap_use if the value can be destroyed
+ * after a remove.
+ */
+UTILS_EXPORT void* celix_stripedHashMap_get(celix_striped_hash_map_t *map, const void *key);
+
+/**
+ * Returns whether the map contains the key.
+ */
+UTILS_EXPORT bool celix_stripedHashMap_hasKey(celix_striped_hash_map_t *map, const void *key);
+
+/**
+ * Returns the number of entries in the map. With concurrent updates this is an indication.
+ */
+UTILS_EXPORT size_t celix_stripedHashMap_size(celix_striped_hash_map_t *map);
+
+/**
+ * Calls the use callback with the value for the key, while holding the read lock of the stripe.
+ * The callback should not update the map.
+ *
+ * @return True if the key was found and the callback was called.
+ */
+UTILS_EXPORT bool celix_stripedHashMap_use(celix_striped_hash_map_t *map, const void *key, void *handle, void (*use)(void *handle, void *value));
+
+/**
+ * Calls the callback for every entry in the map, stripe by stripe while holding the read lock of that stripe.
+ * The callback should not update the map.
+ */
+UTILS_EXPORT void celix_stripedHashMap_forEach(celix_striped_hash_map_t *map, void *handle, void (*callback)(void *handle, const void *key, void *value));
+
+/**
+ * Puts the value for the key, replacing the existing value.
+ * @return The replaced value or NULL.
+ */
+UTILS_EXPORT void* celix_stripedHashMap_put(celix_striped_hash_map_t *map, void *key, void *value);
+
+/**
+ * Puts the value for the key only if the key is not present.
+ * @return The existing value if the key was present (the value is not put) or NULL.
+ */
+UTILS_EXPORT void* celix_stripedHashMap_putIfAbsent(celix_striped_hash_map_t *map, void *key, void *value);
+
+/**
+ * Removes the entry for the key.
+ * @return The removed value or NULL.
+ */
+UTILS_EXPORT void* celix_stripedHashMap_remove(celix_striped_hash_map_t *map, const void *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_STRIPED_HASH_MAP_H_ */
@@ -26,6 +26,7 @@ extern "C" {
 
 #include <time.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #define CELIX_UTILS_MAX_STRLEN      1024*1024*10
 
@@ -38,11 +39,30 @@ char* celix_utils_strdup(const char *str);
 
 /**
  * Creates a hash from a string
+ *
+ * Note that this (djb2) hash value is stable, it is for example used as pubsub message id. For in-memory hash
+ * tables celix_utils_stringFastHash is preferred.
  * @param string
  * @return hash
  */
 unsigned int celix_utils_stringHash(const char* string);
 
+/**
+ * Creates a hash from the provided data, using a wyhash based hash function which processes 8 bytes at a time.
+ *
+ * The hash value can differ between platforms (endianness) and Celix versions, so it should only be used
+ * for in-memory hash tables.
+ * @param data  The data to hash.
+ * @param len   The length of the data.
+ * @return hash
+ */
+unsigned int celix_utils_memHash(const void* data, size_t len);
+
+/**
+ * Creates a hash from a string using celix_utils_memHash.
+ */
+unsigned int celix_utils_stringFastHash(const char* string);
+
 /**
  * Compares two strings and returns true if the strings are equal.
  */
@@ -25,6 +25,9 @@
 #include "celix_threads.h"
 #include "array_list.h"
 #include "hash_map.h"
+#include "celix_rcu.h"
+#include "celix_rcu_hash_map.h"
+#include "celix_striped_hash_map.h"
 #include "properties.h"
 #include "utils.h"
 #include "celix_utils.h"
@@ -34,6 +34,11 @@ extern "C" {
 
 UTILS_EXPORT unsigned int utils_stringHash(const void *string);
 
+/**
+ * celix_utils_stringFastHash with a hash_map_t compatible signature.
+ */
+UTILS_EXPORT unsigned int utils_stringFastHash(const void *string);
+
 UTILS_EXPORT int utils_stringEquals(const void *string, const void *toCompare);
 
 UTILS_EXPORT char *string_ndup(const char *s, size_t n);
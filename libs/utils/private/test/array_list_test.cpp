@@ -93,7 +93,15 @@ TEST(array_list, trimToSize) {
 
     arrayList_trimToSize(list);
     LONGS_EQUAL(1, list->size);
-    LONGS_EQUAL(1, list->capacity);
+    LONGS_EQUAL(10, list->capacity); //small lists use the inline storage
+
+    for (int i = 0; i < 20; i++) {
+        arrayList_add(list, entry);
+    }
+    arrayList_trimToSize(list);
+    LONGS_EQUAL(21, list->size);
+    LONGS_EQUAL(21, list->capacity);
+    arrayList_clear(list);
 
     free(entry);
 }
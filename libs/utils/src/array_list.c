@@ -36,6 +36,8 @@ static celix_status_t arrayList_elementEquals(const void *a, const void *b, bool
 static bool celix_arrayList_defaultEquals(const celix_array_list_entry_t a, const celix_array_list_entry_t b);
 static bool celix_arrayList_equalsForElement(celix_array_list_t *list, celix_array_list_entry_t a, celix_array_list_entry_t b);
 
+_Static_assert(sizeof(celix_array_list_storage_t) >= sizeof(struct celix_array_list), "celix_array_list_storage_t too small for celix_array_list_t");
+
 
 celix_status_t arrayList_create(array_list_pt *list) {
     return arrayList_createWithEquals(arrayList_elementEquals, list);
@@ -77,29 +79,50 @@ static bool celix_arrayList_equalsForElement(celix_array_list_t *list, celix_arr
 
 void arrayList_trimToSize(array_list_pt list) {
     list->modCount++;
-    size_t oldCapacity = list->capacity;
-    if (list->size < oldCapacity) {
+    if (list->elementData == list->inlineData) {
+        return; //nothing to trim
+    }
+    if (list->size <= CELIX_ARRAY_LIST_INLINE_CAPACITY) {
+        memcpy(list->inlineData, list->elementData, sizeof(celix_array_list_entry_t) * list->size);
+        free(list->elementData);
+        list->elementData = list->inlineData;
+        list->capacity = CELIX_ARRAY_LIST_INLINE_CAPACITY;
+    } else if (list->size < list->capacity) {
         celix_array_list_entry_t * newList = realloc(list->elementData, sizeof(celix_array_list_entry_t) * list->size);
-        list->capacity = list->size;
-        list->elementData = newList;
+        if (newList != NULL) {
+            list->capacity = list->size;
+            list->elementData = newList;
+        }
     }
 }
 
-void arrayList_ensureCapacity(array_list_pt list, int capacity) {
+static void arrayList_grow(celix_array_list_t *list, size_t capacity) {
     celix_array_list_entry_t *newList;
-    list->modCount++;
-    size_t oldCapacity = list->capacity;
-    if (capacity > oldCapacity) {
-        size_t newCapacity = (oldCapacity * 3) / 2 + 1;
-        if (newCapacity < capacity) {
-            newCapacity = capacity;
+    size_t newCapacity = (list->capacity * 3) / 2 + 1;
+    if (newCapacity < capacity) {
+        newCapacity = capacity;
+    }
+    if (list->elementData == list->inlineData) {
+        newList = malloc(sizeof(celix_array_list_entry_t) * newCapacity);
+        if (newList != NULL) {
+            memcpy(newList, list->inlineData, sizeof(celix_array_list_entry_t) * list->size);
         }
+    } else {
         newList = realloc(list->elementData, sizeof(celix_array_list_entry_t) * newCapacity);
+    }
+    if (newList != NULL) {
         list->capacity = newCapacity;
         list->elementData = newList;
     }
 }
 
+void arrayList_ensureCapacity(array_list_pt list, int capacity) {
+    list->modCount++;
+    if (capacity > list->capacity) {
+        arrayList_grow(list, capacity);
+    }
+}
+
 unsigned int arrayList_size(array_list_pt list) {
     return (int)list->size;
 }
@@ -182,9 +205,7 @@ void * arrayList_set(array_list_pt list, unsigned int index, void * element) {
 }
 
 bool arrayList_add(array_list_pt list, void * element) {
-    arrayList_ensureCapacity(list, (int)list->size + 1);
-    memset(&list->elementData[list->size], 0, sizeof(celix_array_list_entry_t));
-    list->elementData[list->size++].voidPtrVal = element;
+    celix_arrayList_add(list, element);
     return true;
 }
 
@@ -195,8 +216,9 @@ int arrayList_addIndex(array_list_pt list, unsigned int index, void * element) {
     }
     arrayList_ensureCapacity(list, (int)list->size+1);
     numMoved = list->size - index;
-    memmove(list->elementData+(index+1), list->elementData+index, sizeof(void *) * numMoved);
+    memmove(list->elementData+(index+1), list->elementData+index, sizeof(celix_array_list_entry_t) * numMoved);
 
+    memset(&list->elementData[index], 0, sizeof(celix_array_list_entry_t));
     list->elementData[index].voidPtrVal = element;
     list->size++;
     return 0;
@@ -212,7 +234,7 @@ void * arrayList_remove(array_list_pt list, unsigned int index) {
     list->modCount++;
     oldElement = list->elementData[index].voidPtrVal;
     numMoved = list->size - index - 1;
-    memmove(list->elementData+index, list->elementData+index+1, sizeof(void *) * numMoved);
+    memmove(list->elementData+index, list->elementData+index+1, sizeof(celix_array_list_entry_t) * numMoved);
     memset(&list->elementData[--list->size], 0, sizeof(celix_array_list_entry_t));
 
     return oldElement;
@@ -223,7 +245,7 @@ void arrayList_fastRemove(array_list_pt list, unsigned int index) {
     list->modCount++;
 
     numMoved = list->size - index - 1;
-    memmove(list->elementData+index, list->elementData+index+1, sizeof(void *) * numMoved);
+    memmove(list->elementData+index, list->elementData+index+1, sizeof(celix_array_list_entry_t) * numMoved);
     memset(&list->elementData[--list->size], 0, sizeof(celix_array_list_entry_t));
 }
 
@@ -364,17 +386,31 @@ celix_array_list_t* celix_arrayList_create() {
 celix_array_list_t* celix_arrayList_createWithEquals(celix_arrayList_equals_fp equals) {
     array_list_t *list = calloc(1, sizeof(*list));
     if (list != NULL) {
-        list->capacity = 10;
-        list->elementData = malloc(sizeof(celix_array_list_entry_t) * list->capacity);
+        list->capacity = CELIX_ARRAY_LIST_INLINE_CAPACITY;
+        list->elementData = list->inlineData;
         list->equals = equals;
     }
     return list;
 }
 
+celix_array_list_t* celix_arrayList_createInStorage(celix_array_list_storage_t *storage) {
+    celix_array_list_t *list = (celix_array_list_t*)storage;
+    memset(list, 0, sizeof(*list));
+    list->capacity = CELIX_ARRAY_LIST_INLINE_CAPACITY;
+    list->elementData = list->inlineData;
+    list->equals = celix_arrayList_defaultEquals;
+    list->inStorage = true;
+    return list;
+}
+
 void celix_arrayList_destroy(celix_array_list_t *list) {
     list->size = 0;
-    free(list->elementData);
-    free(list);
+    if (list->elementData != list->inlineData) {
+        free(list->elementData);
+    }
+    if (!list->inStorage) {
+        free(list);
+    }
 }
 
 int celix_arrayList_size(const celix_array_list_t *list) {
@@ -403,66 +439,29 @@ double celix_arrayList_getDouble(const celix_array_list_t *list, int index) { re
 bool celix_arrayList_getBool(const celix_array_list_t *list, int index) { return arrayList_getEntry(list, index).boolVal; }
 size_t celix_arrayList_getSize(const celix_array_list_t *list, int index) { return arrayList_getEntry(list, index).sizeVal; }
 
-static void arrayList_addEntry(celix_array_list_t *list, celix_array_list_entry_t entry) {
-    arrayList_ensureCapacity(list, (int)list->size + 1);
-    memset(&list->elementData[list->size], 0, sizeof(entry));
-    list->elementData[list->size++] = entry;
-}
-
-void celix_arrayList_add(celix_array_list_t *list, void * element) {
-    celix_array_list_entry_t entry = { .voidPtrVal = element };
-    arrayList_addEntry(list, entry);
-}
-
-void celix_arrayList_addInt(celix_array_list_t *list, int val) { 
-    celix_array_list_entry_t entry; 
-    memset(&entry, 0, sizeof(entry)); 
-    entry.intVal = val; 
-    arrayList_addEntry(list, entry);
-}
-void celix_arrayList_addLong(celix_array_list_t *list, long val) { 
-    celix_array_list_entry_t entry; 
-    memset(&entry, 0, sizeof(entry)); 
-    entry.longVal = val; 
-    arrayList_addEntry(list, entry);
-}
-void celix_arrayList_addUInt(celix_array_list_t *list, unsigned int val) { 
-    celix_array_list_entry_t entry; 
-    memset(&entry, 0, sizeof(entry)); 
-    entry.uintVal = val; 
-    arrayList_addEntry(list, entry);
-}
-void celix_arrayList_addULong(celix_array_list_t *list, unsigned long val) { 
-    celix_array_list_entry_t entry; 
-    memset(&entry, 0, sizeof(entry)); 
-    entry.ulongVal = val; 
-    arrayList_addEntry(list, entry);
-}
-void celix_arrayList_addDouble(celix_array_list_t *list, double val) { 
-    celix_array_list_entry_t entry; 
-    memset(&entry, 0, sizeof(entry)); 
-    entry.doubleVal = val; 
-    arrayList_addEntry(list, entry);
-}
-void celix_arrayList_addFloat(celix_array_list_t *list, float val) { 
-    celix_array_list_entry_t entry; 
-    memset(&entry, 0, sizeof(entry)); 
-    entry.floatVal = val; 
-    arrayList_addEntry(list, entry);
-}
-void celix_arrayList_addBool(celix_array_list_t *list, bool val) { 
-    celix_array_list_entry_t entry; 
-    memset(&entry, 0, sizeof(entry)); 
-    entry.boolVal = val; 
-    arrayList_addEntry(list, entry);
-}
-void celix_arrayList_addSize(celix_array_list_t *list, size_t val) { 
-    celix_array_list_entry_t entry; 
-    memset(&entry, 0, sizeof(entry)); 
-    entry.sizeVal = val; 
-    arrayList_addEntry(list, entry);
+/**
+ * Returns a zeroed entry at the end of the list, so that the typed add functions can directly set the value.
+ */
+static inline celix_array_list_entry_t* arrayList_addEmptyEntry(celix_array_list_t *list) {
+    list->modCount++;
+    if (list->size == list->capacity) {
+        arrayList_grow(list, list->size + 1);
+    }
+    celix_array_list_entry_t *entry = &list->elementData[list->size++];
+    memset(entry, 0, sizeof(*entry));
+    return entry;
 }
 
+void celix_arrayList_add(celix_array_list_t *list, void * element) { arrayList_addEmptyEntry(list)->voidPtrVal = element; }
+void celix_arrayList_addInt(celix_array_list_t *list, int val) { arrayList_addEmptyEntry(list)->intVal = val; }
+void celix_arrayList_addLong(celix_array_list_t *list, long val) { arrayList_addEmptyEntry(list)->longVal = val; }
+void celix_arrayList_addUInt(celix_array_list_t *list, unsigned int val) { arrayList_addEmptyEntry(list)->uintVal = val; }
+void celix_arrayList_addULong(celix_array_list_t *list, unsigned long val) { arrayList_addEmptyEntry(list)->ulongVal = val; }
+void celix_arrayList_addDouble(celix_array_list_t *list, double val) { arrayList_addEmptyEntry(list)->doubleVal = val; }
+void celix_arrayList_addFloat(celix_array_list_t *list, float val) { arrayList_addEmptyEntry(list)->floatVal = val; }
+void celix_arrayList_addBool(celix_array_list_t *list, bool val) { arrayList_addEmptyEntry(list)->boolVal = val; }
+void celix_arrayList_addSize(celix_array_list_t *list, size_t val) { arrayList_addEmptyEntry(list)->sizeVal = val; }
+
 int celix_arrayList_indexOf(celix_array_list_t *list, celix_array_list_entry_t entry) {
     size_t size = celix_arrayList_size(list);
     int i;
@@ -480,7 +479,7 @@ void celix_arrayList_removeAt(celix_array_list_t *list, int index) {
     if (index >= 0 && index < list->size) {
         list->modCount++;
         size_t numMoved = list->size - index - 1;
-        memmove(list->elementData+index, list->elementData+index+1, sizeof(void *) * numMoved);
+        memmove(list->elementData+index, list->elementData+index+1, sizeof(celix_array_list_entry_t) * numMoved);
         memset(&list->elementData[--list->size], 0, sizeof(celix_array_list_entry_t));
     }
 }
@@ -29,15 +29,21 @@
 
 #include "array_list.h"
 
+/**
+ * Note the header fields should fit in the reserved part of celix_array_list_storage_t.
+ */
 struct celix_array_list {
-    celix_array_list_entry_t* elementData;
+    celix_array_list_entry_t* elementData; //inlineData or heap allocated if the list grows beyond the inline capacity
     size_t size;
     size_t capacity;
 
     unsigned int modCount;
+    bool inStorage; //created with celix_arrayList_createInStorage, the list itself is not freed on destroy
 
     array_list_element_equals_pt equalsDeprecated;
     celix_arrayList_equals_fp  equals;
+
+    celix_array_list_entry_t inlineData[CELIX_ARRAY_LIST_INLINE_CAPACITY];
 };
 
 struct celix_array_list_iterator {
@@ -0,0 +1,127 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <sched.h>
+
+#include "celix_rcu.h"
+
+//Number of reader counts per epoch, readers are spread over the slots to prevent contention on a single counter
+#define CELIX_RCU_READER_SLOTS 16
+//Number of rcu instances for which a thread tracks its read depth, see celix_rcu_inReadSection
+#define CELIX_RCU_MAX_NESTED 8
+
+typedef struct celix_rcu_reader_count {
+    unsigned int count;
+    char padding[64 - sizeof(unsigned int)]; //One reader count per cache line
+} celix_rcu_reader_count_t;
+
+struct celix_rcu {
+    unsigned int readerEpoch; //Which of the reader counts new readers use (atomic access)
+    celix_rcu_reader_count_t readers[2][CELIX_RCU_READER_SLOTS]; //Active readers per epoch (atomic access)
+};
+
+static unsigned int celix_rcu_nextReaderSlot = 0;
+static __thread int celix_rcu_threadReaderSlot = -1;
+//Read depth of the calling thread per rcu. Slots with depth 0 are free.
+static __thread struct {
+    const celix_rcu_t *rcu;
+    int depth;
+} celix_rcu_threadReadDepths[CELIX_RCU_MAX_NESTED];
+static __thread int celix_rcu_threadReadDepthsUsed = 0; //nr of (possibly freed) slots in use
+static __thread int celix_rcu_threadReadDepthOverflow = 0; //read depth of the rcu instances which did not fit
+
+/**
+ * Adds delta to the read depth of the calling thread for the rcu.
+ */
+static void celix_rcu_updateThreadReadDepth(const celix_rcu_t *rcu, int delta) {
+    int freeSlot = -1;
+    for (int i = 0; i < celix_rcu_threadReadDepthsUsed; ++i) {
+        if (celix_rcu_threadReadDepths[i].depth > 0 && celix_rcu_threadReadDepths[i].rcu == rcu) {
+            celix_rcu_threadReadDepths[i].depth += delta;
+            return;
+        } else if (freeSlot < 0 && celix_rcu_threadReadDepths[i].depth == 0) {
+            freeSlot = i;
+        }
+    }
+    if (delta < 0) {
+        celix_rcu_threadReadDepthOverflow += delta;
+        return;
+    }
+    if (freeSlot < 0 && celix_rcu_threadReadDepthsUsed < CELIX_RCU_MAX_NESTED) {
+        freeSlot = celix_rcu_threadReadDepthsUsed++;
+    }
+    if (freeSlot < 0) {
+        //note an overflow is treated as a read section of every rcu, so a writer never waits on itself
+        celix_rcu_threadReadDepthOverflow += delta;
+        return;
+    }
+    celix_rcu_threadReadDepths[freeSlot].rcu = rcu;
+    celix_rcu_threadReadDepths[freeSlot].depth = delta;
+}
+
+celix_rcu_t* celix_rcu_create(void) {
+    return calloc(1, sizeof(celix_rcu_t));
+}
+
+void celix_rcu_destroy(celix_rcu_t *rcu) {
+    free(rcu);
+}
+
+int celix_rcu_beginRead(celix_rcu_t *rcu) {
+    if (celix_rcu_threadReaderSlot < 0) {
+        celix_rcu_threadReaderSlot = (int)(__atomic_fetch_add(&celix_rcu_nextReaderSlot, 1, __ATOMIC_RELAXED) % CELIX_RCU_READER_SLOTS);
+    }
+    int epoch = (int)(__atomic_load_n(&rcu->readerEpoch, __ATOMIC_SEQ_CST) & 1);
+    __atomic_fetch_add(&rcu->readers[epoch][celix_rcu_threadReaderSlot].count, 1, __ATOMIC_SEQ_CST);
+    celix_rcu_updateThreadReadDepth(rcu, 1);
+    return epoch;
+}
+
+void celix_rcu_endRead(celix_rcu_t *rcu, int token) {
+    celix_rcu_updateThreadReadDepth(rcu, -1);
+    __atomic_fetch_sub(&rcu->readers[token][celix_rcu_threadReaderSlot].count, 1, __ATOMIC_SEQ_CST);
+}
+
+bool celix_rcu_inReadSection(const celix_rcu_t *rcu) {
+    if (celix_rcu_threadReadDepthOverflow > 0) {
+        return true;
+    }
+    for (int i = 0; i < celix_rcu_threadReadDepthsUsed; ++i) {
+        if (celix_rcu_threadReadDepths[i].depth > 0 && celix_rcu_threadReadDepths[i].rcu == rcu) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Two epoch flips are needed, because a reader can read the epoch before a flip and register itself after the
+ * writer checked the reader count of that epoch.
+ */
+void celix_rcu_synchronize(celix_rcu_t *rcu) {
+    for (int flip = 0; flip < 2; ++flip) {
+        unsigned int epoch = __atomic_fetch_xor(&rcu->readerEpoch, 1, __ATOMIC_SEQ_CST) & 1;
+        for (int slot = 0; slot < CELIX_RCU_READER_SLOTS; ++slot) {
+            while (__atomic_load_n(&rcu->readers[epoch][slot].count, __ATOMIC_SEQ_CST) != 0) {
+                sched_yield();
+            }
+        }
+    }
+}
@@ -0,0 +1,281 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "celix_rcu_hash_map.h"
+#include "celix_rcu.h"
+#include "celix_threads.h"
+
+#define CELIX_RCU_HASH_MAP_MIN_CAPACITY 8
+
+typedef struct celix_rcu_hash_map_entry {
+    bool used;
+    unsigned int hash;
+    void *key;
+    void *value;
+} celix_rcu_hash_map_entry_t;
+
+/**
+ * Immutable snapshot of the map: an open addressing hash table (linear probing) with a load factor <= 0.5.
+ */
+typedef struct celix_rcu_hash_map_snapshot celix_rcu_hash_map_snapshot_t;
+struct celix_rcu_hash_map_snapshot {
+    celix_rcu_hash_map_snapshot_t *nextRetired;
+    size_t size;
+    size_t capacity; //power of 2
+    celix_rcu_hash_map_entry_t entries[];
+};
+
+struct celix_rcu_hash_map {
+    unsigned int (*keyHash)(const void *key);
+    int (*keyEquals)(const void *key1, const void *key2);
+
+    celix_thread_mutex_t writeLock; //serializes the writers, protects retired
+    celix_rcu_hash_map_snapshot_t *retired; //Snapshots which could not be freed yet, because the writer was also a reader
+
+    celix_rcu_hash_map_snapshot_t *snapshot; //The published snapshot, NULL if empty (atomic access)
+    celix_rcu_t *rcu;
+};
+
+static unsigned int celix_rcuHashMap_pointerHash(const void *key) {
+    uintptr_t ptr = (uintptr_t)key;
+    return (unsigned int)(ptr ^ ((uint64_t)ptr >> 32));
+}
+
+static int celix_rcuHashMap_pointerEquals(const void *key1, const void *key2) {
+    return key1 == key2;
+}
+
+/**
+ * Spreads the bits of the (user provided) hash, so that sequential keys also work with a power of 2 table.
+ */
+static unsigned int celix_rcuHashMap_mix(unsigned int h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+celix_rcu_hash_map_t* celix_rcuHashMap_create(unsigned int (*keyHash)(const void *key), int (*keyEquals)(const void *key1, const void *key2)) {
+    celix_rcu_hash_map_t *map = calloc(1, sizeof(*map));
+    map->keyHash = keyHash != NULL ? keyHash : celix_rcuHashMap_pointerHash;
+    map->keyEquals = keyEquals != NULL ? keyEquals : celix_rcuHashMap_pointerEquals;
+    celixThreadMutex_create(&map->writeLock, NULL);
+    map->rcu = celix_rcu_create();
+    return map;
+}
+
+static void celix_rcuHashMap_freeRetired(celix_rcu_hash_map_t *map) {
+    while (map->retired != NULL) {
+        celix_rcu_hash_map_snapshot_t *retired = map->retired;
+        map->retired = retired->nextRetired;
+        free(retired);
+    }
+}
+
+void celix_rcuHashMap_destroy(celix_rcu_hash_map_t *map) {
+    if (map != NULL) {
+        free(map->snapshot);
+        celix_rcuHashMap_freeRetired(map);
+        celixThreadMutex_destroy(&map->writeLock);
+        celix_rcu_destroy(map->rcu);
+        free(map);
+    }
+}
+
+int celix_rcuHashMap_beginRead(celix_rcu_hash_map_t *map) {
+    return celix_rcu_beginRead(map->rcu);
+}
+
+void celix_rcuHashMap_endRead(celix_rcu_hash_map_t *map, int token) {
+    celix_rcu_endRead(map->rcu, token);
+}
+
+/**
+ * Returns the index of the entry for the key or -1 if not found.
+ */
+static long celix_rcuHashMap_find(celix_rcu_hash_map_t *map, const celix_rcu_hash_map_snapshot_t *snapshot, unsigned int hash, const void *key) {
+    if (snapshot == NULL) {
+        return -1;
+    }
+    size_t mask = snapshot->capacity - 1;
+    for (size_t i = hash & mask; snapshot->entries[i].used; i = (i + 1) & mask) {
+        const celix_rcu_hash_map_entry_t *entry = &snapshot->entries[i];
+        if (entry->hash == hash && (entry->key == key || map->keyEquals(entry->key, key))) {
+            return (long)i;
+        }
+    }
+    return -1;
+}
+
+void* celix_rcuHashMap_get(celix_rcu_hash_map_t *map, const void *key) {
+    unsigned int hash = celix_rcuHashMap_mix(map->keyHash(key));
+    void *value = NULL;
+    int token = celix_rcuHashMap_beginRead(map);
+    celix_rcu_hash_map_snapshot_t *snapshot = __atomic_load_n(&map->snapshot, __ATOMIC_SEQ_CST);
+    long index = celix_rcuHashMap_find(map, snapshot, hash, key);
+    if (index >= 0) {
+        value = snapshot->entries[index].value;
+    }
+    celix_rcuHashMap_endRead(map, token);
+    return value;
+}
+
+bool celix_rcuHashMap_hasKey(celix_rcu_hash_map_t *map, const void *key) {
+    unsigned int hash = celix_rcuHashMap_mix(map->keyHash(key));
+    int token = celix_rcuHashMap_beginRead(map);
+    celix_rcu_hash_map_snapshot_t *snapshot = __atomic_load_n(&map->snapshot, __ATOMIC_SEQ_CST);
+    bool found = celix_rcuHashMap_find(map, snapshot, hash, key) >= 0;
+    celix_rcuHashMap_endRead(map, token);
+    return found;
+}
+
+size_t celix_rcuHashMap_size(celix_rcu_hash_map_t *map) {
+    int token = celix_rcuHashMap_beginRead(map);
+    celix_rcu_hash_map_snapshot_t *snapshot = __atomic_load_n(&map->snapshot, __ATOMIC_SEQ_CST);
+    size_t size = snapshot == NULL ? 0 : snapshot->size;
+    celix_rcuHashMap_endRead(map, token);
+    return size;
+}
+
+void celix_rcuHashMap_forEach(celix_rcu_hash_map_t *map, void *handle, void (*callback)(void *handle, const void *key, void *value)) {
+    int token = celix_rcuHashMap_beginRead(map);
+    celix_rcu_hash_map_snapshot_t *snapshot = __atomic_load_n(&map->snapshot, __ATOMIC_SEQ_CST);
+    if (snapshot != NULL) {
+        for (size_t i = 0; i < snapshot->capacity; ++i) {
+            if (snapshot->entries[i].used) {
+                callback(handle, snapshot->entries[i].key, snapshot->entries[i].value);
+            }
+        }
+    }
+    celix_rcuHashMap_endRead(map, token);
+}
+
+static celix_rcu_hash_map_snapshot_t* celix_rcuHashMap_createSnapshot(size_t capacity) {
+    celix_rcu_hash_map_snapshot_t *snapshot = calloc(1, sizeof(*snapshot) + capacity * sizeof(celix_rcu_hash_map_entry_t));
+    snapshot->capacity = capacity;
+    return snapshot;
+}
+
+static void celix_rcuHashMap_insert(celix_rcu_hash_map_snapshot_t *snapshot, unsigned int hash, void *key, void *value) {
+    size_t mask = snapshot->capacity - 1;
+    size_t i = hash & mask;
+    while (snapshot->entries[i].used) {
+        i = (i + 1) & mask;
+    }
+    snapshot->entries[i].used = true;
+    snapshot->entries[i].hash = hash;
+    snapshot->entries[i].key = key;
+    snapshot->entries[i].value = value;
+    snapshot->size += 1;
+}
+
+/**
+ * Copies the entries of the snapshot to a new snapshot with the provided capacity, skipping the entry at skipIndex.
+ */
+static celix_rcu_hash_map_snapshot_t* celix_rcuHashMap_copySnapshot(const celix_rcu_hash_map_snapshot_t *snapshot, size_t capacity, long skipIndex) {
+    celix_rcu_hash_map_snapshot_t *copy = celix_rcuHashMap_createSnapshot(capacity);
+    if (snapshot != NULL) {
+        for (size_t i = 0; i < snapshot->capacity; ++i) {
+            const celix_rcu_hash_map_entry_t *entry = &snapshot->entries[i];
+            if (entry->used && (long)i != skipIndex) {
+                celix_rcuHashMap_insert(copy, entry->hash, entry->key, entry->value);
+            }
+        }
+    }
+    return copy;
+}
+
+/**
+ * Publishes the new snapshot and frees the old one when no reader can use it anymore. Called with the write lock.
+ */
+static void celix_rcuHashMap_publish(celix_rcu_hash_map_t *map, celix_rcu_hash_map_snapshot_t *snapshot) {
+    celix_rcu_hash_map_snapshot_t *old = __atomic_exchange_n(&map->snapshot, snapshot, __ATOMIC_SEQ_CST);
+    if (celix_rcu_inReadSection(map->rcu)) {
+        //Called from a read section, cannot wait on ourselves.
+        if (old != NULL) {
+            old->nextRetired = map->retired;
+            map->retired = old;
+        }
+        return;
+    }
+
+    celix_rcu_synchronize(map->rcu);
+    free(old);
+    celix_rcuHashMap_freeRetired(map);
+}
+
+void* celix_rcuHashMap_put(celix_rcu_hash_map_t *map, void *key, void *value) {
+    unsigned int hash = celix_rcuHashMap_mix(map->keyHash(key));
+    void *replaced = NULL;
+
+    celixThreadMutex_lock(&map->writeLock);
+    celix_rcu_hash_map_snapshot_t *snapshot = __atomic_load_n(&map->snapshot, __ATOMIC_RELAXED);
+    long index = celix_rcuHashMap_find(map, snapshot, hash, key);
+    celix_rcu_hash_map_snapshot_t *copy;
+    if (index >= 0) {
+        replaced = snapshot->entries[index].value;
+        size_t size = sizeof(*snapshot) + snapshot->capacity * sizeof(celix_rcu_hash_map_entry_t);
+        copy = malloc(size);
+        memcpy(copy, snapshot, size);
+        copy->nextRetired = NULL;
+        copy->entries[index].value = value; //note the existing key is kept, as for hash_map_t
+    } else {
+        size_t capacity = snapshot == NULL ? CELIX_RCU_HASH_MAP_MIN_CAPACITY : snapshot->capacity;
+        size_t size = snapshot == NULL ? 0 : snapshot->size;
+        while ((size + 1) * 2 > capacity) {
+            capacity *= 2;
+        }
+        copy = celix_rcuHashMap_copySnapshot(snapshot, capacity, -1);
+        celix_rcuHashMap_insert(copy, hash, key, value);
+    }
+    celix_rcuHashMap_publish(map, copy);
+    celixThreadMutex_unlock(&map->writeLock);
+
+    return replaced;
+}
+
+void* celix_rcuHashMap_remove(celix_rcu_hash_map_t *map, const void *key) {
+    unsigned int hash = celix_rcuHashMap_mix(map->keyHash(key));
+    void *removed = NULL;
+
+    celixThreadMutex_lock(&map->writeLock);
+    celix_rcu_hash_map_snapshot_t *snapshot = __atomic_load_n(&map->snapshot, __ATOMIC_RELAXED);
+    long index = celix_rcuHashMap_find(map, snapshot, hash, key);
+    if (index >= 0) {
+        removed = snapshot->entries[index].value;
+        celix_rcu_hash_map_snapshot_t *copy = NULL;
+        if (snapshot->size > 1) {
+            size_t capacity = snapshot->capacity;
+            while (capacity > CELIX_RCU_HASH_MAP_MIN_CAPACITY && (snapshot->size - 1) * 8 < capacity) {
+                capacity /= 2;
+            }
+            copy = celix_rcuHashMap_copySnapshot(snapshot, capacity, index);
+        }
+        celix_rcuHashMap_publish(map, copy);
+    }
+    celixThreadMutex_unlock(&map->writeLock);
+
+    return removed;
+}
@@ -0,0 +1,163 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "celix_striped_hash_map.h"
+#include "celix_threads.h"
+#include "hash_map.h"
+
+#define CELIX_STRIPED_HASH_MAP_DEFAULT_NR_OF_STRIPES 16
+
+typedef struct celix_striped_hash_map_stripe {
+    celix_thread_rwlock_t lock;
+    hash_map_t *map;
+    size_t size; //atomic access, so that the map size can be read without locking all stripes
+} celix_striped_hash_map_stripe_t;
+
+struct celix_striped_hash_map {
+    unsigned int (*keyHash)(const void *key);
+    size_t stripeMask;
+    celix_striped_hash_map_stripe_t *stripes;
+};
+
+static unsigned int celix_stripedHashMap_pointerHash(const void *key) {
+    uintptr_t ptr = (uintptr_t)key;
+    return (unsigned int)(ptr ^ ((uint64_t)ptr >> 32));
+}
+
+celix_striped_hash_map_t* celix_stripedHashMap_create(unsigned int (*keyHash)(const void *key), int (*keyEquals)(const void *key1, const void *key2), size_t nrOfStripes) {
+    size_t nr = 1;
+    while (nr < (nrOfStripes == 0 ? CELIX_STRIPED_HASH_MAP_DEFAULT_NR_OF_STRIPES : nrOfStripes)) {
+        nr *= 2;
+    }
+
+    celix_striped_hash_map_t *map = calloc(1, sizeof(*map));
+    map->keyHash = keyHash != NULL ? keyHash : celix_stripedHashMap_pointerHash;
+    map->stripeMask = nr - 1;
+    map->stripes = calloc(nr, sizeof(*map->stripes));
+    for (size_t i = 0; i < nr; ++i) {
+        celixThreadRwlock_create(&map->stripes[i].lock, NULL);
+        map->stripes[i].map = hashMap_create(keyHash, NULL, keyEquals, NULL);
+    }
+    return map;
+}
+
+void celix_stripedHashMap_destroy(celix_striped_hash_map_t *map) {
+    if (map != NULL) {
+        for (size_t i = 0; i <= map->stripeMask; ++i) {
+            hashMap_destroy(map->stripes[i].map, false, false);
+            celixThreadRwlock_destroy(&map->stripes[i].lock);
+        }
+        free(map->stripes);
+        free(map);
+    }
+}
+
+/**
+ * Selects the stripe on the high bits of the (mixed) hash, the hash_map_t of the stripe uses the low bits.
+ */
+static celix_striped_hash_map_stripe_t* celix_stripedHashMap_stripe(celix_striped_hash_map_t *map, const void *key) {
+    unsigned int h = map->keyHash(key) * 0x9E3779B1U;
+    return &map->stripes[(h >> 16) & map->stripeMask];
+}
+
+void* celix_stripedHashMap_get(celix_striped_hash_map_t *map, const void *key) {
+    celix_striped_hash_map_stripe_t *stripe = celix_stripedHashMap_stripe(map, key);
+    celixThreadRwlock_readLock(&stripe->lock);
+    void *value = hashMap_get(stripe->map, key);
+    celixThreadRwlock_unlock(&stripe->lock);
+    return value;
+}
+
+bool celix_stripedHashMap_hasKey(celix_striped_hash_map_t *map, const void *key) {
+    celix_striped_hash_map_stripe_t *stripe = celix_stripedHashMap_stripe(map, key);
+    celixThreadRwlock_readLock(&stripe->lock);
+    bool found = hashMap_containsKey(stripe->map, key);
+    celixThreadRwlock_unlock(&stripe->lock);
+    return found;
+}
+
+size_t celix_stripedHashMap_size(celix_striped_hash_map_t *map) {
+    size_t size = 0;
+    for (size_t i = 0; i <= map->stripeMask; ++i) {
+        size += __atomic_load_n(&map->stripes[i].size, __ATOMIC_RELAXED);
+    }
+    return size;
+}
+
+bool celix_stripedHashMap_use(celix_striped_hash_map_t *map, const void *key, void *handle, void (*use)(void *handle, void *value)) {
+    celix_striped_hash_map_stripe_t *stripe = celix_stripedHashMap_stripe(map, key);
+    celixThreadRwlock_readLock(&stripe->lock);
+    hash_map_entry_t *entry = hashMap_getEntry(stripe->map, key);
+    if (entry != NULL) {
+        use(handle, hashMapEntry_getValue(entry));
+    }
+    celixThreadRwlock_unlock(&stripe->lock);
+    return entry != NULL;
+}
+
+void celix_stripedHashMap_forEach(celix_striped_hash_map_t *map, void *handle, void (*callback)(void *handle, const void *key, void *value)) {
+    for (size_t i = 0; i <= map->stripeMask; ++i) {
+        celix_striped_hash_map_stripe_t *stripe = &map->stripes[i];
+        celixThreadRwlock_readLock(&stripe->lock);
+        hash_map_iterator_t iter = hashMapIterator_construct(stripe->map);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_t *entry = hashMapIterator_nextEntry(&iter);
+            callback(handle, hashMapEntry_getKey(entry), hashMapEntry_getValue(entry));
+        }
+        celixThreadRwlock_unlock(&stripe->lock);
+    }
+}
+
+static void* celix_stripedHashMap_putInternal(celix_striped_hash_map_t *map, void *key, void *value, bool replace) {
+    celix_striped_hash_map_stripe_t *stripe = celix_stripedHashMap_stripe(map, key);
+    void *existing = NULL;
+    celixThreadRwlock_writeLock(&stripe->lock);
+    hash_map_entry_t *entry = hashMap_getEntry(stripe->map, key);
+    if (entry == NULL) {
+        hashMap_put(stripe->map, key, value);
+        __atomic_store_n(&stripe->size, (size_t)hashMap_size(stripe->map), __ATOMIC_RELAXED);
+    } else {
+        existing = hashMapEntry_getValue(entry);
+        if (replace) {
+            hashMap_put(stripe->map, key, value);
+        }
+    }
+    celixThreadRwlock_unlock(&stripe->lock);
+    return existing;
+}
+
+void* celix_stripedHashMap_put(celix_striped_hash_map_t *map, void *key, void *value) {
+    return celix_stripedHashMap_putInternal(map, key, value, true);
+}
+
+void* celix_stripedHashMap_putIfAbsent(celix_striped_hash_map_t *map, void *key, void *value) {
+    return celix_stripedHashMap_putInternal(map, key, value, false);
+}
+
+void* celix_stripedHashMap_remove(celix_striped_hash_map_t *map, const void *key) {
+    celix_striped_hash_map_stripe_t *stripe = celix_stripedHashMap_stripe(map, key);
+    celixThreadRwlock_writeLock(&stripe->lock);
+    void *removed = hashMap_remove(stripe->map, key);
+    __atomic_store_n(&stripe->size, (size_t)hashMap_size(stripe->map), __ATOMIC_RELAXED);
+    celixThreadRwlock_unlock(&stripe->lock);
+    return removed;
+}
@@ -218,7 +218,7 @@ static void parseLine(const char* line, celix_properties_t *props) {
 
 
 celix_properties_t* celix_properties_create(void) {
-    return hashMap_create(utils_stringHash, utils_stringHash, utils_stringEquals, utils_stringEquals);
+    return hashMap_create(utils_stringFastHash, utils_stringFastHash, utils_stringEquals, utils_stringEquals);
 }
 
 void celix_properties_destroy(celix_properties_t *properties) {
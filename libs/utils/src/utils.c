@@ -19,6 +19,7 @@
 
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <assert.h>
 
@@ -38,6 +39,10 @@ unsigned int utils_stringHash(const void* strPtr) {
     return celix_utils_stringHash((const char*)strPtr);
 }
 
+unsigned int utils_stringFastHash(const void* strPtr) {
+    return celix_utils_stringFastHash((const char*)strPtr);
+}
+
 int utils_stringEquals(const void* string, const void* toCompare) {
     return celix_utils_stringEquals((const char*)string, (const char*)toCompare);
 }
@@ -51,13 +56,107 @@ unsigned int celix_utils_stringHash(const char* string) {
     return hc;
 }
 
+/*
+ * wyhash (final version 4, public domain, https://github.com/wangyi-fudan/wyhash).
+ * The input is read 8 bytes at a time and mixed with a 64x64->128 bit multiply, short strings (<= 16 bytes, most
+ * property keys) are handled with at most 4 overlapping reads and without a loop.
+ */
+static const uint64_t CELIX_UTILS_WYHASH_SECRET[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+
+static inline void celix_utils_wymum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    *a = lo;
+    *b = hi;
+#endif
+}
+
+static inline uint64_t celix_utils_wymix(uint64_t a, uint64_t b) {
+    celix_utils_wymum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t celix_utils_wyr8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t celix_utils_wyr4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t celix_utils_wyr3(const uint8_t *p, size_t k) {
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+unsigned int celix_utils_memHash(const void* data, size_t len) {
+    const uint64_t *secret = CELIX_UTILS_WYHASH_SECRET;
+    const uint8_t *p = data;
+    uint64_t seed = celix_utils_wymix(secret[0], secret[1]);
+    uint64_t a;
+    uint64_t b;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (celix_utils_wyr4(p) << 32) | celix_utils_wyr4(p + ((len >> 3) << 2));
+            b = (celix_utils_wyr4(p + len - 4) << 32) | celix_utils_wyr4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = celix_utils_wyr3(p, len);
+            b = 0;
+        } else {
+            a = 0;
+            b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do {
+                seed = celix_utils_wymix(celix_utils_wyr8(p) ^ secret[1], celix_utils_wyr8(p + 8) ^ seed);
+                see1 = celix_utils_wymix(celix_utils_wyr8(p + 16) ^ secret[2], celix_utils_wyr8(p + 24) ^ see1);
+                see2 = celix_utils_wymix(celix_utils_wyr8(p + 32) ^ secret[3], celix_utils_wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = celix_utils_wymix(celix_utils_wyr8(p) ^ secret[1], celix_utils_wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = celix_utils_wyr8(p + i - 16);
+        b = celix_utils_wyr8(p + i - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    celix_utils_wymum(&a, &b);
+    uint64_t h = celix_utils_wymix(a ^ secret[0] ^ len, b ^ secret[1]);
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+unsigned int celix_utils_stringFastHash(const char* string) {
+    return celix_utils_memHash(string, strlen(string)); //note strlen is vectorized by the C library
+}
+
 bool celix_utils_stringEquals(const char* a, const char* b) {
-    if (a == NULL && b == NULL) {
+    if (a == b) {
         return true;
     } else if (a == NULL || b == NULL) {
         return false;
     } else {
-        return strncmp(a, b, 1024*124*10) == 0;
+        return strcmp(a, b) == 0;
     }
 }
 